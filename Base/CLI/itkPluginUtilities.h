@@ -7,6 +7,9 @@
 #include <itkImageFileReader.h>
 #include <itkPluginFilterWatcher.h>
 
+// Slicer includes
+#include "vtkSlicerCLISharedMemory.h"
+
 // STD includes
 #include <vector>
 #include <string>
@@ -52,6 +55,24 @@ namespace itk
       }
     }
 
+  //-----------------------------------------------------------------------------
+  /// Returns true if fileName refers to a memory-backed file (POSIX shared memory,
+  /// /dev/shm on Linux). Slicer passes such files to executable modules for
+  /// exchanging images without disk access, if shared memory is available.
+  bool IsSharedMemoryFileName(const std::string& fileName)
+    {
+    return vtkSlicerCLISharedMemory::IsSharedMemoryFileName(fileName);
+    }
+
+  //-----------------------------------------------------------------------------
+  /// Returns true if an output image should be written with compression.
+  /// Shared memory files are read back immediately by Slicer, therefore
+  /// compressing them would only slow down the data exchange.
+  bool UseCompressionForFileName(const std::string& fileName, bool useCompression = true)
+    {
+    return useCompression && !IsSharedMemoryFileName(fileName);
+    }
+
   //-----------------------------------------------------------------------------
   template <class T>
   void AlignVolumeCenters(T *fixed, T *moving, typename T::PointType &origin)
@@ -0,0 +1,89 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __vtkSlicerCLISharedMemory_h
+#define __vtkSlicerCLISharedMemory_h
+
+// STD includes
+#include <sstream>
+#include <string>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+/// \brief Location of the memory-backed files that Slicer exchanges with executable modules.
+///
+/// Images are written to POSIX shared memory (/dev/shm on Linux) if it has enough
+/// free space. Shared memory is readable by all local users, therefore files are
+/// written into a subdirectory that only the current user can access (see
+/// GetUserDirectory()), and they are created with permissions for the owner only.
+/// Names of the files start with GetFileNamePrefix() followed by the process id
+/// of Slicer (digits encoded as letters A-J), so that files left behind by a
+/// Slicer process that did not exit normally can be found and removed.
+///
+/// This header is used both by Slicer and by the executable modules
+/// (see itkPluginUtilities.h), it must not depend on any library.
+namespace vtkSlicerCLISharedMemory
+{
+  //-----------------------------------------------------------------------------
+  /// Directory of memory-backed files, without trailing slash.
+  /// Empty if there is no such directory on this platform.
+  inline std::string GetDirectory()
+    {
+#ifdef _WIN32
+    return std::string();
+#else
+    return "/dev/shm";
+#endif
+    }
+
+  //-----------------------------------------------------------------------------
+  /// Directory of the memory-backed files of the current user, without trailing slash.
+  /// It is a subdirectory of GetDirectory() that must be owned by the user and not
+  /// accessible by other users. Empty if there is no shared memory directory.
+  inline std::string GetUserDirectory()
+    {
+    std::string directory = GetDirectory();
+    if (directory.empty())
+      {
+      return directory;
+      }
+#ifndef _WIN32
+    std::ostringstream userDirectory;
+    userDirectory << directory << "/Slicer-" << getuid();
+    directory = userDirectory.str();
+#endif
+    return directory;
+    }
+
+  //-----------------------------------------------------------------------------
+  /// Prefix of the names of the files that Slicer writes into the shared memory directory.
+  inline std::string GetFileNamePrefix()
+    {
+    return "Slicer-";
+    }
+
+  //-----------------------------------------------------------------------------
+  /// Returns true if fileName refers to a file in the shared memory directory.
+  inline bool IsSharedMemoryFileName(const std::string& fileName)
+    {
+    std::string directory = GetDirectory();
+    if (directory.empty())
+      {
+      return false;
+      }
+    directory += "/";
+    return fileName.compare(0, directory.size(), directory) == 0;
+    }
+}
+
+#endif
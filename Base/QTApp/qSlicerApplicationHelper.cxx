@@ -24,6 +24,7 @@
 #include <QFont>
 #include <QLabel>
 #include <QSettings>
+#include <QStandardPaths>
 #include <QSysInfo>
 #include <QThread>
 #include <QTimer>
@@ -34,6 +35,7 @@
 #ifdef Slicer_BUILD_CLI_SUPPORT
 # include "qSlicerCLIExecutableModuleFactory.h"
 # include "qSlicerCLILoadableModuleFactory.h"
+# include "vtkSlicerCLIModuleLogic.h"
 #endif
 #include "qSlicerCommandOptions.h"
 #include "qSlicerCoreModuleFactory.h"
@@ -169,6 +171,10 @@ void qSlicerApplicationHelper::setupModuleFactoryManager(qSlicerModuleFactoryMan
     QString tempDirectory =
       qSlicerCoreApplication::application()->temporaryPath();
 
+    // Images exchanged with executable CLIs by a Slicer process that did not exit
+    // normally would otherwise use shared memory until the computer is restarted.
+    vtkSlicerCLIModuleLogic::RemoveStaleSharedMemoryFiles();
+
     // Option to prefer executable CLIs to limit memory consumption.
     bool preferExecutableCLIs =
       app->userSettings()->value("Modules/PreferExecutableCLI", Slicer_CLI_PREFER_EXECUTABLE_DEFAULT).toBool();
@@ -179,7 +185,18 @@ void qSlicerApplicationHelper::setupModuleFactoryManager(qSlicerModuleFactoryMan
 
     qSlicerCLIExecutableModuleFactory* cliExecutableFactory = new qSlicerCLIExecutableModuleFactory();
     cliExecutableFactory->setTempDirectory(tempDirectory);
+    // Avoid running each CLI executable with "--xml" at every startup
+    cliExecutableFactory->setXmlModuleDescriptionCacheFilePath(
+      QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/CLIModuleDescriptions.ini");
     moduleFactoryManager->registerFactory(cliExecutableFactory, preferExecutableCLIs ? 1 : 0);
+    // Only prefetch the descriptions of the executables that are instantiated,
+    // not the ones superseded by loadable CLIs.
+    QObject::connect(moduleFactoryManager, &qSlicerAbstractModuleFactoryManager::modulesRegistered,
+                     moduleFactoryManager, [=]()
+      {
+      cliExecutableFactory->setModuleNamesToPrefetch(
+        moduleFactoryManager->registeredModuleNames(cliExecutableFactory));
+      });
 
     if (!options->disableBuiltInModules() &&
         !options->disableBuiltInCLIModules() &&
@@ -48,5 +48,19 @@ int qSlicerCLIExecutableModuleFactoryTest1(int, char * [] )
       }
     }
 
+  if (!factory.xmlModuleDescriptionCacheFilePath().isEmpty())
+    {
+    std::cerr << __LINE__ << " - Error in xmlModuleDescriptionCacheFilePath()" << std::endl
+                          << "XML description cache should be disabled by default" << std::endl;
+    return EXIT_FAILURE;
+    }
+  factory.setXmlModuleDescriptionCacheFilePath("/tmp/CLIModuleDescriptions.ini");
+  if (factory.xmlModuleDescriptionCacheFilePath() != "/tmp/CLIModuleDescriptions.ini")
+    {
+    std::cerr << __LINE__ << " - Error in setXmlModuleDescriptionCacheFilePath()" << std::endl
+                          << "filePath = " << qPrintable(factory.xmlModuleDescriptionCacheFilePath()) << std::endl;
+    return EXIT_FAILURE;
+    }
+
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,211 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c) Kitware Inc.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSettings>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+// SlicerQt includes
+#include "qSlicerApplication.h"
+#include "qSlicerCLIExecutableModuleFactory.h"
+
+// STD includes
+#include <iostream>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+/// Write a CLI executable that prints its XML description and records each
+/// run in \a runLogFilePath.
+bool writeCLIExecutable(const QString& filePath, const QString& runLogFilePath, const QString& title)
+{
+  QFile file(filePath);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+    return false;
+    }
+  QTextStream stream(&file);
+  stream << "#!/bin/sh\n"
+         << "echo run >> \"" << runLogFilePath << "\"\n"
+         << "cat << EOF\n"
+         << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+         << "<executable>\n"
+         << "  <category>Testing</category>\n"
+         << "  <title>" << title << "</title>\n"
+         << "  <description>XML description cache test</description>\n"
+         << "  <version>1.0</version>\n"
+         << "</executable>\n"
+         << "EOF\n";
+  stream.flush();
+  file.close();
+  return file.setPermissions(file.permissions() | QFileDevice::ExeOwner);
+}
+
+//-----------------------------------------------------------------------------
+int numberOfRuns(const QString& runLogFilePath)
+{
+  QFile file(runLogFilePath);
+  if (!file.open(QIODevice::ReadOnly))
+    {
+    return 0;
+    }
+  return QTextStream(&file).readAll().count("run");
+}
+
+//-----------------------------------------------------------------------------
+/// Instantiate the module of \a executablePath using a new factory, as done
+/// at application startup.
+bool instantiateModule(const QString& executablePath, const QString& cacheFilePath)
+{
+  qSlicerCLIExecutableModuleFactory factory;
+  factory.setXmlModuleDescriptionCacheFilePath(cacheFilePath);
+  QString moduleName = factory.registerFileItem(QFileInfo(executablePath));
+  return factory.instantiate(moduleName) != nullptr;
+}
+
+//-----------------------------------------------------------------------------
+bool checkNumberOfRuns(int line, const QString& runLogFilePath, int expectedNumberOfRuns)
+{
+  int runs = numberOfRuns(runLogFilePath);
+  if (runs != expectedNumberOfRuns)
+    {
+    std::cerr << "Line " << line << " - " << qPrintable(QFileInfo(runLogFilePath).baseName())
+              << " was run " << runs << " times instead of " << expectedNumberOfRuns << std::endl;
+    return false;
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int qSlicerCLIExecutableModuleFactoryTest2(int argc, char * argv[])
+{
+#ifdef Q_OS_WIN32
+  Q_UNUSED(argc);
+  Q_UNUSED(argv);
+  std::cout << "Test requires a POSIX shell, skipping" << std::endl;
+  return EXIT_SUCCESS;
+#else
+  qSlicerApplication::setAttribute(qSlicerApplication::AA_DisablePython);
+  qSlicerApplication app(argc, argv);
+
+  QTemporaryDir tempDir;
+  if (!tempDir.isValid())
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to create temporary directory" << std::endl;
+    return EXIT_FAILURE;
+    }
+  QDir dir(tempDir.path());
+  QString cacheFilePath = dir.filePath("CLIModuleDescriptions.ini");
+  QString executablePath = dir.filePath("CacheTestCLI");
+  QString runLogFilePath = dir.filePath("CacheTestCLIRuns");
+  QString otherExecutablePath = dir.filePath("OtherCacheTestCLI");
+  QString otherRunLogFilePath = dir.filePath("OtherCacheTestCLIRuns");
+  if (!writeCLIExecutable(executablePath, runLogFilePath, "Cache Test")
+    || !writeCLIExecutable(otherExecutablePath, otherRunLogFilePath, "Other Cache Test"))
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to write CLI executables" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Store: the executable is run and its description is cached
+  if (!instantiateModule(executablePath, cacheFilePath)
+    || !checkNumberOfRuns(__LINE__, runLogFilePath, 1))
+    {
+    return EXIT_FAILURE;
+    }
+  {
+  QSettings settings(cacheFilePath, QSettings::IniFormat);
+  int size = settings.beginReadArray("Modules");
+  if (size != 1)
+    {
+    std::cerr << "Line " << __LINE__ << " - Cache has " << size << " entries instead of 1" << std::endl;
+    return EXIT_FAILURE;
+    }
+  settings.setArrayIndex(0);
+  if (settings.value("Path").toString() != QFileInfo(executablePath).absoluteFilePath()
+    || !settings.value("XmlDescription").toString().contains("<title>Cache Test</title>"))
+    {
+    std::cerr << "Line " << __LINE__ << " - Unexpected cache entry for "
+              << qPrintable(settings.value("Path").toString()) << std::endl;
+    return EXIT_FAILURE;
+    }
+  settings.endArray();
+  }
+
+  // Hit: the description is read from the cache
+  if (!instantiateModule(executablePath, cacheFilePath)
+    || !checkNumberOfRuns(__LINE__, runLogFilePath, 1))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // Invalidation on size change
+  if (!writeCLIExecutable(executablePath, runLogFilePath, "Cache Test Resized")
+    || !instantiateModule(executablePath, cacheFilePath)
+    || !checkNumberOfRuns(__LINE__, runLogFilePath, 2)
+    || !instantiateModule(executablePath, cacheFilePath)
+    || !checkNumberOfRuns(__LINE__, runLogFilePath, 2))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // Invalidation on modification time change, the size is unchanged
+  {
+  QFile executable(executablePath);
+  QDateTime lastModified = QFileInfo(executablePath).lastModified();
+  if (!executable.open(QIODevice::ReadWrite)
+    || !executable.setFileTime(lastModified.addSecs(10), QFileDevice::FileModificationTime))
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to change modification time" << std::endl;
+    return EXIT_FAILURE;
+    }
+  }
+  if (!instantiateModule(executablePath, cacheFilePath)
+    || !checkNumberOfRuns(__LINE__, runLogFilePath, 3)
+    || !instantiateModule(executablePath, cacheFilePath)
+    || !checkNumberOfRuns(__LINE__, runLogFilePath, 3))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // Only the modules to prefetch are run when the first module is instantiated
+  {
+  qSlicerCLIExecutableModuleFactory factory;
+  QString moduleName = factory.registerFileItem(QFileInfo(executablePath));
+  QString otherModuleName = factory.registerFileItem(QFileInfo(otherExecutablePath));
+  factory.setModuleNamesToPrefetch(QStringList() << moduleName);
+  if (!factory.instantiate(moduleName)
+    || !checkNumberOfRuns(__LINE__, runLogFilePath, 4)
+    || !checkNumberOfRuns(__LINE__, otherRunLogFilePath, 0)
+    || !factory.instantiate(otherModuleName)
+    || !checkNumberOfRuns(__LINE__, otherRunLogFilePath, 1))
+    {
+    return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+#endif
+}
@@ -19,8 +19,16 @@
 ==============================================================================*/
 
 // Qt includes
+#include <QDateTime>
+#include <QDebug>
+#include <QHash>
 #include <QProcess>
+#include <QRunnable>
+#include <QSettings>
 #include <QStandardPaths>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
 
 // SlicerQt includes
 #include "qSlicerCLIExecutableModuleFactory.h"
@@ -48,107 +56,47 @@ QString findPython()
 }
 
 //-----------------------------------------------------------------------------
-qSlicerCLIExecutableModuleFactoryItem::qSlicerCLIExecutableModuleFactoryItem(
-  const QString& newTempDirectory)
-  : TempDirectory(newTempDirectory)
-  , CLIModule(nullptr)
+namespace
 {
-}
 
 //-----------------------------------------------------------------------------
-bool qSlicerCLIExecutableModuleFactoryItem::load()
+struct qSlicerCLIXmlModuleDescription
 {
-  return true;
-}
+  qSlicerCLIXmlModuleDescription() : RetrievedFromExecutable(false) {}
+  QString XmlDescription;
+  QStringList ErrorStrings;
+  QStringList WarningStrings;
+  /// True if the description was printed by the executable with "--xml"
+  /// instead of read from a XML file next to it.
+  bool RetrievedFromExecutable;
+};
 
 //-----------------------------------------------------------------------------
-QString qSlicerCLIExecutableModuleFactoryItem::xmlModuleDescriptionFilePath()
+QString xmlModuleDescriptionFilePath(const QString& executablePath)
 {
-  QFileInfo info = QFileInfo(this->path());
+  QFileInfo info = QFileInfo(executablePath);
   return QDir(info.path()).filePath(info.baseName() + ".xml");
 }
 
 //-----------------------------------------------------------------------------
-qSlicerAbstractCoreModule* qSlicerCLIExecutableModuleFactoryItem::instanciator()
-{
-  // Using a scoped pointer ensures the memory will be cleaned if instantiator
-  // fails before returning the module. See QScopedPointer::take()
-  QScopedPointer<qSlicerCLIModule> module(new qSlicerCLIModule());
-  module->setModuleType("CommandLineModule");
-  module->setEntryPoint(this->path());
-
-  // Identify CLI-only .py scripts by `#!` first line
-  // then set up interpreter path in SEM module `Location` parameter.
-  if (QFileInfo(this->path()).suffix().toLower() == "py")
-    {
-      QString python_path = findPython();
-      if (python_path.isEmpty())
-        {
-        this->appendInstantiateErrorString(
-          QString("Failed to find python interpreter for CLI: %1").arg(this->path()));
-        return nullptr;
-        }
-
-      module->setEntryPoint("python");
-      module->moduleDescription().SetLocation(python_path.toStdString());
-      module->moduleDescription().SetTarget(this->path().toStdString());
-    }
-
-  QString xmlFilePath = this->xmlModuleDescriptionFilePath();
-
-  //
-  // If the xml file exists, read it and associate it with the module
-  // description. If not, run the CLI executable with "--xml".
-  //
-  QString xmlDescription;
-  if (QFile::exists(xmlFilePath))
-    {
-    QFile xmlFile(xmlFilePath);
-    if (xmlFile.open(QIODevice::ReadOnly))
-      {
-      xmlDescription = QTextStream(&xmlFile).readAll();
-      }
-    else
-      {
-      this->appendInstantiateErrorString(QString("CLI description: %1").arg(xmlFilePath));
-      this->appendInstantiateErrorString("Failed to read Xml Description");
-      }
-    }
-  else
-    {
-    xmlDescription = this->runCLIWithXmlArgument();
-    }
-  if (xmlDescription.isEmpty())
-    {
-    return nullptr;
-    }
-
-  module->setXmlModuleDescription(xmlDescription.toUtf8());
-  module->setTempDirectory(this->TempDirectory);
-  module->setPath(this->path());
-  module->setInstalled(qSlicerCLIModuleFactoryHelper::isInstalled(this->path()));
-  module->setBuiltIn(qSlicerCLIModuleFactoryHelper::isBuiltIn(this->path()));
-
-  this->CLIModule = module.data();
-
-  return module.take();
-}
-
-//-----------------------------------------------------------------------------
-QString qSlicerCLIExecutableModuleFactoryItem::runCLIWithXmlArgument()
+qSlicerCLIXmlModuleDescription runCLIWithXmlArgument(const QString& executablePath)
 {
-  ctkScopedCurrentDir scopedCurrentDir(QFileInfo(this->path()).path());
+  qSlicerCLIXmlModuleDescription description;
+  description.RetrievedFromExecutable = true;
 
   int cliProcessTimeoutInMs = 5000;
   QProcess cli;
   QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
   env.insert("ITK_AUTOLOAD_PATH", "");
   cli.setProcessEnvironment(env);
-  cli.start(this->path(), QStringList(QString("--xml")));
+  // Descriptions can be retrieved from multiple threads, the working directory
+  // of the process is set instead of the current directory of the application.
+  cli.setWorkingDirectory(QFileInfo(executablePath).path());
+  cli.start(executablePath, QStringList(QString("--xml")));
   bool res = cli.waitForFinished(cliProcessTimeoutInMs);
   if (!res)
     {
-    this->appendInstantiateErrorString(QString("CLI executable: %1").arg(this->path()));
+    description.ErrorStrings << QString("CLI executable: %1").arg(executablePath);
     QString errorString;
     switch(cli.error())
       {
@@ -180,14 +128,14 @@ QString qSlicerCLIExecutableModuleFactoryItem::runCLIWithXmlArgument()
               "Failed to execute process. An unknown error occurred.");
         break;
       }
-    this->appendInstantiateErrorString(errorString);
-    return nullptr;
+    description.ErrorStrings << errorString;
+    return description;
     }
   QString errors = cli.readAllStandardError();
   if (!errors.isEmpty())
     {
-    this->appendInstantiateErrorString(QString("CLI executable: %1").arg(this->path()));
-    this->appendInstantiateErrorString(errors);
+    description.ErrorStrings << QString("CLI executable: %1").arg(executablePath);
+    description.ErrorStrings << errors;
     // TODO: More investigation for the following behavior:
     // on my machine (Ubuntu 10.04 with ITKv4), having standard error trims the
     // standard output results. The following readAllStandardOutput() is then
@@ -198,30 +146,69 @@ QString qSlicerCLIExecutableModuleFactoryItem::runCLIWithXmlArgument()
   QString xmlDescription = cli.readAllStandardOutput();
   if (xmlDescription.isEmpty())
     {
-    this->appendInstantiateErrorString(QString("CLI executable: %1").arg(this->path()));
-    this->appendInstantiateErrorString("Failed to retrieve Xml Description");
-    return QString();
+    description.ErrorStrings << QString("CLI executable: %1").arg(executablePath);
+    description.ErrorStrings << "Failed to retrieve Xml Description";
+    return description;
     }
   if (!xmlDescription.startsWith("<?xml"))
     {
-    this->appendInstantiateWarningString(QString("CLI executable: %1").arg(this->path()));
-    this->appendInstantiateWarningString(QLatin1String("XML description doesn't start right away."));
-    this->appendInstantiateWarningString(QString("Output before '<?xml' is [%1]").arg(
-                                           xmlDescription.mid(0, xmlDescription.indexOf("<?xml"))));
+    description.WarningStrings << QString("CLI executable: %1").arg(executablePath);
+    description.WarningStrings << QLatin1String("XML description doesn't start right away.");
+    description.WarningStrings << QString("Output before '<?xml' is [%1]").arg(
+                                    xmlDescription.mid(0, xmlDescription.indexOf("<?xml")));
     xmlDescription.remove(0, xmlDescription.indexOf("<?xml"));
     }
-  return xmlDescription;
+  description.XmlDescription = xmlDescription;
+  return description;
 }
 
 //-----------------------------------------------------------------------------
-void qSlicerCLIExecutableModuleFactoryItem::uninstantiate()
+qSlicerCLIXmlModuleDescription readXmlModuleDescription(const QString& executablePath)
 {
-  this->CLIModule->cliModuleLogic()->KillProcesses();
-  this->ctkAbstractFactoryFileBasedItem<qSlicerAbstractCoreModule>::uninstantiate();
+  QString xmlFilePath = xmlModuleDescriptionFilePath(executablePath);
+
+  //
+  // If the xml file exists, read it and associate it with the module
+  // description. If not, run the CLI executable with "--xml".
+  //
+  if (!QFile::exists(xmlFilePath))
+    {
+    return runCLIWithXmlArgument(executablePath);
+    }
+  qSlicerCLIXmlModuleDescription description;
+  QFile xmlFile(xmlFilePath);
+  if (xmlFile.open(QIODevice::ReadOnly))
+    {
+    description.XmlDescription = QTextStream(&xmlFile).readAll();
+    }
+  else
+    {
+    description.ErrorStrings << QString("CLI description: %1").arg(xmlFilePath);
+    description.ErrorStrings << "Failed to read Xml Description";
+    }
+  return description;
 }
 
 //-----------------------------------------------------------------------------
-// qSlicerCLIExecutableModuleFactoryPrivate
+class qSlicerCLIXmlModuleDescriptionReader : public QRunnable
+{
+public:
+  qSlicerCLIXmlModuleDescriptionReader(const QString& executablePath,
+                                       qSlicerCLIXmlModuleDescription* description)
+    : ExecutablePath(executablePath)
+    , Description(description)
+  {
+  }
+  void run() override
+  {
+    *this->Description = readXmlModuleDescription(this->ExecutablePath);
+  }
+protected:
+  QString ExecutablePath;
+  qSlicerCLIXmlModuleDescription* Description;
+};
+
+} // end of anonymous namespace
 
 //-----------------------------------------------------------------------------
 class qSlicerCLIExecutableModuleFactoryPrivate
@@ -233,15 +220,313 @@ public:
   typedef qSlicerCLIExecutableModuleFactoryPrivate Self;
   qSlicerCLIExecutableModuleFactoryPrivate(qSlicerCLIExecutableModuleFactory& object);
 
-private:
+  /// Return the XML description of the CLI \a executablePath.
+  /// The first call retrieves the descriptions of all the modules to prefetch.
+  qSlicerCLIXmlModuleDescription xmlModuleDescription(const QString& executablePath);
+
+  void prefetchXmlModuleDescriptions();
+  void readXmlModuleDescriptions(const QStringList& executablePaths);
+
+  /// Return the cached description of \a executablePath or an empty string
+  /// if the executable is not in the cache or has changed since.
+  QString cachedXmlModuleDescription(const QString& executablePath)const;
+  void readCache();
+  void writeCache();
+
+  struct CachedXmlModuleDescription
+  {
+    CachedXmlModuleDescription() : LastModified(0), Size(0) {}
+    qint64 LastModified;
+    qint64 Size;
+    QString XmlDescription;
+  };
+
   QString TempDirectory;
+  QString CacheFilePath;
+  bool CacheRead;
+  QHash<QString, CachedXmlModuleDescription> Cache;
+  QStringList ModuleNamesToPrefetch;
+  bool XmlModuleDescriptionsPrefetched;
+  QHash<QString, qSlicerCLIXmlModuleDescription> PrefetchedXmlModuleDescriptions;
 };
 
+//-----------------------------------------------------------------------------
+qSlicerCLIExecutableModuleFactoryItem::qSlicerCLIExecutableModuleFactoryItem(
+  const QString& newTempDirectory, qSlicerCLIExecutableModuleFactory* factory)
+  : TempDirectory(newTempDirectory)
+  , CLIModule(nullptr)
+  , Factory(factory)
+{
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerCLIExecutableModuleFactoryItem::load()
+{
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+QString qSlicerCLIExecutableModuleFactoryItem::xmlModuleDescriptionFilePath()
+{
+  return ::xmlModuleDescriptionFilePath(this->path());
+}
+
+//-----------------------------------------------------------------------------
+qSlicerAbstractCoreModule* qSlicerCLIExecutableModuleFactoryItem::instanciator()
+{
+  // Using a scoped pointer ensures the memory will be cleaned if instantiator
+  // fails before returning the module. See QScopedPointer::take()
+  QScopedPointer<qSlicerCLIModule> module(new qSlicerCLIModule());
+  module->setModuleType("CommandLineModule");
+  module->setEntryPoint(this->path());
+
+  // Identify CLI-only .py scripts by `#!` first line
+  // then set up interpreter path in SEM module `Location` parameter.
+  if (QFileInfo(this->path()).suffix().toLower() == "py")
+    {
+      QString python_path = findPython();
+      if (python_path.isEmpty())
+        {
+        this->appendInstantiateErrorString(
+          QString("Failed to find python interpreter for CLI: %1").arg(this->path()));
+        return nullptr;
+        }
+
+      module->setEntryPoint("python");
+      module->moduleDescription().SetLocation(python_path.toStdString());
+      module->moduleDescription().SetTarget(this->path().toStdString());
+    }
+
+  qSlicerCLIXmlModuleDescription description = this->Factory ?
+    this->Factory->d_func()->xmlModuleDescription(this->path()) :
+    readXmlModuleDescription(this->path());
+  foreach(const QString& errorString, description.ErrorStrings)
+    {
+    this->appendInstantiateErrorString(errorString);
+    }
+  foreach(const QString& warningString, description.WarningStrings)
+    {
+    this->appendInstantiateWarningString(warningString);
+    }
+  QString xmlDescription = description.XmlDescription;
+  if (xmlDescription.isEmpty())
+    {
+    return nullptr;
+    }
+
+  module->setXmlModuleDescription(xmlDescription.toUtf8());
+  module->setTempDirectory(this->TempDirectory);
+  module->setPath(this->path());
+  module->setInstalled(qSlicerCLIModuleFactoryHelper::isInstalled(this->path()));
+  module->setBuiltIn(qSlicerCLIModuleFactoryHelper::isBuiltIn(this->path()));
+
+  this->CLIModule = module.data();
+
+  return module.take();
+}
+
+//-----------------------------------------------------------------------------
+QString qSlicerCLIExecutableModuleFactoryItem::runCLIWithXmlArgument()
+{
+  qSlicerCLIXmlModuleDescription description = ::runCLIWithXmlArgument(this->path());
+  foreach(const QString& errorString, description.ErrorStrings)
+    {
+    this->appendInstantiateErrorString(errorString);
+    }
+  foreach(const QString& warningString, description.WarningStrings)
+    {
+    this->appendInstantiateWarningString(warningString);
+    }
+  return description.XmlDescription;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCLIExecutableModuleFactoryItem::uninstantiate()
+{
+  this->CLIModule->cliModuleLogic()->KillProcesses();
+  this->ctkAbstractFactoryFileBasedItem<qSlicerAbstractCoreModule>::uninstantiate();
+}
+
+//-----------------------------------------------------------------------------
+// qSlicerCLIExecutableModuleFactoryPrivate
+
 //-----------------------------------------------------------------------------
 qSlicerCLIExecutableModuleFactoryPrivate::qSlicerCLIExecutableModuleFactoryPrivate(qSlicerCLIExecutableModuleFactory& object)
 :q_ptr(&object)
 {
   this->TempDirectory = QDir::tempPath();
+  this->XmlModuleDescriptionsPrefetched = false;
+  this->CacheRead = false;
+}
+
+//-----------------------------------------------------------------------------
+qSlicerCLIXmlModuleDescription qSlicerCLIExecutableModuleFactoryPrivate
+::xmlModuleDescription(const QString& executablePath)
+{
+  if (!this->XmlModuleDescriptionsPrefetched)
+    {
+    this->prefetchXmlModuleDescriptions();
+    }
+  if (this->PrefetchedXmlModuleDescriptions.contains(executablePath))
+    {
+    return this->PrefetchedXmlModuleDescriptions.take(executablePath);
+    }
+  // Module not prefetched or instantiated again
+  QStringList executablePaths;
+  executablePaths << executablePath;
+  this->readXmlModuleDescriptions(executablePaths);
+  return this->PrefetchedXmlModuleDescriptions.take(executablePath);
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCLIExecutableModuleFactoryPrivate::prefetchXmlModuleDescriptions()
+{
+  Q_Q(qSlicerCLIExecutableModuleFactory);
+  this->XmlModuleDescriptionsPrefetched = true;
+  QStringList executablePaths;
+  foreach(const QString& key, this->ModuleNamesToPrefetch)
+    {
+    ctkAbstractFactoryFileBasedItem<qSlicerAbstractCoreModule>* item =
+      dynamic_cast<ctkAbstractFactoryFileBasedItem<qSlicerAbstractCoreModule>*>(q->item(key));
+    if (item)
+      {
+      executablePaths << item->path();
+      }
+    }
+  this->readXmlModuleDescriptions(executablePaths);
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCLIExecutableModuleFactoryPrivate::readXmlModuleDescriptions(const QStringList& executablePaths)
+{
+  this->readCache();
+
+  // Descriptions found in the cache don't require to run the executable.
+  QStringList executablePathsToRead;
+  foreach(const QString& executablePath, executablePaths)
+    {
+    if (!QFile::exists(::xmlModuleDescriptionFilePath(executablePath)))
+      {
+      QString cachedXmlDescription = this->cachedXmlModuleDescription(executablePath);
+      if (!cachedXmlDescription.isEmpty())
+        {
+        qSlicerCLIXmlModuleDescription description;
+        description.XmlDescription = cachedXmlDescription;
+        this->PrefetchedXmlModuleDescriptions[executablePath] = description;
+        continue;
+        }
+      }
+    executablePathsToRead << executablePath;
+    }
+  if (executablePathsToRead.isEmpty())
+    {
+    return;
+    }
+
+  // Each description is retrieved by running an executable, run them in parallel.
+  QVector<qSlicerCLIXmlModuleDescription> descriptions(executablePathsToRead.count());
+  QThreadPool threadPool;
+  threadPool.setMaxThreadCount(QThread::idealThreadCount());
+  for (int i = 0; i < executablePathsToRead.count(); ++i)
+    {
+    threadPool.start(new qSlicerCLIXmlModuleDescriptionReader(
+      executablePathsToRead[i], &descriptions[i]));
+    }
+  threadPool.waitForDone();
+
+  bool cacheModified = false;
+  for (int i = 0; i < executablePathsToRead.count(); ++i)
+    {
+    const qSlicerCLIXmlModuleDescription& description = descriptions[i];
+    this->PrefetchedXmlModuleDescriptions[executablePathsToRead[i]] = description;
+    if (description.RetrievedFromExecutable &&
+        description.ErrorStrings.isEmpty() &&
+        !description.XmlDescription.isEmpty() &&
+        !this->CacheFilePath.isEmpty())
+      {
+      QFileInfo executableInfo(executablePathsToRead[i]);
+      CachedXmlModuleDescription& cachedDescription = this->Cache[executableInfo.absoluteFilePath()];
+      cachedDescription.LastModified = executableInfo.lastModified().toMSecsSinceEpoch();
+      cachedDescription.Size = executableInfo.size();
+      cachedDescription.XmlDescription = description.XmlDescription;
+      cacheModified = true;
+      }
+    }
+  if (cacheModified)
+    {
+    this->writeCache();
+    }
+}
+
+//-----------------------------------------------------------------------------
+QString qSlicerCLIExecutableModuleFactoryPrivate::cachedXmlModuleDescription(const QString& executablePath)const
+{
+  QFileInfo executableInfo(executablePath);
+  QHash<QString, CachedXmlModuleDescription>::const_iterator it =
+    this->Cache.constFind(executableInfo.absoluteFilePath());
+  if (it == this->Cache.constEnd() ||
+      it->LastModified != executableInfo.lastModified().toMSecsSinceEpoch() ||
+      it->Size != executableInfo.size())
+    {
+    return QString();
+    }
+  return it->XmlDescription;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCLIExecutableModuleFactoryPrivate::readCache()
+{
+  if (this->CacheRead || this->CacheFilePath.isEmpty())
+    {
+    return;
+    }
+  this->CacheRead = true;
+  this->Cache.clear();
+  QSettings settings(this->CacheFilePath, QSettings::IniFormat);
+  int size = settings.beginReadArray("Modules");
+  for (int i = 0; i < size; ++i)
+    {
+    settings.setArrayIndex(i);
+    CachedXmlModuleDescription& cachedDescription = this->Cache[settings.value("Path").toString()];
+    cachedDescription.LastModified = settings.value("LastModified").toLongLong();
+    cachedDescription.Size = settings.value("Size").toLongLong();
+    cachedDescription.XmlDescription = settings.value("XmlDescription").toString();
+    }
+  settings.endArray();
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCLIExecutableModuleFactoryPrivate::writeCache()
+{
+  if (this->CacheFilePath.isEmpty())
+    {
+    return;
+    }
+  QDir().mkpath(QFileInfo(this->CacheFilePath).absolutePath());
+  QSettings settings(this->CacheFilePath, QSettings::IniFormat);
+  settings.remove("Modules");
+  settings.beginWriteArray("Modules");
+  int index = 0;
+  QHash<QString, CachedXmlModuleDescription>::const_iterator it;
+  for (it = this->Cache.constBegin(); it != this->Cache.constEnd(); ++it)
+    {
+    // Forget executables that have been removed
+    if (!QFile::exists(it.key()))
+      {
+      continue;
+      }
+    settings.setArrayIndex(index++);
+    settings.setValue("Path", it.key());
+    settings.setValue("LastModified", it->LastModified);
+    settings.setValue("Size", it->Size);
+    settings.setValue("XmlDescription", it->XmlDescription);
+    }
+  settings.endArray();
+  settings.sync();
+  if (settings.status() != QSettings::NoError)
+    {
+    qWarning() << "Failed to write CLI module description cache" << this->CacheFilePath;
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -286,7 +571,7 @@ ctkAbstractFactoryItem<qSlicerAbstractCoreModule>* qSlicerCLIExecutableModuleFac
 ::createFactoryFileBasedItem()
 {
   Q_D(qSlicerCLIExecutableModuleFactory);
-  return new qSlicerCLIExecutableModuleFactoryItem(d->TempDirectory);
+  return new qSlicerCLIExecutableModuleFactoryItem(d->TempDirectory, this);
 }
 
 //-----------------------------------------------------------------------------
@@ -301,3 +586,33 @@ void qSlicerCLIExecutableModuleFactory::setTempDirectory(const QString& newTempD
   Q_D(qSlicerCLIExecutableModuleFactory);
   d->TempDirectory = newTempDirectory;
 }
+
+//-----------------------------------------------------------------------------
+void qSlicerCLIExecutableModuleFactory::setXmlModuleDescriptionCacheFilePath(const QString& filePath)
+{
+  Q_D(qSlicerCLIExecutableModuleFactory);
+  d->CacheFilePath = filePath;
+  d->CacheRead = false;
+}
+
+//-----------------------------------------------------------------------------
+QString qSlicerCLIExecutableModuleFactory::xmlModuleDescriptionCacheFilePath()const
+{
+  Q_D(const qSlicerCLIExecutableModuleFactory);
+  return d->CacheFilePath;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCLIExecutableModuleFactory::setModuleNamesToPrefetch(const QStringList& moduleNames)
+{
+  Q_D(qSlicerCLIExecutableModuleFactory);
+  d->ModuleNamesToPrefetch = moduleNames;
+  d->XmlModuleDescriptionsPrefetched = false;
+}
+
+//-----------------------------------------------------------------------------
+QStringList qSlicerCLIExecutableModuleFactory::moduleNamesToPrefetch()const
+{
+  Q_D(const qSlicerCLIExecutableModuleFactory);
+  return d->ModuleNamesToPrefetch;
+}
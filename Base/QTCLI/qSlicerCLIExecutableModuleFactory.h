@@ -24,6 +24,7 @@
 // SlicerQT includes
 #include "qSlicerAbstractCoreModule.h"
 #include "qSlicerBaseQTCLIExport.h"
+class qSlicerCLIExecutableModuleFactory;
 class qSlicerCLIModule;
 
 // CTK includes
@@ -35,7 +36,8 @@ class qSlicerCLIExecutableModuleFactoryItem
   : public ctkAbstractFactoryFileBasedItem<qSlicerAbstractCoreModule>
 {
 public:
-  qSlicerCLIExecutableModuleFactoryItem(const QString& newTempDirectory);
+  qSlicerCLIExecutableModuleFactoryItem(const QString& newTempDirectory,
+                                        qSlicerCLIExecutableModuleFactory* factory = nullptr);
   bool load() override;
   void uninstantiate() override;
 protected:
@@ -47,6 +49,7 @@ protected:
 private:
   QString TempDirectory;
   qSlicerCLIModule* CLIModule;
+  qSlicerCLIExecutableModuleFactory* Factory;
 };
 
 class qSlicerCLIExecutableModuleFactoryPrivate;
@@ -71,6 +74,28 @@ public:
 
   void setTempDirectory(const QString& newTempDirectory);
 
+  /// Set the file where the XML descriptions retrieved by running the CLI
+  /// executables with "--xml" are cached between sessions.
+  /// Cached descriptions are only used if the path, size and modification
+  /// time of the executable did not change.
+  /// Caching is disabled if the path is empty (default).
+  /// Only the raw XML descriptions of CLI executables are cached: the
+  /// descriptions are still parsed at every startup, and loadable and
+  /// scripted modules are neither cached nor loaded in parallel.
+  void setXmlModuleDescriptionCacheFilePath(const QString& filePath);
+  QString xmlModuleDescriptionCacheFilePath()const;
+
+  /// Set the names of the modules whose XML descriptions are retrieved all
+  /// at once, using one thread per processor core, when the first module is
+  /// instantiated.
+  /// Only modules that are going to be instantiated should be listed: items
+  /// of this factory superseded by a factory with a higher priority are not.
+  /// Descriptions of the other modules are retrieved when they are
+  /// instantiated. Empty by default.
+  /// \sa qSlicerAbstractModuleFactoryManager::registeredModuleNames()
+  void setModuleNamesToPrefetch(const QStringList& moduleNames);
+  QStringList moduleNamesToPrefetch()const;
+
 protected:
   bool isValidFile(const QFileInfo& file)const override;
 
@@ -84,6 +109,7 @@ protected:
 private:
   Q_DECLARE_PRIVATE(qSlicerCLIExecutableModuleFactory);
   Q_DISABLE_COPY(qSlicerCLIExecutableModuleFactory);
+  friend class qSlicerCLIExecutableModuleFactoryItem;
 };
 
 #endif
@@ -105,6 +105,11 @@ vtkMRMLAbstractLogic* qSlicerCLIModule::createLogic()
     logic->SetAllowInMemoryTransfer(0);
     }
 
+  if (d->Desc.GetParameterValue("AllowSharedMemoryTransfer") == "false")
+    {
+    logic->SetAllowSharedMemoryTransfer(0);
+    }
+
   return logic;
 }
 
@@ -11,6 +11,7 @@
 =========================================================================auto=*/
 
 #include "vtkSlicerCLIModuleLogic.h"
+#include "vtkSlicerCLISharedMemory.h"
 
 #include "vtkSlicerTask.h"
 
@@ -30,14 +31,17 @@
 #include <vtkMRMLStorageNode.h>
 #include <vtkMRMLModelStorageNode.h>
 #include <vtkMRMLTransformNode.h>
+#include <vtkMRMLVolumeNode.h>
 
 // VTK includes
 #include <vtkCallbackCommand.h>
+#include <vtkImageData.h>
 #include <vtkIntArray.h>
 #include <vtkMultiThreader.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkStringArray.h>
+#include <vtksys/Directory.hxx>
 #include <vtksys/SystemTools.hxx>
 
 // ITKSYS includes
@@ -55,12 +59,18 @@
 // STL includes
 #include <algorithm>
 #include <cassert>
+#include <cstdlib>
 #include <ctime>
 #include <mutex>
 #include <set>
 
 #ifdef _WIN32
 #else
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
 #include <sys/types.h>
 #include <unistd.h>
 #endif
@@ -79,6 +89,20 @@ struct DigitsToCharacters
     }
 };
 
+//----------------------------------------------------------------------------
+struct CharactersToDigits
+{
+  char operator() (char in)
+    {
+      if (in >= 65 && in <= 74)
+        {
+        return in - 17;
+        }
+
+      return in;
+    }
+};
+
 typedef std::pair<vtkSlicerCLIModuleLogic *, vtkMRMLCommandLineModuleNode *> LogicNodePair;
 class MRMLIDMap : public std::map<std::string, std::string> {};
 
@@ -199,6 +223,7 @@ public:
   ModuleDescription DefaultModuleDescription;
   int DeleteTemporaryFiles;
   int AllowInMemoryTransfer;
+  int AllowSharedMemoryTransfer;
 
   int RedirectModuleStreams;
 
@@ -300,6 +325,7 @@ vtkSlicerCLIModuleLogic::vtkSlicerCLIModuleLogic()
 
   this->Internal->DeleteTemporaryFiles = 1;
   this->Internal->AllowInMemoryTransfer = 1;
+  this->Internal->AllowSharedMemoryTransfer = 1;
   this->Internal->RedirectModuleStreams = 1;
   this->Internal->RescheduleCallback =
     vtkSmartPointer<vtkSlicerCLIRescheduleCallback>::New();
@@ -403,6 +429,161 @@ int vtkSlicerCLIModuleLogic::GetAllowInMemoryTransfer() const
   return this->Internal->AllowInMemoryTransfer;
 }
 
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::SetAllowSharedMemoryTransfer(int value)
+{
+  vtkDebugMacro(<< this->GetClassName() << " (" << this << "): setting AllowSharedMemoryTransfer to " << value);
+  if (this->Internal->AllowSharedMemoryTransfer != value)
+    {
+    this->Internal->AllowSharedMemoryTransfer = value;
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCLIModuleLogic::GetAllowSharedMemoryTransfer() const
+{
+  return this->Internal->AllowSharedMemoryTransfer;
+}
+
+//----------------------------------------------------------------------------
+std::string vtkSlicerCLIModuleLogic::GetSharedMemoryDirectory(const std::string& nodeID)
+{
+  if (!this->GetAllowSharedMemoryTransfer())
+    {
+    return std::string();
+    }
+#ifdef _WIN32
+  // No memory-backed file system is available, the temporary directory is used
+  (void)nodeID;
+  return std::string();
+#else
+  // POSIX shared memory objects are files in /dev/shm on Linux. Files written there
+  // are kept in memory, the executable reads and writes them without any disk access.
+  const std::string sharedMemoryDirectory = vtkSlicerCLISharedMemory::GetUserDirectory();
+  if (sharedMemoryDirectory.empty())
+    {
+    return std::string();
+    }
+  // /dev/shm is writable by all users: images are only written into a directory
+  // that the current user has created and that other users cannot access.
+  if (mkdir(sharedMemoryDirectory.c_str(), S_IRWXU) != 0 && errno != EEXIST)
+    {
+    return std::string();
+    }
+  struct stat directoryStatus;
+  if (lstat(sharedMemoryDirectory.c_str(), &directoryStatus) != 0
+    || !S_ISDIR(directoryStatus.st_mode)
+    || directoryStatus.st_uid != getuid()
+    || (directoryStatus.st_mode & (S_IRWXG | S_IRWXO)) != 0)
+    {
+    vtkWarningMacro("GetSharedMemoryDirectory: " << sharedMemoryDirectory
+      << " is not a private directory of the current user, using temporary directory");
+    return std::string();
+    }
+
+  // Shared memory is limited (typically to half of the physical memory), make sure
+  // that the image fits (the output is usually about the same size as the input).
+  struct statvfs sharedMemoryStatus;
+  if (statvfs(sharedMemoryDirectory.c_str(), &sharedMemoryStatus) != 0)
+    {
+    return std::string();
+    }
+  double freeSpaceKiB = static_cast<double>(sharedMemoryStatus.f_bavail) * sharedMemoryStatus.f_frsize / 1024.0;
+  double requiredSpaceKiB = 64 * 1024.0;
+  vtkMRMLVolumeNode* volumeNode = vtkMRMLVolumeNode::SafeDownCast(
+    this->GetMRMLScene() ? this->GetMRMLScene()->GetNodeByID(nodeID.c_str()) : nullptr);
+  if (volumeNode && volumeNode->GetImageData())
+    {
+    requiredSpaceKiB += 2.0 * volumeNode->GetImageData()->GetActualMemorySize();
+    }
+  if (freeSpaceKiB < requiredSpaceKiB)
+    {
+    vtkDebugMacro("GetSharedMemoryDirectory: not enough shared memory for node " << nodeID
+      << ", using temporary directory");
+    return std::string();
+    }
+  return sharedMemoryDirectory;
+#endif
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCLIModuleLogic::CreateSharedMemoryFile(const std::string& fileName)
+{
+#ifdef _WIN32
+  (void)fileName;
+  return false;
+#else
+  // The file is created here, readable and writable by the owner only, so that
+  // Slicer and the executable write into a file that no other user can read.
+  // O_EXCL makes sure that an existing file (or symbolic link) is not reused.
+  int fileDescriptor = open(fileName.c_str(), O_WRONLY | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+  if (fileDescriptor < 0)
+    {
+    vtkDebugMacro("CreateSharedMemoryFile: cannot create " << fileName << ", using temporary directory");
+    return false;
+    }
+  close(fileDescriptor);
+  return true;
+#endif
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCLIModuleLogic::RemoveStaleSharedMemoryFiles()
+{
+#ifdef _WIN32
+  return 0;
+#else
+  // Only files of the current user are removed
+  const std::string sharedMemoryDirectory = vtkSlicerCLISharedMemory::GetUserDirectory();
+  struct stat directoryStatus;
+  if (sharedMemoryDirectory.empty()
+    || lstat(sharedMemoryDirectory.c_str(), &directoryStatus) != 0
+    || !S_ISDIR(directoryStatus.st_mode)
+    || directoryStatus.st_uid != getuid())
+    {
+    return 0;
+    }
+  vtksys::Directory directory;
+  if (sharedMemoryDirectory.empty() || !directory.Load(sharedMemoryDirectory))
+    {
+    return 0;
+    }
+  const std::string prefix = vtkSlicerCLISharedMemory::GetFileNamePrefix();
+  int numberOfRemovedFiles = 0;
+  for (unsigned long fileIndex = 0; fileIndex < directory.GetNumberOfFiles(); ++fileIndex)
+    {
+    std::string fileName = directory.GetFile(fileIndex);
+    if (fileName.compare(0, prefix.size(), prefix) != 0)
+      {
+      continue;
+      }
+    // The prefix is followed by the process id, encoded by DigitsToCharacters
+    std::string::size_type separator = fileName.find('_', prefix.size());
+    if (separator == std::string::npos || separator == prefix.size())
+      {
+      continue;
+      }
+    std::string pid = fileName.substr(prefix.size(), separator - prefix.size());
+    if (pid.find_first_not_of("ABCDEFGHIJ") != std::string::npos)
+      {
+      continue;
+      }
+    std::transform(pid.begin(), pid.end(), pid.begin(), CharactersToDigits());
+    pid_t processId = static_cast<pid_t>(atol(pid.c_str()));
+    if (processId == getpid() || kill(processId, 0) == 0 || errno != ESRCH)
+      {
+      // the process is running (or it cannot be checked)
+      continue;
+      }
+    if (vtksys::SystemTools::RemoveFile(sharedMemoryDirectory + "/" + fileName))
+      {
+      ++numberOfRemovedFiles;
+      }
+    }
+  return numberOfRemovedFiles;
+#endif
+}
+
 //----------------------------------------------------------------------------
 void vtkSlicerCLIModuleLogic::RedirectModuleStreamsOn()
 {
@@ -558,12 +739,28 @@ vtkSlicerCLIModuleLogic
       {
       // If running an executable
 
-      // Use default fname construction, tack on extension
+      // Use default fname construction, tack on extension.
+      // Images are exchanged through shared memory if possible.
+      std::string sharedMemoryDirectory;
+      if (commandType == CommandLineModule)
+        {
+        sharedMemoryDirectory = this->GetSharedMemoryDirectory(name);
+        }
       std::string ext = ".nrrd";
       if (extensions.size() != 0)
         {
         ext = extensions[0];
         }
+      if (!sharedMemoryDirectory.empty())
+        {
+        std::string sharedMemoryFileName = sharedMemoryDirectory + "/" + vtkSlicerCLISharedMemory::GetFileNamePrefix()
+          + vtksys::SystemTools::GetFilenameName(fname) + ext;
+        if (this->CreateSharedMemoryFile(sharedMemoryFileName))
+          {
+          fname = sharedMemoryFileName;
+          ext.clear();
+          }
+        }
       fname = fname + ext;
       }
     else
@@ -91,6 +91,19 @@ public:
   void SetAllowInMemoryTransfer(int value);
   int GetAllowInMemoryTransfer() const;
 
+  /// Control use of shared memory (memory-backed files, e.g. /dev/shm on Linux) for
+  /// exchanging images with executable CLIs. If shared memory is not available or does
+  /// not have enough free space then files in the temporary directory are used. On by default.
+  void SetAllowSharedMemoryTransfer(int value);
+  int GetAllowSharedMemoryTransfer() const;
+
+  /// Remove files from the shared memory directory of the current user that were
+  /// written by Slicer processes that are no longer running (e.g., because they crashed while an
+  /// executable CLI was running). Called once at application startup.
+  /// \return Number of removed files
+  /// \sa vtkSlicerCLISharedMemory
+  static int RemoveStaleSharedMemoryFiles();
+
   /// For debugging, control redirection of cout and cerr
   virtual void RedirectModuleStreamsOn();
   virtual void RedirectModuleStreamsOff();
@@ -140,6 +153,12 @@ protected:
                                      const std::vector<std::string>& extensions,
                                      CommandLineModuleType commandType);
   std::string ConstructTemporarySceneFileName(vtkMRMLScene *scene);
+  /// Return the directory where images can be exchanged with executable CLIs
+  /// through shared memory, or an empty string if it cannot hold the node's image.
+  std::string GetSharedMemoryDirectory(const std::string& nodeID);
+  /// Create an empty file that only the current user can read and write.
+  /// Returns false if the file cannot be created or already exists.
+  bool CreateSharedMemoryFile(const std::string& fileName);
   std::string FindHiddenNodeID(const ModuleDescription& d,
                                const ModuleParameter& p);
 
@@ -20,6 +20,7 @@
 
 // Qt includes
 #include <QDir>
+#include <QElapsedTimer>
 
 // SlicerQt includes
 #include "qSlicerCoreApplication.h"
@@ -27,6 +28,7 @@
 #include "qSlicerAbstractCoreModule.h"
 
 // STD includes
+#include <algorithm>
 #include <csignal>
 #include <typeinfo>
 
@@ -59,6 +61,7 @@ public:
   QMap<qSlicerModuleFactory*, int> Factories;
   QMap<QString, qSlicerModuleFactory*> RegisteredModules;
   QMap<QString, QStringList> ModuleDependees;
+  QMap<QString, qint64> ModuleInstantiationTimes;
 
   bool Verbose;
 };
@@ -371,10 +374,18 @@ void qSlicerAbstractModuleFactoryManager::registerModule(const QFileInfo& file)
 void qSlicerAbstractModuleFactoryManager::instantiateModules()
 {
   Q_D(qSlicerAbstractModuleFactoryManager);
+  QElapsedTimer timer;
+  timer.start();
   foreach (const QString& moduleName, d->RegisteredModules.keys())
     {
     this->instantiateModule(moduleName);
     }
+  if (d->Verbose)
+    {
+    qDebug() << "Instantiated" << this->instantiatedModuleNames().count()
+             << "modules in" << timer.elapsed() << "ms";
+    this->printModuleInstantiationTimes();
+    }
 
   // XXX See issue #3804
   // Python maps SIGINT (control-c) to its own handler.  We will remap it
@@ -400,7 +411,10 @@ qSlicerAbstractCoreModule* qSlicerAbstractModuleFactoryManager
     qCritical() << "Fail to instantiate module " << moduleName << " (not registered)";
     return nullptr;
     }
+  QElapsedTimer timer;
+  timer.start();
   qSlicerAbstractCoreModule* module = factory->instantiate(moduleName);
+  d->ModuleInstantiationTimes[moduleName] = timer.elapsed();
   if (!module)
     {
     qCritical() << "Fail to instantiate module " << moduleName;
@@ -424,6 +438,35 @@ qSlicerAbstractCoreModule* qSlicerAbstractModuleFactoryManager
   return module;
 }
 
+//-----------------------------------------------------------------------------
+qint64 qSlicerAbstractModuleFactoryManager::moduleInstantiationTime(const QString& moduleName)const
+{
+  Q_D(const qSlicerAbstractModuleFactoryManager);
+  return d->ModuleInstantiationTimes.value(moduleName, -1);
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerAbstractModuleFactoryManager::printModuleInstantiationTimes()const
+{
+  Q_D(const qSlicerAbstractModuleFactoryManager);
+  QList<QPair<qint64, QString> > times;
+  QMap<QString, qint64>::const_iterator it;
+  for (it = d->ModuleInstantiationTimes.constBegin(); it != d->ModuleInstantiationTimes.constEnd(); ++it)
+    {
+    times << qMakePair(it.value(), it.key());
+    }
+  // Slowest modules first
+  std::sort(times.begin(), times.end(), [](const QPair<qint64, QString>& a, const QPair<qint64, QString>& b)
+    {
+    return a.first > b.first || (a.first == b.first && a.second < b.second);
+    });
+  qDebug() << "Module instantiation times:";
+  for (int i = 0; i < times.count(); ++i)
+    {
+    qDebug() << "\t" << qPrintable(times[i].second) << ":" << times[i].first << "ms";
+    }
+}
+
 //-----------------------------------------------------------------------------
 QStringList qSlicerAbstractModuleFactoryManager::registeredModuleNames() const
 {
@@ -431,6 +474,13 @@ QStringList qSlicerAbstractModuleFactoryManager::registeredModuleNames() const
   return d->RegisteredModules.keys();
 }
 
+//-----------------------------------------------------------------------------
+QStringList qSlicerAbstractModuleFactoryManager::registeredModuleNames(qSlicerModuleFactory* factory) const
+{
+  Q_D(const qSlicerAbstractModuleFactoryManager);
+  return d->RegisteredModules.keys(factory);
+}
+
 //-----------------------------------------------------------------------------
 QStringList qSlicerAbstractModuleFactoryManager::instantiatedModuleNames() const
 {
@@ -165,6 +165,11 @@ public:
   /// Convenient method returning the list of all registered module names
   Q_INVOKABLE QStringList registeredModuleNames() const;
 
+  /// Return the names of the modules registered by \a factory.
+  /// Modules that \a factory can instantiate but that are registered by a
+  /// factory with a higher priority are not listed.
+  QStringList registeredModuleNames(qSlicerModuleFactory* factory) const;
+
   /// Return true if a module has been registered, false otherwise
   Q_INVOKABLE bool isRegistered(const QString& name)const;
 
@@ -180,6 +185,17 @@ public:
   /// Return the instance of a module if already instantiated, 0 otherwise
   Q_INVOKABLE qSlicerAbstractCoreModule* moduleInstance(const QString& moduleName)const;
 
+  /// Return the time in milliseconds spent in the last instantiation of the
+  /// module, or -1 if the instantiation of the module was never attempted.
+  /// \sa printModuleInstantiationTimes()
+  Q_INVOKABLE qint64 moduleInstantiationTime(const QString& moduleName)const;
+
+  /// Print the instantiation time of each module using qDebug(), slowest
+  /// modules first. The report is printed after instantiateModules() if
+  /// verbose module discovery is enabled.
+  /// \sa moduleInstantiationTime(), setVerboseModuleDiscovery()
+  Q_INVOKABLE void printModuleInstantiationTimes()const;
+
   /// Uninstantiate all instantiated modules
   void uninstantiateModules();
 
@@ -86,6 +86,7 @@
 
 // MRML includes
 #include <vtkCacheManager.h>
+#include <vtkEventBroker.h>
 #include <vtkMRMLCrosshairNode.h>
 #ifdef Slicer_BUILD_CLI_SUPPORT
 # include <vtkMRMLCommandLineModuleNode.h>
@@ -407,6 +408,27 @@ void qSlicerCoreApplicationPrivate::init()
     qSlicerCoreApplication::loadLanguage();
     }
 
+  // Optionally merge repeated MRML events (for example, a node modified many
+  // times while dragging a slider) into a single delivery. Pending events are
+  // delivered when a new event arrives after MaximumLatency or from the event
+  // loop at the same interval.
+  if (q->userSettings()->value("Developer/CoalesceMRMLEvents", false).toBool())
+    {
+    vtkEventBroker* broker = vtkEventBroker::GetInstance();
+    broker->SetEventModeToCoalescing();
+    QTimer* eventQueueTimer = new QTimer(q);
+    eventQueueTimer->setInterval(static_cast<int>(broker->GetMaximumLatency() * 1000.));
+    QObject::connect(eventQueueTimer, &QTimer::timeout, []()
+      {
+      vtkEventBroker* broker = vtkEventBroker::GetInstance();
+      if (broker->GetNumberOfQueuedObservations() > 0)
+        {
+        broker->ProcessEventQueue();
+        }
+      });
+    eventQueueTimer->start();
+    }
+
   q->connect(q, SIGNAL(aboutToQuit()), q, SLOT(onAboutToQuit()));
 }
 
@@ -0,0 +1,238 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkEventBroker.h"
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLModelNode.h"
+
+// VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkNew.h>
+
+// STD includes
+#include <string>
+#include <vector>
+
+namespace
+{
+
+int InvocationCount = 0;
+std::vector<std::string> InvocationOrder;
+vtkMRMLModelNode* NestedSubject = nullptr;
+
+//---------------------------------------------------------------------------
+void CountInvocationsCallback(vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(eid),
+                              void* vtkNotUsed(clientData), void* vtkNotUsed(callData))
+{
+  ++InvocationCount;
+}
+
+//---------------------------------------------------------------------------
+void OuterCallback(vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(eid),
+                   void* vtkNotUsed(clientData), void* vtkNotUsed(callData))
+{
+  InvocationOrder.push_back("outer begin");
+  NestedSubject->Modified();
+  InvocationOrder.push_back("outer end");
+}
+
+//---------------------------------------------------------------------------
+void NestedCallback(vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(eid),
+                    void* vtkNotUsed(clientData), void* vtkNotUsed(callData))
+{
+  InvocationOrder.push_back("nested");
+}
+
+//---------------------------------------------------------------------------
+// An observer modifies another observed subject while it is invoked.
+int TestNestedInvocation(vtkEventBroker* broker)
+{
+  vtkNew<vtkMRMLModelNode> outerSubject;
+  vtkNew<vtkMRMLModelNode> nestedSubject;
+  vtkNew<vtkMRMLModelNode> observer;
+  vtkNew<vtkCallbackCommand> outerCallback;
+  outerCallback->SetCallback(OuterCallback);
+  vtkNew<vtkCallbackCommand> nestedCallback;
+  nestedCallback->SetCallback(NestedCallback);
+  NestedSubject = nestedSubject.GetPointer();
+  broker->AddObservation(outerSubject.GetPointer(), vtkCommand::ModifiedEvent, observer.GetPointer(), outerCallback.GetPointer());
+  broker->AddObservation(nestedSubject.GetPointer(), vtkCommand::ModifiedEvent, observer.GetPointer(), nestedCallback.GetPointer());
+
+  std::vector<std::string> nestedFirst;
+  nestedFirst.push_back("outer begin");
+  nestedFirst.push_back("nested");
+  nestedFirst.push_back("outer end");
+  std::vector<std::string> nestedLast;
+  nestedLast.push_back("outer begin");
+  nestedLast.push_back("outer end");
+  nestedLast.push_back("nested");
+
+  // Synchronous: the nested event is delivered within the outer invocation
+  broker->SetEventModeToSynchronous();
+  InvocationOrder.clear();
+  outerSubject->Modified();
+  CHECK_BOOL(InvocationOrder == nestedFirst, true);
+
+  // Asynchronous: both events are queued and delivered in order by the same
+  // processing of the queue
+  broker->SetEventModeToAsynchronous();
+  InvocationOrder.clear();
+  outerSubject->Modified();
+  CHECK_BOOL(InvocationOrder.empty(), true);
+  broker->ProcessEventQueue();
+  CHECK_BOOL(InvocationOrder == nestedLast, true);
+  CHECK_INT(broker->GetNumberOfQueuedObservations(), 0);
+
+  // Coalescing with immediate flush: the outer event is delivered immediately,
+  // the nested event is delivered after the outer observer returns
+  broker->SetEventModeToCoalescing();
+  broker->SetMaximumLatency(-1.0);
+  InvocationOrder.clear();
+  outerSubject->Modified();
+  CHECK_BOOL(InvocationOrder == nestedLast, true);
+  CHECK_INT(broker->GetNumberOfQueuedObservations(), 0);
+
+  broker->SetEventModeToSynchronous();
+  broker->RemoveObservations(outerSubject.GetPointer(), observer.GetPointer());
+  broker->RemoveObservations(nestedSubject.GetPointer(), observer.GetPointer());
+  NestedSubject = nullptr;
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int TestEventBatch(vtkEventBroker* broker, vtkMRMLModelNode* subject)
+{
+  broker->SetEventModeToSynchronous();
+  broker->ResetEventCounters();
+  InvocationCount = 0;
+
+  // Outside of a batch, events are delivered immediately
+  subject->Modified();
+  CHECK_INT(InvocationCount, 1);
+  CHECK_INT(broker->GetNumberOfQueuedObservations(), 0);
+
+  // Inside a batch, events are merged and delivered at the end of the outermost batch
+  InvocationCount = 0;
+  broker->StartEventBatch();
+  {
+    MRMLEventBatchBlocker batch;
+    for (int i = 0; i < 200; ++i)
+      {
+      subject->Modified();
+      }
+    CHECK_INT(broker->GetEventBatchLevel(), 2);
+  }
+  CHECK_INT(InvocationCount, 0);
+  CHECK_INT(broker->GetNumberOfQueuedObservations(), 1);
+  broker->EndEventBatch();
+  CHECK_INT(InvocationCount, 1);
+  CHECK_INT(broker->GetNumberOfQueuedObservations(), 0);
+  CHECK_INT(broker->GetEventBatchLevel(), 0);
+
+  CHECK_INT(static_cast<int>(broker->GetNumberOfQueuedEvents()), 200);
+  CHECK_INT(static_cast<int>(broker->GetNumberOfCoalescedEvents()), 199);
+
+  // Batches have no effect in asynchronous mode
+  broker->SetEventModeToAsynchronous();
+  InvocationCount = 0;
+  broker->StartEventBatch();
+  subject->Modified();
+  broker->EndEventBatch();
+  CHECK_INT(InvocationCount, 0);
+  CHECK_INT(broker->GetNumberOfQueuedObservations(), 1);
+  broker->ProcessEventQueue();
+  CHECK_INT(InvocationCount, 1);
+
+  broker->SetEventModeToSynchronous();
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int TestCoalescing(vtkEventBroker* broker, vtkMRMLModelNode* subject)
+{
+  broker->SetEventModeToCoalescing();
+  broker->ResetEventCounters();
+  InvocationCount = 0;
+
+  // With a large latency events stay in the queue until it is processed
+  broker->SetMaximumLatency(1000.0);
+  for (int i = 0; i < 10; ++i)
+    {
+    subject->Modified();
+    }
+  CHECK_INT(InvocationCount, 0);
+  broker->ProcessEventQueue();
+  CHECK_INT(InvocationCount, 1);
+  CHECK_INT(static_cast<int>(broker->GetNumberOfCoalescedEvents()), 9);
+
+  // The end of the outermost batch processes the queue
+  broker->StartEventBatch();
+  subject->Modified();
+  subject->Modified();
+  broker->EndEventBatch();
+  CHECK_INT(InvocationCount, 2);
+
+  // With a negative latency the queue is flushed each time an event is queued
+  broker->SetMaximumLatency(-1.0);
+  subject->Modified();
+  subject->Modified();
+  CHECK_INT(InvocationCount, 4);
+
+  // but not inside a batch
+  broker->StartEventBatch();
+  subject->Modified();
+  subject->Modified();
+  CHECK_INT(InvocationCount, 4);
+  broker->EndEventBatch();
+  CHECK_INT(InvocationCount, 5);
+
+  // Changing mode delivers pending events
+  broker->SetMaximumLatency(1000.0);
+  subject->Modified();
+  CHECK_INT(InvocationCount, 5);
+  broker->SetEventModeToSynchronous();
+  CHECK_INT(InvocationCount, 6);
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkEventBrokerTest1(int , char * [] )
+{
+  vtkEventBroker* broker = vtkEventBroker::GetInstance();
+  CHECK_NOT_NULL(broker);
+
+  vtkNew<vtkMRMLModelNode> subject;
+  vtkNew<vtkMRMLModelNode> observer;
+  vtkNew<vtkCallbackCommand> callback;
+  callback->SetCallback(CountInvocationsCallback);
+  broker->AddObservation(subject.GetPointer(), vtkCommand::ModifiedEvent, observer.GetPointer(), callback.GetPointer());
+
+  // Synchronous mode: one invocation per event
+  broker->SetEventModeToSynchronous();
+  subject->Modified();
+  subject->Modified();
+  CHECK_INT(InvocationCount, 2);
+
+  CHECK_EXIT_SUCCESS(TestEventBatch(broker, subject.GetPointer()));
+  CHECK_EXIT_SUCCESS(TestCoalescing(broker, subject.GetPointer()));
+  CHECK_EXIT_SUCCESS(TestNestedInvocation(broker));
+
+  broker->SetEventModeToSynchronous();
+  broker->SetMaximumLatency(0.05);
+  broker->RemoveObservations(subject.GetPointer(), observer.GetPointer());
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,169 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLModelStorageNode.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLTableBinaryStorageNode.h"
+#include "vtkMRMLTableNode.h"
+
+// VTK includes
+#include <vtkCollection.h>
+#include <vtkDoubleArray.h>
+#include <vtkNew.h>
+#include <vtkPolyData.h>
+#include <vtkSphereSource.h>
+#include <vtkTable.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+// Create a scene with models and tables, each stored in a separate file
+int createBenchmarkScene(const std::string& tempDir, int numberOfNodes, const std::string& sceneFileName)
+{
+  vtkNew<vtkMRMLScene> scene;
+  scene->SetRootDirectory(tempDir.c_str());
+  for (int i = 0; i < numberOfNodes; ++i)
+    {
+    std::ostringstream modelFileName;
+    modelFileName << tempDir << "/vtkMRMLSceneParallelImportTest_model" << i << ".vtk";
+    vtkNew<vtkSphereSource> sphere;
+    sphere->SetThetaResolution(200 + i);
+    sphere->SetPhiResolution(200);
+    sphere->Update();
+    vtkMRMLModelNode* modelNode = vtkMRMLModelNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLModelNode"));
+    modelNode->SetAndObservePolyData(sphere->GetOutput());
+    vtkNew<vtkMRMLModelStorageNode> modelStorageNode;
+    scene->AddNode(modelStorageNode.GetPointer());
+    modelStorageNode->SetFileName(modelFileName.str().c_str());
+    modelNode->SetAndObserveStorageNodeID(modelStorageNode->GetID());
+    CHECK_INT(modelStorageNode->WriteData(modelNode), 1);
+
+    std::ostringstream tableFileName;
+    tableFileName << tempDir << "/vtkMRMLSceneParallelImportTest_table" << i << ".mtbl";
+    vtkNew<vtkDoubleArray> column;
+    column->SetName("values");
+    for (int row = 0; row < 100000 + i; ++row)
+      {
+      column->InsertNextValue(row * 0.1);
+      }
+    vtkMRMLTableNode* tableNode = vtkMRMLTableNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLTableNode"));
+    tableNode->AddColumn(column.GetPointer());
+    vtkNew<vtkMRMLTableBinaryStorageNode> tableStorageNode;
+    scene->AddNode(tableStorageNode.GetPointer());
+    tableStorageNode->SetFileName(tableFileName.str().c_str());
+    tableNode->SetAndObserveStorageNodeID(tableStorageNode->GetID());
+    CHECK_INT(tableStorageNode->WriteData(tableNode), 1);
+    }
+  scene->SetURL(sceneFileName.c_str());
+  CHECK_INT(scene->Commit(), 1);
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int importScene(vtkMRMLScene* scene, const std::string& sceneFileName, int numberOfThreads)
+{
+  scene->SetURL(sceneFileName.c_str());
+  scene->SetNumberOfDataReadingThreads(numberOfThreads);
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  CHECK_INT(scene->Import(), 1);
+  timer->StopTimer();
+  std::cout << "<DartMeasurement name=\"vtkMRMLSceneParallelImport-Threads" << numberOfThreads
+            << "\" type=\"numeric/double\">" << timer->GetElapsedTime() << "</DartMeasurement>" << std::endl;
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+// Measures importing a scene with many data files, reading files one at a time
+// and in parallel. Optional second argument sets the number of models and
+// tables (default: 20).
+int vtkMRMLSceneParallelImportTest(int argc, char * argv[])
+{
+  if (argc < 2)
+    {
+    std::cerr << "Usage: " << argv[0] << " /path/to/temp [numberOfNodes]" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::string tempDir = argv[1];
+  int numberOfNodes = (argc > 2 ? atoi(argv[2]) : 20);
+  std::string sceneFileName = tempDir + "/vtkMRMLSceneParallelImportTest.mrml";
+  CHECK_EXIT_SUCCESS(createBenchmarkScene(tempDir, numberOfNodes, sceneFileName));
+
+  vtkNew<vtkMRMLScene> serialScene;
+  // All processor cores are used by default
+  CHECK_INT(serialScene->GetNumberOfDataReadingThreads(), 0);
+  CHECK_EXIT_SUCCESS(importScene(serialScene.GetPointer(), sceneFileName, 1));
+  CHECK_INT(serialScene->GetLastImportNumberOfPrefetchedFiles(), 0);
+  vtkNew<vtkMRMLScene> parallelScene;
+  // Number of threads is set explicitly, so that the test does not depend on the number of cores
+  CHECK_EXIT_SUCCESS(importScene(parallelScene.GetPointer(), sceneFileName, 4));
+
+  // All data files are read in background threads
+  CHECK_INT(parallelScene->GetLastImportNumberOfPrefetchedFiles(), 2 * numberOfNodes);
+
+  // Same nodes are loaded, in the same order
+  CHECK_INT(parallelScene->GetNumberOfNodes(), serialScene->GetNumberOfNodes());
+  for (int i = 0; i < serialScene->GetNumberOfNodes(); ++i)
+    {
+    vtkMRMLNode* serialNode = serialScene->GetNthNode(i);
+    vtkMRMLNode* parallelNode = parallelScene->GetNthNode(i);
+    CHECK_STRING(parallelNode->GetID(), serialNode->GetID());
+    vtkMRMLModelNode* serialModelNode = vtkMRMLModelNode::SafeDownCast(serialNode);
+    if (serialModelNode)
+      {
+      vtkMRMLModelNode* parallelModelNode = vtkMRMLModelNode::SafeDownCast(parallelNode);
+      CHECK_NOT_NULL(parallelModelNode);
+      CHECK_NOT_NULL(parallelModelNode->GetPolyData());
+      CHECK_INT(parallelModelNode->GetPolyData()->GetNumberOfPoints(), serialModelNode->GetPolyData()->GetNumberOfPoints());
+      }
+    vtkMRMLTableNode* serialTableNode = vtkMRMLTableNode::SafeDownCast(serialNode);
+    if (serialTableNode)
+      {
+      vtkMRMLTableNode* parallelTableNode = vtkMRMLTableNode::SafeDownCast(parallelNode);
+      CHECK_NOT_NULL(parallelTableNode);
+      CHECK_INT(parallelTableNode->GetNumberOfRows(), serialTableNode->GetNumberOfRows());
+      CHECK_DOUBLE_TOLERANCE(parallelTableNode->GetTable()->GetValue(1000, 0).ToDouble(), 100.0, 1e-9);
+      }
+    }
+
+  // Reading time is reported for each file
+  std::vector<std::string> fileNames;
+  std::vector<double> readingTimes;
+  parallelScene->GetLastImportDataReadingTimes(fileNames, readingTimes);
+  CHECK_INT(static_cast<int>(fileNames.size()), 2 * numberOfNodes);
+  CHECK_INT(static_cast<int>(readingTimes.size()), 2 * numberOfNodes);
+  double totalReadingTime = 0.0;
+  for (size_t fileIndex = 0; fileIndex < fileNames.size(); ++fileIndex)
+    {
+    CHECK_BOOL(readingTimes[fileIndex] >= 0.0, true);
+    totalReadingTime += readingTimes[fileIndex];
+    }
+  std::cout << "Total time of reading " << fileNames.size() << " files: " << totalReadingTime << "s" << std::endl;
+
+  // Modified flags are the same as after a serial import
+  vtkNew<vtkCollection> modifiedNodes;
+  CHECK_BOOL(parallelScene->GetStorableNodesModifiedSinceRead(modifiedNodes.GetPointer()), false);
+
+  return EXIT_SUCCESS;
+}
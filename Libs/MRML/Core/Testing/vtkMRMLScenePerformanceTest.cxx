@@ -0,0 +1,212 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLLabelMapVolumeNode.h"
+#include "vtkMRMLLinearTransformNode.h"
+#include "vtkMRMLModelDisplayNode.h"
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLScalarVolumeNode.h"
+#include "vtkMRMLScene.h"
+
+// VTK includes
+#include <vtkCollection.h>
+#include <vtkNew.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+// Classes that are queried. Abstract classes are included to exercise the
+// class hierarchy lookup.
+const char* QueriedClassNames[] = {
+  "vtkMRMLModelNode",
+  "vtkMRMLScalarVolumeNode",
+  "vtkMRMLVolumeNode",
+  "vtkMRMLDisplayableNode",
+  "vtkMRMLTransformNode",
+  "vtkMRMLDisplayNode",
+  "vtkMRMLNode",
+  "vtkMRMLSegmentationNode" // not in the scene
+  };
+
+//---------------------------------------------------------------------------
+void populateScene(vtkMRMLScene* scene, int numberOfNodes)
+{
+  scene->StartState(vtkMRMLScene::BatchProcessState);
+  for (int i = 0; i < numberOfNodes; ++i)
+    {
+    switch (i % 5)
+      {
+      case 0: scene->AddNode(vtkSmartPointer<vtkMRMLModelNode>::New()); break;
+      case 1: scene->AddNode(vtkSmartPointer<vtkMRMLModelDisplayNode>::New()); break;
+      case 2: scene->AddNode(vtkSmartPointer<vtkMRMLScalarVolumeNode>::New()); break;
+      case 3: scene->AddNode(vtkSmartPointer<vtkMRMLLabelMapVolumeNode>::New()); break;
+      default: scene->AddNode(vtkSmartPointer<vtkMRMLLinearTransformNode>::New()); break;
+      }
+    }
+  scene->EndState(vtkMRMLScene::BatchProcessState);
+}
+
+//---------------------------------------------------------------------------
+// Compare indexed class queries with a full scan of the scene.
+bool checkClassQueries(vtkMRMLScene* scene)
+{
+  for (const char* className : QueriedClassNames)
+    {
+    std::vector<vtkMRMLNode*> expectedNodes;
+    for (int i = 0; i < scene->GetNumberOfNodes(); ++i)
+      {
+      vtkMRMLNode* node = scene->GetNthNode(i);
+      if (node->IsA(className))
+        {
+        expectedNodes.push_back(node);
+        }
+      }
+    std::vector<vtkMRMLNode*> nodes;
+    scene->GetNodesByClass(className, nodes);
+    if (nodes != expectedNodes
+      || scene->GetNumberOfNodesByClass(className) != static_cast<int>(expectedNodes.size())
+      || scene->GetFirstNodeByClass(className) != (expectedNodes.empty() ? nullptr : expectedNodes.front())
+      || scene->GetNthNodeByClass(static_cast<int>(expectedNodes.size()) / 2, className)
+        != (expectedNodes.empty() ? nullptr : expectedNodes[expectedNodes.size() / 2]))
+      {
+      std::cerr << "Class query mismatch for " << className << ": found "
+        << nodes.size() << " nodes instead of " << expectedNodes.size() << std::endl;
+      return false;
+      }
+    // Previous content of the vector is cleared
+    std::vector<vtkMRMLNode*> reusedNodes(1, nullptr);
+    if (scene->GetNodesByClass(className, reusedNodes) != static_cast<int>(expectedNodes.size())
+      || reusedNodes != expectedNodes)
+      {
+      std::cerr << "GetNodesByClass did not clear the vector before adding the nodes of " << className << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+int benchmark(int numberOfNodes)
+{
+  std::cout << "Number of nodes: " << numberOfNodes << std::endl;
+  vtkNew<vtkTimerLog> timer;
+
+  vtkNew<vtkMRMLScene> scene;
+  timer->StartTimer();
+  populateScene(scene.GetPointer(), numberOfNodes);
+  timer->StopTimer();
+  std::cout << "  AddNode: " << timer->GetElapsedTime() << "s" << std::endl;
+
+  scene->SetSaveToXMLString(1);
+  scene->Commit();
+  std::string xmlScene = scene->GetSceneXMLString();
+
+  vtkNew<vtkMRMLScene> importedScene;
+  importedScene->SetLoadFromXMLString(1);
+  importedScene->SetSceneXMLString(xmlScene);
+  timer->StartTimer();
+  importedScene->Import();
+  timer->StopTimer();
+  std::cout << "  Import: " << timer->GetElapsedTime() << "s" << std::endl;
+  CHECK_INT(importedScene->GetNumberOfNodes(), scene->GetNumberOfNodes());
+
+  const int numberOfQueries = 1000;
+  timer->StartTimer();
+  for (int i = 0; i < numberOfQueries; ++i)
+    {
+    importedScene->GetFirstNodeByClass(QueriedClassNames[i % 8]);
+    }
+  timer->StopTimer();
+  std::cout << "  GetFirstNodeByClass: " << timer->GetElapsedTime() / numberOfQueries * 1e6 << "us" << std::endl;
+
+  timer->StartTimer();
+  for (int i = 0; i < numberOfQueries; ++i)
+    {
+    vtkCollection* nodes = importedScene->GetNodesByClass(QueriedClassNames[i % 8]);
+    nodes->Delete();
+    }
+  timer->StopTimer();
+  std::cout << "  GetNodesByClass: " << timer->GetElapsedTime() / numberOfQueries * 1e6 << "us" << std::endl;
+
+  // Iterating with GetNthNodeByClass must not be quadratic
+  timer->StartTimer();
+  int numberOfModelNodes = importedScene->GetNumberOfNodesByClass("vtkMRMLModelNode");
+  for (int i = 0; i < numberOfModelNodes; ++i)
+    {
+    CHECK_NOT_NULL(importedScene->GetNthNodeByClass(i, "vtkMRMLModelNode"));
+    }
+  timer->StopTimer();
+  std::cout << "  GetNthNodeByClass loop: " << timer->GetElapsedTime() << "s" << std::endl;
+
+  // Same for abstract classes, which merge the nodes of several classes
+  timer->StartTimer();
+  int numberOfDisplayableNodes = importedScene->GetNumberOfNodesByClass("vtkMRMLDisplayableNode");
+  for (int i = 0; i < numberOfDisplayableNodes; ++i)
+    {
+    CHECK_NOT_NULL(importedScene->GetNthNodeByClass(i, "vtkMRMLDisplayableNode"));
+    }
+  timer->StopTimer();
+  std::cout << "  GetNthNodeByClass abstract class loop: " << timer->GetElapsedTime() << "s" << std::endl;
+
+  CHECK_BOOL(checkClassQueries(importedScene.GetPointer()), true);
+
+  // Removing nodes in the middle of the scene and inserting nodes out of
+  // order must keep the class queries in scene order.
+  for (int i = importedScene->GetNumberOfNodes() - 1; i >= 0; i -= 3)
+    {
+    importedScene->RemoveNode(importedScene->GetNthNode(i));
+    }
+  importedScene->InsertBeforeNode(importedScene->GetNthNode(2), vtkSmartPointer<vtkMRMLModelNode>::New());
+  importedScene->InsertAfterNode(importedScene->GetNthNode(1), vtkSmartPointer<vtkMRMLScalarVolumeNode>::New());
+  CHECK_BOOL(checkClassQueries(importedScene.GetPointer()), true);
+
+  timer->StartTimer();
+  importedScene->Clear(1);
+  timer->StopTimer();
+  std::cout << "  Clear: " << timer->GetElapsedTime() << "s" << std::endl;
+  CHECK_INT(importedScene->GetNumberOfNodesByClass("vtkMRMLNode"), 0);
+  CHECK_NULL(importedScene->GetFirstNodeByClass("vtkMRMLModelNode"));
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+// Measures scene import and class queries for increasing scene sizes.
+// Optional arguments set the number of nodes (default: 1000 10000).
+int vtkMRMLScenePerformanceTest(int argc, char * argv[])
+{
+  std::vector<int> numbersOfNodes;
+  for (int i = 1; i < argc; ++i)
+    {
+    numbersOfNodes.push_back(atoi(argv[i]));
+    }
+  if (numbersOfNodes.empty())
+    {
+    numbersOfNodes.push_back(1000);
+    numbersOfNodes.push_back(10000);
+    }
+  for (int numberOfNodes : numbersOfNodes)
+    {
+    CHECK_EXIT_SUCCESS(benchmark(numberOfNodes));
+    }
+  return EXIT_SUCCESS;
+}
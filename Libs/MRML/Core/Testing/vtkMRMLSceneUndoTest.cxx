@@ -0,0 +1,140 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLScalarVolumeNode.h"
+#include "vtkMRMLScene.h"
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+
+// STD includes
+#include <cstdlib>
+#include <string>
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+short getVoxel(vtkMRMLScene* scene, const std::string& nodeID)
+{
+  vtkMRMLScalarVolumeNode* volumeNode = vtkMRMLScalarVolumeNode::SafeDownCast(scene->GetNodeByID(nodeID));
+  if (!volumeNode || !volumeNode->GetImageData())
+    {
+    return -1;
+    }
+  return *static_cast<short*>(volumeNode->GetImageData()->GetScalarPointer(5, 5, 5));
+}
+
+//---------------------------------------------------------------------------
+void setVoxel(vtkMRMLScene* scene, const std::string& nodeID, short value)
+{
+  vtkMRMLScalarVolumeNode* volumeNode = vtkMRMLScalarVolumeNode::SafeDownCast(scene->GetNodeByID(nodeID));
+  vtkImageData* imageData = volumeNode->GetImageData();
+  *static_cast<short*>(imageData->GetScalarPointer(5, 5, 5)) = value;
+  imageData->Modified();
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkMRMLSceneUndoTest(int vtkNotUsed(argc), char * vtkNotUsed(argv)[])
+{
+  vtkNew<vtkMRMLScene> scene;
+  scene->SetUndoOn();
+
+  vtkNew<vtkImageData> imageData;
+  imageData->SetDimensions(64, 64, 64);
+  imageData->AllocateScalars(VTK_SHORT, 1);
+  imageData->GetPointData()->GetScalars()->Fill(10);
+  vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+  volumeNode->SetUndoEnabled(true);
+  volumeNode->SetName("Original");
+  volumeNode->SetAndObserveImageData(imageData.GetPointer());
+  scene->AddNode(volumeNode.GetPointer());
+  std::string volumeNodeID = volumeNode->GetID();
+
+  // Snapshot contains a copy of the image
+  scene->SaveStateForUndo();
+  vtkTypeInt64 imageMemorySize = scene->GetUndoStackMemorySize();
+  CHECK_BOOL(imageMemorySize >= 64 * 64 * 64 * 2, true);
+
+  // Unchanged node is not copied again
+  scene->SaveStateForUndo();
+  CHECK_INT(scene->GetNumberOfUndoLevels(), 2);
+  CHECK_BOOL(scene->GetUndoStackMemorySize() == imageMemorySize, true);
+
+  // Image is shared with the previous snapshot if only node properties are changed
+  volumeNode->SetName("Renamed");
+  scene->SaveStateForUndo();
+  CHECK_INT(scene->GetNumberOfUndoLevels(), 3);
+  CHECK_BOOL(scene->GetUndoStackMemorySize() == imageMemorySize, true);
+
+  // Modified image is copied
+  setVoxel(scene.GetPointer(), volumeNodeID, 20);
+  scene->SaveStateForUndo();
+  CHECK_INT(scene->GetNumberOfUndoLevels(), 4);
+  CHECK_BOOL(scene->GetUndoStackMemorySize() == 2 * imageMemorySize, true);
+  setVoxel(scene.GetPointer(), volumeNodeID, 30);
+
+  // Undo restores saved states
+  scene->Undo();
+  CHECK_INT(getVoxel(scene.GetPointer(), volumeNodeID), 20);
+  scene->Undo();
+  CHECK_INT(getVoxel(scene.GetPointer(), volumeNodeID), 10);
+  CHECK_STRING(volumeNode->GetName(), "Renamed");
+  scene->Undo();
+  CHECK_INT(getVoxel(scene.GetPointer(), volumeNodeID), 10);
+  CHECK_STRING(volumeNode->GetName(), "Original");
+  CHECK_INT(scene->GetNumberOfUndoLevels(), 1);
+
+  // Redo restores undone states
+  scene->Redo();
+  CHECK_STRING(volumeNode->GetName(), "Renamed");
+  scene->Redo();
+  CHECK_INT(getVoxel(scene.GetPointer(), volumeNodeID), 20);
+  scene->Redo();
+  CHECK_INT(getVoxel(scene.GetPointer(), volumeNodeID), 30);
+  CHECK_INT(scene->GetNumberOfRedoLevels(), 0);
+
+  // Oldest states are removed to fit in the memory budget
+  scene->SetMaximumUndoStackMemorySize(imageMemorySize * 3 / 2);
+  CHECK_BOOL(scene->GetUndoStackMemorySize() <= imageMemorySize * 3 / 2, true);
+  CHECK_BOOL(scene->GetNumberOfUndoLevels() >= 1, true);
+  scene->SaveStateForUndo();
+  CHECK_BOOL(scene->GetUndoStackMemorySize() <= imageMemorySize * 3 / 2, true);
+  scene->SetMaximumUndoStackMemorySize(0);
+
+  // Restored node does not share its image with saved states
+  scene->ClearUndoStack();
+  scene->SaveStateForUndo();
+  scene->RemoveNode(volumeNode.GetPointer());
+  CHECK_NULL(scene->GetNodeByID(volumeNodeID));
+  scene->Undo();
+  CHECK_NOT_NULL(scene->GetNodeByID(volumeNodeID));
+  CHECK_INT(getVoxel(scene.GetPointer(), volumeNodeID), 30);
+  setVoxel(scene.GetPointer(), volumeNodeID, 40);
+  scene->Redo();
+  CHECK_NULL(scene->GetNodeByID(volumeNodeID));
+  scene->Undo();
+  CHECK_INT(getVoxel(scene.GetPointer(), volumeNodeID), 40);
+
+  scene->ClearUndoStack();
+  scene->ClearRedoStack();
+  CHECK_BOOL(scene->GetUndoStackMemorySize() == 0, true);
+
+  return EXIT_SUCCESS;
+}
@@ -23,15 +23,124 @@ Care Ontario.
 #include "vtkMRMLScene.h"
 #include "vtkMRMLSegmentationNode.h"
 #include "vtkMRMLSegmentationStorageNode.h"
+#include "vtkOrientedImageData.h"
 #include "vtkSegmentationConverterFactory.h"
+#include "vtkSparseOrientedImageData.h"
 
 // Converter rules
 #include "vtkClosedSurfaceToBinaryLabelmapConversionRule.h"
 #include "vtkBinaryLabelmapToClosedSurfaceConversionRule.h"
+#include "vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule.h"
+#include "vtkSparseBinaryLabelmapToBinaryLabelmapConversionRule.h"
 
 #include "vtkFractionalLabelmapToClosedSurfaceConversionRule.h"
 #include "vtkClosedSurfaceToFractionalLabelmapConversionRule.h"
 
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+
+// STD includes
+#include <algorithm>
+#include <string>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkSparseOrientedImageData> createSparseLabelmap(const int boxExtent[6])
+{
+  vtkNew<vtkOrientedImageData> denseImage;
+  denseImage->SetExtent(0, 63, 0, 63, 0, 63);
+  denseImage->SetSpacing(0.5, 0.5, 1.0);
+  denseImage->SetOrigin(10.0, -20.0, 5.0);
+  denseImage->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  denseImage->GetPointData()->GetScalars()->Fill(0);
+  for (int k = boxExtent[4]; k <= boxExtent[5]; ++k)
+    {
+    for (int j = boxExtent[2]; j <= boxExtent[3]; ++j)
+      {
+      for (int i = boxExtent[0]; i <= boxExtent[1]; ++i)
+        {
+        *static_cast<unsigned char*>(denseImage->GetScalarPointer(i, j, k)) = 1;
+        }
+      }
+    }
+  vtkSmartPointer<vtkSparseOrientedImageData> sparseImage = vtkSmartPointer<vtkSparseOrientedImageData>::New();
+  sparseImage->SetFromImage(denseImage);
+  return sparseImage;
+}
+
+//----------------------------------------------------------------------------
+int countLabelVoxels(vtkOrientedImageData* image, int labelValue, int labelExtent[6])
+{
+  int extent[6] = { 0, -1, 0, -1, 0, -1 };
+  image->GetExtent(extent);
+  labelExtent[0] = labelExtent[2] = labelExtent[4] = VTK_INT_MAX;
+  labelExtent[1] = labelExtent[3] = labelExtent[5] = VTK_INT_MIN;
+  int numberOfVoxels = 0;
+  for (int k = extent[4]; k <= extent[5]; ++k)
+    {
+    for (int j = extent[2]; j <= extent[3]; ++j)
+      {
+      for (int i = extent[0]; i <= extent[1]; ++i)
+        {
+        if (static_cast<int>(image->GetScalarComponentAsDouble(i, j, k, 0)) != labelValue)
+          {
+          continue;
+          }
+        ++numberOfVoxels;
+        int ijk[3] = { i, j, k };
+        for (int axis = 0; axis < 3; ++axis)
+          {
+          labelExtent[axis * 2] = std::min(labelExtent[axis * 2], ijk[axis]);
+          labelExtent[axis * 2 + 1] = std::max(labelExtent[axis * 2 + 1], ijk[axis]);
+          }
+        }
+      }
+    }
+  return numberOfVoxels;
+}
+
+//----------------------------------------------------------------------------
+int compareSegmentLabelmaps(vtkMRMLSegmentationNode* expectedSegmentationNode, vtkMRMLSegmentationNode* segmentationNode)
+{
+  std::vector<std::string> segmentIDs;
+  expectedSegmentationNode->GetSegmentation()->GetSegmentIDs(segmentIDs);
+  CHECK_INT(segmentationNode->GetSegmentation()->GetNumberOfSegments(), static_cast<int>(segmentIDs.size()));
+  for (const std::string& segmentID : segmentIDs)
+    {
+    vtkOrientedImageData* expectedLabelmap = expectedSegmentationNode->GetBinaryLabelmapInternalRepresentation(segmentID);
+    vtkOrientedImageData* labelmap = segmentationNode->GetBinaryLabelmapInternalRepresentation(segmentID);
+    CHECK_NOT_NULL(expectedLabelmap);
+    CHECK_NOT_NULL(labelmap);
+    int expectedExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    int extent[6] = { 0, -1, 0, -1, 0, -1 };
+    expectedLabelmap->GetExtent(expectedExtent);
+    labelmap->GetExtent(extent);
+    for (int i = 0; i < 6; ++i)
+      {
+      CHECK_INT(extent[i], expectedExtent[i]);
+      }
+    CHECK_BOOL(expectedLabelmap->GetNumberOfPoints() > 0, true);
+    for (int k = extent[4]; k <= extent[5]; ++k)
+      {
+      for (int j = extent[2]; j <= extent[3]; ++j)
+        {
+        for (int i = extent[0]; i <= extent[1]; ++i)
+          {
+          CHECK_DOUBLE(labelmap->GetScalarComponentAsDouble(i, j, k, 0), expectedLabelmap->GetScalarComponentAsDouble(i, j, k, 0));
+          }
+        }
+      }
+    }
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
 int vtkMRMLSegmentationStorageNodeTest1(int argc, char * argv[] )
 {
   vtkNew<vtkMRMLSegmentationStorageNode> node1;
@@ -39,11 +148,12 @@ int vtkMRMLSegmentationStorageNodeTest1(int argc, char * argv[] )
   scene->AddNode(node1.GetPointer());
   EXERCISE_ALL_BASIC_MRML_METHODS(node1.GetPointer());
 
-  if (argc != 4)
+  if (argc != 5)
     {
     std::cerr << "Line " << __LINE__
               << " - Missing parameters !\n"
               << "Usage: " << argv[0] << " /path/to/ITKSnapSegmentation.nii.gz /path/to/OldSlicerSegmentation.seg.nrrd /path/to/SlicerSegmentation.seg.nrrd"
+              << " /path/to/temp"
               << std::endl;
     return EXIT_FAILURE;
     }
@@ -53,10 +163,13 @@ int vtkMRMLSegmentationStorageNodeTest1(int argc, char * argv[] )
   converterFactory->RegisterConverterRule(vtkSmartPointer<vtkBinaryLabelmapToClosedSurfaceConversionRule>::New());
   converterFactory->RegisterConverterRule(vtkSmartPointer<vtkFractionalLabelmapToClosedSurfaceConversionRule>::New());
   converterFactory->RegisterConverterRule(vtkSmartPointer<vtkClosedSurfaceToFractionalLabelmapConversionRule>::New());
+  converterFactory->RegisterConverterRule(vtkSmartPointer<vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule>::New());
+  converterFactory->RegisterConverterRule(vtkSmartPointer<vtkSparseBinaryLabelmapToBinaryLabelmapConversionRule>::New());
 
   const char* itkSnapSegmentationFilename = argv[1]; // ITKSnapSegmentation.nii.gz
   const char* oldSlicerSegmentationFilename = argv[2]; // OldSlicerSegmentation.seg.nrrd: Segmentation before shared labelmaps implemented.
   const char* slicerSegmentationFilename = argv[3]; // SlicerSegmentation.seg.nrrd: Segmentation with shared labelmaps.
+  const char* tempDir = argv[4];
 
   // Test segmentation exported from ITK-SNAP
   std::cout << "Testing ITK-SNAP segmentation" << std::endl;
@@ -114,5 +227,187 @@ int vtkMRMLSegmentationStorageNodeTest1(int argc, char * argv[] )
     CHECK_INT(numberOfLayers, 2);
   }
 
+  std::cout << "Testing reading header only" << std::endl;
+  {
+    // Reference: all voxels read when the file is read
+    vtkNew<vtkMRMLSegmentationNode> segmentationNode;
+    scene->AddNode(segmentationNode);
+    vtkNew<vtkMRMLSegmentationStorageNode> segmentationStorageNode;
+    scene->AddNode(segmentationStorageNode);
+    segmentationStorageNode->SetFileName(slicerSegmentationFilename);
+    CHECK_INT(segmentationStorageNode->ReadData(segmentationNode), 1);
+    CHECK_BOOL(segmentationStorageNode->GetLabelmapVoxelsPending(), false);
+    vtkSegmentation* segmentation = segmentationNode->GetSegmentation();
+    std::vector<std::string> segmentIDs;
+    segmentation->GetSegmentIDs(segmentIDs);
+
+    // Voxels are read on first access to a labelmap
+    vtkNew<vtkMRMLSegmentationNode> headerOnlySegmentationNode;
+    scene->AddNode(headerOnlySegmentationNode);
+    vtkNew<vtkMRMLSegmentationStorageNode> headerOnlyStorageNode;
+    scene->AddNode(headerOnlyStorageNode);
+    headerOnlyStorageNode->SetFileName(slicerSegmentationFilename);
+    headerOnlyStorageNode->ReadHeaderOnlyOn();
+    CHECK_INT(headerOnlyStorageNode->ReadData(headerOnlySegmentationNode), 1);
+    CHECK_BOOL(headerOnlyStorageNode->GetLabelmapVoxelsPending(), true);
+
+    // Segment properties are available, representations are pending
+    vtkSegmentation* headerOnlySegmentation = headerOnlySegmentationNode->GetSegmentation();
+    CHECK_INT(headerOnlySegmentation->GetNumberOfSegments(), 3);
+    for (const std::string& segmentID : segmentIDs)
+      {
+      vtkSegment* headerOnlySegment = headerOnlySegmentation->GetSegment(segmentID);
+      CHECK_NOT_NULL(headerOnlySegment);
+      CHECK_STRING(headerOnlySegment->GetName(), segmentation->GetSegment(segmentID)->GetName());
+      CHECK_DOUBLE(headerOnlySegment->GetColor()[0], segmentation->GetSegment(segmentID)->GetColor()[0]);
+      CHECK_INT(headerOnlySegment->GetLabelValue(), segmentation->GetSegment(segmentID)->GetLabelValue());
+      CHECK_BOOL(headerOnlySegment->GetRepresentationsPending(), true);
+      }
+    CHECK_BOOL(headerOnlyStorageNode->GetLabelmapVoxelsPending(), true);
+
+    // Accessing a labelmap directly through vtkSegment reads the voxels of all segments
+    vtkOrientedImageData* headerOnlyLabelmap = vtkOrientedImageData::SafeDownCast(headerOnlySegmentation->GetSegment(segmentIDs[0])
+      ->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+    CHECK_NOT_NULL(headerOnlyLabelmap);
+    CHECK_BOOL(headerOnlyLabelmap->GetNumberOfPoints() > 0, true);
+    CHECK_BOOL(headerOnlyStorageNode->GetLabelmapVoxelsPending(), false);
+    for (const std::string& segmentID : segmentIDs)
+      {
+      CHECK_BOOL(headerOnlySegmentation->GetSegment(segmentID)->GetRepresentationsPending(), false);
+      }
+    CHECK_INT(headerOnlySegmentation->GetNumberOfLayers(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()), 2);
+    CHECK_BOOL(headerOnlySegmentationNode->GetModifiedSinceRead(), false);
+    CHECK_EXIT_SUCCESS(compareSegmentLabelmaps(segmentationNode, headerOnlySegmentationNode));
+
+    // Segmentation that is modified before the voxels are read remains modified
+    vtkNew<vtkMRMLSegmentationNode> modifiedSegmentationNode;
+    scene->AddNode(modifiedSegmentationNode);
+    vtkNew<vtkMRMLSegmentationStorageNode> modifiedStorageNode;
+    scene->AddNode(modifiedStorageNode);
+    modifiedStorageNode->SetFileName(slicerSegmentationFilename);
+    modifiedStorageNode->ReadHeaderOnlyOn();
+    CHECK_INT(modifiedStorageNode->ReadData(modifiedSegmentationNode), 1);
+    CHECK_BOOL(modifiedSegmentationNode->GetModifiedSinceRead(), false);
+    modifiedSegmentationNode->GetSegmentation()->GetSegment(segmentIDs[0])->SetName("renamed");
+    CHECK_BOOL(modifiedSegmentationNode->GetModifiedSinceRead(), true);
+    CHECK_INT(modifiedStorageNode->ReadLabelmapVoxels(modifiedSegmentationNode), 1);
+    CHECK_BOOL(modifiedStorageNode->GetLabelmapVoxelsPending(), false);
+    CHECK_BOOL(modifiedSegmentationNode->GetModifiedSinceRead(), true);
+
+    // Segmentation is hidden after reading, voxels are read when it is shown
+    vtkNew<vtkMRMLSegmentationNode> displayedSegmentationNode;
+    scene->AddNode(displayedSegmentationNode);
+    vtkNew<vtkMRMLSegmentationStorageNode> displayedStorageNode;
+    scene->AddNode(displayedStorageNode);
+    displayedStorageNode->SetFileName(slicerSegmentationFilename);
+    displayedStorageNode->ReadHeaderOnlyOn();
+    CHECK_INT(displayedStorageNode->ReadData(displayedSegmentationNode), 1);
+    CHECK_BOOL(displayedStorageNode->GetLabelmapVoxelsPending(), true);
+    CHECK_NOT_NULL(displayedSegmentationNode->GetDisplayNode());
+    CHECK_BOOL(displayedSegmentationNode->GetDisplayNode()->GetVisibility(), false);
+    displayedSegmentationNode->GetDisplayNode()->SetVisibility(true);
+    CHECK_BOOL(displayedStorageNode->GetLabelmapVoxelsPending(), false);
+    CHECK_EXIT_SUCCESS(compareSegmentLabelmaps(segmentationNode, displayedSegmentationNode));
+
+    // Voxels are read immediately if there is a visible display node already (as in scene loading)
+    vtkNew<vtkMRMLSegmentationNode> sceneSegmentationNode;
+    scene->AddNode(sceneSegmentationNode);
+    sceneSegmentationNode->CreateDefaultDisplayNodes();
+    vtkNew<vtkMRMLSegmentationStorageNode> sceneStorageNode;
+    scene->AddNode(sceneStorageNode);
+    sceneStorageNode->SetFileName(slicerSegmentationFilename);
+    sceneStorageNode->ReadHeaderOnlyOn();
+    sceneSegmentationNode->SetAndObserveStorageNodeID(sceneStorageNode->GetID());
+    CHECK_INT(sceneStorageNode->ReadData(sceneSegmentationNode), 1);
+    CHECK_BOOL(sceneStorageNode->GetLabelmapVoxelsPending(), false);
+    CHECK_BOOL(sceneSegmentationNode->GetModifiedSinceRead(), false);
+    CHECK_EXIT_SUCCESS(compareSegmentLabelmaps(segmentationNode, sceneSegmentationNode));
+  }
+
+  std::cout << "Testing sparse labelmap segmentation" << std::endl;
+  {
+    vtkNew<vtkMRMLSegmentationNode> segmentationNode;
+    scene->AddNode(segmentationNode);
+    vtkSegmentation* segmentation = segmentationNode->GetSegmentation();
+    segmentation->SetMasterRepresentationName(vtkSegmentationConverter::GetSparseBinaryLabelmapRepresentationName());
+    const int boxExtents[2][6] = { { 2, 10, 3, 12, 4, 9 }, { 40, 50, 5, 20, 30, 33 } };
+    for (int segmentIndex = 0; segmentIndex < 2; ++segmentIndex)
+      {
+      vtkNew<vtkSegment> segment;
+      segment->SetName(segmentIndex == 0 ? "first" : "second");
+      segment->AddRepresentation(vtkSegmentationConverter::GetSparseBinaryLabelmapRepresentationName(),
+        createSparseLabelmap(boxExtents[segmentIndex]));
+      CHECK_BOOL(segmentation->AddSegment(segment, segmentIndex == 0 ? "first" : "second"), true);
+      }
+    CHECK_BOOL(segmentation->IsMasterRepresentationImageData(), false);
+
+    std::string sparseSegmentationFilename = std::string(tempDir) + "/SparseSegmentation.seg.nrrd";
+    vtkNew<vtkMRMLSegmentationStorageNode> segmentationStorageNode;
+    scene->AddNode(segmentationStorageNode);
+    segmentationStorageNode->SetFileName(sparseSegmentationFilename.c_str());
+    CHECK_INT(segmentationStorageNode->WriteData(segmentationNode), 1);
+    // Segments are converted to dense labelmaps for writing without modifying the segmentation
+    CHECK_STD_STRING(segmentation->GetMasterRepresentationName(), vtkSegmentationConverter::GetSparseBinaryLabelmapRepresentationName());
+    CHECK_BOOL(segmentation->ContainsRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()), false);
+
+    vtkNew<vtkMRMLSegmentationNode> loadedSegmentationNode;
+    scene->AddNode(loadedSegmentationNode);
+    vtkNew<vtkMRMLSegmentationStorageNode> loadedSegmentationStorageNode;
+    scene->AddNode(loadedSegmentationStorageNode);
+    loadedSegmentationStorageNode->SetFileName(sparseSegmentationFilename.c_str());
+    CHECK_INT(loadedSegmentationStorageNode->ReadData(loadedSegmentationNode), 1);
+    vtkSegmentation* loadedSegmentation = loadedSegmentationNode->GetSegmentation();
+    CHECK_INT(loadedSegmentation->GetNumberOfSegments(), 2);
+    CHECK_STD_STRING(loadedSegmentation->GetMasterRepresentationName(), vtkSegmentationConverter::GetBinaryLabelmapRepresentationName());
+    CHECK_BOOL(loadedSegmentation->ContainsRepresentation(vtkSegmentationConverter::GetSparseBinaryLabelmapRepresentationName()), true);
+
+    for (int segmentIndex = 0; segmentIndex < 2; ++segmentIndex)
+      {
+      std::string segmentID = (segmentIndex == 0 ? "first" : "second");
+      vtkSparseOrientedImageData* sparseLabelmap = vtkSparseOrientedImageData::SafeDownCast(
+        segmentation->GetSegment(segmentID)->GetRepresentation(vtkSegmentationConverter::GetSparseBinaryLabelmapRepresentationName()));
+      CHECK_NOT_NULL(sparseLabelmap);
+      vtkNew<vtkOrientedImageData> expectedLabelmap;
+      sparseLabelmap->GetImage(expectedLabelmap);
+
+      vtkSegment* loadedSegment = loadedSegmentation->GetSegment(segmentID);
+      CHECK_NOT_NULL(loadedSegment);
+      CHECK_STRING(loadedSegment->GetName(), segmentation->GetSegment(segmentID)->GetName());
+      vtkOrientedImageData* loadedLabelmap = vtkOrientedImageData::SafeDownCast(
+        loadedSegment->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+      CHECK_NOT_NULL(loadedLabelmap);
+
+      int expectedLabelExtent[6] = { 0, -1, 0, -1, 0, -1 };
+      int loadedLabelExtent[6] = { 0, -1, 0, -1, 0, -1 };
+      int expectedNumberOfVoxels = countLabelVoxels(expectedLabelmap, 1, expectedLabelExtent);
+      int loadedNumberOfVoxels = countLabelVoxels(loadedLabelmap, loadedSegment->GetLabelValue(), loadedLabelExtent);
+      int boxNumberOfVoxels = 1;
+      for (int axis = 0; axis < 3; ++axis)
+        {
+        boxNumberOfVoxels *= boxExtents[segmentIndex][axis * 2 + 1] - boxExtents[segmentIndex][axis * 2] + 1;
+        }
+      CHECK_INT(expectedNumberOfVoxels, boxNumberOfVoxels);
+      CHECK_INT(loadedNumberOfVoxels, expectedNumberOfVoxels);
+      for (int i = 0; i < 6; ++i)
+        {
+        CHECK_INT(expectedLabelExtent[i], boxExtents[segmentIndex][i]);
+        CHECK_INT(loadedLabelExtent[i], expectedLabelExtent[i]);
+        }
+      double expectedSpacing[3] = { 0.0, 0.0, 0.0 };
+      double loadedSpacing[3] = { 0.0, 0.0, 0.0 };
+      expectedLabelmap->GetSpacing(expectedSpacing);
+      loadedLabelmap->GetSpacing(loadedSpacing);
+      double expectedOrigin[3] = { 0.0, 0.0, 0.0 };
+      double loadedOrigin[3] = { 0.0, 0.0, 0.0 };
+      expectedLabelmap->GetOrigin(expectedOrigin);
+      loadedLabelmap->GetOrigin(loadedOrigin);
+      for (int axis = 0; axis < 3; ++axis)
+        {
+        CHECK_DOUBLE_TOLERANCE(loadedSpacing[axis], expectedSpacing[axis], 1e-6);
+        CHECK_DOUBLE_TOLERANCE(loadedOrigin[axis], expectedOrigin[axis], 1e-6);
+        }
+      }
+  }
+
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,172 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLLinearTransformNode.h"
+#include "vtkMRMLSequenceNode.h"
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+std::string indexValueAsString(int indexType, int itemNumber)
+{
+  std::ostringstream indexValue;
+  if (indexType == vtkMRMLSequenceNode::NumericIndex)
+    {
+    // 100Hz tracking stream
+    indexValue << itemNumber * 0.01;
+    }
+  else
+    {
+    indexValue << "frame" << itemNumber;
+    }
+  return indexValue.str();
+}
+
+//---------------------------------------------------------------------------
+int benchmark(int indexType, int numberOfItems)
+{
+  std::cout << vtkMRMLSequenceNode::GetIndexTypeAsString(indexType)
+    << " index, number of items: " << numberOfItems << std::endl;
+  vtkNew<vtkTimerLog> timer;
+
+  vtkNew<vtkMRMLSequenceNode> sequenceNode;
+  sequenceNode->SetIndexType(indexType);
+  vtkNew<vtkMRMLLinearTransformNode> transformNode;
+
+  timer->StartTimer();
+  for (int i = 0; i < numberOfItems; ++i)
+    {
+    sequenceNode->SetDataNodeAtValue(transformNode.GetPointer(), indexValueAsString(indexType, i));
+    }
+  timer->StopTimer();
+  std::cout << "  Append: " << timer->GetElapsedTime() / numberOfItems * 1e6 << "us" << std::endl;
+  CHECK_INT(sequenceNode->GetNumberOfDataNodes(), numberOfItems);
+
+  const int numberOfQueries = 10000;
+  std::vector<std::string> queriedIndexValues;
+  for (int i = 0; i < numberOfQueries; ++i)
+    {
+    queriedIndexValues.push_back(indexValueAsString(indexType, (i * 7919) % numberOfItems));
+    }
+  timer->StartTimer();
+  for (const std::string& indexValue : queriedIndexValues)
+    {
+    sequenceNode->GetDataNodeAtValue(indexValue);
+    }
+  timer->StopTimer();
+  std::cout << "  Seek: " << timer->GetElapsedTime() / numberOfQueries * 1e6 << "us" << std::endl;
+
+  // Check lookup results
+  for (int i = 0; i < numberOfItems; i += 997)
+    {
+    CHECK_INT(sequenceNode->GetItemNumberFromIndexValue(indexValueAsString(indexType, i)), i);
+    }
+  CHECK_INT(sequenceNode->GetItemNumberFromIndexValue(indexValueAsString(indexType, numberOfItems)), -1);
+
+  // Item numbers must be updated after removing and inserting items
+  sequenceNode->RemoveDataNodeAtValue(indexValueAsString(indexType, 1));
+  CHECK_INT(sequenceNode->GetItemNumberFromIndexValue(indexValueAsString(indexType, 1)), -1);
+  CHECK_INT(sequenceNode->GetItemNumberFromIndexValue(indexValueAsString(indexType, 2)), 1);
+  CHECK_INT(sequenceNode->GetItemNumberFromIndexValue(indexValueAsString(indexType, numberOfItems - 1)), numberOfItems - 2);
+  sequenceNode->SetDataNodeAtValue(transformNode.GetPointer(), indexValueAsString(indexType, 1));
+  int expectedItemNumber = (indexType == vtkMRMLSequenceNode::NumericIndex ? 1 : numberOfItems - 1);
+  CHECK_INT(sequenceNode->GetItemNumberFromIndexValue(indexValueAsString(indexType, 1)), expectedItemNumber);
+  CHECK_BOOL(sequenceNode->UpdateIndexValue(indexValueAsString(indexType, 0), indexValueAsString(indexType, numberOfItems)), true);
+  CHECK_INT(sequenceNode->GetItemNumberFromIndexValue(indexValueAsString(indexType, 0)), -1);
+  // Numeric index items are kept sorted, text index items keep their position
+  expectedItemNumber = (indexType == vtkMRMLSequenceNode::NumericIndex ? numberOfItems - 1 : 0);
+  CHECK_INT(sequenceNode->GetItemNumberFromIndexValue(indexValueAsString(indexType, numberOfItems)), expectedItemNumber);
+  CHECK_INT(sequenceNode->GetItemNumberFromIndexValue(indexValueAsString(indexType, 2)), 1);
+
+  // Copy rebuilds the lookup table
+  vtkNew<vtkMRMLSequenceNode> copiedSequenceNode;
+  copiedSequenceNode->Copy(sequenceNode.GetPointer());
+  for (int i = 2; i < numberOfItems; i += 997)
+    {
+    CHECK_INT(copiedSequenceNode->GetItemNumberFromIndexValue(indexValueAsString(indexType, i)),
+      sequenceNode->GetItemNumberFromIndexValue(indexValueAsString(indexType, i)));
+    }
+
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int testDuplicateIndexValues()
+{
+  // Index values read from a scene file may contain duplicates, the first item is found
+  vtkNew<vtkMRMLSequenceNode> sequenceNode;
+  sequenceNode->GetSequenceScene();
+  const char* atts[] = { "indexType", "text", "indexValues", "n0:a;n1:b;n2:a;n3:c;n4:a", nullptr };
+  sequenceNode->ReadXMLAttributes(atts);
+  CHECK_INT(sequenceNode->GetNumberOfDataNodes(), 5);
+  CHECK_INT(sequenceNode->GetItemNumberFromIndexValue("a"), 0);
+
+  // Renumbering items after the first occurrence keeps referring to the first item
+  sequenceNode->RemoveDataNodeAtValue("b");
+  CHECK_INT(sequenceNode->GetItemNumberFromIndexValue("a"), 0);
+  CHECK_INT(sequenceNode->GetItemNumberFromIndexValue("c"), 2);
+
+  // Removing the first occurrence refers to the next item with the same index value
+  sequenceNode->RemoveDataNodeAtValue("a");
+  CHECK_INT(sequenceNode->GetNumberOfDataNodes(), 3);
+  CHECK_INT(sequenceNode->GetItemNumberFromIndexValue("a"), 0);
+  CHECK_INT(sequenceNode->GetItemNumberFromIndexValue("c"), 1);
+
+  // Changing the index value of the first occurrence refers to the next item as well
+  CHECK_BOOL(sequenceNode->UpdateIndexValue("a", "d"), true);
+  CHECK_INT(sequenceNode->GetItemNumberFromIndexValue("d"), 0);
+  CHECK_INT(sequenceNode->GetItemNumberFromIndexValue("a"), 2);
+
+  // Index value is not found after its last occurrence is removed
+  sequenceNode->RemoveDataNodeAtValue("a");
+  CHECK_INT(sequenceNode->GetItemNumberFromIndexValue("a"), -1);
+  CHECK_INT(sequenceNode->GetItemNumberFromIndexValue("c"), 1);
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+// Measures appending items to a sequence and finding items by index value.
+// Optional arguments set the number of items (default: 100000).
+int vtkMRMLSequenceNodePerformanceTest(int argc, char * argv[])
+{
+  std::vector<int> numbersOfItems;
+  for (int i = 1; i < argc; ++i)
+    {
+    numbersOfItems.push_back(atoi(argv[i]));
+    }
+  if (numbersOfItems.empty())
+    {
+    numbersOfItems.push_back(100000);
+    }
+  for (int numberOfItems : numbersOfItems)
+    {
+    CHECK_EXIT_SUCCESS(benchmark(vtkMRMLSequenceNode::NumericIndex, numberOfItems));
+    CHECK_EXIT_SUCCESS(benchmark(vtkMRMLSequenceNode::TextIndex, numberOfItems));
+    }
+  CHECK_EXIT_SUCCESS(testDuplicateIndexValues());
+  return EXIT_SUCCESS;
+}
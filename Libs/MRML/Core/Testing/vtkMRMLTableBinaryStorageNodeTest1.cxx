@@ -0,0 +1,224 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLTableBinaryStorageNode.h"
+#include "vtkMRMLTableNode.h"
+#include "vtkMRMLTableStorageNode.h"
+
+// VTK includes
+#include <vtkBitArray.h>
+#include <vtkDoubleArray.h>
+#include <vtkIntArray.h>
+#include <vtkNew.h>
+#include <vtkStringArray.h>
+#include <vtkTable.h>
+
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <string>
+
+namespace
+{
+
+// Large enough to be memory-mapped when read
+const vtkIdType NUMBER_OF_ROWS = 200000;
+
+//---------------------------------------------------------------------------
+void createTable(vtkMRMLTableNode* tableNode)
+{
+  vtkNew<vtkDoubleArray> doubleColumn;
+  doubleColumn->SetName("double\tcolumn");
+  vtkNew<vtkIntArray> vectorColumn;
+  vectorColumn->SetName("vector");
+  vectorColumn->SetNumberOfComponents(3);
+  vectorColumn->SetComponentName(0, "X");
+  vectorColumn->SetComponentName(1, "Y");
+  vectorColumn->SetComponentName(2, "Z");
+  vtkNew<vtkStringArray> stringColumn;
+  stringColumn->SetName("string");
+  vtkNew<vtkBitArray> bitColumn;
+  bitColumn->SetName("bit");
+  for (vtkIdType row = 0; row < NUMBER_OF_ROWS; ++row)
+    {
+    doubleColumn->InsertNextValue(row * 0.5);
+    vectorColumn->InsertNextTuple3(row, -row, row % 7);
+    stringColumn->InsertNextValue(row % 3 == 0 ? std::string() : std::string("value ") + std::to_string(row));
+    bitColumn->InsertNextValue(row % 5 == 0 ? 1 : 0);
+    }
+  vtkNew<vtkTable> table;
+  table->AddColumn(doubleColumn.GetPointer());
+  table->AddColumn(vectorColumn.GetPointer());
+  table->AddColumn(stringColumn.GetPointer());
+  table->AddColumn(bitColumn.GetPointer());
+  tableNode->SetAndObserveTable(table.GetPointer());
+  tableNode->SetColumnUnitLabel("double\tcolumn", "mm");
+  tableNode->SetColumnLongName("vector", "Position vector");
+}
+
+//---------------------------------------------------------------------------
+int checkTable(vtkMRMLTableNode* tableNode, bool allColumns)
+{
+  vtkTable* table = tableNode->GetTable();
+  CHECK_NOT_NULL(table);
+  CHECK_INT(table->GetNumberOfRows(), NUMBER_OF_ROWS);
+  CHECK_INT(table->GetNumberOfColumns(), allColumns ? 4 : 2);
+
+  vtkDoubleArray* doubleColumn = vtkDoubleArray::SafeDownCast(table->GetColumnByName("double\tcolumn"));
+  CHECK_NOT_NULL(doubleColumn);
+  CHECK_STD_STRING(tableNode->GetColumnUnitLabel("double\tcolumn"), "mm");
+
+  vtkStringArray* stringColumn = vtkStringArray::SafeDownCast(table->GetColumnByName("string"));
+  CHECK_NOT_NULL(stringColumn);
+
+  for (vtkIdType row = 0; row < NUMBER_OF_ROWS; row += 997)
+    {
+    CHECK_DOUBLE(doubleColumn->GetValue(row), row * 0.5);
+    CHECK_STD_STRING(stringColumn->GetValue(row),
+      row % 3 == 0 ? std::string() : std::string("value ") + std::to_string(row));
+    }
+  if (!allColumns)
+    {
+    CHECK_NULL(table->GetColumnByName("vector"));
+    return EXIT_SUCCESS;
+    }
+
+  vtkIntArray* vectorColumn = vtkIntArray::SafeDownCast(table->GetColumnByName("vector"));
+  CHECK_NOT_NULL(vectorColumn);
+  CHECK_INT(vectorColumn->GetNumberOfComponents(), 3);
+  CHECK_STRING(vectorColumn->GetComponentName(2), "Z");
+  CHECK_STD_STRING(tableNode->GetColumnLongName("vector"), "Position vector");
+  vtkBitArray* bitColumn = vtkBitArray::SafeDownCast(table->GetColumnByName("bit"));
+  CHECK_NOT_NULL(bitColumn);
+  for (vtkIdType row = 0; row < NUMBER_OF_ROWS; row += 997)
+    {
+    CHECK_INT(vectorColumn->GetTypedComponent(row, 1), -row);
+    CHECK_INT(bitColumn->GetValue(row), row % 5 == 0 ? 1 : 0);
+    }
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int testReadWrite(vtkMRMLScene* scene, bool compression)
+{
+  std::string fileName = std::string(scene->GetRootDirectory()) + "/vtkMRMLTableBinaryStorageNodeTest1.mtbl";
+  vtksys::SystemTools::RemoveFile(fileName);
+
+  vtkNew<vtkMRMLTableNode> tableNode;
+  createTable(tableNode.GetPointer());
+  vtkNew<vtkMRMLTableBinaryStorageNode> storageNode;
+  storageNode->SetFileName(fileName.c_str());
+  storageNode->SetUseCompression(compression ? 1 : 0);
+  CHECK_INT(storageNode->WriteData(tableNode.GetPointer()), 1);
+
+  std::vector<std::string> columnNames;
+  CHECK_BOOL(storageNode->GetColumnNamesInFile(fileName, columnNames), true);
+  CHECK_INT(static_cast<int>(columnNames.size()), 4);
+  CHECK_STD_STRING(columnNames[0], "double\tcolumn");
+
+  vtkNew<vtkMRMLTableNode> readTableNode;
+  CHECK_INT(storageNode->ReadData(readTableNode.GetPointer()), 1);
+  CHECK_EXIT_SUCCESS(checkTable(readTableNode.GetPointer(), true));
+
+  // Modifying a table that may be memory-mapped does not change the file
+  vtkDoubleArray::SafeDownCast(readTableNode->GetTable()->GetColumnByName("double\tcolumn"))->SetValue(0, 1234.0);
+    {
+    vtkNew<vtkMRMLTableNode> readTableNode2;
+    CHECK_INT(storageNode->ReadData(readTableNode2.GetPointer()), 1);
+    CHECK_EXIT_SUCCESS(checkTable(readTableNode2.GetPointer(), true));
+    }
+
+  // Overwrite the file that the table is read from
+  // (on Windows, columns of the written table node are unmapped before the file is replaced)
+  readTableNode->GetTable()->GetColumnByName("double\tcolumn")->SetVariantValue(0, 0.0);
+  CHECK_INT(storageNode->WriteData(readTableNode.GetPointer()), 1);
+  CHECK_EXIT_SUCCESS(checkTable(readTableNode.GetPointer(), true));
+  vtkNew<vtkMRMLTableNode> overwrittenTableNode;
+  CHECK_INT(storageNode->ReadData(overwrittenTableNode.GetPointer()), 1);
+  CHECK_EXIT_SUCCESS(checkTable(overwrittenTableNode.GetPointer(), true));
+
+  // Read selected columns only
+  std::vector<std::string> columnNamesToRead;
+  columnNamesToRead.push_back("string");
+  columnNamesToRead.push_back("double\tcolumn");
+  storageNode->SetColumnNamesToRead(columnNamesToRead);
+  vtkNew<vtkMRMLTableNode> partialTableNode;
+  CHECK_INT(storageNode->ReadData(partialTableNode.GetPointer()), 1);
+  CHECK_EXIT_SUCCESS(checkTable(partialTableNode.GetPointer(), false));
+
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int testChooseFormatOnSave(vtkMRMLScene* scene)
+{
+  std::string fileName = std::string(scene->GetRootDirectory()) + "/vtkMRMLTableBinaryStorageNodeTest1_saved.mtbl";
+  vtksys::SystemTools::RemoveFile(fileName);
+
+  vtkNew<vtkMRMLTableNode> tableNode;
+  scene->AddNode(tableNode.GetPointer());
+  createTable(tableNode.GetPointer());
+  CHECK_STD_STRING(tableNode->GetDefaultStorageNodeClassName(), "vtkMRMLTableStorageNode");
+  CHECK_STD_STRING(tableNode->GetDefaultStorageNodeClassName("table.csv"), "vtkMRMLTableStorageNode");
+  CHECK_STD_STRING(tableNode->GetDefaultStorageNodeClassName(fileName.c_str()), "vtkMRMLTableBinaryStorageNode");
+
+  // Default table storage node writes the binary format if it is chosen as write file type
+  vtkNew<vtkMRMLTableStorageNode> storageNode;
+  CHECK_BOOL(storageNode->SupportedFileType(fileName.c_str()) != 0, true);
+  storageNode->SetFileName(fileName.c_str());
+  CHECK_INT(storageNode->WriteData(tableNode.GetPointer()), 1);
+  CHECK_STD_STRING(storageNode->GetSchemaFileName(), "");
+
+  std::vector<std::string> columnNames;
+  vtkNew<vtkMRMLTableBinaryStorageNode> binaryStorageNode;
+  CHECK_BOOL(binaryStorageNode->GetColumnNamesInFile(fileName, columnNames), true);
+  CHECK_INT(static_cast<int>(columnNames.size()), 4);
+
+  vtkNew<vtkMRMLTableNode> readTableNode;
+  CHECK_INT(storageNode->ReadData(readTableNode.GetPointer()), 1);
+  CHECK_EXIT_SUCCESS(checkTable(readTableNode.GetPointer(), true));
+
+  scene->RemoveNode(tableNode.GetPointer());
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkMRMLTableBinaryStorageNodeTest1(int argc, char * argv[])
+{
+  if (argc != 2)
+    {
+    std::cerr << "Usage: " << argv[0] << " /path/to/temp" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  vtkNew<vtkMRMLTableBinaryStorageNode> node1;
+  EXERCISE_ALL_BASIC_MRML_METHODS(node1.GetPointer());
+
+  vtkNew<vtkMRMLScene> scene;
+  scene->SetRootDirectory(argv[1]);
+
+  CHECK_EXIT_SUCCESS(testReadWrite(scene.GetPointer(), false));
+  CHECK_EXIT_SUCCESS(testReadWrite(scene.GetPointer(), true));
+  CHECK_EXIT_SUCCESS(testChooseFormatOnSave(scene.GetPointer()));
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,187 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLGridTransformNode.h"
+#include "vtkMRMLLinearTransformNode.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLTransformGridCache.h"
+
+// VTK includes
+#include <vtkGeneralTransform.h>
+#include <vtkGridTransform.h>
+#include <vtkImageData.h>
+#include <vtkMath.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+
+// STD includes
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Smooth displacement field with a few millimeters of displacement
+void setDisplacements(vtkGridTransform* gridTransform, double amplitude)
+{
+  vtkNew<vtkImageData> grid;
+  grid->SetDimensions(21, 21, 21);
+  grid->SetOrigin(-50.0, -50.0, -50.0);
+  grid->SetSpacing(5.0, 5.0, 5.0);
+  grid->AllocateScalars(VTK_DOUBLE, 3);
+  double* displacement = static_cast<double*>(grid->GetScalarPointer());
+  for (int k = 0; k < 21; ++k)
+    {
+    for (int j = 0; j < 21; ++j)
+      {
+      for (int i = 0; i < 21; ++i)
+        {
+        double x = -50.0 + i * 5.0;
+        double y = -50.0 + j * 5.0;
+        double z = -50.0 + k * 5.0;
+        *(displacement++) = amplitude * sin(y / 20.0);
+        *(displacement++) = amplitude * sin(z / 25.0);
+        *(displacement++) = amplitude * cos(x / 30.0);
+        }
+      }
+    }
+  gridTransform->SetDisplacementGridData(grid.GetPointer());
+  gridTransform->SetInterpolationModeToCubic();
+}
+
+//----------------------------------------------------------------------------
+double getMaximumError(vtkMRMLTransformNode* transformNode, vtkAbstractTransform* approximateTransform)
+{
+  vtkNew<vtkGeneralTransform> exactTransform;
+  transformNode->GetTransformFromWorld(exactTransform.GetPointer());
+  double maximumError = 0.0;
+  for (double x = -37.0; x <= 37.0; x += 7.4)
+    {
+    for (double y = -37.0; y <= 37.0; y += 7.4)
+      {
+      for (double z = -37.0; z <= 37.0; z += 7.4)
+        {
+        double point[3] = { x, y, z };
+        double exactPoint[3] = { 0.0, 0.0, 0.0 };
+        double approximatePoint[3] = { 0.0, 0.0, 0.0 };
+        exactTransform->TransformPoint(point, exactPoint);
+        approximateTransform->TransformPoint(point, approximatePoint);
+        maximumError = std::max(maximumError, sqrt(vtkMath::Distance2BetweenPoints(exactPoint, approximatePoint)));
+        }
+      }
+    }
+  return maximumError;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkMRMLTransformGridCacheTest1(int vtkNotUsed(argc), char * vtkNotUsed(argv)[])
+{
+  vtkNew<vtkMRMLScene> scene;
+
+  // Grid transform under a linear transform
+  vtkNew<vtkMRMLLinearTransformNode> linearTransformNode;
+  scene->AddNode(linearTransformNode.GetPointer());
+  vtkNew<vtkMatrix4x4> matrix;
+  matrix->SetElement(0, 3, 5.0);
+  matrix->SetElement(1, 3, -3.0);
+  linearTransformNode->SetMatrixTransformToParent(matrix.GetPointer());
+
+  vtkNew<vtkMRMLGridTransformNode> gridTransformNode;
+  scene->AddNode(gridTransformNode.GetPointer());
+  vtkNew<vtkGridTransform> gridTransform;
+  setDisplacements(gridTransform.GetPointer(), 3.0);
+  gridTransformNode->SetAndObserveTransformToParent(gridTransform.GetPointer());
+  gridTransformNode->SetAndObserveTransformNodeID(linearTransformNode->GetID());
+
+  vtkNew<vtkMRMLTransformGridCache> cache;
+  cache->SetTransformNode(gridTransformNode.GetPointer());
+  cache->SetTransformFromWorld(true);
+  cache->SetBounds(-40.0, 40.0, -40.0, 40.0, -40.0, 40.0);
+  cache->SetGridSpacing(4.0);
+  cache->SetMaximumError(0.2);
+  cache->SetBackgroundComputation(false);
+  CHECK_POINTER(cache->GetTransformNode(), gridTransformNode.GetPointer());
+  CHECK_BOOL(cache->IsGridUpToDate(), false);
+  CHECK_BOOL(cache->GetGridError() < 0.0, true);
+
+  // Grid approximates the inverse of the transform chain within the error bound
+  vtkAbstractTransform* transform = cache->GetTransform();
+  CHECK_BOOL(cache->IsGridUpToDate(), true);
+  CHECK_NOT_NULL(vtkGridTransform::SafeDownCast(transform));
+  CHECK_BOOL(cache->GetGridError() <= 0.2, true);
+  double error = getMaximumError(gridTransformNode.GetPointer(), transform);
+  std::cout << "Error of synchronously computed grid: " << error << std::endl;
+  CHECK_BOOL(error < 0.5, true);
+
+  // Grid is discarded when the parent transform is modified
+  matrix->SetElement(2, 3, 8.0);
+  linearTransformNode->SetMatrixTransformToParent(matrix.GetPointer());
+  CHECK_BOOL(cache->IsGridUpToDate(), false);
+
+  // Exact transform is used until the grid is computed in the background
+  cache->SetBackgroundComputation(true);
+  transform = cache->GetTransform();
+  CHECK_NOT_NULL(vtkGeneralTransform::SafeDownCast(transform));
+  vtkAbstractTransform* proxyTransform = cache->GetProxyTransform();
+  CHECK_NOT_NULL(proxyTransform);
+  for (int i = 0; i < 600 && !cache->IsGridUpToDate(); ++i)
+    {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+  CHECK_BOOL(cache->IsGridUpToDate(), true);
+
+  // Proxy transform switches to the grid without getting it from the cache again
+  double testPoint[3] = { 12.3, -4.5, 6.7 };
+  double proxyPoint[3] = { 0.0, 0.0, 0.0 };
+  proxyTransform->TransformPoint(testPoint, proxyPoint);
+  transform = cache->GetTransform();
+  CHECK_NOT_NULL(vtkGridTransform::SafeDownCast(transform));
+  double gridPoint[3] = { 0.0, 0.0, 0.0 };
+  transform->TransformPoint(testPoint, gridPoint);
+  CHECK_DOUBLE(proxyPoint[0], gridPoint[0]);
+  CHECK_DOUBLE(proxyPoint[1], gridPoint[1]);
+  CHECK_DOUBLE(proxyPoint[2], gridPoint[2]);
+  error = getMaximumError(gridTransformNode.GetPointer(), transform);
+  std::cout << "Error of grid computed in the background: " << error << std::endl;
+  CHECK_BOOL(error < 0.5, true);
+
+  // Modifying the transform while the grid is computed cancels the computation
+  setDisplacements(gridTransform.GetPointer(), 4.0);
+  gridTransformNode->InvokeCustomModifiedEvent(vtkMRMLTransformableNode::TransformModifiedEvent);
+  cache->GetTransform();
+  setDisplacements(gridTransform.GetPointer(), 2.0);
+  gridTransformNode->InvokeCustomModifiedEvent(vtkMRMLTransformableNode::TransformModifiedEvent);
+  CHECK_BOOL(cache->IsGridUpToDate(), false);
+
+  // Exact transform is used if the error bound cannot be met
+  cache->SetBackgroundComputation(false);
+  cache->SetMaximumError(1e-6);
+  cache->SetMaximumNumberOfGridPoints(10000);
+  transform = cache->GetTransform();
+  CHECK_BOOL(cache->IsGridUpToDate(), false);
+  CHECK_BOOL(cache->GetGridError() > 1e-6, true);
+  CHECK_NOT_NULL(vtkGeneralTransform::SafeDownCast(transform));
+  CHECK_BOOL(cache->ComputeGrid(), false);
+
+  cache->SetTransformNode(nullptr);
+  CHECK_NULL(cache->GetTransformNode());
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,222 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLScalarVolumeNode.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLSequenceNode.h"
+#include "vtkMRMLVolumeSequenceFrameLoader.h"
+#include "vtkMRMLVolumeSequenceStorageNode.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkNew.h>
+
+// STD includes
+#include <cstring>
+#include <sstream>
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+bool isSameImage(vtkImageData* image1, vtkImageData* image2)
+{
+  if (!image1 || !image2)
+    {
+    std::cerr << "Missing image" << std::endl;
+    return false;
+    }
+  int dimensions1[3] = { 0 };
+  int dimensions2[3] = { 0 };
+  image1->GetDimensions(dimensions1);
+  image2->GetDimensions(dimensions2);
+  if (dimensions1[0] != dimensions2[0] || dimensions1[1] != dimensions2[1] || dimensions1[2] != dimensions2[2]
+    || image1->GetScalarType() != image2->GetScalarType()
+    || image1->GetNumberOfScalarComponents() != image2->GetNumberOfScalarComponents())
+    {
+    std::cerr << "Image geometry or scalar type mismatch" << std::endl;
+    return false;
+    }
+  size_t imageSize = static_cast<size_t>(image1->GetNumberOfPoints()) * image1->GetScalarSize()
+    * image1->GetNumberOfScalarComponents();
+  if (memcmp(image1->GetScalarPointer(), image2->GetScalarPointer(), imageSize) != 0)
+    {
+    std::cerr << "Voxel values mismatch" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+int compareFrame(vtkMRMLSequenceNode* eagerSequenceNode, vtkMRMLSequenceNode* lazySequenceNode, int itemNumber)
+{
+  vtkMRMLVolumeNode* eagerVolume = vtkMRMLVolumeNode::SafeDownCast(eagerSequenceNode->GetNthDataNode(itemNumber));
+  vtkMRMLVolumeNode* lazyVolume = vtkMRMLVolumeNode::SafeDownCast(lazySequenceNode->GetNthDataNode(itemNumber));
+  CHECK_NOT_NULL(eagerVolume);
+  CHECK_NOT_NULL(lazyVolume);
+  if (!isSameImage(eagerVolume->GetImageData(), lazyVolume->GetImageData()))
+    {
+    std::cerr << "Frame " << itemNumber << " loaded on demand is different from the frame read from the file" << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int testLoadOnDemand(vtkMRMLScene* scene, const std::string& fileName, bool expectFrameLoader)
+{
+  // Read all frames
+  vtkNew<vtkMRMLSequenceNode> eagerSequenceNode;
+  scene->AddNode(eagerSequenceNode.GetPointer());
+  vtkNew<vtkMRMLVolumeSequenceStorageNode> eagerStorageNode;
+  scene->AddNode(eagerStorageNode.GetPointer());
+  eagerStorageNode->SetFileName(fileName.c_str());
+  CHECK_BOOL(eagerStorageNode->ReadData(eagerSequenceNode.GetPointer()), true);
+  CHECK_NULL(eagerSequenceNode->GetFrameLoader());
+  int numberOfFrames = eagerSequenceNode->GetNumberOfDataNodes();
+
+  // Read frames on demand
+  vtkNew<vtkMRMLSequenceNode> lazySequenceNode;
+  scene->AddNode(lazySequenceNode.GetPointer());
+  vtkNew<vtkMRMLVolumeSequenceStorageNode> lazyStorageNode;
+  scene->AddNode(lazyStorageNode.GetPointer());
+  lazyStorageNode->SetFileName(fileName.c_str());
+  lazyStorageNode->SetLazyLoading(true);
+  lazyStorageNode->SetFrameCacheSize(2);
+  lazyStorageNode->SetReadAheadFrames(1);
+  CHECK_BOOL(lazyStorageNode->ReadData(lazySequenceNode.GetPointer()), true);
+  CHECK_INT(lazySequenceNode->GetNumberOfDataNodes(), numberOfFrames);
+  vtkMRMLVolumeSequenceFrameLoader* lazyFrameLoader = lazySequenceNode->GetFrameLoader();
+  if (!expectFrameLoader)
+    {
+    // Compressed file is read completely
+    CHECK_NULL(lazyFrameLoader);
+    for (int itemNumber = 0; itemNumber < numberOfFrames; ++itemNumber)
+      {
+      CHECK_EXIT_SUCCESS(compareFrame(eagerSequenceNode.GetPointer(), lazySequenceNode.GetPointer(), itemNumber));
+      }
+    return EXIT_SUCCESS;
+    }
+  CHECK_NOT_NULL(lazyFrameLoader);
+  CHECK_BOOL(lazyFrameLoader->IsOpen(), true);
+  CHECK_INT(lazyFrameLoader->GetNumberOfCachedFrames(), 0);
+
+  // Accessing a data node without loading
+  vtkMRMLNode* firstLazyDataNode = lazySequenceNode->GetNthDataNodeWithoutLoading(0);
+  CHECK_NOT_NULL(firstLazyDataNode);
+  CHECK_BOOL(lazyFrameLoader->IsDataNodeLoadPending(firstLazyDataNode), true);
+  // Frames that are not loaded yet can be written
+  CHECK_BOOL(lazyStorageNode->CanWriteFromReferenceNode(lazySequenceNode.GetPointer()), true);
+
+  // Frames read directly from the loader
+  for (int frameIndex = 0; frameIndex < numberOfFrames; ++frameIndex)
+    {
+    vtkMRMLVolumeNode* eagerVolume = vtkMRMLVolumeNode::SafeDownCast(eagerSequenceNode->GetNthDataNode(frameIndex));
+    CHECK_NOT_NULL(eagerVolume);
+    CHECK_BOOL(isSameImage(eagerVolume->GetImageData(), lazyFrameLoader->ReadFrame(frameIndex)), true);
+    }
+  CHECK_NULL(lazyFrameLoader->ReadFrame(numberOfFrames));
+
+  // Browse forward then backward (as done for display), frames are read ahead in both directions
+  // but they are not loaded into the data nodes and at most FrameCacheSize frames are kept in memory
+  for (int pass = 0; pass < 2; ++pass)
+    {
+    for (int step = 0; step < numberOfFrames; ++step)
+      {
+      int itemNumber = (pass == 0 ? step : numberOfFrames - 1 - step);
+      vtkMRMLVolumeNode* eagerVolume = vtkMRMLVolumeNode::SafeDownCast(eagerSequenceNode->GetNthDataNode(itemNumber));
+      CHECK_NOT_NULL(eagerVolume);
+      CHECK_BOOL(isSameImage(eagerVolume->GetImageData(),
+        lazyFrameLoader->GetFrameImage(lazySequenceNode.GetPointer(), itemNumber)), true);
+      CHECK_BOOL(lazyFrameLoader->IsDataNodeLoadPending(lazySequenceNode->GetNthDataNodeWithoutLoading(itemNumber)), true);
+      CHECK_BOOL(lazyFrameLoader->GetNumberOfCachedFrames() <= 2, true);
+      }
+    }
+
+  // Getting a data node loads it, it keeps its voxels while other frames are browsed
+  CHECK_EXIT_SUCCESS(compareFrame(eagerSequenceNode.GetPointer(), lazySequenceNode.GetPointer(), 0));
+  CHECK_BOOL(lazyFrameLoader->IsDataNodeLoadPending(firstLazyDataNode), false);
+  CHECK_NULL(lazyFrameLoader->GetFrameImage(lazySequenceNode.GetPointer(), 0));
+  for (int itemNumber = 1; itemNumber < numberOfFrames; ++itemNumber)
+    {
+    CHECK_NOT_NULL(lazyFrameLoader->GetFrameImage(lazySequenceNode.GetPointer(), itemNumber));
+    }
+  CHECK_EXIT_SUCCESS(compareFrame(eagerSequenceNode.GetPointer(), lazySequenceNode.GetPointer(), 1));
+  CHECK_EXIT_SUCCESS(compareFrame(eagerSequenceNode.GetPointer(), lazySequenceNode.GetPointer(), numberOfFrames - 1));
+  CHECK_BOOL(isSameImage(vtkMRMLVolumeNode::SafeDownCast(eagerSequenceNode->GetNthDataNode(0))->GetImageData(),
+    vtkMRMLVolumeNode::SafeDownCast(firstLazyDataNode)->GetImageData()), true);
+
+  // All frames are loaded when the loader is no longer used
+  lazyFrameLoader->LoadAllDataNodes();
+  CHECK_INT(lazyFrameLoader->GetNumberOfCachedFrames(), 0);
+  lazySequenceNode->SetFrameLoader(nullptr);
+  for (int itemNumber = 0; itemNumber < numberOfFrames; ++itemNumber)
+    {
+    CHECK_EXIT_SUCCESS(compareFrame(eagerSequenceNode.GetPointer(), lazySequenceNode.GetPointer(), itemNumber));
+    }
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkMRMLVolumeSequenceFrameLoaderTest1(int argc, char* argv[])
+{
+  if (argc != 2)
+    {
+    std::cerr << "Usage: " << argv[0] << " /path/to/temp" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const char* tempDir = argv[1];
+  std::string fileName = std::string(tempDir) + "/vtkMRMLVolumeSequenceFrameLoaderTest1.seq.nrrd";
+
+  vtkNew<vtkMRMLVolumeSequenceFrameLoader> frameLoader;
+  EXERCISE_BASIC_OBJECT_METHODS(frameLoader.GetPointer());
+
+  // Create a sequence of volumes, each voxel value is unique
+  const int numberOfFrames = 6;
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLSequenceNode> sequenceNode;
+  scene->AddNode(sequenceNode.GetPointer());
+  for (int frameIndex = 0; frameIndex < numberOfFrames; ++frameIndex)
+    {
+    vtkNew<vtkImageData> image;
+    image->SetDimensions(9, 7, 5);
+    image->AllocateScalars(VTK_SHORT, 1);
+    short* voxels = static_cast<short*>(image->GetScalarPointer());
+    for (vtkIdType voxelIndex = 0; voxelIndex < image->GetNumberOfPoints(); ++voxelIndex)
+      {
+      voxels[voxelIndex] = static_cast<short>(frameIndex * 1000 - voxelIndex);
+      }
+    vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+    volumeNode->SetAndObserveImageData(image.GetPointer());
+    std::ostringstream indexValue;
+    indexValue << frameIndex;
+    sequenceNode->SetDataNodeAtValue(volumeNode.GetPointer(), indexValue.str());
+    }
+
+  // Frames are read on demand from the uncompressed file, the compressed file is read completely
+  for (int useCompression = 0; useCompression < 2; ++useCompression)
+    {
+    vtkNew<vtkMRMLVolumeSequenceStorageNode> storageNode;
+    scene->AddNode(storageNode.GetPointer());
+    storageNode->SetFileName(fileName.c_str());
+    storageNode->SetUseCompression(useCompression);
+    CHECK_BOOL(storageNode->WriteData(sequenceNode.GetPointer()), true);
+    CHECK_EXIT_SUCCESS(testLoadOnDemand(scene.GetPointer(), fileName, useCompression == 0));
+    }
+
+  std::cout << "Success" << std::endl;
+  return EXIT_SUCCESS;
+}
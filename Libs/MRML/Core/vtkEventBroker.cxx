@@ -95,6 +95,12 @@ vtkEventBroker::vtkEventBroker()
   this->EventNestingLevel = 0;
   this->TimerLog = vtkTimerLog::New();
   this->CompressCallData = 0;
+  this->MaximumLatency = 0.05;
+  this->EventBatchLevel = 0;
+  this->EventQueueStartTime = 0.0;
+  this->ProcessingEventQueue = false;
+  this->NumberOfQueuedEvents = 0;
+  this->NumberOfCoalescedEvents = 0;
   this->LogFileName = nullptr;
   this->ScriptHandler = nullptr;
   this->ScriptHandlerClientData = nullptr;
@@ -681,7 +687,8 @@ void vtkEventBroker::ProcessEvent ( vtkObservation *observation, vtkObject *call
   //
   if ( eid == observation->GetEvent() || observation->GetEvent() == vtkCommand::AnyEvent )
     {
-    if ( this->EventMode == vtkEventBroker::Synchronous || eid == vtkCommand::DeleteEvent )
+    if ( (this->EventMode == vtkEventBroker::Synchronous && this->EventBatchLevel == 0)
+         || eid == vtkCommand::DeleteEvent )
       {
       this->InvokeObservation( observation, eid, callData );
       }
@@ -689,6 +696,21 @@ void vtkEventBroker::ProcessEvent ( vtkObservation *observation, vtkObject *call
       {
       this->QueueObservation( observation, eid, callData );
       }
+    else if ( this->EventMode == vtkEventBroker::Synchronous )
+      {
+      // inside a batch, the queue is processed by EndEventBatch()
+      this->QueueObservation( observation, eid, callData );
+      }
+    else if ( this->EventMode == vtkEventBroker::Coalescing )
+      {
+      this->QueueObservation( observation, eid, callData );
+      // flush now if the oldest pending event has waited for too long
+      if ( !this->ProcessingEventQueue && this->EventBatchLevel == 0 &&
+           this->TimerLog->GetUniversalTime() - this->EventQueueStartTime > this->MaximumLatency )
+        {
+        this->ProcessEventQueue();
+        }
+      }
     else
       {
       vtkErrorMacro ( "Bad EventMode " << this->EventMode );
@@ -748,12 +770,39 @@ void vtkEventBroker::QueueObservation ( vtkObservation *observation,
   //    one unique entry for each
   // it it's not there, add the current call data to the list so that each unique combination
   // can be invoked.
+  // When coalescing, only keep one call per event id (with the most recent call data).
   // If the event is not currently in the queue, add it and keep a flag.
   //
+  this->NumberOfQueuedEvents++;
+  if ( this->EventQueue.empty() )
+    {
+    this->EventQueueStartTime = this->TimerLog->GetUniversalTime();
+    }
   vtkObservation::CallType call(eid, callData);
-  if ( this->GetCompressCallData() &&
+  if ( this->IsCoalescingEvents() )
+    {
+    std::deque< vtkObservation::CallType >::iterator dataIter;
+    for(dataIter=observation->GetCallDataList()->begin();dataIter != observation->GetCallDataList()->end(); dataIter++)
+      {
+      if ( call.EventID == dataIter->EventID )
+        {
+        dataIter->CallData = call.CallData;
+        this->NumberOfCoalescedEvents++;
+        break;
+        }
+      }
+    if ( dataIter == observation->GetCallDataList()->end() )
+      {
+      observation->GetCallDataList()->push_back( call );
+      }
+    }
+  else if ( this->GetCompressCallData() &&
        observation->GetEvent() != vtkCommand::AnyEvent)
     {
+    if ( !observation->GetCallDataList()->empty() )
+      {
+      this->NumberOfCoalescedEvents += observation->GetCallDataList()->size();
+      }
     observation->GetCallDataList()->clear();
     observation->GetCallDataList()->push_back( call );
     }
@@ -772,6 +821,10 @@ void vtkEventBroker::QueueObservation ( vtkObservation *observation,
       {
       observation->GetCallDataList()->push_back( call );
       }
+    else
+      {
+      this->NumberOfCoalescedEvents++;
+      }
     }
 
   if ( !observation->GetInEventQueue() )
@@ -859,6 +912,15 @@ void vtkEventBroker::ProcessEventQueue ()
   // - if the observation is no longer in the queue, stop processing events
   // - unregister before after dequeing in case the observation should go away
   //
+  if ( this->ProcessingEventQueue && this->EventMode != vtkEventBroker::Asynchronous )
+    {
+    // the queue is being processed already (an observer triggered the flush),
+    // the outer loop will take care of the newly queued observations
+    return;
+    }
+  // In asynchronous mode, nested calls process the queue as they always did
+  bool wasProcessingEventQueue = this->ProcessingEventQueue;
+  this->ProcessingEventQueue = true;
   while ( this->GetNumberOfQueuedObservations() > 0 )
     {
     vtkObservation *observation = this->EventQueue.front();
@@ -880,6 +942,43 @@ void vtkEventBroker::ProcessEventQueue ()
     this->DequeueObservation();
     observation->Delete();
     }
+  this->ProcessingEventQueue = wasProcessingEventQueue;
+}
+
+//----------------------------------------------------------------------------
+void vtkEventBroker::StartEventBatch()
+{
+  this->EventBatchLevel++;
+}
+
+//----------------------------------------------------------------------------
+void vtkEventBroker::EndEventBatch()
+{
+  if ( this->EventBatchLevel <= 0 )
+    {
+    vtkErrorMacro( "EndEventBatch: no batch was started" );
+    return;
+    }
+  this->EventBatchLevel--;
+  if ( this->EventBatchLevel == 0 &&
+       this->EventMode != vtkEventBroker::Asynchronous )
+    {
+    this->ProcessEventQueue();
+    }
+}
+
+//----------------------------------------------------------------------------
+bool vtkEventBroker::IsCoalescingEvents()
+{
+  return this->EventMode == vtkEventBroker::Coalescing ||
+    (this->EventMode == vtkEventBroker::Synchronous && this->EventBatchLevel > 0);
+}
+
+//----------------------------------------------------------------------------
+void vtkEventBroker::ResetEventCounters()
+{
+  this->NumberOfQueuedEvents = 0;
+  this->NumberOfCoalescedEvents = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -890,6 +989,10 @@ void vtkEventBroker::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "NumberOfObservations: " << this->GetNumberOfObservations() << "\n";
   os << indent << "NumberOfQueueObservations: " << this->GetNumberOfQueuedObservations() << "\n";
   os << indent << "EventMode: " << this->GetEventModeAsString() << "\n";
+  os << indent << "MaximumLatency: " << this->MaximumLatency << "\n";
+  os << indent << "EventBatchLevel: " << this->EventBatchLevel << "\n";
+  os << indent << "NumberOfQueuedEvents: " << this->NumberOfQueuedEvents << "\n";
+  os << indent << "NumberOfCoalescedEvents: " << this->NumberOfCoalescedEvents << "\n";
   os << indent << "EventLogging: " << this->EventLogging << "\n";
   os << indent << "EventNestingLevel: " << this->EventNestingLevel << "\n";
   os << indent << "LogFileName: " <<
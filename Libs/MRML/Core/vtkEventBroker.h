@@ -177,11 +177,21 @@ public:
   /// Event Queue processing modes
   ///
   /// In synchronous mode, observations are invoked immediately when the
-  /// event takes place.  In asynchronous mode, observations are added
+  /// event takes place, except inside an event batch (see StartEventBatch()).
+  /// In asynchronous mode, observations are added
   /// to the event queue for later invocation.
+  /// In coalescing mode, observations are queued as in asynchronous mode but
+  /// all the pending invocations of the same event of an observation (same
+  /// subject, event and observer) are merged into a single invocation
+  /// with the most recent call data. The queue is processed when
+  /// ProcessEventQueue() is called (typically from an application timer),
+  /// at the end of the outermost event batch, or when an event is queued
+  /// while the oldest pending event has been waiting for more than
+  /// MaximumLatency seconds.
   enum EventMode {
     Synchronous,
-    Asynchronous
+    Asynchronous,
+    Coalescing
   };
   vtkGetMacro(EventMode, int);
   void SetEventMode(int eventMode)
@@ -196,12 +206,39 @@ public:
 
   void SetEventModeToSynchronous() {this->SetEventMode(vtkEventBroker::Synchronous);};
   void SetEventModeToAsynchronous() {this->SetEventMode(vtkEventBroker::Asynchronous);};
+  void SetEventModeToCoalescing() {this->SetEventMode(vtkEventBroker::Coalescing);};
   const char * GetEventModeAsString() {
     if (this->EventMode == vtkEventBroker::Synchronous) return ("Synchronous");
     if (this->EventMode == vtkEventBroker::Asynchronous) return ("Asynchronous");
+    if (this->EventMode == vtkEventBroker::Coalescing) return ("Coalescing");
     return "Undefined";
   }
 
+  ///
+  /// Maximum time (in seconds) an event can stay in the queue
+  /// in coalescing mode. Default is 0.05s.
+  vtkSetMacro(MaximumLatency, double);
+  vtkGetMacro(MaximumLatency, double);
+
+  ///
+  /// Mark the beginning and the end of a group of modifications, for example
+  /// the mouse moves of an interactive drag. In synchronous and coalescing
+  /// modes, the events triggered inside the batch are coalesced and the
+  /// observations are invoked once at the end of the outermost batch.
+  /// Batches have no effect in asynchronous mode.
+  /// Calls can be nested and must be balanced, see MRMLEventBatchBlocker.
+  void StartEventBatch();
+  void EndEventBatch();
+  vtkGetMacro(EventBatchLevel, int);
+
+  ///
+  /// Number of events that have been put in the queue (asynchronous and
+  /// coalescing modes) and number of those that have been dropped because
+  /// they were merged with an already pending invocation.
+  vtkGetMacro(NumberOfQueuedEvents, unsigned long);
+  vtkGetMacro(NumberOfCoalescedEvents, unsigned long);
+  void ResetEventCounters();
+
 
   /// Event queue processing
 
@@ -286,6 +323,20 @@ protected:
   int EventMode;
   int CompressCallData;
 
+  double MaximumLatency;
+  int EventBatchLevel;
+  /// Time when the oldest event in the queue was queued
+  double EventQueueStartTime;
+  /// Prevent recursive processing of the queue when coalescing
+  bool ProcessingEventQueue;
+
+  /// Return true if the queued events must be coalesced:
+  /// in coalescing mode or inside a batch in synchronous mode.
+  bool IsCoalescingEvents();
+
+  unsigned long NumberOfQueuedEvents;
+  unsigned long NumberOfCoalescedEvents;
+
   std::ofstream LogFile;
 private:
   /// DetachObservations is a fast (but dangerous) method to delete all the
@@ -296,6 +347,22 @@ private:
   friend class vtkObservation;
 };
 
+/// Utility class to group the events triggered while it exists into one
+/// event batch of the vtkEventBroker instance.
+/// Example: { MRMLEventBatchBlocker batch; node->SetXYZ(...); ... }
+class VTK_MRML_EXPORT MRMLEventBatchBlocker
+{
+public:
+  MRMLEventBatchBlocker()
+  {
+    vtkEventBroker::GetInstance()->StartEventBatch();
+  };
+  ~MRMLEventBatchBlocker()
+  {
+    vtkEventBroker::GetInstance()->EndEventBatch();
+  };
+};
+
 /// Utility class to make sure qSlicerModuleManager is initialized before it is used.
 class VTK_MRML_EXPORT vtkEventBrokerInitialize
 {
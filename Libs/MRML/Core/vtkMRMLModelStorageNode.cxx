@@ -149,6 +149,12 @@ bool vtkMRMLModelStorageNode::CanReadInReferenceNode(vtkMRMLNode *refNode)
   return refNode->IsA("vtkMRMLModelNode");
 }
 
+//----------------------------------------------------------------------------
+bool vtkMRMLModelStorageNode::CanPrefetchData(vtkMRMLNode *refNode)
+{
+  return this->CanReadInReferenceNode(refNode);
+}
+
 //----------------------------------------------------------------------------
 int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
 {
@@ -391,26 +397,54 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
       }
     vtkMRMLModelStorageNode::ConvertBetweenRASAndLPS(meshFromFile, meshToSetInNode);
     }
+  if (this->PrefetchInBackground)
+    {
+    // Observing the mesh is not thread-safe, the mesh is set in the node
+    // in ApplyPrefetchedData, in the main thread.
+    this->PrefetchedMesh = meshToSetInNode;
+    return 1;
+    }
   modelNode->SetAndObserveMesh(meshToSetInNode);
+  this->UpdateDisplayNodesScalarRange(modelNode);
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLModelStorageNode::ApplyPrefetchedData(vtkMRMLNode* refNode, vtkMRMLNode* prefetchedNode)
+{
+  Superclass::ApplyPrefetchedData(refNode, prefetchedNode);
+  vtkMRMLModelNode* modelNode = vtkMRMLModelNode::SafeDownCast(refNode);
+  vtkMRMLModelStorageNode* prefetchStorageNode = vtkMRMLModelStorageNode::SafeDownCast(this->PrefetchStorageNode);
+  if (modelNode && prefetchStorageNode && prefetchStorageNode->PrefetchedMesh)
+    {
+    modelNode->SetAndObserveMesh(prefetchStorageNode->PrefetchedMesh);
+    prefetchStorageNode->PrefetchedMesh = nullptr;
+    }
+  // Display nodes are not available in the background thread, update them now
+  this->UpdateDisplayNodesScalarRange(modelNode);
+}
 
-  if (modelNode->GetMesh() != nullptr)
+//----------------------------------------------------------------------------
+void vtkMRMLModelStorageNode::UpdateDisplayNodesScalarRange(vtkMRMLModelNode* modelNode)
+{
+  if (!modelNode || modelNode->GetMesh() == nullptr)
+    {
+    return;
+    }
+  for (int i=0; i<modelNode->GetNumberOfDisplayNodes(); ++i)
     {
-    for (int i=0; i<modelNode->GetNumberOfDisplayNodes(); ++i)
+    vtkMRMLDisplayNode* displayNode = modelNode->GetNthDisplayNode(i);
+    // is there an active scalar array?
+    if (displayNode && displayNode->GetScalarRangeFlag() == vtkMRMLDisplayNode::UseDataScalarRange)
       {
-      vtkMRMLDisplayNode* displayNode = modelNode->GetNthDisplayNode(i);
-      // is there an active scalar array?
-      if (displayNode && displayNode->GetScalarRangeFlag() == vtkMRMLDisplayNode::UseDataScalarRange)
+      double *scalarRange = modelNode->GetMesh()->GetScalarRange();
+      if (scalarRange)
         {
-        double *scalarRange = modelNode->GetMesh()->GetScalarRange();
-        if (scalarRange)
-          {
-          vtkDebugMacro("ReadDataInternal (" << (this->ID ? this->ID : "(unknown)") << "): setting scalar range " << scalarRange[0] << ", " << scalarRange[1]);
-          displayNode->SetScalarRange(scalarRange);
-          }
+        vtkDebugMacro("ReadDataInternal (" << (this->ID ? this->ID : "(unknown)") << "): setting scalar range " << scalarRange[0] << ", " << scalarRange[1]);
+        displayNode->SetScalarRange(scalarRange);
         }
-      } // For all display nodes
-    }
-  return 1;
+      }
+    } // For all display nodes
 }
 
 //----------------------------------------------------------------------------
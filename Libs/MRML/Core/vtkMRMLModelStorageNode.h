@@ -45,6 +45,9 @@ public:
   /// Return true if the reference node can be read in
   bool CanReadInReferenceNode(vtkMRMLNode *refNode) override;
 
+  /// Files can be read in a background thread when a scene is loaded.
+  bool CanPrefetchData(vtkMRMLNode* refNode) override;
+
   /// Get/Set flag that controls if points are to be written in various coordinate systems
   vtkSetClampMacro(CoordinateSystem, int, 0, vtkMRMLStorageNode::CoordinateSystemType_Last-1);
   vtkGetMacro(CoordinateSystem, int);
@@ -69,6 +72,13 @@ protected:
   /// Read data and set it in the referenced node
   int ReadDataInternal(vtkMRMLNode *refNode) override;
 
+  /// Set the prefetched mesh in the referenced node and update the scalar range of its display nodes.
+  /// The mesh is set here, in the main thread, because setting it adds observers through vtkEventBroker.
+  void ApplyPrefetchedData(vtkMRMLNode* refNode, vtkMRMLNode* prefetchedNode) override;
+
+  /// Set scalar range of display nodes that use the data scalar range
+  void UpdateDisplayNodesScalarRange(vtkMRMLModelNode* modelNode);
+
   /// Write data from a  referenced node
   int WriteDataInternal(vtkMRMLNode *refNode) override;
 
@@ -79,6 +89,9 @@ protected:
   static int GetCoordinateSystemFromFieldData(vtkPointSet* mesh);
 
   int CoordinateSystem;
+
+  /// Mesh read in a background thread, set in the model node by ApplyPrefetchedData
+  vtkSmartPointer<vtkPointSet> PrefetchedMesh;
 };
 
 #endif
@@ -122,6 +122,12 @@ bool vtkMRMLNRRDStorageNode::CanReadInReferenceNode(vtkMRMLNode *refNode)
          refNode->IsA("vtkMRMLDiffusionTensorVolumeNode");
 }
 
+//----------------------------------------------------------------------------
+bool vtkMRMLNRRDStorageNode::CanPrefetchData(vtkMRMLNode *refNode)
+{
+  return this->CanReadInReferenceNode(refNode);
+}
+
 //----------------------------------------------------------------------------
 int vtkMRMLNRRDStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
 {
@@ -167,7 +173,7 @@ int vtkMRMLNRRDStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     reader->SetUseNativeOriginOn();
     }
 
-  if (volNode->GetImageData())
+  if (volNode->GetImageData() && !this->PrefetchInBackground)
     {
     volNode->SetAndObserveImageData (nullptr);
     }
@@ -299,10 +305,30 @@ int vtkMRMLNRRDStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
   ici->SetOutputOrigin( 0, 0, 0 );
   ici->Update();
 
+  if (this->PrefetchInBackground)
+    {
+    // Observing the image data is not thread-safe, the image data is set in the node
+    // in ApplyPrefetchedData, in the main thread.
+    this->PrefetchedImageDataProducer = ici.GetPointer();
+    return 1;
+    }
   volNode->SetImageDataConnection(ici->GetOutputPort());
   return 1;
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLNRRDStorageNode::ApplyPrefetchedData(vtkMRMLNode* refNode, vtkMRMLNode* prefetchedNode)
+{
+  Superclass::ApplyPrefetchedData(refNode, prefetchedNode);
+  vtkMRMLVolumeNode* volNode = vtkMRMLVolumeNode::SafeDownCast(refNode);
+  vtkMRMLNRRDStorageNode* prefetchStorageNode = vtkMRMLNRRDStorageNode::SafeDownCast(this->PrefetchStorageNode);
+  if (volNode && prefetchStorageNode && prefetchStorageNode->PrefetchedImageDataProducer)
+    {
+    volNode->SetImageDataConnection(prefetchStorageNode->PrefetchedImageDataProducer->GetOutputPort());
+    prefetchStorageNode->PrefetchedImageDataProducer = nullptr;
+    }
+}
+
 //----------------------------------------------------------------------------
 int vtkMRMLNRRDStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
 {
@@ -16,6 +16,7 @@
 #define __vtkMRMLNRRDStorageNode_h
 
 #include "vtkMRMLStorageNode.h"
+class vtkAlgorithm;
 class vtkDoubleArray;
 class vtkTeemNRRDReader;
 
@@ -60,6 +61,9 @@ class VTK_MRML_EXPORT vtkMRMLNRRDStorageNode : public vtkMRMLStorageNode
   /// Return true if the node can be read in.
   bool CanReadInReferenceNode(vtkMRMLNode *refNode) override;
 
+  /// Files can be read in a background thread when a scene is loaded.
+  bool CanPrefetchData(vtkMRMLNode* refNode) override;
+
   ///
   /// Configure the storage node for data exchange. This is an
   /// opportunity to optimize the storage node's settings, for
@@ -88,6 +92,10 @@ protected:
   /// Read data and set it in the referenced node
   int ReadDataInternal(vtkMRMLNode *refNode) override;
 
+  /// Set the prefetched image data in the referenced node.
+  /// The image data is set here, in the main thread, because setting it adds observers through vtkEventBroker.
+  void ApplyPrefetchedData(vtkMRMLNode* refNode, vtkMRMLNode* prefetchedNode) override;
+
   /// Write data from a  referenced node
   int WriteDataInternal(vtkMRMLNode *refNode) override;
 
@@ -95,6 +103,9 @@ protected:
   int GetGzipCompressionLevelFromCompressionParameter(std::string parameter);
 
   int CenterImage;
+
+  /// Image data read in a background thread, set in the volume node by ApplyPrefetchedData
+  vtkSmartPointer<vtkAlgorithm> PrefetchedImageDataProducer;
 };
 
 #endif
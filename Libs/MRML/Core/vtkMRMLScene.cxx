@@ -67,6 +67,7 @@ Version:   $Revision: 1.18 $
 #include "vtkMRMLSubjectHierarchyNode.h"
 #include "vtkMRMLTableNode.h"
 #include "vtkMRMLTableStorageNode.h"
+#include "vtkMRMLTableBinaryStorageNode.h"
 #include "vtkMRMLTableViewNode.h"
 #include "vtkMRMLTextNode.h"
 #include "vtkMRMLTextStorageNode.h"
@@ -76,6 +77,7 @@ Version:   $Revision: 1.18 $
 #include "vtkMRMLVectorVolumeDisplayNode.h"
 #include "vtkMRMLViewNode.h"
 #include "vtkMRMLVolumeArchetypeStorageNode.h"
+#include "vtkMRMLVolumeNode.h"
 #include "vtkMRMLVolumeSequenceStorageNode.h"
 #include "vtkURIHandler.h"
 
@@ -93,9 +95,13 @@ Version:   $Revision: 1.18 $
 #include <vtkCollection.h>
 #include <vtkDebugLeaks.h>
 #include <vtkErrorCode.h>
+#include <vtkImageData.h>
+#include <vtkIntArray.h>
 #include <vtkObjectFactory.h>
 #include <vtkPNGWriter.h>
+#include <vtkPointSet.h>
 #include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
 
 // VTKSYS includes
 #include <vtksys/RegularExpression.hxx>
@@ -104,14 +110,12 @@ Version:   $Revision: 1.18 $
 
 // STD includes
 #include <algorithm>
+#include <atomic>
 #include <numeric>
+#include <thread>
 
 //#define MRMLSCENE_VERBOSE
 
-#ifdef MRMLSCENE_VERBOSE
-# include <vtkTimerLog.h>
-#endif
-
 vtkCxxSetObjectMacro(vtkMRMLScene, CacheManager, vtkCacheManager)
 vtkCxxSetObjectMacro(vtkMRMLScene, DataIOManager, vtkDataIOManager)
 vtkCxxSetObjectMacro(vtkMRMLScene, UserTagTable, vtkTagTable)
@@ -121,6 +125,7 @@ vtkCxxSetObjectMacro(vtkMRMLScene, URIHandlerCollection, vtkCollection)
 vtkMRMLScene::vtkMRMLScene()
 {
   this->NodeIDsMTime = 0;
+  this->NodeClassIndexNextPosition = 0;
 
   this->RegisteredNodeClasses.clear();
   this->UniqueIDs.clear();
@@ -128,6 +133,7 @@ vtkMRMLScene::vtkMRMLScene()
 
   this->Nodes =  vtkCollection::New();
   this->MaximumNumberOfSavedUndoStates = 20;
+  this->MaximumUndoStackMemorySize = 0;
   this->UndoFlag = false;
 
   this->NodeReferences.clear();
@@ -145,6 +151,8 @@ vtkMRMLScene::vtkMRMLScene()
   this->SaveToXMLString = 0;
 
   this->ReadDataOnLoad = 1;
+  this->NumberOfDataReadingThreads = 0;
+  this->LastImportNumberOfPrefetchedFiles = 0;
 
   this->LastLoadedVersion = nullptr;
   this->Version = nullptr;
@@ -158,6 +166,10 @@ vtkMRMLScene::vtkMRMLScene()
   // is caught by other observers.
   this->AddObserver(vtkCommand::DeleteEvent, this->DeleteEventCallback, 1000.);
 
+  this->NodeSnapshotCallbackCommand = vtkCallbackCommand::New();
+  this->NodeSnapshotCallbackCommand->SetClientData( reinterpret_cast<void *>(this) );
+  this->NodeSnapshotCallbackCommand->SetCallback( vtkMRMLScene::NodeSnapshotCallback );
+
   //
   // Register all the 'built-in' nodes for the library
   // SmartPointer is used to create an instance of the class, and destroy immediately after registration is complete.
@@ -228,6 +240,7 @@ vtkMRMLScene::vtkMRMLScene()
   this->RegisterNodeClass( vtkSmartPointer< vtkMRMLChartViewNode >::New() );
   this->RegisterNodeClass( vtkSmartPointer< vtkMRMLTableNode >::New() );
   this->RegisterNodeClass( vtkSmartPointer< vtkMRMLTableStorageNode >::New() );
+  this->RegisterNodeClass( vtkSmartPointer< vtkMRMLTableBinaryStorageNode >::New() );
   this->RegisterNodeClass( vtkSmartPointer< vtkMRMLTableViewNode >::New() );
   this->RegisterNodeClass( vtkSmartPointer< vtkMRMLTextNode >::New() );
   this->RegisterNodeClass( vtkSmartPointer< vtkMRMLTextStorageNode >::New() );
@@ -247,6 +260,7 @@ vtkMRMLScene::~vtkMRMLScene()
 {
   this->ClearUndoStack ( );
   this->ClearRedoStack ( );
+  this->RemoveUnusedNodeSnapshots(true);
 
   if ( this->Nodes != nullptr )
     {
@@ -292,6 +306,11 @@ vtkMRMLScene::~vtkMRMLScene()
     this->DeleteEventCallback->Delete();
     this->DeleteEventCallback = nullptr;
     }
+  if ( this->NodeSnapshotCallbackCommand != nullptr )
+    {
+    this->NodeSnapshotCallbackCommand->Delete();
+    this->NodeSnapshotCallbackCommand = nullptr;
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -773,6 +792,9 @@ int vtkMRMLScene::Import()
   this->SetUndoOff();
   this->StartState(vtkMRMLScene::ImportState);
   this->ReferencedIDChanges.clear();
+  this->LastImportDataFileNames.clear();
+  this->LastImportDataReadingTimes.clear();
+  this->LastImportNumberOfPrefetchedFiles = 0;
 
   // read nodes into a temp scene
   vtkSmartPointer<vtkCollection> loadedNodes = vtkSmartPointer<vtkCollection>::New();
@@ -816,6 +838,10 @@ int vtkMRMLScene::Import()
 
     this->InvokeEvent(vtkMRMLScene::NewSceneEvent, nullptr);
 
+    // Read independent data files in parallel. Storage nodes then use the
+    // prefetched data when UpdateScene is called.
+    std::map<vtkMRMLStorageNode*, double> prefetchTimes = this->PrefetchStorableNodesData(addedNodes);
+
     // Notify the imported nodes about that all nodes are created
     // (so the observers can be attached to referenced nodes, etc.)
     // by calling UpdateScene on each node
@@ -827,7 +853,26 @@ int vtkMRMLScene::Import()
       vtkDebugMacro("Adding Node: " << (node->GetName() ? node->GetName() : "(undefined)"));
       if (node->GetAddToScene())
         {
+        vtkMRMLStorableNode* storableNode = vtkMRMLStorableNode::SafeDownCast(node);
+        vtkMRMLStorageNode* storageNode = storableNode ? storableNode->GetStorageNode() : nullptr;
+        double startTime = vtkTimerLog::GetUniversalTime();
         node->UpdateScene(this);
+        if (storageNode && storageNode->GetFileName())
+          {
+          double readingTime = vtkTimerLog::GetUniversalTime() - startTime;
+          std::map<vtkMRMLStorageNode*, double>::iterator prefetchTimeIt = prefetchTimes.find(storageNode);
+          if (prefetchTimeIt != prefetchTimes.end())
+            {
+            readingTime += prefetchTimeIt->second;
+            }
+          this->LastImportDataFileNames.push_back(storageNode->GetFileName());
+          this->LastImportDataReadingTimes.push_back(readingTime);
+          if (storageNode->GetLastReadUsedPrefetchedData())
+            {
+            this->LastImportNumberOfPrefetchedFiles++;
+            }
+          vtkDebugMacro("Import: read " << storageNode->GetFileName() << " in " << readingTime << "s");
+          }
         }
       if (this->GetErrorCode() == 1)
         {
@@ -840,10 +885,22 @@ int vtkMRMLScene::Import()
         }
       }
 
+    // Discard data that was prefetched but not used (e.g., storage node was not read)
+    for (std::map<vtkMRMLStorageNode*, double>::iterator prefetchTimeIt = prefetchTimes.begin();
+      prefetchTimeIt != prefetchTimes.end(); ++prefetchTimeIt)
+      {
+      prefetchTimeIt->first->ClearPrefetchedData();
+      }
+
     this->Modified();
     this->RemoveUnusedNodeReferences();
 #ifdef MRMLSCENE_VERBOSE
     updateSceneTimer->StopTimer();
+    for (size_t fileIndex = 0; fileIndex < this->LastImportDataFileNames.size(); ++fileIndex)
+      {
+      std::cerr << "vtkMRMLScene::Import()::ReadData " << this->LastImportDataFileNames[fileIndex]
+        << ": " << this->LastImportDataReadingTimes[fileIndex] << std::endl;
+      }
 #endif
     }
   else
@@ -889,6 +946,83 @@ int vtkMRMLScene::Import()
   return returnCode;
 }
 
+//------------------------------------------------------------------------------
+std::map<vtkMRMLStorageNode*, double> vtkMRMLScene::PrefetchStorableNodesData(vtkCollection* nodes)
+{
+  std::map<vtkMRMLStorageNode*, double> prefetchTimes;
+  unsigned int numberOfThreads = (this->NumberOfDataReadingThreads > 0
+    ? static_cast<unsigned int>(this->NumberOfDataReadingThreads) : std::thread::hardware_concurrency());
+  if (numberOfThreads <= 1 || !this->ReadDataOnLoad)
+    {
+    return prefetchTimes;
+    }
+
+  // Temporary nodes for reading are created in the main thread. Only nodes that have
+  // a single storage node are prefetched (if there are multiple storage nodes then
+  // each reads into the same node, in order) and a storage node that is shared
+  // between multiple storable nodes is only prefetched for the first one.
+  std::vector<vtkMRMLStorageNode*> storageNodes;
+  vtkMRMLNode* node = nullptr;
+  vtkCollectionSimpleIterator it;
+  for (nodes->InitTraversal(it); (node = vtkMRMLNode::SafeDownCast(nodes->GetNextItemAsObject(it))); )
+    {
+    vtkMRMLStorableNode* storableNode = vtkMRMLStorableNode::SafeDownCast(node);
+    if (!storableNode || !storableNode->GetAddToScene() || storableNode->GetNumberOfStorageNodes() != 1)
+      {
+      continue;
+      }
+    vtkMRMLStorageNode* storageNode = storableNode->GetStorageNode();
+    if (!storageNode || prefetchTimes.find(storageNode) != prefetchTimes.end())
+      {
+      continue;
+      }
+    if (storageNode->InitializePrefetchData(storableNode))
+      {
+      storageNodes.push_back(storageNode);
+      prefetchTimes[storageNode] = 0.0;
+      }
+    }
+  if (storageNodes.empty())
+    {
+    return prefetchTimes;
+    }
+
+  // Each thread reads the next file that is not read yet
+  std::atomic<size_t> nextStorageNodeIndex(0);
+  auto prefetchData = [&storageNodes, &nextStorageNodeIndex]()
+    {
+    for (size_t storageNodeIndex = nextStorageNodeIndex++; storageNodeIndex < storageNodes.size();
+      storageNodeIndex = nextStorageNodeIndex++)
+      {
+      storageNodes[storageNodeIndex]->PrefetchData();
+      }
+    };
+  numberOfThreads = std::min(numberOfThreads, static_cast<unsigned int>(storageNodes.size()));
+  std::vector<std::thread> threads;
+  for (unsigned int threadIndex = 1; threadIndex < numberOfThreads; ++threadIndex)
+    {
+    threads.emplace_back(prefetchData);
+    }
+  prefetchData();
+  for (std::thread& thread : threads)
+    {
+    thread.join();
+    }
+
+  for (vtkMRMLStorageNode* storageNode : storageNodes)
+    {
+    prefetchTimes[storageNode] = storageNode->GetPrefetchTime();
+    }
+  return prefetchTimes;
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLScene::GetLastImportDataReadingTimes(std::vector<std::string>& fileNames, std::vector<double>& readingTimes)
+{
+  fileNames = this->LastImportDataFileNames;
+  readingTimes = this->LastImportDataReadingTimes;
+}
+
 //------------------------------------------------------------------------------
 int vtkMRMLScene::LoadIntoScene(vtkCollection* nodeCollection)
 {
@@ -1207,6 +1341,7 @@ vtkMRMLNode* vtkMRMLScene::AddNodeNoNotify(vtkMRMLNode *n)
 
   // cache the node so the whole scene cache stays up-to date
   this->AddNodeID(n);
+  this->AddNodeToClassIndex(n);
 
   // Keep the SH up-to-date
   if (vtkMRMLSubjectHierarchyNode::SafeDownCast(n) != nullptr &&
@@ -1424,6 +1559,7 @@ void vtkMRMLScene::RemoveNode(vtkMRMLNode *n)
 
   std::string nid = (n->GetID() ? n->GetID() : "");
   this->RemoveNodeID(n->GetID());
+  this->RemoveNodeFromClassIndex(n);
 
   this->InvokeEvent(vtkMRMLScene::NodeRemovedEvent, n);
 
@@ -1601,15 +1737,17 @@ int vtkMRMLScene::GetNumberOfNodesByClass(const char *className)
     vtkErrorMacro("GetNumberOfNodesByClass: class name is null.");
     return 0;
     }
+  this->UpdateNodeIDs();
   int num=0;
-  vtkMRMLNode *node;
-  vtkCollectionSimpleIterator it;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
+  const std::vector<std::string>& classNames = this->GetIndexedClassNames(className);
+  for (std::vector<std::string>::const_iterator classNameIt = classNames.begin();
+    classNameIt != classNames.end(); ++classNameIt)
     {
-    if (node->IsA(className))
+    std::map< std::string, NodeClassIndexBucketType >::iterator bucketIt =
+      this->NodeClassIndex.find(*classNameIt);
+    if (bucketIt != this->NodeClassIndex.end())
       {
-      num++;
+      num += static_cast<int>(bucketIt->second.GetNumberOfNodes());
       }
     }
   return num;
@@ -1624,16 +1762,7 @@ int vtkMRMLScene::GetNodesByClass(const char *className, std::vector<vtkMRMLNode
     vtkErrorMacro("GetNodesByClass: class name is null.");
     return 0;
     }
-  vtkMRMLNode *node;
-  vtkCollectionSimpleIterator it;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
-    {
-    if (node->IsA(className))
-      {
-      nodes.push_back(node);
-      }
-    }
+  this->GetIndexedNodesByClass(className, nodes);
   return static_cast<int>(nodes.size());
 }
 
@@ -1646,15 +1775,11 @@ vtkCollection* vtkMRMLScene::GetNodesByClass(const char *className)
     return nullptr;
     }
   vtkCollection* nodes = vtkCollection::New();
-  vtkMRMLNode *node;
-  vtkCollectionSimpleIterator it;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
+  std::vector<vtkMRMLNode*> foundNodes;
+  this->GetIndexedNodesByClass(className, foundNodes);
+  for (std::vector<vtkMRMLNode*>::iterator nodeIt = foundNodes.begin(); nodeIt != foundNodes.end(); ++nodeIt)
     {
-    if (node->IsA(className))
-      {
-      nodes->AddItem(node);
-      }
+    nodes->AddItem(*nodeIt);
     }
   return nodes;
 }
@@ -1791,28 +1916,60 @@ vtkMRMLNode* vtkMRMLScene::GetNthNodeByClass(int n, const char *className)
     return nullptr;
     }
 
-  int num=0;
-  vtkMRMLNode *node;
-  vtkCollectionSimpleIterator it;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
-    {
-    if (node->IsA(className))
+  this->UpdateNodeIDs();
+  const std::vector<std::string>& classNames = this->GetIndexedClassNames(className);
+  if (classNames.size() == 1)
+    {
+    // Fast path: nodes of a single class are already in scene order
+    std::map< std::string, NodeClassIndexBucketType >::iterator bucketIt =
+      this->NodeClassIndex.find(classNames[0]);
+    if (bucketIt == this->NodeClassIndex.end()
+      || n >= static_cast<int>(bucketIt->second.GetNumberOfNodes()))
       {
-      if (num == n)
-        {
-        return node;
-        }
-      num++;
+      return nullptr;
       }
+    bucketIt->second.Compact();
+    return bucketIt->second.Nodes[n].second;
     }
-  return nullptr;
+  const std::vector<vtkMRMLNode*>& nodes = this->GetMergedIndexedNodesByClass(className);
+  if (n >= static_cast<int>(nodes.size()))
+    {
+    return nullptr;
+    }
+  return nodes[n];
 }
 
 //------------------------------------------------------------------------------
 vtkMRMLNode* vtkMRMLScene::GetFirstNodeByClass(const char *className)
 {
-  return this->GetNthNodeByClass(0, className);
+  if (className == nullptr)
+    {
+    vtkErrorMacro("GetFirstNodeByClass: class name is null.");
+    return nullptr;
+    }
+  this->UpdateNodeIDs();
+  // The first node is the one with the lowest position among all matching classes
+  vtkMRMLNode* firstNode = nullptr;
+  unsigned long firstPosition = 0;
+  const std::vector<std::string>& classNames = this->GetIndexedClassNames(className);
+  for (std::vector<std::string>::const_iterator classNameIt = classNames.begin();
+    classNameIt != classNames.end(); ++classNameIt)
+    {
+    std::map< std::string, NodeClassIndexBucketType >::iterator bucketIt =
+      this->NodeClassIndex.find(*classNameIt);
+    if (bucketIt == this->NodeClassIndex.end() || bucketIt->second.GetNumberOfNodes() == 0)
+      {
+      continue;
+      }
+    bucketIt->second.Compact();
+    const std::pair<unsigned long, vtkMRMLNode*>& firstBucketNode = bucketIt->second.Nodes.front();
+    if (!firstNode || firstBucketNode.first < firstPosition)
+      {
+      firstNode = firstBucketNode.second;
+      firstPosition = firstBucketNode.first;
+      }
+    }
+  return firstNode;
 }
 
 //------------------------------------------------------------------------------
@@ -2050,8 +2207,11 @@ vtkMRMLNode* vtkMRMLScene::InsertAfterNode(vtkMRMLNode *item, vtkMRMLNode *n)
     vtkDebugMacro("InsertAfterNode: item index = " << itemIndex-1 << ", inserting after index = " << index);
     this->Nodes->vtkCollection::InsertItem(index, (vtkObject *)n);
     }
-  // cache the node so the whole scene cache stays up-to-date
-  this->AddNodeID(n);
+  // cache the node so the whole scene cache stays up-to-date.
+  // The node may not be at the end of the collection, rebuild the caches to
+  // keep the class index in scene order.
+  this->NodeIDsMTime = 0;
+  this->UpdateNodeIDs();
 
   n->SetDisableModifiedEvent(modifyStatus);
 
@@ -2148,8 +2308,11 @@ vtkMRMLNode* vtkMRMLScene::InsertBeforeNode(vtkMRMLNode *item, vtkMRMLNode *n)
     vtkDebugMacro("InsertBeforeNode: item index = " << itemIndex-1 << ", inserting after index = " << index);
     this->Nodes->vtkCollection::InsertItem(index, (vtkObject *)n);
     }
-  // cache the node so the whole scene cache stays up-todate
-  this->AddNodeID(n);
+  // cache the node so the whole scene cache stays up-to-date.
+  // The node may not be at the end of the collection, rebuild the caches to
+  // keep the class index in scene order.
+  this->NodeIDsMTime = 0;
+  this->UpdateNodeIDs();
 
   n->SetDisableModifiedEvent(modifyStatus);
 
@@ -2515,6 +2678,8 @@ void vtkMRMLScene::SaveStateForUndo (vtkMRMLNode *node)
     {
     this->CopyNodeInUndoStack(node);
     }
+  // memory size of the saved state is only known after nodes are copied
+  this->TrimUndoStack();
 }
 
 //------------------------------------------------------------------------------
@@ -2546,6 +2711,8 @@ void vtkMRMLScene::SaveStateForUndo (std::vector<vtkMRMLNode *> nodes)
       this->CopyNodeInUndoStack(node);
       }
     }
+  // memory size of the saved state is only known after nodes are copied
+  this->TrimUndoStack();
 }
 
 //------------------------------------------------------------------------------
@@ -2585,6 +2752,8 @@ void vtkMRMLScene::SaveStateForUndo (vtkCollection* nodes)
       this->CopyNodeInUndoStack(node);
       }
     }
+  // memory size of the saved state is only known after nodes are copied
+  this->TrimUndoStack();
 }
 
 //------------------------------------------------------------------------------
@@ -2660,6 +2829,284 @@ void vtkMRMLScene::PushIntoRedoStack()
   this->RedoStack.push_back(newScene);
 }
 
+//------------------------------------------------------------------------------
+namespace
+{
+// Image or mesh data of volume and model nodes, which may be shared between undo snapshots
+vtkDataObject* GetNodeBulkData(vtkMRMLNode* node)
+{
+  vtkMRMLVolumeNode* volumeNode = vtkMRMLVolumeNode::SafeDownCast(node);
+  if (volumeNode)
+    {
+    return volumeNode->GetImageData();
+    }
+  vtkMRMLModelNode* modelNode = vtkMRMLModelNode::SafeDownCast(node);
+  if (modelNode)
+    {
+    return modelNode->GetMesh();
+    }
+  return nullptr;
+}
+
+// Get bulk data of those nodes of a saved state that are not in the current scene
+// (nodes of the current scene do not use extra memory)
+void GetSavedStateBulkData(vtkCollection* savedState, const std::set<vtkMRMLNode*>& currentNodes,
+  std::set<vtkDataObject*>& savedBulkData)
+{
+  for (int n = 0; n < savedState->GetNumberOfItems(); n++)
+    {
+    vtkMRMLNode* node = vtkMRMLNode::SafeDownCast(savedState->GetItemAsObject(n));
+    if (!node || currentNodes.find(node) != currentNodes.end())
+      {
+      continue;
+      }
+    vtkDataObject* bulkData = GetNodeBulkData(node);
+    if (bulkData)
+      {
+      savedBulkData.insert(bulkData);
+      }
+    }
+}
+
+// Memory size of bulk data in bytes
+vtkTypeInt64 GetBulkDataMemorySize(vtkDataObject* bulkData)
+{
+  // GetActualMemorySize returns size in kibibytes
+  return static_cast<vtkTypeInt64>(bulkData->GetActualMemorySize()) * 1024;
+}
+
+void SetNodeBulkData(vtkMRMLNode* node, vtkDataObject* bulkData)
+{
+  vtkMRMLVolumeNode* volumeNode = vtkMRMLVolumeNode::SafeDownCast(node);
+  if (volumeNode)
+    {
+    volumeNode->SetAndObserveImageData(vtkImageData::SafeDownCast(bulkData));
+    return;
+    }
+  vtkMRMLModelNode* modelNode = vtkMRMLModelNode::SafeDownCast(node);
+  if (modelNode)
+    {
+    modelNode->SetAndObserveMesh(vtkPointSet::SafeDownCast(bulkData));
+    }
+}
+
+// Same as vtkMRMLNode::CopyWithScene but bulk data is not copied from the source node,
+// the target node uses the specified bulk data instead.
+// The node class must implement CopyContent (HasCopyContent() returns true).
+void CopyWithSceneUsingBulkData(vtkMRMLNode* target, vtkMRMLNode* source, vtkDataObject* bulkData)
+{
+  MRMLNodeModifyBlocker blocker(target);
+  if (source->GetScene())
+    {
+    target->SetScene(source->GetScene());
+    }
+  if (source->GetID())
+    {
+    target->SetID(source->GetID());
+    }
+  if (source->GetName() && strcmp(source->GetName(), ""))
+    {
+    target->SetName(source->GetName());
+    }
+  target->SetHideFromEditors(source->GetHideFromEditors());
+  target->SetAddToScene(source->GetAddToScene());
+  if (source->GetSingletonTag())
+    {
+    target->SetSingletonTag(source->GetSingletonTag());
+    }
+  target->SetUndoEnabled(source->GetUndoEnabled());
+  target->CopyContent(source, false);
+  SetNodeBulkData(target, bulkData);
+  target->CopyReferences(source);
+}
+}
+
+//------------------------------------------------------------------------------
+vtkSmartPointer<vtkMRMLNode> vtkMRMLScene::GetNodeSnapshot(vtkMRMLNode* node)
+{
+  vtkMRMLNode* lastSnapshot = nullptr;
+  bool nodeModified = true;
+  NodeSnapshotsType::iterator snapshotIt = this->NodeSnapshots.find(node);
+  if (snapshotIt != this->NodeSnapshots.end() && snapshotIt->second.Node == node)
+    {
+    lastSnapshot = snapshotIt->second.Snapshot;
+    nodeModified = snapshotIt->second.NodeModified;
+    }
+  if (lastSnapshot && !nodeModified)
+    {
+    // node has not been modified since the last snapshot
+    return lastSnapshot;
+    }
+
+  vtkSmartPointer<vtkMRMLNode> snapshot = vtkSmartPointer<vtkMRMLNode>::Take(node->CreateNodeInstance());
+  if (snapshot.GetPointer() == nullptr)
+    {
+    vtkErrorMacro("GetNodeSnapshot: failed to create instance of " << node->GetClassName());
+    return nullptr;
+    }
+  vtkDataObject* lastSnapshotBulkData = GetNodeBulkData(lastSnapshot);
+  if (lastSnapshotBulkData && GetNodeBulkData(node) && node->HasCopyContent())
+    {
+    // only node properties were modified, bulk data can be shared with the last snapshot
+    CopyWithSceneUsingBulkData(snapshot, node, lastSnapshotBulkData);
+    }
+  else
+    {
+    snapshot->CopyWithScene(node);
+    }
+  this->SetNodeSnapshot(node, snapshot);
+  return snapshot;
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLScene::SetNodeSnapshot(vtkMRMLNode* node, vtkMRMLNode* snapshot)
+{
+  NodeSnapshotInfo& snapshotInfo = this->NodeSnapshots[node];
+  if (snapshotInfo.Node.GetPointer() != node)
+    {
+    // New entry or a left-over entry of a deleted node that had the same address
+    snapshotInfo.Node = node;
+    snapshotInfo.ObserverTags.clear();
+    vtkIntArray* contentModifiedEvents = node->GetContentModifiedEvents();
+    for (int i = 0; contentModifiedEvents && i < contentModifiedEvents->GetNumberOfValues(); i++)
+      {
+      snapshotInfo.ObserverTags.push_back(node->AddObserver(
+        contentModifiedEvents->GetValue(i), this->NodeSnapshotCallbackCommand));
+      }
+    // Node references are copied to snapshots, too
+    snapshotInfo.ObserverTags.push_back(node->AddObserver(
+      vtkMRMLNode::ReferenceAddedEvent, this->NodeSnapshotCallbackCommand));
+    snapshotInfo.ObserverTags.push_back(node->AddObserver(
+      vtkMRMLNode::ReferenceModifiedEvent, this->NodeSnapshotCallbackCommand));
+    snapshotInfo.ObserverTags.push_back(node->AddObserver(
+      vtkMRMLNode::ReferenceRemovedEvent, this->NodeSnapshotCallbackCommand));
+    }
+  snapshotInfo.Snapshot = snapshot;
+  snapshotInfo.NodeModified = false;
+}
+
+//------------------------------------------------------------------------------
+bool vtkMRMLScene::IsNodeSnapshotUpToDate(vtkMRMLNode* node, vtkMRMLNode* snapshot)
+{
+  NodeSnapshotsType::iterator snapshotIt = this->NodeSnapshots.find(node);
+  if (snapshotIt == this->NodeSnapshots.end() || snapshotIt->second.Node != node)
+    {
+    return false;
+    }
+  return (snapshot != nullptr && snapshotIt->second.Snapshot == snapshot && !snapshotIt->second.NodeModified);
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLScene::NodeSnapshotCallback(vtkObject *caller, unsigned long eid,
+                                        void *clientData, void *vtkNotUsed(callData))
+{
+  vtkMRMLScene *self = reinterpret_cast<vtkMRMLScene *>(clientData);
+  vtkMRMLNode* node = vtkMRMLNode::SafeDownCast(caller);
+  if (self == nullptr || node == nullptr)
+    {
+    return;
+    }
+  NodeSnapshotsType::iterator snapshotIt = self->NodeSnapshots.find(node);
+  if (snapshotIt == self->NodeSnapshots.end() || snapshotIt->second.Node != node)
+    {
+    return;
+    }
+  if (eid == vtkCommand::ModifiedEvent
+    || eid == vtkMRMLNode::ReferenceAddedEvent
+    || eid == vtkMRMLNode::ReferenceModifiedEvent
+    || eid == vtkMRMLNode::ReferenceRemovedEvent)
+    {
+    snapshotIt->second.NodeModified = true;
+    }
+  else
+    {
+    // Content (such as bulk data) is modified, the last snapshot cannot be reused.
+    // Observers are kept, as a new snapshot of the node is likely to be created.
+    snapshotIt->second.Snapshot = nullptr;
+    }
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLScene::DetachNodeSnapshot(vtkMRMLNode* snapshot, vtkCollection* restoredState)
+{
+  if (!snapshot)
+    {
+    return;
+    }
+  vtkDataObject* bulkData = GetNodeBulkData(snapshot);
+
+  // Other saved states keep a copy of the node
+  vtkSmartPointer<vtkMRMLNode> replacement;
+  std::list< vtkCollection* >* stacks[2] = { &this->UndoStack, &this->RedoStack };
+  for (std::list< vtkCollection* >* stack : stacks)
+    {
+    for (vtkCollection* savedState : *stack)
+      {
+      if (savedState == restoredState)
+        {
+        continue;
+        }
+      int index = savedState->IsItemPresent(snapshot);
+      if (index == 0)
+        {
+        continue;
+        }
+      if (replacement.GetPointer() == nullptr)
+        {
+        replacement = vtkSmartPointer<vtkMRMLNode>::Take(snapshot->CreateNodeInstance());
+        if (bulkData && snapshot->HasCopyContent())
+          {
+          CopyWithSceneUsingBulkData(replacement, snapshot, bulkData);
+          }
+        else
+          {
+          replacement->CopyWithScene(snapshot);
+          }
+        }
+      savedState->ReplaceItem(index - 1, replacement);
+      }
+    }
+  for (NodeSnapshotsType::iterator snapshotIt = this->NodeSnapshots.begin();
+    snapshotIt != this->NodeSnapshots.end(); ++snapshotIt)
+    {
+    if (snapshotIt->second.Snapshot == snapshot)
+      {
+      snapshotIt->second.Snapshot = replacement.GetPointer();
+      }
+    }
+
+  // Bulk data may be shared with other snapshots
+  if (bulkData)
+    {
+    vtkSmartPointer<vtkDataObject> bulkDataCopy = vtkSmartPointer<vtkDataObject>::Take(bulkData->NewInstance());
+    bulkDataCopy->DeepCopy(bulkData);
+    SetNodeBulkData(snapshot, bulkDataCopy);
+    }
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLScene::RemoveUnusedNodeSnapshots(bool removeAll/*=false*/)
+{
+  for (NodeSnapshotsType::iterator snapshotIt = this->NodeSnapshots.begin();
+    snapshotIt != this->NodeSnapshots.end(); )
+    {
+    if (!removeAll && snapshotIt->second.Node && snapshotIt->second.Snapshot)
+      {
+      ++snapshotIt;
+      continue;
+      }
+    vtkMRMLNode* node = snapshotIt->second.Node;
+    if (node)
+      {
+      for (unsigned long observerTag : snapshotIt->second.ObserverTags)
+        {
+        node->RemoveObserver(observerTag);
+        }
+      }
+    this->NodeSnapshots.erase(snapshotIt++);
+    }
+}
+
 //------------------------------------------------------------------------------
 // Put a replacement node into the undoable copy of the scene so that the node
 // can be edited
@@ -2671,10 +3118,10 @@ void vtkMRMLScene::CopyNodeInUndoStack(vtkMRMLNode *copyNode)
     return;
     }
 
-  vtkMRMLNode *snode = copyNode->CreateNodeInstance();
-  if (snode != nullptr)
+  vtkSmartPointer<vtkMRMLNode> snode = this->GetNodeSnapshot(copyNode);
+  if (snode.GetPointer() == nullptr)
     {
-    snode->CopyWithScene(copyNode);
+    return;
     }
 
   vtkCollection* undoScene = this->UndoStack.back();
@@ -2688,7 +3135,6 @@ void vtkMRMLScene::CopyNodeInUndoStack(vtkMRMLNode *copyNode)
       break;
       }
     }
-  snode->Delete();
 }
 
 //------------------------------------------------------------------------------
@@ -2701,10 +3147,10 @@ void vtkMRMLScene::CopyNodeInRedoStack(vtkMRMLNode *copyNode)
     vtkErrorMacro("CopyNodeInRedoStack: node is null");
     return;
     }
-  vtkMRMLNode *snode = copyNode->CreateNodeInstance();
-  if (snode != nullptr)
+  vtkSmartPointer<vtkMRMLNode> snode = this->GetNodeSnapshot(copyNode);
+  if (snode.GetPointer() == nullptr)
     {
-    snode->CopyWithScene(copyNode);
+    return;
     }
   vtkCollection* undoScene = this->RedoStack.back();
   int nnodes = undoScene->GetNumberOfItems();
@@ -2717,7 +3163,6 @@ void vtkMRMLScene::CopyNodeInRedoStack(vtkMRMLNode *copyNode)
       break;
       }
     }
-  snode->Delete();
 }
 
 //------------------------------------------------------------------------------
@@ -2801,7 +3246,11 @@ void vtkMRMLScene::Undo()
       // nodes differ, copy from undo to current scene
       // but before create a copy in redo stack from current
       this->CopyNodeInRedoStack(*curIterNode);
-      (*curIterNode)->CopyWithScene(*iterNode);
+      if (!this->IsNodeSnapshotUpToDate(*curIterNode, *iterNode))
+        {
+        (*curIterNode)->CopyWithScene(*iterNode);
+        this->SetNodeSnapshot(*curIterNode, *iterNode);
+        }
       }
     }
 
@@ -2819,6 +3268,7 @@ void vtkMRMLScene::Undo()
 
   for (nn=0; nn<addNodes.size(); nn++)
     {
+    this->DetachNodeSnapshot(addNodes[nn], undoScene);
     this->AddNode(addNodes[nn]);
     addNodes[nn]->SetSceneReferences();
     }
@@ -2933,7 +3383,11 @@ void vtkMRMLScene::Redo()
       // nodes differ, copy from redo to current scene
       // but before create a copy in undo stack from current
       this->CopyNodeInUndoStack(curIter->second);
-      curIter->second->CopyWithScene(iter->second);
+      if (!this->IsNodeSnapshotUpToDate(curIter->second, iter->second))
+        {
+        curIter->second->CopyWithScene(iter->second);
+        this->SetNodeSnapshot(curIter->second, iter->second);
+        }
       }
     }
 
@@ -2956,6 +3410,7 @@ void vtkMRMLScene::Redo()
 
   for (nn=0; nn<addNodes.size(); nn++)
     {
+    this->DetachNodeSnapshot(addNodes[nn], undoScene);
     this->AddNode(addNodes[nn]);
     }
   for (nn=0; nn<removeNodes.size(); nn++)
@@ -2984,6 +3439,7 @@ void vtkMRMLScene::ClearUndoStack()
     (*iter)->Delete();
     }
   this->UndoStack.clear();
+  this->RemoveUnusedNodeSnapshots();
 }
 
 //------------------------------------------------------------------------------
@@ -2996,6 +3452,7 @@ void vtkMRMLScene::ClearRedoStack()
     (*iter)->Delete();
     }
   this->RedoStack.clear();
+  this->RemoveUnusedNodeSnapshots();
 }
 
 //------------------------------------------------------------------------------
@@ -3265,6 +3722,7 @@ void vtkMRMLScene::UpdateNodeIDs()
   if (this->Nodes->GetNumberOfItems() == 0)
     {
     this->ClearNodeIDs();
+    this->ClearNodeClassIndex();
     }
   else if (this->Nodes->GetMTime() > this->NodeIDsMTime)
     {
@@ -3277,6 +3735,7 @@ void vtkMRMLScene::UpdateNodeIDs()
                       " without having the map in sync.");
       }
     this->ClearNodeIDs();
+    this->ClearNodeClassIndex();
 #ifdef MRMLSCENE_VERBOSE
     std::cerr << "Recompute node id cache..." << std::endl;
 #endif
@@ -3289,6 +3748,7 @@ void vtkMRMLScene::UpdateNodeIDs()
         {
         this->AddNodeID(node);
         }
+      this->AddNodeToClassIndex(node);
       }
     }
 }
@@ -3323,6 +3783,193 @@ void vtkMRMLScene::ClearNodeIDs()
   }
 }
 
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::AddNodeToClassIndex(vtkMRMLNode *node)
+{
+  if (!node || !node->GetClassName())
+    {
+    return;
+    }
+  if (this->NodeClassIndexPositions.find(node) != this->NodeClassIndexPositions.end())
+    {
+    // already indexed
+    return;
+    }
+  std::string className = node->GetClassName();
+  std::map< std::string, NodeClassIndexBucketType >::iterator bucketIt =
+    this->NodeClassIndex.find(className);
+  if (bucketIt == this->NodeClassIndex.end())
+    {
+    bucketIt = this->NodeClassIndex.insert(
+      std::make_pair(className, NodeClassIndexBucketType())).first;
+    // The new class may match previously queried classes
+    this->NodeClassIndexMatches.clear();
+    }
+  // Positions are increasing, nodes stay sorted
+  unsigned long position = this->NodeClassIndexNextPosition++;
+  bucketIt->second.Nodes.push_back(std::make_pair(position, node));
+  this->NodeClassIndexPositions[node] = position;
+  this->NodeClassIndexMTime.Modified();
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::RemoveNodeFromClassIndex(vtkMRMLNode *node)
+{
+  std::map< vtkMRMLNode*, unsigned long >::iterator positionIt =
+    this->NodeClassIndexPositions.find(node);
+  if (positionIt == this->NodeClassIndexPositions.end())
+    {
+    return;
+    }
+  unsigned long position = positionIt->second;
+  this->NodeClassIndexPositions.erase(positionIt);
+  // The class name of a node never changes, so the bucket can be found directly.
+  std::map< std::string, NodeClassIndexBucketType >::iterator bucketIt =
+    this->NodeClassIndex.find(node->GetClassName());
+  if (bucketIt == this->NodeClassIndex.end())
+    {
+    vtkErrorMacro("RemoveNodeFromClassIndex: class index is out of sync for " << node->GetClassName());
+    return;
+    }
+  NodeClassIndexBucketType& bucket = bucketIt->second;
+  std::vector< std::pair<unsigned long, vtkMRMLNode*> >::iterator nodeIt = std::lower_bound(
+    bucket.Nodes.begin(), bucket.Nodes.end(), std::make_pair(position, static_cast<vtkMRMLNode*>(nullptr)));
+  if (nodeIt == bucket.Nodes.end() || nodeIt->first != position)
+    {
+    vtkErrorMacro("RemoveNodeFromClassIndex: class index is out of sync for " << node->GetClassName());
+    return;
+    }
+  nodeIt->second = nullptr;
+  ++bucket.NumberOfRemovedNodes;
+  this->NodeClassIndexMTime.Modified();
+  if (bucket.GetNumberOfNodes() == 0)
+    {
+    // Buckets are never empty: GetIndexedClassNames() needs a node to check
+    // the class hierarchy.
+    this->NodeClassIndex.erase(bucketIt);
+    }
+  else if (bucket.NumberOfRemovedNodes > bucket.Nodes.size() / 2)
+    {
+    bucket.Compact();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::NodeClassIndexBucketType::Compact()
+{
+  if (this->NumberOfRemovedNodes == 0)
+    {
+    return;
+    }
+  this->Nodes.erase(std::remove_if(this->Nodes.begin(), this->Nodes.end(),
+    [](const std::pair<unsigned long, vtkMRMLNode*>& positionedNode) { return positionedNode.second == nullptr; }),
+    this->Nodes.end());
+  this->NumberOfRemovedNodes = 0;
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::ClearNodeClassIndex()
+{
+  this->NodeClassIndex.clear();
+  this->NodeClassIndexPositions.clear();
+  this->NodeClassIndexMatches.clear();
+  this->NodeClassIndexMergedNodes.clear();
+  this->NodeClassIndexNextPosition = 0;
+  this->NodeClassIndexMTime.Modified();
+}
+
+//-----------------------------------------------------------------------------
+const std::vector<std::string>& vtkMRMLScene::GetIndexedClassNames(const char* className)
+{
+  std::string queriedClassName(className);
+  std::map< std::string, std::vector<std::string> >::iterator matchIt =
+    this->NodeClassIndexMatches.find(queriedClassName);
+  if (matchIt != this->NodeClassIndexMatches.end())
+    {
+    return matchIt->second;
+    }
+  std::vector<std::string>& matchingClassNames = this->NodeClassIndexMatches[queriedClassName];
+  for (std::map< std::string, NodeClassIndexBucketType >::iterator bucketIt = this->NodeClassIndex.begin();
+    bucketIt != this->NodeClassIndex.end(); ++bucketIt)
+    {
+    bucketIt->second.Compact();
+    if (bucketIt->second.Nodes.front().second->IsA(className))
+      {
+      matchingClassNames.push_back(bucketIt->first);
+      }
+    }
+  return matchingClassNames;
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::GetIndexedNodesByClass(const char* className, std::vector<vtkMRMLNode*>& nodes)
+{
+  this->UpdateNodeIDs();
+  const std::vector<std::string>& classNames = this->GetIndexedClassNames(className);
+  if (classNames.size() > 1)
+    {
+    // Merging and sorting buckets is done once per index modification
+    const std::vector<vtkMRMLNode*>& mergedNodes = this->GetMergedIndexedNodesByClass(className);
+    nodes.insert(nodes.end(), mergedNodes.begin(), mergedNodes.end());
+    return;
+    }
+  std::vector< std::pair<unsigned long, vtkMRMLNode*> > positionedNodes;
+  for (std::vector<std::string>::const_iterator classNameIt = classNames.begin();
+    classNameIt != classNames.end(); ++classNameIt)
+    {
+    std::map< std::string, NodeClassIndexBucketType >::iterator bucketIt =
+      this->NodeClassIndex.find(*classNameIt);
+    if (bucketIt == this->NodeClassIndex.end())
+      {
+      continue;
+      }
+    bucketIt->second.Compact();
+    positionedNodes.insert(positionedNodes.end(), bucketIt->second.Nodes.begin(), bucketIt->second.Nodes.end());
+    }
+  nodes.reserve(nodes.size() + positionedNodes.size());
+  for (std::vector< std::pair<unsigned long, vtkMRMLNode*> >::iterator nodeIt = positionedNodes.begin();
+    nodeIt != positionedNodes.end(); ++nodeIt)
+    {
+    nodes.push_back(nodeIt->second);
+    }
+}
+
+//-----------------------------------------------------------------------------
+const std::vector<vtkMRMLNode*>& vtkMRMLScene::GetMergedIndexedNodesByClass(const char* className)
+{
+  this->UpdateNodeIDs();
+  NodeClassIndexMergedNodesType& mergedNodes = this->NodeClassIndexMergedNodes[std::string(className)];
+  if (mergedNodes.MTime == this->NodeClassIndexMTime.GetMTime())
+    {
+    return mergedNodes.Nodes;
+    }
+  const std::vector<std::string>& classNames = this->GetIndexedClassNames(className);
+  std::vector< std::pair<unsigned long, vtkMRMLNode*> > positionedNodes;
+  for (std::vector<std::string>::const_iterator classNameIt = classNames.begin();
+    classNameIt != classNames.end(); ++classNameIt)
+    {
+    std::map< std::string, NodeClassIndexBucketType >::iterator bucketIt =
+      this->NodeClassIndex.find(*classNameIt);
+    if (bucketIt == this->NodeClassIndex.end())
+      {
+      continue;
+      }
+    bucketIt->second.Compact();
+    positionedNodes.insert(positionedNodes.end(), bucketIt->second.Nodes.begin(), bucketIt->second.Nodes.end());
+    }
+  // Restore scene order across classes
+  std::sort(positionedNodes.begin(), positionedNodes.end());
+  mergedNodes.Nodes.clear();
+  mergedNodes.Nodes.reserve(positionedNodes.size());
+  for (std::vector< std::pair<unsigned long, vtkMRMLNode*> >::iterator nodeIt = positionedNodes.begin();
+    nodeIt != positionedNodes.end(); ++nodeIt)
+    {
+    mergedNodes.Nodes.push_back(nodeIt->second);
+    }
+  mergedNodes.MTime = this->NodeClassIndexMTime.GetMTime();
+  return mergedNodes.Nodes;
+}
+
 //------------------------------------------------------------------------------
 void vtkMRMLScene::AddURIHandler(vtkURIHandler *handler)
 {
@@ -3690,15 +4337,108 @@ void vtkMRMLScene::SetMaximumNumberOfSavedUndoStates(int stackSize)
   this->Modified();
 }
 
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::SetMaximumUndoStackMemorySize(vtkTypeInt64 size)
+{
+  if (size == this->MaximumUndoStackMemorySize)
+    {
+    return;
+    }
+
+  if (size < 0)
+    {
+    vtkErrorMacro("Cannot set maximum undo stack memory size to be a value less than 0");
+    return;
+    }
+
+  this->MaximumUndoStackMemorySize = size;
+  this->TrimUndoStack();
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+vtkTypeInt64 vtkMRMLScene::GetUndoStackMemorySize()
+{
+  std::set<vtkMRMLNode*> currentNodes = this->GetCurrentNodeSet();
+  std::set<vtkDataObject*> savedBulkData;
+  std::list< vtkCollection* >* stacks[2] = { &this->UndoStack, &this->RedoStack };
+  for (std::list< vtkCollection* >* stack : stacks)
+    {
+    for (vtkCollection* savedState : *stack)
+      {
+      GetSavedStateBulkData(savedState, currentNodes, savedBulkData);
+      }
+    }
+  vtkTypeInt64 memorySize = 0;
+  for (vtkDataObject* bulkData : savedBulkData)
+    {
+    memorySize += GetBulkDataMemorySize(bulkData);
+    }
+  return memorySize;
+}
+
+//-----------------------------------------------------------------------------
+std::set<vtkMRMLNode*> vtkMRMLScene::GetCurrentNodeSet()
+{
+  std::set<vtkMRMLNode*> currentNodes;
+  for (int n = 0; this->Nodes && n < this->Nodes->GetNumberOfItems(); n++)
+    {
+    currentNodes.insert(vtkMRMLNode::SafeDownCast(this->Nodes->GetItemAsObject(n)));
+    }
+  return currentNodes;
+}
+
 //-----------------------------------------------------------------------------
 void vtkMRMLScene::TrimUndoStack()
 {
   std::list<vtkSmartPointer<vtkCollection> > removedStacks;
   while(static_cast<int>(this->UndoStack.size()) > this->MaximumNumberOfSavedUndoStates)
     {
-    removedStacks.emplace_back(this->UndoStack.front());
+    removedStacks.push_back(vtkSmartPointer<vtkCollection>::Take(this->UndoStack.front()));
     this->UndoStack.pop_front();
     }
+  if (this->MaximumUndoStackMemorySize > 0 && this->UndoStack.size() > 1)
+    {
+    // Memory size is computed once. When the oldest state is removed, only the size of
+    // bulk data that is not referenced by any remaining saved state is subtracted.
+    std::set<vtkMRMLNode*> currentNodes = this->GetCurrentNodeSet();
+    std::map<vtkDataObject*, int> numberOfReferencingSavedStates;
+    std::list< vtkCollection* >* stacks[2] = { &this->UndoStack, &this->RedoStack };
+    for (std::list< vtkCollection* >* stack : stacks)
+      {
+      for (vtkCollection* savedState : *stack)
+        {
+        std::set<vtkDataObject*> savedBulkData;
+        GetSavedStateBulkData(savedState, currentNodes, savedBulkData);
+        for (vtkDataObject* bulkData : savedBulkData)
+          {
+          numberOfReferencingSavedStates[bulkData]++;
+          }
+        }
+      }
+    vtkTypeInt64 memorySize = 0;
+    for (const std::pair<vtkDataObject* const, int>& bulkDataReferences : numberOfReferencingSavedStates)
+      {
+      memorySize += GetBulkDataMemorySize(bulkDataReferences.first);
+      }
+    // the most recent state is always kept
+    while (this->UndoStack.size() > 1 && memorySize > this->MaximumUndoStackMemorySize)
+      {
+      std::set<vtkDataObject*> removedBulkData;
+      GetSavedStateBulkData(this->UndoStack.front(), currentNodes, removedBulkData);
+      for (vtkDataObject* bulkData : removedBulkData)
+        {
+        if (--numberOfReferencingSavedStates[bulkData] == 0)
+          {
+          memorySize -= GetBulkDataMemorySize(bulkData);
+          }
+        }
+      removedStacks.push_back(vtkSmartPointer<vtkCollection>::Take(this->UndoStack.front()));
+      this->UndoStack.pop_front();
+      }
+    }
+  removedStacks.clear();
+  this->RemoveUnusedNodeSnapshots();
 }
 
 //----------------------------------------------------------------------------
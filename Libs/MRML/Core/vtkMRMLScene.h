@@ -291,6 +291,9 @@ public:
   vtkMRMLNode* GetNthNode(int n);
 
   /// Get n-th node of a specified class in the scene
+  /// \note Class queries update the node ID and class index caches when the
+  /// scene has changed, they must not be called concurrently from multiple
+  /// threads.
   vtkMRMLNode* GetNthNodeByClass(int n, const char* className );
   /// Convenience function for getting 0-th node of a specified class in the scene
   vtkMRMLNode* GetFirstNodeByClass(const char* className);
@@ -497,6 +500,22 @@ public:
   vtkSetMacro(ReadDataOnLoad,int);
   vtkGetMacro(ReadDataOnLoad,int);
 
+  /// Number of threads used for reading data files when a scene is imported.
+  /// If 0 (default) then the number of available processor cores is used.
+  /// If 1 then data files are read one at a time in the main thread.
+  /// Only files of storage nodes that support it (see vtkMRMLStorageNode::CanPrefetchData)
+  /// are read in parallel. Nodes are still updated and all events are invoked
+  /// in the main thread, in the same order as without parallel reading.
+  vtkSetMacro(NumberOfDataReadingThreads, int);
+  vtkGetMacro(NumberOfDataReadingThreads, int);
+
+  /// Get the data files that were read in the last Import() and the time
+  /// spent reading each (in seconds).
+  void GetLastImportDataReadingTimes(std::vector<std::string>& fileNames, std::vector<double>& readingTimes);
+
+  /// Number of data files that were read in background threads in the last Import().
+  vtkGetMacro(LastImportNumberOfPrefetchedFiles, int);
+
   void SetErrorMessage(const std::string &error);
   std::string GetErrorMessage();
 
@@ -747,6 +766,17 @@ public:
   void SetMaximumNumberOfSavedUndoStates(int stackSize);
   vtkGetMacro(MaximumNumberOfSavedUndoStates, int);
 
+  /// \brief Sets the maximum memory size (in bytes) of image and mesh data saved in the undo stack.
+  /// The oldest saved states are removed until the stack fits in the budget, but the most recent
+  /// saved state is always kept. 0 (default) means no limit.
+  /// \sa GetUndoStackMemorySize()
+  void SetMaximumUndoStackMemorySize(vtkTypeInt64 size);
+  vtkGetMacro(MaximumUndoStackMemorySize, vtkTypeInt64);
+
+  /// \brief Returns the memory size (in bytes) of image and mesh data saved in the undo and redo stacks.
+  /// Data that is shared between saved states is counted only once.
+  vtkTypeInt64 GetUndoStackMemorySize();
+
   /// \brief Write the scene to a MRML scene bundle (.mrb) file.
   /// If thumbnail image is provided then it is saved in the scene's root folder.
   /// Returns false if the save failed
@@ -799,6 +829,36 @@ protected:
   void CopyNodeInUndoStack(vtkMRMLNode *node);
   void CopyNodeInRedoStack(vtkMRMLNode *node);
 
+  /// \brief Get a copy of the node that can be saved in the undo or redo stack.
+  ///
+  /// Snapshots are shared between saved states: if the node has not been modified
+  /// since its last snapshot was created (none of its content modified events were
+  /// invoked) then the last snapshot is returned. If only node properties were modified,
+  /// then the new snapshot shares image or mesh data with the last snapshot.
+  /// \sa vtkMRMLNode::GetContentModifiedEvents()
+  vtkSmartPointer<vtkMRMLNode> GetNodeSnapshot(vtkMRMLNode* node);
+
+  /// Store that \a snapshot is identical to the current content of \a node
+  /// and start tracking modifications of the node.
+  void SetNodeSnapshot(vtkMRMLNode* node, vtkMRMLNode* snapshot);
+
+  /// Returns true if \a node has not been modified since \a snapshot was created.
+  bool IsNodeSnapshotUpToDate(vtkMRMLNode* node, vtkMRMLNode* snapshot);
+
+  /// \brief Prepare a snapshot that is restored into the scene.
+  ///
+  /// Replaces the snapshot by a copy in other saved states (except in \a restoredState)
+  /// and makes the snapshot use its own image or mesh data, so that modifying the
+  /// node in the scene does not change saved states.
+  void DetachNodeSnapshot(vtkMRMLNode* snapshot, vtkCollection* restoredState);
+
+  /// Stop tracking modifications of nodes that have no snapshot in the undo or redo stack anymore.
+  /// If \a removeAll is true then tracking of all nodes is stopped.
+  void RemoveUnusedNodeSnapshots(bool removeAll=false);
+
+  /// Handle content modified events of nodes that have snapshots in the undo or redo stack.
+  static void NodeSnapshotCallback(vtkObject *caller, unsigned long eid, void *clientData, void *callData);
+
   /// Add a node to the scene without invoking a vtkMRMLScene::NodeAddedEvent event.
   ///
   /// \warning Use with extreme caution as it might unsynchronize observer.
@@ -843,12 +903,40 @@ protected:
   /// Clear NodeIDs map used to speedup GetByID() method.
   void ClearNodeIDs();
 
+  /// Add node to \a NodeClassIndex used to speedup GetNodesByClass() and
+  /// related methods.
+  void AddNodeToClassIndex(vtkMRMLNode *node);
+
+  /// Remove node from \a NodeClassIndex.
+  void RemoveNodeFromClassIndex(vtkMRMLNode *node);
+
+  /// Clear \a NodeClassIndex.
+  void ClearNodeClassIndex();
+
+  /// Get the class names in \a NodeClassIndex that are \a className or
+  /// derived from it (see vtkObject::IsA()).
+  /// The result is cached until a node of a not yet indexed class is added.
+  const std::vector<std::string>& GetIndexedClassNames(const char* className);
+
+  /// Append all nodes that are \a className or derived from it to \a nodes,
+  /// in the order they appear in the \a Nodes collection.
+  void GetIndexedNodesByClass(const char* className, std::vector<vtkMRMLNode*>& nodes);
+
+  /// Get all nodes that are \a className or derived from it, merged from all
+  /// matching class buckets and sorted in scene order.
+  /// The result is cached until \a NodeClassIndexMTime changes, so that
+  /// iterating with GetNthNodeByClass() over an abstract class is linear.
+  const std::vector<vtkMRMLNode*>& GetMergedIndexedNodesByClass(const char* className);
+
   /// Get a NodeReferences iterator for a node reference.
   NodeReferencesType::iterator FindNodeReference(const char* referencedId, vtkMRMLNode* referencingNode);
 
   /// Clean up elements of the undo/redo stack beyond the maximum size
   void TrimUndoStack();
 
+  /// Get all nodes of the scene (not including saved states)
+  std::set<vtkMRMLNode*> GetCurrentNodeSet();
+
   /// Reserve all node reference ids for a node
   void ReserveNodeReferenceIDs(vtkMRMLNode* node);
 
@@ -877,11 +965,26 @@ protected:
   std::vector<unsigned long> States;
 
   int  MaximumNumberOfSavedUndoStates;
+  vtkTypeInt64 MaximumUndoStackMemorySize;
   bool UndoFlag;
 
   std::list< vtkCollection* >  UndoStack;
   std::list< vtkCollection* >  RedoStack;
 
+  struct NodeSnapshotInfo
+    {
+    NodeSnapshotInfo() : NodeModified(false) {}
+    vtkWeakPointer<vtkMRMLNode> Node;
+    /// Most recent snapshot of the node in the undo or redo stack
+    vtkWeakPointer<vtkMRMLNode> Snapshot;
+    /// Node properties are modified since the snapshot was created (bulk data is not modified)
+    bool NodeModified;
+    std::vector<unsigned long> ObserverTags;
+    };
+  typedef std::map<vtkMRMLNode*, NodeSnapshotInfo> NodeSnapshotsType;
+  NodeSnapshotsType NodeSnapshots;
+  vtkCallbackCommand* NodeSnapshotCallbackCommand;
+
   std::string                 URL;
   std::string                 RootDirectory;
 
@@ -896,6 +999,37 @@ protected:
   std::map< std::string, std::string > ReferencedIDChanges;
   std::map< std::string, vtkSmartPointer<vtkMRMLNode> > NodeIDs;
 
+  /// Nodes of a class sorted by their insertion position in the scene.
+  /// Removed nodes are set to nullptr and erased when the bucket is compacted,
+  /// so that removing all nodes of a class is not quadratic.
+  struct NodeClassIndexBucketType
+  {
+    std::vector< std::pair<unsigned long, vtkMRMLNode*> > Nodes;
+    size_t NumberOfRemovedNodes{0};
+    size_t GetNumberOfNodes() const { return this->Nodes.size() - this->NumberOfRemovedNodes; }
+    /// Erase removed nodes. Nodes can then be accessed by index.
+    void Compact();
+  };
+  /// Nodes of the scene grouped by class name (vtkObject::GetClassName()).
+  /// It is kept in sync with \a NodeIDs.
+  /// Like \a NodeIDs, it is updated by const-like queries (GetNodesByClass(),
+  /// GetNthNodeByClass()...), which are therefore not thread-safe.
+  std::map< std::string, NodeClassIndexBucketType > NodeClassIndex;
+  /// Insertion position of each indexed node.
+  std::map< vtkMRMLNode*, unsigned long > NodeClassIndexPositions;
+  /// Indexed class names that are a given class (see GetIndexedClassNames())
+  std::map< std::string, std::vector<std::string> > NodeClassIndexMatches;
+  unsigned long NodeClassIndexNextPosition;
+  /// Modified when a node is added to or removed from \a NodeClassIndex.
+  vtkTimeStamp NodeClassIndexMTime;
+  struct NodeClassIndexMergedNodesType
+  {
+    vtkMTimeType MTime{0};
+    std::vector<vtkMRMLNode*> Nodes;
+  };
+  /// Cache of GetMergedIndexedNodesByClass() results by queried class name.
+  std::map< std::string, NodeClassIndexMergedNodesType > NodeClassIndexMergedNodes;
+
   // Stores default nodes. If a class is created or reset (using CreateNodeByClass or Clear) and
   // a default node is defined for it then the content of the default node will be used to initialize
   // the class. It is useful for overriding default values that are set in a node's constructor.
@@ -911,6 +1045,11 @@ protected:
 
   int ReadDataOnLoad;
 
+  int NumberOfDataReadingThreads;
+  std::vector<std::string> LastImportDataFileNames;
+  std::vector<double> LastImportDataReadingTimes;
+  int LastImportNumberOfPrefetchedFiles;
+
   vtkMTimeType  NodeIDsMTime;
 
   void RemoveAllNodes(bool removeSingletons);
@@ -928,6 +1067,11 @@ private:
   /// Returns nonzero on success
   int LoadIntoScene(vtkCollection* scene);
 
+  /// Read data files of storable nodes in background threads (see NumberOfDataReadingThreads).
+  /// The data is applied to the nodes when their storage nodes read data in the main thread.
+  /// Returns the storage nodes that prefetched data and the time spent reading in the background.
+  std::map<vtkMRMLStorageNode*, double> PrefetchStorableNodesData(vtkCollection* nodes);
+
   unsigned long ErrorCode;
 
   /// Time when the scene was last read or written.
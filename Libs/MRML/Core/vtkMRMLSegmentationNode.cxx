@@ -232,6 +232,8 @@ void vtkMRMLSegmentationNode::SetAndObserveSegmentation(vtkSegmentation* segment
       this->Segmentation, vtkSegmentation::RepresentationModified, this, this->SegmentationModifiedCallbackCommand);
     vtkEventBroker::GetInstance()->AddObservation(
       this->Segmentation, vtkSegmentation::SegmentsOrderModified, this, this->SegmentationModifiedCallbackCommand);
+    vtkEventBroker::GetInstance()->AddObservation(
+      this->Segmentation, vtkSegmentation::SegmentRepresentationsPending, this, this->SegmentationModifiedCallbackCommand);
   }
 }
 
@@ -281,6 +283,10 @@ void vtkMRMLSegmentationNode::SegmentationModifiedCallback(vtkObject* vtkNotUsed
       self->StorableModifiedTime.Modified();
       self->InvokeCustomModifiedEvent(eid);
       break;
+    case vtkSegmentation::SegmentRepresentationsPending:
+      // Representations are accessed directly through vtkSegmentation
+      self->ReadPendingLabelmapVoxels();
+      break;
     default:
       vtkErrorWithObjectMacro(self, "vtkMRMLSegmentationNode::SegmentationModifiedCallback: Unknown event id "<<eid);
       return;
@@ -328,6 +334,40 @@ void vtkMRMLSegmentationNode::OnSegmentModified(const char* vtkNotUsed(segmentId
 {
 }
 
+//---------------------------------------------------------------------------
+void vtkMRMLSegmentationNode::ProcessMRMLEvents(vtkObject* caller, unsigned long event, void* callData)
+{
+  vtkMRMLDisplayNode* displayNode = vtkMRMLDisplayNode::SafeDownCast(caller);
+  if (displayNode && event == vtkCommand::ModifiedEvent && displayNode->GetVisibility())
+    {
+    this->ReadPendingLabelmapVoxels();
+    }
+  this->Superclass::ProcessMRMLEvents(caller, event, callData);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSegmentationNode::OnNodeReferenceAdded(vtkMRMLNodeReference* reference)
+{
+  this->Superclass::OnNodeReferenceAdded(reference);
+  vtkMRMLDisplayNode* displayNode = vtkMRMLDisplayNode::SafeDownCast(reference->GetReferencedNode());
+  if (std::string(reference->GetReferenceRole()) == this->DisplayNodeReferenceRole
+    && displayNode && displayNode->GetVisibility())
+    {
+    // Segments must be complete by the time they are displayed
+    this->ReadPendingLabelmapVoxels();
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSegmentationNode::ReadPendingLabelmapVoxels()
+{
+  vtkMRMLSegmentationStorageNode* storageNode = vtkMRMLSegmentationStorageNode::SafeDownCast(this->GetStorageNode());
+  if (storageNode && storageNode->GetLabelmapVoxelsPending())
+    {
+    storageNode->ReadLabelmapVoxels(this);
+    }
+}
+
 //---------------------------------------------------------------------------
 void vtkMRMLSegmentationNode::OnSubjectHierarchyUIDAdded(
   vtkMRMLSubjectHierarchyNode* shNode, vtkIdType itemWithNewUID )
@@ -452,6 +492,7 @@ void vtkMRMLSegmentationNode::ApplyTransform(vtkAbstractTransform* transform)
     {
     return;
     }
+  this->ReadPendingLabelmapVoxels();
 
   // Apply transform on segmentation
   bool wasEnabled = this->Segmentation->SetMasterRepresentationModifiedEnabled(false);
@@ -527,6 +568,7 @@ void vtkMRMLSegmentationNode::GetRASBounds(double bounds[6])
 void vtkMRMLSegmentationNode::GetBounds(double bounds[6])
 {
   vtkMath::UninitializeBounds(bounds);
+  this->ReadPendingLabelmapVoxels();
   if (this->Segmentation)
     {
     this->Segmentation->GetBounds(bounds);
@@ -541,6 +583,7 @@ bool vtkMRMLSegmentationNode::GenerateMergedLabelmap(
   const std::vector<std::string>& segmentIDs/*=std::vector<std::string>()*/
   )
 {
+  this->ReadPendingLabelmapVoxels();
   return this->Segmentation->GenerateMergedLabelmap(mergedImageData, extentComputationMode, mergedLabelmapGeometry, segmentIDs);
 }
 
@@ -587,6 +630,7 @@ bool vtkMRMLSegmentationNode::GenerateEditMask(vtkOrientedImageData* maskImage,
     // input reference geometry is empty, so we don't need to generate a mask
     return true;
     }
+  this->ReadPendingLabelmapVoxels();
 
   std::vector<std::string> allSegmentIDs;
   this->GetSegmentation()->GetSegmentIDs(allSegmentIDs);
@@ -876,6 +920,7 @@ bool vtkMRMLSegmentationNode::CreateBinaryLabelmapRepresentation()
     vtkErrorMacro("CreateBinaryLabelmapRepresentation: Invalid segmentation");
     return false;
     }
+  this->ReadPendingLabelmapVoxels();
   return this->Segmentation->CreateRepresentation(vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName());
 }
 
@@ -898,6 +943,7 @@ void vtkMRMLSegmentationNode::GetBinaryLabelmapRepresentation(const std::string
     vtkErrorMacro("GetBinaryLabelmapRepresentation: Invalid segmentation");
     return;
     }
+  this->ReadPendingLabelmapVoxels();
   vtkSegment* segment = this->Segmentation->GetSegment(segmentId);
   if (!segment)
     {
@@ -932,6 +978,7 @@ vtkOrientedImageData* vtkMRMLSegmentationNode::GetBinaryLabelmapInternalRepresen
     vtkErrorMacro("GetBinaryLabelmapRepresentation: Invalid segmentation");
     return nullptr;
     }
+  this->ReadPendingLabelmapVoxels();
   vtkSegment* segment = this->Segmentation->GetSegment(segmentId);
   if (!segment)
     {
@@ -949,6 +996,7 @@ bool vtkMRMLSegmentationNode::CreateClosedSurfaceRepresentation()
     vtkErrorMacro("CreateClosedSurfaceRepresentation: Invalid segmentation");
     return false;
     }
+  this->ReadPendingLabelmapVoxels();
   return this->Segmentation->CreateRepresentation(vtkSegmentationConverter::GetSegmentationClosedSurfaceRepresentationName());
 }
 
@@ -971,6 +1019,7 @@ void vtkMRMLSegmentationNode::GetClosedSurfaceRepresentation(const std::string s
     vtkErrorMacro("GetClosedSurfaceRepresentation: Invalid segmentation");
     return;
     }
+  this->ReadPendingLabelmapVoxels();
   vtkSegment* segment = this->Segmentation->GetSegment(segmentId);
   if (!segment)
     {
@@ -994,6 +1043,7 @@ vtkPolyData* vtkMRMLSegmentationNode::GetClosedSurfaceInternalRepresentation(con
     vtkErrorMacro("GetClosedSurfaceRepresentation: Invalid segmentation");
     return nullptr;
     }
+  this->ReadPendingLabelmapVoxels();
   vtkSegment* segment = this->Segmentation->GetSegment(segmentId);
   if (!segment)
     {
@@ -1035,6 +1085,7 @@ double* vtkMRMLSegmentationNode::GetSegmentCenter(const std::string& segmentID)
     vtkErrorMacro("GetSegmentCenter: Invalid segmentation");
     return nullptr;
     }
+  this->ReadPendingLabelmapVoxels();
   vtkSegment* currentSegment = this->Segmentation->GetSegment(segmentID);
   if (!currentSegment)
     {
@@ -104,6 +104,13 @@ public:
   /// Create and observe a segmentation display node
   void CreateDefaultDisplayNodes() override;
 
+  /// Reads voxels of segments that were read from file header only
+  /// (see vtkMRMLSegmentationStorageNode::ReadHeaderOnly) when a display node is made visible.
+  void ProcessMRMLEvents(vtkObject* caller, unsigned long event, void* callData) override;
+
+  /// Reads voxels of segments that were read from file header only when a visible display node is added.
+  void OnNodeReferenceAdded(vtkMRMLNodeReference* reference) override;
+
   /// Function called from segmentation logic when UID is added in a subject hierarchy node.
   /// In case the newly added UID is a volume node referenced from this segmentation,
   /// its geometry will be set as image geometry conversion parameter.
@@ -290,6 +297,12 @@ protected:
   /// Forwards event from the node.
   void OnSegmentModified(const char* segmentId);
 
+  /// Read voxels of segments if the segmentation was read from file header only
+  /// (see vtkMRMLSegmentationStorageNode::ReadHeaderOnly).
+  /// Called before segment representations are accessed through this node, and when
+  /// a pending segment representation is accessed directly through GetSegmentation().
+  void ReadPendingLabelmapVoxels();
+
 protected:
   vtkMRMLSegmentationNode();
   ~vtkMRMLSegmentationNode() override;
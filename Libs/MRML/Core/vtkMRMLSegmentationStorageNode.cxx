@@ -51,10 +51,13 @@
 #include <vtkObjectFactory.h>
 #include <vtkPointData.h>
 #include <vtkPolyData.h>
+#include <vtkStreamingDemandDrivenPipeline.h>
 #include <vtkStringArray.h>
 #include <vtkTransform.h>
 #include <vtkXMLMultiBlockDataWriter.h>
 #include <vtkXMLMultiBlockDataReader.h>
+#include <vtk_zlib.h>
+#include <vtksys/FStream.hxx>
 #include <vtksys/SystemTools.hxx>
 
 #ifdef SUPPORT_4D_SPATIAL_NRRD
@@ -68,8 +71,14 @@
 #endif
 
 // STL & C++ includes
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <iterator>
+#include <limits>
+#include <map>
 #include <sstream>
+#include <thread>
 
 //----------------------------------------------------------------------------
 static const std::string SERIALIZATION_SEPARATOR = "|";
@@ -89,6 +98,608 @@ static const std::string KEY_SEGMENTATION_REFERENCE_IMAGE_EXTENT_OFFSET = "Refer
 static const std::string KEY_SEGMENTATION_CONTAINED_REPRESENTATION_NAMES = "ContainedRepresentationNames";
 
 static const int SINGLE_SEGMENT_INDEX = -1; // used as segment index when there is only a single segment
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Properties of a NRRD file that are needed for reading voxels directly from the file
+struct NrrdVoxelLayout
+{
+  std::streamoff DataOffset{0};
+  bool GzipEncoding{false};
+  int ScalarType{VTK_VOID};
+  int NumberOfComponents{1};
+  int Dimensions[3]{0, 0, 0};
+};
+
+//----------------------------------------------------------------------------
+int GetNrrdScalarType(const std::string& typeName)
+{
+  // Integer types that can be used in labelmaps
+  static const std::map<std::string, int> scalarTypes =
+    {
+    { "signed char", VTK_SIGNED_CHAR }, { "int8", VTK_SIGNED_CHAR }, { "int8_t", VTK_SIGNED_CHAR },
+    { "uchar", VTK_UNSIGNED_CHAR }, { "unsigned char", VTK_UNSIGNED_CHAR }, { "uint8", VTK_UNSIGNED_CHAR }, { "uint8_t", VTK_UNSIGNED_CHAR },
+    { "short", VTK_SHORT }, { "short int", VTK_SHORT }, { "signed short", VTK_SHORT }, { "signed short int", VTK_SHORT },
+    { "int16", VTK_SHORT }, { "int16_t", VTK_SHORT },
+    { "ushort", VTK_UNSIGNED_SHORT }, { "unsigned short", VTK_UNSIGNED_SHORT }, { "unsigned short int", VTK_UNSIGNED_SHORT },
+    { "uint16", VTK_UNSIGNED_SHORT }, { "uint16_t", VTK_UNSIGNED_SHORT },
+    { "int", VTK_INT }, { "signed int", VTK_INT }, { "int32", VTK_INT }, { "int32_t", VTK_INT },
+    { "uint", VTK_UNSIGNED_INT }, { "unsigned int", VTK_UNSIGNED_INT }, { "uint32", VTK_UNSIGNED_INT }, { "uint32_t", VTK_UNSIGNED_INT }
+    };
+  std::map<std::string, int>::const_iterator scalarTypeIt = scalarTypes.find(typeName);
+  return (scalarTypeIt != scalarTypes.end() ? scalarTypeIt->second : VTK_VOID);
+}
+
+//----------------------------------------------------------------------------
+// Read the header of a NRRD file that stores the voxels in the same file.
+// Returns false if the voxels cannot be read directly (detached data, unsupported encoding,
+// scalar type, byte order, or axis layout).
+bool ReadNrrdVoxelLayout(const std::string& path, NrrdVoxelLayout& layout)
+{
+  vtksys::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+  std::string line;
+  if (!file || !std::getline(file, line) || line.compare(0, 4, "NRRD") != 0)
+    {
+    return false;
+    }
+  std::string encoding;
+  std::string type;
+  std::string endian;
+  std::string kinds;
+  std::vector<int> sizes;
+  int dimension = 0;
+  bool endOfHeader = false;
+  while (std::getline(file, line))
+    {
+    if (!line.empty() && line[line.size() - 1] == '\r')
+      {
+      line.erase(line.size() - 1);
+      }
+    if (line.empty())
+      {
+      endOfHeader = true;
+      break;
+      }
+    size_t fieldSeparator = line.find(": ");
+    size_t keyValueSeparator = line.find(":=");
+    if (line[0] == '#' || fieldSeparator == std::string::npos
+      || (keyValueSeparator != std::string::npos && keyValueSeparator < fieldSeparator))
+      {
+      // comment or key/value pair
+      continue;
+      }
+    std::string field = line.substr(0, fieldSeparator);
+    std::string value = line.substr(fieldSeparator + 2);
+    if (field == "type")
+      {
+      type = value;
+      }
+    else if (field == "dimension")
+      {
+      dimension = vtkVariant(value).ToInt();
+      }
+    else if (field == "sizes")
+      {
+      std::stringstream ssSizes(value);
+      int size = 0;
+      while (ssSizes >> size)
+        {
+        sizes.push_back(size);
+        }
+      }
+    else if (field == "encoding")
+      {
+      encoding = value;
+      }
+    else if (field == "endian")
+      {
+      endian = value;
+      }
+    else if (field == "kinds")
+      {
+      kinds = value;
+      }
+    else if (field == "data file" || field == "datafile" || field == "line skip" || field == "lineskip"
+      || field == "byte skip" || field == "byteskip")
+      {
+      // voxels are not stored right after the header
+      return false;
+      }
+    }
+  if (!endOfHeader)
+    {
+    return false;
+    }
+  layout.DataOffset = file.tellg();
+
+  if (encoding == "raw")
+    {
+    layout.GzipEncoding = false;
+    }
+  else if (encoding == "gzip" || encoding == "gz")
+    {
+    layout.GzipEncoding = true;
+    }
+  else
+    {
+    return false;
+    }
+
+  layout.ScalarType = GetNrrdScalarType(type);
+  if (layout.ScalarType == VTK_VOID)
+    {
+    return false;
+    }
+#ifdef VTK_WORDS_BIGENDIAN
+  const std::string machineEndian = "big";
+#else
+  const std::string machineEndian = "little";
+#endif
+  if (vtkDataArray::GetDataTypeSize(layout.ScalarType) > 1 && endian != machineEndian)
+    {
+    return false;
+    }
+
+  if (dimension == 3 && sizes.size() == 3)
+    {
+    layout.NumberOfComponents = 1;
+    std::copy(sizes.begin(), sizes.end(), layout.Dimensions);
+    }
+  else if (dimension == 4 && sizes.size() == 4)
+    {
+    // first axis must be the list of layers
+    std::string firstKind = kinds.substr(0, kinds.find(' '));
+    if (firstKind.empty() || firstKind == "domain" || firstKind == "space")
+      {
+      return false;
+      }
+    layout.NumberOfComponents = sizes[0];
+    std::copy(sizes.begin() + 1, sizes.end(), layout.Dimensions);
+    }
+  else
+    {
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Decompress a complete gzip member. Fails if the member does not end exactly
+// at the end of the compressed data or its content size is different from outputSize.
+bool InflateGzipMember(const unsigned char* compressed, size_t compressedSize, unsigned char* output, size_t outputSize)
+{
+  if (compressedSize > std::numeric_limits<uInt>::max() || outputSize > std::numeric_limits<uInt>::max())
+    {
+    return false;
+    }
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  // windowBits = 15 + 16 reads gzip header and trailer instead of zlib wrapper
+  if (inflateInit2(&stream, 15 + 16) != Z_OK)
+    {
+    return false;
+    }
+  stream.next_in = const_cast<Bytef*>(compressed);
+  stream.avail_in = static_cast<uInt>(compressedSize);
+  stream.next_out = output;
+  stream.avail_out = static_cast<uInt>(outputSize);
+  int result = inflate(&stream, Z_FINISH);
+  bool success = (result == Z_STREAM_END && stream.avail_in == 0 && stream.avail_out == 0);
+  inflateEnd(&stream);
+  return success;
+}
+
+//----------------------------------------------------------------------------
+// Voxels of a layer that are read from the file
+struct NrrdLayerRegion
+{
+  int Component{0};
+  int Extent[6]{0, -1, 0, -1, 0, -1};
+  /// Scalars of the layer within Extent
+  unsigned char* Voxels{nullptr};
+};
+
+//----------------------------------------------------------------------------
+// Range of bytes of the uncompressed voxel data that contains the voxels of a layer
+std::pair<size_t, size_t> GetLayerRegionByteRange(const NrrdVoxelLayout& layout, size_t voxelSize, const NrrdLayerRegion& region)
+{
+  const int* extent = region.Extent;
+  size_t firstVoxel = (static_cast<size_t>(extent[4]) * layout.Dimensions[1] + extent[2]) * layout.Dimensions[0] + extent[0];
+  size_t lastVoxel = (static_cast<size_t>(extent[5]) * layout.Dimensions[1] + extent[3]) * layout.Dimensions[0] + extent[1];
+  return std::make_pair(firstVoxel * voxelSize, (lastVoxel + 1) * voxelSize);
+}
+
+//----------------------------------------------------------------------------
+// Copy the bytes of the layer regions that are in a piece of the uncompressed voxel data.
+// The piece contains bytes [pieceStart, pieceStart + pieceSize) of the voxel data. A scalar may be
+// split between consecutive pieces, each piece copies its part of the scalar.
+void CopyLayerRegionsFromPiece(const unsigned char* piece, size_t pieceStart, size_t pieceSize,
+  const NrrdVoxelLayout& layout, size_t scalarSize, const std::vector<NrrdLayerRegion>& regions)
+{
+  if (pieceSize == 0)
+    {
+    return;
+    }
+  size_t voxelSize = scalarSize * layout.NumberOfComponents;
+  size_t rowSize = voxelSize * layout.Dimensions[0];
+  size_t pieceEnd = pieceStart + pieceSize;
+  size_t firstRow = pieceStart / rowSize;
+  size_t lastRow = (pieceEnd - 1) / rowSize;
+  for (const NrrdLayerRegion& region : regions)
+    {
+    const int* extent = region.Extent;
+    size_t regionRowSize = scalarSize * (extent[1] - extent[0] + 1);
+    for (size_t row = firstRow; row <= lastRow; ++row)
+      {
+      int j = static_cast<int>(row % layout.Dimensions[1]);
+      int k = static_cast<int>(row / layout.Dimensions[1]);
+      if (j < extent[2] || j > extent[3] || k < extent[4] || k > extent[5])
+        {
+        continue;
+        }
+      unsigned char* destinationRow = region.Voxels
+        + (static_cast<size_t>(k - extent[4]) * (extent[3] - extent[2] + 1) + (j - extent[2])) * regionRowSize;
+      size_t sourceRowStart = row * rowSize + region.Component * scalarSize;
+      for (int i = extent[0]; i <= extent[1]; ++i)
+        {
+        size_t scalarStart = sourceRowStart + i * voxelSize;
+        size_t copyStart = std::max(scalarStart, pieceStart);
+        size_t copyEnd = std::min(scalarStart + scalarSize, pieceEnd);
+        if (copyStart < copyEnd)
+          {
+          memcpy(destinationRow + (i - extent[0]) * scalarSize + (copyStart - scalarStart),
+            piece + (copyStart - pieceStart), copyEnd - copyStart);
+          }
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Decompress gzip data that may consist of any number of concatenated gzip members, in blocks.
+// Only a block of compressed and a block of uncompressed data is kept in memory.
+bool InflateGzipFileStream(vtksys::ifstream& file, std::streamoff dataOffset, size_t dataSize,
+  const NrrdVoxelLayout& layout, size_t scalarSize, const std::vector<NrrdLayerRegion>& regions)
+{
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (inflateInit2(&stream, 15 + 16) != Z_OK)
+    {
+    return false;
+    }
+  const size_t blockSize = 16 << 20;
+  std::vector<unsigned char> compressed(blockSize);
+  std::vector<unsigned char> output(std::min(blockSize, dataSize));
+  file.clear();
+  file.seekg(dataOffset);
+  size_t outputPosition = 0;
+  bool success = true;
+  while (outputPosition < dataSize)
+    {
+    if (stream.avail_in == 0)
+      {
+      file.read(reinterpret_cast<char*>(compressed.data()), compressed.size());
+      if (file.gcount() <= 0)
+        {
+        success = false;
+        break;
+        }
+      stream.next_in = compressed.data();
+      stream.avail_in = static_cast<uInt>(file.gcount());
+      }
+    size_t outputBlockSize = std::min(output.size(), dataSize - outputPosition);
+    stream.next_out = output.data();
+    stream.avail_out = static_cast<uInt>(outputBlockSize);
+    int result = inflate(&stream, Z_NO_FLUSH);
+    size_t producedSize = outputBlockSize - stream.avail_out;
+    CopyLayerRegionsFromPiece(output.data(), outputPosition, producedSize, layout, scalarSize, regions);
+    outputPosition += producedSize;
+    if (result == Z_STREAM_END)
+      {
+      // continue with the next member
+      inflateReset(&stream);
+      }
+    else if (result == Z_BUF_ERROR && stream.avail_in == 0)
+      {
+      // more input is needed
+      continue;
+      }
+    else if (result != Z_OK)
+      {
+      success = false;
+      break;
+      }
+    }
+  inflateEnd(&stream);
+  return success;
+}
+
+//----------------------------------------------------------------------------
+// Compressed data written in chunks (see vtkTeemNRRDWriter) consists of concatenated gzip members
+// that can be decompressed independently. Find where the members start in the file and where their
+// content is located in the uncompressed data. The file is scanned in blocks.
+// Returns false if the members cannot be located reliably.
+bool FindGzipMembers(vtksys::ifstream& file, std::streamoff dataOffset, size_t compressedSize, size_t dataSize,
+  std::vector<size_t>& memberStarts, std::vector<size_t>& memberOffsets)
+{
+  // Beginning of gzip member headers written by zlib and Teem:
+  // identifier, deflate compression method, no flags, no modification time
+  const unsigned char memberHeader[8] = { 0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00 };
+  // 10-byte header and 8-byte trailer
+  const size_t minimumMemberSize = 18;
+  if (compressedSize < minimumMemberSize)
+    {
+    return false;
+    }
+  memberStarts.clear();
+  const size_t blockSize = 16 << 20;
+  std::vector<unsigned char> block(blockSize + sizeof(memberHeader));
+  for (size_t blockStart = 0; blockStart < compressedSize; blockStart += blockSize)
+    {
+    // Blocks overlap so that headers that cross block boundaries are found
+    size_t readSize = std::min(block.size(), compressedSize - blockStart);
+    file.clear();
+    file.seekg(dataOffset + static_cast<std::streamoff>(blockStart));
+    file.read(reinterpret_cast<char*>(block.data()), readSize);
+    if (static_cast<size_t>(file.gcount()) != readSize)
+      {
+      return false;
+      }
+    size_t scanSize = std::min(blockSize, readSize);
+    for (size_t position = 0; position < scanSize; ++position)
+      {
+      const void* found = memchr(block.data() + position, memberHeader[0], scanSize - position);
+      if (!found)
+        {
+        break;
+        }
+      position = static_cast<const unsigned char*>(found) - block.data();
+      size_t memberStart = blockStart + position;
+      if (position + sizeof(memberHeader) > readSize
+        || memberStart + minimumMemberSize > compressedSize
+        || memcmp(block.data() + position, memberHeader, sizeof(memberHeader)) != 0)
+        {
+        continue;
+        }
+      if (!memberStarts.empty() && memberStart < memberStarts.back() + minimumMemberSize)
+        {
+        // too close to the previous member header, must be part of the compressed data
+        continue;
+        }
+      memberStarts.push_back(memberStart);
+      }
+    }
+  if (memberStarts.empty() || memberStarts[0] != 0)
+    {
+    return false;
+    }
+
+  // Size of the content of each member is stored in the last 4 bytes of the member
+  memberOffsets.resize(memberStarts.size());
+  size_t offset = 0;
+  for (size_t member = 0; member < memberStarts.size(); ++member)
+    {
+    memberOffsets[member] = offset;
+    size_t memberEnd = (member + 1 < memberStarts.size() ? memberStarts[member + 1] : compressedSize);
+    unsigned char trailer[4] = { 0 };
+    file.clear();
+    file.seekg(dataOffset + static_cast<std::streamoff>(memberEnd - 4));
+    file.read(reinterpret_cast<char*>(trailer), sizeof(trailer));
+    if (!file)
+      {
+      return false;
+      }
+    offset += static_cast<size_t>(trailer[0]) | (static_cast<size_t>(trailer[1]) << 8)
+      | (static_cast<size_t>(trailer[2]) << 16) | (static_cast<size_t>(trailer[3]) << 24);
+    }
+  // If a member header pattern occurred inside compressed data or a member is larger than 4GB
+  // then the sizes do not add up.
+  return (offset == dataSize);
+}
+
+//----------------------------------------------------------------------------
+// Read the voxels of the layer regions from the file. Only the parts of the file that contain voxels
+// of the regions are read, and only a piece of the data (a block of raw data or a gzip member) is kept
+// in memory at a time. Gzip members are decompressed in parallel.
+bool ReadNrrdLayerRegions(const std::string& path, const NrrdVoxelLayout& layout, size_t dataSize,
+  const std::vector<NrrdLayerRegion>& regions)
+{
+  vtksys::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+  if (!file)
+    {
+    return false;
+    }
+  size_t scalarSize = static_cast<size_t>(vtkDataArray::GetDataTypeSize(layout.ScalarType));
+  size_t voxelSize = scalarSize * layout.NumberOfComponents;
+  if (voxelSize == 0)
+    {
+    return false;
+    }
+  if (!layout.GzipEncoding)
+    {
+    const size_t blockSize = 16 << 20;
+    std::vector<unsigned char> block;
+    for (const NrrdLayerRegion& region : regions)
+      {
+      std::pair<size_t, size_t> range = GetLayerRegionByteRange(layout, voxelSize, region);
+      std::vector<NrrdLayerRegion> pieceRegions(1, region);
+      for (size_t pieceStart = range.first; pieceStart < range.second; pieceStart += blockSize)
+        {
+        size_t pieceSize = std::min(blockSize, range.second - pieceStart);
+        block.resize(pieceSize);
+        file.seekg(layout.DataOffset + static_cast<std::streamoff>(pieceStart));
+        file.read(reinterpret_cast<char*>(block.data()), pieceSize);
+        if (!file)
+          {
+          return false;
+          }
+        CopyLayerRegionsFromPiece(block.data(), pieceStart, pieceSize, layout, scalarSize, pieceRegions);
+        }
+      }
+    return true;
+    }
+
+  file.seekg(0, std::ios::end);
+  std::streamoff fileSize = file.tellg();
+  if (fileSize <= layout.DataOffset)
+    {
+    return false;
+    }
+  size_t compressedSize = static_cast<size_t>(fileSize - layout.DataOffset);
+
+  std::vector<size_t> memberStarts;
+  std::vector<size_t> memberOffsets;
+  if (!FindGzipMembers(file, layout.DataOffset, compressedSize, dataSize, memberStarts, memberOffsets)
+    || memberStarts.size() < 2)
+    {
+    // Members are not found or the data is not compressed in chunks
+    return InflateGzipFileStream(file, layout.DataOffset, dataSize, layout, scalarSize, regions);
+    }
+
+  std::vector<size_t> membersToRead;
+  for (size_t member = 0; member < memberStarts.size(); ++member)
+    {
+    size_t memberEndOffset = (member + 1 < memberStarts.size() ? memberOffsets[member + 1] : dataSize);
+    for (const NrrdLayerRegion& region : regions)
+      {
+      std::pair<size_t, size_t> range = GetLayerRegionByteRange(layout, voxelSize, region);
+      if (range.first < memberEndOffset && memberOffsets[member] < range.second)
+        {
+        membersToRead.push_back(member);
+        break;
+        }
+      }
+    }
+
+  std::atomic<size_t> nextMember(0);
+  std::atomic<bool> inflateFailed(false);
+  auto inflateMembers = [&]()
+    {
+    vtksys::ifstream memberFile(path.c_str(), std::ios::in | std::ios::binary);
+    std::vector<unsigned char> compressed;
+    std::vector<unsigned char> piece;
+    for (size_t memberIndex = nextMember++; memberIndex < membersToRead.size() && !inflateFailed; memberIndex = nextMember++)
+      {
+      size_t member = membersToRead[memberIndex];
+      bool lastMember = (member + 1 == memberStarts.size());
+      size_t compressedEnd = (lastMember ? compressedSize : memberStarts[member + 1]);
+      size_t memberEndOffset = (lastMember ? dataSize : memberOffsets[member + 1]);
+      compressed.resize(compressedEnd - memberStarts[member]);
+      piece.resize(memberEndOffset - memberOffsets[member]);
+      memberFile.seekg(layout.DataOffset + static_cast<std::streamoff>(memberStarts[member]));
+      memberFile.read(reinterpret_cast<char*>(compressed.data()), compressed.size());
+      if (!memberFile || !InflateGzipMember(compressed.data(), compressed.size(), piece.data(), piece.size()))
+        {
+        inflateFailed = true;
+        break;
+        }
+      // Members contain disjoint byte ranges, therefore threads write different voxels
+      CopyLayerRegionsFromPiece(piece.data(), memberOffsets[member], piece.size(), layout, scalarSize, regions);
+      }
+    };
+  size_t numberOfThreads = std::min(static_cast<size_t>(std::max(1u, std::thread::hardware_concurrency())), membersToRead.size());
+  std::vector<std::thread> threads;
+  for (size_t threadIndex = 1; threadIndex < numberOfThreads; ++threadIndex)
+    {
+    threads.emplace_back(inflateMembers);
+    }
+  inflateMembers();
+  for (std::thread& thread : threads)
+    {
+    thread.join();
+    }
+  if (inflateFailed)
+    {
+    // member boundaries were not found correctly, decompress all data as a single stream
+    return InflateGzipFileStream(file, layout.DataOffset, dataSize, layout, scalarSize, regions);
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void SetSegmentRepresentationsPending(vtkSegmentation* segmentation, bool pending)
+{
+  std::vector<std::string> segmentIDs;
+  segmentation->GetSegmentIDs(segmentIDs);
+  for (const std::string& segmentID : segmentIDs)
+    {
+    segmentation->GetSegment(segmentID)->SetRepresentationsPending(pending);
+    }
+}
+
+//----------------------------------------------------------------------------
+bool IsMasterRepresentationSparseBinaryLabelmap(vtkSegmentation* segmentation)
+{
+  return segmentation && segmentation->GetMasterRepresentationName() ==
+    std::string(vtkSegmentationConverter::GetSegmentationSparseBinaryLabelmapRepresentationName());
+}
+
+//----------------------------------------------------------------------------
+// Read voxels of the listed layers, within the extent of each layer, directly from a NRRD file.
+// Extents are voxel coordinates in the file. Returns false if the file cannot be read this way.
+bool ReadNrrdLabelmapLayers(const std::string& path, int scalarType, int numberOfComponents, const int imageExtent[6],
+  const std::map<int, std::vector<int> >& layerExtents, std::map<int, vtkSmartPointer<vtkOrientedImageData> >& layerLabelmaps)
+{
+  NrrdVoxelLayout layout;
+  if (!ReadNrrdVoxelLayout(path, layout)
+    || layout.ScalarType != scalarType
+    || layout.NumberOfComponents != numberOfComponents)
+    {
+    return false;
+    }
+  for (int i = 0; i < 3; ++i)
+    {
+    if (imageExtent[i * 2] != 0 || imageExtent[i * 2 + 1] + 1 != layout.Dimensions[i])
+      {
+      return false;
+      }
+    }
+
+  // Allocate labelmaps of the layers, voxels are read directly into them
+  size_t voxelSize = static_cast<size_t>(vtkDataArray::GetDataTypeSize(scalarType)) * numberOfComponents;
+  size_t dataSize = voxelSize * layout.Dimensions[0] * layout.Dimensions[1] * layout.Dimensions[2];
+  std::map<int, vtkSmartPointer<vtkOrientedImageData> > labelmaps;
+  std::vector<NrrdLayerRegion> regions;
+  for (const auto& layerExtent : layerExtents)
+    {
+    const std::vector<int>& extent = layerExtent.second;
+    if (layerExtent.first < 0 || layerExtent.first >= numberOfComponents)
+      {
+      return false;
+      }
+    if (extent[0] > extent[1] || extent[2] > extent[3] || extent[4] > extent[5])
+      {
+      continue;
+      }
+    vtkSmartPointer<vtkOrientedImageData> labelmap = vtkSmartPointer<vtkOrientedImageData>::New();
+    labelmap->SetExtent(extent[0], extent[1], extent[2], extent[3], extent[4], extent[5]);
+    labelmap->AllocateScalars(scalarType, 1);
+    labelmaps[layerExtent.first] = labelmap;
+    NrrdLayerRegion region;
+    region.Component = layerExtent.first;
+    std::copy(extent.begin(), extent.begin() + 6, region.Extent);
+    region.Voxels = static_cast<unsigned char*>(labelmap->GetScalarPointer());
+    regions.push_back(region);
+    }
+  if (regions.empty())
+    {
+    return true;
+    }
+
+  if (!ReadNrrdLayerRegions(path, layout, dataSize, regions))
+    {
+    return false;
+    }
+  for (const auto& labelmap : labelmaps)
+    {
+    layerLabelmaps[labelmap.first] = labelmap.second;
+    }
+  return true;
+}
+
+} // end of anonymous namespace
 //----------------------------------------------------------------------------
 vtkMRMLNodeNewMacro(vtkMRMLSegmentationStorageNode);
 
@@ -104,6 +715,8 @@ void vtkMRMLSegmentationStorageNode::PrintSelf(ostream& os, vtkIndent indent)
   Superclass::PrintSelf(os,indent);
   vtkMRMLPrintBeginMacro(os, indent);
   vtkMRMLPrintBooleanMacro(CropToMinimumExtent);
+  vtkMRMLPrintBooleanMacro(ReadHeaderOnly);
+  vtkMRMLPrintBooleanMacro(LabelmapVoxelsPending);
   vtkMRMLPrintEndMacro();
 }
 
@@ -114,6 +727,7 @@ void vtkMRMLSegmentationStorageNode::ReadXMLAttributes(const char** atts)
   Superclass::ReadXMLAttributes(atts);
   vtkMRMLReadXMLBeginMacro(atts);
   vtkMRMLReadXMLBooleanMacro(CropToMinimumExtent, CropToMinimumExtent);
+  vtkMRMLReadXMLBooleanMacro(readHeaderOnly, ReadHeaderOnly);
   vtkMRMLReadXMLEndMacro();
 }
 
@@ -123,6 +737,7 @@ void vtkMRMLSegmentationStorageNode::WriteXML(ostream& of, int nIndent)
   Superclass::WriteXML(of, nIndent);
   vtkMRMLWriteXMLBeginMacro(of);
   vtkMRMLWriteXMLBooleanMacro(CropToMinimumExtent, CropToMinimumExtent);
+  vtkMRMLWriteXMLBooleanMacro(readHeaderOnly, ReadHeaderOnly);
   vtkMRMLWriteXMLEndMacro();
 }
 
@@ -135,6 +750,7 @@ void vtkMRMLSegmentationStorageNode::Copy(vtkMRMLNode *anode)
   Superclass::Copy(anode);
   vtkMRMLCopyBeginMacro(anode);
   vtkMRMLCopyBooleanMacro(CropToMinimumExtent);
+  vtkMRMLCopyBooleanMacro(ReadHeaderOnly);
   vtkMRMLCopyEndMacro();
 }
 
@@ -160,7 +776,8 @@ void vtkMRMLSegmentationStorageNode::InitializeSupportedWriteFileTypes()
   if (segmentationNode)
     {
     // restrict write file types to those that are suitable for current master representation
-    masterIsImage = segmentationNode->GetSegmentation()->IsMasterRepresentationImageData();
+    masterIsImage = segmentationNode->GetSegmentation()->IsMasterRepresentationImageData()
+      || IsMasterRepresentationSparseBinaryLabelmap(segmentationNode->GetSegmentation());
     masterIsPolyData = segmentationNode->GetSegmentation()->IsMasterRepresentationPolyData();
     if (!masterIsImage && !masterIsPolyData)
       {
@@ -215,7 +832,8 @@ const char* vtkMRMLSegmentationStorageNode::GetDefaultWriteFileExtension()
     {
     return nullptr;
     }
-  if (segmentationNode->GetSegmentation()->IsMasterRepresentationImageData())
+  if (segmentationNode->GetSegmentation()->IsMasterRepresentationImageData()
+    || IsMasterRepresentationSparseBinaryLabelmap(segmentationNode->GetSegmentation()))
     {
     return "seg.nrrd";
     }
@@ -285,7 +903,18 @@ int vtkMRMLSegmentationStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
   // Create display node if segmentation there is none
   if (success && !segmentationNode->GetDisplayNode())
     {
-    segmentationNode->CreateDefaultDisplayNodes();
+    if (this->LabelmapVoxelsPending && segmentationNode->GetScene())
+      {
+      // Segments that are read from header only are hidden, their voxels are read when they are shown
+      vtkMRMLSegmentationDisplayNode* displayNode = vtkMRMLSegmentationDisplayNode::SafeDownCast(
+        segmentationNode->GetScene()->AddNewNodeByClass("vtkMRMLSegmentationDisplayNode"));
+      displayNode->SetVisibility(false);
+      segmentationNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+      }
+    else
+      {
+      segmentationNode->CreateDefaultDisplayNodes();
+      }
     }
 
   if (!success)
@@ -491,15 +1120,117 @@ int vtkMRMLSegmentationStorageNode::ReadBinaryLabelmapRepresentation4DSpatial(vt
     segmentation->AddSegment(currentSegment, currentSegmentID);
     }
 
-  // Create contained representations now that all the data is loaded
+  return 1;
+}
+#endif // SUPPORT_4D_SPATIAL_NRRD
+
+//----------------------------------------------------------------------------
+int vtkMRMLSegmentationStorageNode::ReadLabelmapVoxels(vtkMRMLSegmentationNode* segmentationNode)
+{
+  if (!segmentationNode || !segmentationNode->GetSegmentation())
+    {
+    vtkErrorMacro("ReadLabelmapVoxels: Invalid segmentation node");
+    return 0;
+    }
+  if (!this->LabelmapVoxelsPending || this->ReadingLabelmapVoxels)
+    {
+    // nothing to read, or modifying the segments requested the voxels that are being read
+    return 1;
+    }
+  // Segments may have been modified through vtkSegmentation since the header was read
+  bool modifiedSinceRead = segmentationNode->GetModifiedSinceRead();
+
+  vtkNew<vtkMRMLSegmentationNode> loadedSegmentationNode;
+  std::string containedRepresentationNames;
+  if (!this->ReadBinaryLabelmapSegments(loadedSegmentationNode.GetPointer(), this->PendingLabelmapFileName, true, containedRepresentationNames))
+    {
+    vtkErrorMacro("ReadLabelmapVoxels: Failed to read segments from " << this->PendingLabelmapFileName);
+    // Retry on next access of the segments
+    SetSegmentRepresentationsPending(segmentationNode->GetSegmentation(), true);
+    return 0;
+    }
+  this->ReadingLabelmapVoxels = true;
+
+  vtkSegmentation* segmentation = segmentationNode->GetSegmentation();
+  vtkSegmentation* loadedSegmentation = loadedSegmentationNode->GetSegmentation();
+  std::string labelmapRepresentationName = vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName();
+
+  MRMLNodeModifyBlocker blocker(segmentationNode);
+  bool wasMasterRepresentationModifiedEnabled = segmentation->SetMasterRepresentationModifiedEnabled(false);
+  std::vector<std::string> segmentIDs;
+  loadedSegmentation->GetSegmentIDs(segmentIDs);
+  for (const std::string& segmentID : segmentIDs)
+    {
+    vtkSegment* segment = segmentation->GetSegment(segmentID);
+    vtkOrientedImageData* labelmap = (segment ?
+      vtkOrientedImageData::SafeDownCast(segment->GetRepresentation(labelmapRepresentationName)) : nullptr);
+    vtkOrientedImageData* loadedLabelmap = vtkOrientedImageData::SafeDownCast(
+      loadedSegmentation->GetSegment(segmentID)->GetRepresentation(labelmapRepresentationName));
+    if (!labelmap || !loadedLabelmap || labelmap->GetNumberOfPoints() > 0)
+      {
+      // segment is removed or modified since the header was read,
+      // or it shares the labelmap with a segment that is already read
+      continue;
+      }
+    // Segments in the same layer share the labelmap, so the data is set in the existing object
+    labelmap->ShallowCopy(loadedLabelmap);
+    }
+  segmentation->SetMasterRepresentationModifiedEnabled(wasMasterRepresentationModifiedEnabled);
+  SetSegmentRepresentationsPending(segmentation, false);
+  this->LabelmapVoxelsPending = false;
+  this->PendingLabelmapFileName.clear();
+
+  // Representations that were created from empty labelmaps are obsolete
+  segmentation->InvalidateNonMasterRepresentations();
   this->CreateRepresentationsBySerializedNames(segmentation, containedRepresentationNames);
+  segmentation->Modified();
+  segmentation->InvokeEvent(vtkSegmentation::MasterRepresentationModified, segmentation);
 
+  // Reading the voxels completes reading of the file, it does not make the segmentation modified since read
+  if (!modifiedSinceRead)
+    {
+    this->StoredTime->Modified();
+    }
+  this->ReadingLabelmapVoxels = false;
   return 1;
 }
-#endif // SUPPORT_4D_SPATIAL_NRRD
 
 //----------------------------------------------------------------------------
 int vtkMRMLSegmentationStorageNode::ReadBinaryLabelmapRepresentation(vtkMRMLSegmentationNode* segmentationNode, std::string path)
+{
+  this->LabelmapVoxelsPending = false;
+  this->PendingLabelmapFileName.clear();
+  std::string containedRepresentationNames;
+  if (!this->ReadBinaryLabelmapSegments(segmentationNode, path, !this->ReadHeaderOnly, containedRepresentationNames))
+    {
+    return 0;
+    }
+  if (this->LabelmapVoxelsPending)
+    {
+    // Representations are created when the voxels are read
+    this->PendingLabelmapFileName = path;
+    SetSegmentRepresentationsPending(segmentationNode->GetSegmentation(), true);
+    // Display nodes may be already set up (e.g., when the segmentation is loaded from a scene)
+    for (int displayNodeIndex = 0; displayNodeIndex < segmentationNode->GetNumberOfDisplayNodes(); ++displayNodeIndex)
+      {
+      vtkMRMLDisplayNode* displayNode = segmentationNode->GetNthDisplayNode(displayNodeIndex);
+      if (displayNode && displayNode->GetVisibility())
+        {
+        return this->ReadLabelmapVoxels(segmentationNode);
+        }
+      }
+    return 1;
+    }
+
+  // Create contained representations now that all the data is loaded
+  this->CreateRepresentationsBySerializedNames(segmentationNode->GetSegmentation(), containedRepresentationNames);
+
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLSegmentationStorageNode::ReadBinaryLabelmapSegments(vtkMRMLSegmentationNode* segmentationNode,
+  const std::string& path, bool readVoxels, std::string& containedRepresentationNames)
 {
   if (!vtksys::SystemTools::FileExists(path.c_str()))
     {
@@ -527,8 +1258,9 @@ int vtkMRMLSegmentationStorageNode::ReadBinaryLabelmapRepresentation(vtkMRMLSegm
   archetypeImageReader->SetUseNativeOriginOn();
 
   int numberOfSegments = 0;
+  int numberOfFrames = 0;
   std::map<int, std::vector<int> > segmentIndexInLayer;
-  std::string containedRepresentationNames;
+  containedRepresentationNames.clear();
   vtkMatrix4x4* rasToFileIjk = nullptr;
   int imageExtentInFile[6] = { 0, -1, 0, -1, 0, -1 };
   int commonGeometryExtent[6] = { 0, -1, 0, -1, 0, -1 };
@@ -536,19 +1268,18 @@ int vtkMRMLSegmentationStorageNode::ReadBinaryLabelmapRepresentation(vtkMRMLSegm
 
   if (archetypeImageReader->CanReadFile(path.c_str()))
     {
-    // Read the volume
-    archetypeImageReader->Update();
+    // Read image geometry and metadata. Voxels are read later, only where segments are.
+    archetypeImageReader->UpdateInformation();
     if (archetypeImageReader->GetErrorCode() != vtkErrorCode::NoError)
       {
       vtkErrorMacro("ReadBinaryLabelmapRepresentation: Error reading image!");
       return 0;
       }
 
-    // Copy image data to sequence of volume nodes
-    imageData = archetypeImageReader->GetOutput();
     rasToFileIjk = archetypeImageReader->GetRasToIjkMatrix();
-    imageData->GetExtent(imageExtentInFile);
-    imageData->GetExtent(commonGeometryExtent);
+    archetypeImageReader->GetOutputInformation(0)->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), imageExtentInFile);
+    std::copy(imageExtentInFile, imageExtentInFile + 6, commonGeometryExtent);
+    numberOfFrames = static_cast<int>(archetypeImageReader->GetNumberOfComponents());
 
     // Get metadata dictionary from image
     itk::MetaDataDictionary dictionary = archetypeImageReader->GetMetaDataDictionary();
@@ -582,7 +1313,6 @@ int vtkMRMLSegmentationStorageNode::ReadBinaryLabelmapRepresentation(vtkMRMLSegm
       // which means that this is probably a regular NRRD file that should be imported as a segmentation.
       // Use the image extent as common geometry extent.
       vtkInfoMacro(<< KEY_SEGMENTATION_REFERENCE_IMAGE_EXTENT_OFFSET << " attribute was not found in NRRD segmentation file. Assume no offset.");
-      imageData->GetExtent(commonGeometryExtent);
       }
 
     // Read conversion parameters
@@ -617,12 +1347,76 @@ int vtkMRMLSegmentationStorageNode::ReadBinaryLabelmapRepresentation(vtkMRMLSegm
     return 0;
     }
 
-  if (imageData == nullptr)
+  // Get metadata for current segment
+  itk::MetaDataDictionary dictionary = archetypeImageReader->GetMetaDataDictionary();
+
+  // Extent of each layer in the file is the union of extents of the segments in the layer
+  std::map<int, std::vector<int> > layerExtentsInFile;
+  for (const auto& layerSegments : segmentIndexInLayer)
     {
-    vtkErrorMacro("vtkMRMLVolumeSequenceStorageNode::ReadDataInternal: invalid image data");
-    return 0;
+    std::vector<int> layerExtent = { 0, -1, 0, -1, 0, -1 };
+    for (int segmentIndex : layerSegments.second)
+      {
+      int currentSegmentExtent[6] = { 0, -1, 0, -1, 0, -1 };
+      std::string currentExtentString;
+      if (this->GetSegmentMetaDataFromDicitionary(currentExtentString, dictionary, segmentIndex, KEY_SEGMENT_EXTENT))
+        {
+        GetImageExtentFromString(currentSegmentExtent, currentExtentString);
+        }
+      else
+        {
+        vtkWarningMacro("Segment extent is missing for segment " << segmentIndex);
+        std::copy(imageExtentInFile, imageExtentInFile + 6, currentSegmentExtent);
+        }
+      for (int i = 0; i < 3; i++)
+        {
+        currentSegmentExtent[i * 2] = std::max(currentSegmentExtent[i * 2], imageExtentInFile[i * 2]);
+        currentSegmentExtent[i * 2 + 1] = std::min(currentSegmentExtent[i * 2 + 1], imageExtentInFile[i * 2 + 1]);
+        }
+      if (currentSegmentExtent[0] > currentSegmentExtent[1]
+        || currentSegmentExtent[2] > currentSegmentExtent[3]
+        || currentSegmentExtent[4] > currentSegmentExtent[5])
+        {
+        // empty segment
+        continue;
+        }
+      bool layerExtentEmpty = (layerExtent[0] > layerExtent[1]);
+      for (int i = 0; i < 3; i++)
+        {
+        layerExtent[i * 2] = layerExtentEmpty ? currentSegmentExtent[i * 2] : std::min(layerExtent[i * 2], currentSegmentExtent[i * 2]);
+        layerExtent[i * 2 + 1] = layerExtentEmpty ? currentSegmentExtent[i * 2 + 1] : std::max(layerExtent[i * 2 + 1], currentSegmentExtent[i * 2 + 1]);
+        }
+      }
+    layerExtentsInFile[layerSegments.first] = layerExtent;
+    }
+
+  // Read voxels. If the file contains segment metadata then only the voxels within the
+  // extent of each layer are read, directly from the file if possible.
+  std::map<int, vtkSmartPointer<vtkOrientedImageData> > layerLabelmaps;
+  if (numberOfSegments > 0 && !readVoxels)
+    {
+    // Segments are created with empty labelmaps
+    this->LabelmapVoxelsPending = true;
+    }
+  else if (numberOfSegments == 0 || !ReadNrrdLabelmapLayers(path, archetypeImageReader->GetOutputScalarType(),
+    numberOfFrames, imageExtentInFile, layerExtentsInFile, layerLabelmaps))
+    {
+    // Read the complete volume
+    layerLabelmaps.clear();
+    archetypeImageReader->Update();
+    if (archetypeImageReader->GetErrorCode() != vtkErrorCode::NoError)
+      {
+      vtkErrorMacro("ReadBinaryLabelmapRepresentation: Error reading image!");
+      return 0;
+      }
+    imageData = archetypeImageReader->GetOutput();
+    if (imageData == nullptr)
+      {
+      vtkErrorMacro("vtkMRMLVolumeSequenceStorageNode::ReadDataInternal: invalid image data");
+      return 0;
+      }
+    numberOfFrames = imageData->GetNumberOfScalarComponents();
     }
-  int numberOfFrames = imageData->GetNumberOfScalarComponents();
 
   // Read succeeded, set master representation
   segmentation->SetMasterRepresentationName(vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName());
@@ -641,15 +1435,29 @@ int vtkMRMLSegmentationStorageNode::ReadBinaryLabelmapRepresentation(vtkMRMLSegm
   vtkNew<vtkMatrix4x4> imageToWorldMatrix; // = ijkToRas;
   vtkMatrix4x4::Invert(rasToIjk.GetPointer(), imageToWorldMatrix.GetPointer());
 
-  imageData->SetExtent(commonGeometryExtent);
   vtkNew<vtkImageExtractComponents> extractComponents;
-  extractComponents->SetInputData(imageData);
+  if (imageData)
+    {
+    imageData->SetExtent(commonGeometryExtent);
+    extractComponents->SetInputData(imageData);
+    }
 
   vtkNew<vtkImageConstantPad> padder;
   padder->SetInputConnection(extractComponents->GetOutputPort());
 
-  // Get metadata for current segment
-  itk::MetaDataDictionary dictionary = archetypeImageReader->GetMetaDataDictionary();
+  // Labelmaps that are read directly from the file are in the file voxel coordinate system
+  for (auto& layerLabelmap : layerLabelmaps)
+    {
+    int layerExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    layerLabelmap.second->GetExtent(layerExtent);
+    for (int i = 0; i < 3; i++)
+      {
+      layerExtent[i * 2] += referenceImageExtentOffset[i];
+      layerExtent[i * 2 + 1] += referenceImageExtentOffset[i];
+      }
+    layerLabelmap.second->SetExtent(layerExtent);
+    layerLabelmap.second->SetImageToWorldMatrix(imageToWorldMatrix.GetPointer());
+    }
 
   std::vector<vtkSmartPointer<vtkSegment> > segments(numberOfSegments);
   std::map<int, vtkSmartPointer<vtkOrientedImageData> > layerToImage;
@@ -746,32 +1554,25 @@ int vtkMRMLSegmentationStorageNode::ReadBinaryLabelmapRepresentation(vtkMRMLSegm
           currentSegment->SetLabelValue(vtkVariant(labelValue).ToInt());
           }
 
+        if (currentBinaryLabelmap == nullptr)
+          {
+          currentBinaryLabelmap = layerLabelmaps[frameIndex];
+          }
         if (currentBinaryLabelmap == nullptr)
           {
           currentBinaryLabelmap = vtkSmartPointer<vtkOrientedImageData>::New();
 
           // Extent
           int currentSegmentExtent[6] = { 0, -1, 0, -1, 0, -1 };
-          std::string currentExtentString;
-          if (this->GetSegmentMetaDataFromDicitionary(currentExtentString, dictionary, segmentIndex, KEY_SEGMENT_EXTENT))
-            {
-            GetImageExtentFromString(currentSegmentExtent, currentExtentString);
-            }
-          else
-            {
-            vtkWarningMacro("Segment extent is missing for segment " << segmentIndex);
-            for (int i = 0; i < 6; i++)
-              {
-              currentSegmentExtent[i] = imageExtentInFile[i];
-              }
-            }
+          std::copy(layerExtentsInFile[frameIndex].begin(), layerExtentsInFile[frameIndex].end(), currentSegmentExtent);
           for (int i = 0; i < 3; i++)
             {
             currentSegmentExtent[i * 2] += referenceImageExtentOffset[i];
             currentSegmentExtent[i * 2 + 1] += referenceImageExtentOffset[i];
             }
           // Copy with clipping to specified extent
-          if (currentSegmentExtent[0] <= currentSegmentExtent[1]
+          if (imageData
+            && currentSegmentExtent[0] <= currentSegmentExtent[1]
             && currentSegmentExtent[2] <= currentSegmentExtent[3]
             && currentSegmentExtent[4] <= currentSegmentExtent[5])
             {
@@ -820,7 +1621,7 @@ int vtkMRMLSegmentationStorageNode::ReadBinaryLabelmapRepresentation(vtkMRMLSegm
         {
         // No segment ID is specified, which may mean that it is an empty segmentation.
         // We consider a segmentation empty if it has only one scalar component that is empty.
-        if (numberOfFrames == 1)
+        if (numberOfFrames == 1 && imageData)
           {
           extractComponents->SetComponents(segmentIndex);
           extractComponents->Update();
@@ -1064,6 +1865,13 @@ int vtkMRMLSegmentationStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
     return 0;
     }
 
+  // Segments that were read from a file header only must be complete before they are written
+  if (this->LabelmapVoxelsPending && !this->ReadLabelmapVoxels(segmentationNode))
+    {
+    vtkErrorMacro("WriteDataInternal: Failed to read voxels of segments from " << this->PendingLabelmapFileName);
+    return 0;
+    }
+
   // Write only master representation
   if (segmentationNode->GetSegmentation()->IsMasterRepresentationImageData())
     {
@@ -1073,12 +1881,56 @@ int vtkMRMLSegmentationStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
     {
     return this->WritePolyDataRepresentation(segmentationNode, fullName);
     }
+  else if (IsMasterRepresentationSparseBinaryLabelmap(segmentationNode->GetSegmentation()))
+    {
+    return this->WriteSparseBinaryLabelmapRepresentation(segmentationNode, fullName);
+    }
 
   vtkErrorMacro("Segmentation master representation " << segmentationNode->GetSegmentation()->GetMasterRepresentationName()
     << " cannot be written to file");
   return 0;
 }
 
+//----------------------------------------------------------------------------
+int vtkMRMLSegmentationStorageNode::WriteSparseBinaryLabelmapRepresentation(vtkMRMLSegmentationNode* segmentationNode, std::string fullName)
+{
+  if (!segmentationNode || !IsMasterRepresentationSparseBinaryLabelmap(segmentationNode->GetSegmentation()))
+    {
+    vtkErrorMacro("WriteSparseBinaryLabelmapRepresentation: Invalid segmentation to write to disk");
+    return 0;
+    }
+  vtkSegmentation* segmentation = segmentationNode->GetSegmentation();
+  const char* sparseRepresentationName = vtkSegmentationConverter::GetSegmentationSparseBinaryLabelmapRepresentationName();
+  const char* binaryRepresentationName = vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName();
+
+  // Convert segments of a temporary segmentation that shares the sparse labelmaps,
+  // so that the written segmentation is not modified.
+  vtkNew<vtkMRMLSegmentationNode> denseSegmentationNode;
+  vtkSegmentation* denseSegmentation = denseSegmentationNode->GetSegmentation();
+  denseSegmentation->SetMasterRepresentationName(sparseRepresentationName);
+  denseSegmentation->CopyConversionParameters(segmentation);
+  std::vector< std::string > segmentIDs;
+  segmentation->GetSegmentIDs(segmentIDs);
+  for (std::vector< std::string >::const_iterator segmentIdIt = segmentIDs.begin(); segmentIdIt != segmentIDs.end(); ++segmentIdIt)
+    {
+    vtkSegment* segment = segmentation->GetSegment(*segmentIdIt);
+    vtkNew<vtkSegment> denseSegment;
+    denseSegment->DeepCopyMetadata(segment);
+    denseSegment->AddRepresentation(sparseRepresentationName, segment->GetRepresentation(sparseRepresentationName));
+    denseSegmentation->AddSegment(denseSegment.GetPointer(), *segmentIdIt);
+    }
+  if (denseSegmentation->GetNumberOfSegments() > 0 && !denseSegmentation->CreateRepresentation(binaryRepresentationName))
+    {
+    vtkErrorMacro("WriteSparseBinaryLabelmapRepresentation: Failed to convert sparse labelmaps to binary labelmaps");
+    return 0;
+    }
+  denseSegmentation->SetMasterRepresentationName(binaryRepresentationName);
+
+  // Contained representation names of the written segmentation are saved,
+  // so that the sparse representation is created when the file is loaded.
+  return this->WriteBinaryLabelmapRepresentation(denseSegmentationNode.GetPointer(), fullName);
+}
+
 //----------------------------------------------------------------------------
 int vtkMRMLSegmentationStorageNode::WriteBinaryLabelmapRepresentation(vtkMRMLSegmentationNode* segmentationNode, std::string fullName)
 {
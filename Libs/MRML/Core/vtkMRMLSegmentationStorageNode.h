@@ -180,6 +180,29 @@ public:
   vtkGetMacro(CropToMinimumExtent, bool);
   vtkBooleanMacro(CropToMinimumExtent, bool);
 
+  /// If enabled then only the header of .seg.nrrd files is read: segments are created with
+  /// their names, colors, tags, and layers, but their binary labelmaps remain empty
+  /// until ReadLabelmapVoxels is called. If the segmentation has no display node then a hidden
+  /// one is created. Voxels are read automatically when a display node of the segmentation is
+  /// visible or made visible, when segment representations are accessed (through
+  /// vtkMRMLSegmentationNode or directly through vtkSegment, see vtkSegment::SetRepresentationsPending),
+  /// or when the segmentation is written.
+  /// Files without segment metadata (plain labelmap volumes) are always read completely.
+  /// It is enabled by the readHeaderOnly attribute in scene files and by the "readHeaderOnly"
+  /// property of the segmentation reader. Default is off.
+  vtkSetMacro(ReadHeaderOnly, bool);
+  vtkGetMacro(ReadHeaderOnly, bool);
+  vtkBooleanMacro(ReadHeaderOnly, bool);
+
+  /// Returns true if segments were read using ReadHeaderOnly and their voxels are not read yet.
+  vtkGetMacro(LabelmapVoxelsPending, bool);
+
+  /// Read voxels of segments that were created when the file was read with ReadHeaderOnly enabled.
+  /// Segments are matched by segment ID. Segments that are modified since the header was read are not changed.
+  /// Returns 1 if there is nothing to read or all voxels are read successfully, 0 on failure.
+  /// Voxels remain pending if reading fails.
+  int ReadLabelmapVoxels(vtkMRMLSegmentationNode* segmentationNode);
+
 protected:
   /// Initialize all the supported read file types
   void InitializeSupportedReadFileTypes() override;
@@ -196,6 +219,11 @@ protected:
   /// Write binary labelmap representation to file
   virtual int WriteBinaryLabelmapRepresentation(vtkMRMLSegmentationNode* segmentationNode, std::string path);
 
+  /// Write sparse binary labelmap representation to file.
+  /// Segments are converted to dense binary labelmaps and written as binary labelmap master representation,
+  /// the sparse representation is re-created when the file is loaded.
+  virtual int WriteSparseBinaryLabelmapRepresentation(vtkMRMLSegmentationNode* segmentationNode, std::string path);
+
   /// Write a poly data representation to file
   virtual int WritePolyDataRepresentation(vtkMRMLSegmentationNode* segmentationNode, std::string path);
 
@@ -205,6 +233,13 @@ protected:
   /// Read binary labelmap representation from nrrd file (3D spatial + list)
   virtual int ReadBinaryLabelmapRepresentation(vtkMRMLSegmentationNode* segmentationNode, std::string path);
 
+  /// Read segments from nrrd file (3D spatial + list), without creating the representations that the file lists.
+  /// If readVoxels is false and the file contains segment metadata then the segments are created with empty labelmaps
+  /// and LabelmapVoxelsPending is set.
+  /// Names of representations that should be created are returned in containedRepresentationNames.
+  int ReadBinaryLabelmapSegments(vtkMRMLSegmentationNode* segmentationNode, const std::string& path,
+    bool readVoxels, std::string& containedRepresentationNames);
+
 #ifdef SUPPORT_4D_SPATIAL_NRRD
   /// Read binary labelmap representation from 4D spatial nrrd file - obsolete
   virtual int ReadBinaryLabelmapRepresentation4DSpatial(vtkMRMLSegmentationNode* segmentationNode, std::string path);
@@ -245,6 +280,11 @@ protected:
 
 protected:
   bool CropToMinimumExtent{false};
+  bool ReadHeaderOnly{false};
+  bool LabelmapVoxelsPending{false};
+  bool ReadingLabelmapVoxels{false};
+  /// File that the pending labelmap voxels are read from (file name may change before the voxels are read)
+  std::string PendingLabelmapFileName;
 
 protected:
   vtkMRMLSegmentationStorageNode();
@@ -20,6 +20,7 @@
 #include "vtkMRMLSequenceNode.h"
 #include "vtkMRMLSequenceStorageNode.h"
 #include "vtkMRMLStorableNode.h"
+#include "vtkMRMLVolumeSequenceFrameLoader.h"
 #include "vtkMRMLVolumeSequenceStorageNode.h"
 
 // MRML includes
@@ -34,6 +35,7 @@
 #include <vtkTimerLog.h>
 
 // STD includes
+#include <algorithm>
 #include <sstream>
 
 #define SAFE_CHAR_POINTER(unsafeString) ( unsafeString==nullptr?"":unsafeString )
@@ -83,7 +85,9 @@ vtkMRMLSequenceNode::~vtkMRMLSequenceNode()
 //----------------------------------------------------------------------------
 void vtkMRMLSequenceNode::RemoveAllDataNodes()
 {
+  this->FrameLoader = nullptr;
   this->IndexEntries.clear();
+  this->IndexValueLookup.clear();
   if (!this->SequenceScene)
     {
     return;
@@ -193,6 +197,7 @@ void vtkMRMLSequenceNode::ReadIndexValues(const std::string& indexText)
   if (!this->IndexEntries.empty())
     {
     this->IndexEntries.clear();
+    this->IndexValueLookup.clear();
     modified = true;
     }
 
@@ -208,6 +213,7 @@ void vtkMRMLSequenceNode::ReadIndexValues(const std::string& indexText)
 
       IndexEntryType indexEntry;
       indexEntry.IndexValue=indexValue;
+      indexEntry.NumericIndexValue = atof(indexValue.c_str());
       // The nodes are not read yet, so we can only store the node ID and get the pointer to the node later (in UpdateScene())
       indexEntry.DataNodeID=nodeId;
       indexEntry.DataNode=nullptr;
@@ -218,6 +224,7 @@ void vtkMRMLSequenceNode::ReadIndexValues(const std::string& indexText)
 
   if (modified)
     {
+    this->UpdateIndexValueLookup();
     this->Modified();
     }
 }
@@ -242,6 +249,13 @@ void vtkMRMLSequenceNode::Copy(vtkMRMLNode *anode)
   this->SetIndexType(snode->GetIndexType());
   this->SetNumericIndexValueTolerance(snode->GetNumericIndexValueTolerance());
 
+  // Data nodes that are not loaded yet would be copied without content
+  if (snode->FrameLoader)
+    {
+    snode->FrameLoader->LoadAllDataNodes();
+    }
+  this->FrameLoader = nullptr;
+
   // Clear nodes: RemoveAllNodes is not a public method, so it's simpler to just delete and recreate the scene
   if (this->SequenceScene)
     {
@@ -268,6 +282,7 @@ void vtkMRMLSequenceNode::Copy(vtkMRMLNode *anode)
     {
     IndexEntryType seqItem;
     seqItem.IndexValue=sourceIndexIt->IndexValue;
+    seqItem.NumericIndexValue = sourceIndexIt->NumericIndexValue;
     seqItem.DataNode = nullptr;
     if (sourceIndexIt->DataNode!=nullptr)
       {
@@ -285,6 +300,7 @@ void vtkMRMLSequenceNode::Copy(vtkMRMLNode *anode)
       }
     this->IndexEntries.push_back(seqItem);
     }
+  this->UpdateIndexValueLookup();
   this->Modified();
   this->StorableModifiedTime.Modified();
 
@@ -307,6 +323,7 @@ void vtkMRMLSequenceNode::CopySequenceIndex(vtkMRMLNode *anode)
       {
       IndexEntryType seqItem;
       seqItem.IndexValue = sourceIndexIt->IndexValue;
+      seqItem.NumericIndexValue = sourceIndexIt->NumericIndexValue;
       if (sourceIndexIt->DataNode != nullptr)
         {
         seqItem.DataNodeID = sourceIndexIt->DataNode->GetID();
@@ -318,6 +335,7 @@ void vtkMRMLSequenceNode::CopySequenceIndex(vtkMRMLNode *anode)
       seqItem.DataNode = nullptr;
       this->IndexEntries.push_back(seqItem);
       }
+    this->UpdateIndexValueLookup();
     this->Modified();
     }
   this->EndModify(wasModified);
@@ -360,12 +378,19 @@ bool vtkMRMLSequenceNode::UpdateDataNodeAtValue(vtkMRMLNode* node, const std::st
     vtkErrorMacro("vtkMRMLSequenceNode::UpdateDataNodeAtValue failed, invalid node");
     return false;
     }
-  vtkMRMLNode* nodeToBeUpdated = this->GetDataNodeAtValue(indexValue);
+  // Content is replaced, therefore it does not have to be loaded
+  int itemNumber = this->GetItemNumberFromIndexValue(indexValue);
+  vtkMRMLNode* nodeToBeUpdated = (itemNumber >= 0 ? this->GetNthDataNodeWithoutLoading(itemNumber) : nullptr);
   if (!nodeToBeUpdated)
     {
     vtkDebugMacro("vtkMRMLSequenceNode::UpdateDataNodeAtValue failed, indexValue not found");
     return false;
     }
+  if (this->FrameLoader)
+    {
+    // Content is replaced, it must not be loaded from the file anymore
+    this->FrameLoader->RemoveDataNode(nodeToBeUpdated);
+    }
   nodeToBeUpdated->CopyContent(node, !shallowCopy);
   this->Modified();
   this->StorableModifiedTime.Modified();
@@ -380,7 +405,7 @@ int vtkMRMLSequenceNode::GetInsertPosition(const std::string& indexValue)
     {
     int itemNumber = this->GetItemNumberFromIndexValue(indexValue, false);
     double numericIndexValue = atof(indexValue.c_str());
-    double foundNumericIndexValue = atof(this->IndexEntries[itemNumber].IndexValue.c_str());
+    double foundNumericIndexValue = this->IndexEntries[itemNumber].NumericIndexValue;
     if (numericIndexValue < foundNumericIndexValue) // Deals with case of index value being smaller than any in the sequence and numeric tolerances
       {
       insertPosition = itemNumber;
@@ -413,7 +438,10 @@ vtkMRMLNode* vtkMRMLSequenceNode::SetDataNodeAtValue(vtkMRMLNode* node, const st
     // Create new item
     IndexEntryType seqItem;
     seqItem.IndexValue = indexValue;
+    seqItem.NumericIndexValue = atof(indexValue.c_str());
     this->IndexEntries.insert(this->IndexEntries.begin() + seqItemIndex, seqItem);
+    // Only items after the inserted item are renumbered (none if appended)
+    this->UpdateIndexValueLookup(seqItemIndex);
     }
   this->IndexEntries[seqItemIndex].DataNode = newNode;
   this->IndexEntries[seqItemIndex].DataNodeID.clear();
@@ -437,8 +465,15 @@ void vtkMRMLSequenceNode::RemoveDataNodeAtValue(const std::string& indexValue)
     return;
     }
   // TODO: remove associated nodes as well (such as storage node)?
+  if (this->FrameLoader)
+    {
+    this->FrameLoader->RemoveDataNode(this->IndexEntries[seqItemIndex].DataNode);
+    }
   this->SequenceScene->RemoveNode(this->IndexEntries[seqItemIndex].DataNode);
+  this->RemoveIndexValueLookupEntry(this->IndexEntries[seqItemIndex].IndexValue, seqItemIndex);
   this->IndexEntries.erase(this->IndexEntries.begin()+seqItemIndex);
+  // Lookup of a remaining item with the same index value is restored
+  this->UpdateIndexValueLookup(seqItemIndex);
   this->Modified();
   this->StorableModifiedTime.Modified();
 }
@@ -460,8 +495,8 @@ int vtkMRMLSequenceNode::GetItemNumberFromIndexValue(const std::string& indexVal
 
     // Deal with index values not within the range of index values in the Sequence
     double numericIndexValue = atof(indexValue.c_str());
-    double lowerNumericIndexValue = atof(this->IndexEntries[lowerBound].IndexValue.c_str());
-    double upperNumericIndexValue = atof(this->IndexEntries[upperBound].IndexValue.c_str());
+    double lowerNumericIndexValue = this->IndexEntries[lowerBound].NumericIndexValue;
+    double upperNumericIndexValue = this->IndexEntries[upperBound].NumericIndexValue;
     if (numericIndexValue <= lowerNumericIndexValue + this->NumericIndexValueTolerance)
       {
       if (numericIndexValue < lowerNumericIndexValue - this->NumericIndexValueTolerance && exactMatchRequired)
@@ -489,7 +524,7 @@ int vtkMRMLSequenceNode::GetItemNumberFromIndexValue(const std::string& indexVal
       {
       // Note that if middle is equal to either lowerBound or upperBound then upperBound - lowerBound <= 1
       int middle = int((lowerBound + upperBound)/2);
-      double middleNumericIndexValue = atof(this->IndexEntries[middle].IndexValue.c_str());
+      double middleNumericIndexValue = this->IndexEntries[middle].NumericIndexValue;
       if (fabs(numericIndexValue - middleNumericIndexValue) <= this->NumericIndexValueTolerance)
         {
         return middle;
@@ -509,16 +544,56 @@ int vtkMRMLSequenceNode::GetItemNumberFromIndexValue(const std::string& indexVal
       }
     }
 
-  // Need linear search for non-numeric index
-  for (int i=0; i<numberOfSeqItems; i++)
+  // Exact match of the index value string
+  std::unordered_map< std::string, int >::iterator lookupIt = this->IndexValueLookup.find(indexValue);
+  if (lookupIt != this->IndexValueLookup.end())
+    {
+    return lookupIt->second;
+    }
+
+  return -1;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLSequenceNode::UpdateIndexValueLookup(int firstItemNumber /* =0 */)
+{
+  int numberOfSeqItems = this->IndexEntries.size();
+  if (firstItemNumber <= 0)
     {
-    if (this->IndexEntries[i].IndexValue.compare(indexValue)==0)
+    // If an index value is found multiple times then the first item is used
+    this->IndexValueLookup.clear();
+    for (int i = 0; i < numberOfSeqItems; i++)
       {
-      return i;
+      this->IndexValueLookup.insert(std::make_pair(this->IndexEntries[i].IndexValue, i));
       }
+    return;
     }
+  // Items before firstItemNumber are not renumbered, their entries remain valid.
+  // Entries that refer to renumbered items are removed first, so that duplicate
+  // index values are resolved to the first item the same way as in a full update.
+  for (int i = firstItemNumber; i < numberOfSeqItems; i++)
+    {
+    std::unordered_map< std::string, int >::iterator lookupIt = this->IndexValueLookup.find(this->IndexEntries[i].IndexValue);
+    if (lookupIt != this->IndexValueLookup.end() && lookupIt->second >= firstItemNumber)
+      {
+      this->IndexValueLookup.erase(lookupIt);
+      }
+    }
+  for (int i = firstItemNumber; i < numberOfSeqItems; i++)
+    {
+    this->IndexValueLookup.insert(std::make_pair(this->IndexEntries[i].IndexValue, i));
+    }
+}
 
-  return -1;
+//---------------------------------------------------------------------------
+void vtkMRMLSequenceNode::RemoveIndexValueLookupEntry(const std::string& indexValue, int itemNumber)
+{
+  std::unordered_map< std::string, int >::iterator lookupIt = this->IndexValueLookup.find(indexValue);
+  if (lookupIt != this->IndexValueLookup.end() && lookupIt->second >= itemNumber)
+    {
+    // An item before itemNumber with the same index value keeps its entry
+    this->IndexValueLookup.erase(lookupIt);
+    }
 }
 
 //---------------------------------------------------------------------------
@@ -535,7 +610,7 @@ vtkMRMLNode* vtkMRMLSequenceNode::GetDataNodeAtValue(const std::string& indexVal
     // not found
     return nullptr;
     }
-  return this->IndexEntries[seqItemIndex].DataNode;
+  return this->GetNthDataNode(seqItemIndex);
 }
 
 //---------------------------------------------------------------------------
@@ -575,7 +650,9 @@ bool vtkMRMLSequenceNode::UpdateIndexValue(const std::string& oldIndexValue, con
     return false;
     }
   // Update the index value
+  this->RemoveIndexValueLookupEntry(this->IndexEntries[oldSeqItemIndex].IndexValue, oldSeqItemIndex);
   this->IndexEntries[oldSeqItemIndex].IndexValue = newIndexValue;
+  this->IndexEntries[oldSeqItemIndex].NumericIndexValue = atof(newIndexValue.c_str());
   if (this->IndexType == vtkMRMLSequenceNode::NumericIndex)
     {
     IndexEntryType movingEntry = this->IndexEntries[oldSeqItemIndex];
@@ -584,7 +661,10 @@ bool vtkMRMLSequenceNode::UpdateIndexValue(const std::string& oldIndexValue, con
     // Insert into new position
     int insertPosition = this->GetInsertPosition(newIndexValue);
     this->IndexEntries.insert(this->IndexEntries.begin() + insertPosition, movingEntry);
+    // Renumber items between the old and new position
+    oldSeqItemIndex = std::min(oldSeqItemIndex, insertPosition);
     }
+  this->UpdateIndexValueLookup(oldSeqItemIndex);
   this->Modified();
   this->StorableModifiedTime.Modified();
   return true;
@@ -634,14 +714,46 @@ std::string vtkMRMLSequenceNode::GetDataNodeTagName()
 //-----------------------------------------------------------------------------
 vtkMRMLNode* vtkMRMLSequenceNode::GetNthDataNode(int itemNumber)
 {
-  if (static_cast<int>(this->IndexEntries.size())<=itemNumber)
+  if (itemNumber < 0 || static_cast<int>(this->IndexEntries.size())<=itemNumber)
     {
     vtkErrorMacro("vtkMRMLSequenceNode::GetNthDataNode failed: itemNumber "<<itemNumber<<" is out of range");
     return nullptr;
     }
+  if (this->FrameLoader)
+    {
+    this->FrameLoader->LoadDataNode(this, itemNumber);
+    }
+  return this->IndexEntries[itemNumber].DataNode;
+}
+
+//-----------------------------------------------------------------------------
+vtkMRMLNode* vtkMRMLSequenceNode::GetNthDataNodeWithoutLoading(int itemNumber)
+{
+  if (itemNumber < 0 || itemNumber >= static_cast<int>(this->IndexEntries.size()))
+    {
+    vtkErrorMacro("vtkMRMLSequenceNode::GetNthDataNodeWithoutLoading failed: itemNumber " << itemNumber << " is out of range");
+    return nullptr;
+    }
   return this->IndexEntries[itemNumber].DataNode;
 }
 
+//-----------------------------------------------------------------------------
+void vtkMRMLSequenceNode::SetFrameLoader(vtkMRMLVolumeSequenceFrameLoader* loader)
+{
+  if (this->FrameLoader == loader)
+    {
+    return;
+    }
+  this->FrameLoader = loader;
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+vtkMRMLVolumeSequenceFrameLoader* vtkMRMLSequenceNode::GetFrameLoader()
+{
+  return this->FrameLoader;
+}
+
 //-----------------------------------------------------------------------------
 vtkMRMLScene* vtkMRMLSequenceNode::GetSequenceScene(bool autoCreate/*=true*/)
 {
@@ -676,7 +788,7 @@ std::string vtkMRMLSequenceNode::GetDefaultStorageNodeClassName(const char* file
     }
 
   // Use specific sequence storage node, if possible
-  vtkMRMLStorableNode* storableNode = vtkMRMLStorableNode::SafeDownCast(this->GetNthDataNode(0));
+  vtkMRMLStorableNode* storableNode = vtkMRMLStorableNode::SafeDownCast(this->GetNthDataNodeWithoutLoading(0));
   if (storableNode)
     {
     vtkSmartPointer<vtkMRMLStorageNode> storageNode = vtkSmartPointer<vtkMRMLStorageNode>::Take(
@@ -22,9 +22,15 @@
 #include <vtkMRML.h>
 #include <vtkMRMLStorableNode.h>
 
+// VTK includes
+#include <vtkSmartPointer.h>
+
 // std includes
 #include <deque>
 #include <set>
+#include <unordered_map>
+
+class vtkMRMLVolumeSequenceFrameLoader;
 
 
 /// \brief MRML node for representing a sequence of MRML nodes
@@ -115,11 +121,18 @@ public:
 
   /// Get the node corresponding to the specified index value
   /// If exact match is not required and index is numeric then the best matching data node is returned.
+  /// If data nodes are loaded on demand (see SetFrameLoader) then the content of the returned node is loaded.
   vtkMRMLNode* GetDataNodeAtValue(const std::string& indexValue, bool exactMatchRequired = true);
 
   /// Get the data node corresponding to the n-th index value
+  /// If data nodes are loaded on demand (see SetFrameLoader) then the content of the returned node is loaded.
   vtkMRMLNode* GetNthDataNode(int itemNumber);
 
+  /// Get the data node corresponding to the n-th index value without loading its content.
+  /// If data nodes are loaded on demand then the returned node may not contain voxels yet,
+  /// therefore only properties that are not loaded on demand (name, class, geometry) may be accessed.
+  vtkMRMLNode* GetNthDataNodeWithoutLoading(int itemNumber);
+
   /// Index value of n-th data node.
   std::string GetNthIndexValue(int itemNumber);
 
@@ -153,6 +166,11 @@ public:
   /// and generic vtkMRMLSequenceStorageNode otherwise.
   std::string GetDefaultStorageNodeClassName(const char* filename = nullptr) override;
 
+  /// Set loader that loads the content of data nodes when they are requested by GetNthDataNode
+  /// or GetDataNodeAtValue (used for reading large volume sequences on demand).
+  void SetFrameLoader(vtkMRMLVolumeSequenceFrameLoader* loader);
+  vtkMRMLVolumeSequenceFrameLoader* GetFrameLoader();
+
   /// Update node IDs in case of node ID conflicts on scene import
   void UpdateScene(vtkMRMLScene *scene) override;
 
@@ -179,9 +197,20 @@ protected:
 
   vtkMRMLNode* DeepCopyNodeToScene(vtkMRMLNode* source, vtkMRMLScene* scene);
 
+  /// Update item numbers in the index value lookup table, starting from the specified item.
+  /// All items must be updated (firstItemNumber = 0) after IndexEntries is replaced.
+  /// If an index value occurs multiple times then the lookup table refers to the first item.
+  void UpdateIndexValueLookup(int firstItemNumber = 0);
+
+  /// Remove the lookup table entry of an index value that is removed from the specified item,
+  /// unless the entry refers to an earlier item with the same index value.
+  /// UpdateIndexValueLookup must be called afterward to add later items with the same index value.
+  void RemoveIndexValueLookupEntry(const std::string& indexValue, int itemNumber);
+
   struct IndexEntryType
     {
     std::string IndexValue;
+    double NumericIndexValue; // IndexValue converted to number, used for searching in numeric index
     vtkMRMLNode* DataNode;
     std::string DataNodeID; // only used temporarily, during scene load
     };
@@ -200,6 +229,14 @@ protected:
 
   /// List of data items (the scene may contain some more nodes, such as storage nodes)
   std::deque< IndexEntryType > IndexEntries;
+
+  /// Item number of each index value, for finding items in constant time by exact index value
+  std::unordered_map< std::string, int > IndexValueLookup;
+
+  /// Loads content of data nodes on demand
+  vtkSmartPointer<vtkMRMLVolumeSequenceFrameLoader> FrameLoader;
+
+  friend class vtkMRMLVolumeSequenceFrameLoader;
 };
 
 #endif
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "vtkMRMLSequenceNode.h"
 #include "vtkMRMLSequenceStorageNode.h"
+#include "vtkMRMLVolumeSequenceFrameLoader.h"
 #include "vtkMRMLScene.h"
 
 // VTK includes
@@ -164,6 +165,13 @@ int vtkMRMLSequenceStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
 
   std::string extension = vtkMRMLStorageNode::GetLowercaseExtensionFromFileName(fullName);
 
+  // Data nodes are written by their own storage nodes, therefore their content must be loaded
+  if (sequenceNode->GetFrameLoader())
+    {
+    sequenceNode->GetFrameLoader()->LoadAllDataNodes();
+    sequenceNode->SetFrameLoader(nullptr);
+    }
+
   bool success = false;
   if (extension == ".mrb")
     {
@@ -26,6 +26,7 @@ Version:   $Revision: 1.1.1.1 $
 #include <vtkCommand.h>
 #include <vtkNew.h>
 #include <vtkStringArray.h>
+#include <vtkTimerLog.h>
 #include <vtkURIHandler.h>
 
 // VTKSYS includes
@@ -57,6 +58,10 @@ vtkMRMLStorageNode::vtkMRMLStorageNode()
   this->SupportedWriteFileTypes = vtkStringArray::New();
   this->WriteFileFormat = nullptr;
   this->StoredTime = vtkTimeStamp::New();
+  this->PrefetchResult = 0;
+  this->PrefetchTime = 0.0;
+  this->PrefetchInBackground = false;
+  this->LastReadUsedPrefetchedData = false;
 }
 
 //----------------------------------------------------------------------------
@@ -1167,6 +1172,7 @@ bool vtkMRMLStorageNode::CanWriteFromReferenceNode(vtkMRMLNode *refNode)
 //------------------------------------------------------------------------------
 int vtkMRMLStorageNode::ReadData(vtkMRMLNode* refNode, bool temporary)
 {
+  this->LastReadUsedPrefetchedData = false;
   if (refNode == nullptr)
     {
     vtkErrorMacro("ReadData: can't read into a null node");
@@ -1195,6 +1201,32 @@ int vtkMRMLStorageNode::ReadData(vtkMRMLNode* refNode, bool temporary)
     return 0;
     }
 
+  if (this->PrefetchNode && this->PrefetchReferenceNode == refNode)
+    {
+    // Data has been already read in a background thread, just apply it
+    int res = this->PrefetchResult;
+    if (res)
+      {
+      this->ApplyPrefetchedData(refNode, this->PrefetchNode);
+      this->LastReadUsedPrefetchedData = true;
+      }
+    this->ClearPrefetchedData();
+    if (res)
+      {
+      vtkMRMLStorableNode* storableNode = vtkMRMLStorableNode::SafeDownCast(refNode);
+      if (storableNode)
+        {
+        storableNode->SetAndObserveStorageNodeID(this->GetID());
+        }
+      this->SetReadStateIdle();
+      if (!temporary)
+        {
+        this->StoredTime->Modified();
+        }
+      }
+    return res;
+    }
+
   this->StageReadData(refNode);
   if ( this->GetReadState() != this->TransferDone )
     {
@@ -1222,6 +1254,82 @@ int vtkMRMLStorageNode::ReadData(vtkMRMLNode* refNode, bool temporary)
   return res;
 }
 
+//------------------------------------------------------------------------------
+bool vtkMRMLStorageNode::CanPrefetchData(vtkMRMLNode* vtkNotUsed(refNode))
+{
+  return false;
+}
+
+//------------------------------------------------------------------------------
+bool vtkMRMLStorageNode::InitializePrefetchData(vtkMRMLNode* refNode)
+{
+  this->ClearPrefetchedData();
+  if (!refNode || !refNode->GetAddToScene() || !this->CanReadInReferenceNode(refNode))
+    {
+    return false;
+    }
+  if (this->GetScene() && this->GetScene()->GetReadDataOnLoad() == 0)
+    {
+    return false;
+    }
+  if (!this->GetFileName() || (this->GetURI() && strlen(this->GetURI()) > 0))
+    {
+    // remote files are downloaded by the cache manager, which requires the scene
+    return false;
+    }
+  if (!refNode->HasCopyContent() || !this->CanPrefetchData(refNode))
+    {
+    return false;
+    }
+
+  // File names are already absolute (they are resolved when the scene is read),
+  // therefore the temporary storage node can read the file without having a scene.
+  this->PrefetchStorageNode = vtkSmartPointer<vtkMRMLStorageNode>::Take(
+    vtkMRMLStorageNode::SafeDownCast(this->CreateNodeInstance()));
+  this->PrefetchNode = vtkSmartPointer<vtkMRMLNode>::Take(refNode->CreateNodeInstance());
+  if (!this->PrefetchStorageNode || !this->PrefetchNode)
+    {
+    this->ClearPrefetchedData();
+    return false;
+    }
+  this->PrefetchStorageNode->Copy(this);
+  this->PrefetchStorageNode->PrefetchInBackground = true;
+  this->PrefetchNode->CopyContent(refNode, false);
+  this->PrefetchReferenceNode = refNode;
+  this->PrefetchResult = 0;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+int vtkMRMLStorageNode::PrefetchData()
+{
+  if (!this->PrefetchStorageNode || !this->PrefetchNode)
+    {
+    return 0;
+    }
+  double startTime = vtkTimerLog::GetUniversalTime();
+  this->PrefetchResult = this->PrefetchStorageNode->ReadData(this->PrefetchNode, true);
+  this->PrefetchTime = vtkTimerLog::GetUniversalTime() - startTime;
+  return this->PrefetchResult;
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLStorageNode::ClearPrefetchedData()
+{
+  this->PrefetchStorageNode = nullptr;
+  this->PrefetchNode = nullptr;
+  this->PrefetchReferenceNode = nullptr;
+  this->PrefetchResult = 0;
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLStorageNode::ApplyPrefetchedData(vtkMRMLNode* refNode, vtkMRMLNode* prefetchedNode)
+{
+  // Reading may update storage node properties (file list, coordinate system, etc.)
+  this->Copy(this->PrefetchStorageNode);
+  refNode->CopyContent(prefetchedNode, false);
+}
+
 //------------------------------------------------------------------------------
 int vtkMRMLStorageNode::WriteData(vtkMRMLNode* refNode)
 {
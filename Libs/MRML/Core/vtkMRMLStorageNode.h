@@ -300,6 +300,39 @@ public:
   /// \sa CanReadInReferenceNode, WriteData
   virtual bool CanWriteFromReferenceNode(vtkMRMLNode* refNode);
 
+  /// Return true if the data file can be read into refNode in a background thread
+  /// by PrefetchData. It is only supported if ReadDataInternal modifies only the node
+  /// that it reads into and the storage node itself (does not access the scene
+  /// or other nodes) and does not add observers through vtkEventBroker, unless
+  /// PrefetchInBackground is checked. Returns false by default.
+  /// \sa InitializePrefetchData(), PrefetchData()
+  virtual bool CanPrefetchData(vtkMRMLNode* refNode);
+
+  /// Prepare reading the data file of refNode in a background thread.
+  /// Temporary copies of this storage node and refNode are created, which are
+  /// then used by PrefetchData. Must be called from the main thread.
+  /// Returns false if the data cannot be prefetched (remote file, unsupported
+  /// storage node, etc.), in this case ReadData reads the file as usual.
+  /// \sa PrefetchData(), CanPrefetchData()
+  bool InitializePrefetchData(vtkMRMLNode* refNode);
+
+  /// Read the data file into the temporary node created by InitializePrefetchData.
+  /// It does not modify this storage node or the reference node, therefore it can be
+  /// called from a background thread (only one thread may prefetch data of a storage node).
+  /// The next ReadData call on refNode uses the prefetched data instead of reading the file.
+  /// Returns 1 on success, 0 on failure.
+  int PrefetchData();
+
+  /// Discard prefetched data.
+  void ClearPrefetchedData();
+
+  /// Time spent in the last PrefetchData call (in seconds).
+  vtkGetMacro(PrefetchTime, double);
+
+  /// True if the last ReadData call applied data prefetched in a background
+  /// thread instead of reading the file.
+  vtkGetMacro(LastReadUsedPrefetchedData, bool);
+
   ///
   /// Configure the storage node for data exchange. This is an
   /// opportunity to optimize the storage node's settings, for
@@ -440,6 +473,26 @@ protected:
   vtkTimeStamp* StoredTime;
 
   vtkWeakPointer<vtkMRMLStorableNode> LastFoundStorableNode;
+
+  /// Copy the prefetched data into refNode. Called by ReadData.
+  /// By default the content of the prefetched node is shallow-copied into refNode
+  /// and properties of the temporary storage node (that may have been updated while
+  /// reading) are copied into this storage node.
+  virtual void ApplyPrefetchedData(vtkMRMLNode* refNode, vtkMRMLNode* prefetchedNode);
+
+  /// Temporary nodes used for reading data in a background thread
+  vtkSmartPointer<vtkMRMLStorageNode> PrefetchStorageNode;
+  vtkSmartPointer<vtkMRMLNode> PrefetchNode;
+  vtkWeakPointer<vtkMRMLNode> PrefetchReferenceNode;
+  int PrefetchResult;
+  double PrefetchTime;
+
+  /// Set in the temporary storage node that reads the data file in a background thread.
+  /// ReadDataInternal must not set observed objects in the node then (vtkEventBroker
+  /// is not thread-safe), but keep the data in the storage node for ApplyPrefetchedData.
+  bool PrefetchInBackground;
+
+  bool LastReadUsedPrefetchedData;
 };
 
 #endif
@@ -0,0 +1,903 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLTableBinaryStorageNode.h"
+#include "vtkMRMLTableNode.h"
+
+// VTK includes
+#include <vtkByteSwap.h>
+#include <vtkDataArray.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkSmartPointer.h>
+#include <vtkStringArray.h>
+#include <vtkTable.h>
+#include <vtkVariant.h>
+#include <vtkVersion.h>
+#include <vtkZLibDataCompressor.h>
+#include <vtksys/Encoding.hxx>
+#include <vtksys/FStream.hxx>
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#if VTK_MAJOR_VERSION >= 9 || (VTK_MAJOR_VERSION >= 8 && VTK_MINOR_VERSION >= 2)
+// Arrays can release their memory with a custom function, therefore mapped memory can be used in arrays
+#define MRML_TABLE_MEMORY_MAPPING_SUPPORTED
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#endif
+
+//------------------------------------------------------------------------------
+vtkMRMLNodeNewMacro(vtkMRMLTableBinaryStorageNode);
+
+namespace
+{
+
+/// File starts with this identifier, followed by location and size of the header
+const char FILE_TYPE_ID[] = "MRMLTBL1";
+const size_t FILE_TYPE_ID_SIZE = 8;
+const size_t PREAMBLE_SIZE = FILE_TYPE_ID_SIZE + 2 * sizeof(vtkTypeUInt64);
+
+const char SECTION_TABLE[] = "table";
+const char SECTION_SCHEMA[] = "schema";
+const char ENCODING_RAW[] = "raw";
+const char ENCODING_ZLIB[] = "zlib";
+
+/// Mapped columns must start at a multiple of the allocation granularity
+/// (64KB on Windows, which is a multiple of the page size on other platforms)
+const vtkTypeUInt64 MEMORY_MAPPING_ALIGNMENT = 65536;
+/// Smaller columns are read into memory, padding would take too much space in the file
+const vtkTypeUInt64 MEMORY_MAPPING_MINIMUM_SIZE = 1024 * 1024;
+const vtkTypeUInt64 DATA_ALIGNMENT = 8;
+
+//----------------------------------------------------------------------------
+struct ColumnBlock
+{
+  std::string Section;
+  std::string Name;
+  int ValueType{VTK_VOID};
+  int NumberOfComponents{1};
+  vtkIdType NumberOfTuples{0};
+  std::string ComponentNames;
+  std::string Encoding{ENCODING_RAW};
+  /// Location of the data block in the file
+  vtkTypeUInt64 Offset{0};
+  vtkTypeUInt64 StoredSize{0};
+  /// Size of the data block when uncompressed
+  vtkTypeUInt64 RawSize{0};
+
+  // Only used for writing
+  const char* RawData{nullptr};
+  std::vector<char> SerializedData;
+  std::vector<unsigned char> CompressedData;
+};
+
+//----------------------------------------------------------------------------
+bool IsMemoryMappable(const ColumnBlock& block)
+{
+  return block.Section == SECTION_TABLE && block.ValueType != VTK_STRING && block.ValueType != VTK_BIT
+    && block.RawSize >= MEMORY_MAPPING_MINIMUM_SIZE;
+}
+
+//----------------------------------------------------------------------------
+// Column names may contain any characters, escape the ones that are used as separators in the header
+std::string EscapeHeaderField(const std::string& text)
+{
+  std::string escaped;
+  escaped.reserve(text.size());
+  for (char c : text)
+    {
+    switch (c)
+      {
+      case '\\': escaped += "\\\\"; break;
+      case '\t': escaped += "\\t"; break;
+      case '\n': escaped += "\\n"; break;
+      case '\r': escaped += "\\r"; break;
+      default: escaped += c;
+      }
+    }
+  return escaped;
+}
+
+//----------------------------------------------------------------------------
+std::string UnescapeHeaderField(const std::string& text)
+{
+  std::string unescaped;
+  unescaped.reserve(text.size());
+  for (size_t i = 0; i < text.size(); ++i)
+    {
+    if (text[i] != '\\' || i + 1 >= text.size())
+      {
+      unescaped += text[i];
+      continue;
+      }
+    ++i;
+    switch (text[i])
+      {
+      case 't': unescaped += '\t'; break;
+      case 'n': unescaped += '\n'; break;
+      case 'r': unescaped += '\r'; break;
+      default: unescaped += text[i];
+      }
+    }
+  return unescaped;
+}
+
+//----------------------------------------------------------------------------
+std::vector<std::string> SplitHeaderLine(const std::string& line)
+{
+  std::vector<std::string> fields;
+  size_t start = 0;
+  while (true)
+    {
+    size_t end = line.find('\t', start);
+    fields.push_back(line.substr(start, end == std::string::npos ? std::string::npos : end - start));
+    if (end == std::string::npos)
+      {
+      break;
+      }
+    start = end + 1;
+    }
+  return fields;
+}
+
+//----------------------------------------------------------------------------
+void PrepareColumnBlock(vtkAbstractArray* array, const char* section, ColumnBlock& block)
+{
+  block.Section = section;
+  block.Name = (array->GetName() ? array->GetName() : "");
+  block.NumberOfComponents = array->GetNumberOfComponents();
+  block.NumberOfTuples = array->GetNumberOfTuples();
+  vtkIdType numberOfValues = array->GetNumberOfValues();
+
+  vtkDataArray* dataArray = vtkDataArray::SafeDownCast(array);
+  if (dataArray)
+    {
+    // Numeric values are written directly from the array
+    block.ValueType = dataArray->GetDataType();
+    block.ComponentNames = vtkMRMLTableNode::GetComponentNamesAsString(vtkMRMLTableNode::GetComponentNamesFromArray(dataArray));
+    block.RawData = (numberOfValues > 0 ? static_cast<const char*>(dataArray->GetVoidPointer(0)) : nullptr);
+    if (block.ValueType == VTK_BIT)
+      {
+      block.RawSize = static_cast<vtkTypeUInt64>(numberOfValues + 7) / 8;
+      }
+    else
+      {
+      block.RawSize = static_cast<vtkTypeUInt64>(numberOfValues) * dataArray->GetDataTypeSize();
+      }
+    return;
+    }
+
+  // Strings, variants, and any other values are stored as strings:
+  // offsets of the values (numberOfValues+1), followed by the characters of all values.
+  block.ValueType = VTK_STRING;
+  vtkStringArray* stringArray = vtkStringArray::SafeDownCast(array);
+  std::vector<vtkTypeUInt64> offsets(numberOfValues + 1, 0);
+  std::string characters;
+  for (vtkIdType valueIndex = 0; valueIndex < numberOfValues; ++valueIndex)
+    {
+    offsets[valueIndex] = characters.size();
+    if (stringArray)
+      {
+      characters += stringArray->GetValue(valueIndex);
+      }
+    else
+      {
+      characters += array->GetVariantValue(valueIndex).ToString();
+      }
+    }
+  offsets[numberOfValues] = characters.size();
+  size_t offsetsSize = offsets.size() * sizeof(vtkTypeUInt64);
+  block.SerializedData.resize(offsetsSize + characters.size());
+  memcpy(block.SerializedData.data(), offsets.data(), offsetsSize);
+  memcpy(block.SerializedData.data() + offsetsSize, characters.data(), characters.size());
+  block.RawData = block.SerializedData.data();
+  block.RawSize = block.SerializedData.size();
+}
+
+//----------------------------------------------------------------------------
+void CompressColumnBlock(ColumnBlock& block)
+{
+  if (block.RawSize == 0)
+    {
+    return;
+    }
+  vtkNew<vtkZLibDataCompressor> compressor;
+  size_t compressionSpace = compressor->GetMaximumCompressionSpace(block.RawSize);
+  block.CompressedData.resize(compressionSpace);
+  size_t compressedSize = compressor->Compress(reinterpret_cast<const unsigned char*>(block.RawData), block.RawSize,
+    block.CompressedData.data(), compressionSpace);
+  if (compressedSize == 0 || compressedSize >= block.RawSize)
+    {
+    // Failed or not worth it, store uncompressed
+    block.CompressedData.clear();
+    block.CompressedData.shrink_to_fit();
+    return;
+    }
+  block.CompressedData.resize(compressedSize);
+  block.Encoding = ENCODING_ZLIB;
+}
+
+//----------------------------------------------------------------------------
+void CompressColumnBlocks(std::vector<ColumnBlock>& blocks)
+{
+  // Columns are compressed independently, each thread takes the next column that is not compressed yet
+  std::atomic<size_t> nextBlockIndex(0);
+  auto compressBlocks = [&blocks, &nextBlockIndex]()
+    {
+    for (size_t blockIndex = nextBlockIndex++; blockIndex < blocks.size(); blockIndex = nextBlockIndex++)
+      {
+      CompressColumnBlock(blocks[blockIndex]);
+      }
+    };
+  size_t numberOfThreads = std::min(static_cast<size_t>(std::max(1u, std::thread::hardware_concurrency())), blocks.size());
+  std::vector<std::thread> threads;
+  for (size_t threadIndex = 1; threadIndex < numberOfThreads; ++threadIndex)
+    {
+    threads.emplace_back(compressBlocks);
+    }
+  compressBlocks();
+  for (std::thread& thread : threads)
+    {
+    thread.join();
+    }
+}
+
+//----------------------------------------------------------------------------
+void WriteUInt64(std::ostream& stream, vtkTypeUInt64 value)
+{
+  vtkByteSwap::SwapLE(&value);
+  stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+//----------------------------------------------------------------------------
+vtkTypeUInt64 ReadUInt64(std::istream& stream)
+{
+  vtkTypeUInt64 value = 0;
+  stream.read(reinterpret_cast<char*>(&value), sizeof(value));
+  vtkByteSwap::SwapLE(&value);
+  return value;
+}
+
+//----------------------------------------------------------------------------
+bool WriteColumnBlocks(const std::string& fileName, std::vector<ColumnBlock>& blocks)
+{
+  vtksys::ofstream file(fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!file)
+    {
+    return false;
+    }
+
+  // Preamble is filled in when the location of the header is known
+  std::vector<char> padding(MEMORY_MAPPING_ALIGNMENT, 0);
+  file.write(padding.data(), PREAMBLE_SIZE);
+  vtkTypeUInt64 position = PREAMBLE_SIZE;
+
+  for (ColumnBlock& block : blocks)
+    {
+    bool compressed = !block.CompressedData.empty();
+    const char* data = compressed ? reinterpret_cast<const char*>(block.CompressedData.data()) : block.RawData;
+    block.StoredSize = compressed ? block.CompressedData.size() : block.RawSize;
+    vtkTypeUInt64 alignment = (!compressed && IsMemoryMappable(block)) ? MEMORY_MAPPING_ALIGNMENT : DATA_ALIGNMENT;
+    vtkTypeUInt64 paddingSize = (alignment - position % alignment) % alignment;
+    file.write(padding.data(), paddingSize);
+    position += paddingSize;
+    block.Offset = position;
+    if (block.StoredSize > 0)
+      {
+      file.write(data, block.StoredSize);
+      }
+    position += block.StoredSize;
+    }
+
+  std::stringstream header;
+#ifdef VTK_WORDS_BIGENDIAN
+  header << "byteOrder\tbig\n";
+#else
+  header << "byteOrder\tlittle\n";
+#endif
+  for (const ColumnBlock& block : blocks)
+    {
+    header << "column"
+      << "\t" << block.Section
+      << "\t" << EscapeHeaderField(block.Name)
+      << "\t" << vtkMRMLTableNode::GetValueTypeAsString(block.ValueType)
+      << "\t" << block.NumberOfComponents
+      << "\t" << block.NumberOfTuples
+      << "\t" << EscapeHeaderField(block.ComponentNames)
+      << "\t" << block.Encoding
+      << "\t" << block.Offset
+      << "\t" << block.StoredSize
+      << "\t" << block.RawSize
+      << "\n";
+    }
+  std::string headerStr = header.str();
+  file.write(headerStr.c_str(), headerStr.size());
+
+  file.seekp(0);
+  file.write(FILE_TYPE_ID, FILE_TYPE_ID_SIZE);
+  WriteUInt64(file, position);
+  WriteUInt64(file, headerStr.size());
+  file.flush();
+  return file.good();
+}
+
+//----------------------------------------------------------------------------
+bool ReadColumnBlocks(vtksys::ifstream& file, std::vector<ColumnBlock>& blocks, bool& swapBytes)
+{
+  char fileTypeId[FILE_TYPE_ID_SIZE] = { 0 };
+  file.read(fileTypeId, FILE_TYPE_ID_SIZE);
+  if (!file || strncmp(fileTypeId, FILE_TYPE_ID, FILE_TYPE_ID_SIZE) != 0)
+    {
+    return false;
+    }
+  vtkTypeUInt64 headerOffset = ReadUInt64(file);
+  vtkTypeUInt64 headerSize = ReadUInt64(file);
+  if (!file)
+    {
+    return false;
+    }
+  std::string headerStr(headerSize, '\0');
+  file.seekg(headerOffset);
+  file.read(&headerStr[0], headerSize);
+  if (!file)
+    {
+    return false;
+    }
+
+#ifdef VTK_WORDS_BIGENDIAN
+  const std::string byteOrder = "big";
+#else
+  const std::string byteOrder = "little";
+#endif
+  swapBytes = false;
+  std::stringstream header(headerStr);
+  std::string line;
+  while (std::getline(header, line))
+    {
+    std::vector<std::string> fields = SplitHeaderLine(line);
+    if (fields[0] == "byteOrder" && fields.size() == 2)
+      {
+      swapBytes = (fields[1] != byteOrder);
+      }
+    else if (fields[0] == "column" && fields.size() == 11)
+      {
+      ColumnBlock block;
+      block.Section = fields[1];
+      block.Name = UnescapeHeaderField(fields[2]);
+      block.ValueType = vtkMRMLTableNode::GetValueTypeFromString(fields[3]);
+      block.NumberOfComponents = vtkVariant(fields[4]).ToInt();
+      block.NumberOfTuples = vtkVariant(fields[5]).ToTypeInt64();
+      block.ComponentNames = UnescapeHeaderField(fields[6]);
+      block.Encoding = fields[7];
+      block.Offset = vtkVariant(fields[8]).ToTypeUInt64();
+      block.StoredSize = vtkVariant(fields[9]).ToTypeUInt64();
+      block.RawSize = vtkVariant(fields[10]).ToTypeUInt64();
+      blocks.push_back(block);
+      }
+    // unknown lines are ignored, to allow adding more information in the future
+    }
+  return true;
+}
+
+#ifdef MRML_TABLE_MEMORY_MAPPING_SUPPORTED
+//----------------------------------------------------------------------------
+// Size of mapped regions, needed for unmapping and for finding mapped columns.
+// Never deleted, as arrays may be released during static destruction.
+std::mutex* MappedColumnsMutex = new std::mutex;
+std::map<void*, size_t>* MappedColumnSizes = new std::map<void*, size_t>;
+
+//----------------------------------------------------------------------------
+void UnmapColumn(void* data)
+{
+  size_t size = 0;
+    {
+    std::lock_guard<std::mutex> lock(*MappedColumnsMutex);
+    std::map<void*, size_t>::iterator mappedColumnIt = MappedColumnSizes->find(data);
+    if (mappedColumnIt == MappedColumnSizes->end())
+      {
+      return;
+      }
+    size = mappedColumnIt->second;
+    MappedColumnSizes->erase(mappedColumnIt);
+    }
+#ifdef _WIN32
+  UnmapViewOfFile(data);
+#else
+  munmap(data, size);
+#endif
+}
+
+#ifdef _WIN32
+//----------------------------------------------------------------------------
+// Get size of a mapped region. Returns 0 if the memory is not mapped from a file.
+size_t GetMappedColumnSize(void* data)
+{
+  std::lock_guard<std::mutex> lock(*MappedColumnsMutex);
+  std::map<void*, size_t>::iterator mappedColumnIt = MappedColumnSizes->find(data);
+  return (mappedColumnIt != MappedColumnSizes->end() ? mappedColumnIt->second : 0);
+}
+
+//----------------------------------------------------------------------------
+// Replace memory-mapped data of the table columns by a copy in memory.
+void CopyMappedColumnsToMemory(vtkTable* table)
+{
+  if (!table)
+    {
+    return;
+    }
+  for (vtkIdType col = 0; col < table->GetNumberOfColumns(); ++col)
+    {
+    vtkDataArray* dataArray = vtkDataArray::SafeDownCast(table->GetColumn(col));
+    if (!dataArray || dataArray->GetNumberOfValues() == 0)
+      {
+      continue;
+      }
+    void* mappedData = dataArray->GetVoidPointer(0);
+    size_t size = GetMappedColumnSize(mappedData);
+    if (size == 0)
+      {
+      continue;
+      }
+    void* data = malloc(size);
+    if (!data)
+      {
+      continue;
+      }
+    memcpy(data, mappedData, size);
+    // The mapped region is released by the free function of the array
+    dataArray->SetVoidArray(data, dataArray->GetNumberOfValues(), 0, vtkAbstractArray::VTK_DATA_ARRAY_FREE);
+    dataArray->DataChanged();
+    }
+}
+#endif
+
+//----------------------------------------------------------------------------
+// Map a region of a file into memory (copy-on-write). Returns nullptr on failure.
+void* MapColumn(const std::string& fileName, vtkTypeUInt64 offset, size_t size)
+{
+#ifdef _WIN32
+  std::wstring fileNameW = vtksys::Encoding::ToWide(fileName);
+  HANDLE fileHandle = CreateFileW(fileNameW.c_str(), GENERIC_READ, FILE_SHARE_READ,
+    nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+    return nullptr;
+    }
+  void* data = nullptr;
+  HANDLE mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+  if (mappingHandle)
+    {
+    // The view keeps the mapping alive
+    data = MapViewOfFile(mappingHandle, FILE_MAP_COPY,
+      static_cast<DWORD>(offset >> 32), static_cast<DWORD>(offset & 0xFFFFFFFF), size);
+    CloseHandle(mappingHandle);
+    }
+  CloseHandle(fileHandle);
+  if (!data)
+    {
+    return nullptr;
+    }
+#else
+  int fileDescriptor = open(fileName.c_str(), O_RDONLY);
+  if (fileDescriptor < 0)
+    {
+    return nullptr;
+    }
+  // The mapping remains valid after the file is closed
+  void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileDescriptor, static_cast<off_t>(offset));
+  close(fileDescriptor);
+  if (data == MAP_FAILED)
+    {
+    return nullptr;
+    }
+#endif
+  std::lock_guard<std::mutex> lock(*MappedColumnsMutex);
+  (*MappedColumnSizes)[data] = size;
+  return data;
+}
+#endif
+
+//----------------------------------------------------------------------------
+// Read (and uncompress) data block of a column into the provided buffer of RawSize bytes
+bool ReadColumnData(vtksys::ifstream& file, const ColumnBlock& block, char* buffer)
+{
+  if (block.RawSize == 0)
+    {
+    return true;
+    }
+  file.seekg(block.Offset);
+  if (block.Encoding == ENCODING_RAW)
+    {
+    if (block.StoredSize != block.RawSize)
+      {
+      return false;
+      }
+    file.read(buffer, block.RawSize);
+    return !file.fail();
+    }
+  else if (block.Encoding == ENCODING_ZLIB)
+    {
+    std::vector<unsigned char> compressedData(block.StoredSize);
+    file.read(reinterpret_cast<char*>(compressedData.data()), block.StoredSize);
+    if (file.fail())
+      {
+      return false;
+      }
+    vtkNew<vtkZLibDataCompressor> compressor;
+    size_t uncompressedSize = compressor->Uncompress(compressedData.data(), block.StoredSize,
+      reinterpret_cast<unsigned char*>(buffer), block.RawSize);
+    return uncompressedSize == block.RawSize;
+    }
+  // unknown encoding
+  return false;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+vtkMRMLTableBinaryStorageNode::vtkMRMLTableBinaryStorageNode()
+{
+  this->DefaultWriteFileExtension = "mtbl";
+  // Uncompressed columns can be memory-mapped, which makes loading of large tables much faster
+  this->UseCompression = 0;
+  this->UseMemoryMapping = true;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLTableBinaryStorageNode::~vtkMRMLTableBinaryStorageNode()
+= default;
+
+//----------------------------------------------------------------------------
+void vtkMRMLTableBinaryStorageNode::PrintSelf(ostream& os, vtkIndent indent)
+{
+  Superclass::PrintSelf(os,indent);
+
+  vtkMRMLPrintBeginMacro(os, indent);
+  vtkMRMLPrintBooleanMacro(UseMemoryMapping);
+  vtkMRMLPrintStdStringVectorMacro(ColumnNamesToRead, std::vector);
+  vtkMRMLPrintEndMacro();
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLTableBinaryStorageNode::CanReadInReferenceNode(vtkMRMLNode *refNode)
+{
+  return refNode->IsA("vtkMRMLTableNode");
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLTableBinaryStorageNode::CanPrefetchData(vtkMRMLNode *refNode)
+{
+  return this->CanReadInReferenceNode(refNode);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTableBinaryStorageNode::SetColumnNamesToRead(const std::vector<std::string>& columnNames)
+{
+  if (this->ColumnNamesToRead == columnNames)
+    {
+    return;
+    }
+  this->ColumnNamesToRead = columnNames;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+const std::vector<std::string>& vtkMRMLTableBinaryStorageNode::GetColumnNamesToRead()
+{
+  return this->ColumnNamesToRead;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLTableBinaryStorageNode::GetColumnNamesInFile(const std::string& fileName, std::vector<std::string>& columnNames)
+{
+  columnNames.clear();
+  vtksys::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+  std::vector<ColumnBlock> blocks;
+  bool swapBytes = false;
+  if (!file || !ReadColumnBlocks(file, blocks, swapBytes))
+    {
+    vtkErrorMacro("GetColumnNamesInFile: failed to read table header from file: " << fileName);
+    return false;
+    }
+  for (const ColumnBlock& block : blocks)
+    {
+    if (block.Section == SECTION_TABLE)
+      {
+      columnNames.push_back(block.Name);
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLTableBinaryStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
+{
+  std::string fullName = this->GetFullNameFromFileName();
+
+  if (fullName.empty())
+    {
+    vtkErrorMacro("ReadData: File name not specified");
+    return 0;
+    }
+  vtkMRMLTableNode *tableNode = vtkMRMLTableNode::SafeDownCast(refNode);
+  if (tableNode == nullptr)
+    {
+    vtkErrorMacro("ReadData: unable to cast input node " << refNode->GetID() << " to a table node");
+    return 0;
+    }
+
+  // Check that the file exists
+  if (vtksys::SystemTools::FileExists(fullName) == false)
+    {
+    vtkErrorMacro("ReadData: table file '" << fullName << "' not found.");
+    return 0;
+    }
+
+  vtksys::ifstream file(fullName.c_str(), std::ios::in | std::ios::binary);
+  std::vector<ColumnBlock> blocks;
+  bool swapBytes = false;
+  if (!file || !ReadColumnBlocks(file, blocks, swapBytes))
+    {
+    vtkErrorMacro("ReadData: failed to read table header from file: " << fullName);
+    return 0;
+    }
+
+  vtkNew<vtkTable> table;
+  vtkNew<vtkTable> schema;
+  for (const ColumnBlock& block : blocks)
+    {
+    if (block.Section == SECTION_TABLE && !this->ColumnNamesToRead.empty()
+      && std::find(this->ColumnNamesToRead.begin(), this->ColumnNamesToRead.end(), block.Name) == this->ColumnNamesToRead.end())
+      {
+      // column is not requested
+      continue;
+      }
+    vtkTable* targetTable = (block.Section == SECTION_SCHEMA ? schema.GetPointer() : table.GetPointer());
+    vtkIdType numberOfValues = block.NumberOfTuples * block.NumberOfComponents;
+
+    if (block.ValueType == VTK_STRING)
+      {
+      size_t offsetsSize = (numberOfValues + 1) * sizeof(vtkTypeUInt64);
+      std::vector<char> data(block.RawSize);
+      if (block.RawSize < offsetsSize || !ReadColumnData(file, block, data.data()))
+        {
+        vtkErrorMacro("ReadData: failed to read column '" << block.Name << "' from file: " << fullName);
+        return 0;
+        }
+      vtkTypeUInt64* offsets = reinterpret_cast<vtkTypeUInt64*>(data.data());
+      if (swapBytes)
+        {
+        vtkByteSwap::SwapVoidRange(offsets, numberOfValues + 1, sizeof(vtkTypeUInt64));
+        }
+      const char* characters = data.data() + offsetsSize;
+      vtkTypeUInt64 charactersSize = block.RawSize - offsetsSize;
+      vtkNew<vtkStringArray> stringArray;
+      stringArray->SetName(block.Name.c_str());
+      stringArray->SetNumberOfComponents(block.NumberOfComponents);
+      stringArray->SetNumberOfTuples(block.NumberOfTuples);
+      for (vtkIdType valueIndex = 0; valueIndex < numberOfValues; ++valueIndex)
+        {
+        vtkTypeUInt64 start = std::min(offsets[valueIndex], charactersSize);
+        vtkTypeUInt64 end = std::min(std::max(offsets[valueIndex + 1], start), charactersSize);
+        stringArray->SetValue(valueIndex, vtkStdString(characters + start, end - start));
+        }
+      targetTable->AddColumn(stringArray);
+      continue;
+      }
+
+    vtkSmartPointer<vtkDataArray> dataArray = vtkSmartPointer<vtkDataArray>::Take(vtkDataArray::CreateDataArray(block.ValueType));
+    if (!dataArray)
+      {
+      vtkErrorMacro("ReadData: unsupported type of column '" << block.Name << "' in file: " << fullName);
+      return 0;
+      }
+    dataArray->SetName(block.Name.c_str());
+    dataArray->SetNumberOfComponents(block.NumberOfComponents);
+    vtkTypeUInt64 expectedSize = (block.ValueType == VTK_BIT ? (numberOfValues + 7) / 8
+      : static_cast<vtkTypeUInt64>(numberOfValues) * dataArray->GetDataTypeSize());
+    if (block.RawSize != expectedSize)
+      {
+      vtkErrorMacro("ReadData: invalid size of column '" << block.Name << "' in file: " << fullName);
+      return 0;
+      }
+
+    bool mapped = false;
+#ifdef MRML_TABLE_MEMORY_MAPPING_SUPPORTED
+    if (this->UseMemoryMapping && !swapBytes && block.Encoding == ENCODING_RAW
+      && IsMemoryMappable(block) && block.Offset % MEMORY_MAPPING_ALIGNMENT == 0)
+      {
+      void* data = MapColumn(fullName, block.Offset, block.RawSize);
+      if (data)
+        {
+        dataArray->SetVoidArray(data, numberOfValues, 0);
+        dataArray->SetArrayFreeFunction(UnmapColumn);
+        mapped = true;
+        }
+      }
+#endif
+    if (!mapped)
+      {
+      dataArray->SetNumberOfTuples(block.NumberOfTuples);
+      if (!ReadColumnData(file, block, numberOfValues > 0 ? static_cast<char*>(dataArray->GetVoidPointer(0)) : nullptr))
+        {
+        vtkErrorMacro("ReadData: failed to read column '" << block.Name << "' from file: " << fullName);
+        return 0;
+        }
+      if (swapBytes && block.ValueType != VTK_BIT)
+        {
+        vtkByteSwap::SwapVoidRange(dataArray->GetVoidPointer(0), numberOfValues, dataArray->GetDataTypeSize());
+        }
+      }
+
+    std::vector<std::string> componentNames = vtkMRMLTableNode::GetComponentNamesFromString(block.ComponentNames);
+    for (int componentIndex = 0; componentIndex < static_cast<int>(componentNames.size())
+      && componentIndex < block.NumberOfComponents; ++componentIndex)
+      {
+      dataArray->SetComponentName(componentIndex, componentNames[componentIndex].c_str());
+      }
+    targetTable->AddColumn(dataArray);
+    }
+
+  if (this->PrefetchInBackground)
+    {
+    // Observers of the table node are not thread-safe, the tables are set in the node
+    // in ApplyPrefetchedData, in the main thread.
+    this->PrefetchedTable = table.GetPointer();
+    this->PrefetchedSchema = (schema->GetNumberOfColumns() > 0 ? schema.GetPointer() : nullptr);
+    return 1;
+    }
+  if (schema->GetNumberOfColumns() > 0)
+    {
+    tableNode->SetAndObserveSchema(schema);
+    }
+  tableNode->SetAndObserveTable(table);
+
+  vtkDebugMacro("ReadData: successfully read table from file: " << fullName);
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLTableBinaryStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
+{
+  if (this->GetFileName() == nullptr)
+    {
+    vtkErrorMacro("WriteData: file name is not set");
+    return 0;
+    }
+  std::string fullName = this->GetFullNameFromFileName();
+  if (fullName.empty())
+    {
+    vtkErrorMacro("WriteData: file name not specified");
+    return 0;
+    }
+
+  vtkMRMLTableNode *tableNode = vtkMRMLTableNode::SafeDownCast(refNode);
+  if (tableNode == nullptr)
+    {
+    vtkErrorMacro("WriteData: unable to cast input node " << refNode->GetID() << " to a valid table node");
+    return 0;
+    }
+  vtkTable* table = tableNode->GetTable();
+  if (!table)
+    {
+    vtkErrorMacro("WriteData: no table to write for the node " << refNode->GetID());
+    return 0;
+    }
+
+  std::vector<ColumnBlock> blocks;
+  for (vtkIdType col = 0; col < table->GetNumberOfColumns(); ++col)
+    {
+    vtkAbstractArray* column = table->GetColumn(col);
+    if (!column)
+      {
+      continue;
+      }
+    blocks.emplace_back();
+    PrepareColumnBlock(column, SECTION_TABLE, blocks.back());
+    }
+  vtkTable* schema = tableNode->GetSchema();
+  if (schema)
+    {
+    for (vtkIdType col = 0; col < schema->GetNumberOfColumns(); ++col)
+      {
+      vtkAbstractArray* column = schema->GetColumn(col);
+      if (!column)
+        {
+        continue;
+        }
+      blocks.emplace_back();
+      PrepareColumnBlock(column, SECTION_SCHEMA, blocks.back());
+      }
+    }
+
+  if (this->GetUseCompression())
+    {
+    CompressColumnBlocks(blocks);
+    }
+
+  // Columns of the table may be memory-mapped from the file that is being overwritten,
+  // therefore write into a temporary file and replace the original file when completed.
+  std::string temporaryFileName = fullName + ".tmp";
+  if (!WriteColumnBlocks(temporaryFileName, blocks))
+    {
+    vtksys::SystemTools::RemoveFile(temporaryFileName);
+    vtkErrorMacro("WriteData: failed to write table node " << refNode->GetID() << " to file " << temporaryFileName);
+    return 0;
+    }
+#if defined(_WIN32) && defined(MRML_TABLE_MEMORY_MAPPING_SUPPORTED)
+  // A file cannot be replaced on Windows while any part of it is mapped into memory.
+  // Columns of this table node may be mapped from the file, copy them into memory and unmap them.
+  CopyMappedColumnsToMemory(table);
+#endif
+  if (!vtksys::SystemTools::RenameFile(temporaryFileName.c_str(), fullName.c_str()))
+    {
+    vtksys::SystemTools::RemoveFile(temporaryFileName);
+    vtkErrorMacro("WriteData: failed to replace file " << fullName << ", it may be in use");
+    return 0;
+    }
+
+  vtkDebugMacro("WriteData: successfully wrote table to file: " << fullName);
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTableBinaryStorageNode::ApplyPrefetchedData(vtkMRMLNode* refNode, vtkMRMLNode* prefetchedNode)
+{
+  vtkMRMLTableNode* tableNode = vtkMRMLTableNode::SafeDownCast(refNode);
+  vtkMRMLTableBinaryStorageNode* prefetchStorageNode = vtkMRMLTableBinaryStorageNode::SafeDownCast(this->PrefetchStorageNode);
+  if (!tableNode || !prefetchStorageNode || !prefetchStorageNode->PrefetchedTable)
+    {
+    Superclass::ApplyPrefetchedData(refNode, prefetchedNode);
+    return;
+    }
+  // Only the table and schema are read from file
+  if (prefetchStorageNode->PrefetchedSchema)
+    {
+    tableNode->SetAndObserveSchema(prefetchStorageNode->PrefetchedSchema);
+    }
+  tableNode->SetAndObserveTable(prefetchStorageNode->PrefetchedTable);
+  prefetchStorageNode->PrefetchedTable = nullptr;
+  prefetchStorageNode->PrefetchedSchema = nullptr;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTableBinaryStorageNode::InitializeSupportedReadFileTypes()
+{
+  this->SupportedReadFileTypes->InsertNextValue("Columnar binary table (.mtbl)");
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTableBinaryStorageNode::InitializeSupportedWriteFileTypes()
+{
+  this->SupportedWriteFileTypes->InsertNextValue("Columnar binary table (.mtbl)");
+}
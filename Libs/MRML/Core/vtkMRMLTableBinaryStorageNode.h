@@ -0,0 +1,114 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkMRMLTableBinaryStorageNode_h
+#define __vtkMRMLTableBinaryStorageNode_h
+
+#include "vtkMRMLStorageNode.h"
+
+// VTK includes
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <string>
+#include <vector>
+
+class vtkMRMLTableNode;
+class vtkTable;
+
+/// \brief MRML node for handling Table node storage in a columnar binary file.
+///
+/// Each column is stored as a contiguous typed array, therefore large tables can be
+/// saved and loaded without converting values to and from text. The file starts with
+/// a fixed-size preamble (file type identifier and location of the header), followed by
+/// the data blocks of the columns, and a text header that lists the columns (name, value type,
+/// number of components and tuples, component names, location of the data block).
+/// The table schema (column properties) is stored in the same file, as a separate set of columns.
+///
+/// If UseCompression is enabled then each column is compressed separately (zlib),
+/// columns that do not become smaller are stored uncompressed. Compression is disabled by default.
+///
+/// Large uncompressed numeric columns are aligned in the file so that they can be memory-mapped
+/// when the file is read (see UseMemoryMapping). Memory-mapped columns are not read into memory
+/// when the file is loaded, but their content is loaded when it is accessed. Mapping is copy-on-write,
+/// modifying the table does not change the file.
+///
+/// If ColumnNamesToRead is specified then only the listed columns are read.
+/// Note that if the table is then written, only the columns that were read are written.
+class VTK_MRML_EXPORT vtkMRMLTableBinaryStorageNode : public vtkMRMLStorageNode
+{
+public:
+  static vtkMRMLTableBinaryStorageNode *New();
+  vtkTypeMacro(vtkMRMLTableBinaryStorageNode,vtkMRMLStorageNode);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  vtkMRMLNode* CreateNodeInstance() override;
+
+  /// Get node XML tag name (like Storage, Model)
+  const char* GetNodeTagName() override {return "TableBinaryStorage";}
+
+  /// Return true if the node can be read in
+  bool CanReadInReferenceNode(vtkMRMLNode *refNode) override;
+
+  /// Files can be read in a background thread when a scene is loaded.
+  bool CanPrefetchData(vtkMRMLNode* refNode) override;
+
+  /// If enabled then large uncompressed numeric columns are memory-mapped when read
+  /// instead of reading them into memory. Default is on.
+  vtkSetMacro(UseMemoryMapping, bool);
+  vtkGetMacro(UseMemoryMapping, bool);
+  vtkBooleanMacro(UseMemoryMapping, bool);
+
+  /// Names of columns that are read from the file. If empty (default) then all columns are read.
+  void SetColumnNamesToRead(const std::vector<std::string>& columnNames);
+  const std::vector<std::string>& GetColumnNamesToRead();
+
+  /// Get names of all columns stored in a file. Only the header of the file is read.
+  /// Returns false if the file cannot be read.
+  bool GetColumnNamesInFile(const std::string& fileName, std::vector<std::string>& columnNames);
+
+protected:
+  vtkMRMLTableBinaryStorageNode();
+  ~vtkMRMLTableBinaryStorageNode() override;
+  vtkMRMLTableBinaryStorageNode(const vtkMRMLTableBinaryStorageNode&);
+  void operator=(const vtkMRMLTableBinaryStorageNode&);
+
+  /// Initialize all the supported write file types
+  void InitializeSupportedReadFileTypes() override;
+
+  /// Initialize all the supported write file types
+  void InitializeSupportedWriteFileTypes() override;
+
+  /// Read data and set it in the referenced node. Returns 0 on failure.
+  int ReadDataInternal(vtkMRMLNode *refNode) override;
+
+  /// Write data from a  referenced node. Returns 0 on failure.
+  int WriteDataInternal(vtkMRMLNode *refNode) override;
+
+  /// Set the prefetched table in the referenced node without copying it
+  /// (copying would read all memory-mapped columns into memory).
+  void ApplyPrefetchedData(vtkMRMLNode* refNode, vtkMRMLNode* prefetchedNode) override;
+
+  bool UseMemoryMapping;
+  std::vector<std::string> ColumnNamesToRead;
+
+  /// Tables read in a background thread, set in the table node by ApplyPrefetchedData
+  vtkSmartPointer<vtkTable> PrefetchedTable;
+  vtkSmartPointer<vtkTable> PrefetchedSchema;
+};
+
+#endif
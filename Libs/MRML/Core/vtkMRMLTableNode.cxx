@@ -23,6 +23,7 @@
 // MRML includes
 #include "vtkMRMLScene.h"
 #include "vtkMRMLTableNode.h"
+#include "vtkMRMLTableBinaryStorageNode.h"
 #include "vtkMRMLTableStorageNode.h"
 
 // VTK includes
@@ -251,6 +252,22 @@ vtkMRMLStorageNode* vtkMRMLTableNode::CreateDefaultStorageNode()
     scene->CreateNodeByClass("vtkMRMLTableStorageNode"));
 }
 
+//---------------------------------------------------------------------------
+std::string vtkMRMLTableNode::GetDefaultStorageNodeClassName(const char* filename /* =nullptr */)
+{
+  if (!filename)
+    {
+    return "vtkMRMLTableStorageNode";
+    }
+  // Appropriate storage node depends on the file extension.
+  vtkNew<vtkMRMLTableBinaryStorageNode> binaryStorageNode;
+  if (binaryStorageNode->SupportedFileType(filename))
+    {
+    return "vtkMRMLTableBinaryStorageNode";
+    }
+  return "vtkMRMLTableStorageNode";
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLTableNode::SetAndObserveTable(vtkTable* table)
 {
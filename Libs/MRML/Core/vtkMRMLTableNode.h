@@ -121,6 +121,12 @@ public:
   /// Create default storage node or nullptr if does not have one
   vtkMRMLStorageNode* CreateDefaultStorageNode() override;
 
+  ///
+  /// Get the storage node class that is used for writing the specified file.
+  /// Columnar binary files (.mtbl) are written by vtkMRMLTableBinaryStorageNode,
+  /// all other formats by vtkMRMLTableStorageNode.
+  std::string GetDefaultStorageNodeClassName(const char* filename /* =nullptr */) override;
+
   ///
   /// Add an array to the table as a new column.
   /// If no column is provided then an empty column is added.
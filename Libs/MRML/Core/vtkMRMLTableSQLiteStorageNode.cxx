@@ -37,6 +37,7 @@
 #include <vtkSQLiteDatabase.h>
 #include <vtkSQLiteQuery.h>
 #include <vtkSmartPointer.h>
+#include <vtkVariant.h>
 
 #include <vtksys/SystemTools.hxx>
 
@@ -181,9 +182,19 @@ int vtkMRMLTableSQLiteStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
   createTableQuery += this->TableName;
   createTableQuery += "(";
 
-  std::string insertPreamble = "INSERT into ";
-  insertPreamble += this->TableName;
-  insertPreamble += "(";
+  std::string insertQuery = "INSERT into ";
+  insertQuery += this->TableName;
+  insertQuery += "(";
+  std::string insertValues = ") VALUES (";
+
+  // SQL type of each column, used for binding values
+  enum
+    {
+    ColumnTypeText,
+    ColumnTypeReal,
+    ColumnTypeInteger
+    };
+  std::vector<int> columnTypes;
 
   //get the columns from the vtkTable to finish the query
   vtkIdType numColumns = table->GetNumberOfColumns();
@@ -192,7 +203,8 @@ int vtkMRMLTableSQLiteStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
     //get this column's name
     std::string columnName = table->GetColumn(i)->GetName();
     createTableQuery += columnName;
-    insertPreamble += "'" + columnName + "'";
+    insertQuery += "'" + columnName + "'";
+    insertValues += "?";
 
     //figure out what type of data is stored in this column
     std::string columnType = table->GetColumn(i)->GetClassName();
@@ -202,25 +214,34 @@ int vtkMRMLTableSQLiteStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
         (columnType.find("Variant") != std::string::npos) )
       {
       createTableQuery += " TEXT";
+      columnTypes.push_back(ColumnTypeText);
       }
     else if( (columnType.find("Double") != std::string::npos) ||
              (columnType.find("Float") != std::string::npos) )
       {
       createTableQuery += " REAL";
+      columnTypes.push_back(ColumnTypeReal);
       }
     else
       {
       createTableQuery += " INTEGER";
+      columnTypes.push_back(ColumnTypeInteger);
+      }
+    if (table->GetColumn(i)->GetNumberOfComponents() > 1)
+      {
+      // multi-component values are stored as text
+      columnTypes.back() = ColumnTypeText;
       }
     if(i == numColumns - 1)
       {
       createTableQuery += ");";
-      insertPreamble += ") VALUES (";
+      insertQuery += insertValues + ");";
       }
     else
       {
       createTableQuery += ", ";
-      insertPreamble += ", ";
+      insertQuery += ", ";
+      insertValues += ", ";
       }
     }
 
@@ -229,39 +250,68 @@ int vtkMRMLTableSQLiteStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
     static_cast<vtkSQLiteQuery*>(database->GetQueryInstance());
 
   query->SetQuery(createTableQuery.c_str());
-  cout << "creating the table" << endl;
   if(!query->Execute())
     {
     vtkErrorMacro(<<"Error performing 'create table' query");
     }
 
-  //iterate over the rows of the vtkTable to complete the insert query
+  // Insert all rows in a single transaction, using one prepared statement.
+  // Committing each row separately would make writing of large tables very slow.
+  bool success = true;
+  if (!query->BeginTransaction())
+    {
+    vtkErrorMacro(<<"Error starting transaction");
+    success = false;
+    }
+  if (success && !query->SetQuery(insertQuery.c_str()))
+    {
+    vtkErrorMacro(<<"Error preparing 'insert' query");
+    success = false;
+    }
   vtkIdType numRows = table->GetNumberOfRows();
-  for(vtkIdType i = 0; i < numRows; i++)
+  for(vtkIdType i = 0; success && i < numRows; i++)
     {
-    std::string insertQuery = insertPreamble;
     for (vtkIdType j = 0; j < numColumns; j++)
       {
-      insertQuery += "'" + table->GetValue(i, j).ToString() + "'";
-      if(j < numColumns - 1)
+      vtkVariant value = table->GetValue(i, j);
+      int parameterIndex = static_cast<int>(j);
+      switch (columnTypes[j])
         {
-        insertQuery += ", ";
+        case ColumnTypeReal: query->BindParameter(parameterIndex, value.ToDouble()); break;
+        case ColumnTypeInteger: query->BindParameter(parameterIndex, value.ToLongLong()); break;
+        default: query->BindParameter(parameterIndex, value.ToString()); break;
         }
       }
-    insertQuery += ");";
     //perform the insert query for this row
-    query->SetQuery(insertQuery.c_str());
     if(!query->Execute())
       {
       vtkErrorMacro(<<"Error performing 'insert' query");
+      success = false;
       }
     }
+  if (success)
+    {
+    if (!query->CommitTransaction())
+      {
+      vtkErrorMacro(<<"Error committing transaction");
+      success = false;
+      }
+    }
+  else
+    {
+    query->RollbackTransaction();
+    }
 
   //cleanup and return
   query->Delete();
   database->Close();
   database->Delete();
 
+  if (!success)
+    {
+    vtkErrorMacro("WriteData: failed to write table to database: " << fullName);
+    return 0;
+    }
   vtkDebugMacro("WriteData: successfully wrote table to database: " << fullName);
   return 1;
 }
@@ -21,6 +21,7 @@
 ==============================================================================*/
 
 // MRML includes
+#include "vtkMRMLTableBinaryStorageNode.h"
 #include "vtkMRMLTableStorageNode.h"
 #include "vtkMRMLTableNode.h"
 #include "vtkMRMLScene.h"
@@ -41,6 +42,16 @@ vtkMRMLNodeNewMacro(vtkMRMLTableStorageNode);
 
 const char* COMPONENT_SEPERATOR = "_";
 
+namespace
+{
+//----------------------------------------------------------------------------
+// Tables in .mtbl files are read and written by vtkMRMLTableBinaryStorageNode
+bool IsBinaryTableFileName(const std::string& fileName)
+{
+  return vtkMRMLStorageNode::GetLowercaseExtensionFromFileName(fileName) == ".mtbl";
+}
+} // end of anonymous namespace
+
 //----------------------------------------------------------------------------
 vtkMRMLTableStorageNode::vtkMRMLTableStorageNode()
 {
@@ -88,6 +99,13 @@ int vtkMRMLTableStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     return 0;
     }
 
+  if (IsBinaryTableFileName(fullName))
+    {
+    vtkNew<vtkMRMLTableBinaryStorageNode> binaryStorageNode;
+    binaryStorageNode->SetFileName(fullName.c_str());
+    return binaryStorageNode->ReadData(tableNode);
+    }
+
   if (this->GetSchemaFileName().empty() && this->AutoFindSchema)
     {
     this->SetSchemaFileName(this->FindSchemaFileName(fullName.c_str()).c_str());
@@ -133,6 +151,15 @@ int vtkMRMLTableStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
     return 0;
     }
 
+  if (IsBinaryTableFileName(fullName))
+    {
+    // Schema is stored in the same file
+    this->ResetFileNameList();
+    vtkNew<vtkMRMLTableBinaryStorageNode> binaryStorageNode;
+    binaryStorageNode->SetFileName(fullName.c_str());
+    return binaryStorageNode->WriteData(tableNode);
+    }
+
   if (!this->WriteTable(fullName, tableNode))
     {
     vtkErrorMacro("WriteData: failed to write table node " << refNode->GetID() << " to file " << fullName);
@@ -183,6 +210,7 @@ void vtkMRMLTableStorageNode::InitializeSupportedReadFileTypes()
   this->SupportedReadFileTypes->InsertNextValue("Tab-separated values (.tsv)");
   this->SupportedReadFileTypes->InsertNextValue("Comma-separated values (.csv)");
   this->SupportedReadFileTypes->InsertNextValue("Text (.txt)");
+  this->SupportedReadFileTypes->InsertNextValue("Columnar binary table (.mtbl)");
 }
 
 //----------------------------------------------------------------------------
@@ -191,6 +219,7 @@ void vtkMRMLTableStorageNode::InitializeSupportedWriteFileTypes()
   this->SupportedWriteFileTypes->InsertNextValue("Tab-separated values (.tsv)");
   this->SupportedWriteFileTypes->InsertNextValue("Comma-separated values (.csv)");
   this->SupportedWriteFileTypes->InsertNextValue("Text (.txt)");
+  this->SupportedWriteFileTypes->InsertNextValue("Columnar binary table (.mtbl)");
 }
 
 //----------------------------------------------------------------------------
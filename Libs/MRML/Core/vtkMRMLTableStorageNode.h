@@ -41,6 +41,10 @@ class vtkTable;
 /// Values in comma-separated files may not contain quotation marks but may contain
 /// any other characters (including commas and tabs).
 ///
+/// If the file extension is .mtbl then the table is read and written using
+/// vtkMRMLTableBinaryStorageNode (columnar binary file, schema is stored in the same file).
+/// This allows choosing the binary format when the table is saved.
+///
 class VTK_MRML_EXPORT vtkMRMLTableStorageNode : public vtkMRMLStorageNode
 {
 public:
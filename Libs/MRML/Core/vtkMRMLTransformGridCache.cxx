@@ -0,0 +1,752 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLTransformableNode.h"
+#include "vtkMRMLTransformGridCache.h"
+#include "vtkMRMLTransformNode.h"
+
+// VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkGeneralTransform.h>
+#include <vtkGridTransform.h>
+#include <vtkImageData.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkSmartPointer.h>
+#include <vtkWeakPointer.h>
+
+// STD includes
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+struct GridKey
+{
+  vtkMTimeType TransformMTime = 0;
+  vtkMTimeType SettingsMTime = 0;
+  unsigned long Generation = 0;
+
+  bool operator==(const GridKey& other) const
+    {
+    return this->TransformMTime == other.TransformMTime
+      && this->SettingsMTime == other.SettingsMTime
+      && this->Generation == other.Generation;
+    }
+  bool operator!=(const GridKey& other) const
+    {
+    return !(*this == other);
+    }
+};
+
+//----------------------------------------------------------------------------
+struct GridSettings
+{
+  double Bounds[6];
+  double GridSpacing;
+  double MaximumError;
+  vtkIdType MaximumNumberOfGridPoints;
+};
+
+//----------------------------------------------------------------------------
+struct GridResult
+{
+  vtkSmartPointer<vtkGridTransform> Grid;
+  double Error = -1.0;
+  bool Accurate = false;
+};
+
+//----------------------------------------------------------------------------
+vtkIdType GetGridDimensions(const double bounds[6], double spacing, int dimensions[3])
+{
+  vtkIdType numberOfPoints = 1;
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    double size = bounds[axis * 2 + 1] - bounds[axis * 2];
+    dimensions[axis] = std::max(2, static_cast<int>(std::ceil(size / spacing)) + 1);
+    numberOfPoints *= dimensions[axis];
+    }
+  return numberOfPoints;
+}
+
+//----------------------------------------------------------------------------
+// Sample the displacements of the transform at the grid points.
+// Returns false if cancelled.
+bool FillDisplacementGrid(vtkAbstractTransform* transform, vtkImageData* grid, const std::atomic<bool>& cancelRequested)
+{
+  int* dimensions = grid->GetDimensions();
+  double* origin = grid->GetOrigin();
+  double* spacing = grid->GetSpacing();
+  float* displacement = static_cast<float*>(grid->GetScalarPointer());
+  double point[3] = { 0.0, 0.0, 0.0 };
+  double transformedPoint[3] = { 0.0, 0.0, 0.0 };
+  for (int k = 0; k < dimensions[2]; ++k)
+    {
+    point[2] = origin[2] + k * spacing[2];
+    for (int j = 0; j < dimensions[1]; ++j)
+      {
+      if (cancelRequested)
+        {
+        return false;
+        }
+      point[1] = origin[1] + j * spacing[1];
+      for (int i = 0; i < dimensions[0]; ++i)
+        {
+        point[0] = origin[0] + i * spacing[0];
+        transform->TransformPoint(point, transformedPoint);
+        *(displacement++) = static_cast<float>(transformedPoint[0] - point[0]);
+        *(displacement++) = static_cast<float>(transformedPoint[1] - point[1]);
+        *(displacement++) = static_cast<float>(transformedPoint[2] - point[2]);
+        }
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Compute the largest distance between exact and interpolated transformed positions
+// at cell centers (where interpolation error is usually the largest).
+// Returns a negative value if cancelled.
+double GetInterpolationError(vtkAbstractTransform* transform, vtkGridTransform* gridTransform,
+  vtkImageData* grid, const std::atomic<bool>& cancelRequested)
+{
+  // Limit the number of evaluated cells to keep error estimation fast
+  const double maximumNumberOfSamples = 20000.0;
+  int* dimensions = grid->GetDimensions();
+  double* origin = grid->GetOrigin();
+  double* spacing = grid->GetSpacing();
+  double numberOfCells = double(dimensions[0] - 1) * double(dimensions[1] - 1) * double(dimensions[2] - 1);
+  int stride = std::max(1, static_cast<int>(std::ceil(std::cbrt(numberOfCells / maximumNumberOfSamples))));
+  double maximumSquaredError = 0.0;
+  double point[3] = { 0.0, 0.0, 0.0 };
+  double exactPoint[3] = { 0.0, 0.0, 0.0 };
+  double gridPoint[3] = { 0.0, 0.0, 0.0 };
+  for (int k = 0; k < dimensions[2] - 1; k += stride)
+    {
+    if (cancelRequested)
+      {
+      return -1.0;
+      }
+    point[2] = origin[2] + (k + 0.5) * spacing[2];
+    for (int j = 0; j < dimensions[1] - 1; j += stride)
+      {
+      point[1] = origin[1] + (j + 0.5) * spacing[1];
+      for (int i = 0; i < dimensions[0] - 1; i += stride)
+        {
+        point[0] = origin[0] + (i + 0.5) * spacing[0];
+        transform->TransformPoint(point, exactPoint);
+        gridTransform->TransformPoint(point, gridPoint);
+        maximumSquaredError = std::max(maximumSquaredError, vtkMath::Distance2BetweenPoints(exactPoint, gridPoint));
+        }
+      }
+    }
+  return std::sqrt(maximumSquaredError);
+}
+
+//----------------------------------------------------------------------------
+// Resample the transform into a displacement grid. Grid spacing is halved until
+// the grid approximates the transform within the maximum error or the grid would
+// contain too many points. Returns false if cancelled.
+bool ComputeGridTransform(vtkAbstractTransform* transform, const GridSettings& settings,
+  const std::atomic<bool>& cancelRequested, GridResult& result)
+{
+  result = GridResult();
+  const double* bounds = settings.Bounds;
+  if (bounds[0] > bounds[1] || bounds[2] > bounds[3] || bounds[4] > bounds[5])
+    {
+    // invalid bounds, the transform cannot be approximated
+    return true;
+    }
+
+  double spacing = (settings.GridSpacing > 0.0 ? settings.GridSpacing : 1.0);
+  int dimensions[3] = { 0, 0, 0 };
+  while (GetGridDimensions(bounds, spacing, dimensions) > settings.MaximumNumberOfGridPoints)
+    {
+    spacing *= 1.25;
+    if (dimensions[0] == 2 && dimensions[1] == 2 && dimensions[2] == 2)
+      {
+      // grid cannot be made smaller
+      break;
+      }
+    }
+
+  while (true)
+    {
+    vtkNew<vtkImageData> grid;
+    grid->SetDimensions(dimensions);
+    grid->SetOrigin(bounds[0], bounds[2], bounds[4]);
+    grid->SetSpacing(spacing, spacing, spacing);
+    grid->AllocateScalars(VTK_FLOAT, 3);
+    if (!FillDisplacementGrid(transform, grid.GetPointer(), cancelRequested))
+      {
+      return false;
+      }
+    vtkSmartPointer<vtkGridTransform> gridTransform = vtkSmartPointer<vtkGridTransform>::New();
+    gridTransform->SetDisplacementGridData(grid.GetPointer());
+    gridTransform->SetInterpolationModeToLinear();
+    double error = GetInterpolationError(transform, gridTransform, grid.GetPointer(), cancelRequested);
+    if (error < 0.0)
+      {
+      return false;
+      }
+    result.Grid = gridTransform;
+    result.Error = error;
+    result.Accurate = (error <= settings.MaximumError);
+    if (result.Accurate)
+      {
+      return true;
+      }
+    int finerDimensions[3] = { 0, 0, 0 };
+    if (GetGridDimensions(bounds, spacing / 2.0, finerDimensions) > settings.MaximumNumberOfGridPoints)
+      {
+      // required accuracy cannot be reached
+      return true;
+      }
+    spacing /= 2.0;
+    std::copy(finerDimensions, finerDimensions + 3, dimensions);
+    }
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+/// Transform that evaluates the grid of a vtkMRMLTransformGridCache if it is up-to-date
+/// and the exact transform otherwise. Its modification time changes when the cache
+/// switches between the two, so that pipelines that use it re-execute.
+class vtkMRMLTransformGridCacheProxyTransform : public vtkAbstractTransform
+{
+public:
+  static vtkMRMLTransformGridCacheProxyTransform* New();
+  vtkTypeMacro(vtkMRMLTransformGridCacheProxyTransform, vtkAbstractTransform);
+
+  void SetCache(vtkMRMLTransformGridCache* cache)
+    {
+    this->Cache = cache;
+    this->Modified();
+    }
+
+  void Inverse() override
+    {
+    this->Inverted = !this->Inverted;
+    this->Modified();
+    }
+
+  vtkAbstractTransform* MakeTransform() override
+    {
+    return vtkMRMLTransformGridCacheProxyTransform::New();
+    }
+
+  vtkMTimeType GetMTime() override
+    {
+    vtkMTimeType mtime = this->Superclass::GetMTime();
+    if (this->Cache)
+      {
+      mtime = std::max(mtime, this->Cache->GetSelectedTransformMTime());
+      }
+    return mtime;
+    }
+
+  void InternalTransformPoint(const float in[3], float out[3]) override
+    {
+    if (!this->CurrentTransform)
+      {
+      std::copy(in, in + 3, out);
+      return;
+      }
+    this->CurrentTransform->InternalTransformPoint(in, out);
+    }
+  void InternalTransformPoint(const double in[3], double out[3]) override
+    {
+    if (!this->CurrentTransform)
+      {
+      std::copy(in, in + 3, out);
+      return;
+      }
+    this->CurrentTransform->InternalTransformPoint(in, out);
+    }
+
+  void InternalTransformDerivative(const float in[3], float out[3], float derivative[3][3]) override
+    {
+    if (!this->CurrentTransform)
+      {
+      std::copy(in, in + 3, out);
+      vtkMath::Identity3x3(derivative);
+      return;
+      }
+    this->CurrentTransform->InternalTransformDerivative(in, out, derivative);
+    }
+  void InternalTransformDerivative(const double in[3], double out[3], double derivative[3][3]) override
+    {
+    if (!this->CurrentTransform)
+      {
+      std::copy(in, in + 3, out);
+      vtkMath::Identity3x3(derivative);
+      return;
+      }
+    this->CurrentTransform->InternalTransformDerivative(in, out, derivative);
+    }
+
+protected:
+  vtkMRMLTransformGridCacheProxyTransform() = default;
+  ~vtkMRMLTransformGridCacheProxyTransform() override = default;
+
+  void InternalDeepCopy(vtkAbstractTransform* transform) override
+    {
+    vtkMRMLTransformGridCacheProxyTransform* proxyTransform = static_cast<vtkMRMLTransformGridCacheProxyTransform*>(transform);
+    this->Cache = proxyTransform->Cache;
+    this->Inverted = proxyTransform->Inverted;
+    }
+
+  /// The evaluated transform is only changed here, as it is called from the thread
+  /// that updates the pipeline (before points are transformed).
+  void InternalUpdate() override
+    {
+    this->CurrentTransform = nullptr;
+    if (!this->Cache)
+      {
+      return;
+      }
+    vtkAbstractTransform* transform = this->Cache->GetTransform();
+    if (this->Inverted)
+      {
+      transform = transform->GetInverse();
+      }
+    transform->Update();
+    this->CurrentTransform = transform;
+    }
+
+  vtkWeakPointer<vtkMRMLTransformGridCache> Cache;
+  bool Inverted{false};
+  /// Grid or exact transform of the cache, referenced so that it remains valid
+  /// until the next update even if the cache replaces it.
+  vtkSmartPointer<vtkAbstractTransform> CurrentTransform;
+
+private:
+  vtkMRMLTransformGridCacheProxyTransform(const vtkMRMLTransformGridCacheProxyTransform&) = delete;
+  void operator=(const vtkMRMLTransformGridCacheProxyTransform&) = delete;
+};
+
+vtkStandardNewMacro(vtkMRMLTransformGridCacheProxyTransform);
+
+//----------------------------------------------------------------------------
+class vtkMRMLTransformGridCache::vtkInternal
+{
+public:
+  vtkInternal();
+  ~vtkInternal();
+
+  /// Get key for the current transform and settings
+  GridKey GetKey(vtkMRMLTransformGridCache* self);
+
+  /// Update ExactTransform from the transform node if needed
+  void UpdateExactTransform(vtkMRMLTransformGridCache* self, const GridKey& key);
+
+  /// Use result of background computation if it is available
+  void RetrievePendingResult();
+
+  void GetSettings(vtkMRMLTransformGridCache* self, GridSettings& settings);
+
+  /// Request computation of the grid in the worker thread.
+  /// The computation that is in progress is cancelled.
+  void StartComputation(vtkMRMLTransformGridCache* self, const GridKey& key);
+  void CancelComputation();
+
+  /// Compute the requested grids until the worker is stopped
+  void WorkerLoop();
+  void StopWorker();
+
+  vtkWeakPointer<vtkMRMLTransformNode> TransformNode;
+  unsigned long TransformNodeObserverTag;
+  vtkNew<vtkCallbackCommand> CallbackCommand;
+  unsigned long Generation;
+
+  vtkNew<vtkGeneralTransform> ExactTransform;
+  GridKey ExactTransformKey;
+
+  GridResult Result;
+  GridKey ResultKey;
+  bool ResultAvailable;
+
+  vtkNew<vtkMRMLTransformGridCacheProxyTransform> ProxyTransform;
+  // Transform returned by the last GetTransform() call and the time it was selected
+  vtkAbstractTransform* SelectedTransform;
+  vtkTimeStamp SelectedTransformTime;
+
+  // Background computation.
+  // The worker thread is started at the first request and it is reused for all subsequent requests.
+  struct GridRequest
+    {
+    vtkSmartPointer<vtkGeneralTransform> Transform;
+    GridSettings Settings;
+    GridKey Key;
+    };
+  std::thread Worker;
+  GridKey WorkerKey; // key of the most recent request (only accessed from the main thread)
+  bool WorkerKeyValid;
+  std::mutex Mutex;
+  std::condition_variable Condition;
+  GridRequest Request;
+  bool RequestAvailable;
+  bool StopWorkerRequested;
+  // Cancels the request that is being computed. Only set while Mutex is locked,
+  // and reset by the worker when it takes the next request.
+  std::atomic<bool> CancelRequested;
+  GridResult PendingResult;
+  GridKey PendingResultKey;
+  bool PendingResultAvailable;
+};
+
+//----------------------------------------------------------------------------
+vtkMRMLTransformGridCache::vtkInternal::vtkInternal()
+  : TransformNodeObserverTag(0)
+  , Generation(0)
+  , ResultAvailable(false)
+  , SelectedTransform(nullptr)
+  , WorkerKeyValid(false)
+  , RequestAvailable(false)
+  , StopWorkerRequested(false)
+  , CancelRequested(false)
+  , PendingResultAvailable(false)
+{
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLTransformGridCache::vtkInternal::~vtkInternal()
+{
+  this->StopWorker();
+}
+
+//----------------------------------------------------------------------------
+GridKey vtkMRMLTransformGridCache::vtkInternal::GetKey(vtkMRMLTransformGridCache* self)
+{
+  GridKey key;
+  key.TransformMTime = (this->TransformNode ? this->TransformNode->GetTransformToWorldMTime() : 0);
+  key.SettingsMTime = self->GetMTime();
+  key.Generation = this->Generation;
+  return key;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTransformGridCache::vtkInternal::UpdateExactTransform(vtkMRMLTransformGridCache* self, const GridKey& key)
+{
+  if (this->ExactTransformKey == key)
+    {
+    return;
+    }
+  this->ExactTransform->Identity();
+  if (this->TransformNode)
+    {
+    if (self->TransformFromWorld)
+      {
+      this->TransformNode->GetTransformFromWorld(this->ExactTransform.GetPointer());
+      }
+    else
+      {
+      this->TransformNode->GetTransformToWorld(this->ExactTransform.GetPointer());
+      }
+    }
+  this->ExactTransformKey = key;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTransformGridCache::vtkInternal::RetrievePendingResult()
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  if (!this->PendingResultAvailable)
+    {
+    return;
+    }
+  this->Result = this->PendingResult;
+  this->ResultKey = this->PendingResultKey;
+  this->ResultAvailable = true;
+  this->PendingResult = GridResult();
+  this->PendingResultAvailable = false;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTransformGridCache::vtkInternal::GetSettings(vtkMRMLTransformGridCache* self, GridSettings& settings)
+{
+  std::copy(self->Bounds, self->Bounds + 6, settings.Bounds);
+  settings.GridSpacing = self->GridSpacing;
+  settings.MaximumError = self->MaximumError;
+  settings.MaximumNumberOfGridPoints = self->MaximumNumberOfGridPoints;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTransformGridCache::vtkInternal::StartComputation(vtkMRMLTransformGridCache* self, const GridKey& key)
+{
+  this->CancelComputation();
+
+  // The worker evaluates its own copy of the transform, as the transform node
+  // may be modified while the grid is computed.
+  vtkSmartPointer<vtkGeneralTransform> transformCopy = vtkSmartPointer<vtkGeneralTransform>::New();
+  if (!vtkMRMLTransformNode::DeepCopyTransform(transformCopy, this->ExactTransform.GetPointer()))
+    {
+    return;
+    }
+  GridRequest request;
+  request.Transform = transformCopy;
+  this->GetSettings(self, request.Settings);
+  request.Key = key;
+
+  this->WorkerKey = key;
+  this->WorkerKeyValid = true;
+    {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->Request = request;
+    this->RequestAvailable = true;
+    }
+  this->Condition.notify_one();
+  if (!this->Worker.joinable())
+    {
+    this->Worker = std::thread(&vtkInternal::WorkerLoop, this);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTransformGridCache::vtkInternal::CancelComputation()
+{
+  this->WorkerKey = GridKey();
+  this->WorkerKeyValid = false;
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  this->CancelRequested = true;
+  this->Request = GridRequest();
+  this->RequestAvailable = false;
+  this->PendingResult = GridResult();
+  this->PendingResultAvailable = false;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTransformGridCache::vtkInternal::WorkerLoop()
+{
+  while (true)
+    {
+    GridRequest request;
+      {
+      std::unique_lock<std::mutex> lock(this->Mutex);
+      this->Condition.wait(lock, [this]
+        { return this->StopWorkerRequested || this->RequestAvailable; });
+      if (this->StopWorkerRequested)
+        {
+        return;
+        }
+      request = this->Request;
+      this->Request = GridRequest();
+      this->RequestAvailable = false;
+      this->CancelRequested = false;
+      }
+    GridResult result;
+    if (!ComputeGridTransform(request.Transform, request.Settings, this->CancelRequested, result))
+      {
+      continue;
+      }
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    if (this->CancelRequested)
+      {
+      // a newer request is waiting or the computation is no longer needed
+      continue;
+      }
+    this->PendingResult = result;
+    this->PendingResultKey = request.Key;
+    this->PendingResultAvailable = true;
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTransformGridCache::vtkInternal::StopWorker()
+{
+  if (!this->Worker.joinable())
+    {
+    return;
+    }
+    {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->StopWorkerRequested = true;
+    this->CancelRequested = true;
+    }
+  this->Condition.notify_all();
+  this->Worker.join();
+}
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkMRMLTransformGridCache);
+
+//----------------------------------------------------------------------------
+vtkMRMLTransformGridCache::vtkMRMLTransformGridCache()
+{
+  this->TransformFromWorld = false;
+  this->Bounds[0] = this->Bounds[2] = this->Bounds[4] = 0.0;
+  this->Bounds[1] = this->Bounds[3] = this->Bounds[5] = -1.0;
+  this->GridSpacing = 2.0;
+  this->MaximumError = 0.5;
+  this->MaximumNumberOfGridPoints = 4000000;
+  this->BackgroundComputation = true;
+  this->Internal = new vtkInternal;
+  this->Internal->ProxyTransform->SetCache(this);
+  this->Internal->CallbackCommand->SetClientData(this);
+  this->Internal->CallbackCommand->SetCallback(vtkMRMLTransformGridCache::TransformModifiedCallback);
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLTransformGridCache::~vtkMRMLTransformGridCache()
+{
+  this->SetTransformNode(nullptr);
+  delete this->Internal;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTransformGridCache::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "TransformNode: " << (this->Internal->TransformNode ? this->Internal->TransformNode->GetID() : "(none)") << "\n";
+  os << indent << "TransformFromWorld: " << this->TransformFromWorld << "\n";
+  os << indent << "Bounds: " << this->Bounds[0] << ", " << this->Bounds[1] << ", " << this->Bounds[2]
+    << ", " << this->Bounds[3] << ", " << this->Bounds[4] << ", " << this->Bounds[5] << "\n";
+  os << indent << "GridSpacing: " << this->GridSpacing << "\n";
+  os << indent << "MaximumError: " << this->MaximumError << "\n";
+  os << indent << "MaximumNumberOfGridPoints: " << this->MaximumNumberOfGridPoints << "\n";
+  os << indent << "BackgroundComputation: " << this->BackgroundComputation << "\n";
+  os << indent << "GridError: " << this->GetGridError() << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTransformGridCache::SetTransformNode(vtkMRMLTransformNode* transformNode)
+{
+  if (this->Internal->TransformNode == transformNode)
+    {
+    return;
+    }
+  if (this->Internal->TransformNode)
+    {
+    this->Internal->TransformNode->RemoveObserver(this->Internal->TransformNodeObserverTag);
+    this->Internal->TransformNodeObserverTag = 0;
+    }
+  this->Internal->TransformNode = transformNode;
+  if (transformNode)
+    {
+    // High priority, so that the grid is invalidated before other observers request the transform
+    this->Internal->TransformNodeObserverTag = transformNode->AddObserver(
+      vtkMRMLTransformableNode::TransformModifiedEvent, this->Internal->CallbackCommand.GetPointer(), 10.0);
+    }
+  this->Invalidate();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLTransformNode* vtkMRMLTransformGridCache::GetTransformNode()
+{
+  return this->Internal->TransformNode;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTransformGridCache::TransformModifiedCallback(vtkObject* vtkNotUsed(caller),
+  unsigned long vtkNotUsed(eid), void* clientData, void* vtkNotUsed(callData))
+{
+  vtkMRMLTransformGridCache* self = reinterpret_cast<vtkMRMLTransformGridCache*>(clientData);
+  self->Invalidate();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTransformGridCache::Invalidate()
+{
+  this->Internal->CancelComputation();
+  this->Internal->Result = GridResult();
+  this->Internal->ResultAvailable = false;
+  // Transform may be changed without changing its modification time (e.g., parent transform node is replaced)
+  this->Internal->Generation++;
+}
+
+//----------------------------------------------------------------------------
+vtkAbstractTransform* vtkMRMLTransformGridCache::GetTransform()
+{
+  GridKey key = this->Internal->GetKey(this);
+  this->Internal->UpdateExactTransform(this, key);
+  this->Internal->RetrievePendingResult();
+  if (!this->Internal->ResultAvailable || this->Internal->ResultKey != key)
+    {
+    if (this->BackgroundComputation)
+      {
+      if (!this->Internal->WorkerKeyValid || this->Internal->WorkerKey != key)
+        {
+        this->Internal->StartComputation(this, key);
+        }
+      }
+    else
+      {
+      this->ComputeGrid();
+      }
+    }
+  vtkAbstractTransform* transform = this->Internal->ExactTransform.GetPointer();
+  if (this->IsGridUpToDate())
+    {
+    transform = this->Internal->Result.Grid;
+    }
+  if (transform != this->Internal->SelectedTransform)
+    {
+    this->Internal->SelectedTransform = transform;
+    this->Internal->SelectedTransformTime.Modified();
+    }
+  return transform;
+}
+
+//----------------------------------------------------------------------------
+vtkAbstractTransform* vtkMRMLTransformGridCache::GetProxyTransform()
+{
+  // Start computation of the grid
+  this->GetTransform();
+  return this->Internal->ProxyTransform.GetPointer();
+}
+
+//----------------------------------------------------------------------------
+vtkMTimeType vtkMRMLTransformGridCache::GetSelectedTransformMTime()
+{
+  vtkAbstractTransform* transform = this->GetTransform();
+  return std::max(this->Internal->SelectedTransformTime.GetMTime(), transform->GetMTime());
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLTransformGridCache::ComputeGrid()
+{
+  this->Internal->CancelComputation();
+  GridKey key = this->Internal->GetKey(this);
+  this->Internal->UpdateExactTransform(this, key);
+  GridSettings settings;
+  this->Internal->GetSettings(this, settings);
+  std::atomic<bool> cancelRequested(false);
+  this->Internal->ExactTransform->Update();
+  ComputeGridTransform(this->Internal->ExactTransform.GetPointer(), settings, cancelRequested, this->Internal->Result);
+  this->Internal->ResultKey = key;
+  this->Internal->ResultAvailable = true;
+  return this->Internal->Result.Accurate;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLTransformGridCache::IsGridUpToDate()
+{
+  this->Internal->RetrievePendingResult();
+  return this->Internal->ResultAvailable
+    && this->Internal->ResultKey == this->Internal->GetKey(this)
+    && this->Internal->Result.Grid != nullptr
+    && this->Internal->Result.Accurate;
+}
+
+//----------------------------------------------------------------------------
+double vtkMRMLTransformGridCache::GetGridError()
+{
+  this->Internal->RetrievePendingResult();
+  return this->Internal->ResultAvailable ? this->Internal->Result.Error : -1.0;
+}
@@ -0,0 +1,129 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+#ifndef __vtkMRMLTransformGridCache_h
+#define __vtkMRMLTransformGridCache_h
+
+// MRML includes
+#include "vtkMRML.h"
+
+// VTK includes
+#include <vtkObject.h>
+
+class vtkAbstractTransform;
+class vtkMRMLTransformNode;
+
+/// \brief Approximates the transform chain of a transform node with a single displacement grid.
+///
+/// Evaluating a chain of non-linear transforms (and especially inverse of non-linear transforms,
+/// which are computed by iterative inversion) at each point is slow. This class resamples
+/// the transform to world (or from world) of a transform node into a single grid transform
+/// within the specified Bounds, which can be evaluated by simple interpolation.
+///
+/// The grid is computed in a background thread, on a copy of the transform. The same thread
+/// is reused for all computations of the cache. Until the grid is available, or if the grid
+/// cannot approximate the transform within MaximumError with at most MaximumNumberOfGridPoints
+/// grid points, GetTransform() returns the exact transform.
+/// The grid is discarded when the transform node is modified (TransformModifiedEvent).
+class VTK_MRML_EXPORT vtkMRMLTransformGridCache : public vtkObject
+{
+public:
+  static vtkMRMLTransformGridCache *New();
+  vtkTypeMacro(vtkMRMLTransformGridCache, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /// Transform node that is approximated. The transform is observed but not referenced.
+  void SetTransformNode(vtkMRMLTransformNode* transformNode);
+  vtkMRMLTransformNode* GetTransformNode();
+
+  /// If enabled then transform from world is approximated, otherwise transform to world.
+  /// Default is off.
+  vtkSetMacro(TransformFromWorld, bool);
+  vtkGetMacro(TransformFromWorld, bool);
+  vtkBooleanMacro(TransformFromWorld, bool);
+
+  /// Region where the transform is approximated, in the input coordinate system of the transform
+  /// (world coordinate system if TransformFromWorld is enabled).
+  vtkSetVector6Macro(Bounds, double);
+  vtkGetVector6Macro(Bounds, double);
+
+  /// Initial distance between grid points. Default is 2.0.
+  /// Distance is halved until the error becomes smaller than MaximumError.
+  vtkSetMacro(GridSpacing, double);
+  vtkGetMacro(GridSpacing, double);
+
+  /// Largest acceptable distance between exact and approximated transformed position,
+  /// measured at the center of grid cells. Default is 0.5.
+  vtkSetMacro(MaximumError, double);
+  vtkGetMacro(MaximumError, double);
+
+  /// Maximum number of grid points. Spacing is increased if needed to fit this limit.
+  /// Default is 4000000 (approximately 48MB memory).
+  vtkSetMacro(MaximumNumberOfGridPoints, vtkIdType);
+  vtkGetMacro(MaximumNumberOfGridPoints, vtkIdType);
+
+  /// If enabled (default) then the grid is computed in a background thread.
+  /// If disabled then the grid is computed in GetTransform().
+  vtkSetMacro(BackgroundComputation, bool);
+  vtkGetMacro(BackgroundComputation, bool);
+  vtkBooleanMacro(BackgroundComputation, bool);
+
+  /// Get the grid transform if it is up-to-date and accurate, otherwise the exact transform.
+  /// If the grid is not up-to-date then its computation is started.
+  /// The returned transform is owned by this object and it is only valid until the next call.
+  vtkAbstractTransform* GetTransform();
+
+  /// Get a transform that evaluates the transform returned by GetTransform() at its last update.
+  /// It can be concatenated into a pipeline once: when the grid becomes available, the modification
+  /// time of this transform changes and the pipeline uses the grid at its next update, without
+  /// getting the transform again. The returned transform is owned by this object.
+  vtkAbstractTransform* GetProxyTransform();
+
+  /// Compute the grid in the current thread. Returns true if the grid approximates the transform
+  /// within MaximumError.
+  bool ComputeGrid();
+
+  /// Returns true if the grid is computed for the current transform and settings
+  /// and it approximates the transform within MaximumError.
+  bool IsGridUpToDate();
+
+  /// Largest error measured for the most recently computed grid.
+  /// Returns -1 if no grid has been computed.
+  double GetGridError();
+
+  /// Discard the grid and cancel its computation.
+  void Invalidate();
+
+protected:
+  vtkMRMLTransformGridCache();
+  ~vtkMRMLTransformGridCache() override;
+
+  static void TransformModifiedCallback(vtkObject* caller, unsigned long eid, void* clientData, void* callData);
+
+  /// Modification time of the transform returned by GetTransform().
+  /// Changes when GetTransform() switches between the exact and the grid transform.
+  vtkMTimeType GetSelectedTransformMTime();
+  friend class vtkMRMLTransformGridCacheProxyTransform;
+
+  bool TransformFromWorld;
+  double Bounds[6];
+  double GridSpacing;
+  double MaximumError;
+  vtkIdType MaximumNumberOfGridPoints;
+  bool BackgroundComputation;
+
+  class vtkInternal;
+  vtkInternal* Internal;
+
+private:
+  vtkMRMLTransformGridCache(const vtkMRMLTransformGridCache&) = delete;
+  void operator=(const vtkMRMLTransformGridCache&) = delete;
+};
+
+#endif
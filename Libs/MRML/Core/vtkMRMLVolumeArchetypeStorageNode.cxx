@@ -37,6 +37,7 @@ Version:   $Revision: 1.6 $
 #include <vtkDataArray.h>
 #include <vtkErrorCode.h>
 #include <vtkImageChangeInformation.h>
+#include <vtkImageData.h>
 #include <vtkNew.h>
 #include <vtkPointData.h>
 #include <vtkSmartPointer.h>
@@ -156,6 +157,18 @@ bool vtkMRMLVolumeArchetypeStorageNode::CanWriteFromReferenceNode(vtkMRMLNode *r
   return refNode->IsA("vtkMRMLScalarVolumeNode");
 }
 
+//----------------------------------------------------------------------------
+bool vtkMRMLVolumeArchetypeStorageNode::CanPrefetchData(vtkMRMLNode *refNode)
+{
+  if (!this->CanReadInReferenceNode(refNode) || !this->GetFileName())
+    {
+    return false;
+    }
+  // DICOM files often have no extension
+  std::string extension = vtkMRMLStorageNode::GetLowercaseExtensionFromFileName(this->GetFileName());
+  return !extension.empty() && extension != ".dcm" && extension != ".ima";
+}
+
 //----------------------------------------------------------------------------
 vtkITKArchetypeImageSeriesReader*
 vtkMRMLVolumeArchetypeStorageNode::InstantiateVectorVolumeReader(const std::string& fullName)
@@ -324,7 +337,7 @@ int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
 
   reader->AddObserver( vtkCommand::ProgressEvent,  this->MRMLCallbackCommand);
 
-  if (volNode->GetImageData())
+  if (volNode->GetImageData() && !this->PrefetchInBackground)
     {
     volNode->SetAndObserveImageData(nullptr);
     }
@@ -462,7 +475,16 @@ int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
 
   vtkNew<vtkImageData> iciOutputCopy;
   iciOutputCopy->ShallowCopy(ici->GetOutput());
-  volNode->SetAndObserveImageData(iciOutputCopy.GetPointer());
+  if (this->PrefetchInBackground)
+    {
+    // Observing the image data is not thread-safe, the image data is set in the node
+    // in ApplyPrefetchedData, in the main thread.
+    this->PrefetchedImageData = iciOutputCopy.GetPointer();
+    }
+  else
+    {
+    volNode->SetAndObserveImageData(iciOutputCopy.GetPointer());
+    }
 
   // Log volume size to the application log. It helps to identify potential out-of-memory issues.
   vtkInfoMacro(<<"Loaded volume from file: "<<fullName \
@@ -486,6 +508,19 @@ int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
   return 1;
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeArchetypeStorageNode::ApplyPrefetchedData(vtkMRMLNode* refNode, vtkMRMLNode* prefetchedNode)
+{
+  Superclass::ApplyPrefetchedData(refNode, prefetchedNode);
+  vtkMRMLVolumeNode* volNode = vtkMRMLVolumeNode::SafeDownCast(refNode);
+  vtkMRMLVolumeArchetypeStorageNode* prefetchStorageNode = vtkMRMLVolumeArchetypeStorageNode::SafeDownCast(this->PrefetchStorageNode);
+  if (volNode && prefetchStorageNode && prefetchStorageNode->PrefetchedImageData)
+    {
+    volNode->SetAndObserveImageData(prefetchStorageNode->PrefetchedImageData);
+    prefetchStorageNode->PrefetchedImageData = nullptr;
+    }
+}
+
 //----------------------------------------------------------------------------
 int vtkMRMLVolumeArchetypeStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
 {
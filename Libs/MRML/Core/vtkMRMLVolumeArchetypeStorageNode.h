@@ -77,6 +77,10 @@ public:
   bool CanReadInReferenceNode(vtkMRMLNode* refNode) override;
   bool CanWriteFromReferenceNode(vtkMRMLNode* refNode) override;
 
+  /// Files can be read in a background thread when a scene is loaded,
+  /// except DICOM files (DICOM readers are not thread-safe).
+  bool CanPrefetchData(vtkMRMLNode* refNode) override;
+
   ///
   /// Configure the storage node for data exchange. This is an
   /// opportunity to optimize the storage node's settings, for
@@ -104,6 +108,10 @@ protected:
   /// Read data and set it in the referenced node
   int ReadDataInternal(vtkMRMLNode *refNode) override;
 
+  /// Set the prefetched image data in the referenced node.
+  /// The image data is set here, in the main thread, because setting it adds observers through vtkEventBroker.
+  void ApplyPrefetchedData(vtkMRMLNode* refNode, vtkMRMLNode* prefetchedNode) override;
+
   /// Write data from a referenced node
   int WriteDataInternal(vtkMRMLNode *refNode) override;
 
@@ -111,6 +119,9 @@ protected:
   int SingleFile;
   int UseOrientationFromFile;
 
+  /// Image data read in a background thread, set in the volume node by ApplyPrefetchedData
+  vtkSmartPointer<vtkImageData> PrefetchedImageData;
+
 };
 
 #endif
@@ -0,0 +1,771 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLSequenceNode.h"
+#include "vtkMRMLVolumeNode.h"
+#include "vtkMRMLVolumeSequenceFrameLoader.h"
+
+// VTK includes
+#include <vtkByteSwap.h>
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkObjectFactory.h>
+#include <vtkWeakPointer.h>
+#include <vtksys/Encoding.hxx>
+#include <vtksys/FStream.hxx>
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <list>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Location and layout of the voxels of a NRRD file
+struct NrrdDataLocation
+{
+  std::string DataFileName;
+  /// Position of the data in the data file (end of the header for attached header)
+  size_t DataOffset{0};
+  long ByteSkip{0};
+  int LineSkip{0};
+  /// Frame index is the fastest varying index (frames are stored along the first axis)
+  bool FramesInterleaved{false};
+};
+
+//----------------------------------------------------------------------------
+bool IsFrameAxisKind(const std::string& kind)
+{
+  return !kind.empty() && kind != "domain" && kind != "space";
+}
+
+//----------------------------------------------------------------------------
+// Get location of the voxels of a NRRD file from its header.
+// Returns false if the voxels are not stored uncompressed in a single file
+// or frames are not stored along the first or last axis.
+bool GetDataLocation(const std::string& fileName, int numberOfFrames, size_t numberOfVoxels,
+  NrrdDataLocation& location)
+{
+  vtksys::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+  std::string line;
+  if (!std::getline(file, line) || line.compare(0, 4, "NRRD") != 0)
+    {
+    return false;
+    }
+  std::string encoding;
+  std::vector<size_t> sizes;
+  std::vector<std::string> kinds;
+  bool headerEndFound = false;
+  while (std::getline(file, line))
+    {
+    if (!line.empty() && line[line.size() - 1] == '\r')
+      {
+      line.erase(line.size() - 1);
+      }
+    if (line.empty())
+      {
+      // Empty line separates header from data
+      headerEndFound = true;
+      break;
+      }
+    if (line[0] == '#')
+      {
+      continue;
+      }
+    size_t separatorPosition = line.find(": ");
+    if (separatorPosition == std::string::npos)
+      {
+      // key/value pair (key:=value), not a field
+      continue;
+      }
+    std::string field = line.substr(0, separatorPosition);
+    std::string value = line.substr(separatorPosition + 2);
+    if (field == "encoding")
+      {
+      encoding = value;
+      }
+    else if (field == "sizes")
+      {
+      std::istringstream sizesStream(value);
+      for (size_t size = 0; sizesStream >> size;)
+        {
+        sizes.push_back(size);
+        }
+      }
+    else if (field == "kinds")
+      {
+      std::istringstream kindsStream(value);
+      for (std::string kind; kindsStream >> kind;)
+        {
+        kinds.push_back(kind);
+        }
+      }
+    else if (field == "byte skip" || field == "byteskip")
+      {
+      location.ByteSkip = atol(value.c_str());
+      }
+    else if (field == "line skip" || field == "lineskip")
+      {
+      location.LineSkip = atoi(value.c_str());
+      }
+    else if (field == "data file" || field == "datafile")
+      {
+      location.DataFileName = value;
+      }
+    }
+
+  if (encoding != "raw")
+    {
+    // Compressed voxels cannot be accessed without decompressing the whole file
+    return false;
+    }
+  if (location.LineSkip != 0 || location.ByteSkip < -1)
+    {
+    return false;
+    }
+
+  if (sizes.size() != 4 || kinds.size() != 4)
+    {
+    return false;
+    }
+  if (sizes[0] == static_cast<size_t>(numberOfFrames) && IsFrameAxisKind(kinds[0]))
+    {
+    location.FramesInterleaved = (numberOfFrames > 1);
+    }
+  else if (sizes[3] == static_cast<size_t>(numberOfFrames) && IsFrameAxisKind(kinds[3]))
+    {
+    location.FramesInterleaved = false;
+    }
+  else
+    {
+    return false;
+    }
+  if (sizes[0] * sizes[1] * sizes[2] * sizes[3] != numberOfVoxels * numberOfFrames)
+    {
+    return false;
+    }
+
+  if (location.DataFileName.empty())
+    {
+    // Attached header, data starts after the empty line
+    if (!headerEndFound)
+      {
+      return false;
+      }
+    location.DataFileName = fileName;
+    location.DataOffset = static_cast<size_t>(file.tellg());
+    return true;
+    }
+  // Detached header, only a single data file is supported
+  if (location.DataFileName.find(' ') != std::string::npos || location.DataFileName.compare(0, 4, "LIST") == 0)
+    {
+    return false;
+    }
+  if (!vtksys::SystemTools::FileIsFullPath(location.DataFileName))
+    {
+    location.DataFileName = vtksys::SystemTools::CollapseFullPath(location.DataFileName,
+      vtksys::SystemTools::GetFilenamePath(fileName));
+    }
+  location.DataOffset = 0;
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+class vtkMRMLVolumeSequenceFrameLoader::vtkInternal
+{
+public:
+  vtkInternal()
+  {
+#ifdef _WIN32
+    this->FileHandle = INVALID_HANDLE_VALUE;
+    this->MappingHandle = nullptr;
+#else
+    this->FileDescriptor = -1;
+#endif
+  }
+
+  struct FrameType
+  {
+    vtkWeakPointer<vtkMRMLVolumeNode> DataNode;
+    int FrameIndex{0};
+  };
+
+  void StartReadAheadThread(vtkMRMLVolumeSequenceFrameLoader* self);
+  void StopReadAheadThread();
+
+  /// Map a file into memory. Returns false if the file is smaller than requiredSize or cannot be mapped.
+  bool MapFile(vtkMRMLVolumeSequenceFrameLoader* self, const std::string& fileName, size_t requiredSize);
+  void UnmapFile();
+
+  /// Get a frame from the cache and mark it as most recently used. Returns nullptr if not cached.
+  /// CacheMutex must be locked.
+  vtkSmartPointer<vtkImageData> GetCachedImage(int frameIndex);
+  /// Add a frame to the cache and remove the least recently used frames if the cache is full.
+  /// CacheMutex must be locked.
+  void AddCachedImage(int frameIndex, vtkImageData* image);
+  /// Remove a frame from the cache. CacheMutex must be locked.
+  void RemoveCachedImage(int frameIndex);
+
+  /// Returns the frame of the data node if it is managed by the loader, nullptr otherwise
+  FrameType* GetFrame(vtkMRMLNode* dataNode);
+
+  // Mapped file
+#ifdef _WIN32
+  HANDLE FileHandle;
+  HANDLE MappingHandle;
+#else
+  int FileDescriptor;
+#endif
+  const char* MappedData{nullptr};
+  size_t MappedSize{0};
+  size_t DataOffset{0};
+
+  // Frame geometry
+  int NumberOfFrames{0};
+  int Extent[6]{0, -1, 0, -1, 0, -1};
+  int ScalarType{VTK_VOID};
+  bool SwapBytes{false};
+  /// Frame index is the fastest varying index in the mapped file
+  bool FramesInterleaved{false};
+
+  /// Data nodes that do not have their voxels loaded yet
+  std::map<vtkMRMLNode*, FrameType> Frames;
+  int LastItemNumber{-1};
+
+  // Frame cache, shared with the read-ahead thread
+  std::mutex CacheMutex;
+  std::map<int, vtkSmartPointer<vtkImageData> > CachedImages;
+  /// Frame indices of cached images, most recently used first
+  std::list<int> CachedFrameIndices;
+  int MaximumNumberOfCachedImages{1};
+
+  // Read-ahead
+  std::thread ReadAheadThread;
+  std::condition_variable ReadAheadCondition;
+  std::deque<int> ReadAheadRequests;
+  bool StopReadAhead{false};
+};
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceFrameLoader::vtkInternal::StartReadAheadThread(vtkMRMLVolumeSequenceFrameLoader* self)
+{
+  if (this->ReadAheadThread.joinable())
+    {
+    return;
+    }
+  this->StopReadAhead = false;
+  this->ReadAheadThread = std::thread([this, self]()
+    {
+    std::unique_lock<std::mutex> lock(this->CacheMutex);
+    while (true)
+      {
+      this->ReadAheadCondition.wait(lock, [this] { return this->StopReadAhead || !this->ReadAheadRequests.empty(); });
+      if (this->StopReadAhead)
+        {
+        return;
+        }
+      int frameIndex = this->ReadAheadRequests.front();
+      this->ReadAheadRequests.pop_front();
+      if (this->CachedImages.find(frameIndex) != this->CachedImages.end())
+        {
+        continue;
+        }
+      lock.unlock();
+      vtkSmartPointer<vtkImageData> image = self->ReadFrame(frameIndex);
+      lock.lock();
+      this->AddCachedImage(frameIndex, image);
+      }
+    });
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceFrameLoader::vtkInternal::StopReadAheadThread()
+{
+  if (!this->ReadAheadThread.joinable())
+    {
+    return;
+    }
+    {
+    std::lock_guard<std::mutex> lock(this->CacheMutex);
+    this->StopReadAhead = true;
+    this->ReadAheadRequests.clear();
+    }
+  this->ReadAheadCondition.notify_all();
+  this->ReadAheadThread.join();
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLVolumeSequenceFrameLoader::vtkInternal::MapFile(vtkMRMLVolumeSequenceFrameLoader* self,
+  const std::string& fileName, size_t requiredSize)
+{
+#ifdef _WIN32
+  std::wstring fileNameW = vtksys::Encoding::ToWide(fileName);
+  this->FileHandle = CreateFileW(fileNameW.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+    nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (this->FileHandle == INVALID_HANDLE_VALUE)
+    {
+    vtkErrorWithObjectMacro(self, "Open: failed to open " << fileName);
+    return false;
+    }
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(this->FileHandle, &fileSize) || static_cast<size_t>(fileSize.QuadPart) < requiredSize)
+    {
+    vtkErrorWithObjectMacro(self, "Open: " << fileName << " is smaller than expected");
+    this->UnmapFile();
+    return false;
+    }
+  this->MappingHandle = CreateFileMappingW(this->FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (this->MappingHandle)
+    {
+    this->MappedData = static_cast<const char*>(MapViewOfFile(this->MappingHandle, FILE_MAP_READ, 0, 0, 0));
+    }
+  this->MappedSize = static_cast<size_t>(fileSize.QuadPart);
+#else
+  this->FileDescriptor = open(fileName.c_str(), O_RDONLY);
+  if (this->FileDescriptor < 0)
+    {
+    vtkErrorWithObjectMacro(self, "Open: failed to open " << fileName);
+    return false;
+    }
+  struct stat fileStatus;
+  if (fstat(this->FileDescriptor, &fileStatus) != 0 || static_cast<size_t>(fileStatus.st_size) < requiredSize)
+    {
+    vtkErrorWithObjectMacro(self, "Open: " << fileName << " is smaller than expected");
+    this->UnmapFile();
+    return false;
+    }
+  this->MappedSize = static_cast<size_t>(fileStatus.st_size);
+  void* mappedData = mmap(nullptr, this->MappedSize, PROT_READ, MAP_SHARED, this->FileDescriptor, 0);
+  if (mappedData != MAP_FAILED)
+    {
+    this->MappedData = static_cast<const char*>(mappedData);
+    }
+#endif
+  if (!this->MappedData)
+    {
+    vtkErrorWithObjectMacro(self, "Open: failed to map " << fileName << " into memory");
+    this->UnmapFile();
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceFrameLoader::vtkInternal::UnmapFile()
+{
+#ifdef _WIN32
+  if (this->MappedData)
+    {
+    UnmapViewOfFile(this->MappedData);
+    }
+  if (this->MappingHandle)
+    {
+    CloseHandle(this->MappingHandle);
+    this->MappingHandle = nullptr;
+    }
+  if (this->FileHandle != INVALID_HANDLE_VALUE)
+    {
+    CloseHandle(this->FileHandle);
+    this->FileHandle = INVALID_HANDLE_VALUE;
+    }
+#else
+  if (this->MappedData)
+    {
+    munmap(const_cast<char*>(this->MappedData), this->MappedSize);
+    }
+  if (this->FileDescriptor >= 0)
+    {
+    close(this->FileDescriptor);
+    this->FileDescriptor = -1;
+    }
+#endif
+  this->MappedData = nullptr;
+  this->MappedSize = 0;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkImageData> vtkMRMLVolumeSequenceFrameLoader::vtkInternal::GetCachedImage(int frameIndex)
+{
+  std::map<int, vtkSmartPointer<vtkImageData> >::iterator imageIt = this->CachedImages.find(frameIndex);
+  if (imageIt == this->CachedImages.end())
+    {
+    return nullptr;
+    }
+  this->CachedFrameIndices.remove(frameIndex);
+  this->CachedFrameIndices.push_front(frameIndex);
+  return imageIt->second;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceFrameLoader::vtkInternal::AddCachedImage(int frameIndex, vtkImageData* image)
+{
+  if (!image)
+    {
+    return;
+    }
+  this->CachedImages[frameIndex] = image;
+  this->CachedFrameIndices.remove(frameIndex);
+  this->CachedFrameIndices.push_front(frameIndex);
+  while (static_cast<int>(this->CachedFrameIndices.size()) > this->MaximumNumberOfCachedImages)
+    {
+    this->CachedImages.erase(this->CachedFrameIndices.back());
+    this->CachedFrameIndices.pop_back();
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceFrameLoader::vtkInternal::RemoveCachedImage(int frameIndex)
+{
+  this->CachedImages.erase(frameIndex);
+  this->CachedFrameIndices.remove(frameIndex);
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLVolumeSequenceFrameLoader::vtkInternal::FrameType* vtkMRMLVolumeSequenceFrameLoader::vtkInternal::GetFrame(
+  vtkMRMLNode* dataNode)
+{
+  std::map<vtkMRMLNode*, FrameType>::iterator frameIt = this->Frames.find(dataNode);
+  if (frameIt == this->Frames.end())
+    {
+    return nullptr;
+    }
+  if (frameIt->second.DataNode.GetPointer() != dataNode)
+    {
+    // data node has been deleted, the address is reused by another node
+    this->Frames.erase(frameIt);
+    return nullptr;
+    }
+  return &frameIt->second;
+}
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkMRMLVolumeSequenceFrameLoader);
+
+//----------------------------------------------------------------------------
+vtkMRMLVolumeSequenceFrameLoader::vtkMRMLVolumeSequenceFrameLoader()
+{
+  this->FrameCacheSize = 8;
+  this->ReadAheadFrames = 2;
+  this->Internal = new vtkInternal;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLVolumeSequenceFrameLoader::~vtkMRMLVolumeSequenceFrameLoader()
+{
+  this->Close();
+  delete this->Internal;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceFrameLoader::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "FrameCacheSize: " << this->FrameCacheSize << "\n";
+  os << indent << "ReadAheadFrames: " << this->ReadAheadFrames << "\n";
+  os << indent << "NumberOfFrames: " << this->Internal->NumberOfFrames << "\n";
+  os << indent << "FramesInterleaved: " << (this->Internal->FramesInterleaved ? "true" : "false") << "\n";
+  os << indent << "NumberOfLoadPendingDataNodes: " << this->Internal->Frames.size() << "\n";
+  os << indent << "NumberOfCachedFrames: " << this->GetNumberOfCachedFrames() << "\n";
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLVolumeSequenceFrameLoader::Open(const std::string& fileName, int numberOfFrames,
+  const int extent[6], int scalarType, bool swapBytes)
+{
+  this->Close();
+
+  size_t numberOfVoxels = static_cast<size_t>(extent[1] - extent[0] + 1)
+    * static_cast<size_t>(extent[3] - extent[2] + 1) * static_cast<size_t>(extent[5] - extent[4] + 1);
+  size_t scalarSize = static_cast<size_t>(vtkDataArray::GetDataTypeSize(scalarType));
+  NrrdDataLocation location;
+  if (numberOfFrames < 1 || numberOfVoxels == 0 || scalarSize == 0
+    || !GetDataLocation(fileName, numberOfFrames, numberOfVoxels, location))
+    {
+    vtkDebugMacro("Open: voxels of " << fileName << " are not stored in a supported layout, cannot be mapped");
+    return false;
+    }
+
+  size_t dataSize = numberOfVoxels * numberOfFrames * scalarSize;
+  size_t dataOffset = location.DataOffset + static_cast<size_t>(std::max(location.ByteSkip, 0L));
+  if (location.ByteSkip == -1)
+    {
+    // Voxels are at the end of the file
+    size_t fileSize = static_cast<size_t>(vtksys::SystemTools::FileLength(location.DataFileName));
+    if (fileSize < dataSize)
+      {
+      vtkErrorMacro("Open: " << location.DataFileName << " is smaller than expected");
+      return false;
+      }
+    dataOffset = fileSize - dataSize;
+    }
+  if (!this->Internal->MapFile(this, location.DataFileName, dataOffset + dataSize))
+    {
+    return false;
+    }
+  this->Internal->DataOffset = dataOffset;
+  this->Internal->NumberOfFrames = numberOfFrames;
+  std::copy(extent, extent + 6, this->Internal->Extent);
+  this->Internal->ScalarType = scalarType;
+  this->Internal->SwapBytes = swapBytes;
+  this->Internal->FramesInterleaved = location.FramesInterleaved;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceFrameLoader::Close()
+{
+  this->Internal->StopReadAheadThread();
+  this->Internal->UnmapFile();
+  this->Internal->CachedImages.clear();
+  this->Internal->CachedFrameIndices.clear();
+  this->Internal->NumberOfFrames = 0;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLVolumeSequenceFrameLoader::IsOpen()
+{
+  return this->Internal->MappedData != nullptr;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkImageData> vtkMRMLVolumeSequenceFrameLoader::ReadFrame(int frameIndex)
+{
+  if (!this->Internal->MappedData || frameIndex < 0 || frameIndex >= this->Internal->NumberOfFrames)
+    {
+    return nullptr;
+    }
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetExtent(this->Internal->Extent);
+  image->AllocateScalars(this->Internal->ScalarType, 1);
+
+  size_t scalarSize = static_cast<size_t>(image->GetScalarSize());
+  size_t numberOfVoxels = static_cast<size_t>(image->GetNumberOfPoints());
+  size_t numberOfFrames = static_cast<size_t>(this->Internal->NumberOfFrames);
+  char* voxels = static_cast<char*>(image->GetScalarPointer());
+  const char* data = this->Internal->MappedData + this->Internal->DataOffset;
+  if (this->Internal->FramesInterleaved)
+    {
+    // Frames are stored along the first axis, voxels of a frame are numberOfFrames scalars apart
+    const char* source = data + frameIndex * scalarSize;
+    size_t sourceStride = scalarSize * numberOfFrames;
+    for (size_t voxelIndex = 0; voxelIndex < numberOfVoxels; ++voxelIndex)
+      {
+      memcpy(voxels + voxelIndex * scalarSize, source, scalarSize);
+      source += sourceStride;
+      }
+    }
+  else
+    {
+    // Frames are stored along the last axis, voxels of a frame are stored contiguously
+    size_t frameSize = scalarSize * numberOfVoxels;
+    memcpy(voxels, data + frameSize * frameIndex, frameSize);
+    }
+  if (this->Internal->SwapBytes && scalarSize > 1)
+    {
+    vtkByteSwap::SwapVoidRange(voxels, static_cast<vtkIdType>(numberOfVoxels), static_cast<int>(scalarSize));
+    }
+  return image;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceFrameLoader::GetFrameExtent(int extent[6])
+{
+  std::copy(this->Internal->Extent, this->Internal->Extent + 6, extent);
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLVolumeSequenceFrameLoader::GetFrameScalarType()
+{
+  return this->Internal->ScalarType;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceFrameLoader::AddDataNode(vtkMRMLVolumeNode* dataNode, int frameIndex)
+{
+  if (!dataNode)
+    {
+    return;
+    }
+  vtkInternal::FrameType& frame = this->Internal->Frames[dataNode];
+  frame.DataNode = dataNode;
+  frame.FrameIndex = frameIndex;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceFrameLoader::RemoveDataNode(vtkMRMLNode* dataNode)
+{
+  this->Internal->Frames.erase(dataNode);
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLVolumeSequenceFrameLoader::IsDataNodeLoadPending(vtkMRMLNode* dataNode)
+{
+  return this->Internal->GetFrame(dataNode) != nullptr;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceFrameLoader::LoadDataNode(vtkMRMLSequenceNode* sequenceNode, int itemNumber)
+{
+  if (!sequenceNode || itemNumber < 0 || itemNumber >= static_cast<int>(sequenceNode->IndexEntries.size()))
+    {
+    return;
+    }
+  vtkMRMLNode* dataNode = sequenceNode->IndexEntries[itemNumber].DataNode;
+  vtkInternal::FrameType* frame = this->Internal->GetFrame(dataNode);
+  if (!frame)
+    {
+    // not managed by this loader or already loaded
+    return;
+    }
+  vtkSmartPointer<vtkImageData> image;
+    {
+    // The data node takes ownership of the voxels, they must not be shared with the cache
+    std::lock_guard<std::mutex> lock(this->Internal->CacheMutex);
+    image = this->Internal->GetCachedImage(frame->FrameIndex);
+    this->Internal->RemoveCachedImage(frame->FrameIndex);
+    }
+  if (!image)
+    {
+    image = this->ReadFrame(frame->FrameIndex);
+    }
+  if (!image)
+    {
+    vtkErrorMacro("LoadDataNode: failed to read frame " << frame->FrameIndex);
+    return;
+    }
+  vtkMRMLVolumeNode* volumeNode = frame->DataNode;
+  this->Internal->Frames.erase(dataNode);
+  volumeNode->SetAndObserveImageData(image);
+  this->ReadAhead(sequenceNode, itemNumber);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceFrameLoader::LoadAllDataNodes()
+{
+  this->Internal->StopReadAheadThread();
+  // Move the list of data nodes, as SetAndObserveImageData may invoke events that access the loader
+  std::map<vtkMRMLNode*, vtkInternal::FrameType> frames;
+  frames.swap(this->Internal->Frames);
+  for (std::map<vtkMRMLNode*, vtkInternal::FrameType>::iterator frameIt = frames.begin(); frameIt != frames.end(); ++frameIt)
+    {
+    vtkInternal::FrameType& frame = frameIt->second;
+    if (!frame.DataNode)
+      {
+      continue;
+      }
+    vtkSmartPointer<vtkImageData> image = this->Internal->GetCachedImage(frame.FrameIndex);
+    if (!image)
+      {
+      image = this->ReadFrame(frame.FrameIndex);
+      }
+    if (image)
+      {
+      frame.DataNode->SetAndObserveImageData(image);
+      }
+    }
+  this->Internal->CachedImages.clear();
+  this->Internal->CachedFrameIndices.clear();
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkImageData> vtkMRMLVolumeSequenceFrameLoader::GetFrameImage(vtkMRMLSequenceNode* sequenceNode, int itemNumber)
+{
+  if (!sequenceNode || itemNumber < 0 || itemNumber >= static_cast<int>(sequenceNode->IndexEntries.size()))
+    {
+    return nullptr;
+    }
+  vtkInternal::FrameType* frame = this->Internal->GetFrame(sequenceNode->IndexEntries[itemNumber].DataNode);
+  if (!frame)
+    {
+    return nullptr;
+    }
+  int frameIndex = frame->FrameIndex;
+  vtkSmartPointer<vtkImageData> image;
+    {
+    std::lock_guard<std::mutex> lock(this->Internal->CacheMutex);
+    this->Internal->MaximumNumberOfCachedImages = std::max(this->FrameCacheSize, 1);
+    image = this->Internal->GetCachedImage(frameIndex);
+    }
+  if (!image)
+    {
+    image = this->ReadFrame(frameIndex);
+    std::lock_guard<std::mutex> lock(this->Internal->CacheMutex);
+    this->Internal->AddCachedImage(frameIndex, image);
+    }
+  this->ReadAhead(sequenceNode, itemNumber);
+  return image;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceFrameLoader::ReadAhead(vtkMRMLSequenceNode* sequenceNode, int itemNumber)
+{
+  int direction = (this->Internal->LastItemNumber >= 0 && itemNumber < this->Internal->LastItemNumber) ? -1 : 1;
+  this->Internal->LastItemNumber = itemNumber;
+  // Frames that are read in advance must not push the current frame out of the cache
+  int readAheadFrames = std::min(this->ReadAheadFrames, std::max(this->FrameCacheSize, 1) - 1);
+  if (readAheadFrames <= 0)
+    {
+    return;
+    }
+
+  std::deque<int> requests;
+  int numberOfItems = static_cast<int>(sequenceNode->IndexEntries.size());
+  for (int offset = 1; offset <= std::min(readAheadFrames, numberOfItems - 1); ++offset)
+    {
+    // Wrap around, as playback is usually looped
+    int nextItemNumber = ((itemNumber + direction * offset) % numberOfItems + numberOfItems) % numberOfItems;
+    vtkInternal::FrameType* frame = this->Internal->GetFrame(sequenceNode->IndexEntries[nextItemNumber].DataNode);
+    if (frame)
+      {
+      requests.push_back(frame->FrameIndex);
+      }
+    }
+  if (requests.empty())
+    {
+    return;
+    }
+
+  this->Internal->StartReadAheadThread(this);
+    {
+    std::lock_guard<std::mutex> lock(this->Internal->CacheMutex);
+    this->Internal->MaximumNumberOfCachedImages = std::max(this->FrameCacheSize, 1);
+    // Requests for another browsing position are not needed anymore
+    this->Internal->ReadAheadRequests = requests;
+    }
+  this->Internal->ReadAheadCondition.notify_one();
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLVolumeSequenceFrameLoader::GetNumberOfCachedFrames()
+{
+  std::lock_guard<std::mutex> lock(this->Internal->CacheMutex);
+  return static_cast<int>(this->Internal->CachedImages.size());
+}
@@ -0,0 +1,131 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+#ifndef __vtkMRMLVolumeSequenceFrameLoader_h
+#define __vtkMRMLVolumeSequenceFrameLoader_h
+
+// MRML includes
+#include "vtkMRML.h"
+
+// VTK includes
+#include <vtkObject.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <string>
+
+class vtkImageData;
+class vtkMRMLNode;
+class vtkMRMLSequenceNode;
+class vtkMRMLVolumeNode;
+
+/// \brief Loads frames of a volume sequence file on demand.
+///
+/// The voxels of an uncompressed (raw encoding) volume sequence NRRD file are accessed
+/// through a read-only memory mapping of the file, without reading the whole file into memory.
+/// Frames may be stored along the last axis, in which case the voxels of a frame are stored
+/// contiguously, or along the first axis, as written by vtkMRMLVolumeSequenceStorageNode
+/// ("kinds: list domain domain domain"), in which case the voxels of a frame are gathered
+/// from the whole mapped file.
+///
+/// Data nodes of the sequence are created without voxels. The voxels of a data node are loaded
+/// when the data node is accessed by vtkMRMLSequenceNode::GetNthDataNode or GetDataNodeAtValue.
+/// From then on the data node keeps its voxels and it is no longer managed by the loader.
+///
+/// Voxels of a frame can also be read without loading them into the data node using GetFrameImage
+/// (e.g., for showing the frame in a proxy node). The last FrameCacheSize frames read this way
+/// are kept in memory, and the next ReadAheadFrames frames in the browsing direction are read
+/// in a background thread.
+class VTK_MRML_EXPORT vtkMRMLVolumeSequenceFrameLoader : public vtkObject
+{
+public:
+  static vtkMRMLVolumeSequenceFrameLoader *New();
+  vtkTypeMacro(vtkMRMLVolumeSequenceFrameLoader, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /// Map the voxels of a NRRD file into memory. Voxels are not read until a frame is requested.
+  /// Returns false if the file cannot be mapped (e.g., compressed encoding or unsupported axis order),
+  /// in this case the file has to be read completely.
+  /// \param numberOfFrames Number of frames (size of the first or last axis)
+  /// \param extent Extent of each frame
+  /// \param scalarType VTK scalar type of the voxels
+  /// \param swapBytes True if the byte order of the file is different from the byte order of this computer
+  bool Open(const std::string& fileName, int numberOfFrames, const int extent[6], int scalarType, bool swapBytes);
+
+  /// Unmap the file. Voxels of data nodes that are not loaded are not available anymore.
+  void Close();
+
+  /// Returns true if a file is mapped
+  bool IsOpen();
+
+  /// Manage a data node of the sequence: its voxels are loaded from the specified frame
+  /// when the data node is accessed. The data node must not be handed out before it is added.
+  void AddDataNode(vtkMRMLVolumeNode* dataNode, int frameIndex);
+
+  /// Stop managing a data node (e.g., because it is removed from the sequence
+  /// or its content is replaced)
+  void RemoveDataNode(vtkMRMLNode* dataNode);
+
+  /// Returns true if the data node is managed by this loader and its voxels are not loaded.
+  bool IsDataNodeLoadPending(vtkMRMLNode* dataNode);
+
+  /// Load voxels of the n-th data node of the sequence (if it is managed by this loader).
+  /// The data node keeps the voxels and it is no longer managed by the loader.
+  void LoadDataNode(vtkMRMLSequenceNode* sequenceNode, int itemNumber);
+
+  /// Load voxels of all data nodes and stop managing them.
+  /// Must be called before the mapped file is overwritten.
+  void LoadAllDataNodes();
+
+  /// Get voxels of the n-th data node of the sequence without loading them into the data node
+  /// and start reading the following frames in the background.
+  /// Returns nullptr if the data node is not managed by this loader (its voxels are in the data node).
+  /// The returned image is shared with the frame cache, it must not be modified.
+  vtkSmartPointer<vtkImageData> GetFrameImage(vtkMRMLSequenceNode* sequenceNode, int itemNumber);
+
+  /// Read voxels of a frame from the mapped file. Can be called from any thread.
+  vtkSmartPointer<vtkImageData> ReadFrame(int frameIndex);
+
+  /// Extent of each frame of the opened file
+  void GetFrameExtent(int extent[6]);
+
+  /// VTK scalar type of the voxels of the opened file
+  int GetFrameScalarType();
+
+  /// Maximum number of frames that are kept in memory by GetFrameImage. Default is 8.
+  vtkSetMacro(FrameCacheSize, int);
+  vtkGetMacro(FrameCacheSize, int);
+
+  /// Number of frames that are read in advance in the browsing direction. Default is 2.
+  /// 0 disables reading in advance.
+  vtkSetMacro(ReadAheadFrames, int);
+  vtkGetMacro(ReadAheadFrames, int);
+
+  /// Number of frames that are currently kept in memory by GetFrameImage
+  int GetNumberOfCachedFrames();
+
+protected:
+  vtkMRMLVolumeSequenceFrameLoader();
+  ~vtkMRMLVolumeSequenceFrameLoader() override;
+
+  /// Queue frames for reading in the background
+  void ReadAhead(vtkMRMLSequenceNode* sequenceNode, int itemNumber);
+
+  int FrameCacheSize;
+  int ReadAheadFrames;
+
+  class vtkInternal;
+  vtkInternal* Internal;
+
+private:
+  vtkMRMLVolumeSequenceFrameLoader(const vtkMRMLVolumeSequenceFrameLoader&) = delete;
+  void operator=(const vtkMRMLVolumeSequenceFrameLoader&) = delete;
+};
+
+#endif
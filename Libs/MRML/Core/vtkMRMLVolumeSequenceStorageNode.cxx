@@ -14,6 +14,7 @@ or http://www.slicer.org/copyright/copyright.txt for details.
 #include "vtkMRMLScalarVolumeNode.h"
 #include "vtkMRMLSequenceNode.h"
 #include "vtkMRMLVectorVolumeNode.h"
+#include "vtkMRMLVolumeSequenceFrameLoader.h"
 
 #include "vtkSlicerVersionConfigure.h"
 #include "vtkTeemNRRDReader.h"
@@ -28,12 +29,40 @@ or http://www.slicer.org/copyright/copyright.txt for details.
 #include "vtkStringArray.h"
 #include "vtksys/SystemTools.hxx"
 
+namespace
+{
+//----------------------------------------------------------------------------
+// Get extent, scalar type, and number of components of the voxels of a frame.
+// Voxels of frames that are loaded on demand are not read, their properties are taken from the file.
+void GetFrameVoxelProperties(vtkMRMLSequenceNode* volSequenceNode, vtkMRMLVolumeNode* frameVolume,
+  int extent[6], int& scalarType, int& numberOfComponents)
+{
+  vtkMRMLVolumeSequenceFrameLoader* frameLoader = volSequenceNode->GetFrameLoader();
+  if (frameLoader && frameLoader->IsDataNodeLoadPending(frameVolume))
+    {
+    frameLoader->GetFrameExtent(extent);
+    scalarType = frameLoader->GetFrameScalarType();
+    numberOfComponents = 1;
+    return;
+    }
+  if (frameVolume->GetImageData())
+    {
+    frameVolume->GetImageData()->GetExtent(extent);
+    scalarType = frameVolume->GetImageData()->GetScalarType();
+    numberOfComponents = frameVolume->GetImageData()->GetNumberOfScalarComponents();
+    }
+}
+} // end of anonymous namespace
+
 //----------------------------------------------------------------------------
 vtkMRMLNodeNewMacro(vtkMRMLVolumeSequenceStorageNode);
 
 //----------------------------------------------------------------------------
 vtkMRMLVolumeSequenceStorageNode::vtkMRMLVolumeSequenceStorageNode()
 {
+  this->LazyLoading = false;
+  this->FrameCacheSize = 8;
+  this->ReadAheadFrames = 2;
 }
 
 //----------------------------------------------------------------------------
@@ -41,6 +70,52 @@ vtkMRMLVolumeSequenceStorageNode::~vtkMRMLVolumeSequenceStorageNode()
 {
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceStorageNode::PrintSelf(ostream& os, vtkIndent indent)
+{
+  Superclass::PrintSelf(os, indent);
+  vtkMRMLPrintBeginMacro(os, indent);
+  vtkMRMLPrintBooleanMacro(LazyLoading);
+  vtkMRMLPrintIntMacro(FrameCacheSize);
+  vtkMRMLPrintIntMacro(ReadAheadFrames);
+  vtkMRMLPrintEndMacro();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceStorageNode::ReadXMLAttributes(const char** atts)
+{
+  MRMLNodeModifyBlocker blocker(this);
+  Superclass::ReadXMLAttributes(atts);
+  vtkMRMLReadXMLBeginMacro(atts);
+  vtkMRMLReadXMLBooleanMacro(lazyLoading, LazyLoading);
+  vtkMRMLReadXMLIntMacro(frameCacheSize, FrameCacheSize);
+  vtkMRMLReadXMLIntMacro(readAheadFrames, ReadAheadFrames);
+  vtkMRMLReadXMLEndMacro();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceStorageNode::WriteXML(ostream& of, int nIndent)
+{
+  Superclass::WriteXML(of, nIndent);
+  vtkMRMLWriteXMLBeginMacro(of);
+  vtkMRMLWriteXMLBooleanMacro(lazyLoading, LazyLoading);
+  vtkMRMLWriteXMLIntMacro(frameCacheSize, FrameCacheSize);
+  vtkMRMLWriteXMLIntMacro(readAheadFrames, ReadAheadFrames);
+  vtkMRMLWriteXMLEndMacro();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceStorageNode::Copy(vtkMRMLNode *anode)
+{
+  MRMLNodeModifyBlocker blocker(this);
+  Superclass::Copy(anode);
+  vtkMRMLCopyBeginMacro(anode);
+  vtkMRMLCopyBooleanMacro(LazyLoading);
+  vtkMRMLCopyIntMacro(FrameCacheSize);
+  vtkMRMLCopyIntMacro(ReadAheadFrames);
+  vtkMRMLCopyEndMacro();
+}
+
 //----------------------------------------------------------------------------
 bool vtkMRMLVolumeSequenceStorageNode::CanReadInReferenceNode(vtkMRMLNode *refNode)
 {
@@ -69,6 +144,13 @@ int vtkMRMLVolumeSequenceStorageNode::ReadDataInternal(vtkMRMLNode* refNode)
     return 0;
     }
 
+  // Frames that are not loaded yet must be read before the file is read again
+  if (volSequenceNode->GetFrameLoader())
+    {
+    volSequenceNode->GetFrameLoader()->LoadAllDataNodes();
+    volSequenceNode->SetFrameLoader(nullptr);
+    }
+
   vtkNew<vtkTeemNRRDReader> reader;
   reader->SetFileName(fullName.c_str());
 
@@ -154,6 +236,12 @@ int vtkMRMLVolumeSequenceStorageNode::ReadDataInternal(vtkMRMLNode* refNode)
   const char* sequenceAxisUnit = reader->GetAxisUnit(frameAxis);
   volSequenceNode->SetIndexUnit(sequenceAxisUnit ? sequenceAxisUnit : "");
 
+  if (this->LazyLoading && this->ReadFramesOnDemand(reader, volSequenceNode, indexValues))
+    {
+    vtkDebugMacro(<< " vtkMRMLVolumeSequenceStorageNode::ReadDataInternal: frames will be loaded on demand. ");
+    return 1;
+    }
+
   // Read and copy the data to sequence of volume nodes
 #ifdef NRRD_CHUNK_IO_AVAILABLE
   int numberOfFrames = reader->GetNumberOfImages();
@@ -245,6 +333,55 @@ int vtkMRMLVolumeSequenceStorageNode::ReadDataInternal(vtkMRMLNode* refNode)
   return 1;
 }
 
+//----------------------------------------------------------------------------
+bool vtkMRMLVolumeSequenceStorageNode::ReadFramesOnDemand(vtkTeemNRRDReader* reader,
+  vtkMRMLSequenceNode* volSequenceNode, const std::vector<std::string>& indexValues)
+{
+  if (reader->GetPointDataType() != vtkDataSetAttributes::SCALARS)
+    {
+    return false;
+    }
+  int numberOfFrames = reader->GetNumberOfComponents();
+  int frameExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  reader->GetDataExtent(frameExtent);
+  vtkNew<vtkMRMLVolumeSequenceFrameLoader> frameLoader;
+  frameLoader->SetFrameCacheSize(this->FrameCacheSize);
+  frameLoader->SetReadAheadFrames(this->ReadAheadFrames);
+  if (!frameLoader->Open(reader->GetFileName(), numberOfFrames, frameExtent,
+    reader->GetDataScalarType(), reader->GetSwapBytes() != 0))
+    {
+    vtkDebugMacro("ReadFramesOnDemand: file cannot be memory-mapped, reading all frames");
+    return false;
+    }
+
+  for (int frameIndex = 0; frameIndex < numberOfFrames; ++frameIndex)
+    {
+    // Voxels are added by the frame loader when the data node is accessed
+    vtkNew<vtkMRMLScalarVolumeNode> frameVolume;
+    frameVolume->SetRASToIJKMatrix(reader->GetRasToIjkMatrix());
+
+    std::ostringstream indexStr;
+    if (static_cast<int>(indexValues.size()) > frameIndex)
+      {
+      indexStr << indexValues[frameIndex] << std::ends;
+      }
+    else
+      {
+      indexStr << frameIndex << std::ends;
+      }
+
+    std::ostringstream nameStr;
+    nameStr << volSequenceNode->GetName() << "_" << std::setw(4) << std::setfill('0') << frameIndex << std::ends;
+    frameVolume->SetName(nameStr.str().c_str());
+    vtkMRMLVolumeNode* addedFrameVolume = vtkMRMLVolumeNode::SafeDownCast(
+      volSequenceNode->SetDataNodeAtValue(frameVolume.GetPointer(), indexStr.str().c_str()));
+    frameLoader->AddDataNode(addedFrameVolume, frameIndex);
+    }
+
+  volSequenceNode->SetFrameLoader(frameLoader.GetPointer());
+  return true;
+}
+
 //----------------------------------------------------------------------------
 bool vtkMRMLVolumeSequenceStorageNode::CanWriteFromReferenceNode(vtkMRMLNode *refNode)
 {
@@ -254,7 +391,7 @@ bool vtkMRMLVolumeSequenceStorageNode::CanWriteFromReferenceNode(vtkMRMLNode *re
     vtkErrorMacro("vtkMRMLVolumeSequenceStorageNode::CanWriteFromReferenceNode: invalid volSequenceNode");
     return false;
     }
-  vtkMRMLVolumeNode* firstFrameVolume = vtkMRMLVolumeNode::SafeDownCast(volSequenceNode->GetNthDataNode(0));
+  vtkMRMLVolumeNode* firstFrameVolume = vtkMRMLVolumeNode::SafeDownCast(volSequenceNode->GetNthDataNodeWithoutLoading(0));
   if (firstFrameVolume == nullptr)
     {
     vtkErrorMacro("vtkMRMLVolumeSequenceStorageNode::CanWriteFromReferenceNode: only volume nodes can be written");
@@ -264,22 +401,18 @@ bool vtkMRMLVolumeSequenceStorageNode::CanWriteFromReferenceNode(vtkMRMLNode *re
   int firstFrameVolumeExtent[6] = { 0, -1, 0, -1, 0, -1 };
   int firstFrameVolumeScalarType = VTK_VOID;
   int firstFrameVolumeNumberOfComponents = 0;
-  if (firstFrameVolume->GetImageData())
+  GetFrameVoxelProperties(volSequenceNode, firstFrameVolume,
+    firstFrameVolumeExtent, firstFrameVolumeScalarType, firstFrameVolumeNumberOfComponents);
+  if (firstFrameVolumeNumberOfComponents > 1)
     {
-    firstFrameVolume->GetImageData()->GetExtent(firstFrameVolumeExtent);
-    firstFrameVolumeScalarType = firstFrameVolume->GetImageData()->GetScalarType();
-    firstFrameVolumeNumberOfComponents = firstFrameVolume->GetImageData()->GetNumberOfScalarComponents();
-    if (firstFrameVolumeNumberOfComponents != 1)
-      {
-      vtkDebugMacro("vtkMRMLVolumeSequenceStorageNode::CanWriteFromReferenceNode: only single scalar component volumes can be written by VTK NRRD writer");
-      return false;
-      }
+    vtkDebugMacro("vtkMRMLVolumeSequenceStorageNode::CanWriteFromReferenceNode: only single scalar component volumes can be written by VTK NRRD writer");
+    return false;
     }
 
   int numberOfFrameVolumes = volSequenceNode->GetNumberOfDataNodes();
   for (int frameIndex = 1; frameIndex<numberOfFrameVolumes; frameIndex++)
     {
-    vtkMRMLVolumeNode* currentFrameVolume = vtkMRMLVolumeNode::SafeDownCast(volSequenceNode->GetNthDataNode(frameIndex));
+    vtkMRMLVolumeNode* currentFrameVolume = vtkMRMLVolumeNode::SafeDownCast(volSequenceNode->GetNthDataNodeWithoutLoading(frameIndex));
     if (currentFrameVolume == nullptr)
       {
       vtkDebugMacro("vtkMRMLVolumeSequenceStorageNode::CanWriteFromReferenceNode: only volume nodes can be written (frame "<<frameIndex<<")");
@@ -291,12 +424,8 @@ bool vtkMRMLVolumeSequenceStorageNode::CanWriteFromReferenceNode(vtkMRMLNode *re
     int currentFrameVolumeExtent[6] = { 0, -1, 0, -1, 0, -1 };
     int currentFrameVolumeScalarType = VTK_VOID;
     int currentFrameVolumeNumberOfComponents = 0;
-    if (currentFrameVolume->GetImageData())
-      {
-      currentFrameVolume->GetImageData()->GetExtent(currentFrameVolumeExtent);
-      currentFrameVolumeScalarType = currentFrameVolume->GetImageData()->GetScalarType();
-      currentFrameVolumeNumberOfComponents = currentFrameVolume->GetImageData()->GetNumberOfScalarComponents();
-      }
+    GetFrameVoxelProperties(volSequenceNode, currentFrameVolume,
+      currentFrameVolumeExtent, currentFrameVolumeScalarType, currentFrameVolumeNumberOfComponents);
     for (int i = 0; i < 6; i++)
       {
       if (firstFrameVolumeExtent[i] != currentFrameVolumeExtent[i])
@@ -330,6 +459,13 @@ int vtkMRMLVolumeSequenceStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
     return 0;
     }
 
+  // The file that frames are loaded from may be overwritten, therefore load all frames now
+  if (volSequenceNode->GetFrameLoader())
+    {
+    volSequenceNode->GetFrameLoader()->LoadAllDataNodes();
+    volSequenceNode->SetFrameLoader(nullptr);
+    }
+
   vtkNew<vtkMatrix4x4> ijkToRas;
   int frameVolumeDimensions[3] = {0};
   int frameVolumeScalarType = VTK_VOID;
@@ -413,6 +549,7 @@ int vtkMRMLVolumeSequenceStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
 #endif
 
   writer->SetUseCompression(this->GetUseCompression());
+  writer->SetCompressionLevel(this->GetGzipCompressionLevelFromCompressionParameter(this->CompressionParameter));
 
   // Set volume attributes
   writer->SetIJKToRASMatrix(ijkToRas.GetPointer());
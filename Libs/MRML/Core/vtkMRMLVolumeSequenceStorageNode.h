@@ -17,6 +17,10 @@
 
 #include "vtkMRMLNRRDStorageNode.h"
 #include <string>
+#include <vector>
+
+class vtkMRMLSequenceNode;
+class vtkTeemNRRDReader;
 
 /// \ingroup Slicer_QtModules_Sequences
 class VTK_MRML_EXPORT vtkMRMLVolumeSequenceStorageNode : public vtkMRMLNRRDStorageNode
@@ -55,6 +59,28 @@ class VTK_MRML_EXPORT vtkMRMLVolumeSequenceStorageNode : public vtkMRMLNRRDStora
   /// Return a default file extension for writting
   const char* GetDefaultWriteFileExtension() override;
 
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+  void ReadXMLAttributes(const char** atts) override;
+  void WriteXML(ostream& of, int indent) override;
+  void Copy(vtkMRMLNode *node) override;
+
+  /// If enabled then voxels of a frame are loaded from a memory-mapped file when the data node
+  /// is accessed by vtkMRMLSequenceNode::GetNthDataNode or GetDataNodeAtValue.
+  /// Only uncompressed (raw encoding) files can be mapped, compressed files are always read completely.
+  /// Disabled by default.
+  /// \sa vtkMRMLVolumeSequenceFrameLoader
+  vtkSetMacro(LazyLoading, bool);
+  vtkGetMacro(LazyLoading, bool);
+  vtkBooleanMacro(LazyLoading, bool);
+
+  /// Maximum number of frames kept in memory for display in lazy loading mode. Default is 8.
+  vtkSetMacro(FrameCacheSize, int);
+  vtkGetMacro(FrameCacheSize, int);
+
+  /// Number of frames read in advance in the browsing direction in lazy loading mode. Default is 2.
+  vtkSetMacro(ReadAheadFrames, int);
+  vtkGetMacro(ReadAheadFrames, int);
+
 protected:
   vtkMRMLVolumeSequenceStorageNode();
   ~vtkMRMLVolumeSequenceStorageNode() override;
@@ -75,11 +101,20 @@ protected:
 
   int ReadDataInternal(vtkMRMLNode* refNode) override;
 
+  /// Add data nodes to the sequence that load their voxels when they are accessed.
+  /// Returns false if the file cannot be memory-mapped.
+  bool ReadFramesOnDemand(vtkTeemNRRDReader* reader, vtkMRMLSequenceNode* volSequenceNode,
+    const std::vector<std::string>& indexValues);
+
   /// Initialize all the supported write file types
   void InitializeSupportedReadFileTypes() override;
 
   /// Initialize all the supported write file types
   void InitializeSupportedWriteFileTypes() override;
+
+  bool LazyLoading;
+  int FrameCacheSize;
+  int ReadAheadFrames;
 };
 
 #endif
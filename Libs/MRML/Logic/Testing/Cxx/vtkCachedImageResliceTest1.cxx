@@ -0,0 +1,178 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRMLLogic includes
+#include "vtkCachedImageReslice.h"
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+#include <vtkTransform.h>
+
+// STD includes
+#include <chrono>
+#include <thread>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkImageData> createVolume()
+{
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(32, 32, 16);
+  image->AllocateScalars(VTK_SHORT, 1);
+  short* ptr = static_cast<short*>(image->GetScalarPointer());
+  for (vtkIdType i = 0; i < 32 * 32 * 16; ++i)
+    {
+    ptr[i] = static_cast<short>(i % 1000);
+    }
+  return image;
+}
+
+//----------------------------------------------------------------------------
+short resliceAt(vtkCachedImageReslice* reslice, double z)
+{
+  vtkNew<vtkTransform> transform;
+  transform->Translate(0.0, 0.0, z);
+  reslice->SetResliceTransform(transform.GetPointer());
+  reslice->Update();
+  return *static_cast<short*>(reslice->GetOutput()->GetScalarPointer(5, 5, 0));
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkCachedImageResliceTest1(int vtkNotUsed(argc), char * vtkNotUsed(argv)[])
+{
+  vtkSmartPointer<vtkImageData> volume = createVolume();
+  vtkNew<vtkCachedImageReslice> reslice;
+  reslice->SetInputData(volume);
+  reslice->SetOutputExtent(0, 31, 0, 31, 0, 0);
+  reslice->GenerateStencilOutputOn();
+
+  // Slices that are displayed again are taken from the cache
+  short valueAt3 = resliceAt(reslice.GetPointer(), 3.0);
+  short valueAt4 = resliceAt(reslice.GetPointer(), 4.0);
+  CHECK_INT(static_cast<int>(reslice->GetNumberOfCacheMisses()), 2);
+  CHECK_INT(resliceAt(reslice.GetPointer(), 3.0), valueAt3);
+  CHECK_INT(resliceAt(reslice.GetPointer(), 4.0), valueAt4);
+  CHECK_INT(static_cast<int>(reslice->GetNumberOfCacheHits()), 2);
+  CHECK_INT(static_cast<int>(reslice->GetNumberOfCacheMisses()), 2);
+  CHECK_INT(reslice->GetNumberOfCachedImages(), 2);
+
+  // Modified input invalidates cached images
+  volume->Modified();
+  CHECK_INT(resliceAt(reslice.GetPointer(), 3.0), valueAt3);
+  CHECK_INT(static_cast<int>(reslice->GetNumberOfCacheMisses()), 3);
+
+  // Changing the interpolation mode invalidates cached images
+  reslice->SetInterpolationModeToLinear();
+  resliceAt(reslice.GetPointer(), 3.0);
+  CHECK_INT(static_cast<int>(reslice->GetNumberOfCacheMisses()), 4);
+
+  // Least recently used images are removed when the memory limit is reached
+  reslice->SetCacheMemoryLimit(reslice->GetCacheMemorySize() / reslice->GetNumberOfCachedImages() * 1.5);
+  CHECK_INT(reslice->GetNumberOfCachedImages(), 1);
+
+  // Cache can be disabled
+  reslice->SetCacheMemoryLimit(0.0);
+  CHECK_INT(reslice->GetNumberOfCachedImages(), 0);
+  reslice->ResetCacheStatistics();
+  resliceAt(reslice.GetPointer(), 3.0);
+  resliceAt(reslice.GetPointer(), 3.0);
+  CHECK_INT(static_cast<int>(reslice->GetNumberOfCacheHits()), 0);
+
+  // Neighboring slices are computed in the background
+  reslice->SetCacheMemoryLimit(64.0);
+  reslice->PrefetchOn();
+  reslice->ResetCacheStatistics();
+  resliceAt(reslice.GetPointer(), 8.0);
+  for (int i = 0; i < 500 && reslice->GetNumberOfPrefetchedImages() < 2; ++i)
+    {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  CHECK_INT(static_cast<int>(reslice->GetNumberOfPrefetchedImages()), 2);
+  reslice->PrefetchOff();
+  resliceAt(reslice.GetPointer(), 9.0);
+  resliceAt(reslice.GetPointer(), 7.0);
+  CHECK_INT(static_cast<int>(reslice->GetNumberOfCacheHits()), 2);
+  CHECK_INT(static_cast<int>(reslice->GetNumberOfCacheMisses()), 1);
+
+  // Images prefetched from a modified input are not used. Nothing is
+  // prefetched while the input is modified between updates, neighbors of the
+  // slice are prefetched again once the input is not modified anymore.
+  reslice->PrefetchOn();
+  resliceAt(reslice.GetPointer(), 8.0);
+  volume->Modified();
+  reslice->ResetCacheStatistics();
+  resliceAt(reslice.GetPointer(), 8.0);
+  CHECK_INT(static_cast<int>(reslice->GetNumberOfPrefetchedImages()), 0);
+  resliceAt(reslice.GetPointer(), 8.0);
+  for (int i = 0; i < 500 && reslice->GetNumberOfPrefetchedImages() < 2; ++i)
+    {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  CHECK_INT(static_cast<int>(reslice->GetNumberOfPrefetchedImages()), 2);
+  reslice->PrefetchOff();
+  resliceAt(reslice.GetPointer(), 9.0);
+  CHECK_INT(static_cast<int>(reslice->GetNumberOfCacheHits()), 2);
+  CHECK_INT(static_cast<int>(reslice->GetNumberOfCacheMisses()), 1);
+
+  // Prefetched images are computed from a copy of the input: modifying the
+  // voxels in place while the background thread reads them has no effect on
+  // prefetched images, which are discarded since the input is modified.
+  reslice->PrefetchOn();
+  resliceAt(reslice.GetPointer(), 12.0);
+  short* voxels = static_cast<short*>(volume->GetScalarPointer());
+  for (vtkIdType i = 0; i < volume->GetNumberOfPoints(); ++i)
+    {
+    voxels[i] = static_cast<short>(-voxels[i]);
+    }
+  volume->Modified();
+  short valueAt13 = *static_cast<short*>(volume->GetScalarPointer(5, 5, 13));
+  reslice->PrefetchOff();
+  CHECK_INT(resliceAt(reslice.GetPointer(), 13.0), valueAt13);
+
+  // Prefetched oblique slices are found in the cache even though the
+  // matrix of the next slice is not computed the same way.
+  reslice->ClearCache();
+  reslice->SetOutputSpacing(1.0, 1.0, 0.7);
+  reslice->PrefetchOn();
+  reslice->ResetCacheStatistics();
+  vtkNew<vtkTransform> obliqueTransform;
+  obliqueTransform->Translate(16.1, 16.3, 8.2);
+  obliqueTransform->RotateX(31.7);
+  obliqueTransform->RotateY(-12.9);
+  obliqueTransform->Translate(-16.0, -16.0, 0.0);
+  reslice->SetResliceTransform(obliqueTransform.GetPointer());
+  reslice->Update();
+  for (int i = 0; i < 500 && reslice->GetNumberOfPrefetchedImages() < 2; ++i)
+    {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  CHECK_INT(static_cast<int>(reslice->GetNumberOfPrefetchedImages()), 2);
+  reslice->PrefetchOff();
+  // Step one slice forward, as the slice logic does when scrolling
+  vtkNew<vtkTransform> nextSliceTransform;
+  nextSliceTransform->SetMatrix(obliqueTransform->GetMatrix());
+  nextSliceTransform->Translate(0.0, 0.0, 0.7);
+  reslice->SetResliceTransform(nextSliceTransform.GetPointer());
+  reslice->Update();
+  CHECK_INT(static_cast<int>(reslice->GetNumberOfCacheHits()), 1);
+  CHECK_INT(static_cast<int>(reslice->GetNumberOfCacheMisses()), 1);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,141 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRMLLogic includes
+#include "vtkImageLabelMapToRGBA.h"
+#include "vtkImageLabelOutline.h"
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkImageMapToRGBA.h>
+#include <vtkLookupTable.h>
+#include <vtkNew.h>
+
+// STD includes
+#include <cmath>
+#include <cstdlib>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Compare with the fill image rendered on top of the outline image, as
+// displayed by the segmentations displayable manager with separate actors.
+int compareWithSeparateFillAndOutline(vtkImageData* labelImage,
+  vtkLookupTable* fillLookupTable, vtkLookupTable* outlineLookupTable, int outline)
+{
+  vtkNew<vtkImageLabelMapToRGBA> labelMapToRGBA;
+  labelMapToRGBA->SetInputData(labelImage);
+  labelMapToRGBA->SetFillLookupTable(fillLookupTable);
+  labelMapToRGBA->SetOutlineLookupTable(outlineLookupTable);
+  labelMapToRGBA->SetOutline(outline);
+  labelMapToRGBA->Update();
+
+  vtkNew<vtkImageMapToRGBA> fillColorMapper;
+  fillColorMapper->SetInputData(labelImage);
+  fillColorMapper->SetLookupTable(fillLookupTable);
+  fillColorMapper->Update();
+  vtkNew<vtkImageLabelOutline> labelOutline;
+  labelOutline->SetInputData(labelImage);
+  labelOutline->SetOutline(outline);
+  vtkNew<vtkImageMapToRGBA> outlineColorMapper;
+  outlineColorMapper->SetInputConnection(labelOutline->GetOutputPort());
+  outlineColorMapper->SetLookupTable(outlineLookupTable);
+  outlineColorMapper->Update();
+
+  vtkImageData* output = labelMapToRGBA->GetOutput();
+  CHECK_INT(output->GetScalarType(), VTK_UNSIGNED_CHAR);
+  CHECK_INT(output->GetNumberOfScalarComponents(), 4);
+  CHECK_INT(output->GetNumberOfPoints(), labelImage->GetNumberOfPoints());
+
+  unsigned char* outPtr = static_cast<unsigned char*>(output->GetScalarPointer());
+  unsigned char* fillPtr = static_cast<unsigned char*>(fillColorMapper->GetOutput()->GetScalarPointer());
+  unsigned char* outlinePtr = static_cast<unsigned char*>(outlineColorMapper->GetOutput()->GetScalarPointer());
+  for (vtkIdType pointIndex = 0; pointIndex < labelImage->GetNumberOfPoints(); ++pointIndex)
+    {
+    double fillAlpha = fillPtr[3] / 255.0;
+    double outlineAlpha = outlinePtr[3] / 255.0 * (1.0 - fillAlpha);
+    double alpha = fillAlpha + outlineAlpha;
+    CHECK_BOOL(std::abs(outPtr[3] - alpha * 255.0) <= 1.0, true);
+    if (alpha > 0.0)
+      {
+      for (int component = 0; component < 3; ++component)
+        {
+        double expected = (fillPtr[component] * fillAlpha + outlinePtr[component] * outlineAlpha) / alpha;
+        CHECK_BOOL(std::abs(outPtr[component] - expected) <= 1.0, true);
+        }
+      }
+    outPtr += 4;
+    fillPtr += 4;
+    outlinePtr += 4;
+    }
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkImageLabelMapToRGBATest1(int vtkNotUsed(argc), char * vtkNotUsed(argv)[])
+{
+  // Labels 0-3 in stripes and a square of label 1 touching the image boundary
+  vtkNew<vtkImageData> labelImage;
+  labelImage->SetDimensions(40, 30, 1);
+  labelImage->AllocateScalars(VTK_SHORT, 1);
+  short* labelPtr = static_cast<short*>(labelImage->GetScalarPointer());
+  for (int y = 0; y < 30; ++y)
+    {
+    for (int x = 0; x < 40; ++x)
+      {
+      short label = static_cast<short>(x / 10);
+      if (x < 8 && y < 8)
+        {
+        label = 1;
+        }
+      *(labelPtr++) = label;
+      }
+    }
+
+  // Lookup tables are set up the same way as in the segmentations displayable manager
+  vtkNew<vtkLookupTable> fillLookupTable;
+  vtkNew<vtkLookupTable> outlineLookupTable;
+  vtkLookupTable* lookupTables[2] = { fillLookupTable.GetPointer(), outlineLookupTable.GetPointer() };
+  for (vtkLookupTable* lookupTable : lookupTables)
+    {
+    lookupTable->SetRampToLinear();
+    lookupTable->SetNumberOfTableValues(4);
+    lookupTable->SetTableRange(0, 3);
+    lookupTable->SetTableValue(0, 0.0, 0.0, 0.0, 0.0);
+    }
+  // label 1: filled and outlined
+  fillLookupTable->SetTableValue(1, 1.0, 0.0, 0.0, 0.5);
+  outlineLookupTable->SetTableValue(1, 1.0, 0.0, 0.0, 1.0);
+  // label 2: outline only
+  fillLookupTable->SetTableValue(2, 0.0, 1.0, 0.0, 0.0);
+  outlineLookupTable->SetTableValue(2, 0.0, 1.0, 0.0, 1.0);
+  // label 3: fill only, different fill and outline colors
+  fillLookupTable->SetTableValue(3, 0.0, 0.0, 1.0, 0.3);
+  outlineLookupTable->SetTableValue(3, 1.0, 1.0, 0.0, 0.0);
+
+  CHECK_EXIT_SUCCESS(compareWithSeparateFillAndOutline(labelImage.GetPointer(),
+    fillLookupTable.GetPointer(), outlineLookupTable.GetPointer(), 1));
+  CHECK_EXIT_SUCCESS(compareWithSeparateFillAndOutline(labelImage.GetPointer(),
+    fillLookupTable.GetPointer(), outlineLookupTable.GetPointer(), 3));
+
+  // Outline of a label becomes visible
+  outlineLookupTable->SetTableValue(3, 1.0, 1.0, 0.0, 0.8);
+  CHECK_EXIT_SUCCESS(compareWithSeparateFillAndOutline(labelImage.GetPointer(),
+    fillLookupTable.GetPointer(), outlineLookupTable.GetPointer(), 2));
+
+  return EXIT_SUCCESS;
+}
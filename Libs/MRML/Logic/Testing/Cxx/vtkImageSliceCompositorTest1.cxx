@@ -0,0 +1,291 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRMLLogic includes
+#include "vtkImageSliceCompositor.h"
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkImageBlend.h>
+#include <vtkImageData.h>
+#include <vtkImageMapToColors.h>
+#include <vtkImageMapToWindowLevelColors.h>
+#include <vtkImageReslice.h>
+#include <vtkImageThreshold.h>
+#include <vtkLookupTable.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
+#include <vtkTransform.h>
+#include <vtkTrivialProducer.h>
+
+// STD includes
+#include <cmath>
+#include <cstdlib>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Reslice as vtkMRMLSliceLayerLogic does: output origin 0, spacing 1, background 0
+vtkSmartPointer<vtkImageData> resliceVolume(vtkImageData* volume, vtkMatrix4x4* xyToIJK,
+  int interpolationMode, int outputExtent[6])
+{
+  vtkNew<vtkTransform> transform;
+  transform->SetMatrix(xyToIJK);
+  vtkNew<vtkImageReslice> reslice;
+  reslice->SetInputData(volume);
+  reslice->SetResliceTransform(transform.GetPointer());
+  reslice->SetInterpolationMode(interpolationMode);
+  reslice->SetBackgroundColor(0, 0, 0, 0);
+  reslice->SetOutputOrigin(0, 0, 0);
+  reslice->SetOutputSpacing(1, 1, 1);
+  reslice->SetOutputExtent(outputExtent);
+  reslice->Update();
+  vtkSmartPointer<vtkImageData> resliced = vtkSmartPointer<vtkImageData>::New();
+  resliced->ShallowCopy(reslice->GetOutput());
+  return resliced;
+}
+
+//----------------------------------------------------------------------------
+// RGBA image of a scalar layer, as computed by vtkMRMLScalarVolumeDisplayNode
+vtkSmartPointer<vtkImageData> mapScalarLayer(vtkImageData* volume, vtkMatrix4x4* xyToIJK,
+  int interpolationMode, double window, double level, bool applyThreshold, double lower, double upper,
+  vtkLookupTable* lookupTable, int outputExtent[6])
+{
+  vtkSmartPointer<vtkImageData> resliced = resliceVolume(volume, xyToIJK, interpolationMode, outputExtent);
+
+  // Voxels inside the volume, as the stencil output of the reslice filter
+  vtkNew<vtkImageData> ones;
+  ones->SetDimensions(volume->GetDimensions());
+  ones->SetOrigin(volume->GetOrigin());
+  ones->SetSpacing(volume->GetSpacing());
+  ones->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  ones->GetPointData()->GetScalars()->Fill(1);
+  vtkSmartPointer<vtkImageData> inside = resliceVolume(ones, xyToIJK, VTK_NEAREST_INTERPOLATION, outputExtent);
+
+  vtkNew<vtkImageMapToWindowLevelColors> windowLevel;
+  windowLevel->SetInputData(resliced);
+  windowLevel->SetOutputFormatToLuminance();
+  windowLevel->SetWindow(window);
+  windowLevel->SetLevel(level);
+  vtkNew<vtkImageMapToColors> mapToColors;
+  mapToColors->SetInputConnection(windowLevel->GetOutputPort());
+  mapToColors->SetLookupTable(lookupTable);
+  mapToColors->SetOutputFormatToRGBA();
+  mapToColors->Update();
+
+  vtkNew<vtkImageThreshold> threshold;
+  threshold->SetInputData(resliced);
+  threshold->ReplaceInOn();
+  threshold->SetInValue(255);
+  threshold->ReplaceOutOn();
+  threshold->SetOutValue(applyThreshold ? 0 : 255);
+  threshold->ThresholdBetween(lower, upper);
+  threshold->SetOutputScalarTypeToUnsignedChar();
+  threshold->Update();
+
+  vtkSmartPointer<vtkImageData> layer = vtkSmartPointer<vtkImageData>::New();
+  layer->DeepCopy(mapToColors->GetOutput());
+  unsigned char* layerPtr = static_cast<unsigned char*>(layer->GetScalarPointer());
+  unsigned char* thresholdPtr = static_cast<unsigned char*>(threshold->GetOutput()->GetScalarPointer());
+  unsigned char* insidePtr = static_cast<unsigned char*>(inside->GetScalarPointer());
+  for (vtkIdType pointIndex = 0; pointIndex < layer->GetNumberOfPoints(); ++pointIndex, layerPtr += 4)
+    {
+    bool opaque = thresholdPtr[pointIndex] != 0 && layerPtr[3] != 0 && insidePtr[pointIndex] != 0;
+    layerPtr[3] = (opaque ? 255 : 0);
+    }
+  return layer;
+}
+
+//----------------------------------------------------------------------------
+// RGBA image of a label layer, as computed by vtkMRMLLabelMapVolumeDisplayNode
+vtkSmartPointer<vtkImageData> mapLabelLayer(vtkImageData* volume, vtkMatrix4x4* xyToIJK,
+  vtkLookupTable* lookupTable, int outputExtent[6])
+{
+  vtkNew<vtkImageMapToColors> mapToColors;
+  mapToColors->SetInputData(resliceVolume(volume, xyToIJK, VTK_NEAREST_INTERPOLATION, outputExtent));
+  mapToColors->SetLookupTable(lookupTable);
+  mapToColors->SetOutputFormatToRGBA();
+  mapToColors->Update();
+  vtkSmartPointer<vtkImageData> layer = vtkSmartPointer<vtkImageData>::New();
+  layer->ShallowCopy(mapToColors->GetOutput());
+  return layer;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkLookupTable> createGreyLookupTable()
+{
+  vtkSmartPointer<vtkLookupTable> lookupTable = vtkSmartPointer<vtkLookupTable>::New();
+  lookupTable->SetNumberOfTableValues(256);
+  lookupTable->SetTableRange(0, 255);
+  for (int i = 0; i < 256; ++i)
+    {
+    // first entry is transparent to test the alpha of the lookup table
+    lookupTable->SetTableValue(i, i / 255.0, i / 255.0, i / 255.0, i == 0 ? 0.0 : 1.0);
+    }
+  return lookupTable;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkImageSliceCompositorTest1(int vtkNotUsed(argc), char * vtkNotUsed(argv)[])
+{
+  int outputExtent[6] = { 0, 63, 0, 47, 0, 0 };
+
+  // Background: short volume with non-trivial origin and spacing
+  vtkNew<vtkImageData> background;
+  background->SetDimensions(30, 25, 6);
+  background->SetOrigin(-4.0, 3.0, -2.0);
+  background->SetSpacing(1.5, 1.25, 2.0);
+  background->AllocateScalars(VTK_SHORT, 1);
+  short* backgroundPtr = static_cast<short*>(background->GetScalarPointer());
+  for (vtkIdType pointIndex = 0; pointIndex < background->GetNumberOfPoints(); ++pointIndex)
+    {
+    backgroundPtr[pointIndex] = static_cast<short>((pointIndex * 37) % 300 - 50);
+    }
+
+  // Foreground: float volume
+  vtkNew<vtkImageData> foreground;
+  foreground->SetDimensions(20, 20, 4);
+  foreground->SetOrigin(2.0, 1.0, -1.0);
+  foreground->SetSpacing(2.0, 2.0, 3.0);
+  foreground->AllocateScalars(VTK_FLOAT, 1);
+  float* foregroundPtr = static_cast<float*>(foreground->GetScalarPointer());
+  for (vtkIdType pointIndex = 0; pointIndex < foreground->GetNumberOfPoints(); ++pointIndex)
+    {
+    foregroundPtr[pointIndex] = static_cast<float>(std::sin(pointIndex * 0.1) * 1000.0);
+    }
+
+  // Label: labels 0-4
+  vtkNew<vtkImageData> label;
+  label->SetDimensions(40, 35, 5);
+  label->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  unsigned char* labelPtr = static_cast<unsigned char*>(label->GetScalarPointer());
+  for (vtkIdType pointIndex = 0; pointIndex < label->GetNumberOfPoints(); ++pointIndex)
+    {
+    labelPtr[pointIndex] = static_cast<unsigned char>((pointIndex / 7) % 5);
+    }
+
+  // Oblique slice: rotation angle is chosen so that sampling points are not
+  // on voxel boundaries, where nearest neighbor interpolation is ambiguous.
+  vtkNew<vtkTransform> xyToVolume;
+  xyToVolume->Translate(-3.1, 2.2, 3.3);
+  xyToVolume->RotateZ(23.0);
+  xyToVolume->RotateX(11.0);
+  xyToVolume->Scale(0.7, 0.7, 1.0);
+  vtkMatrix4x4* xyToIJK = xyToVolume->GetMatrix();
+
+  vtkSmartPointer<vtkLookupTable> backgroundLookupTable = createGreyLookupTable();
+  vtkSmartPointer<vtkLookupTable> foregroundLookupTable = createGreyLookupTable();
+  vtkNew<vtkLookupTable> labelLookupTable;
+  labelLookupTable->SetNumberOfTableValues(5);
+  labelLookupTable->SetTableRange(0, 4);
+  labelLookupTable->SetTableValue(0, 0.0, 0.0, 0.0, 0.0);
+  labelLookupTable->SetTableValue(1, 1.0, 0.0, 0.0, 1.0);
+  labelLookupTable->SetTableValue(2, 0.0, 1.0, 0.0, 1.0);
+  labelLookupTable->SetTableValue(3, 0.0, 0.0, 1.0, 0.5);
+  labelLookupTable->SetTableValue(4, 1.0, 1.0, 0.0, 1.0);
+
+  const double foregroundOpacity = 0.4;
+  const double labelOpacity = 0.6;
+
+  // Reference: separate reslice, color mapping and blending filters
+  vtkNew<vtkImageBlend> blend;
+  blend->AddInputData(mapScalarLayer(background, xyToIJK, VTK_NEAREST_INTERPOLATION,
+    200.0, 80.0, true, 0.0, 220.0, backgroundLookupTable, outputExtent));
+  blend->AddInputData(mapScalarLayer(foreground, xyToIJK, VTK_LINEAR_INTERPOLATION,
+    1500.0, 100.0, false, 0.0, 0.0, foregroundLookupTable, outputExtent));
+  blend->AddInputData(mapLabelLayer(label, xyToIJK, labelLookupTable, outputExtent));
+  blend->SetOpacity(1, foregroundOpacity);
+  blend->SetOpacity(2, labelOpacity);
+  blend->Update();
+
+  // Fused filter
+  vtkNew<vtkTrivialProducer> backgroundProducer;
+  backgroundProducer->SetOutput(background);
+  vtkNew<vtkTrivialProducer> foregroundProducer;
+  foregroundProducer->SetOutput(foreground);
+  vtkNew<vtkTrivialProducer> labelProducer;
+  labelProducer->SetOutput(label);
+
+  vtkNew<vtkImageSliceCompositor> compositor;
+  compositor->SetOutputExtent(outputExtent);
+  compositor->SetNumberOfLayers(3);
+  CHECK_INT(compositor->GetNumberOfLayers(), 3);
+
+  compositor->SetLayerInputConnection(0, backgroundProducer->GetOutputPort());
+  compositor->SetLayerResliceMatrix(0, xyToIJK);
+  compositor->SetLayerWindowLevel(0, 200.0, 80.0);
+  compositor->SetLayerThreshold(0, true, 0.0, 220.0);
+  compositor->SetLayerLookupTable(0, backgroundLookupTable);
+
+  compositor->SetLayerInputConnection(1, foregroundProducer->GetOutputPort());
+  compositor->SetLayerResliceMatrix(1, xyToIJK);
+  compositor->SetLayerInterpolationMode(1, VTK_LINEAR_INTERPOLATION);
+  compositor->SetLayerWindowLevel(1, 1500.0, 100.0);
+  compositor->SetLayerLookupTable(1, foregroundLookupTable);
+  compositor->SetLayerOpacity(1, foregroundOpacity);
+
+  compositor->SetLayerInputConnection(2, labelProducer->GetOutputPort());
+  compositor->SetLayerResliceMatrix(2, xyToIJK);
+  compositor->SetLayerMapping(2, vtkImageSliceCompositor::LabelMapping);
+  compositor->SetLayerLookupTable(2, labelLookupTable);
+  compositor->SetLayerOpacity(2, labelOpacity);
+  CHECK_DOUBLE(compositor->GetLayerOpacity(2), labelOpacity);
+
+  compositor->Update();
+  CHECK_BOOL(compositor->GetLastExecutionTime() >= 0.0, true);
+
+  vtkImageData* output = compositor->GetOutput();
+  vtkImageData* expectedOutput = blend->GetOutput();
+  CHECK_INT(output->GetScalarType(), VTK_UNSIGNED_CHAR);
+  CHECK_INT(output->GetNumberOfScalarComponents(), 4);
+  CHECK_INT(output->GetNumberOfPoints(), expectedOutput->GetNumberOfPoints());
+
+  // vtkImageBlend blends unsigned char images with truncated fixed-point arithmetic,
+  // while the compositor rounds the floating-point result: each of the two blended
+  // layers may change a color component by one. Alpha is the alpha of the background
+  // layer in both cases and must be identical.
+  const int colorTolerance = 2;
+  unsigned char* outPtr = static_cast<unsigned char*>(output->GetScalarPointer());
+  unsigned char* expectedPtr = static_cast<unsigned char*>(expectedOutput->GetScalarPointer());
+  for (vtkIdType pointIndex = 0; pointIndex < output->GetNumberOfPoints(); ++pointIndex, outPtr += 4, expectedPtr += 4)
+    {
+    for (int component = 0; component < 3; ++component)
+      {
+      CHECK_BOOL(std::abs(outPtr[component] - expectedPtr[component]) <= colorTolerance, true);
+      }
+    CHECK_INT(outPtr[3], expectedPtr[3]);
+    }
+
+  // Changing a lookup table updates the output
+  vtkMTimeType outputMTime = output->GetMTime();
+  labelLookupTable->SetTableValue(1, 0.0, 1.0, 1.0, 1.0);
+  compositor->Update();
+  CHECK_BOOL(compositor->GetOutput()->GetMTime() > outputMTime, true);
+
+  // Without layers the output is transparent
+  compositor->SetNumberOfLayers(0);
+  compositor->Update();
+  outPtr = static_cast<unsigned char*>(compositor->GetOutput()->GetScalarPointer());
+  for (vtkIdType pointIndex = 0; pointIndex < 4 * compositor->GetOutput()->GetNumberOfPoints(); ++pointIndex)
+    {
+    CHECK_INT(outPtr[pointIndex], 0);
+    }
+
+  return EXIT_SUCCESS;
+}
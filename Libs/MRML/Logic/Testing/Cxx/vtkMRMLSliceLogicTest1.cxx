@@ -11,6 +11,7 @@
 =========================================================================auto=*/
 
 // MRMLLogic includes
+#include "vtkImageSliceCompositor.h"
 #include "vtkMRMLSliceLogic.h"
 #include "vtkMRMLSliceLayerLogic.h"
 
@@ -67,6 +68,11 @@ int vtkMRMLSliceLogicTest1(int , char * [] )
   TEST_GET_OBJECT(logic, SliceModelDisplayNode);
   TEST_GET_OBJECT(logic, SliceModelTransformNode);
   TEST_GET_OBJECT(logic, Blend);
+  TEST_GET_OBJECT(logic, Compositor);
+  TEST_SET_GET_BOOLEAN(logic, FusedCompositing);
+  // no volume is displayed
+  CHECK_BOOL(logic->GetFusedCompositingActive(), false);
+  CHECK_DOUBLE(logic->GetLastCompositingTime(), 0.0);
 
   logic->Print(std::cout);
   return EXIT_SUCCESS;
@@ -0,0 +1,586 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#include "vtkCachedImageReslice.h"
+
+// VTK includes
+#include <vtkHomogeneousTransform.h>
+#include <vtkImageData.h>
+#include <vtkImageStencilData.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkSmartPointer.h>
+#include <vtkStreamingDemandDrivenPipeline.h>
+#include <vtkTransform.h>
+
+// STD includes
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+// Reslice matrix elements that differ by less than this value are
+// considered equal when looking up cached images.
+static const double VTK_CACHED_IMAGE_RESLICE_MATRIX_TOLERANCE = 1e-6;
+
+//----------------------------------------------------------------------------
+class vtkCachedImageReslice::vtkInternal
+{
+public:
+  struct CacheEntry
+    {
+    std::string Key;
+    vtkSmartPointer<vtkImageData> Image;
+    vtkSmartPointer<vtkImageStencilData> Stencil;
+    double Size; // in MB
+    };
+  typedef std::list<CacheEntry> CacheEntryListType;
+
+  struct PrefetchRequest
+    {
+    std::string Key;
+    vtkSmartPointer<vtkImageData> Input;
+    vtkSmartPointer<vtkImageReslice> Reslice;
+    double MemoryLimit;
+    /// Value of PrefetchInputGeneration when the request was made
+    unsigned long InputGeneration;
+    };
+
+  vtkInternal()
+    {
+    this->CacheMemorySize = 0.0;
+    this->NumberOfCacheHits = 0;
+    this->NumberOfCacheMisses = 0;
+    this->NumberOfPrefetchedImages = 0;
+    this->StopPrefetchThread = false;
+    this->PrefetchInputSource = nullptr;
+    this->PrefetchInputMTime = 0;
+    this->PrefetchInputGeneration = 0;
+    this->LastInput = nullptr;
+    this->LastInputMTime = 0;
+    }
+
+  ~vtkInternal()
+    {
+    this->StopPrefetch();
+    }
+
+  /// Move the entry to the front of the list and return it.
+  /// Must be called with CacheMutex locked.
+  CacheEntry* Find(const std::string& key)
+    {
+    std::map<std::string, CacheEntryListType::iterator>::iterator it = this->CacheEntryMap.find(key);
+    if (it == this->CacheEntryMap.end())
+      {
+      return nullptr;
+      }
+    this->CacheEntries.splice(this->CacheEntries.begin(), this->CacheEntries, it->second);
+    return &(this->CacheEntries.front());
+    }
+
+  /// Must be called with CacheMutex locked.
+  void Add(const std::string& key, vtkImageData* image, vtkImageStencilData* stencil, double memoryLimit)
+    {
+    this->Remove(key);
+    CacheEntry entry;
+    entry.Key = key;
+    entry.Image = vtkSmartPointer<vtkImageData>::New();
+    entry.Image->ShallowCopy(image);
+    entry.Size = image->GetActualMemorySize() / 1024.0;
+    if (stencil)
+      {
+      entry.Stencil = vtkSmartPointer<vtkImageStencilData>::New();
+      entry.Stencil->DeepCopy(stencil);
+      entry.Size += stencil->GetActualMemorySize() / 1024.0;
+      }
+    if (entry.Size > memoryLimit)
+      {
+      return;
+      }
+    this->CacheEntries.push_front(entry);
+    this->CacheEntryMap[key] = this->CacheEntries.begin();
+    this->CacheMemorySize += entry.Size;
+    // Evict least recently used images
+    while (this->CacheMemorySize > memoryLimit && !this->CacheEntries.empty())
+      {
+      this->Remove(this->CacheEntries.back().Key);
+      }
+    }
+
+  /// Must be called with CacheMutex locked.
+  void Remove(const std::string& key)
+    {
+    std::map<std::string, CacheEntryListType::iterator>::iterator it = this->CacheEntryMap.find(key);
+    if (it == this->CacheEntryMap.end())
+      {
+      return;
+      }
+    this->CacheMemorySize -= it->second->Size;
+    this->CacheEntries.erase(it->second);
+    this->CacheEntryMap.erase(it);
+    }
+
+  /// Must be called with CacheMutex locked.
+  void Clear()
+    {
+    this->CacheEntries.clear();
+    this->CacheEntryMap.clear();
+    this->CacheMemorySize = 0.0;
+    }
+
+  void StartPrefetch()
+    {
+    if (this->PrefetchThread.joinable())
+      {
+      return;
+      }
+    this->StopPrefetchThread = false;
+    this->PrefetchThread = std::thread(&vtkInternal::PrefetchLoop, this);
+    }
+
+  void StopPrefetch()
+    {
+    if (!this->PrefetchThread.joinable())
+      {
+      return;
+      }
+      {
+      std::lock_guard<std::mutex> lock(this->PrefetchMutex);
+      this->StopPrefetchThread = true;
+      this->PrefetchRequests.clear();
+      }
+    this->PrefetchCondition.notify_all();
+    this->PrefetchThread.join();
+    }
+
+  void PrefetchLoop()
+    {
+    while (true)
+      {
+      PrefetchRequest request;
+        {
+        std::unique_lock<std::mutex> lock(this->PrefetchMutex);
+        this->PrefetchCondition.wait(lock, [this]
+          { return this->StopPrefetchThread || !this->PrefetchRequests.empty(); });
+        if (this->StopPrefetchThread)
+          {
+          return;
+          }
+        request = this->PrefetchRequests.front();
+        this->PrefetchRequests.pop_front();
+        }
+      if (request.InputGeneration != this->PrefetchInputGeneration)
+        {
+        // the input has been modified since the request was made
+        continue;
+        }
+        {
+        std::lock_guard<std::mutex> lock(this->CacheMutex);
+        if (this->CacheEntryMap.find(request.Key) != this->CacheEntryMap.end())
+          {
+          // already computed
+          continue;
+          }
+        }
+      // The input is connected here so that the main thread never touches
+      // the pipeline information of the snapshot while it is in use.
+      request.Reslice->SetInputData(request.Input);
+      request.Reslice->Update();
+      std::lock_guard<std::mutex> lock(this->CacheMutex);
+      if (request.InputGeneration != this->PrefetchInputGeneration)
+        {
+        // The input voxels may have been modified while they were read,
+        // the image is discarded.
+        continue;
+        }
+      this->Add(request.Key, request.Reslice->GetOutput(),
+        request.Reslice->GetGenerateStencilOutput() ? request.Reslice->GetStencilOutput() : nullptr,
+        request.MemoryLimit);
+      ++this->NumberOfPrefetchedImages;
+      }
+    }
+
+  std::mutex CacheMutex;
+  CacheEntryListType CacheEntries; // most recently used first
+  std::map<std::string, CacheEntryListType::iterator> CacheEntryMap;
+  double CacheMemorySize;
+  unsigned long NumberOfCacheHits;
+  unsigned long NumberOfCacheMisses;
+  unsigned long NumberOfPrefetchedImages;
+
+  std::thread PrefetchThread;
+  std::mutex PrefetchMutex;
+  std::condition_variable PrefetchCondition;
+  std::deque<PrefetchRequest> PrefetchRequests;
+  bool StopPrefetchThread;
+
+  // Deep copy of the input read by the prefetch thread. Only accessed from
+  // the main thread, requests keep a reference to the snapshot they use.
+  vtkSmartPointer<vtkImageData> PrefetchInput;
+  vtkImageData* PrefetchInputSource;
+  vtkMTimeType PrefetchInputMTime;
+  // Incremented by the main thread each time the input is modified.
+  std::atomic<unsigned long> PrefetchInputGeneration;
+
+  // Input of the previous execution, to detect inputs modified between updates
+  vtkImageData* LastInput;
+  vtkMTimeType LastInputMTime;
+};
+
+//------------------------------------------------------------------------------
+vtkStandardNewMacro(vtkCachedImageReslice);
+
+//----------------------------------------------------------------------------
+vtkCachedImageReslice::vtkCachedImageReslice()
+{
+  this->CacheMemoryLimit = 64.0;
+  this->Prefetch = false;
+  this->PrefetchDistance = 1;
+  this->Internal = new vtkInternal;
+}
+
+//----------------------------------------------------------------------------
+vtkCachedImageReslice::~vtkCachedImageReslice()
+{
+  delete this->Internal;
+}
+
+//----------------------------------------------------------------------------
+void vtkCachedImageReslice::SetCacheMemoryLimit(double megabytes)
+{
+  if (megabytes < 0.0)
+    {
+    megabytes = 0.0;
+    }
+  if (this->CacheMemoryLimit == megabytes)
+    {
+    return;
+    }
+  this->CacheMemoryLimit = megabytes;
+  std::lock_guard<std::mutex> lock(this->Internal->CacheMutex);
+  while (this->Internal->CacheMemorySize > this->CacheMemoryLimit && !this->Internal->CacheEntries.empty())
+    {
+    this->Internal->Remove(this->Internal->CacheEntries.back().Key);
+    }
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkCachedImageReslice::ClearCache()
+{
+  std::lock_guard<std::mutex> lock(this->Internal->CacheMutex);
+  this->Internal->Clear();
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkCachedImageReslice::GetNumberOfCacheHits()
+{
+  std::lock_guard<std::mutex> lock(this->Internal->CacheMutex);
+  return this->Internal->NumberOfCacheHits;
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkCachedImageReslice::GetNumberOfCacheMisses()
+{
+  std::lock_guard<std::mutex> lock(this->Internal->CacheMutex);
+  return this->Internal->NumberOfCacheMisses;
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkCachedImageReslice::GetNumberOfPrefetchedImages()
+{
+  std::lock_guard<std::mutex> lock(this->Internal->CacheMutex);
+  return this->Internal->NumberOfPrefetchedImages;
+}
+
+//----------------------------------------------------------------------------
+int vtkCachedImageReslice::GetNumberOfCachedImages()
+{
+  std::lock_guard<std::mutex> lock(this->Internal->CacheMutex);
+  return static_cast<int>(this->Internal->CacheEntries.size());
+}
+
+//----------------------------------------------------------------------------
+double vtkCachedImageReslice::GetCacheMemorySize()
+{
+  std::lock_guard<std::mutex> lock(this->Internal->CacheMutex);
+  return this->Internal->CacheMemorySize;
+}
+
+//----------------------------------------------------------------------------
+void vtkCachedImageReslice::ResetCacheStatistics()
+{
+  std::lock_guard<std::mutex> lock(this->Internal->CacheMutex);
+  this->Internal->NumberOfCacheHits = 0;
+  this->Internal->NumberOfCacheMisses = 0;
+  this->Internal->NumberOfPrefetchedImages = 0;
+}
+
+//----------------------------------------------------------------------------
+bool vtkCachedImageReslice::GetCacheKey(vtkImageData* input, vtkMatrix4x4* resliceMatrix,
+                                        const int updateExtent[6], std::string& key)
+{
+  if (!input || !resliceMatrix || this->GetResliceAxes() != nullptr
+    || this->GetInformationInput() != nullptr || this->GetStencil() != nullptr)
+    {
+    return false;
+    }
+  std::ostringstream keyStream;
+  keyStream.precision(17);
+  keyStream << input << ";" << input->GetMTime() << ";";
+  // Reslice matrices of the same slice are not always bitwise identical: they
+  // are computed by the slice logic and by SchedulePrefetch() with different
+  // arithmetic operations. Rounding the elements makes them share the same key.
+  for (int row = 0; row < 4; ++row)
+    {
+    for (int column = 0; column < 4; ++column)
+      {
+      keyStream << std::llround(resliceMatrix->GetElement(row, column) / VTK_CACHED_IMAGE_RESLICE_MATRIX_TOLERANCE) << ",";
+      }
+    }
+  keyStream << ";" << this->GetInterpolationMode()
+    << ";" << this->GetOutputScalarType()
+    << ";" << this->GetOutputDimensionality()
+    << ";" << this->GetSlabMode() << "," << this->GetSlabNumberOfSlices()
+    << ";" << this->GetGenerateStencilOutput()
+    << ";" << this->GetWrap() << "," << this->GetMirror() << "," << this->GetBorder();
+  double* backgroundColor = this->GetBackgroundColor();
+  double* outputSpacing = this->GetOutputSpacing();
+  double* outputOrigin = this->GetOutputOrigin();
+  keyStream << ";";
+  for (int i = 0; i < 4; ++i)
+    {
+    keyStream << backgroundColor[i] << ",";
+    }
+  keyStream << ";";
+  for (int i = 0; i < 3; ++i)
+    {
+    keyStream << outputSpacing[i] << "," << outputOrigin[i] << ",";
+    }
+  keyStream << ";";
+  for (int i = 0; i < 6; ++i)
+    {
+    keyStream << updateExtent[i] << ",";
+    }
+  key = keyStream.str();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+int vtkCachedImageReslice::RequestData(vtkInformation *request,
+                                       vtkInformationVector **inputVector,
+                                       vtkInformationVector *outputVector)
+{
+  if (this->CacheMemoryLimit <= 0.0)
+    {
+    return this->Superclass::RequestData(request, inputVector, outputVector);
+    }
+
+  vtkImageData* input = vtkImageData::GetData(inputVector[0]);
+  vtkInformation* outInfo = outputVector->GetInformationObject(0);
+  vtkImageData* output = vtkImageData::SafeDownCast(outInfo->Get(vtkDataObject::DATA_OBJECT()));
+  vtkImageStencilData* stencil = nullptr;
+  if (this->GetGenerateStencilOutput())
+    {
+    stencil = vtkImageStencilData::GetData(outputVector, 1);
+    }
+  int updateExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), updateExtent);
+
+  // Only linear transforms are cached
+  vtkHomogeneousTransform* linearTransform = vtkHomogeneousTransform::SafeDownCast(this->GetResliceTransform());
+  vtkMatrix4x4* resliceMatrix = (linearTransform ? linearTransform->GetMatrix() : nullptr);
+
+  std::string key;
+  if (!output || !this->GetCacheKey(input, resliceMatrix, updateExtent, key))
+    {
+    return this->Superclass::RequestData(request, inputVector, outputVector);
+    }
+
+  bool found = false;
+    {
+    std::lock_guard<std::mutex> lock(this->Internal->CacheMutex);
+    vtkInternal::CacheEntry* entry = this->Internal->Find(key);
+    if (entry)
+      {
+      output->ShallowCopy(entry->Image);
+      if (stencil && entry->Stencil)
+        {
+        stencil->DeepCopy(entry->Stencil);
+        }
+      ++this->Internal->NumberOfCacheHits;
+      found = true;
+      }
+    else
+      {
+      ++this->Internal->NumberOfCacheMisses;
+      }
+    }
+
+  int result = 1;
+  if (!found)
+    {
+    result = this->Superclass::RequestData(request, inputVector, outputVector);
+    if (result)
+      {
+      std::lock_guard<std::mutex> lock(this->Internal->CacheMutex);
+      this->Internal->Add(key, output, stencil, this->CacheMemoryLimit);
+      }
+    }
+
+  // Prefetching waits until the input is not modified between two updates:
+  // while the voxels are edited in place (e.g. by a segment editor effect),
+  // each update would otherwise copy the whole input for images that are
+  // invalidated by the next edit.
+  bool inputModified = (input != this->Internal->LastInput || input->GetMTime() != this->Internal->LastInputMTime);
+  this->Internal->LastInput = input;
+  this->Internal->LastInputMTime = input->GetMTime();
+  if (this->Prefetch && !inputModified)
+    {
+    this->SchedulePrefetch(input, resliceMatrix, updateExtent);
+    }
+  else if (this->Prefetch)
+    {
+    std::lock_guard<std::mutex> lock(this->Internal->PrefetchMutex);
+    this->Internal->PrefetchRequests.clear();
+    }
+  else
+    {
+    this->Internal->StopPrefetch();
+    this->Internal->PrefetchInput = nullptr;
+    this->Internal->PrefetchInputSource = nullptr;
+    }
+  return result;
+}
+
+//----------------------------------------------------------------------------
+vtkImageData* vtkCachedImageReslice::GetPrefetchInput(vtkImageData* input)
+{
+  if (this->Internal->PrefetchInput.GetPointer() == nullptr
+    || this->Internal->PrefetchInputSource != input
+    || this->Internal->PrefetchInputMTime != input->GetMTime())
+    {
+    // Pending requests and images being computed from the previous snapshot
+    // are discarded: they would never be found in the cache.
+      {
+      std::lock_guard<std::mutex> lock(this->Internal->PrefetchMutex);
+      this->Internal->PrefetchRequests.clear();
+      }
+      {
+      std::lock_guard<std::mutex> lock(this->Internal->CacheMutex);
+      ++this->Internal->PrefetchInputGeneration;
+      }
+    // A new snapshot is made instead of updating the current one, which may
+    // still be read by the prefetch thread. The voxels are copied: the input
+    // can be modified in place while the prefetch thread reads the snapshot.
+    this->Internal->PrefetchInput = vtkSmartPointer<vtkImageData>::New();
+    this->Internal->PrefetchInput->DeepCopy(input);
+    this->Internal->PrefetchInputSource = input;
+    this->Internal->PrefetchInputMTime = input->GetMTime();
+    }
+  return this->Internal->PrefetchInput;
+}
+
+//----------------------------------------------------------------------------
+void vtkCachedImageReslice::SchedulePrefetch(vtkImageData* input, vtkMatrix4x4* resliceMatrix,
+                                             const int updateExtent[6])
+{
+  // The background thread works on a snapshot of the input, with a separate
+  // reslice filter, so that it does not interfere with this pipeline. The
+  // snapshot is a deep copy: the voxels of the input can be modified in place
+  // (e.g. by segment editor effects) while neighboring slices are computed.
+  std::deque<vtkInternal::PrefetchRequest> requests;
+  for (int step = 1; step <= this->PrefetchDistance; ++step)
+    {
+    for (int direction = -1; direction <= 1; direction += 2)
+      {
+      // Translate the reslice matrix along the output z axis
+      vtkNew<vtkMatrix4x4> offsetMatrix;
+      offsetMatrix->DeepCopy(resliceMatrix);
+      double offset = direction * step * this->GetOutputSpacing()[2];
+      for (int row = 0; row < 3; ++row)
+        {
+        offsetMatrix->SetElement(row, 3,
+          resliceMatrix->GetElement(row, 3) + resliceMatrix->GetElement(row, 2) * offset);
+        }
+      vtkInternal::PrefetchRequest prefetchRequest;
+      prefetchRequest.MemoryLimit = this->CacheMemoryLimit;
+      if (!this->GetCacheKey(input, offsetMatrix.GetPointer(), updateExtent, prefetchRequest.Key))
+        {
+        return;
+        }
+        {
+        std::lock_guard<std::mutex> lock(this->Internal->CacheMutex);
+        if (this->Internal->CacheEntryMap.find(prefetchRequest.Key) != this->Internal->CacheEntryMap.end())
+          {
+          continue;
+          }
+        }
+      prefetchRequest.Input = this->GetPrefetchInput(input);
+      prefetchRequest.InputGeneration = this->Internal->PrefetchInputGeneration;
+      vtkNew<vtkTransform> offsetTransform;
+      offsetTransform->SetMatrix(offsetMatrix.GetPointer());
+      prefetchRequest.Reslice = vtkSmartPointer<vtkImageReslice>::New();
+      vtkImageReslice* reslice = prefetchRequest.Reslice;
+      reslice->SetResliceTransform(offsetTransform.GetPointer());
+      reslice->SetInterpolationMode(this->GetInterpolationMode());
+      reslice->SetOutputScalarType(this->GetOutputScalarType());
+      reslice->SetOutputDimensionality(this->GetOutputDimensionality());
+      reslice->SetSlabMode(this->GetSlabMode());
+      reslice->SetSlabNumberOfSlices(this->GetSlabNumberOfSlices());
+      reslice->SetGenerateStencilOutput(this->GetGenerateStencilOutput());
+      reslice->SetWrap(this->GetWrap());
+      reslice->SetMirror(this->GetMirror());
+      reslice->SetBorder(this->GetBorder());
+      reslice->SetOptimization(this->GetOptimization());
+      reslice->SetBackgroundColor(this->GetBackgroundColor());
+      reslice->SetOutputSpacing(this->GetOutputSpacing());
+      reslice->SetOutputOrigin(this->GetOutputOrigin());
+      reslice->SetOutputExtent(const_cast<int*>(updateExtent));
+      // the main thread already uses all the cores while rendering
+      reslice->SetNumberOfThreads(1);
+      requests.push_back(prefetchRequest);
+      }
+    }
+  if (requests.empty())
+    {
+    return;
+    }
+    {
+    // Only the neighbors of the most recent slice are useful
+    std::lock_guard<std::mutex> lock(this->Internal->PrefetchMutex);
+    this->Internal->PrefetchRequests.swap(requests);
+    }
+  this->Internal->StartPrefetch();
+  this->Internal->PrefetchCondition.notify_one();
+}
+
+//----------------------------------------------------------------------------
+void vtkCachedImageReslice::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+  os << indent << "CacheMemoryLimit: " << this->CacheMemoryLimit << "\n";
+  os << indent << "Prefetch: " << (this->Prefetch ? "on" : "off") << "\n";
+  os << indent << "PrefetchDistance: " << this->PrefetchDistance << "\n";
+  os << indent << "NumberOfCachedImages: " << this->GetNumberOfCachedImages() << "\n";
+  os << indent << "CacheMemorySize: " << this->GetCacheMemorySize() << "\n";
+  os << indent << "NumberOfCacheHits: " << this->GetNumberOfCacheHits() << "\n";
+  os << indent << "NumberOfCacheMisses: " << this->GetNumberOfCacheMisses() << "\n";
+  os << indent << "NumberOfPrefetchedImages: " << this->GetNumberOfPrefetchedImages() << "\n";
+}
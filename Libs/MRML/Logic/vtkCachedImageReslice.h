@@ -0,0 +1,110 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __vtkCachedImageReslice_h
+#define __vtkCachedImageReslice_h
+
+// VTK includes
+#include <vtkImageReslice.h>
+
+#include "vtkMRMLLogicExport.h"
+
+// STD includes
+#include <string>
+
+class vtkMatrix4x4;
+
+/// \brief Image reslice filter that keeps a least recently used cache of its outputs.
+///
+/// Reslicing is skipped if an output has already been computed for the same
+/// input (same data object and modified time), reslice transform matrix,
+/// interpolation mode and output geometry. This makes scrolling back and
+/// forth through the same slices as fast as displaying a cached image.
+/// Each filter has its own cache, images are not shared between views.
+///
+/// Only linear reslice transforms are cached. Cached images are shared with
+/// the output (shallow copy): downstream filters must not modify their input.
+///
+/// Optionally, images at neighboring offsets along the output z axis are
+/// computed in a background thread so that they are already in the cache
+/// when the user scrolls to them. The background thread reads a copy of the
+/// input, made once the input is not modified between two updates, which uses
+/// as much memory as the input. Images that it computes from an input that has
+/// been modified since are discarded.
+class VTK_MRML_LOGIC_EXPORT vtkCachedImageReslice : public vtkImageReslice
+{
+public:
+  static vtkCachedImageReslice *New();
+  vtkTypeMacro(vtkCachedImageReslice, vtkImageReslice);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /// Maximum memory used by cached images, in megabytes.
+  /// Set to 0 to disable caching. Default is 64MB.
+  void SetCacheMemoryLimit(double megabytes);
+  vtkGetMacro(CacheMemoryLimit, double);
+
+  /// Compute images at neighboring offsets in a background thread.
+  /// Off by default.
+  vtkSetMacro(Prefetch, bool);
+  vtkGetMacro(Prefetch, bool);
+  vtkBooleanMacro(Prefetch, bool);
+
+  /// Number of output z-axis steps prefetched in each direction. Default is 1.
+  vtkSetClampMacro(PrefetchDistance, int, 1, 10);
+  vtkGetMacro(PrefetchDistance, int);
+
+  /// Remove all images from the cache.
+  void ClearCache();
+
+  /// Cache statistics
+  unsigned long GetNumberOfCacheHits();
+  unsigned long GetNumberOfCacheMisses();
+  unsigned long GetNumberOfPrefetchedImages();
+  int GetNumberOfCachedImages();
+  /// Memory used by the cached images, in megabytes.
+  double GetCacheMemorySize();
+  void ResetCacheStatistics();
+
+protected:
+  vtkCachedImageReslice();
+  ~vtkCachedImageReslice() override;
+
+  int RequestData(vtkInformation *request,
+                  vtkInformationVector **inputVector,
+                  vtkInformationVector *outputVector) override;
+
+  /// Compute the cache key of an output. Returns false if the output cannot
+  /// be cached (e.g., non-linear transform).
+  bool GetCacheKey(vtkImageData* input, vtkMatrix4x4* resliceMatrix,
+                   const int updateExtent[6], std::string& key);
+
+  /// Return a deep copy of \a input that the prefetch thread can read
+  /// while the input is updated or modified in place. A new copy is made,
+  /// and pending prefetch requests are discarded, when the input is modified.
+  vtkImageData* GetPrefetchInput(vtkImageData* input);
+
+  /// Schedule computation of images at neighboring offsets
+  void SchedulePrefetch(vtkImageData* input, vtkMatrix4x4* resliceMatrix,
+                        const int updateExtent[6]);
+
+  double CacheMemoryLimit;
+  bool Prefetch;
+  int PrefetchDistance;
+
+  class vtkInternal;
+  vtkInternal* Internal;
+
+private:
+  vtkCachedImageReslice(const vtkCachedImageReslice&) = delete;
+  void operator=(const vtkCachedImageReslice&) = delete;
+};
+
+#endif
@@ -0,0 +1,314 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#include "vtkImageLabelMapToRGBA.h"
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkScalarsToColors.h>
+#include <vtkStreamingDemandDrivenPipeline.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+// Limits size of the color table if the lookup table has a very large range
+const int MAXIMUM_NUMBER_OF_LABELS = 65536;
+}
+
+//------------------------------------------------------------------------------
+vtkStandardNewMacro(vtkImageLabelMapToRGBA);
+vtkCxxSetObjectMacro(vtkImageLabelMapToRGBA, FillLookupTable, vtkScalarsToColors);
+vtkCxxSetObjectMacro(vtkImageLabelMapToRGBA, OutlineLookupTable, vtkScalarsToColors);
+
+//----------------------------------------------------------------------------
+vtkImageLabelMapToRGBA::vtkImageLabelMapToRGBA()
+{
+  this->FillLookupTable = nullptr;
+  this->OutlineLookupTable = nullptr;
+  this->Outline = 1;
+  this->Background = 0;
+  this->FirstLabel = 0;
+}
+
+//----------------------------------------------------------------------------
+vtkImageLabelMapToRGBA::~vtkImageLabelMapToRGBA()
+{
+  this->SetFillLookupTable(nullptr);
+  this->SetOutlineLookupTable(nullptr);
+}
+
+//----------------------------------------------------------------------------
+vtkMTimeType vtkImageLabelMapToRGBA::GetMTime()
+{
+  vtkMTimeType mTime = this->Superclass::GetMTime();
+  if (this->FillLookupTable)
+    {
+    mTime = std::max(mTime, this->FillLookupTable->GetMTime());
+    }
+  if (this->OutlineLookupTable)
+    {
+    mTime = std::max(mTime, this->OutlineLookupTable->GetMTime());
+    }
+  return mTime;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageLabelMapToRGBA::RequestInformation(vtkInformation *vtkNotUsed(request),
+                                               vtkInformationVector **vtkNotUsed(inputVector),
+                                               vtkInformationVector *outputVector)
+{
+  vtkInformation* outInfo = outputVector->GetInformationObject(0);
+  vtkDataObject::SetPointDataActiveScalarInfo(outInfo, VTK_UNSIGNED_CHAR, 4);
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageLabelMapToRGBA::RequestUpdateExtent(vtkInformation *vtkNotUsed(request),
+                                                vtkInformationVector **inputVector,
+                                                vtkInformationVector *outputVector)
+{
+  vtkInformation* inInfo = inputVector[0]->GetInformationObject(0);
+  vtkInformation* outInfo = outputVector->GetInformationObject(0);
+  int inExt[6] = { 0, -1, 0, -1, 0, -1 };
+  int wholeExt[6] = { 0, -1, 0, -1, 0, -1 };
+  outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), inExt);
+  inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExt);
+  // neighbors within the outline thickness are needed to find the outline (in the slice plane only)
+  for (int axis = 0; axis < 2; ++axis)
+    {
+    inExt[axis * 2] = std::max(inExt[axis * 2] - this->Outline, wholeExt[axis * 2]);
+    inExt[axis * 2 + 1] = std::min(inExt[axis * 2 + 1] + this->Outline, wholeExt[axis * 2 + 1]);
+    }
+  inInfo->Set(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), inExt, 6);
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageLabelMapToRGBA::UpdateLabelColors()
+{
+  this->LabelColors.clear();
+  this->LabelOutlineVisible.clear();
+  this->FirstLabel = 0;
+  if (!this->FillLookupTable)
+    {
+    return;
+    }
+  double* range = this->FillLookupTable->GetRange();
+  this->FirstLabel = static_cast<int>(std::floor(range[0]));
+  int lastLabel = static_cast<int>(std::ceil(range[1]));
+  if (lastLabel - this->FirstLabel + 1 > MAXIMUM_NUMBER_OF_LABELS)
+    {
+    vtkWarningMacro("UpdateLabelColors: lookup table range is too large, only the first "
+      << MAXIMUM_NUMBER_OF_LABELS << " labels are displayed");
+    lastLabel = this->FirstLabel + MAXIMUM_NUMBER_OF_LABELS - 1;
+    }
+  int numberOfLabels = std::max(lastLabel - this->FirstLabel + 1, 1);
+  this->LabelColors.resize(numberOfLabels * 8);
+  this->LabelOutlineVisible.resize(numberOfLabels);
+
+  // Outside of the outline, the outline image contains the background value
+  unsigned char noOutlineColor[4] = { 0, 0, 0, 0 };
+  if (this->OutlineLookupTable)
+    {
+    memcpy(noOutlineColor, this->OutlineLookupTable->MapValue(this->Background), 4);
+    }
+
+  for (int labelIndex = 0; labelIndex < numberOfLabels; ++labelIndex)
+    {
+    int label = this->FirstLabel + labelIndex;
+    unsigned char fillColor[4] = { 0, 0, 0, 0 };
+    memcpy(fillColor, this->FillLookupTable->MapValue(label), 4);
+    unsigned char outlineColor[4] = { 0, 0, 0, 0 };
+    if (this->OutlineLookupTable && this->Outline > 0 && label != this->Background)
+      {
+      memcpy(outlineColor, this->OutlineLookupTable->MapValue(label), 4);
+      }
+    else
+      {
+      memcpy(outlineColor, noOutlineColor, 4);
+      }
+
+    // Fill is displayed on top of the outline
+    unsigned char* labelColors = &(this->LabelColors[labelIndex * 8]);
+    for (int colorIndex = 0; colorIndex < 2; ++colorIndex)
+      {
+      const unsigned char* underColor = (colorIndex == 0 ? noOutlineColor : outlineColor);
+      double fillAlpha = fillColor[3] / 255.0;
+      double underAlpha = underColor[3] / 255.0 * (1.0 - fillAlpha);
+      double alpha = fillAlpha + underAlpha;
+      unsigned char* color = labelColors + colorIndex * 4;
+      for (int component = 0; component < 3; ++component)
+        {
+        color[component] = (alpha > 0.0
+          ? static_cast<unsigned char>((fillColor[component] * fillAlpha + underColor[component] * underAlpha) / alpha + 0.5)
+          : 0);
+        }
+      color[3] = static_cast<unsigned char>(alpha * 255.0 + 0.5);
+      }
+    this->LabelOutlineVisible[labelIndex] = (memcmp(labelColors, labelColors + 4, 4) != 0);
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkImageLabelMapToRGBA::RequestData(vtkInformation *request,
+                                        vtkInformationVector **inputVector,
+                                        vtkInformationVector *outputVector)
+{
+  vtkImageData* input = vtkImageData::GetData(inputVector[0]);
+  if (input && input->GetPointData()->GetScalars()
+    && input->GetNumberOfScalarComponents() != 1)
+    {
+    vtkErrorMacro("RequestData: input must have a single scalar component");
+    return 0;
+    }
+  // Colors are computed once, before the threads start
+  this->UpdateLabelColors();
+  return this->Superclass::RequestData(request, inputVector, outputVector);
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void vtkImageLabelMapToRGBAExecute(vtkImageLabelMapToRGBA* self, vtkImageData* inData, T*,
+  vtkImageData* outData, int outExt[6], int wholeExt[6], int outline,
+  int firstLabel, int numberOfLabels, const unsigned char* labelColors, const unsigned char* labelOutlineVisible,
+  int threadId)
+{
+  T* inPtr = static_cast<T*>(inData->GetScalarPointerForExtent(outExt));
+  vtkIdType inInc0 = 0, inInc1 = 0, inInc2 = 0;
+  inData->GetIncrements(inInc0, inInc1, inInc2);
+  vtkIdType inIncX = 0, inIncY = 0, inIncZ = 0;
+  inData->GetContinuousIncrements(outExt, inIncX, inIncY, inIncZ);
+
+  unsigned char* outPtr = static_cast<unsigned char*>(outData->GetScalarPointerForExtent(outExt));
+  vtkIdType outIncX = 0, outIncY = 0, outIncZ = 0;
+  outData->GetContinuousIncrements(outExt, outIncX, outIncY, outIncZ);
+
+  const int lastLabelIndex = numberOfLabels - 1;
+  for (int idxZ = outExt[4]; idxZ <= outExt[5]; ++idxZ)
+    {
+    for (int idxY = outExt[2]; !self->AbortExecute && idxY <= outExt[3]; ++idxY)
+      {
+      if (threadId == 0 && idxZ == outExt[4])
+        {
+        self->UpdateProgress(static_cast<double>(idxY - outExt[2] + 1) / (outExt[3] - outExt[2] + 1));
+        }
+      for (int idxX = outExt[0]; idxX <= outExt[1]; ++idxX)
+        {
+        T label = *inPtr;
+        // values outside the lookup table range get the color of the first/last label
+        double labelIndexDouble = static_cast<double>(label) - firstLabel;
+        int labelIndex = (labelIndexDouble <= 0.0 ? 0
+          : (labelIndexDouble >= lastLabelIndex ? lastLabelIndex : static_cast<int>(labelIndexDouble)));
+        const unsigned char* color = labelColors + labelIndex * 8;
+        if (labelOutlineVisible[labelIndex])
+          {
+          // Same criteria as vtkImageLabelOutline: a pixel is on the outline if a pixel
+          // in its in-plane neighborhood has a different label or is outside of the image.
+          bool onOutline = false;
+          for (int hoodY = -outline; !onOutline && hoodY <= outline; ++hoodY)
+            {
+            if (idxY + hoodY < wholeExt[2] || idxY + hoodY > wholeExt[3])
+              {
+              onOutline = true;
+              break;
+              }
+            const T* hoodPtr = inPtr + hoodY * inInc1 - outline * inInc0;
+            for (int hoodX = -outline; hoodX <= outline; ++hoodX, hoodPtr += inInc0)
+              {
+              if (idxX + hoodX < wholeExt[0] || idxX + hoodX > wholeExt[1]
+                || *hoodPtr != label)
+                {
+                onOutline = true;
+                break;
+                }
+              }
+            }
+          if (onOutline)
+            {
+            color += 4;
+            }
+          }
+        outPtr[0] = color[0];
+        outPtr[1] = color[1];
+        outPtr[2] = color[2];
+        outPtr[3] = color[3];
+        outPtr += 4;
+        ++inPtr;
+        }
+      inPtr += inIncY;
+      outPtr += outIncY;
+      }
+    inPtr += inIncZ;
+    outPtr += outIncZ;
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageLabelMapToRGBA::ThreadedRequestData(vtkInformation *vtkNotUsed(request),
+                                                 vtkInformationVector **inputVector,
+                                                 vtkInformationVector *vtkNotUsed(outputVector),
+                                                 vtkImageData ***inData, vtkImageData **outData,
+                                                 int outExt[6], int threadId)
+{
+  vtkImageData* input = inData[0][0];
+  vtkImageData* output = outData[0];
+  if (!input || !input->GetPointData()->GetScalars() || this->LabelColors.empty())
+    {
+    // nothing to display
+    unsigned char* outPtr = static_cast<unsigned char*>(output->GetScalarPointerForExtent(outExt));
+    vtkIdType outIncX = 0, outIncY = 0, outIncZ = 0;
+    output->GetContinuousIncrements(outExt, outIncX, outIncY, outIncZ);
+    vtkIdType rowSize = static_cast<vtkIdType>(outExt[1] - outExt[0] + 1) * 4;
+    for (int idxZ = outExt[4]; idxZ <= outExt[5]; ++idxZ)
+      {
+      for (int idxY = outExt[2]; idxY <= outExt[3]; ++idxY)
+        {
+        memset(outPtr, 0, rowSize);
+        outPtr += rowSize + outIncY;
+        }
+      outPtr += outIncZ;
+      }
+    return;
+    }
+
+  int wholeExt[6] = { 0, -1, 0, -1, 0, -1 };
+  inputVector[0]->GetInformationObject(0)->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExt);
+  int numberOfLabels = static_cast<int>(this->LabelOutlineVisible.size());
+
+  switch (input->GetScalarType())
+    {
+    vtkTemplateMacro(vtkImageLabelMapToRGBAExecute(this, input, static_cast<VTK_TT*>(nullptr),
+      output, outExt, wholeExt, this->Outline, this->FirstLabel, numberOfLabels,
+      &(this->LabelColors[0]), &(this->LabelOutlineVisible[0]), threadId));
+    default:
+      vtkErrorMacro("ThreadedRequestData: unsupported input scalar type " << input->GetScalarType());
+      return;
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageLabelMapToRGBA::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+  os << indent << "FillLookupTable: " << this->FillLookupTable << "\n";
+  os << indent << "OutlineLookupTable: " << this->OutlineLookupTable << "\n";
+  os << indent << "Outline: " << this->Outline << "\n";
+  os << indent << "Background: " << this->Background << "\n";
+}
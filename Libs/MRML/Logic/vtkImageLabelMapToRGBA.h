@@ -0,0 +1,103 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __vtkImageLabelMapToRGBA_h
+#define __vtkImageLabelMapToRGBA_h
+
+// VTK includes
+#include <vtkThreadedImageAlgorithm.h>
+
+#include "vtkMRMLLogicExport.h"
+
+// STD includes
+#include <vector>
+
+class vtkScalarsToColors;
+
+/// \brief Map a label image to an RGBA image showing filled and outlined labels in a single pass.
+///
+/// The output is the same as rendering the input mapped through FillLookupTable
+/// (vtkImageMapToRGBA) on top of the outline of the labels (vtkImageLabelOutline)
+/// mapped through OutlineLookupTable. All labels of the image are processed at once,
+/// using the color, opacity, and visibility (zero opacity) of each label in the lookup tables,
+/// therefore processing time does not depend on the number of labels.
+///
+/// Lookup tables are evaluated once per label at each update. Outline is only searched
+/// around labels whose outline is visible.
+class VTK_MRML_LOGIC_EXPORT vtkImageLabelMapToRGBA : public vtkThreadedImageAlgorithm
+{
+public:
+  static vtkImageLabelMapToRGBA *New();
+  vtkTypeMacro(vtkImageLabelMapToRGBA, vtkThreadedImageAlgorithm);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /// Colors of filled labels. Label values are mapped within the range of the lookup table.
+  virtual void SetFillLookupTable(vtkScalarsToColors*);
+  vtkGetObjectMacro(FillLookupTable, vtkScalarsToColors);
+
+  /// Colors of label outlines. If not set then outline is not displayed.
+  virtual void SetOutlineLookupTable(vtkScalarsToColors*);
+  vtkGetObjectMacro(OutlineLookupTable, vtkScalarsToColors);
+
+  /// Thickness of the outline in pixels. Default is 1.
+  vtkSetClampMacro(Outline, int, 0, 100);
+  vtkGetMacro(Outline, int);
+
+  /// Label value of the background, which is not outlined (usually 0)
+  vtkSetMacro(Background, int);
+  vtkGetMacro(Background, int);
+
+  /// Includes modification time of the lookup tables
+  vtkMTimeType GetMTime() override;
+
+protected:
+  vtkImageLabelMapToRGBA();
+  ~vtkImageLabelMapToRGBA() override;
+
+  int RequestInformation(vtkInformation *,
+                         vtkInformationVector **,
+                         vtkInformationVector *) override;
+
+  int RequestUpdateExtent(vtkInformation *,
+                          vtkInformationVector **,
+                          vtkInformationVector *) override;
+
+  int RequestData(vtkInformation *,
+                  vtkInformationVector **,
+                  vtkInformationVector *) override;
+
+  void ThreadedRequestData(vtkInformation *request,
+                           vtkInformationVector **inputVector,
+                           vtkInformationVector *outputVector,
+                           vtkImageData ***inData, vtkImageData **outData,
+                           int outExt[6], int threadId) override;
+
+  /// Compute colors of all labels from the lookup tables
+  void UpdateLabelColors();
+
+  vtkScalarsToColors* FillLookupTable;
+  vtkScalarsToColors* OutlineLookupTable;
+  int Outline;
+  int Background;
+
+  /// Label value corresponding to the first element in LabelColors
+  int FirstLabel;
+  /// For each label: RGBA of the label inside, RGBA of the label at its outline
+  std::vector<unsigned char> LabelColors;
+  /// For each label: non-zero if the outline has different color than the inside of the label
+  std::vector<unsigned char> LabelOutlineVisible;
+
+private:
+  vtkImageLabelMapToRGBA(const vtkImageLabelMapToRGBA&) = delete;
+  void operator=(const vtkImageLabelMapToRGBA&) = delete;
+};
+
+#endif
@@ -0,0 +1,688 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#include "vtkImageSliceCompositor.h"
+
+// VTK includes
+#include <vtkAlgorithmOutput.h>
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkImageInterpolator.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkLookupTable.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkScalarsToColors.h>
+#include <vtkSmartPointer.h>
+#include <vtkStreamingDemandDrivenPipeline.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+// Limits size of the color table if the lookup table of a label layer has a very large range
+const int MAXIMUM_NUMBER_OF_LABELS = 65536;
+
+//----------------------------------------------------------------------------
+// Convert a value within the range of the scalar type as static_cast does
+double CastToScalarType(double value, int scalarType)
+{
+  if (scalarType == VTK_DOUBLE)
+    {
+    return value;
+    }
+  if (scalarType == VTK_FLOAT)
+    {
+    return static_cast<float>(value);
+    }
+  return std::trunc(value);
+}
+
+//----------------------------------------------------------------------------
+unsigned char ClampToUnsignedChar(double value)
+{
+  if (value > 255.0)
+    {
+    return 255;
+    }
+  if (value < 0.0)
+    {
+    return 0;
+    }
+  return static_cast<unsigned char>(value);
+}
+}
+
+//----------------------------------------------------------------------------
+class vtkImageSliceCompositor::vtkInternal
+{
+public:
+  struct Layer
+  {
+    Layer()
+    {
+      this->ResliceMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+      this->Interpolator = vtkSmartPointer<vtkImageInterpolator>::New();
+    }
+
+    // Layer parameters
+    vtkSmartPointer<vtkMatrix4x4> ResliceMatrix;
+    int InterpolationMode{ VTK_NEAREST_INTERPOLATION };
+    int Mapping{ vtkImageSliceCompositor::ScalarMapping };
+    double Window{ 256.0 };
+    double Level{ 128.0 };
+    bool ApplyThreshold{ false };
+    double LowerThreshold{ 0.0 };
+    double UpperThreshold{ 0.0 };
+    vtkSmartPointer<vtkScalarsToColors> LookupTable;
+    double Opacity{ 1.0 };
+
+    // Computed from the parameters and the input at each update
+    bool Visible{ false };
+    vtkSmartPointer<vtkImageInterpolator> Interpolator;
+    double IndexMatrix[3][4];
+    int ScalarType{ VTK_DOUBLE };
+    double ScalarMinimum{ 0.0 };
+    double ScalarMaximum{ 0.0 };
+    double WindowLower{ 0.0 };
+    double WindowUpper{ 0.0 };
+    unsigned char WindowLowerValue{ 0 };
+    unsigned char WindowUpperValue{ 255 };
+    double WindowShift{ 0.0 };
+    double WindowScale{ 1.0 };
+    double ThresholdLower{ 0.0 };
+    double ThresholdUpper{ 0.0 };
+    /// ScalarMapping: RGBA of the 256 window/level values.
+    /// LabelMapping: RGBA of the labels starting from FirstLabel.
+    std::vector<unsigned char> Colors;
+    double FirstLabel{ 0.0 };
+  };
+
+  /// Compute the mapping tables of the layer. Returns false if the layer cannot be displayed.
+  static bool PrepareLayer(Layer& layer, vtkImageData* input);
+  /// Sample, map to RGBA and write a row of the output into outPtr
+  static void MapRow(Layer& layer, int x0, int y, int z, int count, unsigned char* outPtr);
+  /// Blend a row of RGBA values on top of the output row
+  static void BlendRow(const unsigned char* inPtr, unsigned char* outPtr, int count, double opacity);
+
+  std::vector<Layer> Layers;
+};
+
+//----------------------------------------------------------------------------
+bool vtkImageSliceCompositor::vtkInternal::PrepareLayer(Layer& layer, vtkImageData* input)
+{
+  layer.Visible = false;
+  layer.Colors.clear();
+  if (!input || !input->GetPointData() || !input->GetPointData()->GetScalars()
+    || input->GetNumberOfScalarComponents() != 1 || !layer.LookupTable)
+    {
+    return false;
+    }
+
+  // Output XY to input structured coordinates, as vtkImageReslice does with
+  // the input origin and spacing
+  double origin[3] = { 0.0, 0.0, 0.0 };
+  double spacing[3] = { 1.0, 1.0, 1.0 };
+  input->GetOrigin(origin);
+  input->GetSpacing(spacing);
+  for (int row = 0; row < 3; ++row)
+    {
+    for (int column = 0; column < 4; ++column)
+      {
+      layer.IndexMatrix[row][column] = layer.ResliceMatrix->GetElement(row, column) / spacing[row];
+      }
+    layer.IndexMatrix[row][3] -= origin[row] / spacing[row];
+    }
+
+  // Same sampling as vtkImageReslice with its default border of half a voxel
+  layer.Interpolator->SetInterpolationMode(layer.InterpolationMode);
+  layer.Interpolator->SetBorderModeToClamp();
+  layer.Interpolator->SetTolerance(0.5);
+  layer.Interpolator->SetOutValue(0.0);
+  layer.Interpolator->Initialize(input);
+  layer.Interpolator->Update();
+
+  layer.ScalarType = input->GetScalarType();
+  layer.ScalarMinimum = input->GetScalarTypeMin();
+  layer.ScalarMaximum = input->GetScalarTypeMax();
+
+  if (layer.Mapping == vtkImageSliceCompositor::LabelMapping)
+    {
+    // Same lookup table range as vtkMRMLLabelMapVolumeDisplayNode: one color per label
+    vtkScalarsToColors* labelLookupTable = layer.LookupTable;
+    vtkNew<vtkLookupTable> adjustedLookupTable;
+    vtkLookupTable* lookupTable = vtkLookupTable::SafeDownCast(layer.LookupTable);
+    if (lookupTable)
+      {
+      if (lookupTable->GetNumberOfTableValues() == 0)
+        {
+        return false;
+        }
+      adjustedLookupTable->DeepCopy(lookupTable);
+      if ((adjustedLookupTable->GetTableRange()[1] - adjustedLookupTable->GetTableRange()[0] + 1)
+          != adjustedLookupTable->GetNumberOfTableValues())
+        {
+        adjustedLookupTable->SetTableRange(0, adjustedLookupTable->GetNumberOfTableValues() - 1);
+        }
+      labelLookupTable = adjustedLookupTable;
+      }
+    double* range = labelLookupTable->GetRange();
+    layer.FirstLabel = std::floor(range[0]);
+    double lastLabel = std::min(std::ceil(range[1]), layer.FirstLabel + MAXIMUM_NUMBER_OF_LABELS - 1);
+    int numberOfLabels = std::max(static_cast<int>(lastLabel - layer.FirstLabel) + 1, 1);
+    std::vector<double> labels(numberOfLabels);
+    for (int labelIndex = 0; labelIndex < numberOfLabels; ++labelIndex)
+      {
+      labels[labelIndex] = layer.FirstLabel + labelIndex;
+      }
+    layer.Colors.resize(numberOfLabels * 4);
+    labelLookupTable->MapScalarsThroughTable2(labels.data(), layer.Colors.data(),
+      VTK_DOUBLE, numberOfLabels, 1, VTK_RGBA);
+    }
+  else
+    {
+    // Same clamping of window/level as vtkImageMapToWindowLevelColors
+    double window = layer.Window;
+    double windowLower = layer.Level - std::fabs(window) / 2.0;
+    double windowUpper = windowLower + std::fabs(window);
+    double adjustedLower = std::min(std::max(windowLower, layer.ScalarMinimum), layer.ScalarMaximum);
+    double adjustedUpper = std::min(std::max(windowUpper, layer.ScalarMinimum), layer.ScalarMaximum);
+    layer.WindowLower = CastToScalarType(adjustedLower, layer.ScalarType);
+    layer.WindowUpper = CastToScalarType(adjustedUpper, layer.ScalarType);
+    if (window != 0.0)
+      {
+      double lowerValue = 255.0 * (adjustedLower - windowLower) / window;
+      double upperValue = 255.0 * (adjustedUpper - windowLower) / window;
+      if (window < 0.0)
+        {
+        lowerValue += 255.0;
+        upperValue += 255.0;
+        }
+      layer.WindowLowerValue = ClampToUnsignedChar(lowerValue);
+      layer.WindowUpperValue = ClampToUnsignedChar(upperValue);
+      layer.WindowShift = window / 2.0 - layer.Level;
+      layer.WindowScale = 255.0 / window;
+      }
+    else
+      {
+      // step function at the level
+      layer.WindowLowerValue = 0;
+      layer.WindowUpperValue = 255;
+      layer.WindowShift = 0.0;
+      layer.WindowScale = 0.0;
+      }
+
+    // Same clamping of thresholds as vtkImageThreshold
+    layer.ThresholdLower = CastToScalarType(std::min(std::max(layer.LowerThreshold,
+      layer.ScalarMinimum), layer.ScalarMaximum), layer.ScalarType);
+    layer.ThresholdUpper = CastToScalarType(std::min(std::max(layer.UpperThreshold,
+      layer.ScalarMinimum), layer.ScalarMaximum), layer.ScalarType);
+
+    // Colors of window/level values, as vtkImageMapToColors
+    unsigned char luminances[256];
+    for (int luminance = 0; luminance < 256; ++luminance)
+      {
+      luminances[luminance] = static_cast<unsigned char>(luminance);
+      }
+    layer.Colors.resize(256 * 4);
+    layer.LookupTable->MapScalarsThroughTable2(luminances, layer.Colors.data(),
+      VTK_UNSIGNED_CHAR, 256, 1, VTK_RGBA);
+    }
+
+  layer.Visible = true;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageSliceCompositor::vtkInternal::MapRow(Layer& layer, int x0, int y, int z, int count, unsigned char* outPtr)
+{
+  double rowStart[3] = { 0.0, 0.0, 0.0 };
+  double step[3] = { 0.0, 0.0, 0.0 };
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    const double* matrixRow = layer.IndexMatrix[axis];
+    rowStart[axis] = matrixRow[0] * x0 + matrixRow[1] * y + matrixRow[2] * z + matrixRow[3];
+    step[axis] = matrixRow[0];
+    }
+  const bool integerScalars = (layer.ScalarType != VTK_FLOAT && layer.ScalarType != VTK_DOUBLE);
+  const unsigned char* colors = layer.Colors.data();
+  const int lastColorIndex = static_cast<int>(layer.Colors.size() / 4) - 1;
+  vtkImageInterpolator* interpolator = layer.Interpolator;
+
+  for (int x = 0; x < count; ++x, outPtr += 4)
+    {
+    double point[3] =
+      {
+      rowStart[0] + x * step[0],
+      rowStart[1] + x * step[1],
+      rowStart[2] + x * step[2]
+      };
+    // Sample the volume and convert the value to the scalar type, as vtkImageReslice
+    bool inside = interpolator->CheckBoundsIJK(point);
+    double value = 0.0;
+    if (inside)
+      {
+      interpolator->InterpolateIJK(point, &value);
+      value = std::min(std::max(value, layer.ScalarMinimum), layer.ScalarMaximum);
+      value = integerScalars ? std::floor(value + 0.5) : CastToScalarType(value, layer.ScalarType);
+      }
+
+    if (layer.Mapping == vtkImageSliceCompositor::LabelMapping)
+      {
+      double labelIndex = std::min(std::max(std::floor(value) - layer.FirstLabel, 0.0),
+        static_cast<double>(lastColorIndex));
+      memcpy(outPtr, colors + 4 * static_cast<int>(labelIndex), 4);
+      continue;
+      }
+
+    // Window/level as vtkImageMapToWindowLevelColors, colors as vtkImageMapToColors,
+    // alpha as the threshold and background stencil of vtkMRMLScalarVolumeDisplayNode.
+    unsigned char luminance = 0;
+    if (value <= layer.WindowLower)
+      {
+      luminance = layer.WindowLowerValue;
+      }
+    else if (value >= layer.WindowUpper)
+      {
+      luminance = layer.WindowUpperValue;
+      }
+    else
+      {
+      luminance = static_cast<unsigned char>((value + layer.WindowShift) * layer.WindowScale);
+      }
+    const unsigned char* color = colors + 4 * luminance;
+    outPtr[0] = color[0];
+    outPtr[1] = color[1];
+    outPtr[2] = color[2];
+    bool opaque = inside && color[3] != 0 &&
+      (!layer.ApplyThreshold || (layer.ThresholdLower <= value && value <= layer.ThresholdUpper));
+    outPtr[3] = (opaque ? 255 : 0);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageSliceCompositor::vtkInternal::BlendRow(const unsigned char* inPtr, unsigned char* outPtr, int count, double opacity)
+{
+  const float layerOpacity = static_cast<float>(opacity);
+  for (int x = 0; x < count; ++x, inPtr += 4, outPtr += 4)
+    {
+    float weight = layerOpacity * inPtr[3] / 255.0f;
+    if (weight <= 0.0f)
+      {
+      continue;
+      }
+    for (int component = 0; component < 3; ++component)
+      {
+      outPtr[component] = static_cast<unsigned char>(
+        outPtr[component] + (inPtr[component] - outPtr[component]) * weight + 0.5f);
+      }
+    }
+}
+
+//------------------------------------------------------------------------------
+vtkStandardNewMacro(vtkImageSliceCompositor);
+
+//----------------------------------------------------------------------------
+vtkImageSliceCompositor::vtkImageSliceCompositor()
+{
+  this->Internal = new vtkInternal;
+  for (int i = 0; i < 3; ++i)
+    {
+    this->OutputExtent[2 * i] = 0;
+    this->OutputExtent[2 * i + 1] = -1;
+    }
+  this->LastExecutionTime = 0.0;
+}
+
+//----------------------------------------------------------------------------
+vtkImageSliceCompositor::~vtkImageSliceCompositor()
+{
+  delete this->Internal;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageSliceCompositor::SetNumberOfLayers(int numberOfLayers)
+{
+  numberOfLayers = std::max(numberOfLayers, 0);
+  if (numberOfLayers == this->GetNumberOfLayers())
+    {
+    return;
+    }
+  this->Internal->Layers.resize(numberOfLayers);
+  this->SetNumberOfInputConnections(0, numberOfLayers);
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkImageSliceCompositor::GetNumberOfLayers()
+{
+  return static_cast<int>(this->Internal->Layers.size());
+}
+
+//----------------------------------------------------------------------------
+void vtkImageSliceCompositor::SetLayerInputConnection(int layer, vtkAlgorithmOutput* input)
+{
+  if (layer < 0 || layer >= this->GetNumberOfLayers())
+    {
+    vtkErrorMacro("SetLayerInputConnection: invalid layer index " << layer);
+    return;
+    }
+  if (this->GetNumberOfInputConnections(0) > layer && this->GetInputConnection(0, layer) == input)
+    {
+    return;
+    }
+  this->SetNthInputConnection(0, layer, input);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageSliceCompositor::SetLayerResliceMatrix(int layer, vtkMatrix4x4* xyToIJK)
+{
+  if (layer < 0 || layer >= this->GetNumberOfLayers() || !xyToIJK)
+    {
+    vtkErrorMacro("SetLayerResliceMatrix: invalid layer index " << layer << " or matrix");
+    return;
+    }
+  vtkMatrix4x4* resliceMatrix = this->Internal->Layers[layer].ResliceMatrix;
+  for (int row = 0; row < 4; ++row)
+    {
+    for (int column = 0; column < 4; ++column)
+      {
+      if (resliceMatrix->GetElement(row, column) != xyToIJK->GetElement(row, column))
+        {
+        resliceMatrix->DeepCopy(xyToIJK);
+        this->Modified();
+        return;
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageSliceCompositor::SetLayerInterpolationMode(int layer, int mode)
+{
+  if (layer < 0 || layer >= this->GetNumberOfLayers())
+    {
+    vtkErrorMacro("SetLayerInterpolationMode: invalid layer index " << layer);
+    return;
+    }
+  if (this->Internal->Layers[layer].InterpolationMode == mode)
+    {
+    return;
+    }
+  this->Internal->Layers[layer].InterpolationMode = mode;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkImageSliceCompositor::SetLayerMapping(int layer, int mapping)
+{
+  if (layer < 0 || layer >= this->GetNumberOfLayers())
+    {
+    vtkErrorMacro("SetLayerMapping: invalid layer index " << layer);
+    return;
+    }
+  if (this->Internal->Layers[layer].Mapping == mapping)
+    {
+    return;
+    }
+  this->Internal->Layers[layer].Mapping = mapping;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkImageSliceCompositor::SetLayerWindowLevel(int layer, double window, double level)
+{
+  if (layer < 0 || layer >= this->GetNumberOfLayers())
+    {
+    vtkErrorMacro("SetLayerWindowLevel: invalid layer index " << layer);
+    return;
+    }
+  vtkInternal::Layer& layerInfo = this->Internal->Layers[layer];
+  if (layerInfo.Window == window && layerInfo.Level == level)
+    {
+    return;
+    }
+  layerInfo.Window = window;
+  layerInfo.Level = level;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkImageSliceCompositor::SetLayerThreshold(int layer, bool apply, double lower, double upper)
+{
+  if (layer < 0 || layer >= this->GetNumberOfLayers())
+    {
+    vtkErrorMacro("SetLayerThreshold: invalid layer index " << layer);
+    return;
+    }
+  vtkInternal::Layer& layerInfo = this->Internal->Layers[layer];
+  if (layerInfo.ApplyThreshold == apply && layerInfo.LowerThreshold == lower && layerInfo.UpperThreshold == upper)
+    {
+    return;
+    }
+  layerInfo.ApplyThreshold = apply;
+  layerInfo.LowerThreshold = lower;
+  layerInfo.UpperThreshold = upper;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkImageSliceCompositor::SetLayerLookupTable(int layer, vtkScalarsToColors* lookupTable)
+{
+  if (layer < 0 || layer >= this->GetNumberOfLayers())
+    {
+    vtkErrorMacro("SetLayerLookupTable: invalid layer index " << layer);
+    return;
+    }
+  if (this->Internal->Layers[layer].LookupTable == lookupTable)
+    {
+    return;
+    }
+  this->Internal->Layers[layer].LookupTable = lookupTable;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkImageSliceCompositor::SetLayerOpacity(int layer, double opacity)
+{
+  if (layer < 0 || layer >= this->GetNumberOfLayers())
+    {
+    vtkErrorMacro("SetLayerOpacity: invalid layer index " << layer);
+    return;
+    }
+  opacity = std::min(std::max(opacity, 0.0), 1.0);
+  if (this->Internal->Layers[layer].Opacity == opacity)
+    {
+    return;
+    }
+  this->Internal->Layers[layer].Opacity = opacity;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+double vtkImageSliceCompositor::GetLayerOpacity(int layer)
+{
+  if (layer < 0 || layer >= this->GetNumberOfLayers())
+    {
+    vtkErrorMacro("GetLayerOpacity: invalid layer index " << layer);
+    return 0.0;
+    }
+  return this->Internal->Layers[layer].Opacity;
+}
+
+//----------------------------------------------------------------------------
+vtkMTimeType vtkImageSliceCompositor::GetMTime()
+{
+  vtkMTimeType mTime = this->Superclass::GetMTime();
+  for (const vtkInternal::Layer& layer : this->Internal->Layers)
+    {
+    if (layer.LookupTable)
+      {
+      mTime = std::max(mTime, layer.LookupTable->GetMTime());
+      }
+    }
+  return mTime;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageSliceCompositor::FillInputPortInformation(int vtkNotUsed(port), vtkInformation* info)
+{
+  info->Set(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkImageData");
+  info->Set(vtkAlgorithm::INPUT_IS_REPEATABLE(), 1);
+  info->Set(vtkAlgorithm::INPUT_IS_OPTIONAL(), 1);
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageSliceCompositor::RequestInformation(vtkInformation *vtkNotUsed(request),
+                                                vtkInformationVector **vtkNotUsed(inputVector),
+                                                vtkInformationVector *outputVector)
+{
+  vtkInformation* outInfo = outputVector->GetInformationObject(0);
+  double origin[3] = { 0.0, 0.0, 0.0 };
+  double spacing[3] = { 1.0, 1.0, 1.0 };
+  outInfo->Set(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), this->OutputExtent, 6);
+  outInfo->Set(vtkDataObject::ORIGIN(), origin, 3);
+  outInfo->Set(vtkDataObject::SPACING(), spacing, 3);
+  vtkDataObject::SetPointDataActiveScalarInfo(outInfo, VTK_UNSIGNED_CHAR, 4);
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageSliceCompositor::RequestUpdateExtent(vtkInformation *vtkNotUsed(request),
+                                                 vtkInformationVector **inputVector,
+                                                 vtkInformationVector *vtkNotUsed(outputVector))
+{
+  // Any voxel of the volumes may be visible in the slice
+  for (int inputIndex = 0; inputIndex < inputVector[0]->GetNumberOfInformationObjects(); ++inputIndex)
+    {
+    vtkInformation* inInfo = inputVector[0]->GetInformationObject(inputIndex);
+    int wholeExt[6] = { 0, -1, 0, -1, 0, -1 };
+    inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExt);
+    inInfo->Set(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), wholeExt, 6);
+    }
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageSliceCompositor::RequestData(vtkInformation *request,
+                                         vtkInformationVector **inputVector,
+                                         vtkInformationVector *outputVector)
+{
+  double startTime = vtkTimerLog::GetUniversalTime();
+
+  int numberOfInputs = inputVector[0]->GetNumberOfInformationObjects();
+  for (int layerIndex = 0; layerIndex < this->GetNumberOfLayers(); ++layerIndex)
+    {
+    vtkImageData* input = (layerIndex < numberOfInputs ? vtkImageData::GetData(inputVector[0], layerIndex) : nullptr);
+    if (!vtkInternal::PrepareLayer(this->Internal->Layers[layerIndex], input) && input)
+      {
+      vtkWarningMacro("RequestData: layer " << layerIndex << " is not displayed, it requires"
+        << " a single-component volume and a lookup table");
+      }
+    }
+
+  int result = this->Superclass::RequestData(request, inputVector, outputVector);
+
+  for (vtkInternal::Layer& layer : this->Internal->Layers)
+    {
+    layer.Interpolator->ReleaseData();
+    }
+  this->LastExecutionTime = vtkTimerLog::GetUniversalTime() - startTime;
+  return result;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageSliceCompositor::ThreadedRequestData(vtkInformation *vtkNotUsed(request),
+                                                  vtkInformationVector **vtkNotUsed(inputVector),
+                                                  vtkInformationVector *vtkNotUsed(outputVector),
+                                                  vtkImageData ***vtkNotUsed(inData), vtkImageData **outData,
+                                                  int outExt[6], int vtkNotUsed(threadId))
+{
+  vtkImageData* output = outData[0];
+  const int rowLength = outExt[1] - outExt[0] + 1;
+  if (rowLength <= 0 || outExt[2] > outExt[3] || outExt[4] > outExt[5])
+    {
+    return;
+    }
+  unsigned char* outPtr = static_cast<unsigned char*>(output->GetScalarPointerForExtent(outExt));
+  vtkIdType outIncX = 0;
+  vtkIdType outIncY = 0;
+  vtkIdType outIncZ = 0;
+  output->GetContinuousIncrements(outExt, outIncX, outIncY, outIncZ);
+
+  std::vector<vtkInternal::Layer>& layers = this->Internal->Layers;
+  const int numberOfLayers = static_cast<int>(layers.size());
+  std::vector<unsigned char> layerRow(rowLength * 4);
+  for (int z = outExt[4]; z <= outExt[5]; ++z)
+    {
+    for (int y = outExt[2]; y <= outExt[3]; ++y)
+      {
+      // The first layer is copied to the output, as in vtkImageBlend
+      if (numberOfLayers > 0 && layers[0].Visible)
+        {
+        vtkInternal::MapRow(layers[0], outExt[0], y, z, rowLength, outPtr);
+        }
+      else
+        {
+        memset(outPtr, 0, rowLength * 4);
+        }
+      for (int layerIndex = 1; layerIndex < numberOfLayers; ++layerIndex)
+        {
+        vtkInternal::Layer& layer = layers[layerIndex];
+        if (!layer.Visible || layer.Opacity <= 0.0)
+          {
+          continue;
+          }
+        vtkInternal::MapRow(layer, outExt[0], y, z, rowLength, layerRow.data());
+        vtkInternal::BlendRow(layerRow.data(), outPtr, rowLength, layer.Opacity);
+        }
+      outPtr += rowLength * 4 + outIncY;
+      }
+    outPtr += outIncZ;
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageSliceCompositor::CopyAttributeData(vtkImageData *vtkNotUsed(in), vtkImageData *vtkNotUsed(out),
+                                                vtkInformationVector** vtkNotUsed(inputVector))
+{
+}
+
+//----------------------------------------------------------------------------
+void vtkImageSliceCompositor::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+  os << indent << "OutputExtent: " << this->OutputExtent[0] << " " << this->OutputExtent[1] << " "
+     << this->OutputExtent[2] << " " << this->OutputExtent[3] << " "
+     << this->OutputExtent[4] << " " << this->OutputExtent[5] << "\n";
+  os << indent << "LastExecutionTime: " << this->LastExecutionTime << "\n";
+  os << indent << "NumberOfLayers: " << this->GetNumberOfLayers() << "\n";
+  for (int layerIndex = 0; layerIndex < this->GetNumberOfLayers(); ++layerIndex)
+    {
+    const vtkInternal::Layer& layer = this->Internal->Layers[layerIndex];
+    os << indent << "Layer " << layerIndex << ":"
+       << " Mapping: " << (layer.Mapping == LabelMapping ? "Label" : "Scalar")
+       << " InterpolationMode: " << layer.InterpolationMode
+       << " Window: " << layer.Window << " Level: " << layer.Level
+       << " ApplyThreshold: " << (layer.ApplyThreshold ? "on" : "off")
+       << " Threshold: " << layer.LowerThreshold << " " << layer.UpperThreshold
+       << " Opacity: " << layer.Opacity << "\n";
+    }
+}
@@ -0,0 +1,132 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __vtkImageSliceCompositor_h
+#define __vtkImageSliceCompositor_h
+
+// VTK includes
+#include <vtkThreadedImageAlgorithm.h>
+
+#include "vtkMRMLLogicExport.h"
+
+class vtkAlgorithmOutput;
+class vtkMatrix4x4;
+class vtkScalarsToColors;
+
+/// \brief Reslice, color and blend all the layers of a slice view in a single pass.
+///
+/// Each layer is a single-component volume (input connection of the layer index)
+/// displayed with:
+/// - a transform from output XY coordinates to input IJK coordinates and an
+///   interpolation mode, as used by vtkImageReslice in vtkMRMLSliceLayerLogic
+/// - a color mapping: ScalarMapping applies window/level to 0-255, a lookup table
+///   and an optional threshold (as vtkMRMLScalarVolumeDisplayNode), LabelMapping
+///   maps values directly through a lookup table (as vtkMRMLLabelMapVolumeDisplayNode)
+/// - an opacity: as in vtkImageBlend, the first layer is copied to the output and the
+///   following layers are blended on top of it with the product of their opacity and alpha.
+///
+/// Each output row is computed for all the layers at once: voxels are sampled,
+/// mapped to colors and blended without intermediate images. The output extent
+/// is split between threads, therefore all the layers of the view are resliced
+/// concurrently.
+class VTK_MRML_LOGIC_EXPORT vtkImageSliceCompositor : public vtkThreadedImageAlgorithm
+{
+public:
+  static vtkImageSliceCompositor *New();
+  vtkTypeMacro(vtkImageSliceCompositor, vtkThreadedImageAlgorithm);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  enum LayerMappings
+  {
+    ScalarMapping,
+    LabelMapping
+  };
+
+  /// Number of layers. Parameters of the existing layers are kept.
+  void SetNumberOfLayers(int numberOfLayers);
+  int GetNumberOfLayers();
+
+  /// Volume displayed in the layer
+  void SetLayerInputConnection(int layer, vtkAlgorithmOutput* input);
+
+  /// Transform from output XY coordinates to input IJK coordinates (must be affine)
+  void SetLayerResliceMatrix(int layer, vtkMatrix4x4* xyToIJK);
+
+  /// VTK_NEAREST_INTERPOLATION (default), VTK_LINEAR_INTERPOLATION or VTK_CUBIC_INTERPOLATION
+  void SetLayerInterpolationMode(int layer, int mode);
+
+  /// ScalarMapping (default) or LabelMapping
+  void SetLayerMapping(int layer, int mapping);
+
+  /// Window/level of ScalarMapping. Default is 256/128.
+  void SetLayerWindowLevel(int layer, double window, double level);
+
+  /// Threshold of ScalarMapping: voxels out of [lower, upper] are transparent. Off by default.
+  void SetLayerThreshold(int layer, bool apply, double lower, double upper);
+
+  /// Lookup table of the layer. Layers without lookup table are not displayed.
+  void SetLayerLookupTable(int layer, vtkScalarsToColors* lookupTable);
+
+  /// Opacity of the layer. Ignored for the first layer. Default is 1.
+  void SetLayerOpacity(int layer, double opacity);
+  double GetLayerOpacity(int layer);
+
+  /// Extent of the output image. Output origin is 0 and spacing is 1, as
+  /// the reslice filters of slice layers.
+  vtkSetVector6Macro(OutputExtent, int);
+  vtkGetVector6Macro(OutputExtent, int);
+
+  /// Time (in seconds) spent computing the output at the last update.
+  vtkGetMacro(LastExecutionTime, double);
+
+  /// Includes modification time of the lookup tables
+  vtkMTimeType GetMTime() override;
+
+protected:
+  vtkImageSliceCompositor();
+  ~vtkImageSliceCompositor() override;
+
+  int FillInputPortInformation(int port, vtkInformation* info) override;
+
+  int RequestInformation(vtkInformation *,
+                         vtkInformationVector **,
+                         vtkInformationVector *) override;
+
+  int RequestUpdateExtent(vtkInformation *,
+                          vtkInformationVector **,
+                          vtkInformationVector *) override;
+
+  int RequestData(vtkInformation *,
+                  vtkInformationVector **,
+                  vtkInformationVector *) override;
+
+  void ThreadedRequestData(vtkInformation *request,
+                           vtkInformationVector **inputVector,
+                           vtkInformationVector *outputVector,
+                           vtkImageData ***inData, vtkImageData **outData,
+                           int outExt[6], int threadId) override;
+
+  /// Point data of the volumes does not apply to the output
+  void CopyAttributeData(vtkImageData *in, vtkImageData *out,
+                         vtkInformationVector** inputVector) override;
+
+  int OutputExtent[6];
+  double LastExecutionTime;
+
+  class vtkInternal;
+  vtkInternal* Internal;
+
+private:
+  vtkImageSliceCompositor(const vtkImageSliceCompositor&) = delete;
+  void operator=(const vtkImageSliceCompositor&) = delete;
+};
+
+#endif
@@ -23,6 +23,7 @@
 #include "vtkMRMLDiffusionTensorVolumeDisplayNode.h"
 #include "vtkMRMLDiffusionTensorVolumeSliceDisplayNode.h"
 #include "vtkMRMLScene.h"
+#include "vtkMRMLTransformGridCache.h"
 #include "vtkMRMLTransformNode.h"
 
 // VTK includes
@@ -111,6 +112,10 @@ vtkMRMLSliceLayerLogic::vtkMRMLSliceLayerLogic()
   this->XYToIJKTransform = vtkGeneralTransform ::New();
   this->UVWToIJKTransform = vtkGeneralTransform ::New();
 
+  this->TransformGridCache = vtkMRMLTransformGridCache::New();
+  this->TransformGridCache->SetTransformFromWorld(true);
+  this->TransformGridCacheEnabled = false;
+
   this->IsLabelLayer = 0;
 
   this->AssignAttributeTensorsToScalars= vtkAssignAttribute::New();
@@ -121,7 +126,7 @@ vtkMRMLSliceLayerLogic::vtkMRMLSliceLayerLogic()
   this->AssignAttributeScalarsToTensorsUVW->Assign(vtkDataSetAttributes::SCALARS, vtkDataSetAttributes::TENSORS, vtkAssignAttribute::POINT_DATA);
 
   // Create the parts for the scalar layer pipeline
-  this->Reslice = vtkImageReslice::New();
+  this->Reslice = vtkCachedImageReslice::New();
   this->ResliceUVW = vtkImageReslice::New();
   this->LabelOutline = vtkImageLabelOutline::New();
   this->LabelOutlineUVW = vtkImageLabelOutline::New();
@@ -168,6 +173,7 @@ vtkMRMLSliceLayerLogic::~vtkMRMLSliceLayerLogic()
   this->SetVolumeNode(nullptr);
   this->XYToIJKTransform->Delete();
   this->UVWToIJKTransform->Delete();
+  this->TransformGridCache->Delete();
 
   this->Reslice->SetInputConnection( nullptr );
   this->ResliceUVW->SetInputConnection( nullptr );
@@ -514,8 +520,28 @@ void vtkMRMLSliceLayerLogic::UpdateTransforms()
     {
     // Apply the transform, if it exists
     vtkMRMLTransformNode *transformNode = this->VolumeNode->GetParentTransformNode();
-    if ( transformNode != nullptr )
+    if ( transformNode != nullptr && this->TransformGridCacheEnabled && !transformNode->IsTransformToWorldLinear() )
+      {
+      // Approximate the non-linear transform in the region of the volume
+      // (with a small margin to avoid clamping of displacements at the volume boundary)
+      double bounds[6] = { 0.0, -1.0, 0.0, -1.0, 0.0, -1.0 };
+      this->VolumeNode->GetRASBounds(bounds);
+      double margin = 2.0 * this->TransformGridCache->GetGridSpacing();
+      for (int axis = 0; axis < 3; ++axis)
+        {
+        bounds[axis * 2] -= margin;
+        bounds[axis * 2 + 1] += margin;
+        }
+      this->TransformGridCache->SetTransformNode(transformNode);
+      this->TransformGridCache->SetBounds(bounds);
+      // The proxy switches to the grid when it is computed, without updating the transforms again
+      vtkAbstractTransform* worldTransform = this->TransformGridCache->GetProxyTransform();
+      this->XYToIJKTransform->Concatenate(worldTransform);
+      this->UVWToIJKTransform->Concatenate(worldTransform);
+      }
+    else if ( transformNode != nullptr )
       {
+      this->TransformGridCache->SetTransformNode(nullptr);
       vtkNew<vtkGeneralTransform> worldTransform;
       worldTransform->Identity();
       transformNode->GetTransformFromWorld(worldTransform.GetPointer());
@@ -524,6 +550,10 @@ void vtkMRMLSliceLayerLogic::UpdateTransforms()
       this->XYToIJKTransform->Concatenate(worldTransform.GetPointer());
       this->UVWToIJKTransform->Concatenate(worldTransform.GetPointer());
       }
+    else
+      {
+      this->TransformGridCache->SetTransformNode(nullptr);
+      }
 
     vtkNew<vtkMatrix4x4> rasToIJK;
     this->VolumeNode->GetRASToIJKMatrix(rasToIJK.GetPointer());
@@ -909,6 +939,58 @@ void vtkMRMLSliceLayerLogic::UpdateGlyphs()
     }
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLSliceLayerLogic::SetResliceCacheMemoryLimit(double megabytes)
+{
+  this->Reslice->SetCacheMemoryLimit(megabytes);
+}
+
+//----------------------------------------------------------------------------
+double vtkMRMLSliceLayerLogic::GetResliceCacheMemoryLimit()
+{
+  return this->Reslice->GetCacheMemoryLimit();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSliceLayerLogic::SetResliceCachePrefetch(bool prefetch)
+{
+  this->Reslice->SetPrefetch(prefetch);
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLSliceLayerLogic::GetResliceCachePrefetch()
+{
+  return this->Reslice->GetPrefetch();
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkMRMLSliceLayerLogic::GetResliceCacheHits()
+{
+  return this->Reslice->GetNumberOfCacheHits();
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkMRMLSliceLayerLogic::GetResliceCacheMisses()
+{
+  return this->Reslice->GetNumberOfCacheMisses();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSliceLayerLogic::SetTransformGridCacheEnabled(bool enabled)
+{
+  if (this->TransformGridCacheEnabled == enabled)
+    {
+    return;
+    }
+  this->TransformGridCacheEnabled = enabled;
+  if (!enabled)
+    {
+    this->TransformGridCache->SetTransformNode(nullptr);
+    }
+  this->UpdateTransforms();
+  this->Modified();
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLSliceLayerLogic::PrintSelf(ostream& os, vtkIndent indent)
 {
@@ -918,6 +1000,7 @@ void vtkMRMLSliceLayerLogic::PrintSelf(ostream& os, vtkIndent indent)
   nextIndent = indent.GetNextIndent();
 
   os << indent << "SlicerSliceLayerLogic:             " << this->GetClassName() << "\n";
+  os << indent << "TransformGridCacheEnabled: " << this->TransformGridCacheEnabled << "\n";
 
   if (this->VolumeNode)
     {
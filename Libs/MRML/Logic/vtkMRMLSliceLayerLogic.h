@@ -32,6 +32,7 @@
 #define __vtkMRMLSliceLayerLogic_h
 
 // MRMLLogic includes
+#include "vtkCachedImageReslice.h"
 #include "vtkMRMLAbstractLogic.h"
 
 // MRML includes
@@ -55,6 +56,7 @@ class vtkGeneralTransform;
 //#include <cstdlib>
 
 class vtkImageLabelOutline;
+class vtkMRMLTransformGridCache;
 class vtkTransform;
 
 class VTK_MRML_LOGIC_EXPORT vtkMRMLSliceLayerLogic
@@ -89,6 +91,38 @@ public:
   vtkGetObjectMacro (Reslice, vtkImageReslice);
   vtkGetObjectMacro (ResliceUVW, vtkImageReslice);
 
+  ///
+  /// Resliced images are cached so that slices that have already been
+  /// displayed (e.g., when scrolling back and forth) are not resliced again.
+  /// Set the memory limit (in megabytes) to 0 to disable the cache.
+  /// \sa vtkCachedImageReslice
+  void SetResliceCacheMemoryLimit(double megabytes);
+  double GetResliceCacheMemoryLimit();
+
+  ///
+  /// Reslice neighboring slices in a background thread (off by default).
+  void SetResliceCachePrefetch(bool prefetch);
+  bool GetResliceCachePrefetch();
+
+  ///
+  /// Number of reslice updates that were served from the cache or not.
+  unsigned long GetResliceCacheHits();
+  unsigned long GetResliceCacheMisses();
+
+  ///
+  /// Reslice through a displacement grid that approximates the non-linear
+  /// transform of the volume (off by default). The grid is computed in a
+  /// background thread and the reslice pipeline uses it at its first update
+  /// after the grid becomes available. Until then the exact transform is used.
+  /// \sa vtkMRMLTransformGridCache
+  void SetTransformGridCacheEnabled(bool enabled);
+  vtkGetMacro(TransformGridCacheEnabled, bool);
+  vtkBooleanMacro(TransformGridCacheEnabled, bool);
+
+  ///
+  /// Access grid resolution and error bound of the transform grid cache.
+  vtkGetObjectMacro(TransformGridCache, vtkMRMLTransformGridCache);
+
   ///
   /// Select if this is a label layer or not (it currently determines if we use
   /// the label outline filter)
@@ -166,7 +200,7 @@ protected:
 
   ///
   /// the VTK class instances that implement this Logic's operations
-  vtkImageReslice *Reslice;
+  vtkCachedImageReslice *Reslice;
   vtkImageReslice *ResliceUVW;
   vtkImageLabelOutline *LabelOutline;
   vtkImageLabelOutline *LabelOutlineUVW;
@@ -179,6 +213,9 @@ protected:
   vtkGeneralTransform *XYToIJKTransform;
   vtkGeneralTransform *UVWToIJKTransform;
 
+  vtkMRMLTransformGridCache *TransformGridCache;
+  bool TransformGridCacheEnabled;
+
   int IsLabelLayer;
 
   int UpdatingTransforms;
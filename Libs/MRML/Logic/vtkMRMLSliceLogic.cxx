@@ -15,12 +15,14 @@
 // MRMLLogic includes
 #include "vtkMRMLSliceLogic.h"
 #include "vtkMRMLSliceLayerLogic.h"
+#include "vtkImageSliceCompositor.h"
 
 // MRML includes
 #include <vtkEventBroker.h>
 #include <vtkMRMLCrosshairNode.h>
 #include <vtkMRMLDiffusionTensorVolumeSliceDisplayNode.h>
 #include <vtkMRMLGlyphableVolumeDisplayNode.h>
+#include <vtkMRMLLabelMapVolumeDisplayNode.h>
 #include <vtkMRMLLinearTransformNode.h>
 #include <vtkMRMLModelNode.h>
 #include <vtkMRMLProceduralColorNode.h>
@@ -41,7 +43,9 @@
 #include <vtkImageReslice.h>
 #include <vtkImageThreshold.h>
 #include <vtkInformation.h>
+#include <vtkLookupTable.h>
 #include <vtkMath.h>
+#include <vtkMatrix4x4.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkPlaneSource.h>
@@ -56,6 +60,7 @@
 
 // STD includes
 #include <algorithm>
+#include <utility>
 
 //----------------------------------------------------------------------------
 const int vtkMRMLSliceLogic::SLICE_INDEX_ROTATED=-1;
@@ -190,8 +195,30 @@ struct BlendPipeline
   vtkNew<vtkImageAppendComponents> AddSubAppendRGBA;
   vtkNew<vtkImageCast> AddSubOutputCast;
   vtkNew<vtkImageBlend> Blend;
+  vtkNew<vtkImageSliceCompositor> Compositor;
 };
 
+namespace
+{
+//----------------------------------------------------------------------------
+// Lookup table that the volume display node uses for mapping to colors
+vtkScalarsToColors* GetDisplayLookupTable(vtkMRMLVolumeDisplayNode* displayNode)
+{
+  vtkMRMLColorNode* colorNode = displayNode->GetColorNode();
+  if (!colorNode)
+    {
+    return nullptr;
+    }
+  vtkScalarsToColors* lookupTable = colorNode->GetLookupTable();
+  vtkMRMLProceduralColorNode* proceduralColorNode = vtkMRMLProceduralColorNode::SafeDownCast(colorNode);
+  if (lookupTable == nullptr && proceduralColorNode != nullptr)
+    {
+    lookupTable = proceduralColorNode->GetColorTransferFunction();
+    }
+  return lookupTable;
+}
+}
+
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkMRMLSliceLogic);
 
@@ -221,6 +248,8 @@ vtkMRMLSliceLogic::vtkMRMLSliceLogic()
   this->ImageDataConnection = nullptr;
   this->SliceSpacing[0] = this->SliceSpacing[1] = this->SliceSpacing[2] = 1;
   this->AddingSliceModelNodes = false;
+  this->FusedCompositing = true;
+  this->FusedCompositingActive = false;
 }
 
 //----------------------------------------------------------------------------
@@ -674,6 +703,15 @@ void vtkMRMLSliceLogic::ProcessMRMLLogicsEvents()
       }
     }
 
+  // Parameters of the compositor filter are taken from the layers,
+  // keep them up-to-date even if there is no slice model
+  bool wasFusedCompositingActive = this->FusedCompositingActive;
+  this->UpdateFusedCompositing();
+  if (this->FusedCompositingActive != wasFusedCompositingActive && this->SliceNode)
+    {
+    this->UpdateImageData();
+    }
+
   // This is called when a slice layer is modified, so pass it on
   // to anyone interested in changes to this sub-pipeline
   this->Modified();
@@ -917,10 +955,12 @@ vtkAlgorithmOutput * vtkMRMLSliceLogic::GetImageDataConnection()
 //----------------------------------------------------------------------------
 void vtkMRMLSliceLogic::UpdateImageData ()
 {
+  vtkAlgorithmOutput* blendOutputPort = this->FusedCompositingActive ?
+    this->Pipeline->Compositor->GetOutputPort() : this->Pipeline->Blend->GetOutputPort();
   if (this->SliceNode->GetSliceResolutionMode() == vtkMRMLSliceNode::SliceResolutionMatch2DView)
     {
-    this->ExtractModelTexture->SetInputConnection( this->Pipeline->Blend->GetOutputPort() );
-    this->ImageDataConnection = this->Pipeline->Blend->GetOutputPort();
+    this->ExtractModelTexture->SetInputConnection( blendOutputPort );
+    this->ImageDataConnection = blendOutputPort;
     }
   else
     {
@@ -933,9 +973,9 @@ void vtkMRMLSliceLogic::UpdateImageData ()
        (this->GetForegroundLayer() != nullptr && this->GetForegroundLayer()->GetImageDataConnection() != nullptr) ||
        (this->GetLabelLayer() != nullptr && this->GetLabelLayer()->GetImageDataConnection() != nullptr) )
     {
-    if (this->ImageDataConnection == nullptr || this->Pipeline->Blend->GetOutputPort()->GetMTime() > this->ImageDataConnection->GetMTime())
+    if (this->ImageDataConnection != blendOutputPort)
       {
-      this->ImageDataConnection = this->Pipeline->Blend->GetOutputPort();
+      this->ImageDataConnection = blendOutputPort;
       }
     }
   else
@@ -1111,6 +1151,15 @@ void vtkMRMLSliceLogic::UpdatePipeline()
       modified = 1;
       }
 
+    bool wasFusedCompositingActive = this->FusedCompositingActive;
+    vtkMTimeType oldCompositorMTime = this->Pipeline->Compositor->GetMTime();
+    this->UpdateFusedCompositing();
+    if (this->FusedCompositingActive != wasFusedCompositingActive ||
+        this->Pipeline->Compositor->GetMTime() > oldCompositorMTime)
+      {
+      modified = 1;
+      }
+
     //Models
     this->UpdateImageData();
     vtkMRMLDisplayNode* displayNode = this->SliceModelNode ? this->SliceModelNode->GetModelDisplayNode() : nullptr;
@@ -1230,6 +1279,11 @@ void vtkMRMLSliceLogic::PrintSelf(ostream& os, vtkIndent indent)
     os << indent << "BlendUVW: (none)\n";
     }
 
+  os << indent << "FusedCompositing: " << (this->FusedCompositing ? "on" : "off") << "\n";
+  os << indent << "FusedCompositingActive: " << (this->FusedCompositingActive ? "true" : "false") << "\n";
+  os << indent << "Compositor: ";
+  this->Pipeline->Compositor->PrintSelf(os, nextIndent);
+
   os << indent << "SLICE_MODEL_NODE_NAME_SUFFIX: " << this->SLICE_MODEL_NODE_NAME_SUFFIX << "\n";
 
 }
@@ -2429,3 +2483,182 @@ vtkImageBlend* vtkMRMLSliceLogic::GetBlendUVW()
 {
   return this->PipelineUVW->Blend.GetPointer();
 }
+
+//----------------------------------------------------------------------------
+vtkImageSliceCompositor* vtkMRMLSliceLogic::GetCompositor()
+{
+  return this->Pipeline->Compositor.GetPointer();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSliceLogic::SetFusedCompositing(bool fused)
+{
+  if (this->FusedCompositing == fused)
+    {
+    return;
+    }
+  this->FusedCompositing = fused;
+  this->UpdatePipeline();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+double vtkMRMLSliceLogic::GetLastCompositingTime()
+{
+  return this->FusedCompositingActive ? this->Pipeline->Compositor->GetLastExecutionTime() : 0.0;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSliceLogic::UpdateFusedCompositing()
+{
+  vtkImageSliceCompositor* compositor = this->Pipeline->Compositor.GetPointer();
+  bool active = false;
+  if (this->FusedCompositing && this->SliceNode && this->SliceCompositeNode)
+    {
+    vtkMRMLSliceLayerLogic* backgroundLayer =
+      (this->BackgroundLayer && this->BackgroundLayer->GetImageDataConnection()) ? this->BackgroundLayer : nullptr;
+    vtkMRMLSliceLayerLogic* foregroundLayer =
+      (this->ForegroundLayer && this->ForegroundLayer->GetImageDataConnection()) ? this->ForegroundLayer : nullptr;
+    vtkMRMLSliceLayerLogic* labelLayer =
+      (this->LabelLayer && this->LabelLayer->GetImageDataConnection()) ? this->LabelLayer : nullptr;
+    double foregroundOpacity = this->SliceCompositeNode->GetForegroundOpacity();
+
+    // Same layers as BlendPipeline::AddLayers. Add and subtract are not supported.
+    int sliceCompositing = this->SliceCompositeNode->GetCompositing();
+    if ((sliceCompositing == vtkMRMLSliceCompositeNode::Add || sliceCompositing == vtkMRMLSliceCompositeNode::Subtract)
+      && (!backgroundLayer || !foregroundLayer))
+      {
+      sliceCompositing = vtkMRMLSliceCompositeNode::Alpha;
+      }
+    std::deque<std::pair<vtkMRMLSliceLayerLogic*, double> > layers;
+    if (sliceCompositing == vtkMRMLSliceCompositeNode::Alpha)
+      {
+      if (backgroundLayer)
+        {
+        layers.emplace_back(backgroundLayer, 1.0);
+        }
+      if (foregroundLayer)
+        {
+        layers.emplace_back(foregroundLayer, foregroundOpacity);
+        }
+      }
+    else if (sliceCompositing == vtkMRMLSliceCompositeNode::ReverseAlpha)
+      {
+      if (foregroundLayer)
+        {
+        layers.emplace_back(foregroundLayer, 1.0);
+        }
+      if (backgroundLayer)
+        {
+        layers.emplace_back(backgroundLayer, foregroundOpacity);
+        }
+      }
+    if (labelLayer && (sliceCompositing == vtkMRMLSliceCompositeNode::Alpha
+      || sliceCompositing == vtkMRMLSliceCompositeNode::ReverseAlpha))
+      {
+      layers.emplace_back(labelLayer, this->SliceCompositeNode->GetLabelOpacity());
+      }
+
+    active = !layers.empty();
+    if (active)
+      {
+      compositor->SetNumberOfLayers(static_cast<int>(layers.size()));
+      int layerIndex = 0;
+      for (const std::pair<vtkMRMLSliceLayerLogic*, double>& layer : layers)
+        {
+        if (!this->UpdateCompositorLayer(layerIndex++, layer.first, layer.second))
+          {
+          active = false;
+          break;
+          }
+        }
+      }
+    if (active)
+      {
+      // all layers are resliced to the slice dimensions
+      compositor->SetOutputExtent(layers.front().first->GetReslice()->GetOutputExtent());
+      }
+    }
+  if (!active)
+    {
+    // release the volumes
+    compositor->SetNumberOfLayers(0);
+    }
+  this->FusedCompositingActive = active;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLSliceLogic::UpdateCompositorLayer(int layerIndex, vtkMRMLSliceLayerLogic* layerLogic, double opacity)
+{
+  vtkImageSliceCompositor* compositor = this->Pipeline->Compositor.GetPointer();
+  vtkMRMLVolumeNode* volumeNode = layerLogic->GetVolumeNode();
+  vtkMRMLVolumeDisplayNode* displayNode = layerLogic->GetVolumeDisplayNode();
+  vtkImageReslice* reslice = layerLogic->GetReslice();
+  vtkImageData* imageData = volumeNode ? volumeNode->GetImageData() : nullptr;
+  if (!displayNode || !imageData || !reslice || reslice->GetNumberOfInputConnections(0) != 1
+    || imageData->GetNumberOfScalarComponents() != 1)
+    {
+    return false;
+    }
+
+  // Only the display pipelines of scalar and labelmap volumes are replicated,
+  // subclasses (vector, tensor...) use their own pipeline.
+  bool labelMap = (strcmp(displayNode->GetClassName(), "vtkMRMLLabelMapVolumeDisplayNode") == 0);
+  vtkMRMLScalarVolumeDisplayNode* scalarDisplayNode =
+    (strcmp(displayNode->GetClassName(), "vtkMRMLScalarVolumeDisplayNode") == 0) ?
+    vtkMRMLScalarVolumeDisplayNode::SafeDownCast(displayNode) : nullptr;
+  if (!labelMap && !scalarDisplayNode)
+    {
+    return false;
+    }
+  if (labelMap && layerLogic->GetIsLabelLayer() && this->SliceNode->GetUseLabelOutline())
+    {
+    return false;
+    }
+  if (scalarDisplayNode && scalarDisplayNode->GetWindow() == 0.0)
+    {
+    return false;
+    }
+
+  // Non-linear transforms are resliced through a general transform
+  vtkTransform* resliceTransform = vtkTransform::SafeDownCast(reslice->GetResliceTransform());
+  if (!resliceTransform)
+    {
+    return false;
+    }
+  vtkMatrix4x4* xyToIJK = resliceTransform->GetMatrix();
+  if (xyToIJK->GetElement(3, 0) != 0.0 || xyToIJK->GetElement(3, 1) != 0.0
+    || xyToIJK->GetElement(3, 2) != 0.0 || xyToIJK->GetElement(3, 3) != 1.0)
+    {
+    return false;
+    }
+
+  vtkScalarsToColors* lookupTable = GetDisplayLookupTable(displayNode);
+  if (!lookupTable)
+    {
+    return false;
+    }
+  vtkLookupTable* labelLookupTable = vtkLookupTable::SafeDownCast(lookupTable);
+  if (labelMap && labelLookupTable && labelLookupTable->GetNumberOfTableValues() == 0)
+    {
+    return false;
+    }
+
+  compositor->SetLayerInputConnection(layerIndex, reslice->GetInputConnection(0, 0));
+  compositor->SetLayerResliceMatrix(layerIndex, xyToIJK);
+  compositor->SetLayerInterpolationMode(layerIndex, reslice->GetInterpolationMode());
+  compositor->SetLayerLookupTable(layerIndex, lookupTable);
+  compositor->SetLayerOpacity(layerIndex, opacity);
+  if (labelMap)
+    {
+    compositor->SetLayerMapping(layerIndex, vtkImageSliceCompositor::LabelMapping);
+    }
+  else
+    {
+    compositor->SetLayerMapping(layerIndex, vtkImageSliceCompositor::ScalarMapping);
+    compositor->SetLayerWindowLevel(layerIndex, scalarDisplayNode->GetWindow(), scalarDisplayNode->GetLevel());
+    compositor->SetLayerThreshold(layerIndex, scalarDisplayNode->GetApplyThreshold() != 0,
+      scalarDisplayNode->GetLowerThreshold(), scalarDisplayNode->GetUpperThreshold());
+    }
+  return true;
+}
@@ -34,6 +34,7 @@ class vtkMRMLVolumeNode;
 class vtkAlgorithmOutput;
 class vtkCollection;
 class vtkImageBlend;
+class vtkImageSliceCompositor;
 class vtkTransform;
 class vtkImageData;
 class vtkImageReslice;
@@ -160,6 +161,29 @@ public:
   vtkImageBlend* GetBlend();
   vtkImageBlend* GetBlendUVW();
 
+  ///
+  /// Filter that reslices, colors and blends all the layers of the slice view
+  /// in a single pass, instead of the pipelines of the layers and the blend filter.
+  /// It is used if FusedCompositing is enabled and all the displayed layers are
+  /// scalar or labelmap volumes with a linear transform, blended with alpha compositing.
+  /// \sa GetFusedCompositingActive()
+  vtkImageSliceCompositor* GetCompositor();
+
+  ///
+  /// Compute the slice image with the compositor filter when possible (on by default).
+  void SetFusedCompositing(bool fused);
+  vtkGetMacro(FusedCompositing, bool);
+  vtkBooleanMacro(FusedCompositing, bool);
+
+  ///
+  /// True if the slice image is computed by the compositor filter.
+  vtkGetMacro(FusedCompositingActive, bool);
+
+  ///
+  /// Time (in seconds) spent computing the slice image at the last update.
+  /// Only measured when the compositor filter is active, returns 0 otherwise.
+  double GetLastCompositingTime();
+
   ///
   /// An image reslice instance to pull a single slice from the volume that
   /// represents the filmsheet display output
@@ -405,8 +429,18 @@ protected:
   /// is a relatively expensive operation.
   bool UpdateBlendLayers(vtkImageBlend* blend, const std::deque<SliceLayerInfo> &layers);
 
+  /// Set up the compositor filter from the displayed layers and
+  /// update FusedCompositingActive.
+  void UpdateFusedCompositing();
+
+  /// Set up a layer of the compositor filter from a slice layer.
+  /// Returns false if the slice layer cannot be displayed by the compositor.
+  bool UpdateCompositorLayer(int layerIndex, vtkMRMLSliceLayerLogic* layerLogic, double opacity);
+
   bool                        AddingSliceModelNodes;
   bool                        Initialized;
+  bool                        FusedCompositing;
+  bool                        FusedCompositingActive;
 
   char *                      Name;
   vtkMRMLSliceNode *          SliceNode;
@@ -46,6 +46,7 @@
 #include <vtkMRMLSliceLayerLogic.h>
 
 // MRML includes
+#include <vtkEventBroker.h>
 #include <vtkMRMLApplicationLogic.h>
 #include <vtkMRMLLayoutNode.h>
 #include <vtkMRMLScalarVolumeDisplayNode.h>
@@ -1940,9 +1941,12 @@ void qMRMLSliceControllerWidget::setSliceOffsetValue(double offset)
     applicationLogic->PauseRender();
     }
 
+  // Deliver the slice node modified events once per slider move
+  vtkEventBroker::GetInstance()->StartEventBatch();
   d->SliceLogic->StartSliceOffsetInteraction();
   d->SliceLogic->SetSliceOffset(offset);
   d->SliceLogic->EndSliceOffsetInteraction();
+  vtkEventBroker::GetInstance()->EndEventBatch();
 
   if (applicationLogic)
     {
@@ -1969,8 +1973,10 @@ void qMRMLSliceControllerWidget::trackSliceOffsetValue(double offset)
     applicationLogic->PauseRender();
     }
 
+  vtkEventBroker::GetInstance()->StartEventBatch();
   d->SliceLogic->StartSliceOffsetInteraction();
   d->SliceLogic->SetSliceOffset(offset);
+  vtkEventBroker::GetInstance()->EndEventBatch();
 
   if (applicationLogic)
     {
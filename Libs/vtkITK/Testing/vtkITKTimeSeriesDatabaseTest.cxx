@@ -0,0 +1,226 @@
+/*=========================================================================
+
+  Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+==========================================================================*/
+
+// vtkITK includes
+#include <vtkITKTimeSeriesDatabase.h>
+
+// VTK includes
+#include <vtkDoubleArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+
+// ITK includes
+#include <itkFactoryRegistration.h>
+#include <itkImageFileWriter.h>
+#include <itkImageRegionIteratorWithIndex.h>
+
+// STD includes
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+
+typedef itk::Image<short, 3> ImageType;
+
+const int NumberOfVolumes = 4;
+// Not a multiple of the database block size, so that blocks are clipped at the volume boundary
+const int Dimensions[3] = { 20, 18, 17 };
+
+//----------------------------------------------------------------------------
+short expectedValue(int volume, int i, int j, int k)
+{
+  return static_cast<short>(volume * 1000 + i * 3 + j * 5 + k * 7);
+}
+
+//----------------------------------------------------------------------------
+void writeVolume(const std::string& fileName, int volume)
+{
+  ImageType::RegionType region;
+  for (int i = 0; i < 3; i++)
+    {
+    region.SetSize(i, Dimensions[i]);
+    }
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(region);
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex<ImageType> it(image, region);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    ImageType::IndexType index = it.GetIndex();
+    it.Set(expectedValue(volume, index[0], index[1], index[2]));
+    }
+
+  typedef itk::ImageFileWriter<ImageType> WriterType;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(image);
+  writer->SetFileName(fileName);
+  writer->Update();
+}
+
+//----------------------------------------------------------------------------
+bool checkExtent(vtkITKTimeSeriesDatabase* database, int volume, int extent[6])
+{
+  database->UpdateExtent(extent);
+  vtkImageData* output = database->GetOutput();
+  for (int k = extent[4]; k <= extent[5]; k++)
+    {
+    for (int j = extent[2]; j <= extent[3]; j++)
+      {
+      for (int i = extent[0]; i <= extent[1]; i++)
+        {
+        short value = *static_cast<short*>(output->GetScalarPointer(i, j, k));
+        if (value != expectedValue(volume, i, j, k))
+          {
+          std::cerr << "Volume " << volume << ": voxel (" << i << ", " << j << ", " << k << ") is "
+                    << value << " instead of " << expectedValue(volume, i, j, k) << std::endl;
+          return false;
+          }
+        }
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool checkVoxelTimeSeries(vtkITKTimeSeriesDatabase* database, int i, int j, int k)
+{
+  vtkNew<vtkDoubleArray> values;
+  if (!database->GetVoxelTimeSeries(i, j, k, values.GetPointer()))
+    {
+    std::cerr << "Failed to get the time series of voxel (" << i << ", " << j << ", " << k << ")" << std::endl;
+    return false;
+    }
+  if (values->GetNumberOfValues() != NumberOfVolumes)
+    {
+    std::cerr << "Time series of voxel (" << i << ", " << j << ", " << k << ") has "
+              << values->GetNumberOfValues() << " values instead of " << NumberOfVolumes << std::endl;
+    return false;
+    }
+  for (int volume = 0; volume < NumberOfVolumes; volume++)
+    {
+    if (values->GetValue(volume) != expectedValue(volume, i, j, k))
+      {
+      std::cerr << "Time series of voxel (" << i << ", " << j << ", " << k << ") is "
+                << values->GetValue(volume) << " at volume " << volume
+                << " instead of " << expectedValue(volume, i, j, k) << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool testDatabase(const std::string& databaseFileName, bool useMemoryMapping)
+{
+  std::cout << "Memory mapping: " << (useMemoryMapping ? "on" : "off") << std::endl;
+
+  vtkNew<vtkITKTimeSeriesDatabase> database;
+  database->SetUseMemoryMapping(useMemoryMapping);
+  try
+    {
+    database->Connect(databaseFileName.c_str());
+    }
+  catch (itk::ExceptionObject& err)
+    {
+    std::cerr << "Unable to connect to " << databaseFileName << ": " << err << std::endl;
+    return false;
+    }
+  if (database->GetNumberOfVolumes() != NumberOfVolumes)
+    {
+    std::cerr << "Database has " << database->GetNumberOfVolumes() << " volumes instead of "
+              << NumberOfVolumes << std::endl;
+    return false;
+    }
+
+  int wholeExtent[6] = { 0, Dimensions[0] - 1, 0, Dimensions[1] - 1, 0, Dimensions[2] - 1 };
+  // Crosses block boundaries and does not start at the origin
+  int subExtent[6] = { 3, 17, 15, 17, 2, 16 };
+  for (int volume = 0; volume < NumberOfVolumes; volume++)
+    {
+    database->SetCurrentImage(volume);
+    // The sub-extent is requested after the whole extent is buffered
+    if (!checkExtent(database.GetPointer(), volume, wholeExtent)
+      || !checkExtent(database.GetPointer(), volume, subExtent))
+      {
+      return false;
+      }
+    }
+
+  if (!checkVoxelTimeSeries(database.GetPointer(), 0, 0, 0)
+    || !checkVoxelTimeSeries(database.GetPointer(), 17, 5, 16)
+    || !checkVoxelTimeSeries(database.GetPointer(), Dimensions[0] - 1, Dimensions[1] - 1, Dimensions[2] - 1))
+    {
+    return false;
+    }
+
+  vtkNew<vtkDoubleArray> values;
+  if (database->GetVoxelTimeSeries(Dimensions[0], 0, 0, values.GetPointer()))
+    {
+    std::cerr << "Time series of a voxel outside of the volume is expected to fail" << std::endl;
+    return false;
+    }
+
+  database->Disconnect();
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  itk::itkFactoryRegistration();
+
+  if (argc < 2)
+    {
+    std::cerr << "Usage: " << argv[0] << " /path/to/temp" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::string tempDir = argv[1];
+
+  std::string archetypeFileName;
+  try
+    {
+    for (int volume = 0; volume < NumberOfVolumes; volume++)
+      {
+      std::ostringstream fileName;
+      fileName << tempDir << "/vtkITKTimeSeriesDatabaseTest_" << volume + 1 << ".nrrd";
+      writeVolume(fileName.str(), volume);
+      if (volume == 0)
+        {
+        archetypeFileName = fileName.str();
+        }
+      }
+    }
+  catch (itk::ExceptionObject& err)
+    {
+    std::cerr << "Unable to write the test volumes: " << err << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::string databaseFileName = tempDir + "/vtkITKTimeSeriesDatabaseTest.tsd";
+  try
+    {
+    vtkITKTimeSeriesDatabase::CreateFromFileArchetype(databaseFileName.c_str(), archetypeFileName.c_str());
+    }
+  catch (itk::ExceptionObject& err)
+    {
+    std::cerr << "Unable to create " << databaseFileName << ": " << err << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (!testDatabase(databaseFileName, true) || !testDatabase(databaseFileName, false))
+    {
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Success" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -7,6 +7,8 @@
 #include <itkImageSource.h>
 #include <iostream>
 #include <fstream>
+#include <memory>
+#include <mutex>
 #include <itkTimeSeriesDatabaseHelper.h>
 
 #define TimeSeriesBlockSize 16
@@ -24,6 +26,11 @@ namespace itk
  * The main idea behind TimeSeriesDatabase is to have a representation of a 4 dimensional dataset that
  * is larger than main memory, but may still be accessed in a rapid manner.  Though not strictly
  * ITK conforming, this initial pass is strictly 4 dimensional datasets.
+ *
+ * By default the database files are memory mapped, blocks are then read directly from the
+ * mapping and the operating system page cache holds the blocks in use.  When memory mapping
+ * is turned off or fails, blocks are read from the files and kept in a thread safe block cache.
+ * Both GenerateData and GetVoxelTimeSeries may be used from multiple threads.
  */
 template <class TPixel> class TimeSeriesDatabase : public ImageSource<Image<TPixel,3> > {
 public:
@@ -77,6 +84,16 @@ public:
   itkSetMacro ( CurrentImage, unsigned int );
   itkGetMacro ( CurrentImage, unsigned int );
 
+  /** Memory map the database files instead of reading blocks through
+   * file streams.  Takes effect on the next call to Connect.
+   */
+  itkSetMacro ( UseMemoryMapping, bool );
+  itkGetConstMacro ( UseMemoryMapping, bool );
+  itkBooleanMacro ( UseMemoryMapping );
+
+  /** Return true if the database files are memory mapped */
+  bool IsMemoryMapped() const;
+
   /** Return information about the TimeSeriesDatabase file */
   int GetNumberOfVolumes() { return this->m_Dimensions[3]; };
   itkGetMacro ( OutputSpacing, typename OutputImageType::SpacingType );
@@ -86,11 +103,10 @@ public:
 
   /** Standard method for a ImageSource object */
   void GenerateOutputInformation() override;
-  void GenerateData() override;
 
   /** A convenience method for reading a voxel's time course
    * Subsequent calls to voxels in the immediate region of this will be
-   * cached for quick access
+   * cached for quick access.  May be called from multiple threads.
    */
   void GetVoxelTimeSeries ( typename OutputImageType::IndexType idx, ArrayType& array );
 
@@ -107,6 +123,10 @@ protected:
   ~TimeSeriesDatabase() override;
   void PrintSelf(std::ostream& os, Indent indent) const override;
 
+  /** Each thread copies the blocks that intersect its part of the requested region */
+  void BeforeThreadedGenerateData() override;
+  void DynamicThreadedGenerateData ( const typename OutputImageType::RegionType& outputRegionForThread ) override;
+
   Array<unsigned int> m_Dimensions;
   Array<unsigned int> m_BlocksPerImage;
 
@@ -140,13 +160,23 @@ protected:
   std::vector<std::string> m_DatabaseFileNames;
   unsigned long            m_BlocksPerFile{0};
 
+  bool m_UseMemoryMapping{true};
+  std::vector<std::unique_ptr<TimeSeriesDatabaseHelper::MappedFile> > m_MappedFiles;
+  /// Serialize seek and read on each file stream
+  std::vector<std::unique_ptr<std::mutex> > m_DatabaseFileMutexes;
+
   /// our cache
   struct CacheBlock
   {
     TPixel data[TimeSeriesBlockSize*TimeSeriesBlockSize*TimeSeriesBlockSize];
   };
-  TimeSeriesDatabaseHelper::LRUCache<unsigned long, CacheBlock> m_Cache;
-  CacheBlock* GetCacheBlock ( unsigned long index );
+  typedef std::shared_ptr<const CacheBlock> CacheBlockPointer;
+  TimeSeriesDatabaseHelper::ShardedLRUCache<unsigned long, CacheBlock> m_Cache;
+  CacheBlockPointer GetCacheBlock ( unsigned long index );
+  /// Return the voxels of the block at index.  The block is read from the
+  /// memory mapping if available, from the cache otherwise, in that case
+  /// cacheBlock keeps the returned data valid.
+  const TPixel* GetBlockData ( unsigned long index, CacheBlockPointer& cacheBlock );
 };
 
 } // end namespace itk
@@ -12,6 +12,8 @@
 #include <itksys/SystemTools.hxx>
 #include "itkArchetypeSeriesFileNames.h"
 #include <fstream>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 namespace itk {
@@ -57,6 +59,12 @@ bool TimeSeriesDatabase<TPixel>::IsOpen () const
   return const_cast<std::fstream*>(this->m_DatabaseFiles[0].get())->is_open();
 }
 
+template <class TPixel>
+bool TimeSeriesDatabase<TPixel>::IsMemoryMapped () const
+{
+  return this->m_MappedFiles.size() > 0;
+}
+
 template <class TPixel>
 void TimeSeriesDatabase<TPixel>::Disconnect ()
 {
@@ -66,6 +74,10 @@ void TimeSeriesDatabase<TPixel>::Disconnect ()
     }
   this->m_DatabaseFiles.clear();
   this->m_DatabaseFileNames.clear();
+  this->m_DatabaseFileMutexes.clear();
+  this->m_MappedFiles.clear();
+  this->m_Cache.clear();
+  this->Modified();
 }
 
 template <class TPixel>
@@ -122,6 +134,9 @@ void TimeSeriesDatabase<TPixel>::Connect ( const char* filename )
   o >> dummy;
   this->m_DatabaseFiles.clear();
   this->m_DatabaseFileNames.clear();
+  this->m_DatabaseFileMutexes.clear();
+  this->m_MappedFiles.clear();
+  this->m_Cache.clear();
   // Read and open the files
   for ( int idx = 0; idx < NumberOfFiles; idx++ )
     {
@@ -130,6 +145,23 @@ void TimeSeriesDatabase<TPixel>::Connect ( const char* filename )
     // std::cout << "Reading file " << idx << " " << Filename << std::endl;
     this->m_DatabaseFileNames.push_back ( Filename );
     this->m_DatabaseFiles.push_back ( StreamPtr ( new std::fstream ( Filename.c_str(), ::std::ios::in | ::std::ios::binary ) ) );
+    this->m_DatabaseFileMutexes.push_back ( std::unique_ptr<std::mutex> ( new std::mutex ) );
+    }
+  // Map all the files, or none of them if any cannot be mapped (e.g. out of address space)
+  if ( this->m_UseMemoryMapping )
+    {
+    for ( int idx = 0; idx < NumberOfFiles; idx++ )
+      {
+      std::unique_ptr<TimeSeriesDatabaseHelper::MappedFile> mappedFile ( new TimeSeriesDatabaseHelper::MappedFile );
+      if ( !mappedFile->open ( this->m_DatabaseFileNames[idx] ) )
+        {
+        itkWarningMacro ( "TimeSeriesDatabase::Connect: cannot memory map " << this->m_DatabaseFileNames[idx]
+                          << ", reading blocks from the files" );
+        this->m_MappedFiles.clear();
+        break;
+        }
+      this->m_MappedFiles.push_back ( std::move ( mappedFile ) );
+      }
     }
   /*
   std::cout << "ImageSize: " << m_OutputRegion.GetSize() << endl;
@@ -137,6 +169,7 @@ void TimeSeriesDatabase<TPixel>::Connect ( const char* filename )
   std::cout << "ImageSpacing: " << m_OutputSpacing << endl;
   std::cout << "Direction: " << m_OutputDirection << endl;
   */
+  this->Modified();
 }
 
 
@@ -184,42 +217,65 @@ template <class TPixel>
 
 
 template <class TPixel>
-typename TimeSeriesDatabase<TPixel>::CacheBlock* TimeSeriesDatabase<TPixel>::GetCacheBlock ( unsigned long index )
+typename TimeSeriesDatabase<TPixel>::CacheBlockPointer TimeSeriesDatabase<TPixel>::GetCacheBlock ( unsigned long index )
 {
-  CacheBlock* Buffer = this->m_Cache.find ( index );
-  if ( Buffer == nullptr ) {
-    // Fill it in
-    CacheBlock B;
+  CacheBlockPointer Buffer = this->m_Cache.find ( index );
+  if ( !Buffer ) {
+    // Fill it in.  Two threads may read the same block, the last one inserted is kept.
+    std::shared_ptr<CacheBlock> B = std::make_shared<CacheBlock>();
     int FileIdx = this->CalculateFileIndex ( index );
-
-    this->m_DatabaseFiles[FileIdx]->seekg ( this->CalculatePosition ( index, this->m_BlocksPerFile ) );
-    this->m_DatabaseFiles[FileIdx]->read ( reinterpret_cast<char*> ( B.data ), TimeSeriesVolumeBlockSize * sizeof ( TPixel ) );
-    this->m_Cache.insert ( index, B );
-    Buffer = this->m_Cache.find ( index );
+    {
+      std::lock_guard<std::mutex> lock ( *this->m_DatabaseFileMutexes[FileIdx] );
+      this->m_DatabaseFiles[FileIdx]->clear();
+      this->m_DatabaseFiles[FileIdx]->seekg ( this->CalculatePosition ( index, this->m_BlocksPerFile ) );
+      this->m_DatabaseFiles[FileIdx]->read ( reinterpret_cast<char*> ( B->data ), TimeSeriesVolumeBlockSize * sizeof ( TPixel ) );
+    }
+    Buffer = B;
+    this->m_Cache.insert ( index, Buffer );
   }
   return Buffer;
 }
 
+template <class TPixel>
+const TPixel* TimeSeriesDatabase<TPixel>::GetBlockData ( unsigned long index, CacheBlockPointer& cacheBlock )
+{
+  unsigned int FileIdx = this->CalculateFileIndex ( index );
+  size_t position = static_cast<size_t> ( ::std::streamoff ( this->CalculatePosition ( index, this->m_BlocksPerFile ) ) );
+  if ( FileIdx < this->m_MappedFiles.size()
+       && position + TimeSeriesVolumeBlockSize * sizeof ( TPixel ) <= this->m_MappedFiles[FileIdx]->get_size() )
+    {
+    // Blocks are aligned on their size in the file, and the mapping on a page
+    return reinterpret_cast<const TPixel*> ( this->m_MappedFiles[FileIdx]->get_data() + position );
+    }
+  cacheBlock = this->GetCacheBlock ( index );
+  return cacheBlock->data;
+}
+
 
 template <class TPixel>
 void TimeSeriesDatabase<TPixel>::GetVoxelTimeSeries ( typename OutputImageType::IndexType idx, ArrayType& array )
 {
+  if ( !this->IsOpen() )
+  {
+    itkExceptionMacro ( "TimeSeriesDatabase::GetVoxelTimeSeries: not open for reading" );
+  }
   // See if the index is inside the volume
   // and figure out which cache block we need
   Size<3> CurrentBlock;
   Size<3> Offset;
   for ( int i = 0; i < 3; i++ ) {
-    if ( idx[i] < 0 || idx[i] > this->m_OutputRegion.Size[i] ) {
-      throw 1;
+    if ( idx[i] < 0 || idx[i] >= static_cast<IndexValueType> ( this->m_OutputRegion.GetSize ( i ) ) ) {
+      itkExceptionMacro ( "TimeSeriesDatabase::GetVoxelTimeSeries: index " << idx << " is outside of the volume" );
     }
-    CurrentBlock[i] = reinterpret_cast<unsigned long> ( idx[i] / (double)TimeSeriesBlockSize );
+    CurrentBlock[i] = idx[i] / TimeSeriesBlockSize;
     Offset[i] = idx[i] % TimeSeriesBlockSize;
   }
   unsigned long offset = Offset[0] + Offset[1] * TimeSeriesBlockSize + Offset[2] * TimeSeriesBlockSizeP2;
-  array = ArrayType ( this->m_Dimensions[3] );
-  for ( int volume = 0; volume < this->m_Dimensions[3]; volume++ ) {
-    CacheBlock* cache = this->GetCacheBlock ( CurrentBlock, volume );
-    array[volume] = cache->data[offset];
+  array.SetSize ( this->m_Dimensions[3] );
+  for ( unsigned int volume = 0; volume < this->m_Dimensions[3]; volume++ ) {
+    CacheBlockPointer cacheBlock;
+    const TPixel* data = this->GetBlockData ( this->CalculateIndex ( CurrentBlock, volume ), cacheBlock );
+    array[volume] = data[offset];
   }
 }
 
@@ -235,19 +291,19 @@ void TimeSeriesDatabase<TPixel>::GenerateOutputInformation ( )
 }
 
 template <class TPixel>
-void TimeSeriesDatabase<TPixel>::GenerateData()
+void TimeSeriesDatabase<TPixel>::BeforeThreadedGenerateData()
 {
-  typename OutputImageType::Pointer output = this->GetOutput();
-  typename OutputImageType::RegionType Region;
-  itkDebugMacro ( << "TimeSeriesDatabase::GenerateData()  Allocating" );
-  Region = output->GetRequestedRegion();
-  output->SetBufferedRegion ( Region );
-  output->Allocate();
-
   if ( !this->IsOpen() )
   {
-    itkGenericExceptionMacro ( "TimeSeriesDatabase::GenerateOutputInformation: not open for reading" );
+    itkGenericExceptionMacro ( "TimeSeriesDatabase::GenerateData: not open for reading" );
   }
+}
+
+template <class TPixel>
+void TimeSeriesDatabase<TPixel>::DynamicThreadedGenerateData ( const typename OutputImageType::RegionType& outputRegionForThread )
+{
+  typename OutputImageType::Pointer output = this->GetOutput();
+  typename OutputImageType::RegionType Region = outputRegionForThread;
 
   Size<3> BlockStart, BlockCount;
   for ( unsigned int i = 0; i < 3; i++ ) {
@@ -255,42 +311,21 @@ void TimeSeriesDatabase<TPixel>::GenerateData()
     BlockCount[i] = (int) TSD_MAX ( 1.0, ceil ( (Region.GetIndex(i)+Region.GetSize(i)) / (double)TimeSeriesBlockSize ) - BlockStart[i] );
   }
 
-  bool print = Region.GetIndex(0) == 0 && Region.GetIndex(1) == 0 && Region.GetIndex(2) == 80;
-  print = false;
-  if ( print )
-    {
-    std::cout << "GenerateData for " << output->GetRequestedRegion() << std::endl;
-    output->Print ( std::cout );
-    }
-
   Size<3> CurrentBlock;
-  // Now, read our data, caching as we go, in future, make this thread safe
-  Size<3> BlockSize = { {TimeSeriesBlockSize, TimeSeriesBlockSize, TimeSeriesBlockSize }};
-  ImageRegion<3> BlockRegion;
-  BlockRegion.SetSize ( BlockSize );
   // Fetch only the blocks we need
   for ( CurrentBlock[2] = BlockStart[2]; CurrentBlock[2] < BlockStart[2] + BlockCount[2]; CurrentBlock[2]++ ) {
     for ( CurrentBlock[1] = BlockStart[1]; CurrentBlock[1] < BlockStart[1] + BlockCount[1]; CurrentBlock[1]++ ) {
       for ( CurrentBlock[0] = BlockStart[0]; CurrentBlock[0] < BlockStart[0] + BlockCount[0]; CurrentBlock[0]++ ) {
         typename OutputImageType::RegionType BR, IR;
-        if ( print ) {  std::cout << "For Block Index: " << CurrentBlock << std::endl; }
         unsigned long index = this->CalculateIndex ( CurrentBlock, this->m_CurrentImage );
-        CacheBlock* Buffer = this->GetCacheBlock ( index );
+        CacheBlockPointer cacheBlock;
+        const TPixel* Buffer = this->GetBlockData ( index, cacheBlock );
         if ( this->CalculateIntersection ( CurrentBlock, Region, BR, IR ) ) {
           // Just iterate over whole block
           // Good we can use an iterator!
-          if ( print ) {
-            std::cout << "The easy way! " << std::endl;
-            std::cout << "Block Region: " << BR;
-            std::cout << "Image Region: " << IR;
-          }
-          Index<3> BlockIndex = {{ static_cast<IndexValueType>( CurrentBlock[0] * TimeSeriesBlockSize),
-                                   static_cast<IndexValueType>( CurrentBlock[1] * TimeSeriesBlockSize),
-                                   static_cast<IndexValueType>( CurrentBlock[2] * TimeSeriesBlockSize) }};
-          BlockRegion.SetIndex ( BlockIndex );
           ImageRegionIterator<OutputImageType> it ( output, IR );
           it.GoToBegin();
-          TPixel* ptr = Buffer->data;
+          const TPixel* ptr = Buffer;
           while ( !it.IsAtEnd() ) {
             it.Set ( *ptr );
             ++it;
@@ -300,13 +335,6 @@ void TimeSeriesDatabase<TPixel>::GenerateData()
           // Now we do it the hard way...
           Index<3> ImageIndex;
           Size<3> Count = BR.GetSize();
-          if ( print ) {
-            std::cout << "The Hard way" << std::endl;
-            std::cout << "Count: " << Count << std::endl;
-            std::cout << "Block Region: " << BR;
-            std::cout << "Image Region: " << IR;
-            std::cout << "First voxel: " << Buffer->data[0] << std::endl;
-          }
           unsigned int bx, by, bz, x, y, z;
           for ( z = 0; z < Count[2]; z++ ) {
             ImageIndex[2] = IR.GetIndex(2) + z;
@@ -317,15 +345,7 @@ void TimeSeriesDatabase<TPixel>::GenerateData()
               for ( x = 0; x < Count[0]; x++ ) {
                 ImageIndex[0] = IR.GetIndex(0) + x;
                 bx = BR.GetIndex(0) + x;
-                /*
-                int BufferIndex = bx + TimeSeriesBlockSize*by + TimeSeriesBlockSize*TimeSeriesBlockSize*bz;
-                if ( ImageIndex[0] == 45 && ImageIndex[1] == 0 && ImageIndex[2] == 0 ) {
-                  std::cout << "Index: " << ImageIndex << " Volume Value: " << output->GetPixel ( ImageIndex ) << " buffer: " << Buffer->data[BufferIndex] << std::endl;
-                std::cout << "Index: " << ImageIndex << " From " << BufferIndex << " ( " << bx << ", " << by << ", " << bz << " )\n" << std::endl;
-                }
-                */
-
-                output->SetPixel ( ImageIndex, Buffer->data[bx + TimeSeriesBlockSize*by + TimeSeriesBlockSize*TimeSeriesBlockSize*bz] );
+                output->SetPixel ( ImageIndex, Buffer[bx + TimeSeriesBlockSize*by + TimeSeriesBlockSize*TimeSeriesBlockSize*bz] );
                 }
               }
             }
@@ -333,8 +353,6 @@ void TimeSeriesDatabase<TPixel>::GenerateData()
         }
       }
     }
-
-  return;
 }
 
 
@@ -569,7 +587,7 @@ void TimeSeriesDatabase<TPixel>::SetCacheSizeInMiB ( float sz )
 {
   // How many blocks is this?
   double BlockSizeInMiB = sizeof ( TPixel ) * TimeSeriesVolumeBlockSize / ( 1024*1024.);
-  unsigned long int blocks = (unsigned long int) ceil ( sz * BlockSizeInMiB );
+  unsigned long int blocks = (unsigned long int) ceil ( sz / BlockSizeInMiB );
   this->m_Cache.set_maxsize ( blocks );
 }
 
@@ -600,9 +618,11 @@ TimeSeriesDatabase<TPixel>
   os << indent << "OutputRegion: " << m_OutputRegion;
   os << indent << "OutputOrigin: " << m_OutputOrigin << "\n";
   os << indent << "OutputDirection: " << m_OutputDirection << "\n";
+  os << indent << "UseMemoryMapping: " << m_UseMemoryMapping << "\n";
   if ( this->IsOpen() ) {
     os << indent << "Database is open." << "\n";
     os << indent << "Blocks per file: " << this->m_BlocksPerFile << "\n";
+    os << indent << "Memory mapped: " << this->IsMemoryMapped() << "\n";
     os << indent << "File names: " << "\n";
     for ( ::size_t idx = 0; idx < this->m_DatabaseFileNames.size(); idx++ )
       {
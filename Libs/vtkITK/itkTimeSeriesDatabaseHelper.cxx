@@ -0,0 +1,110 @@
+/*=========================================================================
+
+  Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+==========================================================================*/
+
+#include "itkTimeSeriesDatabaseHelper.h"
+
+#ifdef _WIN32
+# ifndef NOMINMAX
+#  define NOMINMAX
+# endif
+# include <windows.h>
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+namespace itk {
+  namespace TimeSeriesDatabaseHelper {
+
+//----------------------------------------------------------------------------
+MappedFile::~MappedFile()
+{
+  this->close();
+}
+
+//----------------------------------------------------------------------------
+bool MappedFile::open(const std::string& filename)
+{
+  this->close();
+#ifdef _WIN32
+  HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    {
+    return false;
+    }
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+    CloseHandle(file);
+    return false;
+    }
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  // the mapping keeps the file open
+  CloseHandle(file);
+  if (mapping == nullptr)
+    {
+    return false;
+    }
+  void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (view == nullptr)
+    {
+    CloseHandle(mapping);
+    return false;
+    }
+  this->mapping = mapping;
+  this->data = static_cast<const char*>(view);
+  this->size = static_cast<size_t>(fileSize.QuadPart);
+#else
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    {
+    return false;
+    }
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
+    {
+    ::close(fd);
+    return false;
+    }
+  void* view = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_SHARED, fd, 0);
+  // the mapping keeps the file open
+  ::close(fd);
+  if (view == MAP_FAILED)
+    {
+    return false;
+    }
+  this->data = static_cast<const char*>(view);
+  this->size = static_cast<size_t>(fileStat.st_size);
+#endif
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void MappedFile::close()
+{
+  if (!this->data)
+    {
+    return;
+    }
+#ifdef _WIN32
+  UnmapViewOfFile(this->data);
+  CloseHandle(this->mapping);
+  this->mapping = nullptr;
+#else
+  munmap(const_cast<char*>(this->data), this->size);
+#endif
+  this->data = nullptr;
+  this->size = 0;
+}
+
+  }
+}
@@ -1,11 +1,15 @@
 #ifndef itkTimeSeriesDatabaseHelper_h
 #define itkTimeSeriesDatabaseHelper_h
+#include "vtkITKExport.h"
 #include <list>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <cstdarg>
 #include <cassert>
+#include <cstddef>
 
 namespace itk {
   namespace TimeSeriesDatabaseHelper {
@@ -335,6 +339,140 @@ namespace itk {
         unsigned long finds_hit;
         unsigned long removed;
       } stats;
+#endif
+    };
+
+    /// A thread safe cache.
+    ///
+    /// Splits the keys over a fixed number of LRUCache shards, each
+    /// protected by its own mutex, so that threads looking up different
+    /// keys rarely wait for each other. Values are stored as shared
+    /// pointers: a value returned by find() stays valid after it is
+    /// removed from the cache.
+    ///
+    template <typename KeyType, typename ValueType>
+      class ShardedLRUCache
+    {
+    public:
+      typedef std::shared_ptr<const ValueType> ValuePointerType;
+
+      /// Create a new cache.
+      ///
+      /// \param maxsize_ maximal size of the cache, over all the shards
+      ///
+    ShardedLRUCache(unsigned maxsize_ = 100)
+      {
+        set_maxsize(maxsize_);
+      }
+
+      void set_maxsize ( unsigned maxsize_ )
+      {
+        unsigned shardMaxsize = (maxsize_ + NumberOfShards - 1) / NumberOfShards;
+        for (unsigned i = 0; i < NumberOfShards; i++)
+          {
+            std::lock_guard<std::mutex> lock(shards[i].mutex);
+            shards[i].cache.set_maxsize(shardMaxsize > 0 ? shardMaxsize : 1);
+          }
+      }
+
+      unsigned get_maxsize ()
+      {
+        unsigned maxsize = 0;
+        for (unsigned i = 0; i < NumberOfShards; i++)
+          {
+            std::lock_guard<std::mutex> lock(shards[i].mutex);
+            maxsize += shards[i].cache.get_maxsize();
+          }
+        return maxsize;
+      }
+
+      /// Clear the cache.
+      ///
+      void clear()
+      {
+        for (unsigned i = 0; i < NumberOfShards; i++)
+          {
+            std::lock_guard<std::mutex> lock(shards[i].mutex);
+            shards[i].cache.clear();
+          }
+      }
+
+      /// Inserts a key/value pair to the cache.
+      ///
+      void insert(const KeyType& key, const ValuePointerType& value)
+      {
+        shard& s = shards[get_shard_index(key)];
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.cache.insert(key, value);
+      }
+
+      /// Looks for a key in the cache.
+      ///
+      /// Returns the value if found, a null pointer otherwise.
+      ///
+      ValuePointerType find(const KeyType& key)
+      {
+        shard& s = shards[get_shard_index(key)];
+        std::lock_guard<std::mutex> lock(s.mutex);
+        ValuePointerType* valptr = s.cache.find(key);
+        return valptr ? *valptr : ValuePointerType();
+      }
+
+      /// Prints cache statistics of each shard.
+      ///
+      void statistics(ostream& ostr = cerr) const
+      {
+        for (unsigned i = 0; i < NumberOfShards; i++)
+          {
+            std::lock_guard<std::mutex> lock(shards[i].mutex);
+            shards[i].cache.statistics(ostr);
+          }
+      }
+
+    private:
+      static const unsigned NumberOfShards = 16;
+
+      struct shard
+      {
+        mutable std::mutex mutex;
+        LRUCache<KeyType, ValuePointerType> cache;
+      };
+
+      static unsigned get_shard_index(const KeyType& key)
+      {
+        return static_cast<unsigned>(key % NumberOfShards);
+      }
+
+      shard shards[NumberOfShards];
+    };
+
+    /// Read-only memory mapping of a whole file.
+    ///
+    /// The operating system pages the file in on demand and keeps the
+    /// pages that are in use in its page cache, so no block has to be
+    /// copied or cached by the application.
+    ///
+    class VTK_ITK_EXPORT MappedFile
+    {
+    public:
+      MappedFile() = default;
+      ~MappedFile();
+      MappedFile(const MappedFile&) = delete;
+      MappedFile& operator=(const MappedFile&) = delete;
+
+      /// Map the file, returns false if it cannot be mapped.
+      bool open(const std::string& filename);
+      void close();
+
+      bool is_open() const { return data != nullptr; }
+      const char* get_data() const { return data; }
+      size_t get_size() const { return size; }
+
+    private:
+      const char* data{nullptr};
+      size_t size{0};
+#ifdef _WIN32
+      void* mapping{nullptr};
 #endif
     };
   }
@@ -8,6 +8,7 @@
 ==========================================================================*/
 
 #include "vtkITKDistanceTransform.h"
+#include "vtkITKImageBridge.h"
 #include "vtkObjectFactory.h"
 
 #include "vtkDataArray.h"
@@ -44,20 +45,7 @@ void vtkITKDistanceTransformExecute(vtkITKDistanceTransform *self, vtkImageData*
   // Wrap scalars into an ITK image
   // - mostly rely on defaults for spacing, origin etc for this filter
   typedef itk::Image<T, 3> ImageType;
-  typename ImageType::Pointer inImage = ImageType::New();
-  inImage->GetPixelContainer()->SetImportPointer(inPtr, dims[0]*dims[1]*dims[2], false);
-  typename ImageType::RegionType region;
-  typename ImageType::IndexType index;
-  typename ImageType::SizeType size;
-  index[0] = index[1] = index[2] = 0;
-  size[0] = dims[0];
-  size[1] = dims[1];
-  size[2] = dims[2];
-  region.SetIndex(index);
-  region.SetSize(size);
-  inImage->SetLargestPossibleRegion(region);
-  inImage->SetBufferedRegion(region);
-  inImage->SetSpacing(spacing);
+  typename ImageType::Pointer inImage = vtkITKImportImageBuffer<ImageType>(inPtr, dims, spacing);
 
 
   // Calculate the distance transform
@@ -71,11 +59,13 @@ void vtkITKDistanceTransformExecute(vtkITKDistanceTransform *self, vtkImageData*
   dist->SetSquaredDistance(self->GetSquaredDistance());
 
   dist->SetInput( inImage );
+
+  // Write the distance map directly into the output
+  vtkITKImageBridgeOutput<DistanceImageType> outputBridge(dist, outPtr, inImage->GetBufferedRegion().GetNumberOfPixels());
   dist->Update();
 
-  // Copy to the output
-  memcpy(outPtr, dist->GetOutput()->GetBufferPointer(),
-         dist->GetOutput()->GetBufferedRegion().GetNumberOfPixels() * sizeof(T));
+  // Copy to the output, unless the filter wrote it there already
+  outputBridge.CopyOutput();
 
 }
 
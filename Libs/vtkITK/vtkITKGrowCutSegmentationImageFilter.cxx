@@ -304,10 +304,10 @@ void vtkITKImageGrowCutExecute3D(vtkImageData *inData,
 
   std::cout << "Done running filter " << std::endl;
 
-  // allocate outputImage first
+  // wrap the output scalars so that the result is written in place
   outputImage->CopyInformation( labelImage );
   outputImage->SetBufferedRegion( labelImage->GetBufferedRegion() );
-  outputImage->Allocate();
+  outputImage->GetPixelContainer()->SetImportPointer(output, dims[0]*dims[1]*dims[2], false);
   outputImage->FillBuffer(0);
 
   itk::ImageRegionIterator< OutImageType > filterOut(outputImageROI, outputImageROI->GetBufferedRegion());
@@ -317,9 +317,6 @@ void vtkITKImageGrowCutExecute3D(vtkImageData *inData,
     {
     out.Set(filterOut.Get());
     }
-
- memcpy(output, outputImage->GetBufferPointer(),
-         outputImage->GetBufferedRegion().GetNumberOfPixels()*sizeof(OT) );
 }
 
 //-----------------------------------------------------------------------------
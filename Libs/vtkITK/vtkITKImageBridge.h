@@ -0,0 +1,138 @@
+/*=========================================================================
+
+  Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+==========================================================================*/
+
+#ifndef __vtkITKImageBridge_h
+#define __vtkITKImageBridge_h
+
+// ITK includes
+#include <itkCommand.h>
+#include <itkImage.h>
+#include <itkImageSource.h>
+
+// STD includes
+#include <algorithm>
+#include <cstring>
+
+/**
+ * Wrap a VTK scalar buffer as an ITK image without copying it.
+ *
+ * The pixel container of the returned image imports \a buffer without
+ * taking ownership, so the VTK array must outlive the image. The largest
+ * possible and buffered regions start at index 0 and span \a dims. Spacing
+ * is only set if \a spacing is given, origin and direction are left at
+ * their defaults.
+ */
+template <class TImage>
+typename TImage::Pointer vtkITKImportImageBuffer(typename TImage::PixelType* buffer,
+                                                 const int dims[3], const double* spacing = nullptr)
+{
+  typename TImage::Pointer image = TImage::New();
+  typename TImage::RegionType region;
+  typename TImage::IndexType index;
+  typename TImage::SizeType size;
+  index[0] = index[1] = index[2] = 0;
+  size[0] = dims[0];
+  size[1] = dims[1];
+  size[2] = dims[2];
+  region.SetIndex(index);
+  region.SetSize(size);
+  image->SetRegions(region);
+  image->GetPixelContainer()->SetImportPointer(buffer, region.GetNumberOfPixels(), false);
+  if (spacing)
+    {
+    image->SetSpacing(spacing);
+    }
+  return image;
+}
+
+/**
+ * \brief Let an ITK filter write its output directly into a VTK scalar buffer.
+ *
+ * When the filter starts generating data, the pixel container of its output
+ * is replaced by one that imports the preallocated VTK buffer without taking
+ * ownership. Allocating the output then reuses the VTK array instead of
+ * allocating a new one, so no copy is needed after the update.
+ *
+ * Some filters replace the pixel container of their output anyway (filters
+ * running in place, or filters grafting the output of an internal
+ * pipeline). CopyOutput() must therefore be called after the update: it
+ * copies the result into the VTK buffer only if the filter did not write
+ * it there.
+ *
+ * \code
+ * vtkITKImageBridgeOutput<ImageType> outputBridge(filter, outPtr, numberOfPixels);
+ * filter->Update();
+ * outputBridge.CopyOutput();
+ * \endcode
+ */
+template <class TImage>
+class vtkITKImageBridgeOutput
+{
+public:
+  typedef typename TImage::PixelType PixelType;
+  typedef itk::ImageSource<TImage> SourceType;
+
+  vtkITKImageBridgeOutput(SourceType* source, PixelType* buffer, itk::SizeValueType numberOfPixels)
+    : Source(source)
+    , Buffer(buffer)
+    , NumberOfPixels(numberOfPixels)
+  {
+    this->StartEventCommand = CommandType::New();
+    this->StartEventCommand->SetCallbackFunction(this, &vtkITKImageBridgeOutput::SetOutputBuffer);
+    this->StartEventObserverTag = this->Source->AddObserver(itk::StartEvent(), this->StartEventCommand);
+  }
+
+  ~vtkITKImageBridgeOutput()
+  {
+    this->Source->RemoveObserver(this->StartEventObserverTag);
+  }
+
+  /// Copy the filter output into the VTK buffer if the filter did not write
+  /// it there directly. Returns true if no copy was necessary.
+  bool CopyOutput()
+  {
+    TImage* output = this->Source->GetOutput();
+    if (output->GetBufferPointer() == this->Buffer)
+      {
+      return true;
+      }
+    itk::SizeValueType numberOfPixels = std::min<itk::SizeValueType>(
+      output->GetBufferedRegion().GetNumberOfPixels(), this->NumberOfPixels);
+    memcpy(this->Buffer, output->GetBufferPointer(), numberOfPixels * sizeof(PixelType));
+    return false;
+  }
+
+protected:
+  typedef itk::SimpleMemberCommand<vtkITKImageBridgeOutput> CommandType;
+
+  void SetOutputBuffer()
+  {
+    TImage* output = this->Source->GetOutput();
+    if (output->GetRequestedRegion().GetNumberOfPixels() != this->NumberOfPixels)
+      {
+      // Only part of the image is generated, let the filter allocate it
+      return;
+      }
+    typename TImage::PixelContainerPointer container = TImage::PixelContainer::New();
+    container->SetImportPointer(this->Buffer, this->NumberOfPixels, false);
+    output->SetPixelContainer(container);
+  }
+
+  typename SourceType::Pointer Source;
+  PixelType* Buffer;
+  itk::SizeValueType NumberOfPixels;
+  typename CommandType::Pointer StartEventCommand;
+  unsigned long StartEventObserverTag;
+
+private:
+  vtkITKImageBridgeOutput(const vtkITKImageBridgeOutput&) = delete;
+  void operator=(const vtkITKImageBridgeOutput&) = delete;
+};
+
+#endif
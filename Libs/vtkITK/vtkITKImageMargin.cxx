@@ -19,6 +19,7 @@
 ==============================================================================*/
 
 /// vtkITK includes
+#include "vtkITKImageBridge.h"
 #include "vtkITKImageMargin.h"
 
 /// VTK includes
@@ -75,8 +76,8 @@ sdf(itk::SmartPointer<itk::Image<InputPixelType, Dimension> > labelImage, int ba
 
 //----------------------------------------------------------------------------
 template <typename ImageType>
-itk::SmartPointer<ImageType>
-sdfMargin(itk::SmartPointer<ImageType> labelImage, int backgroundValue, double innerMarginMM, double outerMarginMM)
+void sdfMargin(itk::SmartPointer<ImageType> labelImage, int backgroundValue, double innerMarginMM, double outerMarginMM,
+               typename ImageType::PixelType* outPtr)
 {
   innerMarginMM -= std::numeric_limits<double>::epsilon();
   outerMarginMM += std::numeric_limits<double>::epsilon();
@@ -90,8 +91,11 @@ sdfMargin(itk::SmartPointer<ImageType> labelImage, int backgroundValue, double i
     sdfTh->SetLowerThreshold(innerMarginMM*std::abs(innerMarginMM));
     }
   sdfTh->SetUpperThreshold(outerMarginMM*std::abs(outerMarginMM));
+
+  // Threshold directly into the output buffer
+  vtkITKImageBridgeOutput<ImageType> outputBridge(sdfTh, outPtr, labelImage->GetBufferedRegion().GetNumberOfPixels());
   sdfTh->Update();
-  return sdfTh->GetOutput();
+  outputBridge.CopyOutput();
 }
 
 //----------------------------------------------------------------------------
@@ -110,18 +114,7 @@ void vtkITKImageMarginExecute(vtkITKImageMargin *self, vtkImageData* input,
     // Wrap scalars into an ITK image
     // - mostly rely on defaults for spacing, origin etc for this filter
     typedef itk::Image<T, 3> ImageType;
-    typename ImageType::Pointer inImage = ImageType::New();
-    typename ImageType::RegionType region;
-    typename ImageType::IndexType index;
-    typename ImageType::SizeType size;
-
-    inImage->GetPixelContainer()->SetImportPointer(inPtr, dims[0] * dims[1] * dims[2], false);
-    index[0] = index[1] = index[2] = 0;
-    region.SetIndex(index);
-    size[0] = dims[0]; size[1] = dims[1]; size[2] = dims[2];
-    region.SetSize(size);
-    inImage->SetLargestPossibleRegion(region);
-    inImage->SetBufferedRegion(region);
+    typename ImageType::Pointer inImage = vtkITKImportImageBuffer<ImageType>(inPtr, dims);
 
     double innerMarginDistance = self->GetInnerMarginVoxels();
     double outerMarginDistance = self->GetOuterMarginVoxels();
@@ -132,11 +125,7 @@ void vtkITKImageMarginExecute(vtkITKImageMargin *self, vtkImageData* input,
       outerMarginDistance = self->GetOuterMarginMM();
       }
 
-    itk::SmartPointer<ImageType> outputImage;
-    outputImage = sdfMargin<ImageType>(inImage, self->GetBackgroundValue(), innerMarginDistance, outerMarginDistance);
-
-    // Copy to the output
-    memcpy(outPtr, outputImage->GetBufferPointer(), outputImage->GetBufferedRegion().GetNumberOfPixels() * sizeof(T));
+    sdfMargin<ImageType>(inImage, self->GetBackgroundValue(), innerMarginDistance, outerMarginDistance, outPtr);
     }
   catch (itk::ExceptionObject & err)
     {
@@ -8,6 +8,7 @@
 ==========================================================================*/
 
 #include "vtkITKIslandMath.h"
+#include "vtkITKImageBridge.h"
 #include "vtkObjectFactory.h"
 
 #include "vtkDataArray.h"
@@ -75,19 +76,7 @@ void vtkITKIslandMathExecute(vtkITKIslandMath *self, vtkImageData* input,
   // Wrap scalars into an ITK image
   // - mostly rely on defaults for spacing, origin etc for this filter
   typedef itk::Image<T, 3> ImageType;
-  typename ImageType::Pointer inImage = ImageType::New();
-  typename ImageType::RegionType region;
-  typename ImageType::IndexType index;
-  typename ImageType::SizeType size;
-
-  inImage->GetPixelContainer()->SetImportPointer(inPtr, dims[0]*dims[1]*dims[2], false);
-  index[0] = index[1] = index[2] = 0;
-  region.SetIndex(index);
-  size[0] = dims[0]; size[1] = dims[1]; size[2] = dims[2];
-  region.SetSize(size);
-  inImage->SetLargestPossibleRegion(region);
-  inImage->SetBufferedRegion(region);
-  inImage->SetSpacing(spacing);
+  typename ImageType::Pointer inImage = vtkITKImportImageBuffer<ImageType>(inPtr, dims, spacing);
 
   // set up the progress callback
   itk::CStyleCommand::Pointer progressCommand = itk::CStyleCommand::New();
@@ -110,13 +99,17 @@ void vtkITKIslandMathExecute(vtkITKIslandMath *self, vtkImageData* input,
   ccfilter->SetInput( inImage );
   relabel->SetInput( ccfilter->GetOutput() );
   relabel->SetMinimumObjectSize( self->GetMinimumSize() );
+
+  // Write the relabeled image directly into the output
+  // (running in place would reuse the connected component buffer instead)
+  relabel->InPlaceOff();
+  vtkITKImageBridgeOutput<ImageType> outputBridge(relabel, outPtr, inImage->GetBufferedRegion().GetNumberOfPixels());
   relabel->Update();
   self->SetNumberOfIslands(relabel->GetNumberOfObjects());
   self->SetOriginalNumberOfIslands(relabel->GetOriginalNumberOfObjects());
 
-  // Copy to the output
-  memcpy(outPtr, relabel->GetOutput()->GetBufferPointer(),
-         relabel->GetOutput()->GetBufferedRegion().GetNumberOfPixels() * sizeof(T));
+  // Copy to the output, unless the filter wrote it there already
+  outputBridge.CopyOutput();
 
 }
 
@@ -14,6 +14,7 @@ PURPOSE.  See the above copyright notice for more information.
 
 =========================================================================*/
 #include "vtkITKLevelTracing3DImageFilter.h"
+#include "vtkITKImageBridge.h"
 #include "itkLevelTracingImageFilter.h"
 
 #include "vtkInformation.h"
@@ -84,11 +85,13 @@ void vtkITKLevelTracing3DTrace(vtkITKLevelTracing3DImageFilter *vtkNotUsed(self)
   tracing->SetSeed(seedIndex);
 
   tracing->SetInput( image );
+
+  // Trace directly into the output
+  vtkITKImageBridgeOutput<LabelImageType> outputBridge(tracing, oscalars, region.GetNumberOfPixels());
   tracing->Update();
 
-  // Copy to the output
-  memcpy(oscalars, tracing->GetOutput()->GetBufferPointer(),
-         tracing->GetOutput()->GetBufferedRegion().GetNumberOfPixels());
+  // Copy to the output, unless the filter wrote it there already
+  outputBridge.CopyOutput();
 
 }
 
@@ -8,6 +8,7 @@
 ==========================================================================*/
 
 #include "vtkITKMorphologicalContourInterpolator.h"
+#include "vtkITKImageBridge.h"
 #include "vtkObjectFactory.h"
 
 #include "vtkDataArray.h"
@@ -36,20 +37,7 @@ void vtkITKMorphologicalContourInterpolatorExecute(vtkITKMorphologicalContourInt
   // Wrap scalars into an ITK image
   // - mostly rely on defaults for spacing, origin etc for this filter
   typedef itk::Image<T, 3> ImageType;
-  typename ImageType::Pointer inImage = ImageType::New();
-  inImage->GetPixelContainer()->SetImportPointer(inPtr, dims[0]*dims[1]*dims[2], false);
-  typename ImageType::RegionType region;
-  typename ImageType::IndexType index;
-  typename ImageType::SizeType size;
-  index[0] = index[1] = index[2] = 0;
-  size[0] = dims[0];
-  size[1] = dims[1];
-  size[2] = dims[2];
-  region.SetIndex(index);
-  region.SetSize(size);
-  inImage->SetLargestPossibleRegion(region);
-  inImage->SetBufferedRegion(region);
-  inImage->SetSpacing(spacing);
+  typename ImageType::Pointer inImage = vtkITKImportImageBuffer<ImageType>(inPtr, dims, spacing);
 
 
   // Calculate the distance transform
@@ -63,11 +51,13 @@ void vtkITKMorphologicalContourInterpolatorExecute(vtkITKMorphologicalContourInt
   interpolatorFilter->SetUseBallStructuringElement(self->GetUseBallStructuringElement());
 
   interpolatorFilter->SetInput( inImage );
+
+  // Write the interpolated labels directly into the output
+  vtkITKImageBridgeOutput<ImageType> outputBridge(interpolatorFilter, outPtr, inImage->GetBufferedRegion().GetNumberOfPixels());
   interpolatorFilter->Update();
 
-  // Copy to the output
-  memcpy(outPtr, interpolatorFilter->GetOutput()->GetBufferPointer(),
-         interpolatorFilter->GetOutput()->GetBufferedRegion().GetNumberOfPixels() * sizeof(T));
+  // Copy to the output, unless the filter wrote it there already
+  outputBridge.CopyOutput();
 
 }
 
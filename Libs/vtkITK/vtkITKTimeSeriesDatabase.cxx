@@ -8,10 +8,14 @@
 ==========================================================================*/
 #include "vtkITKTimeSeriesDatabase.h"
 
+// ITK includes
+#include <itkImageRegionConstIterator.h>
+
+// VTK includes
+#include <vtkDoubleArray.h>
 #include <vtkInformation.h>
 #include <vtkInformationVector.h>
 #include <vtkStreamingDemandDrivenPipeline.h>
-#include <vtkUnsignedLongArray.h>
 
 vtkStandardNewMacro(vtkITKTimeSeriesDatabase);
 int vtkITKTimeSeriesDatabase::RequestInformation(
@@ -48,13 +52,55 @@ int vtkITKTimeSeriesDatabase::RequestInformation(
   // defined in the subclasses
 void vtkITKTimeSeriesDatabase::ExecuteDataWithInformation(vtkDataObject *output, vtkInformation* outInfo)
   {
-    this->AllocateOutputData(output, outInfo);
-    itk::ImportImageContainer<itk::SizeValueType, OutputImagePixelType>::Pointer PixelContainerShort;
-    PixelContainerShort = this->m_Filter->GetOutput()->GetPixelContainer();
-    void *ptr = static_cast<void *> (PixelContainerShort->GetBufferPointer());
-    vtkUnsignedLongArray::SafeDownCast(
-      vtkImageData::SafeDownCast(output)->GetPointData()->GetScalars())
-      ->SetVoidArray(ptr, PixelContainerShort->Size(), 0,
-                     vtkAOSDataArrayTemplate<unsigned long>::VTK_DATA_ARRAY_DELETE);
-    PixelContainerShort->ContainerManageMemoryOff();
+    vtkImageData* outputImage = this->AllocateOutputData(output, outInfo);
+    int* extent = outputImage->GetExtent();
+    if (extent[0] > extent[1] || extent[2] > extent[3] || extent[4] > extent[5])
+      {
+      return;
+      }
+
+    // only the blocks that intersect the update extent are read, by multiple threads
+    OutputImageType::RegionType region;
+    for (int i = 0; i < 3; i++)
+      {
+      region.SetIndex(i, extent[2 * i]);
+      region.SetSize(i, extent[2 * i + 1] - extent[2 * i] + 1);
+      }
+    this->m_Filter->GetOutput()->SetRequestedRegion(region);
+    this->m_Filter->Update();
+
+    // the buffered region of the filter output may be larger than the requested region
+    OutputImagePixelType* outputPtr = static_cast<OutputImagePixelType*>(outputImage->GetScalarPointer());
+    itk::ImageRegionConstIterator<OutputImageType> it(this->m_Filter->GetOutput(), region);
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+      {
+      *outputPtr++ = it.Get();
+      }
   };
+
+//----------------------------------------------------------------------------
+bool vtkITKTimeSeriesDatabase::GetVoxelTimeSeries(int i, int j, int k, vtkDoubleArray* values)
+{
+  if (!values)
+    {
+    vtkErrorMacro("GetVoxelTimeSeries: invalid values array");
+    return false;
+    }
+  SourceType::OutputImageType::IndexType index = {{ i, j, k }};
+  SourceType::ArrayType timeSeries;
+  try
+    {
+    this->m_Filter->GetVoxelTimeSeries(index, timeSeries);
+    }
+  catch (itk::ExceptionObject& e)
+    {
+    vtkErrorMacro("GetVoxelTimeSeries: " << e.GetDescription());
+    return false;
+    }
+  values->SetNumberOfValues(timeSeries.GetSize());
+  for (unsigned int volume = 0; volume < timeSeries.GetSize(); volume++)
+    {
+    values->SetValue(volume, timeSeries[volume]);
+    }
+  return true;
+}
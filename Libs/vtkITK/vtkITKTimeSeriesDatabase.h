@@ -23,6 +23,8 @@
 #include "vtkITK.h"
 #include "vtkITKUtility.h"
 
+class vtkDoubleArray;
+
 /// \brief Efficiently process large datasets in small memory.
 ///
 /// TimeSeriesDatabase creates a database on disk from a series of volumes
@@ -49,8 +51,27 @@ public:
   };
 
   /// Connect/Disconnect to a database
-  /// void Connect ( const char* filename ) { this->m_Filter->Connect ( filename ); this->Modified(); };
-  /// void Disconnect() { this->m_Filter->Disconnect(); }
+  void Connect ( const char* filename ) { this->m_Filter->Connect ( filename ); this->Modified(); };
+  void Disconnect() { this->m_Filter->Disconnect(); this->Modified(); }
+
+  /// Memory map the database files instead of reading them through a block
+  /// cache. Takes effect on the next Connect. On by default.
+  void SetUseMemoryMapping ( bool value )
+  { DelegateITKInputMacro ( SetUseMemoryMapping, value ); };
+  bool GetUseMemoryMapping ()
+  { DelegateITKOutputMacro ( GetUseMemoryMapping ); };
+  vtkBooleanMacro(UseMemoryMapping, bool);
+
+  /// Size of the block cache used when the files are not memory mapped
+  void SetCacheSizeInMiB ( float value )
+  { DelegateITKInputMacro ( SetCacheSizeInMiB, value ); };
+  float GetCacheSizeInMiB ()
+  { DelegateITKOutputMacro ( GetCacheSizeInMiB ); };
+
+  /// Get the values of the voxel at IJK index over all the volumes.
+  /// May be called from multiple threads. Returns false if the index is
+  /// outside of the volume or the database is not connected.
+  bool GetVoxelTimeSeries ( int i, int j, int k, vtkDoubleArray* values );
 
   /// Get/Set the current time stamp to read
   void SetCurrentImage ( unsigned int value )
@@ -14,6 +14,7 @@ PURPOSE.  See the above copyright notice for more information.
 
 =========================================================================*/
 #include "vtkITKWandImageFilter.h"
+#include "vtkITKImageBridge.h"
 
 #include "vtkDataArray.h"
 #include "vtkObjectFactory.h"
@@ -50,19 +51,7 @@ void vtkITKWandExecute(vtkITKWandImageFilter *self, vtkImageData* input,
   // Wrap scalars into an ITK image
   // - mostly rely on defaults for spacing, origin etc for this filter
   typedef itk::Image<T, 3> ImageType;
-  typename ImageType::Pointer inImage = ImageType::New();
-  inImage->GetPixelContainer()->SetImportPointer(inPtr, dims[0]*dims[1]*dims[2], false);
-  typename ImageType::RegionType region;
-  typename ImageType::IndexType index;
-  typename ImageType::SizeType size;
-  index[0] = index[1] = index[2] = 0;
-  size[0] = dims[0];
-  size[1] = dims[1];
-  size[2] = dims[2];
-  region.SetIndex(index);
-  region.SetSize(size);
-  inImage->SetLargestPossibleRegion(region);
-  inImage->SetBufferedRegion(region);
+  typename ImageType::Pointer inImage = vtkITKImportImageBuffer<ImageType>(inPtr, dims);
 
   // get the value at the seed location
   typename ImageType::IndexType ind;
@@ -96,11 +85,13 @@ void vtkITKWandExecute(vtkITKWandImageFilter *self, vtkImageData* input,
   wand->SetReplaceValue(1);
 
   wand->SetInput( inImage );
+
+  // Write the segmentation directly into the output
+  vtkITKImageBridgeOutput<SegmentImageType> outputBridge(wand, outPtr, inImage->GetBufferedRegion().GetNumberOfPixels());
   wand->Update();
 
-  // Copy to the output
-  memcpy(outPtr, wand->GetOutput()->GetBufferPointer(),
-         wand->GetOutput()->GetBufferedRegion().GetNumberOfPixels() * sizeof(T));
+  // Copy to the output, unless the filter wrote it there already
+  outputBridge.CopyOutput();
 
 }
 
@@ -20,6 +20,7 @@
 
 // VTK includes
 #include <vtkImageAccumulate.h>
+#include <vtkImageConstantPad.h>
 #include <vtkImageThreshold.h>
 #include <vtkMatrix4x4.h>
 #include <vtkNew.h>
@@ -38,6 +39,9 @@
 #include "vtkSegmentationConverterFactory.h"
 #include "vtkSegmentationHistory.h"
 
+// STD includes
+#include <algorithm>
+
 
 int CreateCubeLabelmap(vtkOrientedImageData* imageData, int extent[6]);
 void SetReferenceGeometry(vtkSegmentation*);
@@ -178,6 +182,170 @@ int vtkSegmentationHistoryTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
     return EXIT_FAILURE;
     }
 
+  /////////////////////////////////////////////////
+  // Test storing labelmap differences
+  // Previous states only keep the modified region,
+  // but they can be restored the same way
+  /////////////////////////////////////////////////
+  history->SetMaximumNumberOfStates(10);
+  vtkNew<vtkSegmentationHistory> fullCopyHistory;
+  fullCopyHistory->StoreLabelmapDifferencesOff();
+  fullCopyHistory->SetMaximumNumberOfStates(10);
+  fullCopyHistory->SetSegmentation(segmentation);
+
+  std::vector<int> savedSegment2VoxelCounts;
+  const int numberOfStrokes = 4;
+  for (int strokeIndex = 0; strokeIndex < numberOfStrokes; ++strokeIndex)
+    {
+    history->SaveState();
+    fullCopyHistory->SaveState();
+    vtkOrientedImageData* currentLabelmap = vtkOrientedImageData::SafeDownCast(segment1->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+    savedSegment2VoxelCounts.push_back(GetVoxelCount(currentLabelmap, segment2LabelValue));
+    int strokeExtent[6] = { 20, 21, strokeIndex * 2, strokeIndex * 2 + 1, 0, 1 };
+    vtkNew<vtkOrientedImageData> strokeLabelmap;
+    CreateCubeLabelmap(strokeLabelmap, strokeExtent);
+    vtkOrientedImageDataResample::ModifyImage(currentLabelmap, strokeLabelmap, vtkOrientedImageDataResample::OPERATION_MASKING, nullptr, 0.0, segment2LabelValue);
+    }
+  vtkOrientedImageData* strokesLabelmap = vtkOrientedImageData::SafeDownCast(segment1->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+  int strokesSegment2VoxelCount = GetVoxelCount(strokesLabelmap, segment2LabelValue);
+
+  if (history->GetActualMemorySize() >= fullCopyHistory->GetActualMemorySize())
+    {
+    std::cerr << "History that stores labelmap differences uses " << history->GetActualMemorySize()
+      << " KiB, history that stores full copies uses " << fullCopyHistory->GetActualMemorySize() << " KiB" << std::endl;
+    return EXIT_FAILURE;
+    }
+  fullCopyHistory->SetSegmentation(nullptr);
+
+  for (int strokeIndex = numberOfStrokes - 1; strokeIndex >= 0; --strokeIndex)
+    {
+    history->RestorePreviousState();
+    vtkOrientedImageData* restoredLabelmap = vtkOrientedImageData::SafeDownCast(segment1->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+    int restoredSegment2VoxelCount = GetVoxelCount(restoredLabelmap, segment2LabelValue);
+    if (restoredSegment2VoxelCount != savedSegment2VoxelCounts[strokeIndex])
+      {
+      std::cerr << "Segment 2 voxel count before stroke " << strokeIndex << " (" << savedSegment2VoxelCounts[strokeIndex]
+        << ") and undo voxel count (" << restoredSegment2VoxelCount << ") does not match!" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  while (history->IsRestoreNextStateAvailable())
+    {
+    history->RestoreNextState();
+    }
+  strokesLabelmap = vtkOrientedImageData::SafeDownCast(segment1->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+  if (GetVoxelCount(strokesLabelmap, segment2LabelValue) != strokesSegment2VoxelCount)
+    {
+    std::cerr << "Segment 2 voxel count after strokes (" << strokesSegment2VoxelCount << ") and redo voxel count ("
+      << GetVoxelCount(strokesLabelmap, segment2LabelValue) << ") does not match!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  /////////////////////////////////////////////////
+  // Test edits that change the labelmap extent
+  // Differences cannot be computed between labelmaps
+  // of different extents, complete labelmaps are kept
+  /////////////////////////////////////////////////
+  const int numberOfExtentChanges = 2;
+  int changedExtents[numberOfExtentChanges][6] =
+    {
+      { -5, 35, 0, 30, 0, 28 }, // grow
+      { 2, 20, 3, 18, 1, 22 }   // crop
+    };
+  std::vector<int> savedExtents;
+  savedSegment2VoxelCounts.clear();
+  for (int changeIndex = 0; changeIndex < numberOfExtentChanges; ++changeIndex)
+    {
+    history->SaveState();
+    vtkOrientedImageData* currentLabelmap = vtkOrientedImageData::SafeDownCast(segment1->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+    savedSegment2VoxelCounts.push_back(GetVoxelCount(currentLabelmap, segment2LabelValue));
+    savedExtents.insert(savedExtents.end(), currentLabelmap->GetExtent(), currentLabelmap->GetExtent() + 6);
+
+    vtkNew<vtkImageConstantPad> padder;
+    padder->SetInputData(currentLabelmap);
+    padder->SetOutputWholeExtent(changedExtents[changeIndex]);
+    padder->SetConstant(0);
+    padder->Update();
+    currentLabelmap->DeepCopy(padder->GetOutput());
+    int strokeExtent[6] = { 2, 4 + changeIndex, 3, 5, 1, 2 };
+    vtkNew<vtkOrientedImageData> strokeLabelmap;
+    CreateCubeLabelmap(strokeLabelmap, strokeExtent);
+    vtkOrientedImageDataResample::ModifyImage(currentLabelmap, strokeLabelmap, vtkOrientedImageDataResample::OPERATION_MASKING, nullptr, 0.0, segment2LabelValue);
+    }
+  vtkOrientedImageData* changedLabelmap = vtkOrientedImageData::SafeDownCast(segment1->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+  int changedSegment2VoxelCount = GetVoxelCount(changedLabelmap, segment2LabelValue);
+
+  for (int changeIndex = numberOfExtentChanges - 1; changeIndex >= 0; --changeIndex)
+    {
+    history->RestorePreviousState();
+    vtkOrientedImageData* restoredLabelmap = vtkOrientedImageData::SafeDownCast(segment1->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+    if (!std::equal(savedExtents.begin() + changeIndex * 6, savedExtents.begin() + changeIndex * 6 + 6, restoredLabelmap->GetExtent()))
+      {
+      std::cerr << "Labelmap extent before extent change " << changeIndex << " is not restored by undo" << std::endl;
+      return EXIT_FAILURE;
+      }
+    int restoredSegment2VoxelCount = GetVoxelCount(restoredLabelmap, segment2LabelValue);
+    if (restoredSegment2VoxelCount != savedSegment2VoxelCounts[changeIndex])
+      {
+      std::cerr << "Segment 2 voxel count before extent change " << changeIndex << " (" << savedSegment2VoxelCounts[changeIndex]
+        << ") and undo voxel count (" << restoredSegment2VoxelCount << ") does not match!" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  while (history->IsRestoreNextStateAvailable())
+    {
+    history->RestoreNextState();
+    }
+  changedLabelmap = vtkOrientedImageData::SafeDownCast(segment1->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+  if (!std::equal(changedExtents[numberOfExtentChanges - 1], changedExtents[numberOfExtentChanges - 1] + 6, changedLabelmap->GetExtent()))
+    {
+    std::cerr << "Labelmap extent after extent changes is not restored by redo" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (GetVoxelCount(changedLabelmap, segment2LabelValue) != changedSegment2VoxelCount)
+    {
+    std::cerr << "Segment 2 voxel count after extent changes (" << changedSegment2VoxelCount << ") and redo voxel count ("
+      << GetVoxelCount(changedLabelmap, segment2LabelValue) << ") does not match!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  /////////////////////////////////////////////////
+  // Test splitting the shared labelmap
+  // The labelmap of the last state is now stored in
+  // two labelmaps, so its voxel array is not reused
+  /////////////////////////////////////////////////
+  history->SaveState();
+  vtkOrientedImageData* sharedLabelmap = vtkOrientedImageData::SafeDownCast(segment1->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+  int sharedSegment1VoxelCount = GetVoxelCount(sharedLabelmap, segment1LabelValue);
+  int sharedSegment2VoxelCount = GetVoxelCount(sharedLabelmap, segment2LabelValue);
+  vtkNew<vtkOrientedImageData> separateLabelmap;
+  separateLabelmap->DeepCopy(sharedLabelmap);
+  segment2->AddRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName(), separateLabelmap);
+  int separateStrokeExtent[6] = { 12, 14, 12, 14, 3, 4 };
+  vtkNew<vtkOrientedImageData> separateStrokeLabelmap;
+  CreateCubeLabelmap(separateStrokeLabelmap, separateStrokeExtent);
+  vtkOrientedImageDataResample::ModifyImage(separateLabelmap, separateStrokeLabelmap, vtkOrientedImageDataResample::OPERATION_MASKING, nullptr, 0.0, segment2LabelValue);
+  int separateSegment2VoxelCount = GetVoxelCount(separateLabelmap, segment2LabelValue);
+
+  history->RestorePreviousState();
+  vtkOrientedImageData* restoredSegment1Labelmap = vtkOrientedImageData::SafeDownCast(segment1->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+  vtkOrientedImageData* restoredSegment2Labelmap = vtkOrientedImageData::SafeDownCast(segment2->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+  if (restoredSegment1Labelmap != restoredSegment2Labelmap
+    || GetVoxelCount(restoredSegment1Labelmap, segment1LabelValue) != sharedSegment1VoxelCount
+    || GetVoxelCount(restoredSegment1Labelmap, segment2LabelValue) != sharedSegment2VoxelCount)
+    {
+    std::cerr << "Shared labelmap is not restored by undo after splitting it" << std::endl;
+    return EXIT_FAILURE;
+    }
+  history->RestoreNextState();
+  restoredSegment2Labelmap = vtkOrientedImageData::SafeDownCast(segment2->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+  if (GetVoxelCount(restoredSegment2Labelmap, segment2LabelValue) != separateSegment2VoxelCount)
+    {
+    std::cerr << "Segment 2 voxel count in the separate labelmap (" << separateSegment2VoxelCount << ") and redo voxel count ("
+      << GetVoxelCount(restoredSegment2Labelmap, segment2LabelValue) << ") does not match!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
   std::cout << "Segmentation history test 1 passed." << std::endl;
   return EXIT_SUCCESS;
 }
@@ -19,6 +19,7 @@
 ==============================================================================*/
 
 // VTK includes
+#include <vtkCallbackCommand.h>
 #include <vtkNew.h>
 #include <vtkVersion.h>
 #include <vtkPointData.h>
@@ -41,6 +42,7 @@ void CreateSpherePolyData(vtkPolyData* polyData, double center[3], double radius
 int CreateCubeLabelmap(vtkOrientedImageData* imageData, int extent[6]);
 
 void SetReferenceGeometry(vtkSegmentation*);
+void CreateCubeLabelmapSegmentation(vtkSegmentation* segmentation);
 
 bool TestSharedLabelmapConversion()
 {
@@ -314,6 +316,79 @@ bool TestSharedLabelmapCasting()
   return true;
 }
 
+//----------------------------------------------------------------------------
+void AbortConversionCallback(vtkObject* caller, unsigned long vtkNotUsed(eid), void* vtkNotUsed(clientData), void* vtkNotUsed(callData))
+{
+  vtkSegmentation::SafeDownCast(caller)->AbortConversion();
+}
+
+//----------------------------------------------------------------------------
+bool TestParallelConversion()
+{
+  std::string closedSurfaceName = vtkSegmentationConverter::GetClosedSurfaceRepresentationName();
+
+  vtkNew<vtkSegmentation> sequentialSegmentation;
+  CreateCubeLabelmapSegmentation(sequentialSegmentation);
+  if (sequentialSegmentation->GetNumberOfConversionThreads() != 1)
+    {
+    std::cerr << __LINE__ << ": Parallel conversion must be disabled by default" << std::endl;
+    return false;
+    }
+  // Non-default parameters must be used by all the threads
+  sequentialSegmentation->SetConversionParameter(
+    vtkBinaryLabelmapToClosedSurfaceConversionRule::GetDecimationFactorParameterName(), "0.3");
+  if (!sequentialSegmentation->CreateRepresentation(closedSurfaceName))
+    {
+    std::cerr << __LINE__ << ": Sequential conversion failed" << std::endl;
+    return false;
+    }
+
+  vtkNew<vtkSegmentation> parallelSegmentation;
+  CreateCubeLabelmapSegmentation(parallelSegmentation);
+  parallelSegmentation->SetNumberOfConversionThreads(4);
+  parallelSegmentation->SetConversionParameter(
+    vtkBinaryLabelmapToClosedSurfaceConversionRule::GetDecimationFactorParameterName(), "0.3");
+  if (!parallelSegmentation->CreateRepresentation(closedSurfaceName))
+    {
+    std::cerr << __LINE__ << ": Parallel conversion failed" << std::endl;
+    return false;
+    }
+
+  // Results must not depend on the number of threads
+  std::vector<std::string> segmentIDs;
+  sequentialSegmentation->GetSegmentIDs(segmentIDs);
+  for (std::string segmentID : segmentIDs)
+    {
+    vtkPolyData* sequentialSurface = vtkPolyData::SafeDownCast(
+      sequentialSegmentation->GetSegment(segmentID)->GetRepresentation(closedSurfaceName));
+    vtkPolyData* parallelSurface = vtkPolyData::SafeDownCast(
+      parallelSegmentation->GetSegment(segmentID)->GetRepresentation(closedSurfaceName));
+    if (!sequentialSurface || !parallelSurface
+      || sequentialSurface->GetNumberOfPoints() == 0
+      || sequentialSurface->GetNumberOfPoints() != parallelSurface->GetNumberOfPoints()
+      || sequentialSurface->GetNumberOfCells() != parallelSurface->GetNumberOfCells())
+      {
+      std::cerr << __LINE__ << ": Closed surface mismatch in segment " << segmentID << std::endl;
+      return false;
+      }
+    }
+
+  // Conversion can be aborted from a progress observer
+  vtkNew<vtkSegmentation> abortedSegmentation;
+  CreateCubeLabelmapSegmentation(abortedSegmentation);
+  abortedSegmentation->SetNumberOfConversionThreads(4);
+  vtkNew<vtkCallbackCommand> abortCommand;
+  abortCommand->SetCallback(AbortConversionCallback);
+  abortedSegmentation->AddObserver(vtkCommand::ProgressEvent, abortCommand);
+  if (abortedSegmentation->CreateRepresentation(closedSurfaceName))
+    {
+    std::cerr << __LINE__ << ": Aborted conversion should return false" << std::endl;
+    return false;
+    }
+
+  return true;
+}
+
 //----------------------------------------------------------------------------
 int vtkSegmentationTest2(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
 {
@@ -338,6 +413,11 @@ int vtkSegmentationTest2(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
     return EXIT_FAILURE;
     }
 
+  if (!TestParallelConversion())
+    {
+    return EXIT_FAILURE;
+    }
+
   std::cout << "Segmentation test 2 passed." << std::endl;
   return EXIT_SUCCESS;
 }
@@ -357,6 +437,21 @@ void SetReferenceGeometry(vtkSegmentation* segmentation)
     vtkSegmentationConverter::GetReferenceImageGeometryParameterName(), referenceGeometryString);
 }
 
+//----------------------------------------------------------------------------
+void CreateCubeLabelmapSegmentation(vtkSegmentation* segmentation)
+{
+  // Each segment has its own labelmap, so that they can be converted in parallel
+  for (int i = 0; i < 6; ++i)
+    {
+    vtkNew<vtkOrientedImageData> cubeImage;
+    int extent[6] = { 0, 4 + i, 0, 4 + 2 * i, 0, 4 };
+    CreateCubeLabelmap(cubeImage, extent);
+    vtkNew<vtkSegment> segment;
+    segment->AddRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName(), cubeImage);
+    segmentation->AddSegment(segment);
+    }
+}
+
 //----------------------------------------------------------------------------
 void CreateSpherePolyData(vtkPolyData* polyData, double center[3], double radius)
 {
@@ -0,0 +1,198 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// VTK includes
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+
+// SegmentationCore includes
+#include "vtkOrientedImageData.h"
+#include "vtkOrientedImageDataResample.h"
+#include "vtkSparseOrientedImageData.h"
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+void CreateLabelmap(vtkOrientedImageData* image, const int extent[6], const int boxExtent[6], unsigned char value)
+{
+  vtkNew<vtkMatrix4x4> imageToWorldMatrix;
+  imageToWorldMatrix->SetElement(0, 0, 0.5);
+  imageToWorldMatrix->SetElement(1, 1, 0.5);
+  imageToWorldMatrix->SetElement(2, 2, 2.0);
+  imageToWorldMatrix->SetElement(0, 3, -20.0);
+  image->SetImageToWorldMatrix(imageToWorldMatrix.GetPointer());
+  image->SetExtent(const_cast<int*>(extent));
+  image->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  vtkOrientedImageDataResample::FillImage(image, 0);
+  vtkOrientedImageDataResample::FillImage(image, value, boxExtent);
+}
+
+//----------------------------------------------------------------------------
+bool AreImagesEqual(vtkOrientedImageData* image1, vtkOrientedImageData* image2)
+{
+  int* extent = image1->GetExtent();
+  int* extent2 = image2->GetExtent();
+  for (int i = 0; i < 6; ++i)
+    {
+    if (extent[i] != extent2[i])
+      {
+      std::cerr << "Extent mismatch" << std::endl;
+      return false;
+      }
+    }
+  if (!vtkOrientedImageDataResample::DoGeometriesMatch(image1, image2))
+    {
+    std::cerr << "Geometry mismatch" << std::endl;
+    return false;
+    }
+  for (int k = extent[4]; k <= extent[5]; ++k)
+    {
+    for (int j = extent[2]; j <= extent[3]; ++j)
+      {
+      for (int i = extent[0]; i <= extent[1]; ++i)
+        {
+        unsigned char value1 = *static_cast<unsigned char*>(image1->GetScalarPointer(i, j, k));
+        unsigned char value2 = *static_cast<unsigned char*>(image2->GetScalarPointer(i, j, k));
+        if (value1 != value2)
+          {
+          std::cerr << "Voxel mismatch at (" << i << ", " << j << ", " << k << "): "
+            << int(value1) << " != " << int(value2) << std::endl;
+          return false;
+          }
+        }
+      }
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkSparseOrientedImageDataTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  // Small segment in a large image. Extent does not start at a tile boundary.
+  int extent[6] = { -5, 250, 3, 260, 0, 99 };
+  int boxExtent[6] = { 40, 90, 30, 100, 10, 60 };
+  vtkNew<vtkOrientedImageData> denseImage;
+  CreateLabelmap(denseImage.GetPointer(), extent, boxExtent, 1);
+
+  vtkNew<vtkSparseOrientedImageData> sparseImage;
+  sparseImage->SetTileSize(16);
+  sparseImage->SetFromImage(denseImage.GetPointer());
+  if (sparseImage->GetNumberOfStoredTiles() == 0
+    || sparseImage->GetNumberOfDenseTiles() >= sparseImage->GetNumberOfStoredTiles())
+    {
+    std::cerr << "Unexpected number of tiles: " << sparseImage->GetNumberOfStoredTiles()
+      << " stored, " << sparseImage->GetNumberOfDenseTiles() << " dense" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (sparseImage->GetActualMemorySize() * 10 > denseImage->GetActualMemorySize())
+    {
+    std::cerr << "Sparse image is too large: " << sparseImage->GetActualMemorySize() << "kB, dense image: "
+      << denseImage->GetActualMemorySize() << "kB" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Round trip
+  vtkNew<vtkOrientedImageData> restoredImage;
+  sparseImage->GetImage(restoredImage.GetPointer());
+  if (!AreImagesEqual(denseImage.GetPointer(), restoredImage.GetPointer()))
+    {
+    std::cerr << "Dense image differs from the original image" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Occupied extent must contain the segment
+  int occupiedExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  if (!sparseImage->GetOccupiedExtent(occupiedExtent))
+    {
+    std::cerr << "Occupied extent is empty" << std::endl;
+    return EXIT_FAILURE;
+    }
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    if (occupiedExtent[axis * 2] > boxExtent[axis * 2] || occupiedExtent[axis * 2 + 1] < boxExtent[axis * 2 + 1])
+      {
+      std::cerr << "Occupied extent does not contain the segment" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Modify with the same operations as dense images
+  int modifierExtent[6] = { 0, 120, 0, 120, 0, 50 };
+  int modifierBoxExtent[6] = { 80, 110, 60, 100, 20, 40 };
+  vtkNew<vtkOrientedImageData> modifierImage;
+  CreateLabelmap(modifierImage.GetPointer(), modifierExtent, modifierBoxExtent, 2);
+  int operations[3] = { vtkOrientedImageDataResample::OPERATION_MAXIMUM,
+    vtkOrientedImageDataResample::OPERATION_MINIMUM, vtkOrientedImageDataResample::OPERATION_MASKING };
+  for (int operation : operations)
+    {
+    vtkNew<vtkOrientedImageData> expectedImage;
+    expectedImage->DeepCopy(denseImage.GetPointer());
+    vtkOrientedImageDataResample::ModifyImage(expectedImage.GetPointer(), modifierImage.GetPointer(), operation);
+    vtkNew<vtkSparseOrientedImageData> modifiedSparseImage;
+    modifiedSparseImage->DeepCopy(sparseImage.GetPointer());
+    if (!vtkOrientedImageDataResample::ModifyImage(modifiedSparseImage.GetPointer(), modifierImage.GetPointer(), operation))
+      {
+      std::cerr << "Failed to modify sparse image" << std::endl;
+      return EXIT_FAILURE;
+      }
+    vtkNew<vtkOrientedImageData> modifiedImage;
+    modifiedSparseImage->GetImage(modifiedImage.GetPointer());
+    if (!AreImagesEqual(expectedImage.GetPointer(), modifiedImage.GetPointer()))
+      {
+      std::cerr << "Sparse and dense ModifyImage results differ for operation " << operation << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Merge extends the extent
+  int appendedExtent[6] = { 200, 300, 200, 300, 90, 120 };
+  int appendedBoxExtent[6] = { 240, 280, 250, 290, 95, 110 };
+  vtkNew<vtkOrientedImageData> appendedImage;
+  CreateLabelmap(appendedImage.GetPointer(), appendedExtent, appendedBoxExtent, 3);
+  vtkNew<vtkOrientedImageData> expectedMergedImage;
+  vtkOrientedImageDataResample::MergeImage(denseImage.GetPointer(), appendedImage.GetPointer(), expectedMergedImage.GetPointer(),
+    vtkOrientedImageDataResample::OPERATION_MAXIMUM);
+  vtkNew<vtkSparseOrientedImageData> mergedSparseImage;
+  bool outputModified = false;
+  vtkOrientedImageDataResample::MergeImage(sparseImage.GetPointer(), appendedImage.GetPointer(), mergedSparseImage.GetPointer(),
+    vtkOrientedImageDataResample::OPERATION_MAXIMUM, nullptr, 0, 1, &outputModified);
+  vtkNew<vtkOrientedImageData> mergedImage;
+  mergedSparseImage->GetImage(mergedImage.GetPointer());
+  if (!outputModified || !AreImagesEqual(expectedMergedImage.GetPointer(), mergedImage.GetPointer()))
+    {
+    std::cerr << "Sparse and dense MergeImage results differ" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Shrinking and growing the extent removes voxels that were outside
+  int smallExtent[6] = { 50, 60, 55, 65, 15, 25 };
+  sparseImage->SetExtent(smallExtent);
+  sparseImage->SetExtent(extent);
+  vtkNew<vtkOrientedImageData> expectedCroppedImage;
+  CreateLabelmap(expectedCroppedImage.GetPointer(), extent, smallExtent, 1);
+  sparseImage->GetImage(restoredImage.GetPointer());
+  if (!AreImagesEqual(expectedCroppedImage.GetPointer(), restoredImage.GetPointer()))
+    {
+    std::cerr << "Unexpected voxels after changing extent" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Sparse oriented image data test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -161,7 +161,14 @@ bool vtkBinaryLabelmapToClosedSurfaceConversionRule::Convert(vtkSegment* segment
 
   if (jointSmoothing > 0 && smoothingFactor > 0)
     {
-    if (this->JointSmoothCache.find(orientedBinaryLabelmap) == this->JointSmoothCache.end())
+    vtkSmartPointer<vtkPolyData> sharedSurface;
+    std::map<vtkOrientedImageData*, vtkSmartPointer<vtkPolyData> >::iterator cachedSurfaceIt =
+      this->JointSmoothCache.find(orientedBinaryLabelmap);
+    if (cachedSurfaceIt != this->JointSmoothCache.end())
+      {
+      sharedSurface = cachedSurfaceIt->second;
+      }
+    if (!sharedSurface)
       {
       double* scalarRange = orientedBinaryLabelmap->GetScalarRange();
       int lowLabel = (int)(floor(scalarRange[0]));
@@ -188,10 +195,12 @@ bool vtkBinaryLabelmapToClosedSurfaceConversionRule::Convert(vtkSegment* segment
 
       vtkSmartPointer<vtkPolyData> jointSmoothedSurface = vtkSmartPointer<vtkPolyData>::New();
       this->CreateClosedSurface(orientedBinaryLabelmap, jointSmoothedSurface, labelValues);
+      // Segments of the previous labelmap are all converted already
+      this->JointSmoothCache.clear();
       this->JointSmoothCache[orientedBinaryLabelmap] = jointSmoothedSurface;
+      sharedSurface = jointSmoothedSurface;
       }
 
-    vtkDataObject* sharedSurface = this->JointSmoothCache[orientedBinaryLabelmap];
     if (!sharedSurface)
       {
       vtkErrorMacro("Convert: Could not find cached surface");
@@ -71,6 +71,9 @@ public:
   /// Update the target representation based on the source representation
   bool Convert(vtkSegment* segment) override;
 
+  /// Segments can be converted in parallel, except segments that share a labelmap
+  bool IsParallelConversionSupported() override { return true; };
+
   /// Perform postprocesing steps on the output
   /// Clears the joint smoothing cache
   bool PostConvert(vtkSegmentation* segmentation) override;
@@ -98,7 +101,10 @@ protected:
 
 protected:
   /// Cache for storing merged closed surfaces that have been joint smoothed
-  /// The key used is the binary labelmap representation, which maps to the combined vtkPolyData containing surfaces for all segments in the segmentation
+  /// The key used is the binary labelmap representation, which maps to the combined vtkPolyData containing surfaces for all segments in the segmentation.
+  /// Segments that share a labelmap are converted one after the other, therefore only the surface of the last labelmap is kept.
+  /// When segments are converted in parallel, each thread uses its own clone of the rule (see vtkSegmentation::ConvertSegmentGroupsInParallel),
+  /// so the cache is not shared between threads.
   std::map<vtkOrientedImageData*, vtkSmartPointer<vtkPolyData> > JointSmoothCache;
 
 private:
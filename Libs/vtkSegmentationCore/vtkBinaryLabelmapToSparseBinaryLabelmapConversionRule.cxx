@@ -0,0 +1,121 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// SegmentationCore includes
+#include "vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule.h"
+#include "vtkOrientedImageData.h"
+#include "vtkSegment.h"
+#include "vtkSparseOrientedImageData.h"
+
+// VTK includes
+#include <vtkImageThreshold.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+
+//----------------------------------------------------------------------------
+vtkSegmentationConverterRuleNewMacro(vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule);
+
+//----------------------------------------------------------------------------
+vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule::vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule()
+= default;
+
+//----------------------------------------------------------------------------
+vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule::~vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule()
+= default;
+
+//----------------------------------------------------------------------------
+unsigned int vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule::GetConversionCost(
+  vtkDataObject* vtkNotUsed(sourceRepresentation)/*=nullptr*/,
+  vtkDataObject* vtkNotUsed(targetRepresentation)/*=nullptr*/)
+{
+  // Rough input-independent guess (ms)
+  return 100;
+}
+
+//----------------------------------------------------------------------------
+vtkDataObject* vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule::ConstructRepresentationObjectByRepresentation(std::string representationName)
+{
+  if ( !representationName.compare(this->GetSourceRepresentationName()) )
+    {
+    return (vtkDataObject*)vtkOrientedImageData::New();
+    }
+  else if ( !representationName.compare(this->GetTargetRepresentationName()) )
+    {
+    return (vtkDataObject*)vtkSparseOrientedImageData::New();
+    }
+  else
+    {
+    return nullptr;
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkDataObject* vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule::ConstructRepresentationObjectByClass(std::string className)
+{
+  if (!className.compare("vtkOrientedImageData"))
+    {
+    return (vtkDataObject*)vtkOrientedImageData::New();
+    }
+  else if (!className.compare("vtkSparseOrientedImageData"))
+    {
+    return (vtkDataObject*)vtkSparseOrientedImageData::New();
+    }
+  else
+    {
+    return nullptr;
+    }
+}
+
+//----------------------------------------------------------------------------
+bool vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule::Convert(vtkSegment* segment)
+{
+  this->CreateTargetRepresentation(segment);
+
+  vtkOrientedImageData* binaryLabelmap = vtkOrientedImageData::SafeDownCast(
+    segment->GetRepresentation(this->GetSourceRepresentationName()));
+  if (!binaryLabelmap)
+    {
+    vtkErrorMacro("Convert: Source representation is not an oriented image data!");
+    return false;
+    }
+  vtkSparseOrientedImageData* sparseLabelmap = vtkSparseOrientedImageData::SafeDownCast(
+    segment->GetRepresentation(this->GetTargetRepresentationName()));
+  if (!sparseLabelmap)
+    {
+    vtkErrorMacro("Convert: Target representation is not a sparse oriented image data!");
+    return false;
+    }
+
+  if (binaryLabelmap->IsEmpty())
+    {
+    // Only the geometry is stored
+    return sparseLabelmap->SetFromImage(binaryLabelmap);
+    }
+
+  // The labelmap may be shared with other segments, keep only the voxels of this segment
+  vtkNew<vtkImageThreshold> threshold;
+  threshold->SetInputData(binaryLabelmap);
+  threshold->ThresholdBetween(segment->GetLabelValue(), segment->GetLabelValue());
+  threshold->SetInValue(1);
+  threshold->SetOutValue(0);
+  threshold->SetOutputScalarTypeToUnsignedChar();
+  threshold->Update();
+
+  vtkNew<vtkOrientedImageData> segmentLabelmap;
+  segmentLabelmap->ShallowCopy(threshold->GetOutput());
+  segmentLabelmap->CopyDirections(binaryLabelmap);
+  return sparseLabelmap->SetFromImage(segmentLabelmap);
+}
@@ -22,6 +22,7 @@
 #include "vtkOrientedImageDataResample.h"
 #include "vtkSegmentationConverter.h"
 #include "vtkOrientedImageData.h"
+#include "vtkSparseOrientedImageData.h"
 
 // VTK includes
 #include <vtkAppendPolyData.h>
@@ -1189,6 +1190,79 @@ bool vtkOrientedImageDataResample::ModifyImage(
   return true;
 }
 
+//----------------------------------------------------------------------------
+bool vtkOrientedImageDataResample::MergeImage(
+    vtkSparseOrientedImageData* inputImage,
+    vtkOrientedImageData* imageToAppend,
+    vtkSparseOrientedImageData* outputImage,
+    int operation,
+    const int extent[6]/*=nullptr*/,
+    double maskThreshold /*=0*/,
+    double fillValue /*=1*/,
+    bool *outputModified /*=nullptr*/)
+{
+  if (outputModified != nullptr)
+    {
+    (*outputModified) = false;
+    }
+  if (!inputImage || !imageToAppend || !outputImage)
+    {
+    return false;
+    }
+
+  vtkNew<vtkOrientedImageData> inputGeometryImage;
+  inputImage->GetGeometryImage(inputGeometryImage.GetPointer());
+  if (!vtkOrientedImageDataResample::DoGeometriesMatch(inputGeometryImage.GetPointer(), imageToAppend))
+    {
+    vtkGenericWarningMacro("vtkOrientedImageDataResample::MergeImage failed: geometry mismatch between inputImage and imageToAppend");
+    return false;
+    }
+
+  // Output extent is the union of the input extent and the (clipped) extent of the appended image
+  int outputExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  inputImage->GetExtent(outputExtent);
+  int appendedExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  imageToAppend->GetExtent(appendedExtent);
+  for (int i = 0; i < 3; i++)
+    {
+    if (extent)
+      {
+      appendedExtent[i * 2] = std::max(appendedExtent[i * 2], extent[i * 2]);
+      appendedExtent[i * 2 + 1] = std::min(appendedExtent[i * 2 + 1], extent[i * 2 + 1]);
+      }
+    }
+  bool inputEmpty = (outputExtent[0] > outputExtent[1] || outputExtent[2] > outputExtent[3] || outputExtent[4] > outputExtent[5]);
+  bool appendedEmpty = (appendedExtent[0] > appendedExtent[1] || appendedExtent[2] > appendedExtent[3] || appendedExtent[4] > appendedExtent[5]);
+  for (int i = 0; i < 3 && !appendedEmpty; i++)
+    {
+    outputExtent[i * 2] = (inputEmpty ? appendedExtent[i * 2] : std::min(outputExtent[i * 2], appendedExtent[i * 2]));
+    outputExtent[i * 2 + 1] = (inputEmpty ? appendedExtent[i * 2 + 1] : std::max(outputExtent[i * 2 + 1], appendedExtent[i * 2 + 1]));
+    }
+
+  if (outputImage != inputImage)
+    {
+    outputImage->ShallowCopy(inputImage);
+    }
+  outputImage->SetExtent(outputExtent);
+  return outputImage->ModifyImage(imageToAppend, operation, extent, maskThreshold, fillValue, outputModified);
+}
+
+//----------------------------------------------------------------------------
+bool vtkOrientedImageDataResample::ModifyImage(
+    vtkSparseOrientedImageData* inputImage,
+    vtkOrientedImageData* modifierImage,
+    int operation,
+    const int extent[6]/*=0*/,
+    double maskThreshold /*=0*/,
+    double fillValue /*=1*/)
+{
+  if (!inputImage || !modifierImage)
+    {
+    return false;
+    }
+  return inputImage->ModifyImage(modifierImage, operation, extent, maskThreshold, fillValue);
+}
+
 //----------------------------------------------------------------------------
 bool vtkOrientedImageDataResample::CopyImage(vtkOrientedImageData* imageToCopy, vtkOrientedImageData* outputImage, const int extent[6]/*=0*/)
 {
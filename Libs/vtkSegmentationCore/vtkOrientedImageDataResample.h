@@ -33,6 +33,7 @@
 class vtkImageData;
 class vtkMatrix4x4;
 class vtkOrientedImageData;
+class vtkSparseOrientedImageData;
 class vtkTransform;
 class vtkAbstractTransform;
 
@@ -94,6 +95,17 @@ public:
   static bool ModifyImage(vtkOrientedImageData* inputImage, vtkOrientedImageData* modifierImage, int operation,
     const int extent[6] = nullptr, double maskThreshold = 0, double fillValue = 1);
 
+  /// Combines a sparse inputImage and a dense imageToAppend into a new sparse image by max/min operation.
+  /// Same as the dense version: the extent will be the union of the two images. Only the tiles
+  /// of the output image that overlap imageToAppend are processed.
+  static bool MergeImage(vtkSparseOrientedImageData* inputImage, vtkOrientedImageData* imageToAppend, vtkSparseOrientedImageData* outputImage, int operation,
+    const int extent[6]=nullptr, double maskThreshold = 0, double fillValue = 1, bool *outputModified=nullptr);
+
+  /// Modifies a sparse inputImage in-place by combining with a dense modifierImage using max/min operation.
+  /// Same as the dense version: the extent will remain unchanged.
+  static bool ModifyImage(vtkSparseOrientedImageData* inputImage, vtkOrientedImageData* modifierImage, int operation,
+    const int extent[6] = nullptr, double maskThreshold = 0, double fillValue = 1);
+
   /// Copy image with clipping to the specified extent
   static bool CopyImage(vtkOrientedImageData* imageToCopy, vtkOrientedImageData* outputImage, const int extent[6]=nullptr);
 
@@ -64,6 +64,8 @@ vtkSegment::vtkSegment()
 
   this->LabelValue = 1;
 
+  this->RepresentationsPending = false;
+
   // Set default terminology Tissue/Tissue from the default Slicer terminology dictionary
   this->SetTag( vtkSegment::GetTerminologyEntryTagName(),
     "Segmentation category and type - 3D Slicer General Anatomy list~SCT^85756007^Tissue~SCT^85756007^Tissue~^^~Anatomic codes - DICOM master list~^^~^^");
@@ -95,6 +97,7 @@ void vtkSegment::PrintSelf(ostream& os, vtkIndent indent)
 
   os << indent << "NameAutoGenerated: " << (this->NameAutoGenerated ? "true" : "false") << "\n";
   os << indent << "ColorAutoGenerated: " << (this->ColorAutoGenerated ? "true" : "false") << "\n";
+  os << indent << "RepresentationsPending: " << (this->RepresentationsPending ? "true" : "false") << "\n";
 
   RepresentationMap::iterator reprIt;
   os << indent << "Representations:\n";
@@ -264,6 +267,12 @@ void vtkSegment::GetBounds(double bounds[6])
 //---------------------------------------------------------------------------
 vtkDataObject* vtkSegment::GetRepresentation(std::string name)
 {
+  if (this->RepresentationsPending)
+    {
+    // Clear the flag first, as the observer accesses the representations while loading them
+    this->RepresentationsPending = false;
+    this->InvokeEvent(vtkSegment::RepresentationsPendingEvent);
+    }
   // Use find function instead of operator[] not to create empty representation if it is missing
   RepresentationMap::iterator reprIt = this->Representations.find(name);
   if (reprIt != this->Representations.end())
@@ -276,6 +285,13 @@ vtkDataObject* vtkSegment::GetRepresentation(std::string name)
     }
 }
 
+//---------------------------------------------------------------------------
+void vtkSegment::SetRepresentationsPending(bool pending)
+{
+  // Not a content change, therefore the segment is not modified
+  this->RepresentationsPending = pending;
+}
+
 //---------------------------------------------------------------------------
 bool vtkSegment::AddRepresentation(std::string name, vtkDataObject* representation)
 {
@@ -47,6 +47,12 @@ class vtkSegmentationCore_EXPORT vtkSegment : public vtkObject
   typedef std::map<std::string, vtkSmartPointer<vtkDataObject> > RepresentationMap;
 
 public:
+  enum
+    {
+    /// Invoked when a representation is requested while representations are pending
+    /// (see SetRepresentationsPending). Observers are expected to load the representations.
+    RepresentationsPendingEvent = 62200
+    };
 
   static const double SEGMENT_COLOR_INVALID[3];
 
@@ -73,6 +79,7 @@ public:
   virtual void GetBounds(double bounds[6]);
 
   /// Get representation of a given type. This class is not responsible for conversion, only storage!
+  /// If representations are pending then RepresentationsPendingEvent is invoked first.
   /// \param name Representation name. Default representation names can be queried from \sa vtkSegmentationConverter,
   ///   for example by calling vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName()
   /// \return The specified representation object, nullptr if not present
@@ -138,6 +145,13 @@ public:
   vtkGetMacro(LabelValue, int);
   vtkSetMacro(LabelValue, int);
 
+  /// Flag indicating that the content of the representations is not loaded yet (for example,
+  /// only the header of the segmentation file is read). The first GetRepresentation call clears
+  /// the flag and invokes RepresentationsPendingEvent, so that the observer can load the content.
+  /// Setting the flag does not modify the segment. False by default.
+  vtkGetMacro(RepresentationsPending, bool);
+  void SetRepresentationsPending(bool pending);
+
 protected:
   vtkSegment();
   ~vtkSegment() override;
@@ -152,6 +166,7 @@ protected:
   bool NameAutoGenerated;
   bool ColorAutoGenerated;
   int LabelValue;
+  bool RepresentationsPending;
 
 private:
   vtkSegment(const vtkSegment&) = delete;
@@ -47,8 +47,11 @@
 
 // STD includes
 #include <algorithm>
+#include <condition_variable>
 #include <functional>
+#include <mutex>
 #include <sstream>
+#include <thread>
 
 const int DEFAULT_LABEL_VALUE = 1;
 
@@ -84,6 +87,9 @@ vtkSegmentation::vtkSegmentation()
 
   this->SegmentIdAutogeneratorIndex = 0;
 
+  this->NumberOfConversionThreads = 1;
+  this->ConversionAborted = false;
+
   this->SetMasterRepresentationName(vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName());
 }
 
@@ -178,6 +184,7 @@ void vtkSegmentation::PrintSelf(ostream& os, vtkIndent indent)
 
   os << indent << "MasterRepresentationName:  " << this->MasterRepresentationName << "\n";
   os << indent << "Number of segments:  " << this->Segments.size() << "\n";
+  os << indent << "NumberOfConversionThreads:  " << this->NumberOfConversionThreads << "\n";
 
   for (std::deque< std::string >::iterator segmentIdIt = this->SegmentIds.begin();
     segmentIdIt != this->SegmentIds.end(); ++segmentIdIt)
@@ -333,6 +340,11 @@ bool vtkSegmentation::AddSegment(vtkSegment* segment, std::string segmentId/*=""
     {
     segment->AddObserver(vtkCommand::ModifiedEvent, this->SegmentCallbackCommand);
     }
+  // Requests for pending representations are forwarded regardless of SegmentModifiedEnabled
+  if (!segment->HasObserver(vtkSegment::RepresentationsPendingEvent, this->SegmentCallbackCommand))
+    {
+    segment->AddObserver(vtkSegment::RepresentationsPendingEvent, this->SegmentCallbackCommand);
+    }
 
   bool representationsCreated = true;
 
@@ -558,6 +570,7 @@ void vtkSegmentation::RemoveSegment(SegmentMap::iterator segmentIt)
 
   // Remove observation of segment modified event
   segmentIt->second.GetPointer()->RemoveObservers(vtkCommand::ModifiedEvent, this->SegmentCallbackCommand);
+  segmentIt->second.GetPointer()->RemoveObservers(vtkSegment::RepresentationsPendingEvent, this->SegmentCallbackCommand);
 
   this->SeparateSegmentLabelmap(segmentId);
 
@@ -615,6 +628,11 @@ void vtkSegmentation::OnSegmentModified(vtkObject* caller,
     }
 
   const char* segmentIdChars = segmentId.c_str();
+  if (eid == vtkSegment::RepresentationsPendingEvent)
+    {
+    self->InvokeEvent(vtkSegmentation::SegmentRepresentationsPending, (void*)(segmentIdChars));
+    return;
+    }
   if (eid == vtkCommand::ModifiedEvent)
     {
     self->InvokeEvent(vtkSegmentation::SegmentModified, (void*)(segmentIdChars));
@@ -1014,50 +1032,217 @@ bool vtkSegmentation::ConvertSegmentsUsingPath(std::vector<std::string> segmentI
     return true;
     }
 
+  int numberOfThreads = this->NumberOfConversionThreads;
+  if (numberOfThreads <= 0)
+    {
+    numberOfThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
   // Execute each conversion step in the selected path
-  vtkSegmentationConverter::ConversionPathType::iterator pathIt;
-  for (pathIt = path.begin(); pathIt != path.end(); ++pathIt)
+  int numberOfSteps = static_cast<int>(path.size());
+  for (int step = 0; step < numberOfSteps; ++step)
     {
-    vtkSegmentationConverterRule* currentConversionRule = (*pathIt);
+    vtkSegmentationConverterRule* currentConversionRule = path[step];
     if (!currentConversionRule)
       {
       vtkErrorMacro("ConvertSegmentsUsingPath: Invalid converter rule!");
       return false;
       }
+    std::string sourceRepresentationName = currentConversionRule->GetSourceRepresentationName();
+    std::string targetRepresentationName = currentConversionRule->GetTargetRepresentationName();
 
     // Perform conversion step
+    this->ConversionAborted = false;
     currentConversionRule->PreConvert(this);
+
+    // Collect segments to convert. Segments that share their source representation
+    // (segments in the same labelmap layer) are put in the same group, as they cannot
+    // be converted concurrently.
+    std::vector<std::vector<vtkSegment*> > segmentGroups;
+    std::map<vtkDataObject*, size_t> groupIndexForSource;
     for (auto segmentID : segmentIDs)
       {
       vtkSegment* segment = this->GetSegment(segmentID);
 
       // Get source representation from segment. It is expected to exist
-      vtkDataObject* sourceRepresentation = segment->GetRepresentation(
-        currentConversionRule->GetSourceRepresentationName());
+      vtkDataObject* sourceRepresentation = segment->GetRepresentation(sourceRepresentationName);
       if (!sourceRepresentation)
         {
         vtkErrorMacro("ConvertSegmentsUsingPath: Source representation does not exist!");
         return false;
         }
 
-      // Get target representation
-      vtkSmartPointer<vtkDataObject> targetRepresentation = segment->GetRepresentation(
-        currentConversionRule->GetTargetRepresentationName());
       // If target representation exists and we do not overwrite existing representations,
       // then no conversion is necessary with this conversion rule
-      if (targetRepresentation.GetPointer() && !overwriteExisting)
+      if (segment->GetRepresentation(targetRepresentationName) && !overwriteExisting)
         {
         continue;
         }
-      currentConversionRule->Convert(segment);
+
+      std::map<vtkDataObject*, size_t>::iterator groupIt = groupIndexForSource.find(sourceRepresentation);
+      if (groupIt == groupIndexForSource.end())
+        {
+        groupIt = groupIndexForSource.insert(std::make_pair(sourceRepresentation, segmentGroups.size())).first;
+        segmentGroups.push_back(std::vector<vtkSegment*>());
+        }
+      segmentGroups[groupIt->second].push_back(segment);
       }
-    currentConversionRule->PostConvert(this);
 
-  }
+    int numberOfGroups = static_cast<int>(segmentGroups.size());
+    int numberOfStepThreads = std::min(numberOfThreads, numberOfGroups);
+    if (numberOfStepThreads > 1 && currentConversionRule->IsParallelConversionSupported())
+      {
+      this->ConvertSegmentGroupsInParallel(currentConversionRule, segmentGroups, numberOfStepThreads, step, numberOfSteps);
+      }
+    else
+      {
+      for (int groupIndex = 0; groupIndex < numberOfGroups && !this->ConversionAborted; ++groupIndex)
+        {
+        for (vtkSegment* segment : segmentGroups[groupIndex])
+          {
+          currentConversionRule->Convert(segment);
+          }
+        double progress = (step + double(groupIndex + 1) / numberOfGroups) / numberOfSteps;
+        this->InvokeEvent(vtkCommand::ProgressEvent, &progress);
+        }
+      }
+
+    currentConversionRule->PostConvert(this);
+    if (this->ConversionAborted)
+      {
+      vtkWarningMacro("ConvertSegmentsUsingPath: Conversion to " << targetRepresentationName << " representation was aborted");
+      return false;
+      }
+    }
 
   return true;
 }
 
+//-----------------------------------------------------------------------------
+void vtkSegmentation::ConvertSegmentGroupsInParallel(vtkSegmentationConverterRule* rule,
+  const std::vector<std::vector<vtkSegment*> >& segmentGroups, int numberOfThreads, int step, int numberOfSteps)
+{
+  std::string sourceRepresentationName = rule->GetSourceRepresentationName();
+  std::string targetRepresentationName = rule->GetTargetRepresentationName();
+  int numberOfGroups = static_cast<int>(segmentGroups.size());
+
+  // Worker threads convert into temporary segments that only contain the source representation,
+  // so that the segments of the segmentation (and their observers) are only accessed from this thread.
+  std::vector<std::vector<vtkSmartPointer<vtkSegment> > > workSegmentGroups(numberOfGroups);
+  for (int groupIndex = 0; groupIndex < numberOfGroups; ++groupIndex)
+    {
+    for (vtkSegment* segment : segmentGroups[groupIndex])
+      {
+      vtkDataObject* sourceRepresentation = segment->GetRepresentation(sourceRepresentationName);
+      vtkOrientedImageData* sourceLabelmap = vtkOrientedImageData::SafeDownCast(sourceRepresentation);
+      if (sourceLabelmap)
+        {
+        // The scalar range is cached in the image when it is first computed, compute it
+        // here so that worker threads only read it.
+        sourceLabelmap->GetScalarRange();
+        }
+      vtkSmartPointer<vtkSegment> workSegment = vtkSmartPointer<vtkSegment>::New();
+      workSegment->SetLabelValue(segment->GetLabelValue());
+      workSegment->AddRepresentation(sourceRepresentationName, sourceRepresentation);
+      workSegmentGroups[groupIndex].push_back(workSegment);
+      }
+    }
+
+  // Each thread converts using its own copy of the rule, so that conversion parameters
+  // and the state kept by the rule during conversion are not shared between threads.
+  std::vector<vtkSmartPointer<vtkSegmentationConverterRule> > threadRules;
+  for (int threadIndex = 0; threadIndex < numberOfThreads; ++threadIndex)
+    {
+    vtkSmartPointer<vtkSegmentationConverterRule> threadRule = vtkSmartPointer<vtkSegmentationConverterRule>::Take(rule->Clone());
+    threadRule->PreConvert(this);
+    threadRules.push_back(threadRule);
+    }
+
+  std::mutex completedMutex;
+  std::condition_variable completedCondition;
+  std::vector<bool> groupCompleted(numberOfGroups, false);
+  std::atomic<int> nextGroupIndex(0);
+  std::atomic<int> numberOfFinishedThreads(0);
+
+  auto convertGroups = [&](vtkSegmentationConverterRule* threadRule)
+    {
+    int groupIndex = 0;
+    while (!this->ConversionAborted && (groupIndex = nextGroupIndex++) < numberOfGroups)
+      {
+      for (vtkSegment* workSegment : workSegmentGroups[groupIndex])
+        {
+        threadRule->Convert(workSegment);
+        }
+      std::lock_guard<std::mutex> lock(completedMutex);
+      groupCompleted[groupIndex] = true;
+      completedCondition.notify_one();
+      }
+    std::lock_guard<std::mutex> lock(completedMutex);
+    ++numberOfFinishedThreads;
+    completedCondition.notify_one();
+    };
+
+  std::vector<std::thread> threads;
+  for (int threadIndex = 0; threadIndex < numberOfThreads; ++threadIndex)
+    {
+    threads.push_back(std::thread(convertGroups, threadRules[threadIndex].GetPointer()));
+    }
+
+  // Store results in the original segments in the order of the segment groups, so that
+  // the resulting segmentation does not depend on the order in which the threads finish.
+  // Temporary segments of a group are released as soon as its results are stored.
+  int numberOfStoredGroups = 0;
+  while (numberOfStoredGroups < numberOfGroups)
+    {
+      {
+      std::unique_lock<std::mutex> lock(completedMutex);
+      completedCondition.wait(lock, [&]
+        {
+        return groupCompleted[numberOfStoredGroups] || numberOfFinishedThreads == numberOfThreads;
+        });
+      if (!groupCompleted[numberOfStoredGroups])
+        {
+        // Aborted
+        break;
+        }
+      }
+
+    for (size_t segmentIndex = 0; segmentIndex < segmentGroups[numberOfStoredGroups].size(); ++segmentIndex)
+      {
+      vtkSegment* segment = segmentGroups[numberOfStoredGroups][segmentIndex];
+      vtkDataObject* convertedRepresentation =
+        workSegmentGroups[numberOfStoredGroups][segmentIndex]->GetRepresentation(targetRepresentationName);
+      if (!convertedRepresentation)
+        {
+        continue;
+        }
+      vtkDataObject* targetRepresentation = segment->GetRepresentation(targetRepresentationName);
+      if (targetRepresentation && !rule->ReplaceTargetRepresentation)
+        {
+        targetRepresentation->ShallowCopy(convertedRepresentation);
+        }
+      else
+        {
+        segment->AddRepresentation(targetRepresentationName, convertedRepresentation);
+        }
+      }
+    workSegmentGroups[numberOfStoredGroups].clear();
+    ++numberOfStoredGroups;
+
+    double progress = (step + double(numberOfStoredGroups) / numberOfGroups) / numberOfSteps;
+    this->InvokeEvent(vtkCommand::ProgressEvent, &progress);
+    }
+
+  for (std::thread& thread : threads)
+    {
+    thread.join();
+    }
+  for (vtkSegmentationConverterRule* threadRule : threadRules)
+    {
+    threadRule->PostConvert(this);
+    }
+}
+
 //-----------------------------------------------------------------------------
 bool vtkSegmentation::ConvertSegmentUsingPath(vtkSegment* segment, vtkSegmentationConverter::ConversionPathType path, bool overwriteExisting/*=false*/)
 {
@@ -1174,12 +1359,15 @@ bool vtkSegmentation::CreateRepresentation(const std::string& targetRepresentati
 
   std::vector<std::string> segmentIDs;
   this->GetSegmentIDs(segmentIDs);
-  if (!this->ConvertSegmentsUsingPath(segmentIDs, cheapestPath, alwaysConvert))
+  bool success = this->ConvertSegmentsUsingPath(segmentIDs, cheapestPath, alwaysConvert);
+  if (!success && !this->ConversionAborted)
     {
     vtkErrorMacro("CreateRepresentation: Conversion failed");
+    this->SetSegmentModifiedEnabled(wasSegmentModifiedEnabled);
     return false;
     }
 
+  // Segments that were converted before an abort are reported as modified
   for (SegmentMap::iterator segmentIt = this->Segments.begin(); segmentIt != this->Segments.end(); ++segmentIt)
     {
     vtkDataObject* representationBefore = representationsBefore[segmentIt->first];
@@ -1208,7 +1396,7 @@ bool vtkSegmentation::CreateRepresentation(const std::string& targetRepresentati
     }
 
   this->InvokeEvent(vtkSegmentation::ContainedRepresentationNamesModified);
-  return true;
+  return success;
 }
 
 //---------------------------------------------------------------------------
@@ -26,6 +26,7 @@
 #include <vtkSmartPointer.h>
 
 // STD includes
+#include <atomic>
 #include <map>
 #include <deque>
 #include <vector>
@@ -108,6 +109,9 @@ public:
     ContainedRepresentationNamesModified,
     /// Invoked if segment IDs order is changed. Not called when a segment is added or removed.
     SegmentsOrderModified,
+    /// Invoked when a representation of a segment is requested while its representations are pending
+    /// (see vtkSegment::SetRepresentationsPending). Segment ID is passed as call data.
+    SegmentRepresentationsPending,
     };
 
   enum
@@ -409,6 +413,20 @@ public:
   bool CreateRepresentation(vtkSegmentationConverter::ConversionPathType path,
                             vtkSegmentationConverterRule::ConversionParameterListType parameters);
 
+  /// Number of threads used for converting segments when the conversion rule supports it.
+  /// Segments that share their source representation (e.g., segments in the same
+  /// labelmap layer) are always converted by the same thread.
+  /// Each thread converts with its own copy of the conversion rule and parameters.
+  /// 1 (default) disables parallel conversion, 0 means the number of processor cores.
+  vtkSetMacro(NumberOfConversionThreads, int);
+  vtkGetMacro(NumberOfConversionThreads, int);
+
+  /// Stop the conversion that is currently in progress. Segments that were already converted
+  /// keep their new representation, other segments are left unchanged and CreateRepresentation returns false.
+  /// Can be called from an observer of vtkCommand::ProgressEvent, which is invoked during conversion
+  /// with the completed fraction (double*) as call data.
+  void AbortConversion() { this->ConversionAborted = true; };
+
   /// Removes a representation from all segments if present
   void RemoveRepresentation(const std::string& representationName);
 
@@ -469,6 +487,12 @@ public:
 protected:
   bool ConvertSegmentsUsingPath(std::vector<std::string> segmentIDs, vtkSegmentationConverter::ConversionPathType path, bool overwriteExisting = false);
 
+  /// Convert groups of segments using multiple threads. Segments in the same group are converted
+  /// by the same thread. Results are stored in the segments on the calling thread, in group order.
+  /// Used by \sa ConvertSegmentsUsingPath if the conversion rule supports parallel conversion.
+  void ConvertSegmentGroupsInParallel(vtkSegmentationConverterRule* rule,
+    const std::vector<std::vector<vtkSegment*> >& segmentGroups, int numberOfThreads, int step, int numberOfSteps);
+
   /// Convert given segment along a specified path
   /// \param segment Segment to convert
   /// \param path Path to do the conversion along
@@ -549,6 +573,12 @@ protected:
 
   std::set<vtkSmartPointer<vtkDataObject> > MasterRepresentationCache;
 
+  /// Number of threads used for converting segments in parallel
+  int NumberOfConversionThreads;
+
+  /// Set by AbortConversion, reset when a conversion step starts
+  std::atomic<bool> ConversionAborted;
+
   friend class vtkMRMLSegmentationNode;
   friend class vtkSlicerSegmentationsModuleLogic;
   friend class vtkSegmentationModifier;
@@ -59,10 +59,12 @@ public:
   static const char* GetSegmentationFractionalLabelmapRepresentationName() { return "Fractional labelmap"; };
   static const char* GetSegmentationPlanarContourRepresentationName()      { return "Planar contour"; };
   static const char* GetSegmentationClosedSurfaceRepresentationName()      { return "Closed surface"; };
+  static const char* GetSegmentationSparseBinaryLabelmapRepresentationName() { return "Sparse binary labelmap"; };
   static const char* GetBinaryLabelmapRepresentationName()     { return GetSegmentationBinaryLabelmapRepresentationName(); };
   static const char* GetFractionalLabelmapRepresentationName() { return GetSegmentationFractionalLabelmapRepresentationName(); };
   static const char* GetPlanarContourRepresentationName()      { return GetSegmentationPlanarContourRepresentationName(); };
   static const char* GetClosedSurfaceRepresentationName()      { return GetSegmentationClosedSurfaceRepresentationName(); };
+  static const char* GetSparseBinaryLabelmapRepresentationName() { return GetSegmentationSparseBinaryLabelmapRepresentationName(); };
 
   // Common conversion parameters
   // ----------------------------
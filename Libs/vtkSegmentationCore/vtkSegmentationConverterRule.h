@@ -92,6 +92,11 @@ public:
   /// \sa ConvertInternal
   virtual bool Convert(vtkSegment* segment) = 0;
 
+  /// Returns true if Convert can be called concurrently from multiple threads for segments
+  /// that do not share their source representation object. In that case Convert is called
+  /// with temporary segments that only contain the source representation. Off by default.
+  virtual bool IsParallelConversionSupported() { return false; };
+
   /// Perform post-conversion steps across the specified segments in the segmentation
   /// This step should be unneccessary if only converting a single segment
   virtual bool PostConvert(vtkSegmentation* vtkNotUsed(segmentation)) { return true; };
@@ -155,6 +160,7 @@ protected:
   bool ReplaceTargetRepresentation{false};
 
   friend class vtkSegmentationConverter;
+  friend class vtkSegmentation;
 };
 
 #endif // __vtkSegmentationConverterRule_h
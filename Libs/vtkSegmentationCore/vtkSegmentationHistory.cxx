@@ -22,14 +22,77 @@
 #include "vtkSegmentationHistory.h"
 #include "vtkSegmentationConverterFactory.h"
 #include "vtkSegmentation.h"
+#include "vtkOrientedImageData.h"
+#include "vtkOrientedImageDataResample.h"
 
 // VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkDataArray.h>
+#include <vtkFieldData.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
-#include <vtkCallbackCommand.h>
+#include <vtkPointData.h>
 
 // std includes
 #include <algorithm>
+#include <cstring>
+#include <set>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Get the smallest extent that contains all voxels that are different in the two images.
+// Images must have the same extent, scalar type, and number of components.
+// Returns false if the images have the same content.
+bool GetModifiedExtent(vtkImageData* image1, vtkImageData* image2, int modifiedExtent[6])
+{
+  int* extent = image1->GetExtent();
+  vtkIdType voxelSize = image1->GetScalarSize() * image1->GetNumberOfScalarComponents();
+  vtkIdType rowSize = static_cast<vtkIdType>(extent[1] - extent[0] + 1) * voxelSize;
+  const unsigned char* row1 = static_cast<const unsigned char*>(image1->GetScalarPointer());
+  const unsigned char* row2 = static_cast<const unsigned char*>(image2->GetScalarPointer());
+  bool modified = false;
+  for (int z = extent[4]; z <= extent[5]; ++z)
+    {
+    for (int y = extent[2]; y <= extent[3]; ++y, row1 += rowSize, row2 += rowSize)
+      {
+      if (memcmp(row1, row2, rowSize) == 0)
+        {
+        continue;
+        }
+      vtkIdType firstByte = 0;
+      while (row1[firstByte] == row2[firstByte])
+        {
+        ++firstByte;
+        }
+      vtkIdType lastByte = rowSize - 1;
+      while (row1[lastByte] == row2[lastByte])
+        {
+        --lastByte;
+        }
+      int firstX = extent[0] + static_cast<int>(firstByte / voxelSize);
+      int lastX = extent[0] + static_cast<int>(lastByte / voxelSize);
+      if (!modified)
+        {
+        int rowExtent[6] = { firstX, lastX, y, y, z, z };
+        std::copy(rowExtent, rowExtent + 6, modifiedExtent);
+        modified = true;
+        }
+      else
+        {
+        modifiedExtent[0] = std::min(modifiedExtent[0], firstX);
+        modifiedExtent[1] = std::max(modifiedExtent[1], lastX);
+        modifiedExtent[2] = std::min(modifiedExtent[2], y);
+        modifiedExtent[3] = std::max(modifiedExtent[3], y);
+        modifiedExtent[5] = z;
+        }
+      }
+    }
+  return modified;
+}
+
+} // end of anonymous namespace
 
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkSegmentationHistory);
@@ -43,6 +106,7 @@ vtkSegmentationHistory::vtkSegmentationHistory()
 
   this->LastRestoredState = 0;
   this->RestoreStateInProgress = false;
+  this->StoreLabelmapDifferences = true;
 
   this->SegmentationModifiedCallbackCommand = vtkCallbackCommand::New();
   this->SegmentationModifiedCallbackCommand->SetClientData( reinterpret_cast<void *>(this) );
@@ -98,6 +162,9 @@ void vtkSegmentationHistory::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Modified Time: " << this->GetMTime() << "\n";
 
   os << indent << "Number of saved states:  " << this->SegmentationStates.size() << "\n";
+  os << indent << "StoreLabelmapDifferences:  " << (this->StoreLabelmapDifferences ? "true" : "false") << "\n";
+  os << indent << "Number of stored labelmap differences:  " << this->LabelmapDifferences.size() << "\n";
+  os << indent << "Memory size (KiB):  " << this->GetActualMemorySize() << "\n";
 }
 
 //---------------------------------------------------------------------------
@@ -123,6 +190,11 @@ bool vtkSegmentationHistory::SaveState()
   this->Segmentation->GetSegmentIDs(segmentIDs);
   newSegmentationState.SegmentIds = segmentIDs;
   std::map<vtkDataObject*, vtkDataObject*> savedObjects;
+  if (this->StoreLabelmapDifferences)
+    {
+    // Labelmaps saved this way are not copied again in CopySegment
+    this->SaveModifiedLabelmapRegions(savedObjects);
+    }
   for (std::vector<std::string>::iterator segmentIDIt = segmentIDs.begin(); segmentIDIt != segmentIDs.end(); ++segmentIDIt)
     {
     vtkSegment* segment = this->Segmentation->GetSegment(*segmentIDIt);
@@ -148,6 +220,10 @@ bool vtkSegmentationHistory::SaveState()
     newSegmentationState.Segments[*segmentIDIt] = segmentClone;
     }
   this->SegmentationStates.push_back(newSegmentationState);
+  if (this->StoreLabelmapDifferences)
+    {
+    this->StoreLabelmapDifferencesOfPreviousState();
+    }
 
   // Set the current state as last restored state
   this->LastRestoredState = (unsigned int)this->SegmentationStates.size();
@@ -213,6 +289,28 @@ bool vtkSegmentationHistory::RestoreState(unsigned int stateIndex)
 
   std::set<std::string> segmentIDsToKeep;
   std::map<vtkDataObject*, vtkDataObject*> restoredRepresentations;
+
+  // Labelmaps that only store differences are reconstructed and used in the segmentation directly
+  std::vector<vtkSmartPointer<vtkOrientedImageData> > reconstructedLabelmaps;
+  for (SegmentsMap::iterator restoredSegmentsIt = restoredState.Segments.begin();
+    restoredSegmentsIt != restoredState.Segments.end(); ++restoredSegmentsIt)
+    {
+    std::vector<std::string> representationNames;
+    restoredSegmentsIt->second->GetContainedRepresentationNames(representationNames);
+    for (const std::string& representationName : representationNames)
+      {
+      vtkOrientedImageData* labelmap = vtkOrientedImageData::SafeDownCast(
+        restoredSegmentsIt->second->GetRepresentation(representationName));
+      if (!labelmap || this->LabelmapDifferences.find(labelmap) == this->LabelmapDifferences.end()
+        || restoredRepresentations.find(labelmap) != restoredRepresentations.end())
+        {
+        continue;
+        }
+      vtkSmartPointer<vtkOrientedImageData> reconstructedLabelmap = this->GetLabelmapCopy(labelmap);
+      reconstructedLabelmaps.push_back(reconstructedLabelmap);
+      restoredRepresentations[labelmap] = reconstructedLabelmap;
+      }
+    }
   for (SegmentsMap::iterator restoredSegmentsIt = restoredState.Segments.begin();
     restoredSegmentsIt != restoredState.Segments.end(); ++restoredSegmentsIt)
     {
@@ -293,6 +391,7 @@ void vtkSegmentationHistory::RemoveAllNextStates()
     }
   if (modified)
     {
+    this->RemoveUnusedLabelmapDifferences();
     this->Modified();
     }
 }
@@ -309,6 +408,7 @@ void vtkSegmentationHistory::RemoveAllObsoleteStates()
    }
   if (modified)
     {
+    this->RemoveUnusedLabelmapDifferences();
     this->Modified();
     }
 }
@@ -354,6 +454,7 @@ void vtkSegmentationHistory::OnSegmentationModified(vtkObject* vtkNotUsed(caller
 void vtkSegmentationHistory::RemoveAllStates()
 {
   this->SegmentationStates.clear();
+  this->LabelmapDifferences.clear();
   this->LastRestoredState = 0;
   this->Modified();
 }
@@ -363,3 +464,287 @@ int vtkSegmentationHistory::GetNumberOfStates()
 {
   return this->SegmentationStates.size();
 }
+
+//---------------------------------------------------------------------------
+void vtkSegmentationHistory::SaveModifiedLabelmapRegions(std::map<vtkDataObject*, vtkDataObject*>& savedObjects)
+{
+  if (this->SegmentationStates.empty())
+    {
+    return;
+    }
+  SegmentationState& lastState = this->SegmentationStates.back();
+
+  // Find the current labelmap of each labelmap of the last state. If a labelmap of the last state
+  // is now stored in different labelmaps (e.g., a shared labelmap was split) then it is skipped here.
+  std::map<vtkOrientedImageData*, vtkOrientedImageData*> currentLabelmaps;
+  std::set<vtkOrientedImageData*> skippedLabelmaps;
+  for (SegmentsMap::iterator lastSegmentIt = lastState.Segments.begin();
+    lastSegmentIt != lastState.Segments.end(); ++lastSegmentIt)
+    {
+    vtkSegment* segment = this->Segmentation->GetSegment(lastSegmentIt->first);
+    std::vector<std::string> representationNames;
+    lastSegmentIt->second->GetContainedRepresentationNames(representationNames);
+    for (const std::string& representationName : representationNames)
+      {
+      vtkOrientedImageData* lastLabelmap = vtkOrientedImageData::SafeDownCast(
+        lastSegmentIt->second->GetRepresentation(representationName));
+      if (!lastLabelmap)
+        {
+        continue;
+        }
+      vtkOrientedImageData* labelmap = nullptr;
+      if (segment)
+        {
+        labelmap = vtkOrientedImageData::SafeDownCast(segment->GetRepresentation(representationName));
+        }
+      std::pair<std::map<vtkOrientedImageData*, vtkOrientedImageData*>::iterator, bool> inserted =
+        currentLabelmaps.insert(std::make_pair(lastLabelmap, labelmap));
+      if (!inserted.second && inserted.first->second != labelmap)
+        {
+        skippedLabelmaps.insert(lastLabelmap);
+        }
+      }
+    }
+
+  for (std::map<vtkOrientedImageData*, vtkOrientedImageData*>::iterator labelmapIt = currentLabelmaps.begin();
+    labelmapIt != currentLabelmaps.end(); ++labelmapIt)
+    {
+    vtkOrientedImageData* lastLabelmap = labelmapIt->first;
+    vtkOrientedImageData* labelmap = labelmapIt->second;
+    if (!labelmap || skippedLabelmaps.find(lastLabelmap) != skippedLabelmaps.end()
+      || savedObjects.find(labelmap) != savedObjects.end()
+      || this->LabelmapDifferences.find(lastLabelmap) != this->LabelmapDifferences.end())
+      {
+      // removed, split, merged into an already saved labelmap, or the last state does not have all voxels
+      continue;
+      }
+    if (lastLabelmap->GetMTime() > labelmap->GetMTime())
+      {
+      // not modified, CopySegment reuses the labelmap of the last state
+      continue;
+      }
+    // Voxel array of the last state can only be reused if the labelmap has the same extent and voxel size
+    int* lastExtent = lastLabelmap->GetExtent();
+    int* extent = labelmap->GetExtent();
+    if (strcmp(lastLabelmap->GetClassName(), labelmap->GetClassName()) != 0
+      || !lastLabelmap->GetPointData()->GetScalars() || !labelmap->GetPointData()->GetScalars()
+      || labelmap->GetPointData()->GetNumberOfArrays() != 1
+      || lastLabelmap->GetScalarType() != labelmap->GetScalarType()
+      || lastLabelmap->GetNumberOfScalarComponents() != labelmap->GetNumberOfScalarComponents()
+      || !std::equal(lastExtent, lastExtent + 6, extent)
+      || !vtkOrientedImageDataResample::DoGeometriesMatch(lastLabelmap, labelmap))
+      {
+      continue;
+      }
+
+    // Move voxels of the last state into the saved labelmap
+    vtkSmartPointer<vtkOrientedImageData> savedLabelmap = vtkSmartPointer<vtkOrientedImageData>::Take(
+      lastLabelmap->NewInstance());
+    savedLabelmap->CopyStructure(labelmap);
+    savedLabelmap->CopyDirections(labelmap);
+    savedLabelmap->GetFieldData()->DeepCopy(labelmap->GetFieldData());
+    savedLabelmap->GetPointData()->SetScalars(lastLabelmap->GetPointData()->GetScalars());
+
+    LabelmapDifference difference;
+    difference.Labelmap = lastLabelmap;
+    difference.ReferenceLabelmap = savedLabelmap;
+    int modifiedExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    if (GetModifiedExtent(lastLabelmap, labelmap, modifiedExtent))
+      {
+      difference.ModifiedVoxels = vtkSmartPointer<vtkImageData>::New();
+      difference.ModifiedVoxels->SetExtent(modifiedExtent);
+      difference.ModifiedVoxels->AllocateScalars(lastLabelmap->GetScalarType(), lastLabelmap->GetNumberOfScalarComponents());
+      difference.ModifiedVoxels->CopyAndCastFrom(lastLabelmap, modifiedExtent);
+      savedLabelmap->CopyAndCastFrom(labelmap, modifiedExtent);
+      }
+    // Only geometry and field data of the labelmap of the last state is kept
+    lastLabelmap->GetPointData()->SetScalars(nullptr);
+    this->LabelmapDifferences[lastLabelmap] = difference;
+    savedObjects[labelmap] = savedLabelmap;
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkSegmentationHistory::StoreLabelmapDifferencesOfPreviousState()
+{
+  if (this->SegmentationStates.size() < 2)
+    {
+    return;
+    }
+  SegmentationState& previousState = this->SegmentationStates[this->SegmentationStates.size() - 2];
+  SegmentationState& lastState = this->SegmentationStates.back();
+
+  std::set<vtkOrientedImageData*> processedLabelmaps;
+  for (SegmentsMap::iterator previousSegmentIt = previousState.Segments.begin();
+    previousSegmentIt != previousState.Segments.end(); ++previousSegmentIt)
+    {
+    SegmentsMap::iterator lastSegmentIt = lastState.Segments.find(previousSegmentIt->first);
+    if (lastSegmentIt == lastState.Segments.end())
+      {
+      continue;
+      }
+    std::vector<std::string> representationNames;
+    previousSegmentIt->second->GetContainedRepresentationNames(representationNames);
+    for (const std::string& representationName : representationNames)
+      {
+      vtkOrientedImageData* previousLabelmap = vtkOrientedImageData::SafeDownCast(
+        previousSegmentIt->second->GetRepresentation(representationName));
+      vtkOrientedImageData* lastLabelmap = vtkOrientedImageData::SafeDownCast(
+        lastSegmentIt->second->GetRepresentation(representationName));
+      if (!previousLabelmap || !lastLabelmap || previousLabelmap == lastLabelmap
+        || processedLabelmaps.find(previousLabelmap) != processedLabelmaps.end())
+        {
+        // not a labelmap, not modified, or shared labelmap that is already processed
+        continue;
+        }
+      processedLabelmaps.insert(previousLabelmap);
+
+      // Differences are only computed from complete labelmaps
+      if (this->LabelmapDifferences.find(previousLabelmap) != this->LabelmapDifferences.end()
+        || this->LabelmapDifferences.find(lastLabelmap) != this->LabelmapDifferences.end())
+        {
+        continue;
+        }
+      // Voxels are compared row by row, therefore the labelmaps must have the same extent and voxel size.
+      // Otherwise the complete labelmap is kept (e.g., if an edit grew or cropped the labelmap).
+      int* previousExtent = previousLabelmap->GetExtent();
+      int* lastExtent = lastLabelmap->GetExtent();
+      if (!previousLabelmap->GetPointData()->GetScalars() || !lastLabelmap->GetPointData()->GetScalars()
+        || previousLabelmap->GetScalarType() != lastLabelmap->GetScalarType()
+        || previousLabelmap->GetNumberOfScalarComponents() != lastLabelmap->GetNumberOfScalarComponents()
+        || !std::equal(previousExtent, previousExtent + 6, lastExtent)
+        || !vtkOrientedImageDataResample::DoGeometriesMatch(previousLabelmap, lastLabelmap))
+        {
+        continue;
+        }
+
+      LabelmapDifference difference;
+      difference.Labelmap = previousLabelmap;
+      difference.ReferenceLabelmap = lastLabelmap;
+      int modifiedExtent[6] = { 0, -1, 0, -1, 0, -1 };
+      if (GetModifiedExtent(previousLabelmap, lastLabelmap, modifiedExtent))
+        {
+        difference.ModifiedVoxels = vtkSmartPointer<vtkImageData>::New();
+        difference.ModifiedVoxels->SetExtent(modifiedExtent);
+        difference.ModifiedVoxels->AllocateScalars(previousLabelmap->GetScalarType(), previousLabelmap->GetNumberOfScalarComponents());
+        difference.ModifiedVoxels->CopyAndCastFrom(previousLabelmap, modifiedExtent);
+        }
+      // Release voxels, only geometry and field data of the labelmap is kept
+      previousLabelmap->GetPointData()->SetScalars(nullptr);
+      this->LabelmapDifferences[previousLabelmap] = difference;
+      }
+    }
+}
+
+//---------------------------------------------------------------------------
+vtkSmartPointer<vtkOrientedImageData> vtkSegmentationHistory::GetLabelmapCopy(vtkOrientedImageData* labelmap)
+{
+  std::map<vtkOrientedImageData*, LabelmapDifference>::iterator differenceIt = this->LabelmapDifferences.find(labelmap);
+  if (differenceIt == this->LabelmapDifferences.end())
+    {
+    // complete labelmap
+    vtkSmartPointer<vtkOrientedImageData> labelmapCopy = vtkSmartPointer<vtkOrientedImageData>::New();
+    labelmapCopy->DeepCopy(labelmap);
+    return labelmapCopy;
+    }
+
+  // Reconstruct from the next state
+  vtkSmartPointer<vtkOrientedImageData> labelmapCopy = this->GetLabelmapCopy(differenceIt->second.ReferenceLabelmap);
+  vtkImageData* modifiedVoxels = differenceIt->second.ModifiedVoxels;
+  if (modifiedVoxels)
+    {
+    labelmapCopy->CopyAndCastFrom(modifiedVoxels, modifiedVoxels->GetExtent());
+    }
+  labelmapCopy->GetFieldData()->DeepCopy(labelmap->GetFieldData());
+  return labelmapCopy;
+}
+
+//---------------------------------------------------------------------------
+void vtkSegmentationHistory::RemoveUnusedLabelmapDifferences()
+{
+  if (this->LabelmapDifferences.empty())
+    {
+    return;
+    }
+
+  // Labelmaps that are stored in states
+  std::set<vtkDataObject*> usedObjects;
+  for (SegmentationState& state : this->SegmentationStates)
+    {
+    for (SegmentsMap::iterator segmentIt = state.Segments.begin(); segmentIt != state.Segments.end(); ++segmentIt)
+      {
+      std::vector<std::string> representationNames;
+      segmentIt->second->GetContainedRepresentationNames(representationNames);
+      for (const std::string& representationName : representationNames)
+        {
+        usedObjects.insert(segmentIt->second->GetRepresentation(representationName));
+        }
+      }
+    }
+
+  // Labelmaps that are needed for reconstructing labelmaps stored in states
+  bool usedObjectsAdded = true;
+  while (usedObjectsAdded)
+    {
+    usedObjectsAdded = false;
+    for (std::map<vtkOrientedImageData*, LabelmapDifference>::iterator differenceIt = this->LabelmapDifferences.begin();
+      differenceIt != this->LabelmapDifferences.end(); ++differenceIt)
+      {
+      if (usedObjects.find(differenceIt->first) != usedObjects.end()
+        && usedObjects.insert(differenceIt->second.ReferenceLabelmap.GetPointer()).second)
+        {
+        usedObjectsAdded = true;
+        }
+      }
+    }
+
+  for (std::map<vtkOrientedImageData*, LabelmapDifference>::iterator differenceIt = this->LabelmapDifferences.begin();
+    differenceIt != this->LabelmapDifferences.end(); )
+    {
+    if (usedObjects.find(differenceIt->first) == usedObjects.end())
+      {
+      differenceIt = this->LabelmapDifferences.erase(differenceIt);
+      }
+    else
+      {
+      ++differenceIt;
+      }
+    }
+}
+
+//---------------------------------------------------------------------------
+unsigned long vtkSegmentationHistory::GetActualMemorySize()
+{
+  std::set<vtkDataObject*> objects;
+  for (SegmentationState& state : this->SegmentationStates)
+    {
+    for (SegmentsMap::iterator segmentIt = state.Segments.begin(); segmentIt != state.Segments.end(); ++segmentIt)
+      {
+      std::vector<std::string> representationNames;
+      segmentIt->second->GetContainedRepresentationNames(representationNames);
+      for (const std::string& representationName : representationNames)
+        {
+        objects.insert(segmentIt->second->GetRepresentation(representationName));
+        }
+      }
+    }
+  for (std::map<vtkOrientedImageData*, LabelmapDifference>::iterator differenceIt = this->LabelmapDifferences.begin();
+    differenceIt != this->LabelmapDifferences.end(); ++differenceIt)
+    {
+    objects.insert(differenceIt->second.ReferenceLabelmap.GetPointer());
+    if (differenceIt->second.ModifiedVoxels)
+      {
+      objects.insert(differenceIt->second.ModifiedVoxels.GetPointer());
+      }
+    }
+
+  unsigned long memorySize = 0;
+  for (vtkDataObject* object : objects)
+    {
+    if (object)
+      {
+      memorySize += object->GetActualMemorySize();
+      }
+    }
+  return memorySize;
+}
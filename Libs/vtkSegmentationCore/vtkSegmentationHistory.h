@@ -34,6 +34,8 @@
 
 class vtkCallbackCommand;
 class vtkDataObject;
+class vtkImageData;
+class vtkOrientedImageData;
 class vtkSegment;
 class vtkSegmentation;
 
@@ -86,6 +88,20 @@ public:
   /// Get the current number of states.
   int GetNumberOfStates();
 
+  /// If enabled then labelmaps of previous states only keep the region that is different
+  /// from the labelmap in the next state. Full copy of modified labelmaps is only kept in the
+  /// most recent state and previous states are reconstructed from it when they are restored.
+  /// This allows keeping many states of large segmentations in memory.
+  /// If a modified labelmap has the same extent and geometry as in the most recent state then it is
+  /// saved without copying all its voxels: the voxel array of the most recent state is moved into
+  /// the new state and only the modified region is updated. Enabled by default.
+  vtkGetMacro(StoreLabelmapDifferences, bool);
+  vtkSetMacro(StoreLabelmapDifferences, bool);
+  vtkBooleanMacro(StoreLabelmapDifferences, bool);
+
+  /// Return the memory used by all stored states in kibibytes (1024 bytes).
+  unsigned long GetActualMemorySize();
+
 protected:
   /// Callback function called when the segmentation has been modified.
   /// It clears all states that are more recent than the last restored state.
@@ -100,6 +116,21 @@ protected:
   /// Restores a state defined by stateIndex.
   bool RestoreState(unsigned int stateIndex);
 
+  /// Save labelmaps of the segmentation that are modified since the last state
+  /// by updating the modified region of the labelmaps of the last state.
+  /// Labelmaps of the last state only keep the difference, saved labelmaps are added to savedObjects.
+  void SaveModifiedLabelmapRegions(std::map<vtkDataObject*, vtkDataObject*>& savedObjects);
+
+  /// Replace labelmaps of the previous state that are modified in the last state
+  /// by the difference between the two labelmaps.
+  void StoreLabelmapDifferencesOfPreviousState();
+
+  /// Get a full copy of a labelmap stored in a state (reconstructed from differences if needed).
+  vtkSmartPointer<vtkOrientedImageData> GetLabelmapCopy(vtkOrientedImageData* labelmap);
+
+  /// Delete stored labelmap differences that are not needed for restoring any of the states.
+  void RemoveUnusedLabelmapDifferences();
+
 protected:
   vtkSegmentationHistory();
   ~vtkSegmentationHistory() override;
@@ -112,6 +143,17 @@ protected:
     std::vector<std::string> SegmentIds; // order of segments
     };
 
+  struct LabelmapDifference
+    {
+    /// Labelmap stored in a state. Its voxels are not kept, only its geometry.
+    vtkSmartPointer<vtkOrientedImageData> Labelmap;
+    /// Labelmap in the next state that differences are computed from.
+    vtkSmartPointer<vtkOrientedImageData> ReferenceLabelmap;
+    /// Voxels of Labelmap in the region where it differs from ReferenceLabelmap.
+    /// nullptr if the two labelmaps have the same content.
+    vtkSmartPointer<vtkImageData> ModifiedVoxels;
+    };
+
   vtkSegmentation* Segmentation;
   vtkCallbackCommand* SegmentationModifiedCallbackCommand;
   std::deque<SegmentationState> SegmentationStates;
@@ -124,6 +166,9 @@ protected:
 
   bool RestoreStateInProgress;
 
+  bool StoreLabelmapDifferences;
+  std::map<vtkOrientedImageData*, LabelmapDifference> LabelmapDifferences;
+
 private:
   vtkSegmentationHistory(const vtkSegmentationHistory&) = delete;
   void operator=(const vtkSegmentationHistory&) = delete;
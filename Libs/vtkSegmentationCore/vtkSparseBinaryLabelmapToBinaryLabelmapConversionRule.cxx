@@ -0,0 +1,116 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// SegmentationCore includes
+#include "vtkSparseBinaryLabelmapToBinaryLabelmapConversionRule.h"
+#include "vtkOrientedImageData.h"
+#include "vtkSegment.h"
+#include "vtkSparseOrientedImageData.h"
+
+// VTK includes
+#include <vtkObjectFactory.h>
+
+//----------------------------------------------------------------------------
+vtkSegmentationConverterRuleNewMacro(vtkSparseBinaryLabelmapToBinaryLabelmapConversionRule);
+
+//----------------------------------------------------------------------------
+vtkSparseBinaryLabelmapToBinaryLabelmapConversionRule::vtkSparseBinaryLabelmapToBinaryLabelmapConversionRule()
+{
+  // Segments that shared a labelmap must not overwrite each other's voxels
+  this->ReplaceTargetRepresentation = true;
+}
+
+//----------------------------------------------------------------------------
+vtkSparseBinaryLabelmapToBinaryLabelmapConversionRule::~vtkSparseBinaryLabelmapToBinaryLabelmapConversionRule()
+= default;
+
+//----------------------------------------------------------------------------
+unsigned int vtkSparseBinaryLabelmapToBinaryLabelmapConversionRule::GetConversionCost(
+  vtkDataObject* vtkNotUsed(sourceRepresentation)/*=nullptr*/,
+  vtkDataObject* vtkNotUsed(targetRepresentation)/*=nullptr*/)
+{
+  // Rough input-independent guess (ms)
+  return 50;
+}
+
+//----------------------------------------------------------------------------
+vtkDataObject* vtkSparseBinaryLabelmapToBinaryLabelmapConversionRule::ConstructRepresentationObjectByRepresentation(std::string representationName)
+{
+  if ( !representationName.compare(this->GetSourceRepresentationName()) )
+    {
+    return (vtkDataObject*)vtkSparseOrientedImageData::New();
+    }
+  else if ( !representationName.compare(this->GetTargetRepresentationName()) )
+    {
+    return (vtkDataObject*)vtkOrientedImageData::New();
+    }
+  else
+    {
+    return nullptr;
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkDataObject* vtkSparseBinaryLabelmapToBinaryLabelmapConversionRule::ConstructRepresentationObjectByClass(std::string className)
+{
+  if (!className.compare("vtkSparseOrientedImageData"))
+    {
+    return (vtkDataObject*)vtkSparseOrientedImageData::New();
+    }
+  else if (!className.compare("vtkOrientedImageData"))
+    {
+    return (vtkDataObject*)vtkOrientedImageData::New();
+    }
+  else
+    {
+    return nullptr;
+    }
+}
+
+//----------------------------------------------------------------------------
+bool vtkSparseBinaryLabelmapToBinaryLabelmapConversionRule::Convert(vtkSegment* segment)
+{
+  this->CreateTargetRepresentation(segment);
+
+  vtkSparseOrientedImageData* sparseLabelmap = vtkSparseOrientedImageData::SafeDownCast(
+    segment->GetRepresentation(this->GetSourceRepresentationName()));
+  if (!sparseLabelmap)
+    {
+    vtkErrorMacro("Convert: Source representation is not a sparse oriented image data!");
+    return false;
+    }
+  vtkOrientedImageData* binaryLabelmap = vtkOrientedImageData::SafeDownCast(
+    segment->GetRepresentation(this->GetTargetRepresentationName()));
+  if (!binaryLabelmap)
+    {
+    vtkErrorMacro("Convert: Target representation is not an oriented image data!");
+    return false;
+    }
+
+  // Only allocate the region of the tiles that contain foreground
+  int occupiedExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  sparseLabelmap->GetOccupiedExtent(occupiedExtent);
+  if (!sparseLabelmap->GetImage(binaryLabelmap, occupiedExtent))
+    {
+    vtkErrorMacro("Convert: Failed to get voxels of the sparse labelmap!");
+    return false;
+    }
+
+  // Foreground voxels of sparse binary labelmaps are 1
+  segment->SetLabelValue(1);
+
+  return true;
+}
@@ -0,0 +1,646 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#include "vtkSparseOrientedImageData.h"
+
+// SegmentationCore includes
+#include "vtkOrientedImageData.h"
+#include "vtkOrientedImageDataResample.h"
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+
+// STD includes
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+vtkStandardNewMacro(vtkSparseOrientedImageData);
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+int FloorDivide(int value, int divisor)
+{
+  return (value >= 0) ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+//----------------------------------------------------------------------------
+bool IntersectExtents(const int extent1[6], const int extent2[6], int intersection[6])
+{
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    intersection[axis * 2] = std::max(extent1[axis * 2], extent2[axis * 2]);
+    intersection[axis * 2 + 1] = std::min(extent1[axis * 2 + 1], extent2[axis * 2 + 1]);
+    if (intersection[axis * 2] > intersection[axis * 2 + 1])
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool IsExtentEmpty(const int extent[6])
+{
+  return extent[0] > extent[1] || extent[2] > extent[3] || extent[4] > extent[5];
+}
+
+//----------------------------------------------------------------------------
+template <class T> bool IsRegionUniformGeneric(vtkImageData* image, const int extent[6], double& value)
+{
+  T firstValue = *static_cast<T*>(image->GetScalarPointer(extent[0], extent[2], extent[4]));
+  int rowLength = extent[1] - extent[0] + 1;
+  for (int k = extent[4]; k <= extent[5]; k++)
+    {
+    for (int j = extent[2]; j <= extent[3]; j++)
+      {
+      T* imagePtr = static_cast<T*>(image->GetScalarPointer(extent[0], j, k));
+      for (int i = 0; i < rowLength; i++)
+        {
+        if (imagePtr[i] != firstValue)
+          {
+          return false;
+          }
+        }
+      }
+    }
+  value = static_cast<double>(firstValue);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool IsRegionUniform(vtkImageData* image, const int extent[6], double& value)
+{
+  switch (image->GetScalarType())
+    {
+    vtkTemplateMacro(return IsRegionUniformGeneric<VTK_TT>(image, extent, value));
+    default:
+      return false;
+    }
+  return false;
+}
+
+//----------------------------------------------------------------------------
+/// Copy voxels in extent between images of the same scalar type
+void CopyRegion(vtkImageData* sourceImage, vtkImageData* destinationImage, const int extent[6])
+{
+  size_t rowSizeInBytes = static_cast<size_t>(extent[1] - extent[0] + 1) * sourceImage->GetScalarSize();
+  for (int k = extent[4]; k <= extent[5]; k++)
+    {
+    for (int j = extent[2]; j <= extent[3]; j++)
+      {
+      memcpy(destinationImage->GetScalarPointer(extent[0], j, k),
+        sourceImage->GetScalarPointer(extent[0], j, k), rowSizeInBytes);
+      }
+    }
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+vtkSparseOrientedImageData::vtkSparseOrientedImageData()
+{
+  this->TileSize = 32;
+  this->ScalarType = VTK_UNSIGNED_CHAR;
+  this->Geometry = vtkSmartPointer<vtkOrientedImageData>::New();
+  int emptyExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  this->Geometry->SetExtent(emptyExtent);
+}
+
+//----------------------------------------------------------------------------
+vtkSparseOrientedImageData::~vtkSparseOrientedImageData() = default;
+
+//----------------------------------------------------------------------------
+void vtkSparseOrientedImageData::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+  int extent[6] = { 0, -1, 0, -1, 0, -1 };
+  this->GetExtent(extent);
+  os << indent << "Extent: " << extent[0] << " " << extent[1] << " " << extent[2]
+    << " " << extent[3] << " " << extent[4] << " " << extent[5] << "\n";
+  os << indent << "ScalarType: " << this->ScalarType << "\n";
+  os << indent << "TileSize: " << this->TileSize << "\n";
+  os << indent << "NumberOfStoredTiles: " << this->GetNumberOfStoredTiles() << "\n";
+  os << indent << "NumberOfDenseTiles: " << this->GetNumberOfDenseTiles() << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkSparseOrientedImageData::Initialize()
+{
+  this->Superclass::Initialize();
+  this->Tiles.clear();
+  if (this->Geometry)
+    {
+    vtkNew<vtkMatrix4x4> identityMatrix;
+    this->Geometry->SetImageToWorldMatrix(identityMatrix.GetPointer());
+    int emptyExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    this->Geometry->SetExtent(emptyExtent);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkSparseOrientedImageData::ShallowCopy(vtkDataObject *src)
+{
+  vtkSparseOrientedImageData* sparseImage = vtkSparseOrientedImageData::SafeDownCast(src);
+  if (!sparseImage)
+    {
+    vtkErrorMacro("ShallowCopy: source is not a sparse oriented image");
+    return;
+    }
+  this->Superclass::ShallowCopy(src);
+  this->TileSize = sparseImage->TileSize;
+  this->ScalarType = sparseImage->ScalarType;
+  vtkNew<vtkMatrix4x4> imageToWorldMatrix;
+  sparseImage->GetImageToWorldMatrix(imageToWorldMatrix.GetPointer());
+  this->Geometry->SetImageToWorldMatrix(imageToWorldMatrix.GetPointer());
+  this->Geometry->SetExtent(sparseImage->Geometry->GetExtent());
+  this->Tiles = sparseImage->Tiles;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkSparseOrientedImageData::DeepCopy(vtkDataObject *src)
+{
+  vtkSparseOrientedImageData* sparseImage = vtkSparseOrientedImageData::SafeDownCast(src);
+  if (!sparseImage)
+    {
+    vtkErrorMacro("DeepCopy: source is not a sparse oriented image");
+    return;
+    }
+  this->ShallowCopy(src);
+  for (TileMapType::iterator tileIt = this->Tiles.begin(); tileIt != this->Tiles.end(); ++tileIt)
+    {
+    if (tileIt->second.Voxels)
+      {
+      vtkSmartPointer<vtkDataArray> voxels = vtkSmartPointer<vtkDataArray>::Take(tileIt->second.Voxels->NewInstance());
+      voxels->DeepCopy(tileIt->second.Voxels);
+      tileIt->second.Voxels = voxels;
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkSparseOrientedImageData::GetActualMemorySize()
+{
+  unsigned long size = this->Superclass::GetActualMemorySize();
+  size += static_cast<unsigned long>(this->Tiles.size() * (sizeof(TileIndexType) + sizeof(TileType)) / 1024);
+  for (TileMapType::iterator tileIt = this->Tiles.begin(); tileIt != this->Tiles.end(); ++tileIt)
+    {
+    if (tileIt->second.Voxels)
+      {
+      size += tileIt->second.Voxels->GetActualMemorySize();
+      }
+    }
+  return size;
+}
+
+//----------------------------------------------------------------------------
+void vtkSparseOrientedImageData::SetTileSize(int tileSize)
+{
+  if (tileSize < 1)
+    {
+    vtkErrorMacro("SetTileSize: invalid tile size " << tileSize);
+    return;
+    }
+  if (this->TileSize == tileSize)
+    {
+    return;
+    }
+  this->TileSize = tileSize;
+  this->Tiles.clear();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkSparseOrientedImageData::GetExtent(int extent[6])
+{
+  this->Geometry->GetExtent(extent);
+}
+
+//----------------------------------------------------------------------------
+void vtkSparseOrientedImageData::GetImageToWorldMatrix(vtkMatrix4x4* mat)
+{
+  this->Geometry->GetImageToWorldMatrix(mat);
+}
+
+//----------------------------------------------------------------------------
+void vtkSparseOrientedImageData::SetImageToWorldMatrix(vtkMatrix4x4* mat)
+{
+  this->Geometry->SetImageToWorldMatrix(mat);
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkSparseOrientedImageData::GetGeometryImage(vtkOrientedImageData* image)
+{
+  if (!image)
+    {
+    return;
+    }
+  vtkNew<vtkMatrix4x4> imageToWorldMatrix;
+  this->Geometry->GetImageToWorldMatrix(imageToWorldMatrix.GetPointer());
+  image->SetImageToWorldMatrix(imageToWorldMatrix.GetPointer());
+  image->SetExtent(this->Geometry->GetExtent());
+}
+
+//----------------------------------------------------------------------------
+void vtkSparseOrientedImageData::GetTileExtent(const TileIndexType& tileIndex, int tileExtent[6])
+{
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    tileExtent[axis * 2] = tileIndex[axis] * this->TileSize;
+    tileExtent[axis * 2 + 1] = tileExtent[axis * 2] + this->TileSize - 1;
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkSparseOrientedImageData::GetTileIndexRange(const int extent[6], int tileIndexRange[6])
+{
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    tileIndexRange[axis * 2] = FloorDivide(extent[axis * 2], this->TileSize);
+    tileIndexRange[axis * 2 + 1] = FloorDivide(extent[axis * 2 + 1], this->TileSize);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkSparseOrientedImageData::ExtractTile(const TileIndexType& tileIndex, vtkOrientedImageData* tileImage)
+{
+  int tileExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  this->GetTileExtent(tileIndex, tileExtent);
+  this->GetGeometryImage(tileImage);
+  tileImage->SetExtent(tileExtent);
+  tileImage->AllocateScalars(this->ScalarType, 1);
+
+  TileMapType::iterator tileIt = this->Tiles.find(tileIndex);
+  if (tileIt == this->Tiles.end())
+    {
+    vtkOrientedImageDataResample::FillImage(tileImage, 0.0);
+    }
+  else if (tileIt->second.Voxels)
+    {
+    tileImage->GetPointData()->GetScalars()->DeepCopy(tileIt->second.Voxels);
+    }
+  else
+    {
+    vtkOrientedImageDataResample::FillImage(tileImage, tileIt->second.Value);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkSparseOrientedImageData::StoreTile(const TileIndexType& tileIndex, vtkOrientedImageData* tileImage, const int validExtent[6])
+{
+  double uniformValue = 0.0;
+  if (IsRegionUniform(tileImage, validExtent, uniformValue))
+    {
+    if (uniformValue == 0.0)
+      {
+      this->Tiles.erase(tileIndex);
+      return;
+      }
+    TileType& tile = this->Tiles[tileIndex];
+    tile.Value = uniformValue;
+    tile.Voxels = nullptr;
+    return;
+    }
+  TileType& tile = this->Tiles[tileIndex];
+  tile.Value = 0.0;
+  tile.Voxels = tileImage->GetPointData()->GetScalars();
+}
+
+//----------------------------------------------------------------------------
+bool vtkSparseOrientedImageData::SetFromImage(vtkOrientedImageData* image)
+{
+  if (!image)
+    {
+    vtkErrorMacro("SetFromImage: invalid input image");
+    return false;
+    }
+  this->Tiles.clear();
+  vtkNew<vtkMatrix4x4> imageToWorldMatrix;
+  image->GetImageToWorldMatrix(imageToWorldMatrix.GetPointer());
+  this->Geometry->SetImageToWorldMatrix(imageToWorldMatrix.GetPointer());
+  int extent[6] = { 0, -1, 0, -1, 0, -1 };
+  image->GetExtent(extent);
+  this->Geometry->SetExtent(extent);
+  this->Modified();
+
+  if (IsExtentEmpty(extent) || !image->GetPointData() || !image->GetPointData()->GetScalars())
+    {
+    // empty image
+    return true;
+    }
+  if (image->GetNumberOfScalarComponents() != 1)
+    {
+    vtkErrorMacro("SetFromImage: only single-component images are supported");
+    return false;
+    }
+  this->ScalarType = image->GetScalarType();
+
+  int tileIndexRange[6] = { 0, -1, 0, -1, 0, -1 };
+  this->GetTileIndexRange(extent, tileIndexRange);
+  vtkNew<vtkOrientedImageData> tileImage;
+  for (int tileK = tileIndexRange[4]; tileK <= tileIndexRange[5]; ++tileK)
+    {
+    for (int tileJ = tileIndexRange[2]; tileJ <= tileIndexRange[3]; ++tileJ)
+      {
+      for (int tileI = tileIndexRange[0]; tileI <= tileIndexRange[1]; ++tileI)
+        {
+        TileIndexType tileIndex = {{ tileI, tileJ, tileK }};
+        int tileExtent[6] = { 0, -1, 0, -1, 0, -1 };
+        this->GetTileExtent(tileIndex, tileExtent);
+        int validExtent[6] = { 0, -1, 0, -1, 0, -1 };
+        IntersectExtents(tileExtent, extent, validExtent);
+        double uniformValue = 0.0;
+        if (IsRegionUniform(image, validExtent, uniformValue))
+          {
+          if (uniformValue != 0.0)
+            {
+            this->Tiles[tileIndex].Value = uniformValue;
+            }
+          continue;
+          }
+        // Voxels outside the image extent are set to 0
+        tileImage->SetExtent(tileExtent);
+        tileImage->AllocateScalars(this->ScalarType, 1);
+        vtkOrientedImageDataResample::FillImage(tileImage, 0.0);
+        CopyRegion(image, tileImage, validExtent);
+        this->Tiles[tileIndex].Voxels = tileImage->GetPointData()->GetScalars();
+        // make sure the next tile does not overwrite the stored voxels
+        tileImage->GetPointData()->SetScalars(nullptr);
+        }
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSparseOrientedImageData::GetImage(vtkOrientedImageData* image, const int extent[6]/*=nullptr*/)
+{
+  if (!image)
+    {
+    vtkErrorMacro("GetImage: invalid output image");
+    return false;
+    }
+  int outputExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  this->GetExtent(outputExtent);
+  if (extent)
+    {
+    std::copy(extent, extent + 6, outputExtent);
+    }
+  this->GetGeometryImage(image);
+  image->SetExtent(outputExtent);
+  image->AllocateScalars(this->ScalarType, 1);
+  vtkOrientedImageDataResample::FillImage(image, 0.0);
+
+  int copyExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  if (IsExtentEmpty(outputExtent) || !IntersectExtents(outputExtent, this->Geometry->GetExtent(), copyExtent))
+    {
+    return true;
+    }
+
+  int tileIndexRange[6] = { 0, -1, 0, -1, 0, -1 };
+  this->GetTileIndexRange(copyExtent, tileIndexRange);
+  vtkNew<vtkImageData> tileImage;
+  for (int tileK = tileIndexRange[4]; tileK <= tileIndexRange[5]; ++tileK)
+    {
+    for (int tileJ = tileIndexRange[2]; tileJ <= tileIndexRange[3]; ++tileJ)
+      {
+      for (int tileI = tileIndexRange[0]; tileI <= tileIndexRange[1]; ++tileI)
+        {
+        TileIndexType tileIndex = {{ tileI, tileJ, tileK }};
+        TileMapType::iterator tileIt = this->Tiles.find(tileIndex);
+        if (tileIt == this->Tiles.end())
+          {
+          continue;
+          }
+        int tileExtent[6] = { 0, -1, 0, -1, 0, -1 };
+        this->GetTileExtent(tileIndex, tileExtent);
+        int regionExtent[6] = { 0, -1, 0, -1, 0, -1 };
+        IntersectExtents(tileExtent, copyExtent, regionExtent);
+        if (tileIt->second.Voxels)
+          {
+          // Stored voxels are only read, so they can be used directly
+          tileImage->SetExtent(tileExtent);
+          tileImage->GetPointData()->SetScalars(tileIt->second.Voxels);
+          CopyRegion(tileImage, image, regionExtent);
+          }
+        else
+          {
+          vtkOrientedImageDataResample::FillImage(image, tileIt->second.Value, regionExtent);
+          }
+        }
+      }
+    }
+  image->Modified();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSparseOrientedImageData::ModifyImage(vtkOrientedImageData* modifierImage, int operation,
+  const int extent[6]/*=nullptr*/, double maskThreshold/*=0*/, double fillValue/*=1*/, bool* outputModified/*=nullptr*/)
+{
+  if (outputModified)
+    {
+    (*outputModified) = false;
+    }
+  if (!modifierImage)
+    {
+    vtkErrorMacro("ModifyImage: invalid modifier image");
+    return false;
+    }
+  if (!vtkOrientedImageDataResample::DoGeometriesMatch(this->Geometry, modifierImage))
+    {
+    vtkErrorMacro("ModifyImage: geometry mismatch between image and modifier image");
+    return false;
+    }
+
+  // Compute update extent as intersection of image, modifier and specified extents
+  int updateExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  if (!IntersectExtents(this->Geometry->GetExtent(), modifierImage->GetExtent(), updateExtent)
+    || (extent && !IntersectExtents(updateExtent, extent, updateExtent)))
+    {
+    // nothing to do
+    return true;
+    }
+
+  bool modified = false;
+  int tileIndexRange[6] = { 0, -1, 0, -1, 0, -1 };
+  this->GetTileIndexRange(updateExtent, tileIndexRange);
+  for (int tileK = tileIndexRange[4]; tileK <= tileIndexRange[5]; ++tileK)
+    {
+    for (int tileJ = tileIndexRange[2]; tileJ <= tileIndexRange[3]; ++tileJ)
+      {
+      for (int tileI = tileIndexRange[0]; tileI <= tileIndexRange[1]; ++tileI)
+        {
+        TileIndexType tileIndex = {{ tileI, tileJ, tileK }};
+        int tileExtent[6] = { 0, -1, 0, -1, 0, -1 };
+        this->GetTileExtent(tileIndex, tileExtent);
+        int regionExtent[6] = { 0, -1, 0, -1, 0, -1 };
+        IntersectExtents(tileExtent, updateExtent, regionExtent);
+
+        vtkNew<vtkOrientedImageData> tileImage;
+        this->ExtractTile(tileIndex, tileImage.GetPointer());
+        vtkMTimeType tileImageMTimeBefore = tileImage->GetMTime();
+        if (!vtkOrientedImageDataResample::ModifyImage(tileImage.GetPointer(), modifierImage, operation,
+          regionExtent, maskThreshold, fillValue))
+          {
+          return false;
+          }
+        if (tileImage->GetMTime() <= tileImageMTimeBefore)
+          {
+          // no voxels changed
+          continue;
+          }
+        int validExtent[6] = { 0, -1, 0, -1, 0, -1 };
+        IntersectExtents(tileExtent, this->Geometry->GetExtent(), validExtent);
+        this->StoreTile(tileIndex, tileImage.GetPointer(), validExtent);
+        modified = true;
+        }
+      }
+    }
+  if (modified)
+    {
+    this->Modified();
+    }
+  if (outputModified)
+    {
+    (*outputModified) = modified;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkSparseOrientedImageData::SetExtent(const int extent[6])
+{
+  int oldExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  this->GetExtent(oldExtent);
+  if (std::equal(oldExtent, oldExtent + 6, extent))
+    {
+    return;
+    }
+
+  std::vector<TileIndexType> tilesToUpdate;
+  for (TileMapType::iterator tileIt = this->Tiles.begin(); tileIt != this->Tiles.end(); )
+    {
+    int tileExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    this->GetTileExtent(tileIt->first, tileExtent);
+    int newValidExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    if (IsExtentEmpty(extent) || !IntersectExtents(tileExtent, extent, newValidExtent))
+      {
+      // tile is completely outside of the new extent
+      this->Tiles.erase(tileIt++);
+      continue;
+      }
+    int oldValidExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    IntersectExtents(tileExtent, oldExtent, oldValidExtent);
+    if (!std::equal(oldValidExtent, oldValidExtent + 6, newValidExtent))
+      {
+      // valid region of the tile changes
+      tilesToUpdate.push_back(tileIt->first);
+      }
+    ++tileIt;
+    }
+
+  this->Geometry->SetExtent(const_cast<int*>(extent));
+
+  vtkNew<vtkOrientedImageData> oldTileImage;
+  for (std::vector<TileIndexType>::iterator tileIndexIt = tilesToUpdate.begin(); tileIndexIt != tilesToUpdate.end(); ++tileIndexIt)
+    {
+    int tileExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    this->GetTileExtent(*tileIndexIt, tileExtent);
+    this->ExtractTile(*tileIndexIt, oldTileImage.GetPointer());
+    // Only keep voxels that were inside the old extent
+    vtkNew<vtkOrientedImageData> tileImage;
+    this->GetGeometryImage(tileImage.GetPointer());
+    tileImage->SetExtent(tileExtent);
+    tileImage->AllocateScalars(this->ScalarType, 1);
+    vtkOrientedImageDataResample::FillImage(tileImage.GetPointer(), 0.0);
+    int keptExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    if (IntersectExtents(tileExtent, oldExtent, keptExtent)
+      && IntersectExtents(keptExtent, extent, keptExtent))
+      {
+      CopyRegion(oldTileImage.GetPointer(), tileImage.GetPointer(), keptExtent);
+      }
+    int validExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    IntersectExtents(tileExtent, extent, validExtent);
+    this->StoreTile(*tileIndexIt, tileImage.GetPointer(), validExtent);
+    }
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+bool vtkSparseOrientedImageData::GetOccupiedExtent(int extent[6])
+{
+  int occupiedExtent[6] = { VTK_INT_MAX, VTK_INT_MIN, VTK_INT_MAX, VTK_INT_MIN, VTK_INT_MAX, VTK_INT_MIN };
+  bool occupied = false;
+  for (TileMapType::iterator tileIt = this->Tiles.begin(); tileIt != this->Tiles.end(); ++tileIt)
+    {
+    int tileExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    this->GetTileExtent(tileIt->first, tileExtent);
+    int validExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    if (!IntersectExtents(tileExtent, this->Geometry->GetExtent(), validExtent))
+      {
+      continue;
+      }
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      occupiedExtent[axis * 2] = std::min(occupiedExtent[axis * 2], validExtent[axis * 2]);
+      occupiedExtent[axis * 2 + 1] = std::max(occupiedExtent[axis * 2 + 1], validExtent[axis * 2 + 1]);
+      }
+    occupied = true;
+    }
+  if (!occupied)
+    {
+    int emptyExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    std::copy(emptyExtent, emptyExtent + 6, extent);
+    return false;
+    }
+  std::copy(occupiedExtent, occupiedExtent + 6, extent);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSparseOrientedImageData::IsEmpty()
+{
+  return this->Tiles.empty();
+}
+
+//----------------------------------------------------------------------------
+int vtkSparseOrientedImageData::GetNumberOfStoredTiles()
+{
+  return static_cast<int>(this->Tiles.size());
+}
+
+//----------------------------------------------------------------------------
+int vtkSparseOrientedImageData::GetNumberOfDenseTiles()
+{
+  int numberOfDenseTiles = 0;
+  for (TileMapType::iterator tileIt = this->Tiles.begin(); tileIt != this->Tiles.end(); ++tileIt)
+    {
+    if (tileIt->second.Voxels)
+      {
+      ++numberOfDenseTiles;
+      }
+    }
+  return numberOfDenseTiles;
+}
@@ -0,0 +1,165 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkSparseOrientedImageData_h
+#define __vtkSparseOrientedImageData_h
+
+// Segmentation includes
+#include "vtkSegmentationCoreConfigure.h"
+
+// VTK includes
+#include <vtkDataObject.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <array>
+#include <map>
+
+class vtkDataArray;
+class vtkMatrix4x4;
+class vtkOrientedImageData;
+
+/// \ingroup SegmentationCore
+/// \brief Block-sparse storage of a single-component oriented image (labelmap)
+///
+/// The image is divided into cubic tiles of TileSize^3 voxels, aligned to
+/// the voxel grid (tile (0,0,0) starts at voxel (0,0,0)). Tiles that only
+/// contain background (0) are not stored, tiles that contain a single value
+/// (e.g., the inside of a segment) are stored as that value, and only the
+/// remaining tiles (near segment boundaries) store their voxels.
+///
+/// Segments that cover a small part of a large reference geometry therefore
+/// use memory proportional to their size instead of the size of the
+/// reference geometry. The dense image can be retrieved at any time, either
+/// completely or for a sub-extent, using GetImage.
+///
+/// Voxels are modified with the same max/min/masking operations as
+/// vtkOrientedImageDataResample::ModifyImage, processing only the tiles
+/// that overlap the modifier image.
+///
+/// In segmentations, sparse labelmaps are stored in the "Sparse binary labelmap"
+/// representation (one segment per labelmap, foreground value 1), which is
+/// converted from and to the dense "Binary labelmap" representation by
+/// vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule and
+/// vtkSparseBinaryLabelmapToBinaryLabelmapConversionRule. Code that works on
+/// vtkOrientedImageData labelmaps (segment editor effects, displayable managers)
+/// uses the converted dense representation.
+class vtkSegmentationCore_EXPORT vtkSparseOrientedImageData : public vtkDataObject
+{
+public:
+  static vtkSparseOrientedImageData *New();
+  vtkTypeMacro(vtkSparseOrientedImageData, vtkDataObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /// Remove all tiles and reset geometry
+  void Initialize() override;
+  /// Shallow copy. Tile voxel arrays are shared (they are never modified in place).
+  void ShallowCopy(vtkDataObject *src) override;
+  /// Deep copy
+  void DeepCopy(vtkDataObject *src) override;
+
+  /// Memory used by the stored tiles, in kibibytes
+  unsigned long GetActualMemorySize() override;
+
+  /// Number of voxels along each side of a tile. Default is 32.
+  /// Changing the tile size removes all the tiles.
+  void SetTileSize(int tileSize);
+  vtkGetMacro(TileSize, int);
+
+  /// Scalar type of the voxels. Default is VTK_UNSIGNED_CHAR.
+  vtkGetMacro(ScalarType, int);
+  vtkSetMacro(ScalarType, int);
+
+  /// Store the contents of a dense single-component image.
+  /// Geometry, extent and scalar type are copied from the image.
+  bool SetFromImage(vtkOrientedImageData* image);
+
+  /// Write voxels into a dense image.
+  /// If extent is not specified then the whole extent is extracted.
+  /// Voxels outside the extent of this image are set to 0.
+  bool GetImage(vtkOrientedImageData* image, const int extent[6]=nullptr);
+
+  /// Combine with a dense modifier image, see vtkOrientedImageDataResample::ModifyImage.
+  /// The extent remains unchanged. Only tiles that overlap the modifier image
+  /// (and optional extent) are processed.
+  /// \param outputModified If not null then it is set to true if any voxel changed.
+  bool ModifyImage(vtkOrientedImageData* modifierImage, int operation,
+    const int extent[6]=nullptr, double maskThreshold=0, double fillValue=1, bool* outputModified=nullptr);
+
+  /// Get/set the image extent. Voxels that are outside of the new extent are removed,
+  /// voxels in the added region are set to 0.
+  void SetExtent(const int extent[6]);
+  void GetExtent(int extent[6]);
+
+  /// Get/set the image geometry (directions, spacing, origin)
+  void GetImageToWorldMatrix(vtkMatrix4x4* mat);
+  void SetImageToWorldMatrix(vtkMatrix4x4* mat);
+
+  /// Get an empty (no scalars) image that has the same geometry and extent
+  void GetGeometryImage(vtkOrientedImageData* image);
+
+  /// Compute the extent of the stored (not background) tiles, clipped to the image extent.
+  /// Returns false if all the voxels are background.
+  bool GetOccupiedExtent(int extent[6]);
+
+  /// Returns true if all the voxels are background
+  bool IsEmpty();
+
+  /// Number of tiles that are stored, as a single value or as voxels
+  int GetNumberOfStoredTiles();
+  /// Number of tiles that store their voxels
+  int GetNumberOfDenseTiles();
+
+protected:
+  typedef std::array<int, 3> TileIndexType;
+  struct TileType
+    {
+    TileType() : Value(0.0) { }
+    /// Value of all the voxels if Voxels is null
+    double Value;
+    /// TileSize^3 voxels, x index increasing fastest
+    vtkSmartPointer<vtkDataArray> Voxels;
+    };
+  typedef std::map<TileIndexType, TileType> TileMapType;
+
+  /// Get voxel extent of a tile (not clipped to the image extent)
+  void GetTileExtent(const TileIndexType& tileIndex, int tileExtent[6]);
+  /// Get range of tile indices that overlap an extent
+  void GetTileIndexRange(const int extent[6], int tileIndexRange[6]);
+
+  /// Write a tile into a dense image that has the tile's extent
+  void ExtractTile(const TileIndexType& tileIndex, vtkOrientedImageData* tileImage);
+  /// Store a dense image that has the tile's extent. Only voxels inside
+  /// validExtent are taken into account for detecting uniform tiles.
+  void StoreTile(const TileIndexType& tileIndex, vtkOrientedImageData* tileImage, const int validExtent[6]);
+
+protected:
+  vtkSparseOrientedImageData();
+  ~vtkSparseOrientedImageData() override;
+
+protected:
+  int TileSize;
+  int ScalarType;
+  /// Image without scalars that stores geometry and extent
+  vtkSmartPointer<vtkOrientedImageData> Geometry;
+  TileMapType Tiles;
+
+private:
+  vtkSparseOrientedImageData(const vtkSparseOrientedImageData&) = delete;
+  void operator=(const vtkSparseOrientedImageData&) = delete;
+};
+
+#endif
@@ -0,0 +1,116 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c) Kitware Inc.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// vtkTeem includes
+#include <vtkTeemNRRDReader.h>
+#include <vtkTeemNRRDWriter.h>
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+bool writeAndReadImage(vtkImageData* image, const std::string& fileName, int numberOfThreads)
+{
+  vtkNew<vtkTimerLog> timer;
+  vtkNew<vtkTeemNRRDWriter> writer;
+  writer->SetFileName(fileName.c_str());
+  writer->SetInputData(image);
+  writer->SetUseCompression(1);
+  writer->SetCompressionLevel(1);
+  writer->SetNumberOfCompressionThreads(numberOfThreads);
+  writer->SetCompressionChunkSize(65536);
+  timer->StartTimer();
+  writer->Write();
+  timer->StopTimer();
+  std::cout << "Write with " << numberOfThreads << " threads: " << timer->GetElapsedTime() << "s" << std::endl;
+  if (writer->GetWriteError())
+    {
+    std::cerr << "Failed to write " << fileName << std::endl;
+    return false;
+    }
+
+  vtkNew<vtkTeemNRRDReader> reader;
+  reader->SetFileName(fileName.c_str());
+  reader->Update();
+  vtkImageData* readImage = reader->GetOutput();
+  if (readImage->GetNumberOfPoints() != image->GetNumberOfPoints()
+    || readImage->GetScalarType() != image->GetScalarType())
+    {
+    std::cerr << "Image read from " << fileName << " has invalid size or type" << std::endl;
+    return false;
+    }
+  if (memcmp(readImage->GetScalarPointer(), image->GetScalarPointer(),
+    image->GetNumberOfPoints() * image->GetScalarSize()) != 0)
+    {
+    std::cerr << "Image read from " << fileName << " has different voxel values" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkTeemNRRDWriterTest1(int argc, char* argv[])
+{
+  if (argc < 2)
+    {
+    std::cerr << "Usage: vtkTeemNRRDWriterTest1 /path/to/temp" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::string tempDir = argv[1];
+
+  // Image that is split into many chunks. The last chunk is not complete.
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(128, 128, 67);
+  image->AllocateScalars(VTK_SHORT, 1);
+  short* voxels = static_cast<short*>(image->GetScalarPointer());
+  vtkIdType numberOfVoxels = image->GetNumberOfPoints();
+  for (vtkIdType i = 0; i < numberOfVoxels; ++i)
+    {
+    voxels[i] = static_cast<short>((i / 7) % 1000 - 500);
+    }
+
+  // Compressed by Teem
+  if (!writeAndReadImage(image.GetPointer(), tempDir + "/vtkTeemNRRDWriterTest1_1.nrrd", 1))
+    {
+    return EXIT_FAILURE;
+    }
+  // Compressed in chunks
+  if (!writeAndReadImage(image.GetPointer(), tempDir + "/vtkTeemNRRDWriterTest1_4.nrrd", 4))
+    {
+    return EXIT_FAILURE;
+    }
+  // Detached header is written by Teem
+  if (!writeAndReadImage(image.GetPointer(), tempDir + "/vtkTeemNRRDWriterTest1_4.nhdr", 4))
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
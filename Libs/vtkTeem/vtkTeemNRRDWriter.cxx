@@ -8,6 +8,15 @@
 #include "vtkObjectFactory.h"
 #include "vtkInformation.h"
 #include <vtkVersion.h>
+#include <vtk_zlib.h>
+#include <vtksys/FStream.hxx>
+#include <vtksys/SystemTools.hxx>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
 
 #include <vnl/vnl_math.h>
 #include <vnl/vnl_double_3.h>
@@ -18,6 +27,31 @@
 class AttributeMapType: public std::map<std::string, std::string> {};
 class AxisInfoMapType : public std::map<unsigned int, std::string> {};
 
+namespace
+{
+//----------------------------------------------------------------------------
+// Compress data into a complete gzip member (header, deflate stream, and trailer)
+bool CompressGzipChunk(const unsigned char* data, size_t size, int level, std::vector<unsigned char>& compressed)
+{
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  // windowBits = 15 + 16 writes gzip header and trailer instead of zlib wrapper
+  if (deflateInit2(&stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+    return false;
+    }
+  compressed.resize(deflateBound(&stream, static_cast<uLong>(size)) + 32);
+  stream.next_in = const_cast<Bytef*>(data);
+  stream.avail_in = static_cast<uInt>(size);
+  stream.next_out = compressed.data();
+  stream.avail_out = static_cast<uInt>(compressed.size());
+  int result = deflate(&stream, Z_FINISH);
+  compressed.resize(stream.total_out);
+  deflateEnd(&stream);
+  return (result == Z_STREAM_END);
+}
+}
+
 vtkStandardNewMacro(vtkTeemNRRDWriter);
 
 //----------------------------------------------------------------------------
@@ -31,6 +65,8 @@ vtkTeemNRRDWriter::vtkTeemNRRDWriter()
   this->UseCompression = 1;
   // use default CompressionLevel
   this->CompressionLevel = -1;
+  this->NumberOfCompressionThreads = 0;
+  this->CompressionChunkSize = 4 * 1024 * 1024;
   this->DiffusionWeightedData = 0;
   this->FileType = VTK_BINARY;
   this->WriteErrorOff();
@@ -438,7 +474,20 @@ void vtkTeemNRRDWriter::WriteData()
   nio->endian = airEndianUnknown;
 
   // Write the nrrd to file.
-  if (nrrdSave(this->GetFileName(), nrrd, nio))
+  bool written = false;
+  if (nio->encoding == nrrdEncodingGzip)
+    {
+    int numberOfThreads = this->NumberOfCompressionThreads;
+    if (numberOfThreads <= 0)
+      {
+      numberOfThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+      }
+    if (numberOfThreads > 1)
+      {
+      written = this->WriteDataCompressedInParallel(nrrd, nio, numberOfThreads);
+      }
+    }
+  if (!written && nrrdSave(this->GetFileName(), nrrd, nio))
     {
     char *err = biffGetDone(NRRD); // would be nice to free(err)
     vtkErrorMacro("Write: Error writing "
@@ -451,6 +500,96 @@ void vtkTeemNRRDWriter::WriteData()
   return;
 }
 
+//----------------------------------------------------------------------------
+bool vtkTeemNRRDWriter::WriteDataCompressedInParallel(Nrrd* nrrd, NrrdIoState* nio, int numberOfThreads)
+{
+  size_t dataSize = nrrdElementNumber(nrrd) * nrrdElementSize(nrrd);
+  size_t chunkSize = static_cast<size_t>(this->CompressionChunkSize);
+  if (dataSize <= chunkSize)
+    {
+    // nothing to parallelize
+    return false;
+    }
+  std::string fileName = this->GetFileName();
+  if (vtksys::SystemTools::LowerCase(vtksys::SystemTools::GetFilenameLastExtension(fileName)) != ".nrrd")
+    {
+    // detached data file is written by Teem
+    return false;
+    }
+
+  // Write the header (ending with the empty line that separates it from the data)
+  nio->skipData = 1;
+  if (nrrdSave(fileName.c_str(), nrrd, nio))
+    {
+    char *err = biffGetDone(NRRD); // would be nice to free(err)
+    vtkErrorMacro("Write: Error writing header of " << fileName << ":\n" << err);
+    this->WriteErrorOn();
+    return true;
+    }
+
+  vtksys::ofstream file(fileName.c_str(), std::ios::out | std::ios::binary | std::ios::app);
+  if (!file)
+    {
+    vtkErrorMacro("Write: Error opening " << fileName << " for writing voxels");
+    this->WriteErrorOn();
+    return true;
+    }
+
+  // Compress a few chunks per thread at a time and write them in order,
+  // so that the compressed data kept in memory remains small.
+  const unsigned char* data = static_cast<const unsigned char*>(nrrd->data);
+  size_t numberOfChunks = (dataSize + chunkSize - 1) / chunkSize;
+  size_t batchSize = 2 * static_cast<size_t>(numberOfThreads);
+  std::vector< std::vector<unsigned char> > compressedChunks(batchSize);
+  for (size_t firstChunk = 0; firstChunk < numberOfChunks; firstChunk += batchSize)
+    {
+    size_t endChunk = std::min(firstChunk + batchSize, numberOfChunks);
+    std::atomic<size_t> nextChunk(firstChunk);
+    std::atomic<bool> compressionFailed(false);
+    auto compressChunks = [&]()
+      {
+      for (size_t chunk = nextChunk++; chunk < endChunk; chunk = nextChunk++)
+        {
+        size_t offset = chunk * chunkSize;
+        if (!CompressGzipChunk(data + offset, std::min(chunkSize, dataSize - offset),
+          this->CompressionLevel, compressedChunks[chunk - firstChunk]))
+          {
+          compressionFailed = true;
+          }
+        }
+      };
+    std::vector<std::thread> threads;
+    for (int threadIndex = 1; threadIndex < numberOfThreads && threadIndex < static_cast<int>(endChunk - firstChunk); ++threadIndex)
+      {
+      threads.emplace_back(compressChunks);
+      }
+    compressChunks();
+    for (std::thread& thread : threads)
+      {
+      thread.join();
+      }
+    if (compressionFailed)
+      {
+      vtkErrorMacro("Write: Error compressing voxels of " << fileName);
+      this->WriteErrorOn();
+      return true;
+      }
+    for (size_t chunk = firstChunk; chunk < endChunk; ++chunk)
+      {
+      std::vector<unsigned char>& compressedChunk = compressedChunks[chunk - firstChunk];
+      file.write(reinterpret_cast<const char*>(compressedChunk.data()), compressedChunk.size());
+      }
+    if (!file)
+      {
+      vtkErrorMacro("Write: Error writing voxels to " << fileName);
+      this->WriteErrorOn();
+      return true;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
 void vtkTeemNRRDWriter::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
@@ -459,6 +598,10 @@ void vtkTeemNRRDWriter::PrintSelf(ostream& os, vtkIndent indent)
      this->IJKToRASMatrix->PrintSelf(os,indent);
   os << indent << "Measurement frame: ";
      this->MeasurementFrameMatrix->PrintSelf(os,indent);
+  os << indent << "UseCompression: " << this->UseCompression << "\n";
+  os << indent << "CompressionLevel: " << this->CompressionLevel << "\n";
+  os << indent << "NumberOfCompressionThreads: " << this->NumberOfCompressionThreads << "\n";
+  os << indent << "CompressionChunkSize: " << this->CompressionChunkSize << "\n";
 }
 
 void vtkTeemNRRDWriter::SetAttribute(const std::string& name, const std::string& value)
@@ -58,6 +58,17 @@ public:
   vtkSetClampMacro(CompressionLevel, int, 0, 9);
   vtkGetMacro(CompressionLevel, int);
 
+  /// Number of threads used for gzip compression. 0 (default) means the number of processor cores.
+  /// If more than one thread is used and the voxels are stored in the same file as the header (.nrrd)
+  /// then the voxels are split into chunks, which are compressed in parallel and written
+  /// as consecutive gzip members. Such files can be read by any gzip reader, including Teem and ITK.
+  vtkSetMacro(NumberOfCompressionThreads, int);
+  vtkGetMacro(NumberOfCompressionThreads, int);
+
+  /// Size of uncompressed data in each compressed chunk, in bytes (between 64kB and 1GB). Default is 4MB.
+  vtkSetClampMacro(CompressionChunkSize, vtkIdType, 65536, 1073741824);
+  vtkGetMacro(CompressionChunkSize, vtkIdType);
+
   vtkSetClampMacro(FileType,int,VTK_ASCII,VTK_BINARY);
   vtkGetMacro(FileType,int);
   void SetFileTypeToASCII() {this->SetFileType(VTK_ASCII);};
@@ -108,6 +119,12 @@ protected:
   /// Write method. It is called by vtkWriter::Write();
   void WriteData() override;
 
+  ///
+  /// Write gzip-compressed voxels using multiple threads.
+  /// Returns false if the file cannot be written this way (e.g., detached header),
+  /// in this case the file has to be written by Teem.
+  bool WriteDataCompressedInParallel(Nrrd* nrrd, NrrdIoState* nio, int numberOfThreads);
+
   ///
   /// Flag to set to on when a write error occurred
   int WriteError;
@@ -122,6 +139,8 @@ protected:
 
   int UseCompression;
   int CompressionLevel;
+  int NumberOfCompressionThreads;
+  vtkIdType CompressionChunkSize;
   int FileType;
 
   AttributeMapType *Attributes;
@@ -73,7 +73,7 @@ int DoIt( int argc, char * argv[], T )
                                        CLPProcessInformation);
   writer->SetFileName( outputVolume.c_str() );
   writer->SetInput( cast->GetOutput() );
-  writer->SetUseCompression(1);
+  writer->SetUseCompression(itk::UseCompressionForFileName(outputVolume));
   writer->Update();
 
   return EXIT_SUCCESS;
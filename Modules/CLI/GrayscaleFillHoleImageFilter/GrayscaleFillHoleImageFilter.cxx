@@ -68,7 +68,7 @@ int DoIt( int argc, char * argv[], T )
   // Setup the input and output files
   reader->SetFileName( inputVolume.c_str() );
   writer->SetFileName( outputVolume.c_str() );
-  writer->SetUseCompression(1);
+  writer->SetUseCompression(itk::UseCompressionForFileName(outputVolume));
 
   // Setup the fillhole method
   fillhole->SetInput(  reader->GetOutput() );
@@ -104,7 +104,7 @@ int DoIt( int argc, char * argv[] )
                                        CLPProcessInformation);
   writer->SetFileName( OutputVolume.c_str() );
   writer->SetInput( filter->GetOutput() );
-  writer->SetUseCompression(1);
+  writer->SetUseCompression(itk::UseCompressionForFileName(OutputVolume));
   writer->Update();
 
   return EXIT_SUCCESS;
@@ -62,7 +62,7 @@ int DoIt( int argc, char * argv[], T )
   filter->SetRadius( indexRadius );
   filter->SetInput( reader->GetOutput() );
   writer->SetInput( filter->GetOutput() );
-  writer->SetUseCompression(1);
+  writer->SetUseCompression(itk::UseCompressionForFileName(outputVolume));
   writer->Update();
   return EXIT_SUCCESS;
 }
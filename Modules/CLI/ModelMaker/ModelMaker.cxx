@@ -49,8 +49,10 @@ Version:   $Revision$
 #include <vtkImageToStructuredPoints.h>
 #include <vtkInformation.h>
 #include <vtkLookupTable.h>
+#include <vtkMatrix4x4.h>
 #include <vtkNew.h>
 #include <vtkPointData.h>
+#include <vtkPolyDataAlgorithm.h>
 #include <vtkPolyDataNormals.h>
 #include <vtkPolyDataWriter.h>
 #include <vtkReverseSense.h>
@@ -67,6 +69,438 @@ Version:   $Revision$
 // VTKsys includes
 #include <vtksys/SystemTools.hxx>
 
+// STD includes
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Model made from a single label when labels are processed in parallel
+struct LabelModel
+{
+  int Label{0};
+  std::string Name;
+  std::string FileName;
+  // Extent of the cropped label mask, in the index space of the input volume
+  int Extent[6]{0, -1, 0, -1, 0, -1};
+  // 1 if the model is written, 0 if no polygons could be created, -1 on error
+  int Status{0};
+  std::string ErrorMessage;
+};
+
+//----------------------------------------------------------------------------
+// Parameters of the surface extraction, shared by all labels
+struct LabelModelParameters
+{
+  std::string FilterType;
+  int Smooth{0};
+  float Decimate{0.0};
+  bool SplitNormals{true};
+  bool PointNormals{true};
+  bool SaveIntermediateModels{false};
+  bool ReverseNormals{false};
+  vtkMatrix4x4* IJKToLPSMatrix{nullptr};
+  std::string RootDirectory;
+  const char* FileHeader{nullptr};
+};
+
+//----------------------------------------------------------------------------
+std::string GetModelFileName(const std::string& rootDir, const std::string& labelName, const std::string& suffix)
+{
+  if (rootDir != "")
+    {
+    return rootDir + std::string("/") + labelName + suffix + std::string(".vtk");
+    }
+  return labelName + suffix + std::string(".vtk");
+}
+
+//----------------------------------------------------------------------------
+// Update the bounding box of each label in [minLabel, maxLabel] in a single
+// pass over the image. labelExtents holds 6 values per label.
+template <class T>
+void ComputeLabelExtents(vtkImageData* image, T* scalars, int minLabel, int maxLabel, std::vector<int>& labelExtents)
+{
+  int extent[6] = { 0, -1, 0, -1, 0, -1 };
+  image->GetExtent(extent);
+  int numberOfComponents = image->GetNumberOfScalarComponents();
+  for (int k = extent[4]; k <= extent[5]; k++)
+    {
+    for (int j = extent[2]; j <= extent[3]; j++)
+      {
+      for (int i = extent[0]; i <= extent[1]; i++, scalars += numberOfComponents)
+        {
+        double value = static_cast<double>(*scalars);
+        if (value < minLabel || value > maxLabel)
+          {
+          continue;
+          }
+        int label = static_cast<int>(value);
+        if (label != value)
+          {
+          continue;
+          }
+        int* labelExtent = &labelExtents[6 * (label - minLabel)];
+        labelExtent[0] = std::min(labelExtent[0], i);
+        labelExtent[1] = std::max(labelExtent[1], i);
+        labelExtent[2] = std::min(labelExtent[2], j);
+        labelExtent[3] = std::max(labelExtent[3], j);
+        labelExtent[4] = std::min(labelExtent[4], k);
+        labelExtent[5] = std::max(labelExtent[5], k);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Fill the mask with the same values as the image threshold filter of the
+// serial pipeline (200 inside the label, 0 outside). Voxels of the mask
+// extent that are outside of the image are set to 0, as with padding.
+template <class T>
+void ExtractLabelMask(vtkImageData* image, T* scalars, int label, const int maskExtent[6], unsigned char* mask)
+{
+  int extent[6] = { 0, -1, 0, -1, 0, -1 };
+  image->GetExtent(extent);
+  vtkIdType increments[3] = { 0, 0, 0 };
+  image->GetIncrements(increments);
+  for (int k = maskExtent[4]; k <= maskExtent[5]; k++)
+    {
+    for (int j = maskExtent[2]; j <= maskExtent[3]; j++)
+      {
+      for (int i = maskExtent[0]; i <= maskExtent[1]; i++, mask++)
+        {
+        if (i < extent[0] || i > extent[1] || j < extent[2] || j > extent[3] || k < extent[4] || k > extent[5])
+          {
+          *mask = 0;
+          continue;
+          }
+        T value = scalars[(i - extent[0]) * increments[0] + (j - extent[2]) * increments[1] + (k - extent[4]) * increments[2]];
+        *mask = (static_cast<double>(value) == label ? 200 : 0);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+bool WriteModel(vtkAlgorithm* algorithm, const std::string& fileName, const char* fileHeader)
+{
+  vtkNew<vtkPolyDataWriter> writer;
+  writer->SetInputConnection(algorithm->GetOutputPort());
+  writer->SetHeader(fileHeader);
+  writer->SetFileType(2);
+  writer->SetFileName(fileName.c_str());
+  return writer->Write() != 0;
+}
+
+//----------------------------------------------------------------------------
+// Run the per label pipeline of the serial path (marching cubes, decimation,
+// smoothing, transform, normals and stripping) on a cropped label mask and
+// write the model file. Does not touch any shared state, so that labels can
+// be processed concurrently.
+void MakeLabelModel(vtkImageData* image, const LabelModelParameters& parameters, LabelModel& labelModel)
+{
+  if (labelModel.Extent[0] > labelModel.Extent[1])
+    {
+    labelModel.Status = 0;
+    return;
+    }
+  vtkNew<vtkImageData> mask;
+  mask->SetExtent(labelModel.Extent);
+  mask->SetOrigin(image->GetOrigin());
+  mask->SetSpacing(image->GetSpacing());
+  mask->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  switch (image->GetScalarType())
+    {
+    vtkTemplateMacro(ExtractLabelMask(image, static_cast<VTK_TT*>(image->GetScalarPointer()), labelModel.Label,
+      labelModel.Extent, static_cast<unsigned char*>(mask->GetScalarPointer())));
+    default:
+      labelModel.Status = -1;
+      labelModel.ErrorMessage = "unsupported image scalar type";
+      return;
+    }
+
+#if VTK_MAJOR_VERSION >= 9 || (VTK_MAJOR_VERSION >= 8 && VTK_MINOR_VERSION >= 2)
+  vtkNew<vtkFlyingEdges3D> mcubes;
+#else
+  vtkNew<vtkMarchingCubes> mcubes;
+#endif
+  mcubes->SetInputData(mask.GetPointer());
+  mcubes->SetValue(0, 100.5);
+  mcubes->ComputeScalarsOff();
+  mcubes->ComputeGradientsOff();
+  mcubes->ComputeNormalsOff();
+  try
+    {
+    mcubes->Update();
+    }
+  catch(...)
+    {
+    labelModel.Status = -1;
+    labelModel.ErrorMessage = "ERROR while running marching cubes";
+    return;
+    }
+  if ((mcubes->GetOutput())->GetNumberOfPolys() == 0)
+    {
+    labelModel.Status = 0;
+    return;
+    }
+  if (parameters.SaveIntermediateModels)
+    {
+    std::string fileName = GetModelFileName(parameters.RootDirectory, labelModel.Name, "-MarchingCubes");
+    if (!WriteModel(mcubes.GetPointer(), fileName, parameters.FileHeader))
+      {
+      labelModel.ErrorMessage = "ERROR: Failed to write intermediate file " + fileName;
+      }
+    }
+
+  vtkNew<vtkDecimatePro> decimator;
+  decimator->SetInputConnection(mcubes->GetOutputPort());
+  decimator->SetFeatureAngle(60);
+  decimator->SplittingOff();
+  decimator->PreserveTopologyOn();
+  decimator->SetMaximumError(1);
+  decimator->SetTargetReduction(parameters.Decimate);
+  try
+    {
+    decimator->Update();
+    }
+  catch(...)
+    {
+    labelModel.Status = -1;
+    labelModel.ErrorMessage = "ERROR decimating model";
+    return;
+    }
+  if (parameters.SaveIntermediateModels)
+    {
+    std::string fileName = GetModelFileName(parameters.RootDirectory, labelModel.Name, "-Decimated");
+    if (!WriteModel(decimator.GetPointer(), fileName, parameters.FileHeader))
+      {
+      labelModel.ErrorMessage = "ERROR: Failed to write intermediate file " + fileName;
+      }
+    }
+
+  vtkAlgorithm* smootherInput = decimator.GetPointer();
+  vtkNew<vtkReverseSense> reverser;
+  if (parameters.ReverseNormals)
+    {
+    reverser->SetInputConnection(decimator->GetOutputPort());
+    reverser->ReverseNormalsOn();
+    smootherInput = reverser.GetPointer();
+    }
+
+  vtkSmartPointer<vtkPolyDataAlgorithm> smoother;
+  if (parameters.FilterType == "Sinc")
+    {
+    vtkNew<vtkWindowedSincPolyDataFilter> smootherSinc;
+    smootherSinc->SetPassBand(0.1);
+    smootherSinc->SetNumberOfIterations(parameters.Smooth);
+    smootherSinc->FeatureEdgeSmoothingOff();
+    smootherSinc->BoundarySmoothingOff();
+    smoother = smootherSinc.GetPointer();
+    }
+  else
+    {
+    vtkNew<vtkSmoothPolyDataFilter> smootherPoly;
+    smootherPoly->SetRelaxationFactor(0.33);
+    smootherPoly->SetFeatureAngle(60);
+    smootherPoly->SetConvergence(0);
+    smootherPoly->SetNumberOfIterations(parameters.Smooth);
+    smootherPoly->FeatureEdgeSmoothingOff();
+    smootherPoly->BoundarySmoothingOff();
+    smoother = smootherPoly.GetPointer();
+    }
+  smoother->SetInputConnection(smootherInput->GetOutputPort());
+  try
+    {
+    smoother->Update();
+    }
+  catch(...)
+    {
+    labelModel.Status = -1;
+    labelModel.ErrorMessage = "ERROR updating smoother";
+    return;
+    }
+  if (parameters.SaveIntermediateModels)
+    {
+    std::string fileName = GetModelFileName(parameters.RootDirectory, labelModel.Name, "-Smoothed");
+    if (!WriteModel(smoother, fileName, parameters.FileHeader))
+      {
+      labelModel.ErrorMessage = "ERROR: Failed to write intermediate file " + fileName;
+      }
+    }
+
+  // each thread uses its own transform, the pipeline updates it while executing
+  vtkNew<vtkTransform> transformIJKtoLPS;
+  transformIJKtoLPS->SetMatrix(parameters.IJKToLPSMatrix);
+  vtkNew<vtkTransformPolyDataFilter> transformer;
+  transformer->SetInputConnection(smoother->GetOutputPort());
+  transformer->SetTransform(transformIJKtoLPS.GetPointer());
+
+  vtkNew<vtkPolyDataNormals> normals;
+  normals->SetComputePointNormals(parameters.PointNormals);
+  normals->SetInputConnection(transformer->GetOutputPort());
+  normals->SetFeatureAngle(60);
+  normals->SetSplitting(parameters.SplitNormals);
+
+  vtkNew<vtkStripper> stripper;
+  stripper->SetInputConnection(normals->GetOutputPort());
+  try
+    {
+    stripper->Update();
+    }
+  catch(...)
+    {
+    labelModel.Status = -1;
+    labelModel.ErrorMessage = "ERROR updating stripper";
+    return;
+    }
+
+  if (!WriteModel(stripper.GetPointer(), labelModel.FileName, parameters.FileHeader))
+    {
+    labelModel.ErrorMessage = "ERROR: Failed to write model file " + labelModel.FileName;
+    }
+  labelModel.Status = 1;
+}
+
+//----------------------------------------------------------------------------
+void ReportProgress(ModuleProcessInformation* processInformation, double progress, const std::string& comment)
+{
+  if (processInformation)
+    {
+    strncpy(processInformation->ProgressMessage, comment.c_str(), 1023);
+    processInformation->Progress = progress;
+    if (processInformation->ProgressCallbackFunction && processInformation->ProgressCallbackClientData)
+      {
+      (*(processInformation->ProgressCallbackFunction))(processInformation->ProgressCallbackClientData);
+      }
+    }
+  else
+    {
+    std::cout << "<filter-progress>" << progress << "</filter-progress>" << std::endl << std::flush;
+    }
+}
+
+//----------------------------------------------------------------------------
+// Add the model node, its storage and display nodes and its hierarchy node to
+// the output scene
+void AddModelToScene(vtkMRMLScene* modelScene, vtkMRMLNode* rnd, vtkMRMLModelHierarchyNode* topColorHierarchyNode,
+                     vtkMRMLColorTableNode* colorNode, int i, const std::string& labelName,
+                     const std::string& fileName, bool debug)
+{
+  if (debug)
+    {
+    std::cout << "Adding model " << labelName << " to the output scene, with filename " << fileName.c_str()
+              << endl;
+    }
+  // each model needs a mrml node, a storage node and a display node
+  vtkNew<vtkMRMLModelNode> mnode;
+  mnode->SetScene(modelScene);
+  mnode->SetName(labelName.c_str());
+
+  vtkNew<vtkMRMLModelStorageNode> snode;
+  snode->SetFileName(fileName.c_str());
+  if (modelScene->AddNode(snode.GetPointer()) == nullptr)
+    {
+    std::cerr << "ERROR: unable to add the storage node to the model scene" << endl;
+    }
+  vtkNew<vtkMRMLModelDisplayNode> dnode;
+  dnode->SetColor(0.5, 0.5, 0.5);
+  double *rgba;
+  if (colorNode != nullptr)
+    {
+    rgba = colorNode->GetLookupTable()->GetTableValue(i);
+    if (rgba != nullptr)
+      {
+      if (debug)
+        {
+        std::cout << "Got colour: " << rgba[0] << " " << rgba[1] << " " << rgba[2] << " " << rgba[3] << endl;
+        }
+      dnode->SetColor(rgba[0], rgba[1], rgba[2]);
+      }
+    else
+      {
+      std::cerr << "Couldn't get look up table value for " << i << ", display node colour is not set (grey)"
+                << endl;
+      }
+    }
+
+  dnode->SetVisibility(1);
+  modelScene->AddNode(dnode.GetPointer());
+  if (debug)
+    {
+    std::cout << "Added display node: id = " << (dnode->GetID() == nullptr ? "(null)" : dnode->GetID()) << endl;
+    std::cout << "Setting model's storage node: id = "
+              << (snode->GetID() == nullptr ? "(null)" : snode->GetID()) << endl;
+    }
+  mnode->SetAndObserveStorageNodeID(snode->GetID());
+  mnode->SetAndObserveDisplayNodeID(dnode->GetID());
+  modelScene->AddNode(mnode.GetPointer());
+
+  // put it in the hierarchy, either the flat one by default or
+  // try to find the matching color hierarchy node to make this an
+  // associated node
+  std::string colorName;
+  if (colorNode != nullptr)
+    {
+    colorName = std::string(colorNode->GetColorNameAsFileName(i));
+    }
+  else
+    {
+    // might be in a testing case where the hierarchy nodes are
+    // numbered (made from the generic colors)
+    std::stringstream ss;
+    ss << i;
+    colorName = ss.str();
+    if (debug)
+      {
+      std::cout << "No color node, guessing at color name being same as label number " << colorName.c_str() << std::endl;
+      }
+    }
+  vtkMRMLNode *mrmlNode = nullptr;
+  if (colorName.compare("") != 0)
+    {
+    mrmlNode = modelScene->GetFirstNodeByName(colorName.c_str());
+    }
+  // if there's no color hierarchy, or no color name or the mrml node
+  // named for the color isn't a model hierarchy node, use a flat hierarchy
+  if (topColorHierarchyNode == nullptr ||
+      colorName.compare("") == 0 ||
+      mrmlNode == nullptr ||
+      strcmp(mrmlNode->GetClassName(),"vtkMRMLModelHierarchyNode") != 0)
+    {
+    vtkNew<vtkMRMLModelHierarchyNode> mhnd;
+    mhnd->SetHideFromEditors(1);
+    modelScene->AddNode(mhnd.GetPointer());
+    mhnd->SetParentNodeID(rnd->GetID());
+    mhnd->SetModelNodeID(mnode->GetID());
+    }
+  else
+    {
+    // use the template color hierarchy
+    vtkMRMLModelHierarchyNode *colorHierarchyNode = vtkMRMLModelHierarchyNode::SafeDownCast(mrmlNode);
+    if (colorHierarchyNode)
+      {
+      colorHierarchyNode->SetAssociatedNodeID(mnode->GetID());
+      // and hide it so that it doesn't clutter up the tree
+      colorHierarchyNode->SetHideFromEditors(1);
+      if (debug)
+        {
+        std::cout << "Found a color hierarchy node with name " << colorHierarchyNode->GetName() << ", set it's associated node to this model id: " << mnode->GetID() << std::endl;
+        }
+      }
+    }
+  if (debug)
+    {
+    std::cout << "...done adding model to output scene" << endl;
+    }
+}
+
+} // end of anonymous namespace
+
 int main(int argc, char * argv[])
 {
   PARSE_ARGS;
@@ -98,6 +532,7 @@ int main(int argc, char * argv[])
               << (ModelSceneFile.size() > 0 ? ModelSceneFile[0].c_str() : "None") << std::endl;
     std::cout << "Color table file : " << ColorTable.c_str() << std::endl;
     std::cout << "Save intermediate models: " << SaveIntermediateModels << std::endl;
+    std::cout << "Number of threads: " << NumberOfThreads << std::endl;
     std::cout << "Debug: " << debug << std::endl;
     std::cout << "\nStarting..." << std::endl;
     }
@@ -414,6 +849,21 @@ int main(int argc, char * argv[])
     std::cout << "useStartEnd = " << useStartEnd << ", numModelsToGenerate = " << numModelsToGenerate
               << ", numFilterSteps " << numFilterSteps << endl;
     }
+
+  // when making multiple models that are smoothed independently, labels can
+  // be cropped to their bounding box and processed concurrently
+  int numberOfThreads = NumberOfThreads;
+  if (numberOfThreads <= 0)
+    {
+    numberOfThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+  bool processLabelsInParallel = (makeMultiple && !JointSmoothing && numberOfThreads > 1);
+  std::vector<LabelModel> labelModels;
+  if (debug)
+    {
+    std::cout << "Process labels in parallel = " << processLabelsInParallel << ", number of threads = "
+              << numberOfThreads << endl;
+    }
   // check for the input file
   // - strings that start with slicer: are shared memory references, so they won't exist.
   //   The memory address starts with 0x in linux but not on Windows
@@ -708,14 +1158,19 @@ int main(int argc, char * argv[])
         }
       cubes->GenerateValues((labelsMax - labelsMin + 1), labelsMin, labelsMax);
       }
-    try
-      {
-      cubes->Update();
-      }
-    catch(...)
+    // labels that are processed in parallel extract their own surface, the
+    // surfaces of all labels at once are not needed
+    if (!processLabelsInParallel)
       {
-      std::cerr << "ERROR while updating marching cubes filter." << std::endl;
-      return EXIT_FAILURE;
+      try
+        {
+        cubes->Update();
+        }
+      catch(...)
+        {
+        std::cerr << "ERROR while updating marching cubes filter." << std::endl;
+        return EXIT_FAILURE;
+        }
       }
     if (JointSmoothing)
       {
@@ -998,6 +1453,22 @@ int main(int argc, char * argv[])
       */
       }
 
+    if (processLabelsInParallel)
+      {
+      // the surface is made after the loop, once the bounding boxes of all
+      // the labels are known
+      LabelModel labelModel;
+      labelModel.Label = i;
+      labelModel.Name = labelName;
+      if (rootDir == "")
+        {
+        std::cout << "WARNING: output directory is an empty string..." << endl;
+        }
+      labelModel.FileName = GetModelFileName(rootDir, labelName, "");
+      labelModels.push_back(labelModel);
+      continue;
+      }
+
     // threshold
     if (JointSmoothing == 0)
       {
@@ -1171,6 +1642,8 @@ int main(int argc, char * argv[])
           mcubes = nullptr;
           }
         skipLabel = 1;
+        madeModels.erase(std::remove(madeModels.begin(), madeModels.end(), i), madeModels.end());
+        skippedModels.push_back(i);
         std::cout << "...continuing" << endl;
         continue;
         }
@@ -1636,115 +2109,137 @@ int main(int argc, char * argv[])
       writer = nullptr;
       if (modelScene.GetPointer() != nullptr)
         {
-        if (debug)
-          {
-          std::cout << "Adding model " << labelName << " to the output scene, with filename " << fileName.c_str()
-                    << endl;
-          }
-        // each model needs a mrml node, a storage node and a display node
-        vtkNew<vtkMRMLModelNode> mnode;
-        mnode->SetScene(modelScene.GetPointer());
-        mnode->SetName(labelName.c_str());
-
-        vtkNew<vtkMRMLModelStorageNode> snode;
-        snode->SetFileName(fileName.c_str());
-        if (modelScene->AddNode(snode.GetPointer()) == nullptr)
-          {
-          std::cerr << "ERROR: unable to add the storage node to the model scene" << endl;
-          }
-        vtkNew<vtkMRMLModelDisplayNode> dnode;
-        dnode->SetColor(0.5, 0.5, 0.5);
-        double *rgba;
-        if (colorNode != nullptr)
-          {
-          rgba = colorNode->GetLookupTable()->GetTableValue(i);
-          if (rgba != nullptr)
-            {
-            if (debug)
-              {
-              std::cout << "Got colour: " << rgba[0] << " " << rgba[1] << " " << rgba[2] << " " << rgba[3] << endl;
-              }
-            dnode->SetColor(rgba[0], rgba[1], rgba[2]);
-            }
-          else
-            {
-            std::cerr << "Couldn't get look up table value for " << i << ", display node colour is not set (grey)"
-                      << endl;
-            }
-          }
-
-        dnode->SetVisibility(1);
-        modelScene->AddNode(dnode.GetPointer());
-        if (debug)
-          {
-          std::cout << "Added display node: id = " << (dnode->GetID() == nullptr ? "(null)" : dnode->GetID()) << endl;
-          std::cout << "Setting model's storage node: id = "
-                    << (snode->GetID() == nullptr ? "(null)" : snode->GetID()) << endl;
-          }
-        mnode->SetAndObserveStorageNodeID(snode->GetID());
-        mnode->SetAndObserveDisplayNodeID(dnode->GetID());
-        modelScene->AddNode(mnode.GetPointer());
-
-        // put it in the hierarchy, either the flat one by default or
-        // try to find the matching color hierarchy node to make this an
-        // associated node
-        std::string colorName;
-        if (colorNode != nullptr)
-          {
-          colorName = std::string(colorNode->GetColorNameAsFileName(i));
-          }
-        else
-          {
-          // might be in a testing case where the hierarchy nodes are
-          // numbered (made from the generic colors)
-          std::stringstream ss;
-          ss << i;
-          colorName = ss.str();
-          if (debug)
-            {
-            std::cout << "No color node, guessing at color name being same as label number " << colorName.c_str() << std::endl;
-            }
-          }
-        vtkMRMLNode *mrmlNode = nullptr;
-        if (colorName.compare("") != 0)
-          {
-          mrmlNode = modelScene->GetFirstNodeByName(colorName.c_str());
-          }
-        // if there's no color hierarchy, or no color name or the mrml node
-        // named for the color isn't a model hierarchy node, use a flat hierarchy
-        if (topColorHierarchyNode == nullptr ||
-            colorName.compare("") == 0 ||
-            mrmlNode == nullptr ||
-            strcmp(mrmlNode->GetClassName(),"vtkMRMLModelHierarchyNode") != 0)
-          {
-          vtkNew<vtkMRMLModelHierarchyNode> mhnd;
-          mhnd->SetHideFromEditors(1);
-          modelScene->AddNode(mhnd.GetPointer());
-          mhnd->SetParentNodeID(rnd->GetID());
-          mhnd->SetModelNodeID(mnode->GetID());
-          }
-        else
-          {
-          // use the template color hierarchy
-          vtkMRMLModelHierarchyNode *colorHierarchyNode = vtkMRMLModelHierarchyNode::SafeDownCast(mrmlNode);
-          if (colorHierarchyNode)
-            {
-            colorHierarchyNode->SetAssociatedNodeID(mnode->GetID());
-            // and hide it so that it doesn't clutter up the tree
-            colorHierarchyNode->SetHideFromEditors(1);
-            if (debug)
-              {
-              std::cout << "Found a color hierarchy node with name " << colorHierarchyNode->GetName() << ", set it's associated node to this model id: " << mnode->GetID() << std::endl;
-              }
-            }
-          }
-        if (debug)
-          {
-          std::cout << "...done adding model to output scene" << endl;
-          }
+        AddModelToScene(modelScene.GetPointer(), rnd, topColorHierarchyNode, colorNode, i, labelName, fileName, debug);
         }
       } // end of skipping an empty label
     }   // end of loop over labels
+
+  if (processLabelsInParallel && labelModels.size() > 0)
+    {
+    // find the bounding box of all the labels in a single pass over the image
+    int minLabel = labelModels.front().Label;
+    int maxLabel = labelModels.front().Label;
+    for (const LabelModel& labelModel : labelModels)
+      {
+      minLabel = std::min(minLabel, labelModel.Label);
+      maxLabel = std::max(maxLabel, labelModel.Label);
+      }
+    std::vector<int> labelExtents;
+    for (int label = minLabel; label <= maxLabel; label++)
+      {
+      int emptyExtent[6] = { INT_MAX, INT_MIN, INT_MAX, INT_MIN, INT_MAX, INT_MIN };
+      labelExtents.insert(labelExtents.end(), emptyExtent, emptyExtent + 6);
+      }
+    switch (image->GetScalarType())
+      {
+      vtkTemplateMacro(ComputeLabelExtents(image, static_cast<VTK_TT*>(image->GetScalarPointer()),
+        minLabel, maxLabel, labelExtents));
+      default:
+        std::cerr << "ERROR: unsupported scalar type " << image->GetScalarTypeAsString() << std::endl;
+        return EXIT_FAILURE;
+      }
+
+    // crop each label to its bounding box grown by one voxel, so that the
+    // surface is the same as the one extracted from the full image. With
+    // padding, the grown box may extend past the image.
+    int margin = (Pad ? 1 : 0);
+    for (LabelModel& labelModel : labelModels)
+      {
+      const int* labelExtent = &labelExtents[6 * (labelModel.Label - minLabel)];
+      if (labelExtent[0] > labelExtent[1])
+        {
+        // no voxel has exactly this value, leave the extent empty
+        continue;
+        }
+      for (int axis = 0; axis < 3; axis++)
+        {
+        labelModel.Extent[2 * axis] = std::max(labelExtent[2 * axis] - 1, extents[2 * axis] - margin);
+        labelModel.Extent[2 * axis + 1] = std::min(labelExtent[2 * axis + 1] + 1, extents[2 * axis + 1] + margin);
+        }
+      if (debug)
+        {
+        std::cout << "Label " << labelModel.Label << " extent: " << labelModel.Extent[0] << " " << labelModel.Extent[1]
+                  << " " << labelModel.Extent[2] << " " << labelModel.Extent[3] << " " << labelModel.Extent[4] << " "
+                  << labelModel.Extent[5] << endl;
+        }
+      }
+
+    LabelModelParameters parameters;
+    parameters.FilterType = FilterType;
+    if (FilterType == "Sinc" && Smooth == 1)
+      {
+      std::cerr << "Warning: Smoothing iterations of 1 not allowed for Sinc filter, using 2" << endl;
+      Smooth = 2;
+      }
+    parameters.Smooth = Smooth;
+    parameters.Decimate = Decimate;
+    parameters.SplitNormals = SplitNormals;
+    parameters.PointNormals = PointNormals;
+    parameters.SaveIntermediateModels = SaveIntermediateModels;
+    parameters.IJKToLPSMatrix = transformIJKtoLPS->GetMatrix();
+    parameters.ReverseNormals = (parameters.IJKToLPSMatrix->Determinant() < 0);
+    parameters.RootDirectory = rootDir;
+    parameters.FileHeader = modelFileHeader;
+
+    // only as many cropped labels as threads are held in memory at a time,
+    // each model is written as soon as it is done
+    double startProgress = currentFilterOffset / numFilterSteps;
+    std::atomic<size_t> nextLabelModelIndex(0);
+    size_t numberOfProcessedLabels = 0;
+    std::mutex progressMutex;
+    auto processLabels = [&]()
+      {
+      for (size_t labelModelIndex = nextLabelModelIndex++; labelModelIndex < labelModels.size();
+        labelModelIndex = nextLabelModelIndex++)
+        {
+        MakeLabelModel(image, parameters, labelModels[labelModelIndex]);
+        std::lock_guard<std::mutex> lock(progressMutex);
+        numberOfProcessedLabels++;
+        ReportProgress(CLPProcessInformation,
+          startProgress + (1.0 - startProgress) * numberOfProcessedLabels / labelModels.size(),
+          "Make model " + labelModels[labelModelIndex].Name);
+        }
+      };
+    std::vector<std::thread> threads;
+    size_t numberOfWorkerThreads = std::min(static_cast<size_t>(numberOfThreads), labelModels.size()) - 1;
+    for (size_t threadIndex = 0; threadIndex < numberOfWorkerThreads; threadIndex++)
+      {
+      threads.emplace_back(processLabels);
+      }
+    processLabels();
+    for (std::thread& thread : threads)
+      {
+      thread.join();
+      }
+
+    // add the models to the scene in label order, as the serial path does
+    for (const LabelModel& labelModel : labelModels)
+      {
+      if (!labelModel.ErrorMessage.empty())
+        {
+        std::cerr << labelModel.ErrorMessage << " (label " << labelModel.Label << ")" << std::endl;
+        }
+      if (labelModel.Status < 0)
+        {
+        return EXIT_FAILURE;
+        }
+      if (labelModel.Status == 0)
+        {
+        std::cout << "Cannot create a model from label " << labelModel.Label
+                  << "\nNo polygons can be created,\nthere may be no voxels with this label in the volume." << endl;
+        std::cout << "...continuing" << endl;
+        madeModels.erase(std::remove(madeModels.begin(), madeModels.end(), labelModel.Label), madeModels.end());
+        skippedModels.push_back(labelModel.Label);
+        continue;
+        }
+      if (modelScene.GetPointer() != nullptr)
+        {
+        AddModelToScene(modelScene.GetPointer(), rnd, topColorHierarchyNode, colorNode, labelModel.Label,
+                        labelModel.Name, labelModel.FileName, debug);
+        }
+      }
+    }
+
   if (debug)
     {
     std::cout << "End of looping over labels" << endl;
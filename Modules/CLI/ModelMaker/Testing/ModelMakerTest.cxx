@@ -1,5 +1,20 @@
 #include "itkTestMain.h"
 
+// MRML includes
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLScene.h"
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkPolyData.h>
+
+// STD includes
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
 #ifdef WIN32
 #define MODULE_IMPORT __declspec(dllimport)
 #else
@@ -8,7 +23,92 @@
 
 extern "C" MODULE_IMPORT int ModuleEntryPoint(int, char * []);
 
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Get number of points and cells of the models whose name starts with modelNamePrefix,
+// indexed by the rest of the name (label number and color name)
+bool GetModelSizes(const char* sceneFileName, const std::string& modelNamePrefix,
+                   std::map<std::string, std::pair<vtkIdType, vtkIdType> >& modelSizes)
+{
+  vtkNew<vtkMRMLScene> scene;
+  scene->SetURL(sceneFileName);
+  if (!scene->Import())
+    {
+    std::cerr << "Failed to read scene " << sceneFileName << std::endl;
+    return false;
+    }
+  std::vector<vtkMRMLNode*> nodes;
+  scene->GetNodesByClass("vtkMRMLModelNode", nodes);
+  for (vtkMRMLNode* node : nodes)
+    {
+    vtkMRMLModelNode* modelNode = vtkMRMLModelNode::SafeDownCast(node);
+    std::string name = (modelNode->GetName() ? modelNode->GetName() : "");
+    if (name.compare(0, modelNamePrefix.size(), modelNamePrefix) != 0)
+      {
+      continue;
+      }
+    vtkPolyData* polyData = modelNode->GetPolyData();
+    if (!polyData)
+      {
+      std::cerr << "Model " << name << " in scene " << sceneFileName << " has no polygons" << std::endl;
+      return false;
+      }
+    modelSizes[name.substr(modelNamePrefix.size())] =
+      std::make_pair(polyData->GetNumberOfPoints(), polyData->GetNumberOfCells());
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+// Check that two model scenes contain models of the same labels, with the same number of points and cells
+int ModelMakerCompareScenesTest(int argc, char* argv[])
+{
+  if (argc != 5)
+    {
+    std::cerr << "Usage: " << argv[0] << " scene1.mrml modelNamePrefix1 scene2.mrml modelNamePrefix2" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::map<std::string, std::pair<vtkIdType, vtkIdType> > modelSizes1;
+  std::map<std::string, std::pair<vtkIdType, vtkIdType> > modelSizes2;
+  if (!GetModelSizes(argv[1], argv[2], modelSizes1) || !GetModelSizes(argv[3], argv[4], modelSizes2))
+    {
+    return EXIT_FAILURE;
+    }
+  if (modelSizes1.empty())
+    {
+    std::cerr << "No models found in scene " << argv[1] << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (modelSizes1.size() != modelSizes2.size())
+    {
+    std::cerr << "Number of models mismatch: " << modelSizes1.size() << " != " << modelSizes2.size() << std::endl;
+    return EXIT_FAILURE;
+    }
+  for (const auto& modelSize1 : modelSizes1)
+    {
+    auto modelSize2 = modelSizes2.find(modelSize1.first);
+    if (modelSize2 == modelSizes2.end())
+      {
+      std::cerr << "Model " << argv[2] << modelSize1.first << " has no match in scene " << argv[3] << std::endl;
+      return EXIT_FAILURE;
+      }
+    if (modelSize1.second != modelSize2->second)
+      {
+      std::cerr << "Model " << argv[2] << modelSize1.first << " size mismatch:"
+                << " points " << modelSize1.second.first << " != " << modelSize2->second.first << ","
+                << " cells " << modelSize1.second.second << " != " << modelSize2->second.second << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  return EXIT_SUCCESS;
+}
+
 void RegisterTests()
 {
   StringToTestFunctionMap["ModuleEntryPoint"] = ModuleEntryPoint;
+  StringToTestFunctionMap["ModelMakerCompareScenesTest"] = ModelMakerCompareScenesTest;
 }
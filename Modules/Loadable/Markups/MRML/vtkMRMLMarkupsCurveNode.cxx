@@ -30,6 +30,7 @@
 #include <vtkArrayCalculator.h>
 #include <vtkBoundingBox.h>
 #include <vtkCallbackCommand.h>
+#include <vtkCellArray.h>
 #include <vtkCellLocator.h>
 #include <vtkCleanPolyData.h>
 #include <vtkCommand.h>
@@ -38,7 +39,6 @@
 #include <vtkFrenetSerretFrame.h>
 #include <vtkGeneralTransform.h>
 #include <vtkGenericCell.h>
-#include <vtkLine.h>
 #include <vtkMatrix4x4.h>
 #include <vtkNew.h>
 #include <vtkOBBTree.h>
@@ -54,6 +54,7 @@
 #include <vtkTriangleFilter.h>
 
 // STD includes
+#include <algorithm>
 #include <sstream>
 
 //----------------------------------------------------------------------------
@@ -98,6 +99,11 @@ vtkMRMLMarkupsCurveNode::vtkMRMLMarkupsCurveNode()
   this->AddNodeReferenceRole(this->GetShortestDistanceSurfaceNodeReferenceRole(), this->GetShortestDistanceSurfaceNodeReferenceMRMLAttributeName(), events);
 
   this->ActiveScalar = "";
+
+  this->CurvePointsWorldArcLengthMTime = 0;
+  this->CurveSegmentsWorld = vtkSmartPointer<vtkPolyData>::New();
+  this->CurveSegmentsWorldLocator = vtkSmartPointer<vtkCellLocator>::New();
+  this->CurveSegmentsWorldMTime = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -216,8 +222,105 @@ double vtkMRMLMarkupsCurveNode::GetCurveLengthWorld(
   vtkIdType startCurvePointIndex /*=0*/, vtkIdType numberOfCurvePoints /*=-1*/)
 {
   vtkPoints* points = this->GetCurvePointsWorld();
-  return vtkMRMLMarkupsCurveNode::GetCurveLength(points, this->CurveClosed,
-    startCurvePointIndex, numberOfCurvePoints);
+  if (!this->UpdateCurvePointsWorldArcLength(points))
+    {
+    return 0.0;
+    }
+  if (startCurvePointIndex < 0)
+    {
+    vtkWarningMacro("Invalid startCurvePointIndex=" << startCurvePointIndex << ", using 0 instead");
+    startCurvePointIndex = 0;
+    }
+  vtkIdType numberOfPoints = points->GetNumberOfPoints();
+  if (startCurvePointIndex >= numberOfPoints)
+    {
+    return 0.0;
+    }
+  vtkIdType lastCurvePointIndex = numberOfPoints - 1;
+  if (numberOfCurvePoints >= 0 && startCurvePointIndex + numberOfCurvePoints - 1 < lastCurvePointIndex)
+    {
+    lastCurvePointIndex = startCurvePointIndex + numberOfCurvePoints - 1;
+    }
+  double length = 0.0;
+  if (lastCurvePointIndex > startCurvePointIndex)
+    {
+    length = this->CurvePointsWorldArcLength[lastCurvePointIndex] - this->CurvePointsWorldArcLength[startCurvePointIndex];
+    }
+  // Add length of closing segment
+  if (this->CurveClosed && (numberOfCurvePoints < 0 || numberOfCurvePoints >= numberOfPoints))
+    {
+    length += this->CurvePointsWorldArcLength[numberOfPoints] - this->CurvePointsWorldArcLength[numberOfPoints - 1];
+    }
+  return length;
+}
+
+//---------------------------------------------------------------------------
+bool vtkMRMLMarkupsCurveNode::UpdateCurvePointsWorldArcLength(vtkPoints* curvePointsWorld)
+{
+  if (!curvePointsWorld || curvePointsWorld->GetNumberOfPoints() < 2)
+    {
+    this->CurvePointsWorldArcLength.clear();
+    this->CurvePointsWorldArcLengthMTime = 0;
+    return false;
+    }
+  vtkIdType numberOfPoints = curvePointsWorld->GetNumberOfPoints();
+  if (this->CurvePointsWorldArcLengthMTime == curvePointsWorld->GetMTime()
+    && static_cast<vtkIdType>(this->CurvePointsWorldArcLength.size()) == numberOfPoints + 1)
+    {
+    // up-to-date
+    return true;
+    }
+  // The last element is the position of the first point after the closing segment
+  this->CurvePointsWorldArcLength.resize(numberOfPoints + 1);
+  double length = 0.0;
+  double previousPoint[3] = { 0.0 };
+  double nextPoint[3] = { 0.0 };
+  curvePointsWorld->GetPoint(0, previousPoint);
+  this->CurvePointsWorldArcLength[0] = 0.0;
+  for (vtkIdType curvePointIndex = 1; curvePointIndex <= numberOfPoints; curvePointIndex++)
+    {
+    curvePointsWorld->GetPoint(curvePointIndex < numberOfPoints ? curvePointIndex : 0, nextPoint);
+    length += sqrt(vtkMath::Distance2BetweenPoints(previousPoint, nextPoint));
+    this->CurvePointsWorldArcLength[curvePointIndex] = length;
+    previousPoint[0] = nextPoint[0];
+    previousPoint[1] = nextPoint[1];
+    previousPoint[2] = nextPoint[2];
+    }
+  this->CurvePointsWorldArcLengthMTime = curvePointsWorld->GetMTime();
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool vtkMRMLMarkupsCurveNode::UpdateCurveSegmentsWorldLocator(vtkPoints* curvePointsWorld)
+{
+  if (!curvePointsWorld || curvePointsWorld->GetNumberOfPoints() < 2)
+    {
+    this->CurveSegmentsWorldMTime = 0;
+    return false;
+    }
+  vtkIdType numberOfPoints = curvePointsWorld->GetNumberOfPoints();
+  vtkIdType numberOfSegments = (this->CurveClosed ? numberOfPoints : numberOfPoints - 1);
+  if (this->CurveSegmentsWorldMTime == curvePointsWorld->GetMTime()
+    && this->CurveSegmentsWorld->GetPoints() == curvePointsWorld
+    && this->CurveSegmentsWorld->GetNumberOfCells() == numberOfSegments)
+    {
+    // up-to-date
+    return true;
+    }
+  vtkNew<vtkCellArray> segments;
+  segments->Allocate(segments->EstimateSize(numberOfSegments, 2));
+  for (vtkIdType segmentIndex = 0; segmentIndex < numberOfSegments; segmentIndex++)
+    {
+    vtkIdType segmentPointIds[2] = { segmentIndex, (segmentIndex + 1) % numberOfPoints };
+    segments->InsertNextCell(2, segmentPointIds);
+    }
+  this->CurveSegmentsWorld->Initialize();
+  this->CurveSegmentsWorld->SetPoints(curvePointsWorld);
+  this->CurveSegmentsWorld->SetLines(segments);
+  this->CurveSegmentsWorldLocator->SetDataSet(this->CurveSegmentsWorld);
+  this->CurveSegmentsWorldLocator->BuildLocator();
+  this->CurveSegmentsWorldMTime = curvePointsWorld->GetMTime();
+  return true;
 }
 
 //---------------------------------------------------------------------------
@@ -875,11 +978,53 @@ vtkIdType vtkMRMLMarkupsCurveNode::GetFarthestCurvePointIndexToPositionWorld(con
 vtkIdType vtkMRMLMarkupsCurveNode::GetCurvePointIndexAlongCurveWorld(vtkIdType startCurvePointId, double distanceFromStartPoint)
 {
   vtkPoints* points = this->GetCurvePointsWorld();
-  double foundCurvePosition[3] = { 0.0 };
-  vtkIdType foundClosestPointIndex = -1;
-  vtkMRMLMarkupsCurveNode::GetPositionAndClosestPointIndexAlongCurve(foundCurvePosition, foundClosestPointIndex,
-    startCurvePointId, distanceFromStartPoint, points, this->CurveClosed);
-  return foundClosestPointIndex;
+  vtkIdType numberOfPoints = (points != nullptr ? points->GetNumberOfPoints() : 0);
+  if (startCurvePointId < 0 || startCurvePointId >= numberOfPoints)
+    {
+    vtkWarningMacro("vtkMRMLMarkupsCurveNode::GetCurvePointIndexAlongCurveWorld failed: startCurvePointId is out of range");
+    return -1;
+    }
+  if (numberOfPoints == 1 || distanceFromStartPoint == 0.0)
+    {
+    return startCurvePointId;
+    }
+  this->UpdateCurvePointsWorldArcLength(points);
+
+  // Find the position along the curve
+  const std::vector<double>& arcLength = this->CurvePointsWorldArcLength;
+  vtkIdType lastIndex = (this->CurveClosed ? numberOfPoints : numberOfPoints - 1);
+  double curveLength = arcLength[lastIndex];
+  double position = arcLength[startCurvePointId] + distanceFromStartPoint;
+  if (this->CurveClosed)
+    {
+    if (curveLength <= 0.0)
+      {
+      return -1;
+      }
+    position = fmod(position, curveLength);
+    if (position < 0.0)
+      {
+      position += curveLength;
+      }
+    }
+  else if (position <= 0.0)
+    {
+    // reached start of the curve before getting at the requested distance
+    return 0;
+    }
+  else if (position >= curveLength)
+    {
+    // reached end of the curve before getting at the requested distance
+    return numberOfPoints - 1;
+    }
+
+  // Find the line segment that contains the position and return its closest endpoint
+  vtkIdType nextIndex = std::lower_bound(arcLength.begin() + 1, arcLength.begin() + lastIndex + 1, position) - arcLength.begin();
+  nextIndex = std::min(nextIndex, lastIndex);
+  vtkIdType previousIndex = nextIndex - 1;
+  vtkIdType closestIndex = (arcLength[nextIndex] - position <= position - arcLength[previousIndex] ? nextIndex : previousIndex);
+  // index after the closing segment is the first point
+  return closestIndex % numberOfPoints;
 }
 
 //---------------------------------------------------------------------------
@@ -1054,50 +1199,13 @@ vtkIdType vtkMRMLMarkupsCurveNode::GetClosestPointPositionAlongCurveWorld(const
     return -1;
     }
 
-  // Find closest curve point
-  vtkIdType closestCurvePointIndex = this->GetClosestCurvePointIndexToPositionWorld(posWorld);
-  if (closestCurvePointIndex < 0)
-    {
-    return -1;
-    }
-  double closestCurvePoint[3] = { 0.0 };
-  points->GetPoint(closestCurvePointIndex, closestCurvePoint);
-  double closestDistance2 = vtkMath::Distance2BetweenPoints(posWorld, closestPosWorld);
-  closestPosWorld[0] = closestCurvePoint[0];
-  closestPosWorld[1] = closestCurvePoint[1];
-  closestPosWorld[2] = closestCurvePoint[2];
-  vtkIdType lineIndex = closestCurvePointIndex;
-
-  // See if we can find any points closer along the curve
-  double relativePositionAlongLine = -1.0; // between 0.0-1.0 if between the endpoints of the line segment
-  double otherPoint[3] = { 0.0 };
-  double closestPointOnLine[3] = { 0.0 };
-  if (closestCurvePointIndex - 1 >= 0)
-    {
-    points->GetPoint(closestCurvePointIndex - 1, otherPoint);
-    double distance2 = vtkLine::DistanceToLine(posWorld, closestCurvePoint, otherPoint, relativePositionAlongLine, closestPointOnLine);
-    if (distance2 < closestDistance2 && relativePositionAlongLine >= 0 && relativePositionAlongLine <= 1)
-      {
-      closestDistance2 = distance2;
-      closestPosWorld[0] = closestPointOnLine[0];
-      closestPosWorld[1] = closestPointOnLine[1];
-      closestPosWorld[2] = closestPointOnLine[2];
-      lineIndex = closestCurvePointIndex - 1;
-      }
-    }
-  if (closestCurvePointIndex + 1 < points->GetNumberOfPoints())
-    {
-    points->GetPoint(closestCurvePointIndex + 1, otherPoint);
-    double distance2 = vtkLine::DistanceToLine(posWorld, closestCurvePoint, otherPoint, relativePositionAlongLine, closestPointOnLine);
-    if (distance2 < closestDistance2 && relativePositionAlongLine >= 0 && relativePositionAlongLine <= 1)
-      {
-      closestDistance2 = distance2;
-      closestPosWorld[0] = closestPointOnLine[0];
-      closestPosWorld[1] = closestPointOnLine[1];
-      closestPosWorld[2] = closestPointOnLine[2];
-      lineIndex = closestCurvePointIndex;
-      }
-    }
+  // Find closest line segment
+  this->UpdateCurveSegmentsWorldLocator(points);
+  double position[3] = { posWorld[0], posWorld[1], posWorld[2] };
+  vtkIdType lineIndex = -1;
+  int subId = 0;
+  double closestDistance2 = 0.0;
+  this->CurveSegmentsWorldLocator->FindClosestPoint(position, closestPosWorld, lineIndex, subId, closestDistance2);
   return lineIndex;
 }
 
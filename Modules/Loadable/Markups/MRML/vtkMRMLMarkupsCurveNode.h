@@ -34,6 +34,7 @@
 #include <vector>
 
 class vtkArrayCalculator;
+class vtkCellLocator;
 class vtkCleanPolyData;
 class vtkPassThroughFilter;
 class vtkPlane;
@@ -79,6 +80,8 @@ public:
   vtkPoints* GetCurvePointsWorld();
 
   /// Get length of the curve or a section of the curve.
+  /// Lengths are computed from a cached table of cumulative distances along the curve,
+  /// therefore computation time does not depend on the number of curve points.
   /// \param startCurvePointIndex length computation starts from this curve point index
   /// \param numberOfCurvePoints if specified then distances up to the first n points are computed.
   ///   If <0 then all the points are used.
@@ -128,6 +131,7 @@ public:
 
   /// Get position of the closest point along the curve in world coordinates.
   /// The found position may be between two curve points.
+  /// Line segments of the curve are searched using a cached cell locator.
   /// Returns index of the found line segment. -1 if failed.
   /// \param posWorld: input position
   /// \param closestPosWorld: output found closest position
@@ -215,6 +219,17 @@ protected:
   vtkSmartPointer<vtkPassThroughFilter> PassThroughFilter;
   const char* ActiveScalar;
 
+  /// Cumulative distance of each curve point from the first curve point, in world coordinate system.
+  /// For closed curves, the last element is the total length including the closing segment.
+  std::vector<double> CurvePointsWorldArcLength;
+  vtkMTimeType CurvePointsWorldArcLengthMTime;
+
+  /// Line segments between consecutive curve points (cell index = index of the segment start point)
+  /// and locator for finding the closest position on the curve.
+  vtkSmartPointer<vtkPolyData> CurveSegmentsWorld;
+  vtkSmartPointer<vtkCellLocator> CurveSegmentsWorldLocator;
+  vtkMTimeType CurveSegmentsWorldMTime;
+
 protected:
   void ProcessMRMLEvents(vtkObject* caller, unsigned long event, void* callData) override;
   void OnNodeReferenceAdded(vtkMRMLNodeReference* reference) override;
@@ -225,6 +240,14 @@ protected:
   virtual void OnSurfaceModelNodeChanged();
   virtual void OnSurfaceModelTransformChanged();
 
+  /// Update CurvePointsWorldArcLength if the curve points have been modified.
+  /// Returns false if there are less than 2 curve points.
+  bool UpdateCurvePointsWorldArcLength(vtkPoints* curvePointsWorld);
+
+  /// Update CurveSegmentsWorldLocator if the curve points have been modified.
+  /// Returns false if there are less than 2 curve points.
+  bool UpdateCurveSegmentsWorldLocator(vtkPoints* curvePointsWorld);
+
   vtkMRMLMarkupsCurveNode();
   ~vtkMRMLMarkupsCurveNode() override;
   vtkMRMLMarkupsCurveNode(const vtkMRMLMarkupsCurveNode&);
@@ -0,0 +1,143 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLMarkupsClosedCurveNode.h"
+#include "vtkMRMLMarkupsCurveNode.h"
+
+// VTK includes
+#include <vtkLine.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+
+// STL includes
+#include <algorithm>
+#include <cmath>
+
+// Test cached curve length and closest point queries against direct computation
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+void addHelixControlPoints(vtkMRMLMarkupsCurveNode* curveNode, int numberOfControlPoints)
+{
+  for (int i = 0; i < numberOfControlPoints; i++)
+    {
+    double angle = i * 0.5;
+    curveNode->AddControlPoint(vtkVector3d(20.0 * cos(angle), 20.0 * sin(angle), i * 2.0));
+    }
+}
+
+//----------------------------------------------------------------------------
+double getClosestDistanceToSegments(vtkPoints* points, bool closedCurve, const double position[3])
+{
+  vtkIdType numberOfPoints = points->GetNumberOfPoints();
+  vtkIdType numberOfSegments = (closedCurve ? numberOfPoints : numberOfPoints - 1);
+  double closestDistance2 = VTK_DOUBLE_MAX;
+  for (vtkIdType segmentIndex = 0; segmentIndex < numberOfSegments; segmentIndex++)
+    {
+    double t = 0.0;
+    double closestPoint[3] = { 0.0 };
+    double distance2 = vtkLine::DistanceToLine(position, points->GetPoint(segmentIndex),
+      points->GetPoint((segmentIndex + 1) % numberOfPoints), t, closestPoint);
+    closestDistance2 = std::min(closestDistance2, distance2);
+    }
+  return sqrt(closestDistance2);
+}
+
+//----------------------------------------------------------------------------
+int checkCurveQueries(vtkMRMLMarkupsCurveNode* curveNode)
+{
+  const double tol = 1e-6;
+  vtkPoints* points = curveNode->GetCurvePointsWorld();
+  CHECK_NOT_NULL(points);
+  vtkIdType numberOfPoints = points->GetNumberOfPoints();
+  CHECK_BOOL(numberOfPoints > 500, true);
+  bool closedCurve = curveNode->GetCurveClosed();
+
+  // Curve length
+  CHECK_DOUBLE_TOLERANCE(curveNode->GetCurveLengthWorld(),
+    vtkMRMLMarkupsCurveNode::GetCurveLength(points, closedCurve), tol);
+  CHECK_DOUBLE_TOLERANCE(curveNode->GetCurveLengthWorld(17, 200),
+    vtkMRMLMarkupsCurveNode::GetCurveLength(points, closedCurve, 17, 200), tol);
+  CHECK_DOUBLE_TOLERANCE(curveNode->GetCurveLengthWorld(numberOfPoints - 10),
+    vtkMRMLMarkupsCurveNode::GetCurveLength(points, closedCurve, numberOfPoints - 10), tol);
+  CHECK_DOUBLE_TOLERANCE(curveNode->GetCurveLengthWorld(5, 1), 0.0, tol);
+  CHECK_DOUBLE_TOLERANCE(curveNode->GetCurveLengthBetweenStartEndPointsWorld(numberOfPoints - 50, 30),
+    vtkMRMLMarkupsCurveNode::GetCurveLength(points, closedCurve, 0, 31)
+    + vtkMRMLMarkupsCurveNode::GetCurveLength(points, closedCurve, numberOfPoints - 50), tol);
+
+  // Point along the curve
+  for (double distance = 0.5; distance < 300.0; distance += 37.3)
+    {
+    double foundPosition[3] = { 0.0 };
+    vtkIdType expectedPointIndex = -1;
+    vtkMRMLMarkupsCurveNode::GetPositionAndClosestPointIndexAlongCurve(foundPosition, expectedPointIndex,
+      10, distance, points, closedCurve);
+    CHECK_INT(curveNode->GetCurvePointIndexAlongCurveWorld(10, distance), expectedPointIndex);
+    }
+  CHECK_INT(curveNode->GetCurvePointIndexAlongCurveWorld(10, 0.0), 10);
+
+  // Closest point on the curve
+  for (int i = 0; i < 50; i++)
+    {
+    double position[3] = { 30.0 * cos(i * 0.7), 25.0 * sin(i * 1.3), i * 2.0 - 10.0 };
+    double closestPosition[3] = { 0.0 };
+    vtkIdType lineIndex = curveNode->GetClosestPointPositionAlongCurveWorld(position, closestPosition);
+    CHECK_BOOL(lineIndex >= 0 && lineIndex < numberOfPoints, true);
+    double t = 0.0;
+    double closestPointOnLine[3] = { 0.0 };
+    double distanceToFoundLine = sqrt(vtkLine::DistanceToLine(position, points->GetPoint(lineIndex),
+      points->GetPoint((lineIndex + 1) % numberOfPoints), t, closestPointOnLine));
+    double expectedDistance = getClosestDistanceToSegments(points, closedCurve, position);
+    CHECK_DOUBLE_TOLERANCE(sqrt(vtkMath::Distance2BetweenPoints(position, closestPosition)), expectedDistance, tol);
+    CHECK_DOUBLE_TOLERANCE(distanceToFoundLine, expectedDistance, tol);
+    }
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkMRMLMarkupsCurveNodeTest1(int , char * [] )
+{
+  vtkNew<vtkMRMLMarkupsCurveNode> curveNode;
+  curveNode->SetNumberOfPointsPerInterpolatingSegment(20);
+  addHelixControlPoints(curveNode, 40);
+  CHECK_EXIT_SUCCESS(checkCurveQueries(curveNode));
+
+  // Cached values are updated when the curve changes
+  double originalLength = curveNode->GetCurveLengthWorld();
+  curveNode->SetNthControlPointPosition(39, 0.0, 0.0, 300.0);
+  CHECK_BOOL(curveNode->GetCurveLengthWorld() > originalLength + 100.0, true);
+  CHECK_EXIT_SUCCESS(checkCurveQueries(curveNode));
+  double position[3] = { 0.0, 0.0, 310.0 };
+  double closestPosition[3] = { 0.0 };
+  curveNode->GetClosestPointPositionAlongCurveWorld(position, closestPosition);
+  CHECK_BOOL(sqrt(vtkMath::Distance2BetweenPoints(position, closestPosition)) <= 10.0 + 1e-6, true);
+
+  vtkNew<vtkMRMLMarkupsClosedCurveNode> closedCurveNode;
+  closedCurveNode->SetNumberOfPointsPerInterpolatingSegment(20);
+  addHelixControlPoints(closedCurveNode, 40);
+  CHECK_EXIT_SUCCESS(checkCurveQueries(closedCurveNode));
+
+  return EXIT_SUCCESS;
+}
@@ -40,6 +40,7 @@
 #include <vtkTransform.h>
 
 // MRML includes
+#include "vtkEventBroker.h"
 #include "vtkMRMLTransformNode.h"
 
 //----------------------------------------------------------------------
@@ -223,6 +224,8 @@ bool vtkSlicerMarkupsWidget::ProcessMouseMove(vtkMRMLInteractionEventData* event
     // selected), the widget points are modified.
     // First construct a local coordinate system based on the display coordinates
     // of the widget.
+    // The markups node events are delivered to observers once per mouse move.
+    MRMLEventBatchBlocker eventBatch;
     double eventPos[2]
     {
       static_cast<double>(eventData->GetDisplayPosition()[0]),
@@ -340,6 +340,10 @@ void qSlicerSegmentEditorPaintEffectPrivate::paintApply(qMRMLWidget* viewWidget)
 {
   Q_Q(qSlicerSegmentEditorPaintEffect);
 
+  // Deliver the segmentation modified events once per stroke instead of
+  // once per modification
+  MRMLEventBatchBlocker eventBatch;
+
   vtkOrientedImageData* modifierLabelmap = q->defaultModifierLabelmap();
   if (!modifierLabelmap)
     {
@@ -1,5 +1,7 @@
 #include "vtkImageGrowCutSegment.h"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <vector>
 
@@ -26,6 +28,10 @@ const int MaskPixelTypeID = VTK_UNSIGNED_CHAR;
 const NodeKeyValueType DIST_INF = std::numeric_limits<NodeKeyValueType>::max();
 const NodeKeyValueType DIST_EPSILON = 1e-3;
 
+// Number of buckets in the bucket queue. The bucket width is chosen so that the distance
+// difference between any two queued voxels spans less than this many buckets.
+const int BUCKET_QUEUE_SIZE = 4096;
+
 //----------------------------------------------------------------------------
 class vtkImageGrowCutSegment::vtkInternal
 {
@@ -41,12 +47,19 @@ public:
   template<typename IntensityPixelType, typename LabelPixelType>
   void DijkstraBasedClassificationAHP(vtkImageData *intensityVolume, vtkImageData *seedLabelVolume, vtkImageData *maskLabelVolume);
 
+  template<typename IntensityPixelType, typename LabelPixelType>
+  void BucketQueueClassification(vtkImageData *intensityVolume);
+
+  // Add voxel to the priority queue (heap or list of initial voxels of the bucket queue)
+  void QueueVoxel(NodeIndexType index, NodeKeyValueType distance);
+
   template <class SourceVolType>
   bool ExecuteGrowCut(vtkImageData *intensityVolume, vtkImageData *seedLabelVolume, vtkImageData *maskLabelVolume,
-    vtkImageData *resultLabelVolume, double distancePenalty);
+    vtkImageData *resultLabelVolume, double distancePenalty, bool useBucketQueue);
 
   template< class SourceVolType, class SeedVolType>
-  bool ExecuteGrowCut2(vtkImageData *intensityVolume, vtkImageData *seedLabelVolume, vtkImageData *maskLabelVolume, double distancePenalty);
+  bool ExecuteGrowCut2(vtkImageData *intensityVolume, vtkImageData *seedLabelVolume, vtkImageData *maskLabelVolume,
+    double distancePenalty, bool useBucketQueue);
 
   // Stores the shortest distance from known labels to each point
   // If a point is set to DIST_INF then that point will modified, as a shorter distance path will be found.
@@ -68,6 +81,11 @@ public:
 
   FibHeap *m_Heap;
   FibHeapNode *m_HeapNodes; // a node is stored for each voxel
+
+  // Voxels that labels are propagated from (used if heap is not allocated)
+  std::vector<NodeIndexType> m_SeedIndices;
+  bool m_UseBucketQueue;
+
   bool m_bSegInitialized;
 };
 
@@ -77,6 +95,7 @@ vtkImageGrowCutSegment::vtkInternal::vtkInternal()
   m_DistancePenalty = 0.0;
   m_Heap = nullptr;
   m_HeapNodes = nullptr;
+  m_UseBucketQueue = true;
   m_bSegInitialized = false;
   m_DistanceVolume = vtkSmartPointer<vtkImageData>::New();
   m_ResultLabelVolume = vtkSmartPointer<vtkImageData>::New();
@@ -101,11 +120,28 @@ void vtkImageGrowCutSegment::vtkInternal::Reset()
     delete[]m_HeapNodes;
     m_HeapNodes = nullptr;
     }
+  std::vector<NodeIndexType>().swap(m_SeedIndices);
   m_bSegInitialized = false;
   m_DistanceVolume->Initialize();
   m_ResultLabelVolume->Initialize();
 }
 
+//-----------------------------------------------------------------------------
+void vtkImageGrowCutSegment::vtkInternal::QueueVoxel(NodeIndexType index, NodeKeyValueType distance)
+{
+  if (m_Heap)
+    {
+    m_HeapNodes[index] = distance;
+    m_HeapNodes[index].SetIndexValue(index);
+    m_Heap->Insert(&m_HeapNodes[index]);
+    }
+  else if (distance != DIST_INF)
+    {
+    // the bucket queue only stores voxels that have a known distance
+    m_SeedIndices.push_back(index);
+    }
+}
+
 //-----------------------------------------------------------------------------
 template<typename IntensityPixelType, typename LabelPixelType>
 bool vtkImageGrowCutSegment::vtkInternal::InitializationAHP(
@@ -125,16 +161,19 @@ bool vtkImageGrowCutSegment::vtkInternal::InitializationAHP(
     delete[] m_HeapNodes;
     m_HeapNodes = nullptr;
     }
+  m_SeedIndices.clear();
 
   NodeIndexType dimXYZ = m_DimX * m_DimY * m_DimZ;
-  if ((m_HeapNodes = new FibHeapNode[dimXYZ+1]) == nullptr)  // size is +1 for storing the zeroValueElement
+  if (!m_UseBucketQueue)
     {
-    vtkGenericWarningMacro("Memory allocation failed. Dimensions: " << m_DimX << "x" << m_DimY << "x" << m_DimZ);
-    return false;
+    if ((m_HeapNodes = new FibHeapNode[dimXYZ+1]) == nullptr)  // size is +1 for storing the zeroValueElement
+      {
+      vtkGenericWarningMacro("Memory allocation failed. Dimensions: " << m_DimX << "x" << m_DimY << "x" << m_DimZ);
+      return false;
+      }
+    m_Heap = new FibHeap;
+    m_Heap->SetHeapNodes(m_HeapNodes);
     }
-
-  m_Heap = new FibHeap;
-  m_Heap->SetHeapNodes(m_HeapNodes);
   LabelPixelType* seedLabelVolumePtr = nullptr;
   if (seedLabelVolume)
     {
@@ -216,18 +255,8 @@ bool vtkImageGrowCutSegment::vtkInternal::InitializationAHP(
         {
         LabelPixelType seedValue = seedLabelVolumePtr[index];
         resultLabelVolumePtr[index] = seedValue;
-        if (seedValue == 0)
-          {
-          m_HeapNodes[index] = DIST_INF;
-          distanceVolumePtr[index] = DIST_INF;
-          }
-        else
-          {
-          m_HeapNodes[index] = DIST_EPSILON;
-          distanceVolumePtr[index] = DIST_EPSILON;
-          }
-        m_HeapNodes[index].SetIndexValue(index);
-        m_Heap->Insert(&m_HeapNodes[index]);
+        distanceVolumePtr[index] = (seedValue == 0 ? DIST_INF : DIST_EPSILON);
+        this->QueueVoxel(index, distanceVolumePtr[index]);
         }
       }
     else
@@ -240,7 +269,6 @@ bool vtkImageGrowCutSegment::vtkInternal::InitializationAHP(
           // masked region
           resultLabelVolumePtr[index] = 0;
           // small distance will prevent overwriting of masked voxels
-          m_HeapNodes[index] = DIST_EPSILON;
           distanceVolumePtr[index] = DIST_EPSILON;
           // we don't add masked voxels to the heap
           // to exclude them from region growing
@@ -250,18 +278,8 @@ bool vtkImageGrowCutSegment::vtkInternal::InitializationAHP(
           // non-masked region
           LabelPixelType seedValue = seedLabelVolumePtr[index];
           resultLabelVolumePtr[index] = seedValue;
-          if (seedValue == 0)
-            {
-            m_HeapNodes[index] = DIST_INF;
-            distanceVolumePtr[index] = DIST_INF;
-            }
-          else
-            {
-            m_HeapNodes[index] = DIST_EPSILON;
-            distanceVolumePtr[index] = DIST_EPSILON;
-            }
-          m_HeapNodes[index].SetIndexValue(index);
-          m_Heap->Insert(&m_HeapNodes[index]);
+          distanceVolumePtr[index] = (seedValue == 0 ? DIST_INF : DIST_EPSILON);
+          this->QueueVoxel(index, distanceVolumePtr[index]);
           }
         }
       }
@@ -280,30 +298,29 @@ bool vtkImageGrowCutSegment::vtkInternal::InitializationAHP(
           || distanceVolumePtr[index] > DIST_EPSILON // new seed
           )
           {
-          m_HeapNodes[index] = DIST_EPSILON;
           distanceVolumePtr[index] = DIST_EPSILON;
           resultLabelVolumePtr[index] = seedLabelVolumePtr[index];
-          m_HeapNodes[index].SetIndexValue(index);
-          m_Heap->Insert(&m_HeapNodes[index]);
+          this->QueueVoxel(index, DIST_EPSILON);
           }
         // Old seeds will be completely ignored in updates, as their labels have been already propagated
         // and their value cannot changed (because their value is prescribed).
         }
       else
         {
-        m_HeapNodes[index] = DIST_INF;
-        m_HeapNodes[index].SetIndexValue(index);
-        m_Heap->Insert(&m_HeapNodes[index]);
+        this->QueueVoxel(index, DIST_INF);
         }
       }
     }
 
-  // Insert 0 then extract it, which will balance heap
-  NodeIndexType zeroValueElementIndex = dimXYZ;
-  m_HeapNodes[zeroValueElementIndex] = 0;
-  m_HeapNodes[zeroValueElementIndex].SetIndexValue(zeroValueElementIndex);
-  m_Heap->Insert(&m_HeapNodes[zeroValueElementIndex]);
-  m_Heap->ExtractMin();
+  if (m_Heap)
+    {
+    // Insert 0 then extract it, which will balance heap
+    NodeIndexType zeroValueElementIndex = dimXYZ;
+    m_HeapNodes[zeroValueElementIndex] = 0;
+    m_HeapNodes[zeroValueElementIndex].SetIndexValue(zeroValueElementIndex);
+    m_Heap->Insert(&m_HeapNodes[zeroValueElementIndex]);
+    m_Heap->ExtractMin();
+    }
 
   return true;
 }
@@ -315,6 +332,11 @@ void vtkImageGrowCutSegment::vtkInternal::DijkstraBasedClassificationAHP(
     vtkImageData *vtkNotUsed(seedLabelVolume),
     vtkImageData *vtkNotUsed(maskLabelVolume))
 {
+  if (m_UseBucketQueue)
+    {
+    this->BucketQueueClassification<IntensityPixelType, LabelPixelType>(intensityVolume);
+    return;
+    }
   if (m_Heap == nullptr || m_HeapNodes == nullptr)
     {
     return;
@@ -402,10 +424,84 @@ void vtkImageGrowCutSegment::vtkInternal::DijkstraBasedClassificationAHP(
   m_HeapNodes = nullptr;
 }
 
+//-----------------------------------------------------------------------------
+template<typename IntensityPixelType, typename LabelPixelType>
+void vtkImageGrowCutSegment::vtkInternal::BucketQueueClassification(vtkImageData *intensityVolume)
+{
+  LabelPixelType* resultLabelVolumePtr = static_cast<LabelPixelType*>(m_ResultLabelVolume->GetScalarPointer());
+  IntensityPixelType* imSrc = static_cast<IntensityPixelType*>(intensityVolume->GetScalarPointer());
+  NodeKeyValueType* distanceVolumePtr = static_cast<NodeKeyValueType*>(m_DistanceVolume->GetScalarPointer());
+
+  // Voxels are sorted into buckets of equal distance range (Dial's algorithm with wide buckets).
+  // Distance of a neighbor can increase by at most the largest intensity difference plus the
+  // largest distance penalty, therefore all the queued voxels fit into a circular list of buckets.
+  double* intensityRange = intensityVolume->GetScalarRange();
+  double maximumDistanceIncrease = intensityRange[1] - intensityRange[0];
+  if (!m_NeighborDistancePenalties.empty())
+    {
+    maximumDistanceIncrease += *std::max_element(m_NeighborDistancePenalties.begin(), m_NeighborDistancePenalties.end());
+    }
+  // (a few buckets are left as margin for rounding errors)
+  double bucketWidth = maximumDistanceIncrease / (BUCKET_QUEUE_SIZE - 4);
+  if (bucketWidth <= 0.0)
+    {
+    bucketWidth = 1.0;
+    }
+  std::vector< std::vector<NodeIndexType> > buckets(BUCKET_QUEUE_SIZE);
+
+  vtkIdType currentBucket = static_cast<vtkIdType>(DIST_EPSILON / bucketWidth);
+  vtkIdType numberOfQueuedVoxels = static_cast<vtkIdType>(m_SeedIndices.size());
+  buckets[currentBucket % BUCKET_QUEUE_SIZE].swap(m_SeedIndices);
+  std::vector<NodeIndexType> currentVoxels;
+  for (; numberOfQueuedVoxels > 0; ++currentBucket)
+    {
+    std::vector<NodeIndexType>& bucket = buckets[currentBucket % BUCKET_QUEUE_SIZE];
+    // Voxels that get shorter distance but remain in the current bucket are added to the bucket again,
+    // so the bucket is processed until it becomes empty.
+    while (!bucket.empty())
+      {
+      currentVoxels.swap(bucket);
+      numberOfQueuedVoxels -= static_cast<vtkIdType>(currentVoxels.size());
+      for (NodeIndexType index : currentVoxels)
+        {
+        NodeKeyValueType currentDistance = distanceVolumePtr[index];
+        if (static_cast<vtkIdType>(currentDistance / bucketWidth) != currentBucket)
+          {
+          // distance of this voxel has been reduced since it was queued,
+          // it has been already processed in a previous bucket
+          continue;
+          }
+        LabelPixelType currentLabel = resultLabelVolumePtr[index];
+
+        // Update neighbors
+        NodeKeyValueType pixCenter = imSrc[index];
+        unsigned char nbSize = m_NumberOfNeighbors[index];
+        for (unsigned char i = 0; i < nbSize; i++)
+          {
+          NodeIndexType indexNgbh = index + m_NeighborIndexOffsets[i];
+          NodeKeyValueType neighborNewDistance = fabs(pixCenter - imSrc[indexNgbh]) + currentDistance + m_NeighborDistancePenalties[i];
+          if (distanceVolumePtr[indexNgbh] > neighborNewDistance)
+            {
+            distanceVolumePtr[indexNgbh] = neighborNewDistance;
+            resultLabelVolumePtr[indexNgbh] = currentLabel;
+            vtkIdType neighborBucket = static_cast<vtkIdType>(neighborNewDistance / bucketWidth);
+            buckets[neighborBucket % BUCKET_QUEUE_SIZE].push_back(indexNgbh);
+            numberOfQueuedVoxels++;
+            }
+          }
+        }
+      currentVoxels.clear();
+      }
+    }
+
+  m_bSegInitialized = true;
+  std::vector<NodeIndexType>().swap(m_SeedIndices);
+}
+
 //-----------------------------------------------------------------------------
 template< class IntensityPixelType, class LabelPixelType>
 bool vtkImageGrowCutSegment::vtkInternal::ExecuteGrowCut2(vtkImageData *intensityVolume, vtkImageData *seedLabelVolume,
-  vtkImageData *maskLabelVolume, double distancePenalty)
+  vtkImageData *maskLabelVolume, double distancePenalty, bool useBucketQueue)
 {
   int* imSize = intensityVolume->GetDimensions();
 
@@ -432,6 +528,18 @@ bool vtkImageGrowCutSegment::vtkInternal::ExecuteGrowCut2(vtkImageData *intensit
     return false;
     }
 
+  m_UseBucketQueue = useBucketQueue;
+  if (m_UseBucketQueue)
+    {
+    // The bucket width is computed from the intensity range. If the range is not finite
+    // then all voxels would fall into the same bucket and labels would be propagated
+    // by repeatedly revisiting voxels, which is much slower than using the heap.
+    double* intensityRange = intensityVolume->GetScalarRange();
+    if (!(intensityRange[1] - intensityRange[0] < DIST_INF))
+      {
+      m_UseBucketQueue = false;
+      }
+    }
   if (!InitializationAHP<IntensityPixelType, LabelPixelType>(intensityVolume, seedLabelVolume, maskLabelVolume, distancePenalty))
     {
     return false;
@@ -444,7 +552,7 @@ bool vtkImageGrowCutSegment::vtkInternal::ExecuteGrowCut2(vtkImageData *intensit
 //----------------------------------------------------------------------------
 template <class SourceVolType>
 bool vtkImageGrowCutSegment::vtkInternal::ExecuteGrowCut(vtkImageData *intensityVolume, vtkImageData *seedLabelVolume,
-  vtkImageData *maskLabelVolume, vtkImageData *resultLabelVolume, double distancePenalty)
+  vtkImageData *maskLabelVolume, vtkImageData *resultLabelVolume, double distancePenalty, bool useBucketQueue)
 {
   int* extent = intensityVolume->GetExtent();
   double* spacing = intensityVolume->GetSpacing();
@@ -520,7 +628,7 @@ bool vtkImageGrowCutSegment::vtkInternal::ExecuteGrowCut(vtkImageData *intensity
   bool success = false;
   switch (seedLabelVolume->GetScalarType())
   {
-    vtkTemplateMacro((success = ExecuteGrowCut2<SourceVolType, VTK_TT>(intensityVolume, seedLabelVolume, maskLabelVolume, distancePenalty)));
+    vtkTemplateMacro((success = ExecuteGrowCut2<SourceVolType, VTK_TT>(intensityVolume, seedLabelVolume, maskLabelVolume, distancePenalty, useBucketQueue)));
   default:
     vtkGenericWarningMacro("vtkOrientedImageDataResample::MergeImage: Unknown ScalarType");
   }
@@ -543,6 +651,7 @@ vtkImageGrowCutSegment::vtkImageGrowCutSegment()
   this->SetNumberOfInputPorts(3);
   this->SetNumberOfOutputPorts(1);
   this->DistancePenalty = 0.0;
+  this->UseBucketQueue = true;
 }
 
 //-----------------------------------------------------------------------------
@@ -576,7 +685,7 @@ void vtkImageGrowCutSegment::ExecuteDataWithInformation(
 
   switch (intensityVolume->GetScalarType())
     {
-    vtkTemplateMacro(this->Internal->ExecuteGrowCut<VTK_TT>(intensityVolume, seedLabelVolume, maskLabelVolume, resultLabelVolume, this->DistancePenalty));
+    vtkTemplateMacro(this->Internal->ExecuteGrowCut<VTK_TT>(intensityVolume, seedLabelVolume, maskLabelVolume, resultLabelVolume, this->DistancePenalty, this->UseBucketQueue));
     break;
     }
   logger->StopTimer();
@@ -607,6 +716,7 @@ void vtkImageGrowCutSegment::Reset()
 //-----------------------------------------------------------------------------
 void vtkImageGrowCutSegment::PrintSelf(ostream &os, vtkIndent indent)
 {
-  // XXX Implement this function
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "DistancePenalty: " << this->DistancePenalty << std::endl;
+  os << indent << "UseBucketQueue: " << (this->UseBucketQueue ? "true" : "false") << std::endl;
 }
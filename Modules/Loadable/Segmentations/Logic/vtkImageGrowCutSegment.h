@@ -36,6 +36,16 @@ public:
   vtkGetMacro(DistancePenalty, double);
   vtkSetMacro(DistancePenalty, double);
 
+  /// Use a bucket queue for propagating labels instead of a Fibonacci heap.
+  /// The bucket queue does not need to allocate a heap node for each voxel,
+  /// therefore it needs a fraction of the memory and it is faster.
+  /// Results are the same, except choice between labels that reach a voxel
+  /// at exactly the same distance. Enabled by default.
+  /// The heap is used if the intensity range is not finite.
+  vtkGetMacro(UseBucketQueue, bool);
+  vtkSetMacro(UseBucketQueue, bool);
+  vtkBooleanMacro(UseBucketQueue, bool);
+
 protected:
   vtkImageGrowCutSegment();
   ~vtkImageGrowCutSegment() override;
@@ -52,6 +62,7 @@ private:
   class vtkInternal;
   vtkInternal * Internal;
   double DistancePenalty;
+  bool UseBucketQueue;
 };
 
 #endif
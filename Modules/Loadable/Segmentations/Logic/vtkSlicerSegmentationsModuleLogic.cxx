@@ -23,6 +23,7 @@
 
 // SegmentationCore includes
 #include "vtkBinaryLabelmapToClosedSurfaceConversionRule.h"
+#include "vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule.h"
 #include "vtkClosedSurfaceToBinaryLabelmapConversionRule.h"
 #include "vtkClosedSurfaceToFractionalLabelmapConversionRule.h"
 #include "vtkFractionalLabelmapToClosedSurfaceConversionRule.h"
@@ -30,6 +31,7 @@
 #include "vtkOrientedImageDataResample.h"
 #include "vtkSegmentationConverterFactory.h"
 #include <vtkSegmentationModifier.h>
+#include "vtkSparseBinaryLabelmapToBinaryLabelmapConversionRule.h"
 
 // Terminologies includes
 #include "vtkSlicerTerminologiesModuleLogic.h"
@@ -111,6 +113,7 @@ vtkSlicerSegmentationsModuleLogic::~vtkSlicerSegmentationsModuleLogic()
 void vtkSlicerSegmentationsModuleLogic::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfConversionThreads: " << this->NumberOfConversionThreads << "\n";
 }
 
 //---------------------------------------------------------------------------
@@ -152,6 +155,10 @@ void vtkSlicerSegmentationsModuleLogic::RegisterNodes()
     vtkSmartPointer<vtkClosedSurfaceToFractionalLabelmapConversionRule>::New() );
   vtkSegmentationConverterFactory::GetInstance()->RegisterConverterRule(
     vtkSmartPointer<vtkFractionalLabelmapToClosedSurfaceConversionRule>::New() );
+  vtkSegmentationConverterFactory::GetInstance()->RegisterConverterRule(
+    vtkSmartPointer<vtkBinaryLabelmapToSparseBinaryLabelmapConversionRule>::New() );
+  vtkSegmentationConverterFactory::GetInstance()->RegisterConverterRule(
+    vtkSmartPointer<vtkSparseBinaryLabelmapToBinaryLabelmapConversionRule>::New() );
 }
 
 //---------------------------------------------------------------------------
@@ -168,6 +175,13 @@ void vtkSlicerSegmentationsModuleLogic::OnMRMLSceneNodeAdded(vtkMRMLNode* node)
     vtkEventBroker::GetInstance()->AddObservation(
       node, vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemUIDAddedEvent, this, this->SubjectHierarchyUIDCallbackCommand );
     }
+
+  // Convert segments of the new segmentation in parallel
+  vtkMRMLSegmentationNode* segmentationNode = vtkMRMLSegmentationNode::SafeDownCast(node);
+  if (segmentationNode && segmentationNode->GetSegmentation())
+    {
+    segmentationNode->GetSegmentation()->SetNumberOfConversionThreads(this->NumberOfConversionThreads);
+    }
 }
 
 //---------------------------------------------------------------------------
@@ -244,7 +258,7 @@ vtkMRMLSegmentationNode* vtkSlicerSegmentationsModuleLogic::GetSegmentationNodeF
 }
 
 //-----------------------------------------------------------------------------
-vtkMRMLSegmentationNode* vtkSlicerSegmentationsModuleLogic::LoadSegmentationFromFile(const char* fileName, bool autoOpacities/*=true*/)
+vtkMRMLSegmentationNode* vtkSlicerSegmentationsModuleLogic::LoadSegmentationFromFile(const char* fileName, bool autoOpacities/*=true*/, bool readHeaderOnly/*=false*/)
 {
   if (this->GetMRMLScene() == nullptr || fileName == nullptr)
     {
@@ -253,6 +267,7 @@ vtkMRMLSegmentationNode* vtkSlicerSegmentationsModuleLogic::LoadSegmentationFrom
   vtkSmartPointer<vtkMRMLSegmentationNode> segmentationNode = vtkSmartPointer<vtkMRMLSegmentationNode>::New();
   vtkSmartPointer<vtkMRMLSegmentationStorageNode> storageNode = vtkSmartPointer<vtkMRMLSegmentationStorageNode>::New();
   storageNode->SetFileName(fileName);
+  storageNode->SetReadHeaderOnly(readHeaderOnly);
 
   // Check to see which node can read this type of file
   if (!storageNode->SupportedFileType(fileName))
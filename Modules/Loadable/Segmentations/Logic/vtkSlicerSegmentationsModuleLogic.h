@@ -73,8 +73,10 @@ public:
   /// Load segmentation from file
   /// \param filename Path and name of file containing segmentation (nrrd, vtm, etc.)
   /// \param autoOpacities Optional flag determining whether segment opacities are calculated automatically based on containment. True by default
+  /// \param readHeaderOnly Optional flag determining whether voxels of segments are read later,
+  ///   see vtkMRMLSegmentationStorageNode::ReadHeaderOnly. False by default
   /// \return Loaded segmentation node
-  vtkMRMLSegmentationNode* LoadSegmentationFromFile(const char* filename, bool autoOpacities = true);
+  vtkMRMLSegmentationNode* LoadSegmentationFromFile(const char* filename, bool autoOpacities = true, bool readHeaderOnly = false);
 
   /// Create labelmap volume MRML node from oriented image data.
   /// Creates a display node if a display node does not exist. Shifts image extent to start from zero.
@@ -338,6 +340,12 @@ public:
   bool GetDefaultSurfaceSmoothingEnabled();
   void SetDefaultSurfaceSmoothingEnabled(bool enabled);
 
+  /// Number of threads used for converting segments of segmentation nodes that are added to the scene.
+  /// 0 (default) means the number of processor cores, 1 disables parallel conversion.
+  /// \sa vtkSegmentation::SetNumberOfConversionThreads
+  vtkSetMacro(NumberOfConversionThreads, int);
+  vtkGetMacro(NumberOfConversionThreads, int);
+
   enum SegmentStatus
   {
     NotStarted,
@@ -425,6 +433,9 @@ protected:
   /// Terminologies module logic
   vtkSlicerTerminologiesModuleLogic* TerminologiesLogic{nullptr};
 
+  /// Number of conversion threads set in segmentations of new segmentation nodes
+  int NumberOfConversionThreads{0};
+
 private:
   vtkSlicerSegmentationsModuleLogic(const vtkSlicerSegmentationsModuleLogic&) = delete;
   void operator=(const vtkSlicerSegmentationsModuleLogic&) = delete;
@@ -30,6 +30,7 @@
 #include <vtkMRMLTransformNode.h>
 
 // MRML logic includes
+#include "vtkImageLabelMapToRGBA.h"
 #include "vtkImageLabelOutline.h"
 
 // SegmentationCore includes
@@ -206,6 +207,8 @@ public:
       this->Reslice = vtkSmartPointer<vtkImageReslice>::New();
       this->SliceToImageTransform = vtkSmartPointer<vtkGeneralTransform>::New();
       this->LabelOutline = vtkSmartPointer<vtkImageLabelOutline>::New();
+      this->FillColorMapper = vtkSmartPointer<vtkImageMapToRGBA>::New();
+      this->LabelMapToRGBA = vtkSmartPointer<vtkImageLabelMapToRGBA>::New();
       this->LookupTableOutline = vtkSmartPointer<vtkLookupTable>::New();
       this->LookupTableFill = vtkSmartPointer<vtkLookupTable>::New();
       this->ImageThreshold = vtkSmartPointer<vtkImageThreshold>::New();
@@ -239,16 +242,21 @@ public:
       this->ImageOutlineActor->SetVisibility(0);
 
       // Image fill
-      vtkSmartPointer<vtkImageMapToRGBA> fillColorMapper = vtkSmartPointer<vtkImageMapToRGBA>::New();
-      fillColorMapper->SetInputConnection(this->Reslice->GetOutputPort());
-      fillColorMapper->SetOutputFormatToRGBA();
-      fillColorMapper->SetLookupTable(this->LookupTableFill);
+      this->FillColorMapper->SetInputConnection(this->Reslice->GetOutputPort());
+      this->FillColorMapper->SetOutputFormatToRGBA();
+      this->FillColorMapper->SetLookupTable(this->LookupTableFill);
       vtkSmartPointer<vtkImageMapper> imageFillMapper = vtkSmartPointer<vtkImageMapper>::New();
-      imageFillMapper->SetInputConnection(fillColorMapper->GetOutputPort());
+      imageFillMapper->SetInputConnection(this->FillColorMapper->GetOutputPort());
       imageFillMapper->SetColorWindow(255);
       imageFillMapper->SetColorLevel(127.5);
       this->ImageFillActor->SetMapper(imageFillMapper);
       this->ImageFillActor->SetVisibility(0);
+
+      // Image fill and outline of all segments of a binary labelmap, computed in a single pass
+      // and displayed by the image fill actor
+      this->LabelMapToRGBA->SetInputConnection(this->Reslice->GetOutputPort());
+      this->LabelMapToRGBA->SetFillLookupTable(this->LookupTableFill);
+      this->LabelMapToRGBA->SetOutlineLookupTable(this->LookupTableOutline);
       }
 
     vtkSmartPointer<vtkTransform> WorldToSliceTransform;
@@ -273,6 +281,8 @@ public:
     vtkSmartPointer<vtkImageReslice> Reslice;
     vtkSmartPointer<vtkGeneralTransform> SliceToImageTransform;
     vtkSmartPointer<vtkImageLabelOutline> LabelOutline;
+    vtkSmartPointer<vtkImageMapToRGBA> FillColorMapper;
+    vtkSmartPointer<vtkImageLabelMapToRGBA> LabelMapToRGBA;
     vtkSmartPointer<vtkLookupTable> LookupTableOutline;
     vtkSmartPointer<vtkLookupTable> LookupTableFill;
     vtkSmartPointer<vtkImageThreshold> ImageThreshold;
@@ -799,7 +809,16 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateDisplayNodePip
     bool pipelineVisiblity = false;
     for (std::string segmentId : sharedSegmentIds)
       {
-      pipelineVisiblity |= this->IsSegmentVisibleInCurrentSlice(displayNode, pipeline, segmentId);
+      if (this->IsSegmentVisibleInCurrentSlice(displayNode, pipeline, segmentId))
+        {
+        pipelineVisiblity = true;
+        break;
+        }
+      if (imageData)
+        {
+        // segments that share the same labelmap have the same bounds, no need to check the others
+        break;
+        }
       }
 
     if (!pipelineVisiblity)
@@ -944,10 +963,12 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateDisplayNodePip
           }
         }
 
-      // Update pipeline actors
-      pipeline->ImageOutlineActor->SetVisibility(outlineVisible);
+      // Update pipeline actors.
+      // Fill and outline of binary labelmaps are both displayed by the fill actor.
+      bool fractionalLabelmap = (shownRepresenatationName == vtkSegmentationConverter::GetSegmentationFractionalLabelmapRepresentationName());
+      pipeline->ImageOutlineActor->SetVisibility(fractionalLabelmap && outlineVisible);
       pipeline->ImageOutlineActor->SetPosition(0, 0);
-      pipeline->ImageFillActor->SetVisibility(fillVisible);
+      pipeline->ImageFillActor->SetVisibility(fractionalLabelmap ? fillVisible : (fillVisible || outlineVisible));
       pipeline->ImageFillActor->SetPosition(0, 0);
 
       if (!outlineVisible && !fillVisible)
@@ -959,6 +980,7 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateDisplayNodePip
       if (outlineVisible)
         {
         pipeline->LabelOutline->SetOutline(genericDisplayNode->GetSliceIntersectionThickness());
+        pipeline->LabelMapToRGBA->SetOutline(genericDisplayNode->GetSliceIntersectionThickness());
         }
       else
         {
@@ -1139,9 +1161,10 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateDisplayNodePip
 
       // Smooth the border of fractional labelmaps
       pipeline->LabelOutline->SetInputConnection(pipeline->Reslice->GetOutputPort());
-      pipeline->ImageFillActor->GetMapper()->GetInputAlgorithm()->SetInputConnection(pipeline->Reslice->GetOutputPort());
-      if (shownRepresenatationName == vtkSegmentationConverter::GetSegmentationFractionalLabelmapRepresentationName())
+      pipeline->FillColorMapper->SetInputConnection(pipeline->Reslice->GetOutputPort());
+      if (fractionalLabelmap)
         {
+        pipeline->ImageFillActor->GetMapper()->SetInputConnection(pipeline->FillColorMapper->GetOutputPort());
         // If ThresholdValue is not specified, then do not perform thresholding
         vtkDoubleArray* thresholdValue = vtkDoubleArray::SafeDownCast(
           imageData->GetFieldData()->GetAbstractArray(vtkSegmentationConverter::GetThresholdValueFieldName()));
@@ -1149,12 +1172,16 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateDisplayNodePip
           {
           if (!this->SmoothFractionalLabelMapBorder && thresholdValue && thresholdValue->GetNumberOfValues() == 1)
             {
-            pipeline->ImageFillActor->GetMapper()->GetInputAlgorithm()->SetInputConnection(pipeline->ImageThreshold->GetOutputPort());
+            pipeline->FillColorMapper->SetInputConnection(pipeline->ImageThreshold->GetOutputPort());
             }
           pipeline->ImageThreshold->ThresholdByLower(thresholdValue->GetValue(0));
           pipeline->LabelOutline->SetInputConnection(pipeline->ImageThreshold->GetOutputPort());
           }
         }
+      else
+        {
+        pipeline->ImageFillActor->GetMapper()->SetInputConnection(pipeline->LabelMapToRGBA->GetOutputPort());
+        }
       }
     else
       {
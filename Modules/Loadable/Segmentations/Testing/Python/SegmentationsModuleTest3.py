@@ -0,0 +1,148 @@
+import unittest
+import vtk, slicer
+import logging
+from vtk.util import numpy_support
+
+'''
+This class tests the label propagation engines of vtkImageGrowCutSegment.
+The bucket queue engine (default) must produce the same segmentation as the Fibonacci heap engine,
+both for the initial computation and for incremental updates after seeds are added.
+'''
+
+class SegmentationsModuleTest3(unittest.TestCase):
+
+  #------------------------------------------------------------------------------
+  def setUp(self):
+    """ Do whatever is needed to reset the state - typically a scene clear will be enough.
+    """
+    slicer.mrmlScene.Clear(0)
+
+  #------------------------------------------------------------------------------
+  def runTest(self):
+    """Run as few or as many tests as needed here.
+    """
+    self.setUp()
+    self.test_SegmentationsModuleTest3()
+
+  #------------------------------------------------------------------------------
+  def test_SegmentationsModuleTest3(self):
+    # Run tests
+    self.TestSection_CreateInputData()
+    self.TestSection_CompareEngines(distancePenalty=0.0, useMask=False)
+    self.TestSection_CompareEngines(distancePenalty=0.5, useMask=True)
+    self.TestSection_NonFiniteIntensity()
+    logging.info('Test finished')
+
+  #------------------------------------------------------------------------------
+  def createImage(self, array, vtkScalarType):
+    image = vtk.vtkImageData()
+    # numpy array is indexed as [k, j, i]
+    image.SetDimensions(array.shape[2], array.shape[1], array.shape[0])
+    image.SetSpacing(0.8, 0.8, 1.5)
+    image.SetOrigin(10.0, -20.0, 5.0)
+    image.AllocateScalars(vtkScalarType, 1)
+    numpy_support.vtk_to_numpy(image.GetPointData().GetScalars())[:] = array.ravel()
+    return image
+
+  #------------------------------------------------------------------------------
+  def imageToArray(self, image):
+    dims = image.GetDimensions()
+    return numpy_support.vtk_to_numpy(image.GetPointData().GetScalars()).reshape(dims[2], dims[1], dims[0])
+
+  #------------------------------------------------------------------------------
+  def TestSection_CreateInputData(self):
+    import numpy as np
+    logging.info('Test section: Create input data')
+
+    # Two bright blobs on a dark background. Random noise is added
+    # so that labels do not reach voxels at exactly the same distance.
+    randomState = np.random.RandomState(42)
+    k, j, i = np.mgrid[0:20, 0:30, 0:40]
+    intensity = 100.0 * randomState.rand(20, 30, 40)
+    intensity[((i-12)**2 + (j-15)**2 + (k-10)**2) < 36] += 500.0
+    intensity[((i-28)**2 + (j-12)**2 + (k-8)**2) < 25] += 800.0
+    self.intensityImage = self.createImage(intensity.astype(np.float32), vtk.VTK_FLOAT)
+
+    seeds = np.zeros(intensity.shape, dtype=np.int16)
+    seeds[9:12, 14:17, 11:14] = 1
+    seeds[7:10, 11:14, 27:30] = 2
+    seeds[1:3, 1:3, 1:3] = 3
+    seeds[17:19, 26:28, 36:38] = 3
+    self.seedArray = seeds
+
+    mask = np.zeros(intensity.shape, dtype=np.uint8)
+    mask[:, 25:, :10] = 1
+    self.maskImage = self.createImage(mask, vtk.VTK_UNSIGNED_CHAR)
+
+  #------------------------------------------------------------------------------
+  def TestSection_NonFiniteIntensity(self):
+    import numpy as np
+    import vtkSlicerSegmentationsModuleLogicPython as vtkSlicerSegmentationsModuleLogic
+    logging.info('Test section: Non-finite intensity')
+
+    # The bucket queue is the default engine, the heap is used if the intensity range is not finite
+    intensity = np.array(self.imageToArray(self.intensityImage))
+    intensity[5, 5, 5] = np.inf
+    intensityImage = self.createImage(intensity, vtk.VTK_FLOAT)
+    seedImage = self.createImage(self.seedArray, vtk.VTK_SHORT)
+
+    results = {}
+    for useBucketQueue in [False, True]:
+      growCutFilter = vtkSlicerSegmentationsModuleLogic.vtkImageGrowCutSegment()
+      self.assertTrue(growCutFilter.GetUseBucketQueue())
+      growCutFilter.SetUseBucketQueue(useBucketQueue)
+      growCutFilter.SetIntensityVolume(intensityImage)
+      growCutFilter.SetSeedLabelVolume(seedImage)
+      growCutFilter.Update()
+      results[useBucketQueue] = self.imageToArray(growCutFilter.GetOutput())
+    self.assertTrue(np.array_equal(results[False], results[True]))
+
+  #------------------------------------------------------------------------------
+  def TestSection_CompareEngines(self, distancePenalty, useMask):
+    import numpy as np
+    import vtkSlicerSegmentationsModuleLogicPython as vtkSlicerSegmentationsModuleLogic
+    logging.info('Test section: Compare engines (distance penalty: {0}, mask: {1})'.format(distancePenalty, useMask))
+
+    seedImage = self.createImage(self.seedArray, vtk.VTK_SHORT)
+
+    growCutFilters = {}
+    for useBucketQueue in [False, True]:
+      growCutFilter = vtkSlicerSegmentationsModuleLogic.vtkImageGrowCutSegment()
+      growCutFilter.SetUseBucketQueue(useBucketQueue)
+      growCutFilter.SetIntensityVolume(self.intensityImage)
+      growCutFilter.SetSeedLabelVolume(seedImage)
+      if useMask:
+        growCutFilter.SetMaskVolume(self.maskImage)
+      growCutFilter.SetDistancePenalty(distancePenalty)
+      growCutFilter.Update()
+      growCutFilters[useBucketQueue] = growCutFilter
+
+    heapResult = self.imageToArray(growCutFilters[False].GetOutput())
+    bucketQueueResult = self.imageToArray(growCutFilters[True].GetOutput())
+    self.assertEqual(set(np.unique(heapResult)) - {0}, {1, 2, 3})
+    self.assertTrue(np.array_equal(heapResult, bucketQueueResult))
+    if useMask:
+      self.assertEqual(np.count_nonzero(heapResult[:, 25:, :10]), 0)
+
+    # Incremental update: add seeds of a new label and of an existing label
+    seeds = self.imageToArray(seedImage)
+    seeds[2:4, 20:22, 5:7] = 4
+    seeds[15:17, 3:5, 33:35] = 2
+    seedImage.Modified()
+    for growCutFilter in growCutFilters.values():
+      growCutFilter.Update()
+
+    heapResult = self.imageToArray(growCutFilters[False].GetOutput())
+    bucketQueueResult = self.imageToArray(growCutFilters[True].GetOutput())
+    self.assertIn(4, np.unique(heapResult))
+    self.assertTrue(np.array_equal(heapResult, bucketQueueResult))
+
+    # Incremental results must match results computed from scratch
+    growCutFilter = vtkSlicerSegmentationsModuleLogic.vtkImageGrowCutSegment()
+    growCutFilter.SetIntensityVolume(self.intensityImage)
+    growCutFilter.SetSeedLabelVolume(seedImage)
+    if useMask:
+      growCutFilter.SetMaskVolume(self.maskImage)
+    growCutFilter.SetDistancePenalty(distancePenalty)
+    growCutFilter.Update()
+    self.assertTrue(np.array_equal(heapResult, self.imageToArray(growCutFilter.GetOutput())))
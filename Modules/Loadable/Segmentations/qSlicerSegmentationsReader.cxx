@@ -185,8 +185,14 @@ bool qSlicerSegmentationsReader::load(const IOProperties& properties)
       {
       autoOpacities = properties["autoOpacities"].toBool();
       }
+    bool readHeaderOnly = false;
+    if (properties.contains("readHeaderOnly"))
+      {
+      readHeaderOnly = properties["readHeaderOnly"].toBool();
+      }
 
-    vtkMRMLSegmentationNode* node = d->SegmentationsLogic->LoadSegmentationFromFile(fileName.toUtf8().constData(), autoOpacities);
+    vtkMRMLSegmentationNode* node = d->SegmentationsLogic->LoadSegmentationFromFile(
+      fileName.toUtf8().constData(), autoOpacities, readHeaderOnly);
     if (!node)
       {
       this->setLoadedNodes(QStringList());
@@ -25,6 +25,7 @@
 #include "vtkMRMLSequenceBrowserNode.h"
 #include "vtkMRMLSequenceNode.h"
 #include "vtkMRMLSequenceStorageNode.h"
+#include "vtkMRMLVolumeSequenceFrameLoader.h"
 #include "vtkMRMLVolumeSequenceStorageNode.h"
 
 // MRML includes
@@ -346,6 +347,8 @@ void vtkSlicerSequencesLogic::UpdateProxyNodesFromSequences(vtkMRMLSequenceBrows
       }
 
     vtkMRMLNode* sourceDataNode = nullptr;
+    // Voxels of the displayed frame if it is not loaded into the data node
+    vtkSmartPointer<vtkImageData> sourceFrameImage;
     if (browserNode->GetSaveChanges(synchronizedSequenceNode))
       {
       // we want to save changes, therefore we have to make sure a data node is available for the current index
@@ -377,7 +380,22 @@ void vtkSlicerSequencesLogic::UpdateProxyNodesFromSequences(vtkMRMLSequenceBrows
     else
       {
       // we just want to show a node, therefore we can just use closest data node
-      sourceDataNode = synchronizedSequenceNode->GetDataNodeAtValue(indexValue, false /*closest match*/);
+      int itemNumber = synchronizedSequenceNode->GetItemNumberFromIndexValue(indexValue, false /*closest match*/);
+      vtkMRMLVolumeSequenceFrameLoader* frameLoader = synchronizedSequenceNode->GetFrameLoader();
+      if (itemNumber >= 0 && frameLoader)
+        {
+        // Frames of large volume sequences are loaded on demand. The displayed frame is not loaded
+        // into the data node, so that voxels of all the displayed frames are not kept in memory.
+        sourceFrameImage = frameLoader->GetFrameImage(synchronizedSequenceNode, itemNumber);
+        }
+      if (sourceFrameImage)
+        {
+        sourceDataNode = synchronizedSequenceNode->GetNthDataNodeWithoutLoading(itemNumber);
+        }
+      else
+        {
+        sourceDataNode = synchronizedSequenceNode->GetDataNodeAtValue(indexValue, false /*closest match*/);
+        }
       }
     if (sourceDataNode==nullptr)
       {
@@ -421,6 +439,14 @@ void vtkSlicerSequencesLogic::UpdateProxyNodesFromSequences(vtkMRMLSequenceBrows
     // Make sure that by default/most of the time shallow-copy is used.
     bool shallowCopy = browserNode->GetSaveChanges(synchronizedSequenceNode);
     targetProxyNode->CopyContent(sourceDataNode, !shallowCopy);
+    vtkMRMLVolumeNode* targetProxyVolumeNode = vtkMRMLVolumeNode::SafeDownCast(targetProxyNode);
+    if (sourceFrameImage && targetProxyVolumeNode)
+      {
+      // The frame image is shared with the frame cache, the proxy node may modify its own copy only
+      vtkNew<vtkImageData> proxyImage;
+      proxyImage->DeepCopy(sourceFrameImage);
+      targetProxyVolumeNode->SetAndObserveImageData(proxyImage.GetPointer());
+      }
 
     // Singleton nodes must not be renamed, as they are often expected to exist by a specific name
     if (browserNode->GetOverwriteProxyName(synchronizedSequenceNode) && !targetProxyNode->GetSingletonTag())
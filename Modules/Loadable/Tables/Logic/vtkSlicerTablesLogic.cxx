@@ -25,6 +25,7 @@
 
 // MRML includes
 #include <vtkMRMLLayoutNode.h>
+#include <vtkMRMLTableBinaryStorageNode.h>
 #include <vtkMRMLTableNode.h>
 #include <vtkMRMLTableStorageNode.h>
 #include <vtkMRMLScene.h>
@@ -128,9 +129,19 @@ vtkMRMLTableNode* vtkSlicerTablesLogic
   else
     {
     // Storage node
-    vtkNew<vtkMRMLTableStorageNode> tableStorageNode;
+    vtkSmartPointer<vtkMRMLStorageNode> tableStorageNode;
+    if (!extension.compare(".mtbl"))
+      {
+      // Columnar binary file, schema is stored in the same file
+      tableStorageNode = vtkSmartPointer<vtkMRMLTableBinaryStorageNode>::New();
+      }
+    else
+      {
+      vtkNew<vtkMRMLTableStorageNode> textTableStorageNode;
+      textTableStorageNode->SetAutoFindSchema(findSchema);
+      tableStorageNode = textTableStorageNode.GetPointer();
+      }
     tableStorageNode->SetFileName(fileName);
-    tableStorageNode->SetAutoFindSchema(findSchema);
     this->GetMRMLScene()->AddNode(tableStorageNode.GetPointer());
 
     vtkNew<vtkMRMLTableNode> tableNode1;
@@ -106,6 +106,7 @@ QStringList qSlicerTablesReader::extensions()const
     << "Table (*.db3)"
     << "Table (*.sqlite)"
     << "Table (*.sqlite3)"
+    << "Table (*.mtbl)"
     ;
 }
 
@@ -0,0 +1,335 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Terminologies includes
+#include "vtkSlicerTerminologiesModuleLogic.h"
+#include "vtkSlicerTerminologyCategory.h"
+#include "vtkSlicerTerminologyType.h"
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtksys/SystemTools.hxx>
+
+// RapidJSON includes
+#include <rapidjson/document.h>
+#include <rapidjson/filereadstream.h>
+
+// STD includes
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+typedef vtkSlicerTerminologiesModuleLogic::CodeIdentifier CodeIdentifier;
+
+namespace
+{
+
+// Search strings used for all code arrays: empty, mixed case, multiple occurrences in names, no match
+const char* SEARCH_STRINGS[] = { "", "a", "A", "e", " ", "ar", "aR", "Artery", "ARTERY", "left", "Lobe of", "of the", "zzz not found" };
+
+//----------------------------------------------------------------------------
+bool ReadJsonFile(const std::string& filePath, rapidjson::Document& document)
+{
+  FILE* fp = fopen(filePath.c_str(), "r");
+  if (!fp)
+    {
+    return false;
+    }
+  char buffer[4096];
+  rapidjson::FileReadStream fs(fp, buffer, sizeof(buffer));
+  bool success = !document.ParseStream(fs).HasParseError();
+  fclose(fp);
+  return success;
+}
+
+//----------------------------------------------------------------------------
+std::string ToLower(std::string text)
+{
+  std::transform(text.begin(), text.end(), text.begin(), ::tolower);
+  return text;
+}
+
+//----------------------------------------------------------------------------
+bool IsValidCode(const rapidjson::Value& code)
+{
+  return code.IsObject()
+    && code.HasMember("CodingSchemeDesignator") && code["CodingSchemeDesignator"].IsString()
+    && code.HasMember("CodeValue") && code["CodeValue"].IsString()
+    && code.HasMember("CodeMeaning") && code["CodeMeaning"].IsString();
+}
+
+//----------------------------------------------------------------------------
+// Codes with name containing the search string (case-insensitive), found by traversing the Json array
+std::vector<CodeIdentifier> NaiveFindCodes(const rapidjson::Value& jsonArray, const std::string& search)
+{
+  std::vector<CodeIdentifier> codes;
+  std::string searchLowerCase = ToLower(search);
+  for (rapidjson::SizeType index = 0; index < jsonArray.Size(); ++index)
+    {
+    const rapidjson::Value& code = jsonArray[index];
+    if (!IsValidCode(code))
+      {
+      continue;
+      }
+    std::string name = code["CodeMeaning"].GetString();
+    if (ToLower(name).find(searchLowerCase) != std::string::npos)
+      {
+      codes.push_back(CodeIdentifier(code["CodingSchemeDesignator"].GetString(), code["CodeValue"].GetString(), name));
+      }
+    }
+  return codes;
+}
+
+//----------------------------------------------------------------------------
+// First code in the Json array with the given identifier, found by traversing the array
+const rapidjson::Value* NaiveGetCode(const rapidjson::Value& jsonArray, const CodeIdentifier& codeId)
+{
+  for (rapidjson::SizeType index = 0; index < jsonArray.Size(); ++index)
+    {
+    const rapidjson::Value& code = jsonArray[index];
+    if (IsValidCode(code)
+      && codeId.CodingSchemeDesignator == code["CodingSchemeDesignator"].GetString()
+      && codeId.CodeValue == code["CodeValue"].GetString())
+      {
+      return &code;
+      }
+    }
+  return nullptr;
+}
+
+//----------------------------------------------------------------------------
+const rapidjson::Value* GetArrayMember(const rapidjson::Value& code, const char* name)
+{
+  if (!code.IsObject() || !code.HasMember(name) || !code[name].IsArray())
+    {
+    return nullptr;
+    }
+  return &code[name];
+}
+
+//----------------------------------------------------------------------------
+int CheckCodes(const std::vector<CodeIdentifier>& codes, const std::vector<CodeIdentifier>& expectedCodes)
+{
+  CHECK_INT(static_cast<int>(codes.size()), static_cast<int>(expectedCodes.size()));
+  for (size_t index = 0; index < codes.size(); ++index)
+    {
+    CHECK_STD_STRING(codes[index].CodingSchemeDesignator, expectedCodes[index].CodingSchemeDesignator);
+    CHECK_STD_STRING(codes[index].CodeValue, expectedCodes[index].CodeValue);
+    CHECK_STD_STRING(codes[index].CodeMeaning, expectedCodes[index].CodeMeaning);
+    }
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int TestCategories(vtkSlicerTerminologiesModuleLogic* logic, const std::string& terminologyName, const rapidjson::Value& categoryArray)
+{
+  std::vector<CodeIdentifier> categories;
+  CHECK_BOOL(logic->GetCategoriesInTerminology(terminologyName, categories), true);
+  CHECK_EXIT_SUCCESS(CheckCodes(categories, NaiveFindCodes(categoryArray, "")));
+  for (const char* search : SEARCH_STRINGS)
+    {
+    CHECK_BOOL(logic->FindCategoriesInTerminology(terminologyName, categories, search), true);
+    CHECK_EXIT_SUCCESS(CheckCodes(categories, NaiveFindCodes(categoryArray, search)));
+    }
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int TestTerminology(vtkSlicerTerminologiesModuleLogic* logic, const std::string& filePath)
+{
+  std::string terminologyName = logic->LoadTerminologyFromFile(filePath);
+  CHECK_STD_STRING_DIFFERENT(terminologyName, "");
+  rapidjson::Document document;
+  CHECK_BOOL(ReadJsonFile(filePath, document), true);
+  const rapidjson::Value& categoryArray = document["SegmentationCodes"]["Category"];
+
+  CHECK_EXIT_SUCCESS(TestCategories(logic, terminologyName, categoryArray));
+
+  // Search is case-insensitive
+  std::vector<CodeIdentifier> lowerCaseResults;
+  std::vector<CodeIdentifier> upperCaseResults;
+  CHECK_BOOL(logic->FindCategoriesInTerminology(terminologyName, lowerCaseResults, "structure"), true);
+  CHECK_BOOL(logic->FindCategoriesInTerminology(terminologyName, upperCaseResults, "STRUCTURE"), true);
+  CHECK_BOOL(lowerCaseResults.empty(), false);
+  CHECK_EXIT_SUCCESS(CheckCodes(upperCaseResults, lowerCaseResults));
+
+  for (const CodeIdentifier& categoryId : NaiveFindCodes(categoryArray, ""))
+    {
+    // Codes that are listed multiple times are looked up as the first occurrence
+    const rapidjson::Value* categoryObject = NaiveGetCode(categoryArray, categoryId);
+    vtkNew<vtkSlicerTerminologyCategory> category;
+    CHECK_BOOL(logic->GetCategoryInTerminology(terminologyName, categoryId, category), true);
+    CHECK_STRING(category->GetCodeMeaning(), (*categoryObject)["CodeMeaning"].GetString());
+
+    const rapidjson::Value* typeArray = GetArrayMember(*categoryObject, "Type");
+    if (!typeArray)
+      {
+      continue;
+      }
+    std::vector<CodeIdentifier> types;
+    CHECK_BOOL(logic->GetTypesInTerminologyCategory(terminologyName, categoryId, types), true);
+    CHECK_EXIT_SUCCESS(CheckCodes(types, NaiveFindCodes(*typeArray, "")));
+    for (const char* search : SEARCH_STRINGS)
+      {
+      CHECK_BOOL(logic->FindTypesInTerminologyCategory(terminologyName, categoryId, types, search), true);
+      CHECK_EXIT_SUCCESS(CheckCodes(types, NaiveFindCodes(*typeArray, search)));
+      }
+
+    for (const CodeIdentifier& typeId : NaiveFindCodes(*typeArray, ""))
+      {
+      const rapidjson::Value* typeObject = NaiveGetCode(*typeArray, typeId);
+      vtkNew<vtkSlicerTerminologyType> type;
+      CHECK_BOOL(logic->GetTypeInTerminologyCategory(terminologyName, categoryId, typeId, type), true);
+      CHECK_STRING(type->GetCodeMeaning(), (*typeObject)["CodeMeaning"].GetString());
+
+      const rapidjson::Value* modifierArray = GetArrayMember(*typeObject, "Modifier");
+      if (!modifierArray)
+        {
+        continue;
+        }
+      std::vector<CodeIdentifier> modifiers;
+      CHECK_BOOL(logic->GetTypeModifiersInTerminologyType(terminologyName, categoryId, typeId, modifiers), true);
+      CHECK_EXIT_SUCCESS(CheckCodes(modifiers, NaiveFindCodes(*modifierArray, "")));
+      for (const CodeIdentifier& modifierId : modifiers)
+        {
+        vtkNew<vtkSlicerTerminologyType> modifier;
+        CHECK_BOOL(logic->GetTypeModifierInTerminologyType(terminologyName, categoryId, typeId, modifierId, modifier), true);
+        CHECK_STRING(modifier->GetCodeMeaning(), (*NaiveGetCode(*modifierArray, modifierId))["CodeMeaning"].GetString());
+        }
+      }
+    }
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int TestAnatomicContext(vtkSlicerTerminologiesModuleLogic* logic, const std::string& filePath)
+{
+  std::string anatomicContextName = logic->LoadAnatomicContextFromFile(filePath);
+  CHECK_STD_STRING_DIFFERENT(anatomicContextName, "");
+  rapidjson::Document document;
+  CHECK_BOOL(ReadJsonFile(filePath, document), true);
+  const rapidjson::Value& regionArray = document["AnatomicCodes"]["AnatomicRegion"];
+
+  std::vector<CodeIdentifier> regions;
+  CHECK_BOOL(logic->GetRegionsInAnatomicContext(anatomicContextName, regions), true);
+  CHECK_EXIT_SUCCESS(CheckCodes(regions, NaiveFindCodes(regionArray, "")));
+  for (const char* search : SEARCH_STRINGS)
+    {
+    CHECK_BOOL(logic->FindRegionsInAnatomicContext(anatomicContextName, regions, search), true);
+    CHECK_EXIT_SUCCESS(CheckCodes(regions, NaiveFindCodes(regionArray, search)));
+    }
+
+  for (const CodeIdentifier& regionId : NaiveFindCodes(regionArray, ""))
+    {
+    const rapidjson::Value* regionObject = NaiveGetCode(regionArray, regionId);
+    vtkNew<vtkSlicerTerminologyType> region;
+    CHECK_BOOL(logic->GetRegionInAnatomicContext(anatomicContextName, regionId, region), true);
+    CHECK_STRING(region->GetCodeMeaning(), (*regionObject)["CodeMeaning"].GetString());
+
+    const rapidjson::Value* modifierArray = GetArrayMember(*regionObject, "Modifier");
+    if (!modifierArray)
+      {
+      continue;
+      }
+    std::vector<CodeIdentifier> modifiers;
+    CHECK_BOOL(logic->GetRegionModifiersInAnatomicRegion(anatomicContextName, regionId, modifiers), true);
+    CHECK_EXIT_SUCCESS(CheckCodes(modifiers, NaiveFindCodes(*modifierArray, "")));
+    for (const CodeIdentifier& modifierId : modifiers)
+      {
+      vtkNew<vtkSlicerTerminologyType> modifier;
+      CHECK_BOOL(logic->GetRegionModifierInAnatomicRegion(anatomicContextName, regionId, modifierId, modifier), true);
+      CHECK_STRING(modifier->GetCodeMeaning(), (*NaiveGetCode(*modifierArray, modifierId))["CodeMeaning"].GetString());
+      }
+    }
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+// Loading a terminology with the same name replaces the document, lookups and searches
+// must not use the index of the previous document.
+int TestReload(vtkSlicerTerminologiesModuleLogic* logic, const std::string& filePath, const std::string& temporaryDirectory)
+{
+  std::string terminologyName = logic->LoadTerminologyFromFile(filePath);
+  CHECK_STD_STRING_DIFFERENT(terminologyName, "");
+  rapidjson::Document document;
+  CHECK_BOOL(ReadJsonFile(filePath, document), true);
+  CHECK_EXIT_SUCCESS(TestCategories(logic, terminologyName, document["SegmentationCodes"]["Category"]));
+  CodeIdentifier tissueId("SCT", "85756007", "Tissue");
+  vtkNew<vtkSlicerTerminologyCategory> category;
+  CHECK_BOOL(logic->GetCategoryInTerminology(terminologyName, tissueId, category), true);
+  CHECK_STRING(category->GetCodeMeaning(), "Tissue");
+
+  // Terminology with the same name but different categories
+  std::string modifiedFilePath = temporaryDirectory + "/vtkSlicerTerminologiesModuleLogicTest1.term.json";
+    {
+    std::ofstream modifiedFile(modifiedFilePath.c_str());
+    modifiedFile
+      << "{\n"
+      << "  \"SegmentationCategoryTypeContextName\": \"" << terminologyName << "\",\n"
+      << "  \"@schema\": \"" << document["@schema"].GetString() << "\",\n"
+      << "  \"SegmentationCodes\": {\n"
+      << "    \"Category\": [\n"
+      << "      { \"CodeMeaning\": \"Reloaded Tissue\", \"CodingSchemeDesignator\": \"SCT\", \"CodeValue\": \"85756007\", \"Type\": [] },\n"
+      << "      { \"CodeMeaning\": \"Other\", \"CodingSchemeDesignator\": \"TEST\", \"CodeValue\": \"1\", \"Type\": [] }\n"
+      << "    ]\n"
+      << "  }\n"
+      << "}\n";
+    }
+  CHECK_STD_STRING(logic->LoadTerminologyFromFile(modifiedFilePath), terminologyName);
+  rapidjson::Document modifiedDocument;
+  CHECK_BOOL(ReadJsonFile(modifiedFilePath, modifiedDocument), true);
+  CHECK_EXIT_SUCCESS(TestCategories(logic, terminologyName, modifiedDocument["SegmentationCodes"]["Category"]));
+  std::vector<CodeIdentifier> categories;
+  CHECK_BOOL(logic->FindCategoriesInTerminology(terminologyName, categories, "TISSUE"), true);
+  CHECK_INT(static_cast<int>(categories.size()), 1);
+  CHECK_STD_STRING(categories[0].CodeMeaning, "Reloaded Tissue");
+  CHECK_BOOL(logic->GetCategoryInTerminology(terminologyName, tissueId, category), true);
+  CHECK_STRING(category->GetCodeMeaning(), "Reloaded Tissue");
+
+  // Loading the original file through the generic loader replaces the document again
+  CHECK_BOOL(logic->LoadContextFromFile(filePath), true);
+  CHECK_EXIT_SUCCESS(TestCategories(logic, terminologyName, document["SegmentationCodes"]["Category"]));
+  CHECK_BOOL(logic->GetCategoryInTerminology(terminologyName, tissueId, category), true);
+  CHECK_STRING(category->GetCodeMeaning(), "Tissue");
+
+  vtksys::SystemTools::RemoveFile(modifiedFilePath);
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkSlicerTerminologiesModuleLogicTest1(int argc, char * argv[])
+{
+  if (argc < 3)
+    {
+    std::cerr << "Usage: vtkSlicerTerminologiesModuleLogicTest1 /path/to/Terminologies/Resources /path/to/temp" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::string resourcesDirectory = argv[1];
+  std::string temporaryDirectory = argv[2];
+
+  vtkNew<vtkSlicerTerminologiesModuleLogic> logic;
+  CHECK_EXIT_SUCCESS(TestTerminology(logic, resourcesDirectory + "/SegmentationCategoryTypeModifier-SlicerGeneralAnatomy.json"));
+  CHECK_EXIT_SUCCESS(TestTerminology(logic, resourcesDirectory + "/SegmentationCategoryTypeModifier-DICOM-Master.json"));
+  CHECK_EXIT_SUCCESS(TestAnatomicContext(logic, resourcesDirectory + "/AnatomicRegionAndModifier-DICOM-Master.json"));
+  CHECK_EXIT_SUCCESS(TestReload(logic, resourcesDirectory + "/SegmentationCategoryTypeModifier-SlicerGeneralAnatomy.json", temporaryDirectory));
+  return EXIT_SUCCESS;
+}
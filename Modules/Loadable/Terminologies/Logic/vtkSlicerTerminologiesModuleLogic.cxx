@@ -44,6 +44,8 @@
 
 // STD includes
 #include <algorithm>
+#include <unordered_map>
+#include <utility>
 
 #include "rapidjson/document.h"     // rapidjson's DOM-style API
 #include "rapidjson/prettywriter.h" // for stringify JSON
@@ -69,11 +71,48 @@ public:
   vtkInternal();
   ~vtkInternal();
 
+  /// Lookup and search index of a Json code array (categories, types, regions, or modifiers).
+  /// Built once per array so that lookups do not traverse the array and searches do not need to
+  /// convert all the names to lowercase. The Json objects remain owned by the loaded document.
+  struct CodeArrayIndex
+    {
+    /// Json object for each coding scheme designator and code value pair (see \sa GetCodeKey)
+    std::unordered_map<std::string, rapidjson::Value*> Objects;
+    /// Valid codes (with name) in the order of the Json array
+    std::vector<CodeIdentifier> Codes;
+    /// Lowercase names of \sa Codes for case-insensitive search
+    std::vector<std::string> LowerCaseNames;
+    /// All suffixes of \sa LowerCaseNames in alphabetical order for substring search.
+    /// First is the index in \sa Codes, second is the start position of the suffix in the name.
+    /// Built on the first search in the array.
+    std::vector<std::pair<unsigned int, unsigned int> > NameSuffixes;
+    bool NameSuffixesBuilt{false};
+    };
+  typedef std::unordered_map<const rapidjson::Value*, CodeArrayIndex> CodeArrayIndexMap;
+
   /// Utility function to get code in Json array
+  /// Note: Traverses the array. Use \sa FindCodeInArray for arrays of loaded documents.
   /// \param foundIndex Output parameter for index of found object in input array. -1 if not found
   /// \return Json object if found, otherwise null Json object
   rapidjson::Value& GetCodeInArray(CodeIdentifier codeId, rapidjson::Value& jsonArray, int &foundIndex);
 
+  /// Get code in Json array of a loaded document using the index of the array
+  /// \return Json object if found, otherwise null Json object
+  rapidjson::Value& FindCodeInArray(CodeIdentifier codeId, rapidjson::Value& jsonArray);
+  /// Get codes in Json array of a loaded document with name containing a given string (case-insensitive)
+  /// \param search Search string. All codes are returned if empty
+  /// \param codes Output argument containing the found codes in the order of the Json array
+  void FindCodesInArray(rapidjson::Value& jsonArray, std::string search, std::vector<CodeIdentifier>& codes);
+  /// Get index of a Json array of a loaded document. The index is created on first access.
+  CodeArrayIndex& GetCodeArrayIndex(rapidjson::Value& jsonArray);
+  /// Build substring search index of a code array
+  static void BuildNameSuffixes(CodeArrayIndex& index);
+  /// Get key in \sa CodeArrayIndex::Objects for a coding scheme designator and code value pair
+  static std::string GetCodeKey(const std::string& codingSchemeDesignator, const std::string& codeValue)
+    {
+    return codingSchemeDesignator + "\n" + codeValue;
+    }
+
   /// Get root Json value for the terminology with given name
   rapidjson::Value& GetTerminologyRootByName(std::string terminologyName);
 
@@ -138,8 +177,10 @@ public:
   void GetJsonCodeFromIdentifier(rapidjson::Value& code, CodeIdentifier identifier, rapidjson::Document::AllocatorType& allocator);
 
   /// Utility function for safe (memory-leak-free) setting of a document pointer in map
-  static void SetDocumentInTerminologyMap(TerminologyMap& terminologyMap, const std::string& name, rapidjson::Document* doc)
+  /// Note: Code array indices are cleared, as the document may have been modified even if it is already in the map
+  void SetDocumentInTerminologyMap(TerminologyMap& terminologyMap, const std::string& name, rapidjson::Document* doc)
     {
+    this->CodeArrayIndices.clear();
     if (terminologyMap.find(name) != terminologyMap.end())
       {
       if (doc == terminologyMap[name])
@@ -160,6 +201,10 @@ public:
 
   /// Loaded anatomical region contexts. Key is the context name, value is the root item.
   TerminologyMap LoadedAnatomicContexts;
+
+  /// Indices of the code arrays in the loaded terminologies and anatomic contexts.
+  /// Key is the Json array. Cleared when a document is loaded or modified.
+  CodeArrayIndexMap CodeArrayIndices;
 };
 
 //---------------------------------------------------------------------------
@@ -216,6 +261,146 @@ rapidjson::Value& vtkSlicerTerminologiesModuleLogic::vtkInternal::GetCodeInArray
   return JSON_EMPTY_VALUE;
 }
 
+//---------------------------------------------------------------------------
+rapidjson::Value& vtkSlicerTerminologiesModuleLogic::vtkInternal::FindCodeInArray(CodeIdentifier codeId, rapidjson::Value& jsonArray)
+{
+  if (!jsonArray.IsArray())
+    {
+    return JSON_EMPTY_VALUE;
+    }
+
+  CodeArrayIndex& index = this->GetCodeArrayIndex(jsonArray);
+  std::unordered_map<std::string, rapidjson::Value*>::iterator objectIt =
+    index.Objects.find(GetCodeKey(codeId.CodingSchemeDesignator, codeId.CodeValue));
+  if (objectIt == index.Objects.end())
+    {
+    return JSON_EMPTY_VALUE;
+    }
+  return *(objectIt->second);
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerTerminologiesModuleLogic::vtkInternal::FindCodesInArray(
+  rapidjson::Value& jsonArray, std::string search, std::vector<CodeIdentifier>& codes)
+{
+  codes.clear();
+  if (!jsonArray.IsArray())
+    {
+    return;
+    }
+
+  CodeArrayIndex& index = this->GetCodeArrayIndex(jsonArray);
+  if (search.empty())
+    {
+    codes = index.Codes;
+    return;
+    }
+
+  if (!index.NameSuffixesBuilt)
+    {
+    BuildNameSuffixes(index);
+    }
+
+  // Make lowercase for case-insensitive comparison
+  std::transform(search.begin(), search.end(), search.begin(), ::tolower);
+
+  // Names containing the search string are the ones that have a suffix starting with it.
+  // These suffixes are next to each other in the sorted suffix array.
+  const std::vector<std::string>& names = index.LowerCaseNames;
+  std::vector<std::pair<unsigned int, unsigned int> >::const_iterator suffixIt = std::lower_bound(
+    index.NameSuffixes.begin(), index.NameSuffixes.end(), search,
+    [&names](const std::pair<unsigned int, unsigned int>& suffix, const std::string& value)
+      {
+      return names[suffix.first].compare(suffix.second, std::string::npos, value) < 0;
+      });
+  std::vector<unsigned int> foundCodeIndices;
+  for (; suffixIt != index.NameSuffixes.end(); ++suffixIt)
+    {
+    if (names[suffixIt->first].compare(suffixIt->second, search.size(), search) != 0)
+      {
+      break;
+      }
+    foundCodeIndices.push_back(suffixIt->first);
+    }
+
+  // Return codes in the order of the Json array, each only once
+  std::sort(foundCodeIndices.begin(), foundCodeIndices.end());
+  foundCodeIndices.erase(std::unique(foundCodeIndices.begin(), foundCodeIndices.end()), foundCodeIndices.end());
+  codes.reserve(foundCodeIndices.size());
+  for (unsigned int codeIndex : foundCodeIndices)
+    {
+    codes.push_back(index.Codes[codeIndex]);
+    }
+}
+
+//---------------------------------------------------------------------------
+vtkSlicerTerminologiesModuleLogic::vtkInternal::CodeArrayIndex&
+vtkSlicerTerminologiesModuleLogic::vtkInternal::GetCodeArrayIndex(rapidjson::Value& jsonArray)
+{
+  CodeArrayIndexMap::iterator indexIt = this->CodeArrayIndices.find(&jsonArray);
+  if (indexIt != this->CodeArrayIndices.end())
+    {
+    return indexIt->second;
+    }
+
+  CodeArrayIndex& index = this->CodeArrayIndices[&jsonArray];
+  index.Objects.reserve(jsonArray.Size());
+  for (rapidjson::SizeType arrayIndex = 0; arrayIndex < jsonArray.Size(); ++arrayIndex)
+    {
+    rapidjson::Value& currentObject = jsonArray[arrayIndex];
+    if (!currentObject.IsObject())
+      {
+      continue;
+      }
+    rapidjson::Value::MemberIterator codingSchemeDesignator = currentObject.FindMember("CodingSchemeDesignator");
+    rapidjson::Value::MemberIterator codeValue = currentObject.FindMember("CodeValue");
+    rapidjson::Value::MemberIterator codeMeaning = currentObject.FindMember("CodeMeaning");
+    if ( codingSchemeDesignator == currentObject.MemberEnd() || !codingSchemeDesignator->value.IsString()
+      || codeValue == currentObject.MemberEnd() || !codeValue->value.IsString() )
+      {
+      vtkGenericWarningMacro("GetCodeArrayIndex: Invalid code at index " << arrayIndex);
+      continue;
+      }
+
+    // Keep the first object if a code is listed multiple times
+    index.Objects.insert(std::make_pair(
+      GetCodeKey(codingSchemeDesignator->value.GetString(), codeValue->value.GetString()), &currentObject));
+
+    if (codeMeaning == currentObject.MemberEnd() || !codeMeaning->value.IsString())
+      {
+      vtkGenericWarningMacro("GetCodeArrayIndex: Invalid code '" << codeValue->value.GetString() << "' at index " << arrayIndex);
+      continue;
+      }
+    std::string name = codeMeaning->value.GetString();
+    std::string nameLowerCase(name);
+    std::transform(nameLowerCase.begin(), nameLowerCase.end(), nameLowerCase.begin(), ::tolower);
+    index.Codes.push_back(CodeIdentifier(codingSchemeDesignator->value.GetString(), codeValue->value.GetString(), name));
+    index.LowerCaseNames.push_back(nameLowerCase);
+    }
+
+  return index;
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerTerminologiesModuleLogic::vtkInternal::BuildNameSuffixes(CodeArrayIndex& index)
+{
+  const std::vector<std::string>& names = index.LowerCaseNames;
+  index.NameSuffixes.clear();
+  for (unsigned int codeIndex = 0; codeIndex < names.size(); ++codeIndex)
+    {
+    for (unsigned int position = 0; position < names[codeIndex].size(); ++position)
+      {
+      index.NameSuffixes.push_back(std::make_pair(codeIndex, position));
+      }
+    }
+  std::sort(index.NameSuffixes.begin(), index.NameSuffixes.end(),
+    [&names](const std::pair<unsigned int, unsigned int>& a, const std::pair<unsigned int, unsigned int>& b)
+      {
+      return names[a.first].compare(a.second, std::string::npos, names[b.first], b.second, std::string::npos) < 0;
+      });
+  index.NameSuffixesBuilt = true;
+}
+
 //---------------------------------------------------------------------------
 rapidjson::Value& vtkSlicerTerminologiesModuleLogic::vtkInternal::GetTerminologyRootByName(std::string terminologyName)
 {
@@ -272,8 +457,7 @@ rapidjson::Value& vtkSlicerTerminologiesModuleLogic::vtkInternal::GetCategoryInT
     return JSON_EMPTY_VALUE;
     }
 
-  int index = -1;
-  return this->GetCodeInArray(categoryId, categoryArray, index);
+  return this->FindCodeInArray(categoryId, categoryArray);
 }
 
 //---------------------------------------------------------------------------
@@ -371,8 +555,7 @@ rapidjson::Value& vtkSlicerTerminologiesModuleLogic::vtkInternal::GetTypeInTermi
     return JSON_EMPTY_VALUE;
     }
 
-  int index = -1;
-  return this->GetCodeInArray(typeId, typeArray, index);
+  return this->FindCodeInArray(typeId, typeArray);
 }
 
 //---------------------------------------------------------------------------
@@ -499,8 +682,7 @@ rapidjson::Value& vtkSlicerTerminologiesModuleLogic::vtkInternal::GetTypeModifie
     return JSON_EMPTY_VALUE;
     }
 
-  int index = -1;
-  return this->GetCodeInArray(modifierId, typeModifierArray, index);
+  return this->FindCodeInArray(modifierId, typeModifierArray);
 }
 
 //---------------------------------------------------------------------------
@@ -559,8 +741,7 @@ rapidjson::Value& vtkSlicerTerminologiesModuleLogic::vtkInternal::GetRegionInAna
     return JSON_EMPTY_VALUE;
     }
 
-  int index = -1;
-  return this->GetCodeInArray(regionId, regionArray, index);
+  return this->FindCodeInArray(regionId, regionArray);
 }
 
 //---------------------------------------------------------------------------
@@ -611,8 +792,7 @@ rapidjson::Value& vtkSlicerTerminologiesModuleLogic::vtkInternal::GetRegionModif
     return JSON_EMPTY_VALUE;
     }
 
-  int index = -1;
-  return this->GetCodeInArray(modifierId, regionModifierArray, index);
+  return this->FindCodeInArray(modifierId, regionModifierArray);
 }
 
 //---------------------------------------------------------------------------
@@ -632,6 +812,9 @@ bool vtkSlicerTerminologiesModuleLogic::vtkInternal::ConvertSegmentationDescript
     return false;
     }
 
+  // Arrays of the converted document are moved around, so the indices pointing to them become invalid
+  this->CodeArrayIndices.clear();
+
   rapidjson::Document::AllocatorType& allocator = convertedDoc.GetAllocator();
 
   // Use terminology with context name if exists
@@ -852,6 +1035,9 @@ bool vtkSlicerTerminologiesModuleLogic::vtkInternal::ConvertSegmentationDescript
     return false;
     }
 
+  // Arrays of the converted document are moved around, so the indices pointing to them become invalid
+  this->CodeArrayIndices.clear();
+
   rapidjson::Document::AllocatorType& allocator = convertedDoc.GetAllocator();
 
   // Use terminology with context name if exists
@@ -1064,7 +1250,7 @@ bool vtkSlicerTerminologiesModuleLogic::LoadContextFromFile(std::string filePath
     {
     // Store terminology
     std::string contextName = (*jsonRoot)["SegmentationCategoryTypeContextName"].GetString();
-    vtkSlicerTerminologiesModuleLogic::vtkInternal::SetDocumentInTerminologyMap(
+    this->Internal->SetDocumentInTerminologyMap(
       this->Internal->LoadedTerminologies, contextName, jsonRoot);
     vtkDebugMacro("Terminology named '" << contextName << "' successfully loaded from file " << filePath);
     }
@@ -1072,7 +1258,7 @@ bool vtkSlicerTerminologiesModuleLogic::LoadContextFromFile(std::string filePath
     {
     // Store anatomic context
     std::string contextName = (*jsonRoot)["AnatomicContextName"].GetString();
-    vtkSlicerTerminologiesModuleLogic::vtkInternal::SetDocumentInTerminologyMap(
+    this->Internal->SetDocumentInTerminologyMap(
       this->Internal->LoadedAnatomicContexts, contextName, jsonRoot);
     vtkDebugMacro("Anatomic context named '" << contextName << "' successfully loaded from file " << filePath);
     }
@@ -1131,7 +1317,7 @@ std::string vtkSlicerTerminologiesModuleLogic::LoadTerminologyFromFile(std::stri
 
   // Store terminology
   std::string contextName = (*terminologyRoot)["SegmentationCategoryTypeContextName"].GetString();
-  vtkSlicerTerminologiesModuleLogic::vtkInternal::SetDocumentInTerminologyMap(
+  this->Internal->SetDocumentInTerminologyMap(
     this->Internal->LoadedTerminologies, contextName, terminologyRoot);
 
   vtkDebugMacro("Terminology named '" << contextName << "' successfully loaded from file " << filePath);
@@ -1181,7 +1367,7 @@ bool vtkSlicerTerminologiesModuleLogic::LoadTerminologyFromSegmentDescriptorFile
     }
 
   // Store terminology
-  vtkSlicerTerminologiesModuleLogic::vtkInternal::SetDocumentInTerminologyMap(
+  this->Internal->SetDocumentInTerminologyMap(
     this->Internal->LoadedTerminologies, contextName, convertedDoc );
 
   vtkDebugMacro("Terminology named '" << contextName << "' successfully loaded from file " << filePath);
@@ -1249,7 +1435,7 @@ std::string vtkSlicerTerminologiesModuleLogic::LoadAnatomicContextFromFile(std::
 
   // Store anatomic context
   std::string contextName = (*anatomicContextRoot)["AnatomicContextName"].GetString();
-  vtkSlicerTerminologiesModuleLogic::vtkInternal::SetDocumentInTerminologyMap(
+  this->Internal->SetDocumentInTerminologyMap(
     this->Internal->LoadedAnatomicContexts, contextName, anatomicContextRoot);
 
   vtkDebugMacro("Anatomic context named '" << contextName << "' successfully loaded from file " << filePath);
@@ -1299,7 +1485,7 @@ bool vtkSlicerTerminologiesModuleLogic::LoadAnatomicContextFromSegmentDescriptor
     }
 
   // Store anatomic context
-  vtkSlicerTerminologiesModuleLogic::vtkInternal::SetDocumentInTerminologyMap(
+  this->Internal->SetDocumentInTerminologyMap(
     this->Internal->LoadedAnatomicContexts, contextName, convertedDoc );
 
   vtkDebugMacro("Anatomic context named '" << contextName << "' successfully loaded from file " << filePath);
@@ -1433,39 +1619,8 @@ bool vtkSlicerTerminologiesModuleLogic::FindCategoriesInTerminology(std::string
     return false;
     }
 
-  // Make lowercase for case-insensitive comparison
-  std::transform(search.begin(), search.end(), search.begin(), ::tolower);
-
-  // Traverse categories
-  rapidjson::SizeType index = 0;
-  while (index < categoryArray.Size())
-    {
-    rapidjson::Value& category = categoryArray[index];
-    if (category.IsObject())
-      {
-      rapidjson::Value& categoryName = category["CodeMeaning"];
-      rapidjson::Value& categoryCodingSchemeDesignator = category["CodingSchemeDesignator"];
-      rapidjson::Value& categoryCodeValue = category["CodeValue"];
-      if (categoryName.IsString() && categoryCodingSchemeDesignator.IsString() && categoryCodeValue.IsString())
-        {
-        // Add category to list if search string is empty or is contained by the current category name
-        std::string categoryNameStr = categoryName.GetString();
-        std::string categoryNameLowerCase(categoryNameStr);
-        std::transform(categoryNameLowerCase.begin(), categoryNameLowerCase.end(), categoryNameLowerCase.begin(), ::tolower);
-        if (search.empty() || categoryNameLowerCase.find(search) != std::string::npos)
-          {
-          CodeIdentifier categoryId(categoryCodingSchemeDesignator.GetString(), categoryCodeValue.GetString(), categoryNameStr);
-          categories.push_back(categoryId);
-          }
-        }
-      else
-        {
-        vtkErrorMacro("FindCategoriesInTerminology: Invalid category '" << categoryName.GetString() << "' in terminology '" << terminologyName << "'");
-        }
-      }
-    ++index;
-    }
-
+  // Collect categories with name containing the search string
+  this->Internal->FindCodesInArray(categoryArray, search, categories);
   return true;
 }
 
@@ -1508,40 +1663,8 @@ bool vtkSlicerTerminologiesModuleLogic::FindTypesInTerminologyCategory(
     return false;
     }
 
-  // Make lowercase for case-insensitive comparison
-  std::transform(search.begin(), search.end(), search.begin(), ::tolower);
-
-  // Traverse types
-  rapidjson::SizeType index = 0;
-  while (index < typeArray.Size())
-    {
-    rapidjson::Value& type = typeArray[index];
-    if (type.IsObject())
-      {
-      rapidjson::Value& typeName = type["CodeMeaning"];
-      rapidjson::Value& typeCodingSchemeDesignator = type["CodingSchemeDesignator"];
-      rapidjson::Value& typeCodeValue = type["CodeValue"];
-      if (typeName.IsString() && typeCodingSchemeDesignator.IsString() && typeCodeValue.IsString())
-        {
-        // Add type to list if search string is empty or is contained by the current type name
-        std::string typeNameStr = typeName.GetString();
-        std::string typeNameLowerCase(typeNameStr);
-        std::transform(typeNameLowerCase.begin(), typeNameLowerCase.end(), typeNameLowerCase.begin(), ::tolower);
-        if (search.empty() || typeNameLowerCase.find(search) != std::string::npos)
-          {
-          CodeIdentifier typeId(typeCodingSchemeDesignator.GetString(), typeCodeValue.GetString(), typeNameStr);
-          types.push_back(typeId);
-          }
-        }
-      else
-        {
-        vtkErrorMacro("FindTypesInTerminologyCategory: Invalid type '" << typeName.GetString() << "in category '"
-          << categoryId.CodeMeaning << "' in terminology '" << terminologyName << "'");
-        }
-      }
-    ++index;
-    }
-
+  // Collect types with name containing the search string
+  this->Internal->FindCodesInArray(typeArray, search, types);
   return true;
 }
 
@@ -1581,25 +1704,7 @@ bool vtkSlicerTerminologiesModuleLogic::GetTypeModifiersInTerminologyType(
     }
 
   // Collect type modifiers
-  rapidjson::SizeType index = 0;
-  while (index < typeModifierArray.Size())
-    {
-    rapidjson::Value& typeModifier = typeModifierArray[index];
-    if (typeModifier.IsObject())
-      {
-      rapidjson::Value& typeModifierName = typeModifier["CodeMeaning"];
-      rapidjson::Value& typeModifierCodingSchemeDesignator = typeModifier["CodingSchemeDesignator"];
-      rapidjson::Value& typeModifierCodeValue = typeModifier["CodeValue"];
-      if (typeModifierName.IsString() && typeModifierCodingSchemeDesignator.IsString() && typeModifierCodeValue.IsString())
-        {
-        CodeIdentifier typeModifierId(typeModifierCodingSchemeDesignator.GetString(),
-          typeModifierCodeValue.GetString(), typeModifierName.GetString());
-        typeModifiers.push_back(typeModifierId);
-        }
-      }
-    ++index;
-    } // For each type modifier index
-
+  this->Internal->FindCodesInArray(typeModifierArray, "", typeModifiers);
   return true;
 }
 
@@ -1642,40 +1747,8 @@ bool vtkSlicerTerminologiesModuleLogic::FindRegionsInAnatomicContext(std::string
     return false;
     }
 
-  // Make lowercase for case-insensitive comparison
-  std::transform(search.begin(), search.end(), search.begin(), ::tolower);
-
-  // Traverse regions
-  rapidjson::SizeType index = 0;
-  while (index<regionArray.Size())
-    {
-    rapidjson::Value& region = regionArray[index];
-    if (region.IsObject())
-      {
-      rapidjson::Value& regionName = region["CodeMeaning"];
-      rapidjson::Value& regionCodingSchemeDesignator = region["CodingSchemeDesignator"];
-      rapidjson::Value& regionCodeValue = region["CodeValue"];
-      if (regionName.IsString() && regionCodingSchemeDesignator.IsString() && regionCodeValue.IsString())
-        {
-        // Add region name to list if search string is empty or is contained by the current region name
-        std::string regionNameStr = regionName.GetString();
-        std::string regionNameLowerCase(regionNameStr);
-        std::transform(regionNameLowerCase.begin(), regionNameLowerCase.end(), regionNameLowerCase.begin(), ::tolower);
-        if (search.empty() || regionNameLowerCase.find(search) != std::string::npos)
-          {
-          CodeIdentifier regionId(regionCodingSchemeDesignator.GetString(), regionCodeValue.GetString(), regionNameStr);
-          regions.push_back(regionId);
-          }
-        }
-      else
-        {
-        vtkErrorMacro("FindRegionsInAnatomicContext: Invalid region '" << regionName.GetString()
-          << "' in anatomic context '" << anatomicContextName << "'");
-        }
-      }
-    ++index;
-    }
-
+  // Collect regions with name containing the search string
+  this->Internal->FindCodesInArray(regionArray, search, regions);
   return true;
 }
 
@@ -1713,25 +1786,7 @@ bool vtkSlicerTerminologiesModuleLogic::GetRegionModifiersInAnatomicRegion(
     }
 
   // Collect region modifiers
-  rapidjson::SizeType index = 0;
-  while (index<regionModifierArray.Size())
-    {
-    rapidjson::Value& regionModifier = regionModifierArray[index];
-    if (regionModifier.IsObject())
-      {
-      rapidjson::Value& regionModifierName = regionModifier["CodeMeaning"];
-      rapidjson::Value& regionModifierCodingSchemeDesignator = regionModifier["CodingSchemeDesignator"];
-      rapidjson::Value& regionModifierCodeValue = regionModifier["CodeValue"];
-      if (regionModifierName.IsString() && regionModifierCodingSchemeDesignator.IsString() && regionModifierCodeValue.IsString())
-        {
-        CodeIdentifier regionModifierId(regionModifierCodingSchemeDesignator.GetString(),
-          regionModifierCodeValue.GetString(), regionModifierName.GetString());
-          regionModifiers.push_back(regionModifierId);
-        }
-      }
-    ++index;
-    } // For each region index
-
+  this->Internal->FindCodesInArray(regionModifierArray, "", regionModifiers);
   return true;
 }
 
@@ -32,7 +32,10 @@ vtkMRMLNodeNewMacro(vtkMRMLCPURayCastVolumeRenderingDisplayNode);
 
 //----------------------------------------------------------------------------
 vtkMRMLCPURayCastVolumeRenderingDisplayNode::vtkMRMLCPURayCastVolumeRenderingDisplayNode()
-= default;
+{
+  this->ProgressiveRendering = false;
+  this->TargetFrameTime = 0.1;
+}
 
 //----------------------------------------------------------------------------
 vtkMRMLCPURayCastVolumeRenderingDisplayNode::~vtkMRMLCPURayCastVolumeRenderingDisplayNode()
@@ -42,16 +45,43 @@ vtkMRMLCPURayCastVolumeRenderingDisplayNode::~vtkMRMLCPURayCastVolumeRenderingDi
 void vtkMRMLCPURayCastVolumeRenderingDisplayNode::ReadXMLAttributes(const char** atts)
 {
   this->Superclass::ReadXMLAttributes(atts);
+
+  vtkMRMLReadXMLBeginMacro(atts);
+  vtkMRMLReadXMLBooleanMacro(progressiveRendering, ProgressiveRendering);
+  vtkMRMLReadXMLFloatMacro(targetFrameTime, TargetFrameTime);
+  vtkMRMLReadXMLEndMacro();
 }
 
 //----------------------------------------------------------------------------
 void vtkMRMLCPURayCastVolumeRenderingDisplayNode::WriteXML(ostream& of, int nIndent)
 {
   this->Superclass::WriteXML(of, nIndent);
+
+  vtkMRMLWriteXMLBeginMacro(of);
+  vtkMRMLWriteXMLBooleanMacro(progressiveRendering, ProgressiveRendering);
+  vtkMRMLWriteXMLFloatMacro(targetFrameTime, TargetFrameTime);
+  vtkMRMLWriteXMLEndMacro();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLCPURayCastVolumeRenderingDisplayNode::CopyContent(vtkMRMLNode* anode, bool deepCopy/*=true*/)
+{
+  MRMLNodeModifyBlocker blocker(this);
+  Superclass::CopyContent(anode, deepCopy);
+
+  vtkMRMLCopyBeginMacro(anode);
+  vtkMRMLCopyBooleanMacro(ProgressiveRendering);
+  vtkMRMLCopyFloatMacro(TargetFrameTime);
+  vtkMRMLCopyEndMacro();
 }
 
 //----------------------------------------------------------------------------
 void vtkMRMLCPURayCastVolumeRenderingDisplayNode::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
+
+  vtkMRMLPrintBeginMacro(os, indent);
+  vtkMRMLPrintBooleanMacro(ProgressiveRendering);
+  vtkMRMLPrintFloatMacro(TargetFrameTime);
+  vtkMRMLPrintEndMacro();
 }
@@ -47,17 +47,33 @@ public:
 
   /// Copy node content (excludes basic data, such as name and node references).
   /// \sa vtkMRMLNode::CopyContent
-  vtkMRMLCopyContentDefaultMacro(vtkMRMLCPURayCastVolumeRenderingDisplayNode);
+  vtkMRMLCopyContentMacro(vtkMRMLCPURayCastVolumeRenderingDisplayNode);
 
   // Description:
   // Get node XML tag name (like Volume, Model)
   const char* GetNodeTagName() override {return "CPURayCastVolumeRendering";}
 
+  /// Render progressively: during interaction a downsampled copy of the volume is rendered
+  /// at coarse image sample distance, chosen so that rendering fits in TargetFrameTime.
+  /// When interaction ends, the image is refined over successive renders until full
+  /// quality is reached. Default is off.
+  vtkSetMacro(ProgressiveRendering, bool);
+  vtkGetMacro(ProgressiveRendering, bool);
+  vtkBooleanMacro(ProgressiveRendering, bool);
+
+  /// Desired rendering time of a frame during interaction, in seconds.
+  /// Only used if ProgressiveRendering is enabled. Default is 0.1.
+  vtkSetMacro(TargetFrameTime, double);
+  vtkGetMacro(TargetFrameTime, double);
+
 protected:
   vtkMRMLCPURayCastVolumeRenderingDisplayNode();
   ~vtkMRMLCPURayCastVolumeRenderingDisplayNode() override;
   vtkMRMLCPURayCastVolumeRenderingDisplayNode(const vtkMRMLCPURayCastVolumeRenderingDisplayNode&);
   void operator=(const vtkMRMLCPURayCastVolumeRenderingDisplayNode&);
+
+  bool ProgressiveRendering;
+  double TargetFrameTime;
 };
 
 #endif
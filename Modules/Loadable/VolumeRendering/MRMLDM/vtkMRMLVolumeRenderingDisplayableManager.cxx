@@ -44,6 +44,7 @@
 #include <vtkCallbackCommand.h>
 #include <vtkFixedPointVolumeRayCastMapper.h>
 #include <vtkGPUVolumeRayCastMapper.h>
+#include <vtkImageShrink3D.h>
 #include <vtkInteractorStyle.h>
 #include <vtkMatrix4x4.h>
 #include <vtkPlane.h>
@@ -58,6 +59,7 @@
 #include <vtkVolumeProperty.h>
 #include <vtkDoubleArray.h>
 #include <vtkVolumePicker.h>
+#include <vtkWeakPointer.h>
 
 #include <vtkImageData.h> //TODO: Used for workaround. Remove when fixed
 #include <vtkTrivialProducer.h> //TODO: Used for workaround. Remove when fixed
@@ -69,6 +71,29 @@ vtkStandardNewMacro(vtkMRMLVolumeRenderingDisplayableManager);
 //---------------------------------------------------------------------------
 int vtkMRMLVolumeRenderingDisplayableManager::DefaultGPUMemorySize = 256;
 
+namespace
+{
+/// Rendering settings used by progressive CPU ray casting, from full quality to coarsest.
+/// Each step is approximately 2-4x faster to render than the previous one.
+struct ProgressiveRenderingStep
+{
+  /// Index of the downsampled volume in PipelineCPU::LowResolutionMappers, -1 for full resolution
+  int LowResolutionLevel;
+  double ImageSampleDistance;
+};
+const ProgressiveRenderingStep ProgressiveRenderingSteps[] =
+{
+  { -1, 1.0 }, // full quality, ray cast settings of the view node are used
+  { -1, 2.0 },
+  { 0, 2.0 },
+  { 0, 4.0 },
+  { 1, 4.0 },
+  { 1, 8.0 }
+};
+const int NumberOfProgressiveRenderingSteps = sizeof(ProgressiveRenderingSteps) / sizeof(ProgressiveRenderingStep);
+const int NumberOfLowResolutionLevels = 2;
+}
+
 //---------------------------------------------------------------------------
 class vtkMRMLVolumeRenderingDisplayableManager::vtkInternal
 {
@@ -98,8 +123,36 @@ public:
     PipelineCPU() : Pipeline()
     {
       this->RayCastMapperCPU = vtkSmartPointer<vtkFixedPointVolumeRayCastMapper>::New();
+      this->ProgressiveStep = 0;
+      this->InteractiveStep = 2;
+      // Each level halves the resolution of the previous one. Each level has its own mapper
+      // so that switching between levels does not discard the gradients cached in the mappers.
+      for (int level = 0; level < NumberOfLowResolutionLevels; ++level)
+        {
+        vtkSmartPointer<vtkImageShrink3D> shrinkFilter = vtkSmartPointer<vtkImageShrink3D>::New();
+        shrinkFilter->SetShrinkFactors(2, 2, 2);
+        shrinkFilter->AveragingOn();
+        if (level > 0)
+          {
+          shrinkFilter->SetInputConnection(this->LowResolutionFilters[level - 1]->GetOutputPort());
+          }
+        vtkSmartPointer<vtkFixedPointVolumeRayCastMapper> mapper = vtkSmartPointer<vtkFixedPointVolumeRayCastMapper>::New();
+        mapper->SetInputConnection(shrinkFilter->GetOutputPort());
+        this->LowResolutionFilters.push_back(shrinkFilter);
+        this->LowResolutionMappers.push_back(mapper);
+        }
     }
     vtkSmartPointer<vtkFixedPointVolumeRayCastMapper> RayCastMapperCPU;
+
+    /// Multi-resolution pyramid of the volume used for progressive rendering.
+    /// Filters only execute when their output is rendered, and keep their output until the volume is modified.
+    std::vector< vtkSmartPointer<vtkImageShrink3D> > LowResolutionFilters;
+    std::vector< vtkSmartPointer<vtkFixedPointVolumeRayCastMapper> > LowResolutionMappers;
+
+    /// Index of the currently used item in ProgressiveRenderingSteps
+    mutable int ProgressiveStep;
+    /// Step that renders within the target frame time during interaction, adjusted after each interactive frame
+    mutable int InteractiveStep;
   };
   //-------------------------------------------------------------------------
   class PipelineGPU : public Pipeline
@@ -153,6 +206,19 @@ public:
   vtkIdType GetMaxMemoryInBytes(vtkMRMLVolumeRenderingDisplayNode* displayNode);
   void UpdateDesiredUpdateRate(vtkMRMLVolumeRenderingDisplayNode* displayNode);
 
+  // Progressive rendering
+  bool IsInteracting();
+  bool UseProgressiveRendering(vtkMRMLVolumeRenderingDisplayNode* displayNode);
+  /// Apply the current progressive rendering step of the pipeline to the volume actor
+  void UpdatePipelineProgressiveRendering(vtkMRMLCPURayCastVolumeRenderingDisplayNode* displayNode, const PipelineCPU* pipeline);
+  /// Switch progressive pipelines to the interactive step (when interaction starts)
+  void StartProgressiveRenderingInteraction();
+  /// Adjust interactive step based on the time of the last render, or refine the image if not interacting.
+  /// Returns true if another render is needed.
+  bool UpdateProgressiveRenderingAfterRender();
+  void ObserveRendererEndEvent();
+  static void RendererEndCallback(vtkObject* caller, unsigned long eid, void* clientData, void* callData);
+
   // Observations
   void AddObservations(vtkMRMLVolumeNode* node);
   void RemoveObservations(vtkMRMLVolumeNode* node);
@@ -183,6 +249,14 @@ public:
   /// When interaction is >0, we are in interactive mode (low level of detail)
   int Interaction;
 
+  /// True while the view is interacted with (e.g., camera is rotated)
+  bool ViewInteraction;
+
+  /// Observation of renderer EndEvent for progressive rendering
+  vtkSmartPointer<vtkCallbackCommand> RendererEndCallbackCommand;
+  vtkWeakPointer<vtkRenderer> ObservedRenderer;
+  unsigned long RendererEndObserverTag;
+
   /// Used to determine the port index in the multi-volume actor
   unsigned int NextMultiVolumeActorPortIndex;
 
@@ -213,6 +287,8 @@ vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::vtkInternal(vtkMRMLVolume
 , AddingVolumeNode(false)
 , OriginalDesiredUpdateRate(0.0) // 0 fps is a special value that means it hasn't been set
 , Interaction(0)
+, ViewInteraction(false)
+, RendererEndObserverTag(0)
   //TODO: Change back to 0 once the VTK issue https://gitlab.kitware.com/vtk/vtk/issues/17325 is fixed
 , NextMultiVolumeActorPortIndex(1)
 , PickedNodeID("")
@@ -248,6 +324,10 @@ vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::vtkInternal(vtkMRMLVolume
 
   this->VolumePicker = vtkSmartPointer<vtkVolumePicker>::New();
   this->VolumePicker->SetTolerance(0.005);
+
+  this->RendererEndCallbackCommand = vtkSmartPointer<vtkCallbackCommand>::New();
+  this->RendererEndCallbackCommand->SetClientData(this);
+  this->RendererEndCallbackCommand->SetCallback(vtkInternal::RendererEndCallback);
 }
 
 //---------------------------------------------------------------------------
@@ -255,6 +335,11 @@ vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::~vtkInternal()
 {
   this->ClearDisplayableNodes();
 
+  if (this->ObservedRenderer)
+    {
+    this->ObservedRenderer->RemoveObserver(this->RendererEndObserverTag);
+    }
+
   if (this->DisplayObservedEvents)
     {
     this->DisplayObservedEvents->Delete();
@@ -422,6 +507,8 @@ void vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::AddDisplayNode(vtkMR
     this->External->GetRenderer()->AddVolume(pipelineCpu->VolumeActor);
     // Add pipeline
     this->DisplayPipelines.insert( std::make_pair(displayNode, pipelineCpu) );
+    // Render times are needed for progressive rendering
+    this->ObserveRendererEndEvent();
     }
   else if (displayNode->IsA("vtkMRMLGPURayCastVolumeRenderingDisplayNode"))
     {
@@ -805,6 +892,13 @@ void vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::UpdateDisplayNodePip
   // Update ROI clipping planes
   this->UpdatePipelineROIs(displayNode, pipeline);
 
+  // Select resolution and image sample distance for progressive rendering
+  if (displayNode->IsA("vtkMRMLCPURayCastVolumeRenderingDisplayNode"))
+    {
+    this->UpdatePipelineProgressiveRendering(vtkMRMLCPURayCastVolumeRenderingDisplayNode::SafeDownCast(displayNode),
+      dynamic_cast<const PipelineCPU*>(pipeline));
+    }
+
   // Set volume property
   vtkVolumeProperty* volumeProperty = displayNode->GetVolumePropertyNode() ? displayNode->GetVolumePropertyNode()->GetVolumeProperty() : nullptr;
   pipeline->VolumeActor->SetProperty(volumeProperty);
@@ -945,6 +1039,175 @@ void vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::UpdateDesiredUpdateR
     }
 }
 
+//---------------------------------------------------------------------------
+bool vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::IsInteracting()
+{
+  return this->Interaction > 0 || this->ViewInteraction;
+}
+
+//---------------------------------------------------------------------------
+bool vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::UseProgressiveRendering(vtkMRMLVolumeRenderingDisplayNode* displayNode)
+{
+  vtkMRMLCPURayCastVolumeRenderingDisplayNode* cpuDisplayNode = vtkMRMLCPURayCastVolumeRenderingDisplayNode::SafeDownCast(displayNode);
+  if (!cpuDisplayNode || !cpuDisplayNode->GetProgressiveRendering() || !this->IsVisible(cpuDisplayNode))
+    {
+    return false;
+    }
+  // Maximum quality is requested, never render at lower resolution
+  vtkMRMLViewNode* viewNode = this->External->GetMRMLViewNode();
+  return viewNode && viewNode->GetVolumeRenderingQuality() != vtkMRMLViewNode::Maximum;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::UpdatePipelineProgressiveRendering(
+  vtkMRMLCPURayCastVolumeRenderingDisplayNode* displayNode, const PipelineCPU* pipeline)
+{
+  if (!displayNode || !pipeline)
+    {
+    return;
+    }
+  if (!this->UseProgressiveRendering(displayNode))
+    {
+    pipeline->ProgressiveStep = 0;
+    }
+  if (pipeline->ProgressiveStep == 0)
+    {
+    // Full quality, mapper is already set up according to view node settings
+    pipeline->VolumeActor->SetMapper(pipeline->RayCastMapperCPU);
+    return;
+    }
+
+  const ProgressiveRenderingStep& step = ProgressiveRenderingSteps[pipeline->ProgressiveStep];
+  if (step.LowResolutionLevel < 0)
+    {
+    pipeline->RayCastMapperCPU->SetAutoAdjustSampleDistances(false);
+    pipeline->RayCastMapperCPU->SetImageSampleDistance(step.ImageSampleDistance);
+    pipeline->VolumeActor->SetMapper(pipeline->RayCastMapperCPU);
+    return;
+    }
+
+  vtkVolumeMapper* volumeMapper = this->GetVolumeMapper(displayNode);
+  vtkMRMLVolumeNode* volumeNode = displayNode->GetVolumeNode();
+  if (!volumeMapper || !volumeNode)
+    {
+    return;
+    }
+  // Reconnection is expensive operation, therefore only do it if needed
+  if (pipeline->LowResolutionFilters[0]->GetInputConnection(0, 0) != volumeNode->GetImageDataConnection())
+    {
+    pipeline->LowResolutionFilters[0]->SetInputConnection(0, volumeNode->GetImageDataConnection());
+    }
+
+  // Downsampled volume is rendered with the same settings, except that samples are taken
+  // farther apart along the rays, as the downsampled volume has no finer details.
+  double shrinkFactor = static_cast<double>(2 << step.LowResolutionLevel);
+  vtkFixedPointVolumeRayCastMapper* lowResolutionMapper = pipeline->LowResolutionMappers[step.LowResolutionLevel];
+  lowResolutionMapper->SetAutoAdjustSampleDistances(false);
+  lowResolutionMapper->SetLockSampleDistanceToInputSpacing(false);
+  lowResolutionMapper->SetImageSampleDistance(step.ImageSampleDistance);
+  lowResolutionMapper->SetSampleDistance(displayNode->GetSampleDistance() * shrinkFactor);
+  lowResolutionMapper->SetInteractiveSampleDistance(displayNode->GetSampleDistance() * shrinkFactor);
+  lowResolutionMapper->SetBlendMode(volumeMapper->GetBlendMode());
+  lowResolutionMapper->SetClippingPlanes(volumeMapper->GetClippingPlanes());
+  pipeline->VolumeActor->SetMapper(lowResolutionMapper);
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::StartProgressiveRenderingInteraction()
+{
+  for (PipelinesCacheType::iterator pipelineIt = this->DisplayPipelines.begin(); pipelineIt != this->DisplayPipelines.end(); ++pipelineIt)
+    {
+    const PipelineCPU* pipelineCpu = dynamic_cast<const PipelineCPU*>(pipelineIt->second);
+    if (!pipelineCpu || !this->UseProgressiveRendering(pipelineIt->first))
+      {
+      continue;
+      }
+    if (pipelineCpu->ProgressiveStep != pipelineCpu->InteractiveStep)
+      {
+      pipelineCpu->ProgressiveStep = pipelineCpu->InteractiveStep;
+      this->UpdateDisplayNodePipeline(pipelineIt->first, pipelineCpu);
+      }
+    }
+}
+
+//---------------------------------------------------------------------------
+bool vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::UpdateProgressiveRenderingAfterRender()
+{
+  bool renderRequested = false;
+  bool interacting = this->IsInteracting();
+  for (PipelinesCacheType::iterator pipelineIt = this->DisplayPipelines.begin(); pipelineIt != this->DisplayPipelines.end(); ++pipelineIt)
+    {
+    const PipelineCPU* pipelineCpu = dynamic_cast<const PipelineCPU*>(pipelineIt->second);
+    if (!pipelineCpu || !this->UseProgressiveRendering(pipelineIt->first))
+      {
+      continue;
+      }
+    vtkMRMLCPURayCastVolumeRenderingDisplayNode* displayNode =
+      vtkMRMLCPURayCastVolumeRenderingDisplayNode::SafeDownCast(pipelineIt->first);
+    int newStep = pipelineCpu->ProgressiveStep;
+    if (interacting)
+      {
+      // Adjust the interactive step so that the next interactive frame fits in the target time.
+      // Each step changes rendering time by a factor of 2-4, so only switch to a finer step
+      // if there is enough headroom to avoid oscillating between two steps.
+      double renderTime = pipelineCpu->VolumeActor->GetMapper() ? pipelineCpu->VolumeActor->GetMapper()->GetTimeToDraw() : 0.0;
+      double targetFrameTime = displayNode->GetTargetFrameTime();
+      if (renderTime > targetFrameTime && pipelineCpu->InteractiveStep < NumberOfProgressiveRenderingSteps - 1)
+        {
+        pipelineCpu->InteractiveStep++;
+        }
+      else if (renderTime < targetFrameTime / 4.0 && pipelineCpu->InteractiveStep > 1)
+        {
+        pipelineCpu->InteractiveStep--;
+        }
+      newStep = pipelineCpu->InteractiveStep;
+      }
+    else if (pipelineCpu->ProgressiveStep > 0)
+      {
+      // Idle, refine the image by one step in each render
+      newStep = pipelineCpu->ProgressiveStep - 1;
+      renderRequested = true;
+      }
+    if (newStep != pipelineCpu->ProgressiveStep)
+      {
+      pipelineCpu->ProgressiveStep = newStep;
+      this->UpdateDisplayNodePipeline(displayNode, pipelineCpu);
+      }
+    }
+  return renderRequested;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::ObserveRendererEndEvent()
+{
+  vtkRenderer* renderer = this->External->GetRenderer();
+  if (renderer == this->ObservedRenderer)
+    {
+    return;
+    }
+  if (this->ObservedRenderer)
+    {
+    this->ObservedRenderer->RemoveObserver(this->RendererEndObserverTag);
+    }
+  this->ObservedRenderer = renderer;
+  if (renderer)
+    {
+    this->RendererEndObserverTag = renderer->AddObserver(vtkCommand::EndEvent, this->RendererEndCallbackCommand);
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::RendererEndCallback(
+  vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(eid), void* clientData, void* vtkNotUsed(callData))
+{
+  vtkInternal* self = reinterpret_cast<vtkInternal*>(clientData);
+  if (self->UpdateProgressiveRenderingAfterRender())
+    {
+    // Render request is processed asynchronously, after the current render is completed
+    self->External->RequestRender();
+    }
+}
+
 //---------------------------------------------------------------------------
 void vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::AddObservations(vtkMRMLVolumeNode* node)
 {
@@ -1325,6 +1588,7 @@ void vtkMRMLVolumeRenderingDisplayableManager::ProcessMRMLNodesEvents(vtkObject*
         {
         interactorStyle->StartState(VTKIS_VOLUME_PROPS);
         }
+      this->Internal->StartProgressiveRenderingInteraction();
       }
     }
   else if (event == vtkCommand::EndEvent ||
@@ -1342,6 +1606,8 @@ void vtkMRMLVolumeRenderingDisplayableManager::ProcessMRMLNodesEvents(vtkObject*
         {
         this->Internal->UpdateDisplayNode(vtkMRMLVolumeRenderingDisplayNode::SafeDownCast(caller));
         }
+      // Start progressive refinement
+      this->RequestRender();
       }
     }
   else if (event == vtkCommand::InteractionEvent)
@@ -1370,6 +1636,16 @@ void vtkMRMLVolumeRenderingDisplayableManager::OnInteractorStyleEvent(int eventI
     case vtkCommand::EndInteractionEvent:
     case vtkCommand::StartInteractionEvent:
       {
+      this->Internal->ViewInteraction = (eventID == vtkCommand::StartInteractionEvent);
+      if (this->Internal->ViewInteraction)
+        {
+        this->Internal->StartProgressiveRenderingInteraction();
+        }
+      else
+        {
+        // Start progressive refinement
+        this->RequestRender();
+        }
       vtkInternal::VolumeToDisplayCacheType::iterator volumeIt;
       for ( volumeIt = this->Internal->VolumeToDisplayNodes.begin();
             volumeIt != this->Internal->VolumeToDisplayNodes.end(); ++volumeIt )
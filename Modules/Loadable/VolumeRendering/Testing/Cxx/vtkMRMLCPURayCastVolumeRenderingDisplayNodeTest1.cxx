@@ -0,0 +1,49 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c) Kitware Inc.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// VolumeRendering includes
+#include <vtkMRMLCPURayCastVolumeRenderingDisplayNode.h>
+
+// MRML includes
+#include <vtkMRMLCoreTestingMacros.h>
+#include <vtkMRMLScene.h>
+
+// VTK includes
+#include <vtkNew.h>
+
+//----------------------------------------------------------------------------
+int vtkMRMLCPURayCastVolumeRenderingDisplayNodeTest1(int , char * [] )
+{
+  vtkNew<vtkMRMLCPURayCastVolumeRenderingDisplayNode> node1;
+  vtkNew<vtkMRMLScene> scene;
+  scene->AddNode(node1.GetPointer());
+  EXERCISE_ALL_BASIC_MRML_METHODS(node1.GetPointer());
+
+  // Progressive rendering is off by default
+  CHECK_BOOL(node1->GetProgressiveRendering(), false);
+  CHECK_DOUBLE_TOLERANCE(node1->GetTargetFrameTime(), 0.1, 1e-9);
+
+  // Progressive rendering settings are copied
+  node1->ProgressiveRenderingOn();
+  node1->SetTargetFrameTime(0.05);
+  vtkNew<vtkMRMLCPURayCastVolumeRenderingDisplayNode> node2;
+  node2->Copy(node1.GetPointer());
+  CHECK_BOOL(node2->GetProgressiveRendering(), true);
+  CHECK_DOUBLE_TOLERANCE(node2->GetTargetFrameTime(), 0.05, 1e-9);
+
+  return EXIT_SUCCESS;
+}
@@ -269,7 +269,7 @@ class DataProbeInfoWidget(object):
     # set image
     if (not slicer.mrmlScene.IsBatchProcessing()) and sliceLogic and hasVolume and self.showImage:
       pixmap = self._createMagnifiedPixmap(
-        xyz, sliceLogic.GetBlend().GetOutputPort(), self.imageLabel.size, color)
+        xyz, sliceLogic.GetImageDataConnection(), self.imageLabel.size, color)
       if pixmap:
         self.imageLabel.setPixmap(pixmap)
         self.onShowImage(self.showImage)